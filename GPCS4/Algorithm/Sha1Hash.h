@@ -22,6 +22,11 @@ namespace alg {
     : m_digest(digest) { }
     
     std::string toString() const;
+
+    const Sha1Digest& digest() const
+	{
+      return m_digest;
+    }
     
     uint32_t dword(uint32_t id) const 
 	{
@@ -1,18 +1,19 @@
-
-#define SPDLOG_NO_NAME
-#define SPDLOG_NO_ATOMIC_LEVELS
-
 #include "GPCS4Log.h"
 
+#include "PlatThread.h"
 #include "UtilString.h"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdarg>
 #include <cstdio>
+#include <cstdlib>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <cxxopts/cxxopts.hpp>
-#include <spdlog/sinks/basic_file_sink.h>
-#include <spdlog/sinks/msvc_sink.h>
-#include <spdlog/sinks/stdout_color_sinks.h>
-#include <spdlog/spdlog.h>
 
 #define LOG_STR_BUFFER_LEN 0x2000
 
@@ -25,42 +26,557 @@ void showMessageBox(const char* title, const char* message)
 	MessageBoxA(NULL, message, title, MB_OK | MB_ICONERROR);
 }
 
+static void writeDebugger(const char* text)
+{
+	if (IsDebuggerPresent())
+	{
+		OutputDebugStringA(text);
+	}
+}
+
 #else
 
 void showMessageBox(const char* title, const char* message)
 {
 }
 
+static void writeDebugger(const char* text)
+{
+}
+
 #endif  //GPCS4_WINDOWS
 
 
 namespace logsys
 {;
 
-static std::unique_ptr<spdlog::logger> g_logger;
+using detail::ArgType;
+using detail::LogRing;
+using detail::RecordHeader;
+
+// Bytes of the ring of each thread logging.
+constexpr uint32_t RingCapacity = 0x20000;
+// Messages are written out at least this often.
+constexpr auto FlushInterval = std::chrono::milliseconds(10);
+// Formatted messages are written to the sinks in chunks of this size.
+constexpr size_t OutputChunkSize = 0x10000;
+// Milliseconds a crash handler waits for the output lock.
+constexpr uint32_t CrashLockTimeout = 200;
+// Functions registered to run on a crash.
+constexpr uint32_t MaxCrashCallbacks = 8;
+
+struct LogState
+{
+	// Only guards the list.
+	std::mutex                            ringMutex;
+	std::vector<std::shared_ptr<LogRing>> rings;
+
+	// Held to read rings and write to the sinks.
+	std::mutex                            outputMutex;
+	OutputDesc                            output = { "", true, false };
+	FILE*                                 file   = nullptr;
+	std::string                           buffer;
+	std::vector<std::shared_ptr<LogRing>> readRings;
+	std::vector<const RecordHeader*>      readRecords;
+	uint64_t                              startTime = detail::now();
+
+	std::mutex              threadMutex;
+	std::condition_variable threadCond;
+	bool                    running = false;
+	std::atomic<bool>       wakePending = { false };
+	std::thread             thread;
+};
+
+// Never freed, threads may log until the process is gone.
+static LogState& getState()
+{
+	static LogState* state = new LogState();
+	return *state;
+}
+
+// Retires the ring of a thread when it exits.
+struct RingOwner
+{
+	std::shared_ptr<LogRing> ring;
+
+	~RingOwner();
+};
+
+static thread_local RingOwner t_owner;
+static thread_local bool      t_exited = false;
+
+RingOwner::~RingOwner()
+{
+	if (ring)
+	{
+		ring->retire();
+	}
+	detail::t_ring = nullptr;
+	t_exited       = true;
+}
+
+template <typename... Args>
+static void appendFormat(std::string& out, const char* format, Args... args)
+{
+	char text[256];
+	int  length = std::snprintf(text, sizeof(text), format, args...);
+	if (length >= static_cast<int>(sizeof(text)))
+	{
+		size_t offset = out.size();
+		out.resize(offset + length + 1);
+		std::snprintf(&out[offset], length + 1, format, args...);
+		out.resize(offset + length);
+	}
+	else if (length > 0)
+	{
+		out.append(text, length);
+	}
+}
+
+// Applies a printf format to stored arguments. Each conversion is
+// printed on its own, integers are first cut to the size their
+// length modifier gives, since they were all stored in 64 bits.
+static void formatMessage(const RecordHeader& record, std::string& out)
+{
+	auto        slots   = reinterpret_cast<const uint64_t*>(&record + 1);
+	const char* strings = reinterpret_cast<const char*>(slots + record.argCount);
+	uint32_t    index   = 0;
+
+	auto takeArg = [&](ArgType* type, uint64_t* value, const char** string)
+	{
+		bool ret = false;
+		if (index < record.argCount)
+		{
+			*type   = static_cast<ArgType>((record.argTypes >> (2 * index)) & 3);
+			*value  = slots[index++];
+			*string = strings;
+			if (*type == ArgType::kString)
+			{
+				strings += std::strlen(strings) + 1;
+			}
+			ret = true;
+		}
+		return ret;
+	};
+
+	ArgType     type   = ArgType::kInt;
+	uint64_t    value  = 0;
+	const char* string = nullptr;
+
+	const char* pos = record.format;
+	while (*pos)
+	{
+		const char* percent = std::strchr(pos, '%');
+		if (!percent)
+		{
+			out.append(pos);
+			break;
+		}
+		out.append(pos, percent - pos);
+
+		pos = percent + 1;
+		if (*pos == '%')
+		{
+			out += '%';
+			++pos;
+			continue;
+		}
+
+		// Flags and width, * taken from the arguments.
+		std::string spec = "%";
+		bool        valid = true;
+		while (*pos && std::strchr("-+ #0", *pos))
+		{
+			spec += *pos++;
+		}
+		if (*pos == '*')
+		{
+			valid &= takeArg(&type, &value, &string);
+			spec += std::to_string(static_cast<int>(value));
+			++pos;
+		}
+		while (*pos >= '0' && *pos <= '9')
+		{
+			spec += *pos++;
+		}
+
+		int precision = -1;
+		if (*pos == '.')
+		{
+			++pos;
+			precision = 0;
+			if (*pos == '*')
+			{
+				valid &= takeArg(&type, &value, &string);
+				precision = static_cast<int>(value);
+				++pos;
+			}
+			while (*pos >= '0' && *pos <= '9')
+			{
+				precision = precision * 10 + (*pos++ - '0');
+			}
+		}
+
+		uint32_t bits = 32;
+		if (std::strncmp(pos, "hh", 2) == 0)
+		{
+			bits = 8;
+			pos += 2;
+		}
+		else if (std::strncmp(pos, "ll", 2) == 0 || std::strncmp(pos, "I64", 3) == 0)
+		{
+			bits = 64;
+			pos += *pos == 'I' ? 3 : 2;
+		}
+		else if (std::strncmp(pos, "I32", 3) == 0)
+		{
+			pos += 3;
+		}
+		else if (*pos && std::strchr("hlLzjtqI", *pos))
+		{
+			bits = *pos == 'h'   ? 16
+				   : *pos == 'l' ? sizeof(long) * 8
+				   : *pos == 'L' ? 32
+								 : 64;
+			++pos;
+		}
+
+		char conversion = *pos;
+		if (!conversion)
+		{
+			out.append(percent);
+			break;
+		}
+		++pos;
+
+		if (!valid || !takeArg(&type, &value, &string))
+		{
+			// Missing arguments, keep the specification as is.
+			out.append(percent, pos - percent);
+			continue;
+		}
+
+		if (precision >= 0)
+		{
+			spec += "." + std::to_string(precision);
+		}
+
+		uint64_t mask = bits == 64 ? ~0ull : (1ull << bits) - 1;
+		switch (conversion)
+		{
+		case 'd':
+		case 'i':
+		{
+			// Sign extended from the logged size.
+			uint64_t sign   = 1ull << (bits - 1);
+			int64_t  number = static_cast<int64_t>(((value & mask) ^ sign) - sign);
+			appendFormat(out, (spec + "lld").c_str(), static_cast<long long>(number));
+		}
+		break;
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+			appendFormat(out, (spec + "ll" + conversion).c_str(), static_cast<unsigned long long>(value & mask));
+			break;
+		case 'c':
+			appendFormat(out, (spec + "c").c_str(), static_cast<int>(value));
+			break;
+		case 'e':
+		case 'E':
+		case 'f':
+		case 'F':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+		{
+			double number = static_cast<double>(static_cast<int64_t>(value));
+			if (type == ArgType::kDouble)
+			{
+				std::memcpy(&number, &value, sizeof(number));
+			}
+			appendFormat(out, (spec + conversion).c_str(), number);
+		}
+		break;
+		case 's':
+		case 'S':
+			if (type == ArgType::kString)
+			{
+				appendFormat(out, (spec + "s").c_str(), string);
+			}
+			else
+			{
+				// Not a narrow string, don't follow the pointer.
+				appendFormat(out, (spec + "p").c_str(), reinterpret_cast<void*>(value));
+			}
+			break;
+		case 'p':
+			appendFormat(out, (spec + "p").c_str(), reinterpret_cast<void*>(value));
+			break;
+		case 'n':
+			break;
+		default:
+			out.append(percent, pos - percent);
+			break;
+		}
+	}
+}
+
+static void formatRecord(LogState& state, const RecordHeader& record, uint64_t threadId)
+{
+	static const char* const levelNames[] = {
+		"trace", "debug", "warning", "warning", "error", "trace", "trace"
+	};
+	static const char* const levelPrefixes[] = {
+		"", "", "<FIXME>", "", "", "<SCE>", "<GRAPH>"
+	};
+
+	double seconds = static_cast<int64_t>(record.time - state.startTime) / 1000000000.0;
+	appendFormat(state.buffer, "[%.6f][%llu][%s]%s%s(%d): ",
+				 seconds, static_cast<unsigned long long>(threadId),
+				 levelNames[record.level], levelPrefixes[record.level],
+				 record.function, record.line);
+	formatMessage(record, state.buffer);
+	state.buffer += '\n';
+}
+
+static void writeOutput(LogState& state)
+{
+	if (!state.buffer.empty())
+	{
+		if (state.output.console)
+		{
+			std::fwrite(state.buffer.data(), 1, state.buffer.size(), stderr);
+			writeDebugger(state.buffer.c_str());
+		}
+		if (state.file)
+		{
+			std::fwrite(state.buffer.data(), 1, state.buffer.size(), state.file);
+		}
+		state.buffer.clear();
+	}
+}
+
+static void flushFiles(LogState& state)
+{
+	std::fflush(stderr);
+	if (state.file)
+	{
+		std::fflush(state.file);
+	}
+}
+
+// Writes out the records of all rings, oldest first.
+// The output lock must be held.
+static void drainRings(LogState& state)
+{
+	auto& rings   = state.readRings;
+	auto& records = state.readRecords;
+	{
+		std::lock_guard<std::mutex> lock(state.ringMutex);
+		rings = state.rings;
+	}
+
+	records.resize(rings.size());
+	for (size_t i = 0; i != rings.size(); ++i)
+	{
+		records[i] = rings[i]->peek();
+	}
+
+	while (true)
+	{
+		size_t oldest = rings.size();
+		for (size_t i = 0; i != rings.size(); ++i)
+		{
+			if (records[i] && (oldest == rings.size() || records[i]->time < records[oldest]->time))
+			{
+				oldest = i;
+			}
+		}
+
+		if (oldest == rings.size())
+		{
+			break;
+		}
+
+		formatRecord(state, *records[oldest], rings[oldest]->threadId());
+		rings[oldest]->release(records[oldest]);
+		records[oldest] = rings[oldest]->peek();
+
+		if (state.buffer.size() >= OutputChunkSize)
+		{
+			writeOutput(state);
+		}
+	}
+	writeOutput(state);
+
+	{
+		std::lock_guard<std::mutex> lock(state.ringMutex);
+		auto iter = std::remove_if(state.rings.begin(), state.rings.end(),
+								   [](const std::shared_ptr<LogRing>& ring)
+								   { return ring->isRetired() && !ring->peek(); });
+		state.rings.erase(iter, state.rings.end());
+	}
+	rings.clear();
+}
+
+static void runLogThread(LogState& state)
+{
+	std::unique_lock<std::mutex> lock(state.threadMutex);
+	while (state.running)
+	{
+		// Wakeups may be missed, they're only there to write
+		// out a filling ring before the interval ends.
+		state.threadCond.wait_for(lock, FlushInterval, [&state]()
+								  { return !state.running || state.wakePending; });
+		state.wakePending = false;
+
+		lock.unlock();
+		flush();
+		lock.lock();
+	}
+}
+
+static void startLogThread(LogState& state)
+{
+	std::lock_guard<std::mutex> lock(state.threadMutex);
+	if (!state.running)
+	{
+		state.running = true;
+		state.thread  = std::thread([&state]()
+									{ runLogThread(state); });
+		detail::g_async = true;
+	}
+}
+
+static void stopLogThread(LogState& state)
+{
+	detail::g_async = false;
+	{
+		std::lock_guard<std::mutex> lock(state.threadMutex);
+		state.running = false;
+		state.threadCond.notify_all();
+	}
+
+	if (state.thread.joinable())
+	{
+		state.thread.join();
+	}
+}
+
+static std::atomic<CrashCallback> g_crashCallbacks[MaxCrashCallbacks];
+static std::atomic<uint32_t>      g_crashCallbackCount = { 0 };
+
+// Writes out what's left when the process dies. The crashing
+// thread may hold the output lock, so it's not waited for long.
+static void flushOnCrash()
+{
+	uint32_t callbackCount = std::min(g_crashCallbackCount.load(), MaxCrashCallbacks);
+	for (uint32_t i = 0; i != callbackCount; ++i)
+	{
+		CrashCallback callback = g_crashCallbacks[i].load();
+		if (callback)
+		{
+			callback();
+		}
+	}
+
+	auto& state  = getState();
+	bool  locked = false;
+	for (uint32_t i = 0; i != CrashLockTimeout && !locked; ++i)
+	{
+		locked = state.outputMutex.try_lock();
+		if (!locked)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
 
-void initSpdLog()
+	if (locked)
+	{
+		drainRings(state);
+		flushFiles(state);
+		state.outputMutex.unlock();
+	}
+}
+
+static void crashSignalHandler(int sig)
+{
+	flushOnCrash();
+	std::signal(sig, SIG_DFL);
+	std::raise(sig);
+}
+
+#ifdef GPCS4_WINDOWS
+
+static LPTOP_LEVEL_EXCEPTION_FILTER g_previousFilter = nullptr;
+
+// Only called for exceptions no handler took,
+// so faults handled by the emulator don't get here.
+static LONG WINAPI crashExceptionFilter(EXCEPTION_POINTERS* info)
 {
-	/// Init spdlog
+	flushOnCrash();
+	return g_previousFilter ? g_previousFilter(info) : EXCEPTION_CONTINUE_SEARCH;
+}
+
+#endif  // GPCS4_WINDOWS
 
-	auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
-	console_sink->set_level(spdlog::level::trace);  // message generating filter
-	console_sink->set_pattern("[%t][%^%l%$]%v");
+static void installCrashHandlers()
+{
+#ifdef GPCS4_WINDOWS
+	g_previousFilter  = SetUnhandledExceptionFilter(crashExceptionFilter);
+	const int signals[] = { SIGABRT };
+#else
+	const int signals[] = { SIGABRT, SIGSEGV, SIGBUS, SIGILL, SIGFPE };
+#endif  // GPCS4_WINDOWS
 
-	auto msvc_sink = std::make_shared<spdlog::sinks::msvc_sink_mt>();
-	msvc_sink->set_level(spdlog::level::trace);  // message generating filter
-	msvc_sink->set_pattern("[%t][%^%l%$]%v");
+	for (int sig : signals)
+	{
+		// Handlers installed by others are left alone.
+		auto previous = std::signal(sig, crashSignalHandler);
+		if (previous != SIG_DFL && previous != SIG_ERR)
+		{
+			std::signal(sig, previous);
+		}
+	}
+}
 
-	auto file_sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>("GPCS4.log", true);
-	file_sink->set_level(spdlog::level::trace);
-	file_sink->set_pattern("[%t][%^%l%$]%v");
+// Lowest level logged, and all above it.
+static uint32_t levelMask(const std::string& name)
+{
+	auto bit = [](Level level)
+	{
+		return 1u << static_cast<uint32_t>(level);
+	};
 
-	//g_logger.reset(new spdlog::logger("GPCS4", { console_sink }));
-	//g_logger.reset(new spdlog::logger("GPCS4", { msvc_sink, file_sink, console_sink }));
-	g_logger.reset(new spdlog::logger("GPCS4", { msvc_sink }));
-	g_logger->set_level(spdlog::level::trace);  // message showing filter
+	uint32_t error = bit(Level::kError);
+	uint32_t warn  = error | bit(Level::kWarning);
+	uint32_t fixme = warn | bit(Level::kFixme);
+	uint32_t debug = fixme | bit(Level::kDebug);
 
-	//g_logger->flush_on(spdlog::level::trace); // I/O cost
+	uint32_t mask = LevelMaskAll;
+	if (name == "debug")
+	{
+		mask = debug;
+	}
+	else if (name == "fixme")
+	{
+		mask = fixme;
+	}
+	else if (name == "warn")
+	{
+		mask = warn;
+	}
+	else if (name == "error")
+	{
+		mask = error;
+	}
+	else if (name == "off")
+	{
+		mask = 0;
+	}
+	return mask;
 }
 
 void initLogChannel(const cxxopts::ParseResult& optResult)
@@ -73,10 +589,7 @@ void initLogChannel(const cxxopts::ParseResult& optResult)
 
 		for (auto&& s : ls)
 		{
-			for (auto&& p : ChannelContainer::get()->getChannels())
-			{
-				p->checkSig(s);
-			}
+			setLevel(s);
 		}
 	}
 	else if (optResult.count("L"))
@@ -97,52 +610,232 @@ void initLogChannel(const cxxopts::ParseResult& optResult)
 
 void init(const cxxopts::ParseResult& optResult)
 {
-	initSpdLog();
+	OutputDesc desc = {};
+	desc.console    = true;
+	desc.async      = true;
+	if (optResult.count("log-file"))
+	{
+		desc.filePath = optResult["log-file"].as<std::string>();
+	}
+
+	setOutput(desc);
+	installCrashHandlers();
+	std::atexit(shutdown);
+
 	initLogChannel(optResult);
 }
 
-void Channel::print(Level nLevel, const char* szFunction, const char* szSourcePath, int nLine, const char* szFormat, ...)
+void setOutput(const OutputDesc& desc)
 {
-	if (!m_enabled)
+	auto& state = getState();
+	stopLogThread(state);
+
 	{
-		return;
+		std::lock_guard<std::mutex> lock(state.outputMutex);
+		drainRings(state);
+		flushFiles(state);
+
+		if (state.file)
+		{
+			std::fclose(state.file);
+			state.file = nullptr;
+		}
+
+		state.output = desc;
+		if (!desc.filePath.empty())
+		{
+			state.file = std::fopen(desc.filePath.c_str(), "w");
+			if (!state.file)
+			{
+				std::fprintf(stderr, "open log file %s failed\n", desc.filePath.c_str());
+			}
+		}
 	}
-	// generate format string
-	va_list stArgList;
-	va_start(stArgList, szFormat);
-	char szTempStr[LOG_STR_BUFFER_LEN + 1] = { 0 };
-	vsprintf_s(szTempStr, LOG_STR_BUFFER_LEN, szFormat, stArgList);
-	va_end(stArgList);
 
-	switch (nLevel)
+	if (desc.async)
 	{
-	case Level::kDebug:
-		g_logger->debug("{}({}): {}", szFunction, nLine, szTempStr);
-		break;
-	case Level::kTrace:
-		g_logger->trace("{}({}): {}", szFunction, nLine, szTempStr);
-		break;
-	case Level::kFixme:
-		g_logger->warn("<FIXME>{}({}): {}", szFunction, nLine, szTempStr);
-		break;
-	case Level::kWarning:
-		g_logger->warn("{}({}): {}", szFunction, nLine, szTempStr);
-		break;
-	case Level::kError:
-		g_logger->error("{}({}): {}", szFunction, nLine, szTempStr);
-		break;
-	case Level::kSceTrace:
-		g_logger->trace("<SCE>{}({}): {}", szFunction, nLine, szTempStr);
-		break;
-	case Level::kSceGraphic:
-		g_logger->trace("<GRAPH>{}({}): {}", szFunction, nLine, szTempStr);
-		break;
+		startLogThread(state);
+	}
+}
+
+void flush()
+{
+	auto& state = getState();
+
+	std::lock_guard<std::mutex> lock(state.outputMutex);
+	drainRings(state);
+	flushFiles(state);
+}
+
+void shutdown()
+{
+	stopLogThread(getState());
+	flush();
+}
+
+bool addCrashCallback(CrashCallback callback)
+{
+	bool ret = false;
+	do
+	{
+		uint32_t index = g_crashCallbackCount.fetch_add(1);
+		if (index >= MaxCrashCallbacks)
+		{
+			std::fprintf(stderr, "too many crash callbacks\n");
+			break;
+		}
+
+		g_crashCallbacks[index].store(callback);
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+void setLevel(const std::string& spec)
+{
+	for (auto&& p : ChannelContainer::get()->getChannels())
+	{
+		p->checkSig(spec);
+	}
+}
+
+namespace detail
+{;
+
+std::atomic<bool> g_async = { false };
+
+LogRing::LogRing(uint32_t capacity, uint64_t threadId) :
+	m_buffer(new uint8_t[capacity]),
+	m_capacity(capacity),
+	m_mask(capacity - 1),
+	m_threadId(threadId)
+{
+}
+
+LogRing::~LogRing()
+{
+	delete[] m_buffer;
+}
+
+const RecordHeader* LogRing::peek()
+{
+	const RecordHeader* record = nullptr;
+
+	uint64_t tail = m_tail.load(std::memory_order_relaxed);
+	uint64_t head = m_head.load(std::memory_order_acquire);
+	while (tail != head)
+	{
+		auto header = reinterpret_cast<const RecordHeader*>(m_buffer + (static_cast<uint32_t>(tail) & m_mask));
+		if (header->level != PaddingLevel)
+		{
+			record = header;
+			break;
+		}
+
+		tail += header->size;
+		m_tail.store(tail, std::memory_order_release);
 	}
+	return record;
 }
 
+void LogRing::release(const RecordHeader* record)
+{
+	m_tail.store(m_tail.load(std::memory_order_relaxed) + record->size, std::memory_order_release);
+}
+
+uint64_t LogRing::threadId() const
+{
+	return m_threadId;
+}
+
+void LogRing::retire()
+{
+	m_retired.store(true, std::memory_order_release);
+}
+
+bool LogRing::isRetired() const
+{
+	return m_retired.load(std::memory_order_acquire);
+}
+
+uint8_t* reserveSlow(uint32_t size, LogRing** ring)
+{
+	uint8_t* record = nullptr;
+	do
+	{
+		if (t_exited)
+		{
+			*ring  = nullptr;
+			record = new uint8_t[size];
+			break;
+		}
+
+		if (!t_ring)
+		{
+			auto& state   = getState();
+			t_owner.ring = std::make_shared<LogRing>(RingCapacity, plat::GetThreadId());
+			t_ring       = t_owner.ring.get();
+
+			std::lock_guard<std::mutex> lock(state.ringMutex);
+			state.rings.push_back(t_owner.ring);
+		}
+
+		*ring  = t_ring;
+		record = t_ring->reserve(size);
+		if (record)
+		{
+			break;
+		}
+
+		// The logging thread is behind, write out
+		// everything here, this ring included.
+		flush();
+		record = t_ring->reserve(size);
+	} while (false);
+	return record;
+}
+
+void commitScratch(uint8_t* record)
+{
+	auto& state = getState();
+	{
+		std::lock_guard<std::mutex> lock(state.outputMutex);
+		formatRecord(state, *reinterpret_cast<RecordHeader*>(record), plat::GetThreadId());
+		writeOutput(state);
+		flushFiles(state);
+	}
+	delete[] record;
+}
+
+void writeSync()
+{
+	auto& state = getState();
+
+	// Files are flushed when asked to or on a crash, like before.
+	std::lock_guard<std::mutex> lock(state.outputMutex);
+	drainRings(state);
+}
+
+void wakeLogThread()
+{
+	auto& state = getState();
+	if (!state.wakePending.exchange(true))
+	{
+		state.threadCond.notify_one();
+	}
+}
+
+uint64_t now()
+{
+	auto time = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+}
+
+}  // namespace detail
+
 void Channel::assert_(const char* szExpression, const char* szFunction, const char* szSourcePath, int nLine, const char* szFormat, ...)
 {
-	if (!m_enabled)
+	if (!isEnabled(Level::kError))
 	{
 		// just always enable assert
 	}
@@ -150,12 +843,24 @@ void Channel::assert_(const char* szExpression, const char* szFunction, const ch
 	va_list stArgList;
 	va_start(stArgList, szFormat);
 	char szTempStr[LOG_STR_BUFFER_LEN + 1] = { 0 };
-	vsprintf_s(szTempStr, LOG_STR_BUFFER_LEN, szFormat, stArgList);
+	std::vsnprintf(szTempStr, LOG_STR_BUFFER_LEN, szFormat, stArgList);
 	char szMsgBoxStr[LOG_STR_BUFFER_LEN + 1] = { 0 };
-	sprintf_s(szMsgBoxStr, LOG_STR_BUFFER_LEN, "[Assert@%s]: %s\n[Cause]: %s\n[Path]: %s(%d): %s", getName().c_str(), szExpression, szTempStr, szSourcePath, nLine, szFunction);
+	std::snprintf(szMsgBoxStr, LOG_STR_BUFFER_LEN, "[Assert@%s]: %s\n[Cause]: %s\n[Path]: %s(%d): %s", getName().c_str(), szExpression, szTempStr, szSourcePath, nLine, szFunction);
 	va_end(stArgList);
 
-	g_logger->critical("[{}]{}({}): [Assert: {}] {}", getName(), szFunction, nLine, szExpression, szTempStr);
+	// Written at once after everything logged before,
+	// the process may not live on.
+	flush();
+	{
+		auto& state = getState();
+
+		std::lock_guard<std::mutex> lock(state.outputMutex);
+		appendFormat(state.buffer, "[%llu][critical][%s]%s(%d): [Assert: %s] %s\n",
+					 static_cast<unsigned long long>(plat::GetThreadId()), getName().c_str(),
+					 szFunction, nLine, szExpression, szTempStr);
+		writeOutput(state);
+		flushFiles(state);
+	}
 
 	showMessageBox("Assertion Fail", szMsgBoxStr);
 
@@ -168,7 +873,7 @@ void Channel::assert_(const char* szExpression, const char* szFunction, const ch
 
 Channel::Channel(const std::string& n) :
 	m_channelNameList(util::str::split(n, '.')),
-	m_enabled(false)
+	m_levelMask(0)
 {
 	auto cc = ChannelContainer::get();
 	cc->add(this);
@@ -176,23 +881,22 @@ Channel::Channel(const std::string& n) :
 
 void Channel::checkSig(const std::string& n)
 {
-	do 
+	do
 	{
-		if (m_enabled)
-		{
-			// Already enabled, shouldn't be disabled again. 
-			break;
-		}
+		auto        separator = n.find(':');
+		std::string name      = n.substr(0, separator);
+		uint32_t    mask      = separator == std::string::npos
+									? LevelMaskAll
+									: levelMask(n.substr(separator + 1));
 
-		if (n == "ALL")
+		if (name == "ALL")
 		{
-			m_enabled = true;
+			setLevelMask(mask);
 			break;
 		}
-		m_enabled = false;
 
 		bool notMatch = false;
-		auto up       = util::str::split(n, '.');
+		auto up       = util::str::split(name, '.');
 		for (size_t i = 0; i < up.size() && i < m_channelNameList.size(); ++i)
 		{
 			if (up[i] != m_channelNameList[i])
@@ -211,11 +915,21 @@ void Channel::checkSig(const std::string& n)
 		// If this name is "Solar.Earth.Asia", should enable
 		if (up.size() <= m_channelNameList.size())
 		{
-			m_enabled = true;
+			setLevelMask(mask);
 		}
 	} while (false);
 }
 
+void Channel::setLevelMask(uint32_t mask)
+{
+	m_levelMask.store(mask, std::memory_order_relaxed);
+}
+
+uint32_t Channel::getLevelMask() const
+{
+	return m_levelMask.load(std::memory_order_relaxed);
+}
+
 std::string Channel::getName()
 {
 	return util::str::concat(m_channelNameList, ".");
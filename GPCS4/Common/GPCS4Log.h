@@ -2,7 +2,10 @@
 
 #include "GPCS4Common.h"
 
+#include <atomic>
+#include <cstring>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace cxxopts
@@ -15,6 +18,58 @@ namespace logsys
 
 	void init(const cxxopts::ParseResult& optResult);
 
+	struct OutputDesc
+	{
+		// File the log is also written to, empty for none.
+		std::string filePath;
+		// Write to stderr, and the debugger output on Windows.
+		bool console;
+		// Format messages on the logging thread instead of
+		// the thread logging them.
+		bool async;
+	};
+
+	/**
+	 * \brief Changes where and how messages are written
+	 *
+	 * Messages logged before are written out first.
+	 */
+	void setOutput(const OutputDesc& desc);
+
+	/**
+	 * \brief Formats and writes every message logged so far
+	 *
+	 * Can be called from any thread.
+	 */
+	void flush();
+
+	/**
+	 * \brief Stops the logging thread
+	 *
+	 * Messages logged later are written by the thread logging them.
+	 */
+	void shutdown();
+
+	using CrashCallback = void (*)();
+
+	/**
+	 * \brief Adds a function called when the process crashes
+	 *
+	 * Called on the crashing thread before the log is flushed,
+	 * to write out state worth having in a crash report.
+	 * \returns False if too many are registered already
+	 */
+	bool addCrashCallback(CrashCallback callback);
+
+	/**
+	 * \brief Sets the levels of channels at runtime
+	 *
+	 * \param [in] spec Channel name or prefix, 'ALL' for all channels,
+	 *                  optionally followed by ':' and the lowest level
+	 *                  logged, one of trace, debug, fixme, warn, error, off.
+	 */
+	void setLevel(const std::string& spec);
+
 	enum class Level : int
 	{
 		kTrace,
@@ -26,22 +81,343 @@ namespace logsys
 		kSceGraphic,
 	};
 
+	// One bit per level.
+	constexpr uint32_t LevelMaskAll = 0x7F;
+
+	namespace detail
+	{
+		// Type of an argument stored in a log record.
+		enum class ArgType : uint32_t
+		{
+			kInt,
+			kDouble,
+			kString,
+		};
+
+		// Types take 2 bits each of RecordHeader::argTypes.
+		constexpr uint32_t MaxArgCount = 32;
+		// String arguments of a message are cut to this many bytes in total.
+		constexpr uint32_t MaxStringBytes = 0x2000;
+		// Level of the record filling the end of a ring before it wraps.
+		constexpr uint16_t PaddingLevel = 0xFFFF;
+
+		// A message as logged, followed by one 8 byte slot per
+		// argument, then string arguments, each null terminated.
+		// The format and function are literals, so only their
+		// address is kept.
+		struct RecordHeader
+		{
+			// Bytes of the record, arguments included, multiple of 8.
+			uint32_t    size;
+			uint16_t    level;
+			uint16_t    argCount;
+			int32_t     line;
+			uint32_t    stringBytes;
+			uint64_t    argTypes;
+			uint64_t    time;
+			const char* function;
+			const char* format;
+		};
+
+		/**
+		 * \brief Records logged by one thread
+		 *
+		 * Only the owning thread writes records. Whoever holds the
+		 * output lock reads them, usually the logging thread, so
+		 * logging takes no lock.
+		 */
+		class LogRing
+		{
+		public:
+			LogRing(uint32_t capacity, uint64_t threadId);
+			~LogRing();
+
+			/**
+			 * \brief Room for a record of size bytes
+			 *
+			 * \returns Null if the ring is full
+			 */
+			uint8_t* reserve(uint32_t size)
+			{
+				uint8_t* record = nullptr;
+				do
+				{
+					uint64_t head       = m_head.load(std::memory_order_relaxed);
+					uint32_t offset     = static_cast<uint32_t>(head) & m_mask;
+					uint32_t contiguous = m_capacity - offset;
+					uint32_t padding    = size > contiguous ? contiguous : 0;
+					uint64_t end        = head + padding + size;
+					if (end - m_cachedTail > m_capacity)
+					{
+						m_cachedTail = m_tail.load(std::memory_order_acquire);
+						if (end - m_cachedTail > m_capacity)
+						{
+							break;
+						}
+					}
+
+					if (padding != 0)
+					{
+						auto header   = reinterpret_cast<RecordHeader*>(m_buffer + offset);
+						header->size  = padding;
+						header->level = PaddingLevel;
+						offset        = 0;
+					}
+
+					m_pending = padding + size;
+					record    = m_buffer + offset;
+				} while (false);
+				return record;
+			}
+
+			// Publishes the record last reserved.
+			void commit()
+			{
+				m_head.store(m_head.load(std::memory_order_relaxed) + m_pending, std::memory_order_release);
+			}
+
+			// Whether the logging thread should be woken up early.
+			bool isHalfFull()
+			{
+				uint64_t head = m_head.load(std::memory_order_relaxed);
+				if (head - m_cachedTail > m_capacity / 2)
+				{
+					m_cachedTail = m_tail.load(std::memory_order_acquire);
+				}
+				return head - m_cachedTail > m_capacity / 2;
+			}
+
+			/**
+			 * \brief Oldest record not read yet
+			 *
+			 * For the output lock holder only.
+			 * \returns Null if there's none
+			 */
+			const RecordHeader* peek();
+
+			// Frees the record returned by peek.
+			void release(const RecordHeader* record);
+
+			uint64_t threadId() const;
+
+			// The owning thread exited, the ring is freed once read.
+			void retire();
+
+			bool isRetired() const;
+
+		private:
+			uint8_t* m_buffer;
+			uint32_t m_capacity;
+			uint32_t m_mask;
+			uint64_t m_threadId;
+
+			// Owning thread.
+			alignas(64) std::atomic<uint64_t> m_head = { 0 };
+			uint64_t m_cachedTail = 0;
+			uint32_t m_pending    = 0;
+
+			// Output lock holder.
+			alignas(64) std::atomic<uint64_t> m_tail = { 0 };
+			std::atomic<bool> m_retired              = { false };
+		};
+
+		inline thread_local LogRing* t_ring = nullptr;
+
+		extern std::atomic<bool> g_async;
+
+		/**
+		 * \brief Room for a record when the fast path has none
+		 *
+		 * Creates the ring of the thread, or writes out records
+		 * until there's room. Once the thread's ring is gone at
+		 * thread exit, returns a scratch buffer and clears ring.
+		 */
+		uint8_t* reserveSlow(uint32_t size, LogRing** ring);
+
+		// Writes out a record of the scratch buffer.
+		void commitScratch(uint8_t* record);
+
+		// Writes out the rings without the logging thread.
+		void writeSync();
+
+		void wakeLogThread();
+
+		uint64_t now();
+
+		template <typename T>
+		constexpr ArgType argType()
+		{
+			return std::is_same_v<T, char*> || std::is_same_v<T, const char*>
+					   ? ArgType::kString
+				   : std::is_floating_point_v<T>
+					   ? ArgType::kDouble
+					   : ArgType::kInt;
+		}
+
+		template <typename... Args>
+		constexpr uint64_t argTypes()
+		{
+			uint64_t types = 0;
+			uint32_t index = 0;
+			((types |= static_cast<uint64_t>(argType<Args>()) << (2 * index++)), ...);
+			return types;
+		}
+
+		template <typename T>
+		const char* stringArg(T arg)
+		{
+			const char* string = nullptr;
+			if constexpr (argType<T>() == ArgType::kString)
+			{
+				string = arg ? arg : "(null)";
+			}
+			return string;
+		}
+
+		template <typename T>
+		uint32_t stringLength(T arg)
+		{
+			uint32_t length = 0;
+			if constexpr (argType<T>() == ArgType::kString)
+			{
+				length = static_cast<uint32_t>(std::strlen(stringArg(arg)));
+			}
+			return length;
+		}
+
+		// Integers keep their sign in 64 bits, the format
+		// specification gives the size they were logged as.
+		template <typename T>
+		uint64_t argValue(T arg)
+		{
+			uint64_t value = 0;
+			if constexpr (std::is_floating_point_v<T>)
+			{
+				double number = static_cast<double>(arg);
+				std::memcpy(&value, &number, sizeof(number));
+			}
+			else if constexpr (std::is_pointer_v<T>)
+			{
+				value = reinterpret_cast<uintptr_t>(arg);
+			}
+			else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>)
+			{
+				value = static_cast<uint64_t>(static_cast<int64_t>(arg));
+			}
+			else if constexpr (!std::is_null_pointer_v<T>)
+			{
+				static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(uint64_t),
+							  "unsupported log argument type");
+				std::memcpy(&value, &arg, sizeof(T));
+			}
+			return value;
+		}
+
+		template <typename T>
+		void writeArg(T arg, uint64_t* slots, char*& strings, const uint32_t* lengths, uint32_t& index)
+		{
+			// Strings keep their address too, for %p.
+			slots[index] = argValue(arg);
+			if constexpr (argType<T>() == ArgType::kString)
+			{
+				std::memcpy(strings, stringArg(arg), lengths[index]);
+				strings[lengths[index]] = 0;
+				strings += lengths[index] + 1;
+			}
+			++index;
+		}
+
+	}  // namespace detail
+
 	class Channel
 	{
 	public:
 		Channel(const std::string& n);
 
-		void print(Level nLevel, const char* szFunction, const char* szSourcePath, int nLine, const char* szFormat, ...);
+		// The only check a disabled message costs.
+		bool isEnabled(Level nLevel) const
+		{
+			return (m_levelMask.load(std::memory_order_relaxed) >> static_cast<uint32_t>(nLevel)) & 1;
+		}
+
+		// Stores the arguments, formatting is left to the logging thread.
+		// They're passed by value like to printf, arrays as pointers.
+		template <typename... Args>
+		void print(Level nLevel, const char* szFunction, int nLine, const char* szFormat, Args... args);
+
 		void assert_(const char* szExpression, const char* szFunction, const char* szSourcePath, int nLine, const char* szFormat, ...);
 
 		void        checkSig(const std::string& n);
+		void        setLevelMask(uint32_t mask);
+		uint32_t    getLevelMask() const;
 		std::string getName();
 
 	private:
 		const std::vector<std::string> m_channelNameList;
-		bool                           m_enabled;
+		std::atomic<uint32_t>          m_levelMask;
 	};
 
+	template <typename... Args>
+	void Channel::print(Level nLevel, const char* szFunction, int nLine, const char* szFormat, Args... args)
+	{
+		using namespace detail;
+
+		constexpr uint32_t argCount = sizeof...(Args);
+		static_assert(argCount <= MaxArgCount, "too many log arguments");
+
+		constexpr bool isString[argCount + 1] = { (argType<Args>() == ArgType::kString)..., false };
+
+		uint32_t lengths[argCount + 1] = { stringLength(args)... };
+		uint32_t stringBytes           = 0;
+		for (uint32_t i = 0; i != argCount; ++i)
+		{
+			uint32_t room = stringBytes < MaxStringBytes ? MaxStringBytes - stringBytes : 0;
+			lengths[i]    = lengths[i] < room ? lengths[i] : room;
+			stringBytes += isString[i] ? lengths[i] + 1 : 0;
+		}
+
+		uint32_t size   = (sizeof(RecordHeader) + argCount * sizeof(uint64_t) + stringBytes + 7) & ~7u;
+		LogRing* ring   = t_ring;
+		uint8_t* record = ring ? ring->reserve(size) : nullptr;
+		if (!record)
+		{
+			record = reserveSlow(size, &ring);
+		}
+
+		auto header         = reinterpret_cast<RecordHeader*>(record);
+		header->size        = size;
+		header->level       = static_cast<uint16_t>(nLevel);
+		header->argCount    = argCount;
+		header->line        = nLine;
+		header->stringBytes = stringBytes;
+		header->argTypes    = argTypes<Args...>();
+		header->time        = now();
+		header->function    = szFunction;
+		header->format      = szFormat;
+
+		auto     slots   = reinterpret_cast<uint64_t*>(header + 1);
+		auto     strings = reinterpret_cast<char*>(slots + argCount);
+		uint32_t index   = 0;
+		(writeArg(args, slots, strings, lengths, index), ...);
+
+		if (!ring)
+		{
+			commitScratch(record);
+		}
+		else
+		{
+			ring->commit();
+			if (!g_async.load(std::memory_order_relaxed))
+			{
+				writeSync();
+			}
+			else if (ring->isHalfFull())
+			{
+				wakeLogThread();
+			}
+		}
+	}
+
 	class ChannelContainer
 	{
 	public:
@@ -59,9 +435,10 @@ namespace logsys
 }  // namespace logsys
 
 //do not use these directly
-#define _LOG_PRINT_(level, format, ...)    __logger_handle.print(level, __FUNCTION__, __FILE__, __LINE__, format, __VA_ARGS__)
+// Formats must be literals, only their address is stored.
+#define _LOG_PRINT_(level, format, ...)    (void)(!__logger_handle.isEnabled(level) || (__logger_handle.print(level, __FUNCTION__, __LINE__, "" format, __VA_ARGS__), 0))
 #define _LOG_ASSERT_(expr, format, ...)    (void)(!!(expr) || (__logger_handle.assert_(#expr, __FUNCTION__, __FILE__, __LINE__, format, __VA_ARGS__), 0))
-#define _LOG_IF_(expr, level, format, ...) (void)(!!(expr) && (__logger_handle.print(level, __FUNCTION__, __FILE__, __LINE__, format, __VA_ARGS__), 0))
+#define _LOG_IF_(expr, level, format, ...) (void)(!!(expr) && __logger_handle.isEnabled(level) && (__logger_handle.print(level, __FUNCTION__, __LINE__, "" format, __VA_ARGS__), 0))
 
 #ifdef GPCS4_DEBUG
 
@@ -136,4 +513,4 @@ namespace logsys
 #define LOG_SCE_DUMMY_IMPL()
 #define LOG_GCN_UNHANDLED_INST()
 
-#endif  // GPCS4_DEBUG
\ No newline at end of file
+#endif  // GPCS4_DEBUG
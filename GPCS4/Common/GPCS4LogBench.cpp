@@ -0,0 +1,289 @@
+#include "GPCS4LogBench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+namespace logsys
+{
+	// Not LOG_CHANNEL, the bench logs in release builds too.
+	static Channel g_benchChannel("Common.GPCS4LogBench");
+
+#define BENCH_LOG(level, format, ...) \
+	(void)(!g_benchChannel.isEnabled(level) || (g_benchChannel.print(level, __FUNCTION__, __LINE__, format, __VA_ARGS__), 0))
+
+	// Messages logged between writing them out.
+	constexpr uint32_t LogBenchBurstSize = 256;
+
+	enum class BenchEnum : int32_t
+	{
+		kValue = 3,
+	};
+
+	template <typename... Args>
+	static std::string printfString(const char* format, Args... args)
+	{
+		char text[256] = {};
+		std::snprintf(text, sizeof(text), format, args...);
+		return text;
+	}
+
+	static double elapsedNs(std::chrono::high_resolution_clock::time_point start)
+	{
+		auto elapsed = std::chrono::high_resolution_clock::now() - start;
+		return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+	}
+
+	LogBench::LogBench(const LogBenchDesc& desc) :
+		m_desc(desc)
+	{
+	}
+
+	LogBench::~LogBench()
+	{
+	}
+
+	bool LogBench::run()
+	{
+		bool ret = false;
+		do
+		{
+			if (m_desc.messageCount == 0 || m_desc.threadCount == 0)
+			{
+				std::printf("Nothing to run, message or thread count is 0.\n");
+				break;
+			}
+
+			if (!checkFormat() || !checkLevels())
+			{
+				break;
+			}
+
+			std::printf("Messages       : %u per thread, %u threads\n", m_desc.messageCount, m_desc.threadCount);
+			std::printf("  %-13s: %.1f ns per call\n", "disabled", runDisabled());
+
+			if (!runEnabled(false) || !runEnabled(true))
+			{
+				break;
+			}
+
+			ret = true;
+		} while (false);
+
+		g_benchChannel.setLevelMask(0);
+		setOutput({ "", true, true });
+		return ret;
+	}
+
+	bool LogBench::checkFormat()
+	{
+		bool ret = false;
+		do
+		{
+			setOutput({ m_desc.filePath, false, false });
+			std::vector<std::string> expected;
+
+#define CHECK_FORMAT_AS(text, format, ...)  \
+	expected.push_back(text);               \
+	BENCH_LOG(Level::kDebug, format, __VA_ARGS__)
+#define CHECK_FORMAT(format, ...) CHECK_FORMAT_AS(printfString(format, __VA_ARGS__), format, __VA_ARGS__)
+
+			int32_t     negative = -42;
+			uint16_t    port     = 0xBEEF;
+			int64_t     big      = -0x123456789LL;
+			uint64_t    ubig     = 0xFEDCBA9876543210ULL;
+			double      pi       = 3.14159265358979;
+			float       half     = 0.5f;
+			const char* name     = "pad0";
+			const char* null     = nullptr;
+			char        buffer[] = "stack buffer";
+
+			// Filtered out before anything is stored.
+			g_benchChannel.setLevelMask(1u << static_cast<uint32_t>(Level::kWarning));
+			BENCH_LOG(Level::kDebug, "dropped %d", 1);
+			g_benchChannel.setLevelMask(LevelMaskAll);
+
+			CHECK_FORMAT("%d %i %u", negative, negative, negative);
+			CHECK_FORMAT("%x %X %o %#x", negative, port, port, port);
+			CHECK_FORMAT("%hd %hhx %hu", negative, negative, port);
+			CHECK_FORMAT("%lld %llx %llu", big, ubig, ubig);
+			CHECK_FORMAT("%ld %lu %zu %zd", -5L, 7UL, sizeof(buffer), static_cast<ptrdiff_t>(-7));
+			CHECK_FORMAT("%5d|%-5d|%05d|%+d", negative, negative, negative, negative);
+			CHECK_FORMAT("%*d|%-*d|%.*f", 6, negative, 6, negative, 2, pi);
+			CHECK_FORMAT("%f %.3f %e %g %10.4f", pi, pi, pi, pi, half);
+			CHECK_FORMAT("%s|%8s|%-8s|%.2s", name, name, name, name);
+			CHECK_FORMAT("%s %p %p", buffer, &negative, name);
+			CHECK_FORMAT("%c%c%c %d", 'G', 'P', 'U', true);
+			CHECK_FORMAT("100%% %s", name);
+			CHECK_FORMAT("%s", "no arguments");
+			CHECK_FORMAT_AS(printfString("%llx", ubig), "%I64x", ubig);
+			CHECK_FORMAT_AS("3 (null)", "%d %s", BenchEnum::kValue, null);
+			CHECK_FORMAT_AS("1 %d", "%d %d", 1);
+
+#undef CHECK_FORMAT
+#undef CHECK_FORMAT_AS
+
+			std::vector<std::string> messages;
+			if (!readMessages(&messages) || messages != expected)
+			{
+				std::printf("Formatting messages failed.\n");
+				for (size_t i = 0; i != messages.size() && i != expected.size(); ++i)
+				{
+					if (messages[i] != expected[i])
+					{
+						std::printf("  '%s', expected '%s'\n", messages[i].c_str(), expected[i].c_str());
+					}
+				}
+				break;
+			}
+
+			ret = true;
+		} while (false);
+		return ret;
+	}
+
+	bool LogBench::checkLevels()
+	{
+		auto enabled = [](std::initializer_list<Level> levels)
+		{
+			uint32_t mask = 0;
+			for (auto level : levels)
+			{
+				mask |= 1u << static_cast<uint32_t>(level);
+			}
+			return g_benchChannel.getLevelMask() == mask;
+		};
+
+		bool passed = true;
+
+		g_benchChannel.checkSig("Common:warn");
+		passed &= enabled({ Level::kWarning, Level::kError });
+		// Other channels, and channels below this one.
+		g_benchChannel.checkSig("Graphic:trace");
+		g_benchChannel.checkSig("Common.GPCS4LogBench.Sub");
+		passed &= enabled({ Level::kWarning, Level::kError });
+		g_benchChannel.checkSig("Common.GPCS4LogBench:debug");
+		passed &= enabled({ Level::kDebug, Level::kFixme, Level::kWarning, Level::kError });
+		g_benchChannel.checkSig("ALL:off");
+		passed &= g_benchChannel.getLevelMask() == 0 && !g_benchChannel.isEnabled(Level::kError);
+		g_benchChannel.checkSig("ALL");
+		passed &= g_benchChannel.getLevelMask() == LevelMaskAll && g_benchChannel.isEnabled(Level::kSceGraphic);
+
+		if (!passed)
+		{
+			std::printf("Channel levels are wrong.\n");
+		}
+		return passed;
+	}
+
+	double LogBench::runDisabled()
+	{
+		g_benchChannel.setLevelMask(0);
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i != m_desc.messageCount; ++i)
+		{
+			BENCH_LOG(Level::kSceTrace, "ptr %p size %zu align %u", &start, static_cast<size_t>(i) * 16, i);
+		}
+		return elapsedNs(start) / m_desc.messageCount;
+	}
+
+	bool LogBench::runEnabled(bool async)
+	{
+		bool ret = false;
+		do
+		{
+			setOutput({ m_desc.filePath, false, async });
+			g_benchChannel.setLevelMask(LevelMaskAll);
+
+			// Each thread logs like an HLE function traces its call.
+			// Calls are timed in bursts, so the time the logging thread
+			// spends writing them out isn't counted as the callers' cost.
+			std::atomic<uint64_t>    callTime  = { 0 };
+			std::atomic<uint64_t>    writeTime = { 0 };
+			std::vector<std::thread> threads;
+			for (uint32_t t = 0; t != m_desc.threadCount; ++t)
+			{
+				threads.emplace_back([this, t, &callTime, &writeTime]()
+									 {
+										 uint32_t i = 0;
+										 while (i != m_desc.messageCount)
+										 {
+											 uint32_t end   = std::min(m_desc.messageCount, i + LogBenchBurstSize);
+											 auto     start = std::chrono::high_resolution_clock::now();
+											 for (; i != end; ++i)
+											 {
+												 BENCH_LOG(Level::kSceTrace, "thread %u seq %u ptr %p size %zu name %s",
+														   t, i, &start, static_cast<size_t>(i) * 16, "bench");
+											 }
+											 callTime += static_cast<uint64_t>(elapsedNs(start));
+
+											 start = std::chrono::high_resolution_clock::now();
+											 flush();
+											 writeTime += static_cast<uint64_t>(elapsedNs(start));
+										 }
+									 });
+			}
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+
+			// Every message once, in order.
+			std::vector<std::string> messages;
+			std::vector<uint32_t>    next(m_desc.threadCount, 0);
+			bool                     passed = readMessages(&messages);
+			for (const auto& message : messages)
+			{
+				uint32_t thread = 0;
+				uint32_t seq    = 0;
+				passed &= std::sscanf(message.c_str(), "thread %u seq %u", &thread, &seq) == 2 &&
+						  thread < m_desc.threadCount && next[thread]++ == seq;
+			}
+			passed &= messages.size() == static_cast<size_t>(m_desc.messageCount) * m_desc.threadCount;
+
+			double messageCount = static_cast<double>(m_desc.messageCount) * m_desc.threadCount;
+			std::printf("  %-13s: %.1f ns per call, %.1f ns per message written out, %zu messages\n",
+						async ? "async" : "sync", callTime / messageCount, writeTime / messageCount, messages.size());
+
+			if (!passed)
+			{
+				std::printf("Written messages are wrong.\n");
+				break;
+			}
+
+			ret = true;
+		} while (false);
+		return ret;
+	}
+
+	bool LogBench::readMessages(std::vector<std::string>* messages)
+	{
+		bool ret = false;
+		do
+		{
+			flush();
+
+			std::ifstream file(m_desc.filePath);
+			if (!file)
+			{
+				std::printf("open %s failed\n", m_desc.filePath.c_str());
+				break;
+			}
+
+			// The message follows "function(line): ".
+			std::string line;
+			while (std::getline(file, line))
+			{
+				auto pos = line.find("): ");
+				messages->push_back(pos == std::string::npos ? line : line.substr(pos + 3));
+			}
+
+			ret = true;
+		} while (false);
+		return ret;
+	}
+
+}  // namespace logsys
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "GPCS4Common.h"
+
+#include <string>
+#include <vector>
+
+namespace logsys
+{
+	struct LogBenchDesc
+	{
+		// Messages each thread logs in each test.
+		uint32_t messageCount;
+		// Threads logging at once.
+		uint32_t threadCount;
+		// File the messages are written to.
+		std::string filePath;
+	};
+
+	/**
+	 * \brief Logging cost benchmark
+	 *
+	 * Checks that stored messages format like printf would
+	 * and that channel levels filter them, then reports the
+	 * cost of a log call with its channel disabled, and
+	 * enabled with messages formatted on the logging thread
+	 * or on the thread logging them, as before. Every message
+	 * written is checked to be there once and in order.
+	 */
+	class LogBench
+	{
+	public:
+		LogBench(const LogBenchDesc& desc);
+		~LogBench();
+
+		bool run();
+
+	private:
+		bool checkFormat();
+
+		bool checkLevels();
+
+		double runDisabled();
+
+		bool runEnabled(bool async);
+
+		bool readMessages(std::vector<std::string>* messages);
+
+	private:
+		LogBenchDesc m_desc;
+	};
+
+}  // namespace logsys
@@ -0,0 +1,250 @@
+#include "SceJobBench.h"
+#include "SceJobScheduler.h"
+#include "Emulator/ThreadAffinity.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+
+LOG_CHANNEL(Common.SceJobBench);
+
+// A few hundred nanoseconds of work,
+// close to a small game job.
+constexpr uint32_t JobBenchWorkCount = 256;
+
+// Jobs in each group of the chain test.
+constexpr uint32_t JobBenchChainWidth = 64;
+
+thread_local static volatile uint32_t t_jobBenchSink = 0;
+
+struct JobBenchContext
+{
+	CSceJobScheduler*     scheduler;
+	CSceJobGroup*         group;
+	std::atomic<uint64_t> doneCount;
+};
+
+struct JobBenchTreeNode
+{
+	JobBenchContext* context;
+	uint32_t         jobCount;
+};
+
+static void jobBenchWork(JobBenchContext* context)
+{
+	uint32_t value = 1;
+	for (uint32_t i = 0; i != JobBenchWorkCount; ++i)
+	{
+		value = value * 1664525 + 1013904223;
+	}
+	// Keep the loop from being optimized out.
+	t_jobBenchSink = value;
+	context->doneCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void jobBenchFlatJob(void* arg)
+{
+	jobBenchWork(reinterpret_cast<JobBenchContext*>(arg));
+}
+
+static void jobBenchTreeJob(void* arg)
+{
+	auto node    = reinterpret_cast<JobBenchTreeNode*>(arg);
+	auto context = node->context;
+
+	// Split the remaining jobs in two halves,
+	// children are pushed to this worker's deque.
+	uint32_t childCount = node->jobCount - 1;
+	uint32_t leftCount  = childCount / 2;
+	uint32_t rightCount = childCount - leftCount;
+	delete node;
+
+	jobBenchWork(context);
+
+	if (leftCount)
+	{
+		context->scheduler->Submit(jobBenchTreeJob,
+								   new JobBenchTreeNode{ context, leftCount },
+								   context->group);
+	}
+	if (rightCount)
+	{
+		context->scheduler->Submit(jobBenchTreeJob,
+								   new JobBenchTreeNode{ context, rightCount },
+								   context->group);
+	}
+}
+
+
+CSceJobBench::CSceJobBench(const SceJobBenchDesc& desc) :
+	m_desc(desc)
+{
+}
+
+CSceJobBench::~CSceJobBench()
+{
+}
+
+bool CSceJobBench::Run()
+{
+	bool ret = false;
+	do
+	{
+		if (m_desc.jobCount == 0)
+		{
+			std::printf("Nothing to run, job count is 0.\n");
+			break;
+		}
+
+		// Workers run where the guest cores would, like game jobs.
+		ThreadAffinityMapper mapper;
+		if (mapper.initialize(AffinityMode::Strict, 0))
+		{
+			for (uint32_t i = 0; i != CSceJobScheduler::DefaultWorkerCount; ++i)
+			{
+				m_workerMasks.push_back(mapper.mapGuestMask(1ull << i));
+			}
+		}
+
+		std::printf("Jobs per test  : %u, %u workers, %u host threads, %s\n",
+					m_desc.jobCount,
+					CSceJobScheduler::DefaultWorkerCount,
+					std::thread::hardware_concurrency(),
+					m_workerMasks.empty() ? "not pinned" : "pinned");
+
+		if (!RunFlat() || !RunTree() || !RunChain())
+		{
+			break;
+		}
+
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+bool CSceJobBench::RunFlat()
+{
+	bool ret = false;
+	do
+	{
+		CSceJobScheduler scheduler(CSceJobScheduler::DefaultWorkerCount, m_workerMasks);
+		CSceJobGroup     group;
+		JobBenchContext  context = { &scheduler, &group, { 0 } };
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i != m_desc.jobCount; ++i)
+		{
+			scheduler.Submit(jobBenchFlatJob, &context, &group);
+		}
+		scheduler.Wait(&group);
+		auto end = std::chrono::high_resolution_clock::now();
+
+		if (context.doneCount != m_desc.jobCount)
+		{
+			std::printf("Flat test ran %llu jobs, expected %u.\n",
+						static_cast<unsigned long long>(context.doneCount.load()),
+						m_desc.jobCount);
+			break;
+		}
+
+		Report("Flat", m_desc.jobCount, std::chrono::duration<double>(end - start).count(),
+			   scheduler.GetStats());
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+bool CSceJobBench::RunTree()
+{
+	bool ret = false;
+	do
+	{
+		CSceJobScheduler scheduler(CSceJobScheduler::DefaultWorkerCount, m_workerMasks);
+		CSceJobGroup     group;
+		JobBenchContext  context = { &scheduler, &group, { 0 } };
+
+		auto start = std::chrono::high_resolution_clock::now();
+		scheduler.Submit(jobBenchTreeJob,
+						 new JobBenchTreeNode{ &context, m_desc.jobCount },
+						 &group);
+		scheduler.Wait(&group);
+		auto end = std::chrono::high_resolution_clock::now();
+
+		if (context.doneCount != m_desc.jobCount)
+		{
+			std::printf("Tree test ran %llu jobs, expected %u.\n",
+						static_cast<unsigned long long>(context.doneCount.load()),
+						m_desc.jobCount);
+			break;
+		}
+
+		Report("Tree", m_desc.jobCount, std::chrono::duration<double>(end - start).count(),
+			   scheduler.GetStats());
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+bool CSceJobBench::RunChain()
+{
+	bool ret = false;
+	do
+	{
+		CSceJobScheduler scheduler(CSceJobScheduler::DefaultWorkerCount, m_workerMasks);
+		JobBenchContext  context = { &scheduler, nullptr, { 0 } };
+
+		// Each group only starts once the previous one is done,
+		// this measures how fast dependencies are released.
+		uint32_t groupCount = (m_desc.jobCount + JobBenchChainWidth - 1) / JobBenchChainWidth;
+		auto     groups     = std::make_unique<CSceJobGroup[]>(groupCount);
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i != groupCount; ++i)
+		{
+			CSceJobGroup* previous = i != 0 ? &groups[i - 1] : nullptr;
+			uint32_t      width    = std::min(JobBenchChainWidth, m_desc.jobCount - i * JobBenchChainWidth);
+			for (uint32_t j = 0; j != width; ++j)
+			{
+				scheduler.Submit(jobBenchFlatJob, &context, &groups[i],
+								 previous ? &previous : nullptr, previous ? 1 : 0);
+			}
+		}
+		scheduler.Wait(&groups[groupCount - 1]);
+		auto end = std::chrono::high_resolution_clock::now();
+
+		// Earlier groups are done once the last one is.
+		if (context.doneCount != m_desc.jobCount)
+		{
+			std::printf("Chain test ran %llu jobs, expected %u.\n",
+						static_cast<unsigned long long>(context.doneCount.load()),
+						m_desc.jobCount);
+			break;
+		}
+
+		Report("Chain", m_desc.jobCount, std::chrono::duration<double>(end - start).count(),
+			   scheduler.GetStats());
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+void CSceJobBench::Report(const char* name, uint64_t jobCount, double seconds,
+	const SceJobSchedulerStats& stats)
+{
+	std::printf("%-15s: %.3f ms, %.2f M jobs/s, %.1f ns per job\n",
+				name,
+				seconds * 1000.0,
+				jobCount / seconds / 1000000.0,
+				seconds * 1000000000.0 / jobCount);
+	std::printf("  Steals       : %llu of %llu attempts\n",
+				static_cast<unsigned long long>(stats.stealCount),
+				static_cast<unsigned long long>(stats.stealAttemptCount));
+	std::printf("  Injected     : %llu\n",
+				static_cast<unsigned long long>(stats.injectCount));
+	std::printf("  Max depth    : %llu\n",
+				static_cast<unsigned long long>(stats.maxQueueDepth));
+	std::printf("  Idle time    : %.3f ms over all workers\n",
+				stats.idleTimeNs / 1000000.0);
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "GPCS4Common.h"
+
+#include <vector>
+
+struct SceJobSchedulerStats;
+
+
+struct SceJobBenchDesc
+{
+	// Number of jobs run by each test.
+	uint32_t jobCount;
+};
+
+
+// Measures job throughput of the work stealing scheduler.
+//
+// The flat test submits every job from the main thread,
+// the tree test starts from a single job which spawns
+// its children on the workers, so they spread by stealing,
+// and the chain test runs groups which depend on each other.
+
+class CSceJobBench
+{
+public:
+	CSceJobBench(const SceJobBenchDesc& desc);
+	~CSceJobBench();
+
+	bool Run();
+
+private:
+	bool RunFlat();
+
+	bool RunTree();
+
+	bool RunChain();
+
+	void Report(const char* name, uint64_t jobCount, double seconds,
+		const SceJobSchedulerStats& stats);
+
+private:
+	SceJobBenchDesc m_desc;
+	// Host processors of each worker, from the guest cores.
+	std::vector<uint64_t> m_workerMasks;
+};
@@ -0,0 +1,125 @@
+#include "SceJobDeque.h"
+#include "UtilMath.h"
+
+CSceJobDeque::Buffer::Buffer(int64_t capacity) :
+	mask(capacity - 1),
+	jobs(std::make_unique<std::atomic<SceJob*>[]>(capacity))
+{
+}
+
+int64_t CSceJobDeque::Buffer::Capacity() const
+{
+	return mask + 1;
+}
+
+SceJob* CSceJobDeque::Buffer::Get(int64_t index) const
+{
+	return jobs[index & mask].load(std::memory_order_relaxed);
+}
+
+void CSceJobDeque::Buffer::Put(int64_t index, SceJob* job)
+{
+	jobs[index & mask].store(job, std::memory_order_relaxed);
+}
+
+
+CSceJobDeque::CSceJobDeque(uint32_t initialCapacity) :
+	m_top(0),
+	m_bottom(0)
+{
+	LOG_ASSERT(util::isPowerOfTwo(initialCapacity), "capacity must be power of 2.");
+	m_buffers.push_back(std::make_unique<Buffer>(initialCapacity));
+	m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+}
+
+CSceJobDeque::~CSceJobDeque()
+{
+}
+
+void CSceJobDeque::Push(SceJob* job)
+{
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+	int64_t top    = m_top.load(std::memory_order_acquire);
+	Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+
+	if (bottom - top > buffer->Capacity() - 1)
+	{
+		buffer = Grow(buffer, bottom, top);
+	}
+
+	buffer->Put(bottom, job);
+	m_bottom.store(bottom + 1, std::memory_order_release);
+}
+
+SceJob* CSceJobDeque::Take()
+{
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+	Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+	m_bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t top = m_top.load(std::memory_order_relaxed);
+
+	SceJob* job = nullptr;
+	if (top <= bottom)
+	{
+		job = buffer->Get(bottom);
+		if (top == bottom)
+		{
+			// Last job, race against thieves.
+			if (!m_top.compare_exchange_strong(top, top + 1,
+											   std::memory_order_seq_cst,
+											   std::memory_order_relaxed))
+			{
+				job = nullptr;
+			}
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+	}
+	else
+	{
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+SceJob* CSceJobDeque::Steal()
+{
+	int64_t top = m_top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+	SceJob* job = nullptr;
+	if (top < bottom)
+	{
+		Buffer* buffer = m_buffer.load(std::memory_order_acquire);
+		job            = buffer->Get(top);
+		if (!m_top.compare_exchange_strong(top, top + 1,
+										   std::memory_order_seq_cst,
+										   std::memory_order_relaxed))
+		{
+			job = nullptr;
+		}
+	}
+	return job;
+}
+
+int64_t CSceJobDeque::Size() const
+{
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+	int64_t top    = m_top.load(std::memory_order_relaxed);
+	return bottom > top ? bottom - top : 0;
+}
+
+CSceJobDeque::Buffer* CSceJobDeque::Grow(Buffer* buffer, int64_t bottom, int64_t top)
+{
+	auto newBuffer = std::make_unique<Buffer>(buffer->Capacity() * 2);
+	for (int64_t i = top; i != bottom; ++i)
+	{
+		newBuffer->Put(i, buffer->Get(i));
+	}
+
+	Buffer* result = newBuffer.get();
+	m_buffers.push_back(std::move(newBuffer));
+	m_buffer.store(result, std::memory_order_release);
+	return result;
+}
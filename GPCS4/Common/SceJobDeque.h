@@ -0,0 +1,58 @@
+#pragma once
+#include "GPCS4Common.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+struct SceJob;
+
+// Chase-Lev work stealing deque.
+//
+// The owner worker pushes and takes jobs at the bottom,
+// other workers steal from the top. Only steals and the
+// take of the last job synchronize with a CAS.
+// Memory orders follow Le et al., "Correct and Efficient
+// Work-Stealing for Weak Memory Models".
+
+class CSceJobDeque
+{
+public:
+	CSceJobDeque(uint32_t initialCapacity = 256);
+	~CSceJobDeque();
+
+	// Owner only
+	void Push(SceJob* job);
+
+	// Owner only, nullptr if empty
+	SceJob* Take();
+
+	// Any thread, nullptr if empty or lost a race
+	SceJob* Steal();
+
+	// Approximate, for statistics
+	int64_t Size() const;
+
+private:
+	struct Buffer
+	{
+		Buffer(int64_t capacity);
+
+		int64_t Capacity() const;
+		SceJob* Get(int64_t index) const;
+		void    Put(int64_t index, SceJob* job);
+
+		int64_t                               mask;
+		std::unique_ptr<std::atomic<SceJob*>[]> jobs;
+	};
+
+	Buffer* Grow(Buffer* buffer, int64_t bottom, int64_t top);
+
+private:
+	alignas(64) std::atomic<int64_t> m_top;
+	alignas(64) std::atomic<int64_t> m_bottom;
+	alignas(64) std::atomic<Buffer*> m_buffer;
+
+	// Old buffers may still be read by a thief,
+	// keep them until the deque is destroyed.
+	std::vector<std::unique_ptr<Buffer>> m_buffers;
+};
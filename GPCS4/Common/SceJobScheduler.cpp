@@ -0,0 +1,421 @@
+#include "SceJobScheduler.h"
+#include "Platform/PlatThread.h"
+
+#include <algorithm>
+#include <chrono>
+
+LOG_CHANNEL(Common.SceJobScheduler);
+
+// Times a worker looks for a job again before going to sleep,
+// jobs usually come in bursts.
+constexpr uint32_t JobWorkerSpinCount = 64;
+
+// The worker running on this thread, if any.
+thread_local static void* t_job_worker = nullptr;
+
+
+CSceJobGroup::CSceJobGroup() :
+	m_pending(0)
+{
+}
+
+CSceJobGroup::~CSceJobGroup()
+{
+	std::lock_guard lock(m_mutex);
+	LOG_ASSERT(m_pending.load() == 0, "job group destroyed with pending jobs.");
+}
+
+bool CSceJobGroup::IsDone() const
+{
+	return m_pending.load(std::memory_order_acquire) == 0;
+}
+
+void CSceJobGroup::Add(uint32_t count)
+{
+	m_pending.fetch_add(count, std::memory_order_relaxed);
+}
+
+void CSceJobGroup::Finish(std::vector<SceJob*>& released)
+{
+	if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		std::lock_guard lock(m_mutex);
+		released.insert(released.end(), m_dependents.begin(), m_dependents.end());
+		m_dependents.clear();
+		m_cond.notify_all();
+	}
+}
+
+bool CSceJobGroup::AddDependent(SceJob* job)
+{
+	std::lock_guard lock(m_mutex);
+
+	bool added = false;
+	if (m_pending.load(std::memory_order_acquire) != 0)
+	{
+		m_dependents.push_back(job);
+		added = true;
+	}
+	return added;
+}
+
+void CSceJobGroup::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_cond.wait(lock, [this]
+				{ return IsDone(); });
+}
+
+
+CSceJobScheduler::CSceJobScheduler(uint32_t workerCount, const std::vector<uint64_t>& workerMasks) :
+	m_maxInjectDepth(0),
+	m_helperJobCount(0),
+	m_queuedJobs(0),
+	m_sleepers(0),
+	m_stopped(false)
+{
+	workerCount = std::max(workerCount, 1u);
+
+	for (uint32_t i = 0; i != workerCount; ++i)
+	{
+		auto worker        = std::make_unique<Worker>();
+		worker->owner      = this;
+		worker->index      = i;
+		worker->victimSeed = i * 0x9E3779B9 + 1;
+		m_workers.push_back(std::move(worker));
+	}
+
+	ResetStats();
+
+	for (auto& worker : m_workers)
+	{
+		uint64_t mask  = worker->index < workerMasks.size() ? workerMasks[worker->index] : 0;
+		worker->thread = std::thread([this, mask, worker = worker.get()]()
+			{
+				if (mask && !plat::SetThreadAffinity(mask))
+				{
+					LOG_WARN("pin job worker %d to %llx failed.", worker->index, mask);
+				}
+				RunWorker(worker);
+			});
+	}
+}
+
+CSceJobScheduler::~CSceJobScheduler()
+{
+	// Queued jobs are run before the workers exit.
+	{
+		std::lock_guard lock(m_sleepMutex);
+		m_stopped.store(true);
+	}
+	m_sleepCond.notify_all();
+
+	for (auto& worker : m_workers)
+	{
+		worker->thread.join();
+	}
+}
+
+void CSceJobScheduler::Submit(SceJobFunc func, void* arg, CSceJobGroup* group,
+	CSceJobGroup* const* dependencies, uint32_t dependencyCount)
+{
+	SceJob* job = new SceJob();
+	job->func   = func;
+	job->arg    = arg;
+	job->group  = group;
+	job->pendingDependencies.store(dependencyCount + 1, std::memory_order_relaxed);
+
+	if (group)
+	{
+		group->Add(1);
+	}
+
+	// Groups which are done already don't hold the job,
+	// the extra count keeps it from being released
+	// before all dependencies are registered.
+	uint32_t doneCount = 1;
+	for (uint32_t i = 0; i != dependencyCount; ++i)
+	{
+		if (!dependencies[i]->AddDependent(job))
+		{
+			++doneCount;
+		}
+	}
+
+	if (job->pendingDependencies.fetch_sub(doneCount, std::memory_order_acq_rel) == doneCount)
+	{
+		Enqueue(job);
+	}
+}
+
+void CSceJobScheduler::Wait(CSceJobGroup* group)
+{
+	Worker* worker = GetCurrentWorker();
+	while (!group->IsDone())
+	{
+		SceJob* job = FindJob(worker);
+		if (job)
+		{
+			if (!worker)
+			{
+				m_helperJobCount.fetch_add(1, std::memory_order_relaxed);
+			}
+			Execute(job);
+			continue;
+		}
+
+		// Nothing to help with, the remaining jobs
+		// are running on other workers.
+		group->Wait();
+	}
+}
+
+uint32_t CSceJobScheduler::GetWorkerCount() const
+{
+	return static_cast<uint32_t>(m_workers.size());
+}
+
+SceJobSchedulerStats CSceJobScheduler::GetStats() const
+{
+	SceJobSchedulerStats stats = {};
+	for (auto& worker : m_workers)
+	{
+		stats.jobCount += worker->jobCount.load(std::memory_order_relaxed);
+		stats.stealCount += worker->stealCount.load(std::memory_order_relaxed);
+		stats.stealAttemptCount += worker->stealAttemptCount.load(std::memory_order_relaxed);
+		stats.injectCount += worker->injectCount.load(std::memory_order_relaxed);
+		stats.idleTimeNs += worker->idleTimeNs.load(std::memory_order_relaxed);
+		stats.maxQueueDepth = std::max(stats.maxQueueDepth, worker->maxQueueDepth.load(std::memory_order_relaxed));
+	}
+	stats.jobCount += m_helperJobCount.load(std::memory_order_relaxed);
+	stats.maxQueueDepth = std::max(stats.maxQueueDepth, m_maxInjectDepth.load(std::memory_order_relaxed));
+	return stats;
+}
+
+void CSceJobScheduler::ResetStats()
+{
+	for (auto& worker : m_workers)
+	{
+		worker->jobCount.store(0, std::memory_order_relaxed);
+		worker->stealCount.store(0, std::memory_order_relaxed);
+		worker->stealAttemptCount.store(0, std::memory_order_relaxed);
+		worker->injectCount.store(0, std::memory_order_relaxed);
+		worker->idleTimeNs.store(0, std::memory_order_relaxed);
+		worker->maxQueueDepth.store(0, std::memory_order_relaxed);
+	}
+	m_helperJobCount.store(0, std::memory_order_relaxed);
+	m_maxInjectDepth.store(0, std::memory_order_relaxed);
+}
+
+void CSceJobScheduler::RunWorker(Worker* worker)
+{
+	t_job_worker = worker;
+
+	uint32_t spinCount = 0;
+	auto     idleStart = std::chrono::steady_clock::now();
+	while (true)
+	{
+		SceJob* job = FindJob(worker);
+		if (job)
+		{
+			if (spinCount != 0)
+			{
+				auto idleTime = std::chrono::steady_clock::now() - idleStart;
+				worker->idleTimeNs.fetch_add(
+					std::chrono::duration_cast<std::chrono::nanoseconds>(idleTime).count(),
+					std::memory_order_relaxed);
+				spinCount = 0;
+			}
+
+			worker->jobCount.fetch_add(1, std::memory_order_relaxed);
+			Execute(job);
+			continue;
+		}
+
+		if (spinCount == 0)
+		{
+			idleStart = std::chrono::steady_clock::now();
+		}
+
+		if (++spinCount < JobWorkerSpinCount)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		if (m_stopped.load() && m_queuedJobs.load() == 0)
+		{
+			break;
+		}
+
+		// Idle time is counted from idleStart once a job is found,
+		// sleeping included.
+		Sleep();
+	}
+
+	t_job_worker = nullptr;
+}
+
+SceJob* CSceJobScheduler::FindJob(Worker* worker)
+{
+	SceJob* job = nullptr;
+	do
+	{
+		if (worker)
+		{
+			job = worker->deque.Take();
+			if (job)
+			{
+				break;
+			}
+		}
+
+		{
+			std::lock_guard lock(m_injectMutex);
+			if (!m_injectQueue.empty())
+			{
+				job = m_injectQueue.front();
+				m_injectQueue.pop_front();
+			}
+		}
+
+		if (job)
+		{
+			if (worker)
+			{
+				worker->injectCount.fetch_add(1, std::memory_order_relaxed);
+			}
+			break;
+		}
+
+		job = StealJob(worker);
+	} while (false);
+
+	if (job)
+	{
+		m_queuedJobs.fetch_sub(1, std::memory_order_seq_cst);
+	}
+	return job;
+}
+
+SceJob* CSceJobScheduler::StealJob(Worker* worker)
+{
+	SceJob*  job         = nullptr;
+	uint32_t workerCount = static_cast<uint32_t>(m_workers.size());
+
+	// Start from a random victim so that
+	// thieves don't all hit the same deque.
+	uint32_t start = 0;
+	if (worker)
+	{
+		uint32_t seed = worker->victimSeed;
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		worker->victimSeed = seed;
+		start              = seed % workerCount;
+	}
+
+	for (uint32_t i = 0; i != workerCount; ++i)
+	{
+		Worker* victim = m_workers[(start + i) % workerCount].get();
+		if (victim == worker || victim->deque.Size() == 0)
+		{
+			continue;
+		}
+
+		if (worker)
+		{
+			worker->stealAttemptCount.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		job = victim->deque.Steal();
+		if (job)
+		{
+			if (worker)
+			{
+				worker->stealCount.fetch_add(1, std::memory_order_relaxed);
+			}
+			break;
+		}
+	}
+	return job;
+}
+
+void CSceJobScheduler::Enqueue(SceJob* job)
+{
+	Worker* worker = GetCurrentWorker();
+	if (worker)
+	{
+		worker->deque.Push(job);
+
+		uint64_t depth = static_cast<uint64_t>(worker->deque.Size());
+		if (depth > worker->maxQueueDepth.load(std::memory_order_relaxed))
+		{
+			worker->maxQueueDepth.store(depth, std::memory_order_relaxed);
+		}
+	}
+	else
+	{
+		std::lock_guard lock(m_injectMutex);
+		m_injectQueue.push_back(job);
+
+		uint64_t depth = m_injectQueue.size();
+		if (depth > m_maxInjectDepth.load(std::memory_order_relaxed))
+		{
+			m_maxInjectDepth.store(depth, std::memory_order_relaxed);
+		}
+	}
+
+	// Pairs with the sleepers increment in Sleep,
+	// one of the two sides sees the other.
+	m_queuedJobs.fetch_add(1, std::memory_order_seq_cst);
+	if (m_sleepers.load(std::memory_order_seq_cst) != 0)
+	{
+		{
+			std::lock_guard lock(m_sleepMutex);
+		}
+		m_sleepCond.notify_one();
+	}
+}
+
+void CSceJobScheduler::Execute(SceJob* job)
+{
+	job->func(job->arg);
+
+	CSceJobGroup* group = job->group;
+	delete job;
+
+	if (group)
+	{
+		std::vector<SceJob*> released;
+		group->Finish(released);
+		Release(released);
+	}
+}
+
+void CSceJobScheduler::Release(std::vector<SceJob*>& jobs)
+{
+	for (SceJob* job : jobs)
+	{
+		if (job->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			Enqueue(job);
+		}
+	}
+}
+
+void CSceJobScheduler::Sleep()
+{
+	std::unique_lock<std::mutex> lock(m_sleepMutex);
+	m_sleepers.fetch_add(1, std::memory_order_seq_cst);
+	m_sleepCond.wait(lock, [this]
+					 { return m_queuedJobs.load(std::memory_order_seq_cst) > 0 || m_stopped.load(); });
+	m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+CSceJobScheduler::Worker* CSceJobScheduler::GetCurrentWorker()
+{
+	auto worker = reinterpret_cast<Worker*>(t_job_worker);
+	return (worker && worker->owner == this) ? worker : nullptr;
+}
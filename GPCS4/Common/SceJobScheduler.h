@@ -0,0 +1,163 @@
+#pragma once
+#include "GPCS4Common.h"
+#include "SceJobDeque.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class CSceJobGroup;
+class CSceJobScheduler;
+
+typedef void (*SceJobFunc)(void* arg);
+
+struct SceJob
+{
+	SceJobFunc    func;
+	void*         arg;
+	// Signaled when the job is done, may be null.
+	CSceJobGroup* group;
+	// Groups not done yet, plus one while submitting.
+	std::atomic<uint32_t> pendingDependencies;
+};
+
+
+// A set of jobs which can be waited on,
+// and which other jobs can depend on.
+// This is both the barrier and the dependency
+// primitive of the scheduler.
+
+class CSceJobGroup
+{
+	friend class CSceJobScheduler;
+
+public:
+	CSceJobGroup();
+	~CSceJobGroup();
+
+	bool IsDone() const;
+
+private:
+	void Add(uint32_t count);
+
+	// Returns the jobs depending on the group
+	// once the last job is done.
+	void Finish(std::vector<SceJob*>& released);
+
+	// Returns false if the group is done already,
+	// the job can be run right away.
+	bool AddDependent(SceJob* job);
+
+	void Wait();
+
+private:
+	std::atomic<uint32_t> m_pending;
+
+	std::mutex              m_mutex;
+	std::condition_variable m_cond;
+	std::vector<SceJob*>    m_dependents;
+};
+
+
+struct SceJobSchedulerStats
+{
+	uint64_t jobCount;
+	uint64_t stealCount;
+	uint64_t stealAttemptCount;
+	// Jobs taken from the queue of submissions
+	// made outside of worker threads.
+	uint64_t injectCount;
+	uint64_t idleTimeNs;
+	uint64_t maxQueueDepth;
+};
+
+
+// Job scheduler with one Chase-Lev deque per worker.
+// The linker relocates modules on it at boot, the
+// libSceJobManager exports don't use it yet.
+//
+// Jobs submitted from a worker go to its own deque,
+// idle workers steal from the others. Jobs submitted
+// from other threads go through a shared injection queue.
+// Workers sleep when there's nothing left to run.
+
+class CSceJobScheduler
+{
+public:
+	// The PS4 gives games 6 cores, plus part of a 7th.
+	static constexpr uint32_t DefaultWorkerCount = 6;
+
+	// Worker i is pinned to the host processors in workerMasks[i],
+	// e.g. from ThreadAffinityMapper::mapGuestMask, workers without
+	// a mask or with an empty one are left to the host scheduler.
+	CSceJobScheduler(uint32_t workerCount = DefaultWorkerCount,
+		const std::vector<uint64_t>& workerMasks = {});
+	~CSceJobScheduler();
+
+	// The job runs once every group in dependencies is done.
+	void Submit(SceJobFunc func, void* arg, CSceJobGroup* group,
+		CSceJobGroup* const* dependencies = nullptr, uint32_t dependencyCount = 0);
+
+	// Runs other jobs while waiting.
+	void Wait(CSceJobGroup* group);
+
+	uint32_t GetWorkerCount() const;
+
+	SceJobSchedulerStats GetStats() const;
+
+	void ResetStats();
+
+private:
+	struct Worker
+	{
+		CSceJobScheduler* owner;
+		uint32_t          index;
+		CSceJobDeque      deque;
+		std::thread       thread;
+		uint32_t          victimSeed;
+
+		// Only written by the worker itself.
+		std::atomic<uint64_t> jobCount;
+		std::atomic<uint64_t> stealCount;
+		std::atomic<uint64_t> stealAttemptCount;
+		std::atomic<uint64_t> injectCount;
+		std::atomic<uint64_t> idleTimeNs;
+		std::atomic<uint64_t> maxQueueDepth;
+	};
+
+	void RunWorker(Worker* worker);
+
+	SceJob* FindJob(Worker* worker);
+
+	SceJob* StealJob(Worker* worker);
+
+	void Enqueue(SceJob* job);
+
+	void Execute(SceJob* job);
+
+	void Release(std::vector<SceJob*>& jobs);
+
+	void Sleep();
+
+	Worker* GetCurrentWorker();
+
+private:
+	std::vector<std::unique_ptr<Worker>> m_workers;
+
+	std::mutex          m_injectMutex;
+	std::deque<SceJob*> m_injectQueue;
+	std::atomic<uint64_t> m_maxInjectDepth;
+
+	// Jobs run by non worker threads while waiting.
+	std::atomic<uint64_t> m_helperJobCount;
+
+	// Jobs in any queue, workers only sleep when it's 0.
+	std::atomic<int64_t>    m_queuedJobs;
+	std::atomic<uint32_t>   m_sleepers;
+	std::mutex              m_sleepMutex;
+	std::condition_variable m_sleepCond;
+	std::atomic<bool>       m_stopped;
+};
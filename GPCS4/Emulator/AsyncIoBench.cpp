@@ -0,0 +1,278 @@
+#include "AsyncIoBench.h"
+#include "VirtualFileSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+LOG_CHANNEL(Emulator.AsyncIoBench);
+
+constexpr uint32_t BenchOpSize     = 1024 * 1024;
+constexpr uint32_t BenchProbeSize  = 64 * 1024;
+constexpr uint32_t BenchProbeCount = 16;
+
+static const char* getBackendName(AsyncIoBackend backend)
+{
+	return backend == AsyncIoBackend::IoUring ? "io_uring" : "thread pool";
+}
+
+static int64_t getSteadyTime()
+{
+	using namespace std::chrono;
+	return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+
+AsyncIoBench::AsyncIoBench(const AsyncIoBenchDesc& desc) :
+	m_desc(desc)
+{
+}
+
+AsyncIoBench::~AsyncIoBench()
+{
+	removeFile();
+}
+
+bool AsyncIoBench::run()
+{
+	bool ret = false;
+	do
+	{
+		if (m_desc.fileSize == 0)
+		{
+			std::printf("Nothing to run, file size is 0.\n");
+			break;
+		}
+
+		if (!createFile())
+		{
+			std::printf("Failed to create the data file.\n");
+			break;
+		}
+
+		VirtualFileSystem vfs;
+		vfs.mount("/app0", m_root);
+
+		std::printf("Data file      : %u MB in %s, ops of %u KB\n",
+					m_desc.fileSize, m_root.c_str(), BenchOpSize / 1024);
+
+		// What Fios2 did before, a blocking read per op.
+		VfsFile file;
+		if (vfs.open("/app0/data.bin", VfsOpenRead, &file) < 0)
+		{
+			std::printf("Failed to open the data file.\n");
+			break;
+		}
+
+		std::vector<uint8_t> buffer(m_fileSize);
+		uint64_t             failCount = 0;
+
+		double syncTime = measure([&]()
+								  {
+									  for (uint64_t offset = 0; offset < m_fileSize; offset += BenchOpSize)
+									  {
+										  failCount += vfs.pread(file, buffer.data() + offset, BenchOpSize, offset) != BenchOpSize;
+									  }
+								  });
+		vfs.close(file);
+
+		std::printf("Synchronous\n");
+		std::printf("  Throughput    : %.1f MB/s\n", m_desc.fileSize / syncTime);
+
+		if (failCount)
+		{
+			std::printf("%llu reads failed.\n", static_cast<unsigned long long>(failCount));
+			break;
+		}
+
+		bool success = true;
+#ifdef GPCS4_LINUX
+		success &= runBackend(vfs, AsyncIoBackend::IoUring);
+#endif  // GPCS4_LINUX
+		success &= runBackend(vfs, AsyncIoBackend::ThreadPool);
+		if (!success)
+		{
+			break;
+		}
+
+		ret = true;
+	} while (false);
+
+	removeFile();
+	return ret;
+}
+
+bool AsyncIoBench::runBackend(VirtualFileSystem& vfs, AsyncIoBackend backend)
+{
+	bool ret = false;
+	do
+	{
+		AsyncIoEngine engine(vfs);
+		AsyncIoDesc   desc;
+		desc.backend = backend;
+		if (!engine.initialize(desc) || engine.backend() != backend)
+		{
+			std::printf("%s is not available, skipped.\n", getBackendName(backend));
+			ret = true;
+			break;
+		}
+
+		VfsFile file;
+		if (vfs.open("/app0/data.bin", VfsOpenRead, &file) < 0)
+		{
+			break;
+		}
+
+		std::vector<uint8_t>    buffer(m_fileSize);
+		std::vector<uint8_t>    probeBuffer(BenchProbeSize);
+		std::vector<AsyncIoOp*> ops;
+		uint64_t                failCount = 0;
+
+		auto submitAll = [&]()
+		{
+			for (uint64_t offset = 0; offset < m_fileSize; offset += BenchOpSize)
+			{
+				AsyncIoRequest request;
+				request.file   = file;
+				request.buffer = buffer.data() + offset;
+				request.size   = BenchOpSize;
+				request.offset = offset;
+				ops.push_back(engine.submit(request));
+			}
+		};
+
+		auto waitAll = [&]()
+		{
+			for (auto op : ops)
+			{
+				engine.wait(op);
+				failCount += engine.result(op) != BenchOpSize;
+				engine.release(op);
+			}
+			ops.clear();
+		};
+
+		double time = measure([&]()
+							  {
+								  submitAll();
+								  waitAll();
+							  });
+
+		// A small read behind the whole file, once with the same
+		// priority as the bulk reads and once with a higher one.
+		auto probe = [&](int32_t priority)
+		{
+			double totalTime = 0.0;
+			for (uint32_t i = 0; i != BenchProbeCount; ++i)
+			{
+				submitAll();
+
+				AsyncIoRequest request;
+				request.file     = file;
+				request.buffer   = probeBuffer.data();
+				request.size     = BenchProbeSize;
+				request.offset   = (i * BenchProbeSize) % m_fileSize;
+				request.priority = priority;
+
+				int64_t    start = getSteadyTime();
+				AsyncIoOp* op    = engine.submit(request);
+				engine.wait(op);
+				totalTime += static_cast<double>(getSteadyTime() - start);
+				failCount += engine.result(op) != BenchProbeSize;
+				engine.release(op);
+
+				waitAll();
+			}
+			return totalTime / BenchProbeCount / 1000000.0;
+		};
+
+		double fifoLatency   = probe(0);
+		double urgentLatency = probe(1);
+		auto   stats         = engine.getStats();
+
+		engine.forgetFile(file);
+		vfs.close(file);
+		engine.destroy();
+
+		std::printf("%s\n", getBackendName(backend));
+		std::printf("  Throughput    : %.1f MB/s\n", m_desc.fileSize / time);
+		std::printf("  Read latency  : %.3f ms queued behind the file, %.3f ms with higher priority\n",
+					fifoLatency, urgentLatency);
+		std::printf("  Engine        : %llu ops, %llu chunks, %llu readaheads\n",
+					static_cast<unsigned long long>(stats.completeCount),
+					static_cast<unsigned long long>(stats.chunkCount),
+					static_cast<unsigned long long>(stats.readaheadCount));
+
+		if (failCount)
+		{
+			std::printf("%llu reads failed.\n", static_cast<unsigned long long>(failCount));
+			break;
+		}
+
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+bool AsyncIoBench::createFile()
+{
+	bool ret = false;
+	do
+	{
+		std::error_code error;
+		auto            root = std::filesystem::temp_directory_path(error) / "gpcs4_aio_bench";
+		if (error)
+		{
+			break;
+		}
+
+		std::filesystem::remove_all(root, error);
+		std::filesystem::create_directories(root, error);
+		m_root = root.string();
+
+		std::vector<char> content(BenchOpSize, 'x');
+		std::ofstream     fout(root / "data.bin", std::ofstream::binary);
+		uint32_t          index = 0;
+		for (; index != m_desc.fileSize; ++index)
+		{
+			if (!fout.write(content.data(), content.size()))
+			{
+				break;
+			}
+		}
+
+		m_fileSize = static_cast<uint64_t>(m_desc.fileSize) * BenchOpSize;
+		ret        = index == m_desc.fileSize;
+	} while (false);
+	return ret;
+}
+
+void AsyncIoBench::removeFile()
+{
+	if (!m_root.empty())
+	{
+		std::error_code error;
+		std::filesystem::remove_all(m_root, error);
+		m_root.clear();
+	}
+}
+
+template <typename Func>
+double AsyncIoBench::measure(Func func)
+{
+	uint32_t repeatCount = std::max(m_desc.repeatCount, 1u);
+	double   bestTime    = 0.0;
+	for (uint32_t i = 0; i != repeatCount; ++i)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		func();
+		auto end = std::chrono::high_resolution_clock::now();
+
+		double time = std::chrono::duration<double>(end - start).count();
+		bestTime    = i == 0 ? time : std::min(bestTime, time);
+	}
+	return bestTime;
+}
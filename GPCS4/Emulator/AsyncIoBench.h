@@ -0,0 +1,47 @@
+#pragma once
+
+#include "GPCS4Common.h"
+#include "AsyncIoEngine.h"
+
+#include <string>
+
+struct AsyncIoBenchDesc
+{
+	// Size of the data file in MB.
+	uint32_t fileSize;
+	// Run each test N times and keep the fastest time.
+	uint32_t repeatCount;
+};
+
+// Reads a data file mounted on /app0 through the async io engine,
+// on each backend the host has, and with plain synchronous reads
+// as Fios2 did before.
+//
+// Reports the throughput of reading the whole file in many
+// outstanding ops, and how long a small urgent read takes
+// while the whole file is queued in front of it.
+
+class AsyncIoBench
+{
+public:
+	AsyncIoBench(const AsyncIoBenchDesc& desc);
+	~AsyncIoBench();
+
+	bool run();
+
+private:
+	bool createFile();
+
+	void removeFile();
+
+	bool runBackend(VirtualFileSystem& vfs, AsyncIoBackend backend);
+
+	template <typename Func>
+	double measure(Func func);
+
+private:
+	AsyncIoBenchDesc m_desc;
+
+	std::string m_root;
+	uint64_t    m_fileSize = 0;
+};
@@ -0,0 +1,800 @@
+#include "AsyncIoEngine.h"
+#include "Platform/PlatThread.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+
+#ifdef GPCS4_LINUX
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // GPCS4_LINUX
+
+LOG_CHANNEL(Emulator.AsyncIoEngine);
+
+static int64_t getSteadyTime()
+{
+	using namespace std::chrono;
+	return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+#ifdef GPCS4_LINUX
+
+// user_data of the read which wakes the ring thread,
+// chunks use their slot index plus one.
+constexpr uint64_t RingWakeTag = 0;
+
+struct AsyncIoEngine::IoRing
+{
+	~IoRing()
+	{
+		if (sqes)
+		{
+			munmap(sqes, sqesSize);
+		}
+		if (ring)
+		{
+			munmap(ring, ringSize);
+		}
+		if (eventFd != -1)
+		{
+			close(eventFd);
+		}
+		if (fd != -1)
+		{
+			close(fd);
+		}
+	}
+
+	int      fd         = -1;
+	int      eventFd    = -1;
+	uint64_t eventValue = 0;
+
+	void*         ring     = nullptr;
+	size_t        ringSize = 0;
+	io_uring_sqe* sqes     = nullptr;
+	size_t        sqesSize = 0;
+
+	uint32_t*     sqTail  = nullptr;
+	uint32_t      sqMask  = 0;
+	uint32_t*     sqArray = nullptr;
+	uint32_t*     cqHead  = nullptr;
+	uint32_t*     cqTail  = nullptr;
+	uint32_t      cqMask  = 0;
+	io_uring_cqe* cqes    = nullptr;
+
+	// Chunks in the kernel, only touched by the ring thread.
+	std::vector<Chunk>    chunks;
+	std::vector<uint32_t> freeChunks;
+};
+
+void AsyncIoEngine::prepareSqe(IoRing& ring, uint8_t opcode, int fd,
+							   const void* address, uint32_t length, uint64_t offset, uint64_t userData)
+{
+	uint32_t      tail  = *ring.sqTail;
+	uint32_t      index = tail & ring.sqMask;
+	io_uring_sqe* sqe   = &ring.sqes[index];
+
+	std::memset(sqe, 0, sizeof(io_uring_sqe));
+	sqe->opcode    = opcode;
+	sqe->fd        = fd;
+	sqe->addr      = reinterpret_cast<uint64_t>(address);
+	sqe->len       = length;
+	sqe->off       = offset;
+	sqe->user_data = userData;
+	if (opcode == IORING_OP_FADVISE)
+	{
+		sqe->fadvise_advice = POSIX_FADV_WILLNEED;
+	}
+
+	ring.sqArray[index] = index;
+	// The kernel reads the entry once it sees the new tail.
+	__atomic_store_n(ring.sqTail, tail + 1, __ATOMIC_RELEASE);
+}
+
+#endif  // GPCS4_LINUX
+
+
+bool AsyncIoEngine::OpOrder::operator()(const AsyncIoOp* lhs, const AsyncIoOp* rhs) const
+{
+	// Earliest deadline first, ops without one last,
+	// then the higher priority, then the older op.
+	int64_t lhsDeadline = lhs->request.deadline ? lhs->request.deadline : INT64_MAX;
+	int64_t rhsDeadline = rhs->request.deadline ? rhs->request.deadline : INT64_MAX;
+	if (lhsDeadline != rhsDeadline)
+	{
+		return lhsDeadline < rhsDeadline;
+	}
+	if (lhs->request.priority != rhs->request.priority)
+	{
+		return lhs->request.priority > rhs->request.priority;
+	}
+	return lhs->sequence < rhs->sequence;
+}
+
+
+AsyncIoEngine::AsyncIoEngine(VirtualFileSystem& vfs) :
+	m_vfs(vfs)
+{
+}
+
+AsyncIoEngine::~AsyncIoEngine()
+{
+	destroy();
+}
+
+bool AsyncIoEngine::initialize(const AsyncIoDesc& desc)
+{
+	m_desc             = desc;
+	m_desc.threadCount = std::max(m_desc.threadCount, 1u);
+	m_desc.queueDepth  = std::max(m_desc.queueDepth, 1u);
+	m_desc.chunkSize   = std::max(m_desc.chunkSize, 4096u);
+
+	m_backend = AsyncIoBackend::ThreadPool;
+#ifdef GPCS4_LINUX
+	if (m_desc.backend != AsyncIoBackend::ThreadPool)
+	{
+		if (createRing())
+		{
+			m_backend = AsyncIoBackend::IoUring;
+		}
+		else
+		{
+			LOG_WARN("io_uring is not available, falling back to the thread pool");
+		}
+	}
+#else
+	if (m_desc.backend == AsyncIoBackend::IoUring)
+	{
+		LOG_WARN("io_uring is only available on Linux, falling back to the thread pool");
+	}
+#endif  // GPCS4_LINUX
+
+	m_running = true;
+	if (m_backend == AsyncIoBackend::IoUring)
+	{
+#ifdef GPCS4_LINUX
+		m_threads.emplace_back(&AsyncIoEngine::runRing, this);
+#endif  // GPCS4_LINUX
+	}
+	else
+	{
+		for (uint32_t i = 0; i != m_desc.threadCount; ++i)
+		{
+			m_threads.emplace_back(&AsyncIoEngine::runWorker, this);
+		}
+	}
+
+	LOG_DEBUG("async io on %s, queue depth %d, chunk size %d",
+			  m_backend == AsyncIoBackend::IoUring ? "io_uring" : "thread pool",
+			  m_desc.queueDepth, m_desc.chunkSize);
+	return true;
+}
+
+void AsyncIoEngine::destroy()
+{
+	do
+	{
+		if (!m_running.exchange(false))
+		{
+			break;
+		}
+
+		notifyBackend();
+		for (auto& thread : m_threads)
+		{
+			thread.join();
+		}
+		m_threads.clear();
+
+		// Nobody runs what's left in the queue.
+		std::vector<AsyncIoOp*> ops;
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			ops.assign(m_queue.begin(), m_queue.end());
+			m_queue.clear();
+		}
+
+		for (auto op : ops)
+		{
+			int32_t expected = 0;
+			op->error.compare_exchange_strong(expected, -ECANCELED);
+			if (op->pendingChunks.fetch_sub(1) == 1)
+			{
+				completeOp(op);
+			}
+		}
+
+#ifdef GPCS4_LINUX
+		destroyRing();
+#endif  // GPCS4_LINUX
+
+		std::lock_guard<std::mutex> lock(m_fileMutex);
+		m_files.clear();
+	} while (false);
+}
+
+AsyncIoOp* AsyncIoEngine::submit(const AsyncIoRequest& request)
+{
+	AsyncIoOp* op = prepare(request);
+	start(op);
+	return op;
+}
+
+AsyncIoOp* AsyncIoEngine::prepare(const AsyncIoRequest& request)
+{
+	auto op      = new AsyncIoOp();
+	op->request  = request;
+	op->sequence = 0;
+	op->issued   = 0;
+	// One count for the chunks still to be issued,
+	// dropped once the op leaves the queue.
+	op->pendingChunks = 1;
+	op->transferred   = 0;
+	op->error         = 0;
+	op->cancelled     = false;
+	op->state         = static_cast<uint32_t>(AsyncIoState::Queued);
+	op->refCount      = 2;
+	return op;
+}
+
+void AsyncIoEngine::start(AsyncIoOp* op)
+{
+	m_submitCount.fetch_add(1, std::memory_order_relaxed);
+
+	int32_t error = 0;
+	if (op->request.size != 0 && op->request.file.type == VfsNodeType::File)
+	{
+		error = getHostFile(op->request.file, &op->hostFile);
+	}
+
+	bool queued = false;
+	if (op->request.size != 0 && m_running && error == 0)
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		op->sequence = m_sequence++;
+		m_queue.insert(op);
+		queued = true;
+	}
+
+	if (queued)
+	{
+		notifyBackend();
+	}
+	else
+	{
+		if (op->request.size != 0)
+		{
+			op->error = error != 0 ? error : -ECANCELED;
+		}
+		op->pendingChunks = 0;
+		completeOp(op);
+	}
+}
+
+bool AsyncIoEngine::wait(AsyncIoOp* op, const uint64_t* timeout)
+{
+	using namespace std::chrono;
+
+	bool ret      = false;
+	auto deadline = steady_clock::now() + microseconds(timeout ? *timeout : 0);
+	while (true)
+	{
+		uint32_t state = op->state.load(std::memory_order_acquire);
+		if (state == static_cast<uint32_t>(AsyncIoState::Done))
+		{
+			ret = true;
+			break;
+		}
+
+		if (!timeout)
+		{
+			plat::FutexWait(&op->state, state, nullptr);
+			continue;
+		}
+
+		auto now = steady_clock::now();
+		if (now >= deadline)
+		{
+			break;
+		}
+
+		uint64_t timeLeft = duration_cast<microseconds>(deadline - now).count();
+		plat::FutexWait(&op->state, state, &timeLeft);
+	}
+	return ret;
+}
+
+bool AsyncIoEngine::isDone(const AsyncIoOp* op) const
+{
+	return op->state.load(std::memory_order_acquire) == static_cast<uint32_t>(AsyncIoState::Done);
+}
+
+int64_t AsyncIoEngine::result(const AsyncIoOp* op) const
+{
+	int32_t error = op->error.load(std::memory_order_relaxed);
+	return error != 0 ? error : op->transferred.load(std::memory_order_relaxed);
+}
+
+void AsyncIoEngine::cancel(AsyncIoOp* op)
+{
+	bool dequeued = false;
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		op->cancelled = true;
+
+		auto iter = m_queue.find(op);
+		if (iter != m_queue.end())
+		{
+			m_queue.erase(iter);
+			dequeued = true;
+		}
+	}
+
+	if (dequeued)
+	{
+		int32_t expected = 0;
+		op->error.compare_exchange_strong(expected, -ECANCELED);
+		if (op->pendingChunks.fetch_sub(1) == 1)
+		{
+			completeOp(op);
+		}
+	}
+}
+
+void AsyncIoEngine::release(AsyncIoOp* op)
+{
+	if (op->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		delete op;
+	}
+}
+
+void AsyncIoEngine::forgetFile(const VfsFile& file)
+{
+	std::lock_guard<std::mutex> lock(m_fileMutex);
+	m_files.erase(file.handle);
+}
+
+AsyncIoBackend AsyncIoEngine::backend() const
+{
+	return m_backend;
+}
+
+AsyncIoStats AsyncIoEngine::getStats() const
+{
+	AsyncIoStats stats        = {};
+	stats.submitCount         = m_submitCount.load(std::memory_order_relaxed);
+	stats.completeCount       = m_completeCount.load(std::memory_order_relaxed);
+	stats.chunkCount          = m_chunkCount.load(std::memory_order_relaxed);
+	stats.byteCount           = m_byteCount.load(std::memory_order_relaxed);
+	stats.readaheadCount      = m_readaheadCount.load(std::memory_order_relaxed);
+	stats.missedDeadlineCount = m_missedDeadlineCount.load(std::memory_order_relaxed);
+	return stats;
+}
+
+void AsyncIoEngine::dumpStats()
+{
+	auto stats = getStats();
+	LOG_DEBUG("async io: %lld ops, %lld chunks, %lld bytes, %lld readaheads, %lld missed deadlines",
+			  stats.completeCount, stats.chunkCount, stats.byteCount,
+			  stats.readaheadCount, stats.missedDeadlineCount);
+}
+
+int AsyncIoEngine::getHostFile(const VfsFile& file, std::shared_ptr<VfsFile>* hostFile)
+{
+	std::lock_guard<std::mutex> lock(m_fileMutex);
+
+	int ret = 0;
+	do
+	{
+		auto iter = m_files.find(file.handle);
+		if (iter != m_files.end())
+		{
+			*hostFile = iter->second.hostFile;
+			break;
+		}
+
+		VfsFile copy;
+		ret = m_vfs.reopen(file, &copy);
+		if (ret < 0)
+		{
+			break;
+		}
+
+		// Closed with the last op holding it.
+		VirtualFileSystem& vfs       = m_vfs;
+		auto               closeFile = [&vfs](VfsFile* engineFile)
+		{
+			vfs.close(*engineFile);
+			delete engineFile;
+		};
+
+		*hostFile                     = std::shared_ptr<VfsFile>(new VfsFile(copy), closeFile);
+		m_files[file.handle].hostFile = *hostFile;
+	} while (false);
+	return ret;
+}
+
+bool AsyncIoEngine::takeChunkLocked(Chunk& chunk)
+{
+	bool ret = false;
+	do
+	{
+		if (m_queue.empty())
+		{
+			break;
+		}
+
+		AsyncIoOp* op   = *m_queue.begin();
+		uint64_t   size = std::min<uint64_t>(op->request.size - op->issued, m_desc.chunkSize);
+
+		chunk.op     = op;
+		chunk.buffer = op->request.buffer
+						   ? static_cast<uint8_t*>(op->request.buffer) + op->issued
+						   : nullptr;
+		chunk.offset = op->request.offset + op->issued;
+		chunk.size   = size;
+
+		op->issued += size;
+		op->pendingChunks.fetch_add(1);
+		op->state.store(static_cast<uint32_t>(AsyncIoState::Running), std::memory_order_relaxed);
+
+		if (op->issued == op->request.size)
+		{
+			m_queue.erase(m_queue.begin());
+			// Never the last count, the chunk above holds one.
+			op->pendingChunks.fetch_sub(1);
+		}
+
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+void AsyncIoEngine::completeChunk(const Chunk& chunk, int64_t result)
+{
+	AsyncIoOp* op = chunk.op;
+
+	m_chunkCount.fetch_add(1, std::memory_order_relaxed);
+	if (result < 0)
+	{
+		int32_t expected = 0;
+		op->error.compare_exchange_strong(expected, static_cast<int32_t>(result));
+	}
+	else
+	{
+		op->transferred.fetch_add(result, std::memory_order_relaxed);
+		m_byteCount.fetch_add(result, std::memory_order_relaxed);
+	}
+
+	if (op->pendingChunks.fetch_sub(1) == 1)
+	{
+		completeOp(op);
+	}
+}
+
+void AsyncIoEngine::completeOp(AsyncIoOp* op)
+{
+	if (op->request.deadline && getSteadyTime() > op->request.deadline)
+	{
+		m_missedDeadlineCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	if (op->request.type == AsyncIoType::Read)
+	{
+		updateReadahead(op);
+	}
+
+	// Before the op is done, so that waiters see
+	// whatever the callback writes.
+	if (op->request.callback)
+	{
+		op->request.callback(*op);
+	}
+
+	m_completeCount.fetch_add(1, std::memory_order_relaxed);
+	op->state.store(static_cast<uint32_t>(AsyncIoState::Done), std::memory_order_release);
+	plat::FutexWakeAll(&op->state);
+
+	release(op);
+}
+
+void AsyncIoEngine::updateReadahead(AsyncIoOp* op)
+{
+	do
+	{
+		const AsyncIoRequest& request = op->request;
+		if (!m_desc.readaheadSize ||
+			request.file.type != VfsNodeType::File ||
+			op->error.load(std::memory_order_relaxed) != 0 ||
+			op->transferred.load(std::memory_order_relaxed) != static_cast<int64_t>(request.size))
+		{
+			break;
+		}
+
+		uint64_t readEnd       = request.offset + request.size;
+		uint64_t prefetchBegin = 0;
+		{
+			std::lock_guard<std::mutex> lock(m_fileMutex);
+			auto                        iter = m_files.find(request.file.handle);
+			// Closed while the read ran.
+			if (iter == m_files.end() || iter->second.hostFile != op->hostFile)
+			{
+				break;
+			}
+
+			auto& window       = iter->second.window;
+			bool  isSequential = window.readEnd == request.offset;
+			window.readEnd                           = readEnd;
+			// Only when the reader got into the second half
+			// of what was prefetched last time.
+			if (!isSequential || readEnd + m_desc.readaheadSize / 2 < window.prefetchEnd)
+			{
+				break;
+			}
+
+			prefetchBegin      = std::max(readEnd, window.prefetchEnd);
+			window.prefetchEnd = readEnd + m_desc.readaheadSize;
+		}
+
+		AsyncIoRequest prefetch;
+		prefetch.type     = AsyncIoType::Prefetch;
+		prefetch.file     = request.file;
+		prefetch.offset   = prefetchBegin;
+		prefetch.size     = readEnd + m_desc.readaheadSize - prefetchBegin;
+		prefetch.priority = INT32_MIN;
+		release(submit(prefetch));
+
+		m_readaheadCount.fetch_add(1, std::memory_order_relaxed);
+	} while (false);
+}
+
+int64_t AsyncIoEngine::runChunk(const Chunk& chunk)
+{
+	const AsyncIoRequest& request = chunk.op->request;
+	const VfsFile&        file    = chunk.op->hostFile ? *chunk.op->hostFile : request.file;
+
+	int64_t ret = -EINVAL;
+	switch (request.type)
+	{
+	case AsyncIoType::Read:
+		ret = m_vfs.pread(file, chunk.buffer, chunk.size, chunk.offset);
+		break;
+	case AsyncIoType::Write:
+		ret = m_vfs.pwrite(file, chunk.buffer, chunk.size, chunk.offset);
+		break;
+	case AsyncIoType::Prefetch:
+#ifdef GPCS4_LINUX
+		if (file.type == VfsNodeType::File)
+		{
+			int err = posix_fadvise(static_cast<int>(file.handle),
+									chunk.offset, chunk.size, POSIX_FADV_WILLNEED);
+			ret     = err == 0 ? chunk.size : -err;
+			break;
+		}
+#endif  // GPCS4_LINUX
+		ret = chunk.size;
+		break;
+	}
+	return ret;
+}
+
+void AsyncIoEngine::runWorker()
+{
+	while (true)
+	{
+		Chunk chunk;
+		{
+			std::unique_lock<std::mutex> lock(m_queueMutex);
+			m_queueCond.wait(lock, [this]()
+							 { return !m_running || !m_queue.empty(); });
+			if (!m_running)
+			{
+				break;
+			}
+
+			if (!takeChunkLocked(chunk))
+			{
+				continue;
+			}
+		}
+
+		completeChunk(chunk, runChunk(chunk));
+	}
+}
+
+void AsyncIoEngine::notifyBackend()
+{
+#ifdef GPCS4_LINUX
+	if (m_ring)
+	{
+		uint64_t value = 1;
+		if (::write(m_ring->eventFd, &value, sizeof(value)) < 0)
+		{
+			LOG_ERR("wake io ring failed %d", errno);
+		}
+		return;
+	}
+#endif  // GPCS4_LINUX
+
+	// Taken so a worker between checking the queue
+	// and going to sleep can't miss the notify.
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+	}
+	m_queueCond.notify_all();
+}
+
+#ifdef GPCS4_LINUX
+
+bool AsyncIoEngine::createRing()
+{
+	bool ret  = false;
+	auto ring = std::make_unique<IoRing>();
+	do
+	{
+		io_uring_params params = {};
+		// One more for the wake up read.
+		ring->fd = static_cast<int>(syscall(__NR_io_uring_setup, m_desc.queueDepth + 1, &params));
+		if (ring->fd < 0)
+		{
+			LOG_WARN("io_uring_setup failed %d", errno);
+			break;
+		}
+
+		if (!(params.features & IORING_FEAT_SINGLE_MMAP))
+		{
+			LOG_WARN("io_uring without single mmap is not supported");
+			break;
+		}
+
+		ring->ringSize = std::max(params.sq_off.array + params.sq_entries * sizeof(uint32_t),
+								  params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+		void* ringMemory = mmap(nullptr, ring->ringSize, PROT_READ | PROT_WRITE,
+								MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+		if (ringMemory == MAP_FAILED)
+		{
+			break;
+		}
+		ring->ring = ringMemory;
+
+		ring->sqesSize   = params.sq_entries * sizeof(io_uring_sqe);
+		void* sqeMemory  = mmap(nullptr, ring->sqesSize, PROT_READ | PROT_WRITE,
+								MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+		if (sqeMemory == MAP_FAILED)
+		{
+			break;
+		}
+		ring->sqes = static_cast<io_uring_sqe*>(sqeMemory);
+
+		auto base     = static_cast<uint8_t*>(ring->ring);
+		ring->sqTail  = reinterpret_cast<uint32_t*>(base + params.sq_off.tail);
+		ring->sqMask  = *reinterpret_cast<uint32_t*>(base + params.sq_off.ring_mask);
+		ring->sqArray = reinterpret_cast<uint32_t*>(base + params.sq_off.array);
+		ring->cqHead  = reinterpret_cast<uint32_t*>(base + params.cq_off.head);
+		ring->cqTail  = reinterpret_cast<uint32_t*>(base + params.cq_off.tail);
+		ring->cqMask  = *reinterpret_cast<uint32_t*>(base + params.cq_off.ring_mask);
+		ring->cqes    = reinterpret_cast<io_uring_cqe*>(base + params.cq_off.cqes);
+
+		ring->eventFd = eventfd(0, EFD_CLOEXEC);
+		if (ring->eventFd < 0)
+		{
+			break;
+		}
+
+		ring->chunks.resize(m_desc.queueDepth);
+		for (uint32_t i = 0; i != m_desc.queueDepth; ++i)
+		{
+			ring->freeChunks.push_back(m_desc.queueDepth - 1 - i);
+		}
+
+		m_ring = std::move(ring);
+		ret    = true;
+	} while (false);
+	return ret;
+}
+
+void AsyncIoEngine::destroyRing()
+{
+	m_ring.reset();
+}
+
+void AsyncIoEngine::runRing()
+{
+	IoRing&  ring       = *m_ring;
+	uint32_t inFlight   = 0;
+	bool     wakeArmed  = false;
+
+	while (m_running || inFlight || wakeArmed)
+	{
+		uint32_t submitCount = 0;
+		if (!wakeArmed && m_running)
+		{
+			prepareSqe(ring, IORING_OP_READ, ring.eventFd, &ring.eventValue,
+					   sizeof(ring.eventValue), 0, RingWakeTag);
+			wakeArmed = true;
+			++submitCount;
+		}
+
+		while (m_running && !ring.freeChunks.empty())
+		{
+			Chunk chunk;
+			{
+				std::lock_guard<std::mutex> lock(m_queueMutex);
+				if (!takeChunkLocked(chunk))
+				{
+					break;
+				}
+			}
+
+			const AsyncIoRequest& request = chunk.op->request;
+			if (request.file.type != VfsNodeType::File)
+			{
+				// Devices don't block.
+				completeChunk(chunk, runChunk(chunk));
+				continue;
+			}
+
+			uint8_t opcode = IORING_OP_READ;
+			if (request.type == AsyncIoType::Write)
+			{
+				opcode = IORING_OP_WRITE;
+			}
+			else if (request.type == AsyncIoType::Prefetch)
+			{
+				opcode = IORING_OP_FADVISE;
+			}
+
+			uint32_t index     = ring.freeChunks.back();
+			ring.chunks[index] = chunk;
+			ring.freeChunks.pop_back();
+
+			prepareSqe(ring, opcode, static_cast<int>(chunk.op->hostFile->handle), chunk.buffer,
+					   static_cast<uint32_t>(chunk.size), chunk.offset, index + 1);
+			++inFlight;
+			++submitCount;
+		}
+
+		int err = static_cast<int>(syscall(__NR_io_uring_enter, ring.fd, submitCount, 1,
+										   IORING_ENTER_GETEVENTS, nullptr, 0));
+		if (err < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+		{
+			LOG_ERR("io_uring_enter failed %d", errno);
+			break;
+		}
+
+		uint32_t head = *ring.cqHead;
+		uint32_t tail = __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE);
+		for (; head != tail; ++head)
+		{
+			const io_uring_cqe& cqe = ring.cqes[head & ring.cqMask];
+			if (cqe.user_data == RingWakeTag)
+			{
+				wakeArmed = false;
+				continue;
+			}
+
+			uint32_t index = static_cast<uint32_t>(cqe.user_data - 1);
+			Chunk    chunk = ring.chunks[index];
+			ring.freeChunks.push_back(index);
+			--inFlight;
+
+			int64_t result = cqe.res;
+			if (chunk.op->request.type == AsyncIoType::Prefetch && result >= 0)
+			{
+				result = chunk.size;
+			}
+			completeChunk(chunk, result);
+		}
+		__atomic_store_n(ring.cqHead, head, __ATOMIC_RELEASE);
+	}
+}
+
+#endif  // GPCS4_LINUX
@@ -0,0 +1,242 @@
+#pragma once
+
+#include "GPCS4Common.h"
+#include "VirtualFileSystem.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+enum class AsyncIoBackend
+{
+	// io_uring where the host has it, the thread pool otherwise.
+	Auto,
+	// Opt-in, slower than the thread pool on page cache hits.
+	IoUring,
+	ThreadPool,
+};
+
+enum class AsyncIoType
+{
+	Read,
+	Write,
+	// Asks the host to pull the range into its page cache.
+	Prefetch,
+};
+
+struct AsyncIoDesc
+{
+	AsyncIoBackend backend = AsyncIoBackend::ThreadPool;
+	// Workers of the thread pool backend.
+	uint32_t threadCount = 4;
+	// Chunks in flight at once.
+	uint32_t queueDepth = 64;
+	// Ops are split into chunks of this size, so a large
+	// read can't hold back a more urgent one for long.
+	uint32_t chunkSize = 256 * 1024;
+	// Prefetched after a read which continues the previous one
+	// on the same file, 0 disables readahead.
+	uint32_t readaheadSize = 1024 * 1024;
+};
+
+struct AsyncIoOp;
+
+struct AsyncIoRequest
+{
+	AsyncIoType type     = AsyncIoType::Read;
+	VfsFile     file     = {};
+	void*       buffer   = nullptr;
+	uint64_t    size     = 0;
+	uint64_t    offset   = 0;
+	// Higher runs first among ops with the same deadline.
+	int32_t priority = 0;
+	// Steady clock time in nanoseconds the op should be done by,
+	// 0 for none. Ops are run earliest deadline first,
+	// a missed deadline is only counted.
+	int64_t deadline = 0;
+	// Called on the io thread when the op is done, must not block.
+	std::function<void(AsyncIoOp&)> callback;
+};
+
+enum class AsyncIoState : uint32_t
+{
+	Queued,
+	Running,
+	Done,
+};
+
+struct AsyncIoOp
+{
+	AsyncIoRequest request;
+	uint64_t       sequence;
+
+	// Bytes of the op handed out as chunks, guarded by the queue mutex.
+	uint64_t issued;
+
+	// Chunks in flight, plus one while the op is queued.
+	std::atomic<uint32_t> pendingChunks;
+	std::atomic<int64_t>  transferred;
+	// First negative errno of any chunk.
+	std::atomic<int32_t> error;
+	std::atomic<bool>    cancelled;
+
+	// The engine's own handle on a file, so ops never
+	// move the position of the guest's handle.
+	std::shared_ptr<VfsFile> hostFile;
+
+	// Futex word, an AsyncIoState.
+	std::atomic<uint32_t> state;
+	// The caller and the engine hold one each.
+	std::atomic<uint32_t> refCount;
+};
+
+struct AsyncIoStats
+{
+	uint64_t submitCount;
+	uint64_t completeCount;
+	uint64_t chunkCount;
+	uint64_t byteCount;
+	uint64_t readaheadCount;
+	uint64_t missedDeadlineCount;
+};
+
+// Runs file reads and writes in the background.
+//
+// Ops wait in a queue ordered by deadline and priority, and are
+// cut into chunks which are handed to the backend as it has room.
+// The io_uring backend keeps up to queueDepth chunks in the kernel
+// from a single thread, the thread pool runs one chunk per worker.
+
+class AsyncIoEngine
+{
+public:
+	AsyncIoEngine(VirtualFileSystem& vfs);
+	~AsyncIoEngine();
+
+	bool initialize(const AsyncIoDesc& desc);
+
+	void destroy();
+
+	// The returned op must be released.
+	AsyncIoOp* submit(const AsyncIoRequest& request);
+
+	// Same as submit, in two steps, so the caller can publish
+	// the op before its callback may run. The op must be started.
+	AsyncIoOp* prepare(const AsyncIoRequest& request);
+
+	void start(AsyncIoOp* op);
+
+	// Returns false on timeout, timeout is in microseconds.
+	bool wait(AsyncIoOp* op, const uint64_t* timeout = nullptr);
+
+	bool isDone(const AsyncIoOp* op) const;
+
+	// Bytes transferred, or a negative errno.
+	int64_t result(const AsyncIoOp* op) const;
+
+	// Chunks not started yet are dropped, the op ends with ECANCELED.
+	void cancel(AsyncIoOp* op);
+
+	void release(AsyncIoOp* op);
+
+	// Must be called before the guest closes a file, drops the readahead
+	// state and the engine's handle once no op uses it anymore.
+	void forgetFile(const VfsFile& file);
+
+	AsyncIoBackend backend() const;
+
+	AsyncIoStats getStats() const;
+
+	void dumpStats();
+
+private:
+	struct Chunk
+	{
+		AsyncIoOp* op;
+		uint8_t*   buffer;
+		uint64_t   offset;
+		uint64_t   size;
+	};
+
+	struct OpOrder
+	{
+		bool operator()(const AsyncIoOp* lhs, const AsyncIoOp* rhs) const;
+	};
+
+	struct ReadWindow
+	{
+		uint64_t readEnd     = 0;
+		uint64_t prefetchEnd = 0;
+	};
+
+	struct FileState
+	{
+		std::shared_ptr<VfsFile> hostFile;
+		ReadWindow               window;
+	};
+
+	// Reopens the guest's file on first use.
+	int getHostFile(const VfsFile& file, std::shared_ptr<VfsFile>* hostFile);
+
+	bool takeChunkLocked(Chunk& chunk);
+
+	void completeChunk(const Chunk& chunk, int64_t result);
+
+	void completeOp(AsyncIoOp* op);
+
+	void updateReadahead(AsyncIoOp* op);
+
+	// Runs the chunk on the calling thread.
+	int64_t runChunk(const Chunk& chunk);
+
+	void runWorker();
+
+	void notifyBackend();
+
+#ifdef GPCS4_LINUX
+	struct IoRing;
+
+	static void prepareSqe(IoRing& ring, uint8_t opcode, int fd,
+						   const void* address, uint32_t length, uint64_t offset, uint64_t userData);
+
+	bool createRing();
+
+	void destroyRing();
+
+	void runRing();
+#endif  // GPCS4_LINUX
+
+private:
+	VirtualFileSystem& m_vfs;
+	AsyncIoDesc        m_desc;
+	AsyncIoBackend     m_backend = AsyncIoBackend::ThreadPool;
+	std::atomic<bool>  m_running = false;
+
+	std::vector<std::thread> m_threads;
+
+	std::mutex                      m_queueMutex;
+	std::condition_variable         m_queueCond;
+	std::set<AsyncIoOp*, OpOrder>   m_queue;
+	uint64_t                        m_sequence = 0;
+
+	// Guest files with ops since they were opened, by guest handle.
+	std::mutex                              m_fileMutex;
+	std::unordered_map<intptr_t, FileState> m_files;
+
+	std::atomic<uint64_t> m_submitCount         = 0;
+	std::atomic<uint64_t> m_completeCount       = 0;
+	std::atomic<uint64_t> m_chunkCount          = 0;
+	std::atomic<uint64_t> m_byteCount           = 0;
+	std::atomic<uint64_t> m_readaheadCount      = 0;
+	std::atomic<uint64_t> m_missedDeadlineCount = 0;
+
+#ifdef GPCS4_LINUX
+	std::unique_ptr<IoRing> m_ring;
+#endif  // GPCS4_LINUX
+};
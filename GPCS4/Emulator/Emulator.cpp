@@ -1,18 +1,30 @@
 #include "Emulator.h"
+#include "AsyncIoEngine.h"
 #include "Module.h"
 #include "GameThread.h"
+#include "GuestClock.h"
+#include "HleProfiler.h"
+#include "ThreadAffinity.h"
+#include "VirtualFileSystem.h"
 #include "SceModuleSystem.h"
 #include "VirtualCPU.h"
 #include "VirtualGPU.h"
+#include "Sce/SceCapture.h"
 #include "Sce/SceGnmDriver.h"
 #include "Sce/SceVideoOut.h"
+#include "UtilProfiler.h"
+
+#include <filesystem>
 
 LOG_CHANNEL(Emulator);
 
 Emulator::Emulator() 
 {
-	m_cpu = std::make_shared<VirtualCPU>();
-	m_gpu = std::make_shared<sce::VirtualGPU>();
+	m_cpu      = std::make_shared<VirtualCPU>();
+	m_affinity = std::make_unique<ThreadAffinityMapper>();
+	m_vfs      = std::make_unique<VirtualFileSystem>();
+	m_aio      = std::make_unique<AsyncIoEngine>(*m_vfs);
+	m_clock    = std::make_unique<GuestClock>();
 }
 
 Emulator::~Emulator() {}
@@ -65,11 +77,72 @@ bool Emulator::executeEntry(NativeModule const& mod)
 	return ret;
 }
 
-bool Emulator::Init()
+bool Emulator::Init(const EmulatorOptions& options)
 {
 	bool bRet = false;
 	do
 	{
+		m_options = options;
+
+		// Before anything reads the time, the base
+		// of the process time is taken here too.
+		GuestClockDesc clockDesc;
+		clockDesc.source = m_options.clockSource;
+		if (!m_clock->initialize(clockDesc))
+		{
+			break;
+		}
+
+		if (!m_options.profilePath.empty())
+		{
+			util::prof::ProfilerDesc profDesc;
+			profDesc.path       = m_options.profilePath;
+			profDesc.startFrame = m_options.profileStartFrame;
+			profDesc.frameCount = m_options.profileFrameCount;
+			util::prof::initialize(profDesc);
+		}
+
+		// Must be enabled before modules are linked.
+		if (m_options.hleProfile)
+		{
+			HleProfilerDesc hleDesc;
+			hleDesc.reportInterval = m_options.hleProfileInterval;
+			hleDesc.reportCount    = m_options.hleProfileCount;
+			if (!HleProfiler::GetInstance()->initialize(hleDesc))
+			{
+				LOG_WARN("HLE profiler is not available");
+			}
+		}
+
+		// Emulator threads created from now on
+		// are bound to their own cores.
+		m_affinity->initialize(m_options.affinityMode, m_options.reservedCoreCount);
+
+		// GPU creation depends on options,
+		// e.g. whether we have a display window.
+		m_gpu = std::make_shared<sce::VirtualGPU>(m_options.headless, m_options.refreshRate);
+
+		if (!m_options.capturePath.empty())
+		{
+			sce::SceCaptureDesc captureDesc;
+			captureDesc.path       = m_options.capturePath;
+			captureDesc.startFrame = m_options.captureStartFrame;
+			captureDesc.frameCount = m_options.captureFrameCount;
+			m_gpu->capture().initialize(captureDesc);
+		}
+
+		if (!mountFileSystem())
+		{
+			break;
+		}
+
+		AsyncIoDesc aioDesc;
+		aioDesc.backend = m_options.aioBackend;
+		if (!m_aio->initialize(aioDesc))
+		{
+			break;
+		}
+
 		if (!registerModules())
 		{
 			break;
@@ -84,6 +157,46 @@ void Emulator::Unit()
 {
 	auto modManager = CSceModuleSystem::GetInstance();
 	modManager->clearModules();
+
+	m_aio->dumpStats();
+	m_aio->destroy();
+
+	m_affinity->dumpStats();
+	m_vfs->dumpStats();
+	HleProfiler::GetInstance()->dumpStats();
+}
+
+bool Emulator::mountFileSystem()
+{
+	bool ret = false;
+	do
+	{
+		// The game directory is the working directory,
+		// save data and temporary files are kept next to it.
+		std::error_code error;
+		auto            workingDir = std::filesystem::current_path(error);
+		if (error)
+		{
+			LOG_ERR("get working directory failed");
+			break;
+		}
+
+		auto savePath = workingDir / "savedata0";
+		auto tempPath = workingDir / "temp0";
+		std::filesystem::create_directories(savePath, error);
+		std::filesystem::create_directories(tempPath, error);
+
+		if (!m_vfs->mount("/app0", workingDir.string()) ||
+			!m_vfs->mount("/savedata0", savePath.string()) ||
+			!m_vfs->mount("/temp0", tempPath.string()) ||
+			!m_vfs->mountDevices("/dev"))
+		{
+			break;
+		}
+
+		ret = true;
+	} while (false);
+	return ret;
 }
 
 bool Emulator::Run(NativeModule const &mod)
@@ -121,5 +234,30 @@ sce::VirtualGPU& Emulator::GPU()
 	return *m_gpu;
 }
 
+ThreadAffinityMapper& Emulator::affinity()
+{
+	return *m_affinity;
+}
+
+VirtualFileSystem& Emulator::vfs()
+{
+	return *m_vfs;
+}
+
+AsyncIoEngine& Emulator::aio()
+{
+	return *m_aio;
+}
+
+GuestClock& Emulator::clock()
+{
+	return *m_clock;
+}
+
+const EmulatorOptions& Emulator::options() const
+{
+	return m_options;
+}
+
 void PS4API Emulator::LastExitHandler(void) { LOG_DEBUG("program exit."); }
 
@@ -1,11 +1,16 @@
 #pragma once
 
 #include "GPCS4Common.h"
+#include "EmulatorOptions.h"
 #include "UtilSingleton.h"
 
 #include <memory>
 
 class VirtualCPU;
+class ThreadAffinityMapper;
+class VirtualFileSystem;
+class AsyncIoEngine;
+class GuestClock;
 namespace sce
 {
 	class VirtualGPU;
@@ -20,7 +25,7 @@ class Emulator final : public util::Singleton<Emulator>
 	friend class util::Singleton<Emulator>;
 
 public:
-	bool Init();
+	bool Init(const EmulatorOptions& options);
 
 	void Unit();
 
@@ -30,6 +35,16 @@ public:
 
 	sce::VirtualGPU& GPU();
 
+	ThreadAffinityMapper& affinity();
+
+	VirtualFileSystem& vfs();
+
+	AsyncIoEngine& aio();
+
+	GuestClock& clock();
+
+	const EmulatorOptions& options() const;
+
 private:
 	Emulator();
 	~Emulator();
@@ -37,6 +52,8 @@ private:
 private:
 	bool registerModules();
 
+	bool mountFileSystem();
+
 	void loadIntoCPU(NativeModule const& mod);
 
 	bool executeEntry(NativeModule const& mod);
@@ -44,8 +61,14 @@ private:
 	static void PS4API LastExitHandler(void);
 
 private:
+	EmulatorOptions                  m_options;
 	std::shared_ptr<VirtualCPU>      m_cpu;
 	std::shared_ptr<sce::VirtualGPU> m_gpu;
+
+	std::unique_ptr<ThreadAffinityMapper> m_affinity;
+	std::unique_ptr<VirtualFileSystem>    m_vfs;
+	std::unique_ptr<AsyncIoEngine>        m_aio;
+	std::unique_ptr<GuestClock>           m_clock;
 };
 
 // for convenience access
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "GPCS4Common.h"
+#include "AsyncIoEngine.h"
+#include "GuestClock.h"
+#include "ThreadAffinity.h"
+
+#include <string>
+
+/**
+ * \brief Runtime options
+ *
+ * Parsed from command line in main,
+ * and passed to the emulator on init.
+ */
+struct EmulatorOptions
+{
+	// Run without a window, display buffers are
+	// presented into offscreen images instead.
+	bool headless = false;
+
+	// Vblanks per second of the display, flips are retired
+	// at vblank. 0 means flips are not paced at all.
+	uint32_t refreshRate = 60;
+
+	// Pad input script replayed instead of the keyboard,
+	// empty means the keyboard is used.
+	std::string padScriptPath;
+
+	// Dump every Nth presented frame to a png file
+	// in headless mode, 0 means discard all frames.
+	uint32_t frameDumpInterval = 0;
+
+	// Directory where the dumped frames are written to.
+	std::string frameDumpPath = ".";
+
+	// Chrome trace file the profiler writes to,
+	// empty means the profiler is disabled.
+	std::string profilePath;
+
+	// Range of frames to profile.
+	uint32_t profileStartFrame = 0;
+	uint32_t profileFrameCount = 60;
+
+	// Count calls to HLE functions and time them.
+	bool hleProfile = false;
+
+	// Report HLE calls every N frames, 0 to only report on exit.
+	uint32_t hleProfileInterval = 0;
+
+	// Number of HLE functions listed in a report.
+	uint32_t hleProfileCount = 30;
+
+	// PM4 capture file to write,
+	// empty means capturing is disabled.
+	std::string capturePath;
+
+	// Range of frames to capture.
+	uint32_t captureStartFrame = 0;
+	uint32_t captureFrameCount = 1;
+
+	// How guest thread affinity masks are applied to host cores.
+	AffinityMode affinityMode = AffinityMode::Loose;
+
+	// Host cores kept for emulator threads.
+	uint32_t reservedCoreCount = 1;
+
+	// Backend of the async io engine behind Fios2 and sceKernelAio.
+	AsyncIoBackend aioBackend = AsyncIoBackend::ThreadPool;
+
+	// Where the time the guest reads comes from.
+	GuestClockSource clockSource = GuestClockSource::Auto;
+};
@@ -1,5 +1,7 @@
 #include "GameThread.h"
 #include "TLSHandler.h"
+#include "ThreadAffinity.h"
+#include "Emulator.h"
 #include "Platform/PlatThread.h"
 
 #define PS4_MAIN_THREAD_STACK_SIZE (1024 * 1024 * 5)
@@ -80,8 +82,14 @@ void* CGameThread::ThreadFunc(void* pArg)
 			break;
 		}
 
+		auto& affinity = TheEmulator().affinity();
+		affinity.setThreadName(pthread_self(), "main");
+		affinity.bindGuestThread(pthread_self(), nullptr, ThreadAffinityMapper::DefaultGuestMask);
+
 		void* pRet = RunGameThread(pThis);
 
+		affinity.removeThread(pthread_self());
+
 		TLSManager* tlsMgr = TLSManager::GetInstance();
 		tlsMgr->notifyThreadExit();
 
@@ -0,0 +1,142 @@
+#include "GuestClock.h"
+#include "Platform/PlatHardware.h"
+#include "Platform/PlatProcess.h"
+
+#include <thread>
+
+LOG_CHANNEL(Emulator.GuestClock);
+
+// Host clock reads bracketed by tsc reads,
+// the narrowest bracket is kept.
+constexpr uint32_t ClockSampleTries = 16;
+
+// Anything slower isn't a tsc that's ticking right.
+constexpr uint64_t MinTscFrequency = 100000000;
+
+constexpr uint64_t NanosecondsPerSecond = 1000000000;
+
+struct ClockSample
+{
+	// Middle of the bracket.
+	uint64_t tsc;
+	uint64_t time;
+};
+
+template <typename Func>
+static ClockSample sampleClock(Func readTime)
+{
+	ClockSample sample = {};
+	uint64_t    width  = UINT64_MAX;
+	for (uint32_t i = 0; i != ClockSampleTries; ++i)
+	{
+		uint64_t before = __rdtsc();
+		uint64_t time   = readTime();
+		uint64_t after  = __rdtsc();
+		if (after - before < width)
+		{
+			width  = after - before;
+			sample = { before + width / 2, time };
+		}
+	}
+	return sample;
+}
+
+
+GuestClock::GuestClock()
+{
+}
+
+GuestClock::~GuestClock()
+{
+}
+
+bool GuestClock::initialize(const GuestClockDesc& desc)
+{
+	m_tscBased     = false;
+	m_tscFrequency = NanosecondsPerSecond;
+	m_nsPerTick    = 1ull << 32;
+
+	if (desc.source == GuestClockSource::Auto)
+	{
+		if (!plat::IsTscInvariant())
+		{
+			LOG_WARN("host tsc is not invariant, using the host clock");
+		}
+		else if (!calibrate(desc.calibrationMs))
+		{
+			LOG_WARN("calibrating the tsc failed, using the host clock");
+		}
+	}
+
+	if (!m_tscBased)
+	{
+		m_baseTsc       = hostNow();
+		m_baseMonotonic = m_baseTsc;
+		m_baseUtc       = hostUtc();
+	}
+
+	LOG_DEBUG("guest clock from the %s, %llu Hz", m_tscBased ? "tsc" : "host clock", m_tscFrequency);
+	return true;
+}
+
+bool GuestClock::isTscBased() const
+{
+	return m_tscBased;
+}
+
+uint64_t GuestClock::toTsc(uint64_t monotonicNs) const
+{
+	auto delta = static_cast<int64_t>(monotonicNs - m_baseMonotonic);
+	auto ticks = static_cast<int64_t>(static_cast<double>(delta) * m_tscFrequency / NanosecondsPerSecond);
+	return m_baseTsc + static_cast<uint64_t>(ticks);
+}
+
+uint64_t GuestClock::hostUtc()
+{
+	auto time = std::chrono::system_clock::now().time_since_epoch();
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+}
+
+uint64_t GuestClock::cpuTime(GuestClockType type) const
+{
+	return type == GuestClockType::ThreadCpu ? plat::GetThreadCpuTime() : plat::GetProcessCpuTime();
+}
+
+bool GuestClock::calibrate(uint32_t calibrationMs)
+{
+	bool ret = false;
+	do
+	{
+		ClockSample start = sampleClock(&GuestClock::hostNow);
+		std::this_thread::sleep_for(std::chrono::milliseconds(calibrationMs));
+		ClockSample end = sampleClock(&GuestClock::hostNow);
+
+		uint64_t ticks = end.tsc - start.tsc;
+		uint64_t time  = end.time - start.time;
+		// The scale is computed in 64 bits, about 4 seconds at most.
+		if (ticks == 0 || time == 0 || time >= (1ull << 32))
+		{
+			break;
+		}
+
+		uint64_t frequency = static_cast<uint64_t>(static_cast<double>(ticks) * NanosecondsPerSecond / time + 0.5);
+		if (frequency < MinTscFrequency)
+		{
+			break;
+		}
+
+		// Scaled from the measurement itself, not the rounded frequency.
+		m_nsPerTick     = (time << 32) / ticks;
+		m_tscFrequency  = frequency;
+		m_baseTsc       = end.tsc;
+		m_baseMonotonic = end.time;
+
+		// Taken a little later, moved back to the base.
+		ClockSample utc = sampleClock(&GuestClock::hostUtc);
+		m_baseUtc       = utc.time - ticksToNs(utc.tsc - m_baseTsc);
+
+		m_tscBased = true;
+		ret        = true;
+	} while (false);
+	return ret;
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "GPCS4Common.h"
+
+#include <chrono>
+
+#ifdef GPCS4_WINDOWS
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif  // GPCS4_WINDOWS
+
+enum class GuestClockSource
+{
+	// The tsc where the host's is invariant, the host steady clock otherwise.
+	Auto,
+	// The host steady clock, read on every call.
+	Host,
+};
+
+enum class GuestClockType
+{
+	// Since an arbitrary point in the past, never goes back.
+	// Same epoch as the host steady clock.
+	Monotonic,
+	// Since 1970-01-01 00:00:00 UTC.
+	Utc,
+	// Since the clock was initialized, about when the game started.
+	Process,
+	// Cpu time of the whole process, always a host call.
+	ProcessCpu,
+	// Cpu time of the calling thread, always a host call.
+	ThreadCpu,
+};
+
+struct GuestClockDesc
+{
+	GuestClockSource source = GuestClockSource::Auto;
+	// How long the tsc is measured against the host clock.
+	uint32_t calibrationMs = 50;
+};
+
+/**
+ * \brief Time the guest reads
+ *
+ * Backs the kernel time functions and the tsc the guest sees.
+ * With an invariant tsc its frequency is measured once against
+ * the host clock, then every clock is the tsc scaled by a fixed
+ * point factor and added to a base time, no system call is made.
+ *
+ * Bases are taken on initialize and never adjusted, so the
+ * UTC clock doesn't follow later changes of the host time.
+ */
+class GuestClock
+{
+public:
+	GuestClock();
+	~GuestClock();
+
+	bool initialize(const GuestClockDesc& desc);
+
+	// Whether clocks are served from the tsc.
+	bool isTscBased() const;
+
+	// Ticks of the tsc the guest sees.
+	uint64_t readTsc() const
+	{
+		return m_tscBased ? __rdtsc() : hostNow();
+	}
+
+	uint64_t tscFrequency() const
+	{
+		return m_tscFrequency;
+	}
+
+	// Tsc ticks since the clock was initialized.
+	uint64_t processTicks() const
+	{
+		return readTsc() - m_baseTsc;
+	}
+
+	// Nanoseconds.
+	uint64_t now(GuestClockType type) const
+	{
+		uint64_t time = 0;
+		switch (type)
+		{
+		case GuestClockType::Monotonic:
+			time = m_baseMonotonic + ticksToNs(processTicks());
+			break;
+		case GuestClockType::Utc:
+			time = m_baseUtc + ticksToNs(processTicks());
+			break;
+		case GuestClockType::Process:
+			time = ticksToNs(processTicks());
+			break;
+		default:
+			time = cpuTime(type);
+			break;
+		}
+		return time;
+	}
+
+	/**
+	 * \brief Converts a monotonic time to tsc ticks
+	 *
+	 * Wraps around for times before the tsc was reset,
+	 * adding ticks to the result is still right.
+	 */
+	uint64_t toTsc(uint64_t monotonicNs) const;
+
+private:
+	static uint64_t hostNow()
+	{
+		auto time = std::chrono::steady_clock::now().time_since_epoch();
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+	}
+
+	static uint64_t hostUtc();
+
+	// (a * b) >> 32 without overflowing.
+	static uint64_t mulShift32(uint64_t a, uint64_t b)
+	{
+#ifdef GPCS4_WINDOWS
+		uint64_t high = 0;
+		uint64_t low  = _umul128(a, b, &high);
+		return (high << 32) | (low >> 32);
+#else
+		return static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b) >> 32);
+#endif  // GPCS4_WINDOWS
+	}
+
+	uint64_t ticksToNs(uint64_t ticks) const
+	{
+		return mulShift32(ticks, m_nsPerTick);
+	}
+
+	uint64_t cpuTime(GuestClockType type) const;
+
+	bool calibrate(uint32_t calibrationMs);
+
+private:
+	bool m_tscBased = false;
+	// Ticks per second.
+	uint64_t m_tscFrequency = 1000000000;
+	// Nanoseconds per tick, 32.32 fixed point.
+	uint64_t m_nsPerTick = 1ull << 32;
+	// Times at m_baseTsc, in nanoseconds.
+	uint64_t m_baseTsc       = 0;
+	uint64_t m_baseMonotonic = 0;
+	uint64_t m_baseUtc       = 0;
+};
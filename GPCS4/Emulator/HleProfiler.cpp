@@ -0,0 +1,271 @@
+#include "HleProfiler.h"
+#include "Platform/PlatThread.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifdef GPCS4_WINDOWS
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif  // GPCS4_WINDOWS
+
+LOG_CHANNEL(Emulator.HleProfiler);
+
+// These don't return to their caller exactly once,
+// so their stubs can't take over the return address.
+static const char* const g_countOnlyFunctions[] = {
+	"setjmp",
+	"_setjmp",
+	"longjmp",
+	"_longjmp",
+	"exit",
+	"abort",
+	"pthread_exit",
+	"scePthreadExit",
+	"sceFiberRun",
+	"sceFiberSwitch",
+	"sceFiberReturnToThread",
+};
+
+static bool isCountOnly(const char* name)
+{
+	bool ret = false;
+	for (auto function : g_countOnlyFunctions)
+	{
+		if (name && std::strcmp(name, function) == 0)
+		{
+			ret = true;
+			break;
+		}
+	}
+	return ret;
+}
+
+HleProfiler::HleProfiler()
+{
+}
+
+HleProfiler::~HleProfiler()
+{
+}
+
+bool HleProfiler::initialize(const HleProfilerDesc& desc)
+{
+	bool ret = false;
+	do
+	{
+		if (m_enabled)
+		{
+			ret = true;
+			break;
+		}
+
+		if (!plat::AllocateThreadSlot(&m_slot))
+		{
+			LOG_ERR("allocate thread slot failed");
+			break;
+		}
+
+		size_t stubSize = std::max(m_generator.size(), m_generator.attachRoutineSize());
+		// One more for the attach routine.
+		m_pool = std::make_unique<JitFunctionPool>(stubSize, ProfileStubMaxCount + 1);
+
+		m_attachRoutine = m_pool->newFunctionMemory();
+		if (!m_generator.generateAttachRoutine(m_attachRoutine, &HleProfiler::attachThread))
+		{
+			break;
+		}
+
+		m_desc      = desc;
+		m_startTick = __rdtsc();
+		m_startTime = std::chrono::steady_clock::now();
+		m_enabled   = true;
+
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+bool HleProfiler::isEnabled() const
+{
+	return m_enabled;
+}
+
+void* HleProfiler::instrument(void* function, uint64_t nid, const char* name)
+{
+	return instrument(function, nid, name, !isCountOnly(name));
+}
+
+void* HleProfiler::instrument(void* function, uint64_t nid, const char* name, bool timed)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	void* stub = function;
+	do
+	{
+		if (!m_enabled || function == nullptr)
+		{
+			break;
+		}
+
+		auto iter = m_stubTable.find(function);
+		if (iter != m_stubTable.end())
+		{
+			stub = iter->second;
+			break;
+		}
+
+		if (m_stubs.size() == ProfileStubMaxCount)
+		{
+			LOG_WARN("too many functions to profile, %s is not counted", name ? name : "");
+			break;
+		}
+
+		auto memory = m_pool->newFunctionMemory();
+		if (!m_generator.attach(memory, timed))
+		{
+			break;
+		}
+
+		m_generator.patchThreadSlot(m_slot);
+		m_generator.patchAttachRoutine(m_attachRoutine);
+		m_generator.patchCounterIndex(static_cast<uint32_t>(m_stubs.size()));
+		m_generator.patchDestPointer(function);
+
+		m_stubs.push_back({ function, nid, name, timed });
+		m_stubTable.emplace(function, memory);
+		stub = memory;
+	} while (false);
+	return stub;
+}
+
+void HleProfiler::attachThread()
+{
+	auto profiler    = GetInstance();
+	auto thread      = std::make_unique<ProfileStubThread>();
+	thread->threadId = plat::GetThreadId();
+
+	plat::SetThreadSlotValue(profiler->m_slot, thread.get());
+
+	std::lock_guard<std::mutex> lock(profiler->m_mutex);
+	profiler->m_threads.push_back(std::move(thread));
+}
+
+void HleProfiler::nextFrame()
+{
+	do
+	{
+		if (!m_enabled || m_desc.reportInterval == 0)
+		{
+			break;
+		}
+
+		if (++m_frameIndex % m_desc.reportInterval != 0)
+		{
+			break;
+		}
+
+		dumpStats();
+	} while (false);
+}
+
+double HleProfiler::getTickPeriodNs() const
+{
+	auto     elapsed = std::chrono::steady_clock::now() - m_startTime;
+	uint64_t ticks   = __rdtsc() - m_startTick;
+	auto     ns      = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+	return ticks != 0 ? static_cast<double>(ns) / ticks : 0.0;
+}
+
+std::vector<HleProfilerEntry> HleProfiler::getStats() const
+{
+	std::vector<HleProfilerEntry> entries;
+
+	double tickPeriod = getTickPeriodNs();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	entries.reserve(m_stubs.size());
+	for (size_t i = 0; i != m_stubs.size(); ++i)
+	{
+		auto const& stub = m_stubs[i];
+
+		// Other threads keep counting while this reads,
+		// every counter is a single aligned store.
+		uint64_t callCount = 0;
+		uint64_t tickCount = 0;
+		for (auto const& thread : m_threads)
+		{
+			callCount += thread->counters[i].callCount;
+			tickCount += thread->counters[i].tickCount;
+		}
+
+		if (callCount == 0)
+		{
+			continue;
+		}
+
+		HleProfilerEntry entry = {};
+		entry.nid              = stub.nid;
+		entry.name             = stub.name;
+		entry.callCount        = callCount;
+		entry.timeNs           = static_cast<uint64_t>(tickCount * tickPeriod);
+		entry.timed            = stub.timed;
+		entries.push_back(entry);
+	}
+	return entries;
+}
+
+void HleProfiler::dumpStats() const
+{
+	do
+	{
+		if (!m_enabled)
+		{
+			break;
+		}
+
+		auto entries = getStats();
+		auto count   = std::min<size_t>(entries.size(), m_desc.reportCount);
+
+		size_t threadCount = 0;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			threadCount = m_threads.size();
+		}
+
+		auto printEntry = [](HleProfilerEntry const& entry)
+		{
+			std::printf("  %016llX %-40s %12llu calls %10.3f ms %8llu ns/call%s\n",
+						static_cast<unsigned long long>(entry.nid),
+						entry.name ? entry.name : "",
+						static_cast<unsigned long long>(entry.callCount),
+						entry.timeNs / 1000000.0,
+						static_cast<unsigned long long>(entry.timeNs / entry.callCount),
+						entry.timed ? "" : " (count only)");
+		};
+
+		// Reported in every build, not only where debug logs are.
+		std::printf("hle profile: %zu functions called on %zu threads\n",
+					entries.size(), threadCount);
+
+		std::partial_sort(entries.begin(), entries.begin() + count, entries.end(),
+						  [](auto const& lhs, auto const& rhs)
+						  { return lhs.timeNs > rhs.timeNs; });
+		std::printf("by inclusive time:\n");
+		for (size_t i = 0; i != count; ++i)
+		{
+			printEntry(entries[i]);
+		}
+
+		std::partial_sort(entries.begin(), entries.begin() + count, entries.end(),
+						  [](auto const& lhs, auto const& rhs)
+						  { return lhs.callCount > rhs.callCount; });
+		std::printf("by call count:\n");
+		for (size_t i = 0; i != count; ++i)
+		{
+			printEntry(entries[i]);
+		}
+	} while (false);
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "GPCS4Common.h"
+#include "UtilSingleton.h"
+#include "Loader/FuncStub.h"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \brief HLE profiler description
+ */
+struct HleProfilerDesc
+{
+	// Report every N frames, 0 to only report on exit.
+	uint32_t reportInterval;
+	// Number of functions listed in a report.
+	uint32_t reportCount;
+};
+
+/**
+ * \brief Calls to one HLE function, summed over all threads
+ */
+struct HleProfilerEntry
+{
+	uint64_t    nid;
+	const char* name;
+	uint64_t    callCount;
+	// Zero for functions which are only counted.
+	uint64_t    timeNs;
+	bool        timed;
+};
+
+/**
+ * \brief Counts calls to HLE functions
+ *
+ * When enabled, the linker resolves imported HLE functions
+ * to profile stubs instead, see \ref ProfileStubGenerator.
+ * Each thread counts into a block of its own, found through
+ * a thread slot, so the stubs take no locks and allocate nothing.
+ * Blocks are kept when their thread exits, to be reported.
+ */
+class HleProfiler final : public util::Singleton<HleProfiler>
+{
+	friend class util::Singleton<HleProfiler>;
+
+public:
+	bool initialize(const HleProfilerDesc& desc);
+
+	bool isEnabled() const;
+
+	/**
+	 * \brief Gets the stub of an HLE function
+	 *
+	 * All imports of a function share one stub.
+	 * \returns The function itself if no stub can be made
+	 */
+	void* instrument(void* function, uint64_t nid, const char* name);
+
+	/**
+	 * \brief Same, with the kind of stub given
+	 *
+	 * \param [in] timed False to only count calls
+	 */
+	void* instrument(void* function, uint64_t nid, const char* name, bool timed);
+
+	/**
+	 * \brief Called once per flip for periodic reports
+	 */
+	void nextFrame();
+
+	std::vector<HleProfilerEntry> getStats() const;
+
+	// Prints the top functions to stdout.
+	void dumpStats() const;
+
+private:
+	HleProfiler();
+	~HleProfiler();
+
+	struct Stub
+	{
+		void*       function;
+		uint64_t    nid;
+		const char* name;
+		bool        timed;
+	};
+
+	static void attachThread();
+
+	double getTickPeriodNs() const;
+
+private:
+	HleProfilerDesc m_desc    = {};
+	bool            m_enabled = false;
+
+	plat::ThreadSlot                 m_slot = {};
+	std::unique_ptr<JitFunctionPool> m_pool;
+	ProfileStubGenerator             m_generator;
+	void*                            m_attachRoutine = nullptr;
+
+	mutable std::mutex                              m_mutex;
+	std::vector<Stub>                               m_stubs;
+	std::unordered_map<void*, void*>                m_stubTable;
+	std::vector<std::unique_ptr<ProfileStubThread>> m_threads;
+
+	uint64_t                              m_startTick = 0;
+	std::chrono::steady_clock::time_point m_startTime;
+	uint32_t                              m_frameIndex = 0;
+};
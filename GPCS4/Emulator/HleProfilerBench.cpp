@@ -0,0 +1,198 @@
+#include "HleProfilerBench.h"
+#include "HleProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+LOG_CHANNEL(Emulator.HleProfilerBench);
+
+namespace
+{
+	typedef uint64_t(PS4API* PFUNC_BenchSum)(uint64_t a, uint64_t b, uint64_t c, uint64_t d,
+											 uint64_t e, uint64_t f, uint64_t g, uint64_t h);
+	typedef double(PS4API* PFUNC_BenchScale)(double value, uint64_t factor, float offset);
+	typedef uint64_t(PS4API* PFUNC_BenchOuter)(uint64_t value);
+
+	// Bodies differ, so the linker can't fold them into one function.
+
+	uint64_t PS4API benchSumTimed(uint64_t a, uint64_t b, uint64_t c, uint64_t d,
+								  uint64_t e, uint64_t f, uint64_t g, uint64_t h)
+	{
+		return a + b * 2 + c * 3 + d * 4 + e * 5 + f * 6 + g * 7 + h * 8;
+	}
+
+	uint64_t PS4API benchSumCounted(uint64_t a, uint64_t b, uint64_t c, uint64_t d,
+									uint64_t e, uint64_t f, uint64_t g, uint64_t h)
+	{
+		return a * 8 + b * 7 + c * 6 + d * 5 + e * 4 + f * 3 + g * 2 + h;
+	}
+
+	double PS4API benchScale(double value, uint64_t factor, float offset)
+	{
+		return value * factor + offset;
+	}
+
+	// Stub of benchSumTimed, called from benchOuter.
+	PFUNC_BenchSum volatile g_innerFunc = nullptr;
+
+	uint64_t PS4API benchOuter(uint64_t value)
+	{
+		return g_innerFunc(value, 1, 2, 3, 4, 5, 6, 7) + 1;
+	}
+
+	template <typename Func>
+	uint64_t callMany(uint32_t count, Func func)
+	{
+		uint64_t sum = 0;
+		for (uint32_t i = 0; i != count; ++i)
+		{
+			sum += func(i);
+		}
+		return sum;
+	}
+
+	const HleProfilerEntry* findEntry(std::vector<HleProfilerEntry> const& entries, uint64_t nid)
+	{
+		auto iter = std::find_if(entries.begin(), entries.end(),
+								 [nid](HleProfilerEntry const& entry)
+								 { return entry.nid == nid; });
+		return iter != entries.end() ? &(*iter) : nullptr;
+	}
+
+}  // namespace
+
+HleProfilerBench::HleProfilerBench(const HleProfilerBenchDesc& desc) :
+	m_desc(desc)
+{
+}
+
+HleProfilerBench::~HleProfilerBench()
+{
+}
+
+bool HleProfilerBench::run()
+{
+	bool ret = false;
+	do
+	{
+		if (m_desc.callCount == 0)
+		{
+			std::printf("Nothing to run, call count is 0.\n");
+			break;
+		}
+
+		auto profiler = HleProfiler::GetInstance();
+		if (!profiler->initialize(HleProfilerDesc{ 0, 0 }))
+		{
+			std::printf("Enabling the HLE profiler failed.\n");
+			break;
+		}
+
+		auto timedFunc   = reinterpret_cast<PFUNC_BenchSum>(profiler->instrument(
+			reinterpret_cast<void*>(&benchSumTimed), 1, "benchSumTimed", true));
+		auto countedFunc = reinterpret_cast<PFUNC_BenchSum>(profiler->instrument(
+			reinterpret_cast<void*>(&benchSumCounted), 2, "benchSumCounted", false));
+		auto scaleFunc   = reinterpret_cast<PFUNC_BenchScale>(profiler->instrument(
+			reinterpret_cast<void*>(&benchScale), 3, "benchScale", true));
+		auto outerFunc   = reinterpret_cast<PFUNC_BenchOuter>(profiler->instrument(
+			reinterpret_cast<void*>(&benchOuter), 4, "benchOuter", true));
+		g_innerFunc      = timedFunc;
+
+		if (reinterpret_cast<void*>(timedFunc) == reinterpret_cast<void*>(&benchSumTimed) ||
+			reinterpret_cast<void*>(countedFunc) == reinterpret_cast<void*>(&benchSumCounted))
+		{
+			std::printf("Creating profile stubs failed.\n");
+			break;
+		}
+
+		// Arguments and return values, checked before timing,
+		// the first call also attaches this thread.
+		bool passed = true;
+		passed &= timedFunc(1, 2, 3, 4, 5, 6, 7, 8) == benchSumTimed(1, 2, 3, 4, 5, 6, 7, 8);
+		passed &= countedFunc(1, 2, 3, 4, 5, 6, 7, 8) == benchSumCounted(1, 2, 3, 4, 5, 6, 7, 8);
+		passed &= scaleFunc(1.5, 3, 0.25f) == benchScale(1.5, 3, 0.25f);
+		passed &= outerFunc(9) == benchSumTimed(9, 1, 2, 3, 4, 5, 6, 7) + 1;
+		if (!passed)
+		{
+			std::printf("Results through the stubs differ from direct calls.\n");
+			break;
+		}
+
+		PFUNC_BenchSum volatile directPointer  = &benchSumTimed;
+		PFUNC_BenchSum volatile countedPointer = countedFunc;
+		PFUNC_BenchSum volatile timedPointer   = timedFunc;
+
+		uint32_t callCount = m_desc.callCount;
+		auto     callWith  = [callCount](PFUNC_BenchSum volatile& pointer)
+		{
+			return [callCount, &pointer]()
+			{
+				callMany(callCount, [&pointer](uint64_t i)
+						 { return pointer(i, 1, 2, 3, 4, 5, 6, 7); });
+			};
+		};
+
+		double directTime  = measure(callWith(directPointer));
+		double countedTime = measure(callWith(countedPointer));
+		double timedTime   = measure(callWith(timedPointer));
+		double nestedTime  = measure([callCount, outerFunc]()
+									 { callMany(callCount, outerFunc); });
+
+		uint32_t repeatCount = std::max(m_desc.repeatCount, 1u);
+		auto     stats       = profiler->getStats();
+		auto     timed       = findEntry(stats, 1);
+		auto     counted     = findEntry(stats, 2);
+		auto     outer       = findEntry(stats, 4);
+
+		// One checked call each, every outer call calls the timed function too.
+		uint64_t testCallCount   = uint64_t(callCount) * repeatCount;
+		uint64_t expectedCounted = testCallCount + 1;
+		uint64_t expectedOuter   = testCallCount + 1;
+		uint64_t expectedTimed   = testCallCount * 2 + 2;
+
+		auto nsPerCall = [callCount](double time)
+		{ return time * 1000000000.0 / callCount; };
+
+		std::printf("Calls          : %u per test, 8 arguments, 2 on the stack\n", callCount);
+		std::printf("  Direct       : %.2f ns/call\n", nsPerCall(directTime));
+		std::printf("  Count stub   : %.2f ns/call, %+.2f ns\n",
+					nsPerCall(countedTime), nsPerCall(countedTime - directTime));
+		std::printf("  Timed stub   : %.2f ns/call, %+.2f ns\n",
+					nsPerCall(timedTime), nsPerCall(timedTime - directTime));
+		std::printf("  Nested timed : %.2f ns/call, two stubs per call\n", nsPerCall(nestedTime));
+
+		if (!timed || !counted || !outer ||
+			timed->callCount != expectedTimed ||
+			counted->callCount != expectedCounted ||
+			outer->callCount != expectedOuter)
+		{
+			std::printf("Call counts are wrong.\n");
+			break;
+		}
+
+		std::printf("Counted        : %llu timed calls in %.3f ms, %llu nested in %.3f ms\n",
+					timed->callCount, timed->timeNs / 1000000.0,
+					outer->callCount, outer->timeNs / 1000000.0);
+
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+template <typename Func>
+double HleProfilerBench::measure(Func func)
+{
+	uint32_t repeatCount = std::max(m_desc.repeatCount, 1u);
+	double   bestTime    = 0.0;
+	for (uint32_t i = 0; i != repeatCount; ++i)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		func();
+		auto end = std::chrono::high_resolution_clock::now();
+
+		double time = std::chrono::duration<double>(end - start).count();
+		bestTime    = i == 0 ? time : std::min(bestTime, time);
+	}
+	return bestTime;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "GPCS4Common.h"
+
+#include <cstdint>
+
+struct HleProfilerBenchDesc
+{
+	// Number of calls per test.
+	uint32_t callCount;
+	// Run each test N times and keep the fastest time.
+	uint32_t repeatCount;
+};
+
+// Calls small PS4API functions directly, through a count stub
+// and through a timed stub of the HLE profiler, and reports the
+// cost the stubs add to every call.
+//
+// Also checks that arguments on the stack, floating point
+// arguments and return values get through the stubs, and
+// that nested timed calls are counted.
+
+class HleProfilerBench
+{
+public:
+	HleProfilerBench(const HleProfilerBenchDesc& desc);
+	~HleProfilerBench();
+
+	bool run();
+
+private:
+	template <typename Func>
+	double measure(Func func);
+
+private:
+	HleProfilerBenchDesc m_desc;
+};
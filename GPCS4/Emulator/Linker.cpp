@@ -1,8 +1,13 @@
 #include "Linker.h"
+#include "HleProfiler.h"
 #include "ModuleSystemCommon.h"
 #include "SceModuleSystem.h"
 #include "UtilString.h"
 #include "Loader/FuncStub.h"
+#include "Common/SceJobScheduler.h"
+
+#include <algorithm>
+#include <thread>
 
 
 LOG_CHANNEL(Linker);
@@ -12,7 +17,8 @@ CLinker::CLinker() : m_modSystem{*CSceModuleSystem::GetInstance()} {}
 // resolveSymbol always returns true
 bool CLinker::resolveSymbol(NativeModule const &mod,
 							std::string const &name,
-							uint64_t *addrOut) const
+							uint64_t *addrOut,
+							bool isCall) const
 {
 	bool retVal = true;
 
@@ -49,13 +55,10 @@ bool CLinker::resolveSymbol(NativeModule const &mod,
 		}
 		else
 		{
-			address = getSymbolAddress(info->moduleName,
-									   info->libraryName,
-									   info->nid);
-
-			auto policy = m_modSystem.getSymbolPolicy(info->moduleName,
-													  info->libraryName,
-													  info->nid);
+			// Names were interned when the module was loaded.
+			SymbolKey key = { info->moduleId, info->libraryId, info->nid };
+			Policy policy = Policy::UseBuiltin;
+			address       = const_cast<void*>(m_modSystem.getSymbolAddress(key, &policy));
 
 			useNative  = (policy == Policy::UseNative);
 		}
@@ -78,6 +81,12 @@ bool CLinker::resolveSymbol(NativeModule const &mod,
 		if (address != nullptr && !useNative)
 		{
 			// builtin function
+			auto profiler = HleProfiler::GetInstance();
+			if (isCall && profiler->isEnabled())
+			{
+				address = profiler->instrument(address, info->nid,
+											   m_modSystem.getBuiltinSymbolName(info->nid));
+			}
 			*addrOut = reinterpret_cast<uint64_t>(address);
 		}
 		else if (address != nullptr && useNative)
@@ -154,14 +163,49 @@ void* CLinker::generateStubFunction(const SymbolInfo* sybInfo, void* oldFunc) co
 bool CLinker::relocateModules()
 {
 	auto &mods  = m_modSystem.getAllNativeModules();
-	bool retVal = false;
+	bool retVal = true;
 
+	std::vector<RelocationJob> jobs;
+	m_relocationCount = 0;
 	for (auto &mod : mods)
 	{
-		retVal = relocateModule(mod);
-		if (retVal == false)
+		auto &info = mod.getModuleInfo();
+		addRelocationJobs(mod, false, info.nRelaCount, jobs);
+		addRelocationJobs(mod, true, info.nPltRelaCount, jobs);
+		m_relocationCount += info.nRelaCount + info.nPltRelaCount;
+	}
+
+	uint32_t threadCount = m_threadCount != 0 ? m_threadCount : std::thread::hardware_concurrency();
+	threadCount          = static_cast<uint32_t>(std::min<size_t>(threadCount, jobs.size()));
+	if (threadCount <= 1)
+	{
+		for (auto &job : jobs)
+		{
+			relocateJob(&job);
+		}
+	}
+	else
+	{
+		// The calling thread runs jobs too while waiting.
+		// Nothing else runs during boot, so workers are not pinned.
+		CSceJobScheduler scheduler(threadCount - 1);
+		CSceJobGroup     group;
+		for (auto &job : jobs)
+		{
+			scheduler.Submit(relocateJob, &job, &group);
+		}
+		scheduler.Wait(&group);
+	}
+
+	LOG_DEBUG("%llu relocations of %zu modules in %zu jobs on %d threads",
+			  m_relocationCount, mods.size(), jobs.size(), std::max(threadCount, 1u));
+
+	for (auto const &job : jobs)
+	{
+		if (!job.result)
 		{
-			LOG_ERR("fail to relocate module: %s", mod.fileName.c_str());
+			LOG_ERR("fail to relocate module: %s", job.mod->fileName.c_str());
+			retVal = false;
 			break;
 		}
 	}
@@ -169,17 +213,41 @@ bool CLinker::relocateModules()
 	return retVal;
 }
 
-void* CLinker::getSymbolAddress(std::string const& modName,
-								std::string const& libName,
-							    uint64_t nid) const
+uint64_t CLinker::getRelocationCount() const
 {
-	auto pointer = m_modSystem.getSymbolAddress(modName, libName, nid);
-	return const_cast<void*>(pointer);
+	return m_relocationCount;
+}
+
+void CLinker::relocateJob(void *arg)
+{
+	auto job = reinterpret_cast<RelocationJob *>(arg);
+	if (job->isPlt)
+	{
+		job->result = job->linker->relocatePltRela(*job->mod, job->begin, job->end);
+	}
+	else
+	{
+		job->result = job->linker->relocateRela(*job->mod, job->begin, job->end);
+	}
+}
+
+void CLinker::addRelocationJobs(NativeModule &mod, bool isPlt, uint32_t count,
+								std::vector<RelocationJob> &jobs)
+{
+	// Add a job for empty tables too, so a module
+	// which was not mapped is still reported.
+	uint32_t begin = 0;
+	do
+	{
+		uint32_t end = std::min(begin + RelocationChunkSize, count);
+		jobs.push_back({ this, &mod, isPlt, begin, end, false });
+		begin = end;
+	} while (begin < count);
 }
 
 void* CLinker::getSymbolAddress(std::string const& modName, std::string const& libName, std::string const& symbName) const
 {
-	auto symbolManager = m_modSystem.getSymbolManager();
+	auto& symbolManager = m_modSystem.getSymbolManager();
 	auto policy = m_modSystem.getSymbolPolicy(modName, libName, symbName);
 	const void* pointer = nullptr;
 
@@ -195,24 +263,12 @@ void* CLinker::getSymbolAddress(std::string const& modName, std::string const& l
 	return const_cast<void*>(pointer);
 }
 
-bool CLinker::relocateModule(NativeModule& mod)
-{
-	bool retVal = false;
-
-	if (relocateRela(mod) && relocatePltRela(mod))
-	{
-		retVal = true;
-	}
-
-	return retVal;
-}
-
-bool CLinker::relocateRela(NativeModule &mod)
+bool CLinker::relocateRela(NativeModule &mod, uint32_t begin, uint32_t end)
 {
 	bool retVal = false;
 	do
 	{
-		if (mod.getFileMemory().empty())
+		if (mod.getFileMapping() == nullptr)
 		{
 			break;
 		}
@@ -223,7 +279,7 @@ bool CLinker::relocateRela(NativeModule &mod)
 		uint8_t *pStrTab            = info.pStrTab;
 		Elf64_Sym *pSymTab       = (Elf64_Sym *)info.pSymTab;
 		Elf64_Rela *pRelaEntries = (Elf64_Rela *)info.pRela;
-		for (uint32_t i = 0; i != info.nRelaCount; ++i)
+		for (uint32_t i = begin; i != end; ++i)
 		{
 			Elf64_Rela *pRela = &pRelaEntries[i];
 			auto nType        = ELF64_R_TYPE(pRela->r_info);
@@ -304,15 +360,14 @@ bool CLinker::relocateRela(NativeModule &mod)
 	return retVal;
 }
 
-bool CLinker::relocatePltRela(NativeModule &mod)
+bool CLinker::relocatePltRela(NativeModule &mod, uint32_t begin, uint32_t end)
 {
 	bool bRet = false;
 	do
 	{
-		auto &fileData = mod.getFileMemory();
-		auto &info     = mod.getModuleInfo();
+		auto &info = mod.getModuleInfo();
 
-		if (fileData.empty())
+		if (mod.getFileMapping() == nullptr)
 		{
 			break;
 		}
@@ -322,8 +377,7 @@ bool CLinker::relocatePltRela(NativeModule &mod)
 		Elf64_Sym *pSymTab       = (Elf64_Sym *)info.pSymTab;
 		Elf64_Rela *pRelaEntries = (Elf64_Rela *)info.pPltRela;
 
-		LOG_DEBUG("PLT RELA count: %d, for library: %s", info.nPltRelaCount, mod.fileName.c_str());
-		for (uint32_t i = 0; i != info.nPltRelaCount; ++i)
+		for (uint32_t i = begin; i != end; ++i)
 		{
 			Elf64_Rela *pRela = &pRelaEntries[i];
 			auto nType        = ELF64_R_TYPE(pRela->r_info);
@@ -345,7 +399,7 @@ bool CLinker::relocatePltRela(NativeModule &mod)
 				{
 					char *pName = (char *)&pStrTab[symbol.st_name];
 					//LOG_DEBUG("PLT RELA symbol: %s", pName);
-					if (!resolveSymbol(mod, pName, &nSymVal))
+					if (!resolveSymbol(mod, pName, &nSymVal, true))
 					{
 						LOG_ERR("can not get symbol address.");
 						//break;
@@ -4,27 +4,57 @@
 #include "SceModuleSystem.h"
 #include "Module.h"
 #include <string>
+#include <vector>
+
+// Relocation tables of all loaded modules are split into jobs
+// and run on a thread pool. Once every image is mapped, a job only
+// reads the symbol tables and writes to its own module image.
 
 class CLinker
 {
 public:
+	// Relocations per job, smaller tables are relocated in one job.
+	static constexpr uint32_t RelocationChunkSize = 4096;
+
 	CLinker();
-	CLinker(CSceModuleSystem &modSystem) : m_modSystem{modSystem} {};
+	// A thread count of 0 uses every host thread.
+	CLinker(CSceModuleSystem &modSystem, uint32_t threadCount = 0) :
+		m_modSystem{ modSystem }, m_threadCount{ threadCount } {};
 
+	// isCall is set for PLT slots, whose builtin functions
+	// go through a profile stub when the HLE profiler is on.
 	bool resolveSymbol(NativeModule const &mod,
 					   std::string const &name,
-					   uint64_t *addr) const;
+					   uint64_t *addr,
+					   bool isCall = false) const;
 
 	bool relocateModules();
 
+	// Relocations applied by the last relocateModules call.
+	uint64_t getRelocationCount() const;
+
 private:
-	void* getSymbolAddress(std::string const &modName, std::string const& libName, uint64_t nid) const;
+	struct RelocationJob
+	{
+		CLinker      *linker;
+		NativeModule *mod;
+		bool          isPlt;
+		uint32_t      begin;
+		uint32_t      end;
+		bool          result;
+	};
+
+	static void relocateJob(void *arg);
+	void addRelocationJobs(NativeModule &mod, bool isPlt, uint32_t count,
+						   std::vector<RelocationJob> &jobs);
+
 	void* getSymbolAddress(std::string const& modName, std::string const& libName, std::string const& symbName) const;
-	bool relocateModule(NativeModule &mod);
-	bool relocateRela(NativeModule &mod);
-	bool relocatePltRela(NativeModule &mod);
+	bool relocateRela(NativeModule &mod, uint32_t begin, uint32_t end);
+	bool relocatePltRela(NativeModule &mod, uint32_t begin, uint32_t end);
 	void* generateStubFunction(const SymbolInfo* sybInfo, void* oldFunc) const;
 
 private:
 	CSceModuleSystem &m_modSystem;
+	uint32_t          m_threadCount     = 0;
+	uint64_t          m_relocationCount = 0;
 };
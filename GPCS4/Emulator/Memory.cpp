@@ -344,8 +344,10 @@ void* MemoryAllocator::allocateInternal(void* addrIn, size_t len, size_t alignme
 				continue;
 			}
 
+			// Writes are watched so that cached decodes of
+			// command buffers can tell they were rewritten.
 			void* retAddress = VMAllocate(reinterpret_cast<void*>(regionAddress), len,
-										  plat::VMAT_RESERVE_COMMIT, uprot);
+										  plat::VMAT_RESERVE_COMMIT_WATCH, uprot);
 			if (!retAddress)
 			{
 				searchAddr = reinterpret_cast<size_t>(mi.pRegionStart) + mi.nRegionSize;
@@ -0,0 +1,45 @@
+#include "MemoryWriteWatch.h"
+#include "Platform/PlatMemory.h"
+#include "UtilMath.h"
+
+#include <algorithm>
+
+LOG_CHANNEL(Emulator.MemoryWriteWatch);
+
+bool MemoryWriteWatch::sync(const void* address, size_t size, uint64_t* lastWrite, uint64_t* now)
+{
+	bool ret = false;
+	do
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		void* start = const_cast<void*>(address);
+		if (!plat::VMGetWrittenPages(start, size, m_writtenPages))
+		{
+			break;
+		}
+
+		uint64_t stamp = ++m_epoch;
+		for (void* page : m_writtenPages)
+		{
+			m_pageStamps[reinterpret_cast<uintptr_t>(page)] = stamp;
+		}
+
+		uintptr_t begin  = util::alignDown(reinterpret_cast<uintptr_t>(address), plat::VM_PAGE_SIZE);
+		uintptr_t end    = reinterpret_cast<uintptr_t>(address) + size;
+		uint64_t  latest = 0;
+		for (uintptr_t page = begin; page < end; page += plat::VM_PAGE_SIZE)
+		{
+			auto iter = m_pageStamps.find(page);
+			if (iter != m_pageStamps.end())
+			{
+				latest = std::max(latest, iter->second);
+			}
+		}
+
+		*lastWrite = latest;
+		*now       = stamp;
+		ret        = true;
+	} while (false);
+	return ret;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "GPCS4Common.h"
+#include "UtilSingleton.h"
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Tells when guest memory was last written, at page granularity.
+//
+// Guest memory is allocated with write watch, every sync collects
+// the pages written since the previous one, from any thread, and
+// stamps them with a new epoch. Something derived from a range is
+// still valid as long as no page in it got a later stamp than the
+// one taken before reading the range.
+//
+// The host write state is reset on read, so all callers must go
+// through here, otherwise they'd lose each other's writes.
+
+class MemoryWriteWatch final : public util::Singleton<MemoryWriteWatch>
+{
+	friend class util::Singleton<MemoryWriteWatch>;
+
+public:
+	// Collects written pages, then returns the latest stamp of the range
+	// in lastWrite and the current stamp in now.
+	// Returns false if writes to the range can't be tracked.
+	bool sync(const void* address, size_t size, uint64_t* lastWrite, uint64_t* now);
+
+private:
+	MemoryWriteWatch()  = default;
+	~MemoryWriteWatch() = default;
+
+private:
+	std::mutex m_mutex;
+	uint64_t   m_epoch = 0;
+	// Stamp of every page that was ever seen written.
+	std::unordered_map<uintptr_t, uint64_t> m_pageStamps;
+	std::vector<void*>                      m_writtenPages;
+};
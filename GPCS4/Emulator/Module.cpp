@@ -11,8 +11,7 @@ LOG_CHANNEL(Module);
 const MODULE_INFO &NativeModule::getModuleInfo() const { return m_moduleInfo; }
 MODULE_INFO &NativeModule::getModuleInfo() { return m_moduleInfo; }
 
-const ByteArray &NativeModule::getFileMemory() const { return m_fileMemory; }
-ByteArray &NativeModule::getFileMemory() { return m_fileMemory; }
+const plat::MappedFile *NativeModule::getFileMapping() const { return m_fileMapping.get(); }
 
 bool NativeModule::isModule() const
 {
@@ -416,9 +415,8 @@ bool NativeModule::getUnresolvedSymbols(SymbolList *symbolList) const
 	for (auto index : m_importSymbols)
 	{
 		auto &symbol = m_symbols[index];
-		auto addr = modSystem->getSymbolAddress(symbol.moduleName,
-												symbol.libraryName,
-												symbol.nid);
+		SymbolKey key = { symbol.moduleId, symbol.libraryId, symbol.nid };
+		auto addr     = modSystem->getSymbolAddress(key);
 		if (addr == nullptr)
 		{
 			symbolList->emplace_back(symbol);
@@ -3,6 +3,7 @@
 #include "GPCS4Common.h"
 #include "Loader/elf.h"
 #include "PlatMemory.h"
+#include "PlatFile.h"
 
 #include <vector>
 #include <memory>
@@ -118,6 +119,9 @@ struct SymbolInfo
 	std::string symbolName;
 	std::string moduleName;
 	std::string libraryName;
+	// Interned moduleName and libraryName.
+	uint32_t moduleId;
+	uint32_t libraryId;
 	uint64_t address;
 	uint64_t nid;
 	bool isEncoded;
@@ -130,7 +134,6 @@ using SymbolList         = std::vector<SymbolInfo>;
 using NameSymbolIndexMap = std::unordered_map<std::string, size_t>;
 using FileList           = std::vector<std::string>;
 using SymbolAddrMap      = std::map<std::string, void *>;
-using ByteArray          = std::vector<uint8_t>;
 
 class ELFMapper;
 struct NativeModule
@@ -148,8 +151,7 @@ public:
 	plat::memory_ptr &getMappedMemory();
 	const MODULE_INFO &getModuleInfo() const;
 	MODULE_INFO &getModuleInfo();
-	const ByteArray &getFileMemory() const;
-	ByteArray &getFileMemory();
+	const plat::MappedFile *getFileMapping() const;
 	bool isModule() const;
 
 	int initialize();
@@ -214,7 +216,9 @@ private:
 
 	plat::memory_ptr m_mappedMemory;
 	size_t m_mappedSize;
-	ByteArray m_fileMemory;
+	// Tables of the dynamic section point into the mapping,
+	// so it lives as long as the module.
+	plat::mapped_file_ptr m_fileMapping;
 
 	Elf64_Ehdr *m_elfHeader;
 	MODULE_INFO m_moduleInfo;
@@ -1,9 +1,17 @@
 #include "Util/UtilContainer.h"
 #include "ModuleManger.h"
+#include "SymbolTable.h"
 
 void ModuleManager::registerBuiltinModule(std::string const& modName)
 {
 	m_builtinModules.emplace_back(modName);
+
+	uint32_t modId = internSymbolName(modName);
+	if (modId >= m_builtinModuleIds.size())
+	{
+		m_builtinModuleIds.resize(modId + 1, false);
+	}
+	m_builtinModuleIds[modId] = true;
 }
 
 void ModuleManager::registerNativeModule(std::string const& modName,
@@ -20,6 +28,11 @@ bool ModuleManager::isBuiltinModuleDefined(std::string const& modName) const
 	return util::contains(m_builtinModules, modName);
 }
 
+bool ModuleManager::isBuiltinModuleDefined(uint32_t modId) const
+{
+	return modId < m_builtinModuleIds.size() && m_builtinModuleIds[modId];
+}
+
 bool ModuleManager::isNativeModuleLoaded(std::string const& modName)
 {
 	return util::contains(m_nativeModuleNameIndexMap, modName);
@@ -12,6 +12,7 @@ public:
 	void registerNativeModule(std::string const& modName, NativeModule&& mod);
 
 	bool isBuiltinModuleDefined(std::string const& modName) const;
+	bool isBuiltinModuleDefined(uint32_t modId) const;
 
 	bool isNativeModuleLoaded(std::string const& modName);
 	bool getNativeModule(std::string const& modName, NativeModule** modOut);
@@ -21,6 +22,8 @@ public:
 
 private:
 	std::vector<std::string> m_builtinModules;
+	// Indexed by interned module name.
+	std::vector<bool> m_builtinModuleIds;
 	std::vector<NativeModule> m_nativeModules;
 	std::map<std::string, uint64_t> m_nativeModuleNameIndexMap;
 };
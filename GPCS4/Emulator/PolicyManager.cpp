@@ -2,6 +2,7 @@
 
 #include "Util/UtilContainer.h"
 #include "PolicyManager.h"
+#include "SymbolTable.h"
 
 
 void LibraryPolicy::excludeSymbol(uint64_t nid)
@@ -91,7 +92,9 @@ LibraryPolicy& ModulePolicy::addLibraryPolicy(std::string const & name,
 											  LibraryPolicy && lp)
 {
 	m_libPolicyTable.emplace(std::make_pair(name, std::move(lp)));
-	return m_libPolicyTable.at(name);
+	auto& policy = m_libPolicyTable.at(name);
+	m_libPolicyIdTable[internSymbolName(name)] = &policy;
+	return policy;
 }
 
 bool ModulePolicy::getLibraryPolicy(std::string const & name,
@@ -117,6 +120,25 @@ bool ModulePolicy::getLibraryPolicy(std::string const & name,
 	return ret;
 }
 
+bool ModulePolicy::getLibraryPolicy(uint32_t libId,
+	                                const LibraryPolicy ** p) const
+{
+	bool ret = false;
+	do {
+		auto lib = m_libPolicyIdTable.find(libId);
+		if (lib == m_libPolicyIdTable.end())
+		{
+			ret = false;
+			break;
+		}
+
+		*p = lib->second;
+		ret = true;
+	} while (false);
+
+	return ret;
+}
+
 void ModulePolicy::setPolicy(Policy policy)
 {
 	m_policy = policy;
@@ -272,10 +294,51 @@ Policy PolicyManager::getSymbolPolicy(std::string const& modName, std::string co
 }
 
 
+Policy PolicyManager::getSymbolPolicy(uint32_t modId,
+	                                  uint32_t libId,
+                                      uint64_t nid) const
+{
+	Policy ret = m_defaultPolicy;
+	do 
+	{
+		auto modIter = m_modPolicyIdTable.find(modId);
+		if (modIter == m_modPolicyIdTable.end())
+		{
+			if (m_useNativeImplsWhenBuiltinModuleNotDefined &&
+				!m_modManager.isBuiltinModuleDefined(modId))
+			{
+				ret = Policy::UseNative;
+				break;
+			}
+			else
+			{
+				ret = m_defaultPolicy;
+				break;
+			}
+		}
+
+		const LibraryPolicy *libPolicy = nullptr;
+		auto found = modIter->second->getLibraryPolicy(libId, &libPolicy);
+		if (!found)
+		{
+			ret = modIter->second->getPolicy();
+			break;
+		}
+
+		ret = libPolicy->getSymbolPolicy(nid);
+
+	} while (false);
+
+	return ret;
+}
+
+
 ModulePolicyAdder PolicyManager::declareModule(std::string const & name)
 {
 	m_modPolicyTable.emplace(std::make_pair(name, ModulePolicy{}));
-	return { m_modPolicyTable.at(name) };
+	auto& policy = m_modPolicyTable.at(name);
+	m_modPolicyIdTable[internSymbolName(name)] = &policy;
+	return { policy };
 }
 
 
@@ -1,6 +1,7 @@
 #include "ModuleManger.h"
 
 #include <map>
+#include <unordered_map>
 #include <cstdint>
 
 enum class Policy
@@ -38,12 +39,15 @@ public:
 	ModulePolicy() = default;
 	LibraryPolicy& addLibraryPolicy(std::string const &name, LibraryPolicy &&lp);
     bool getLibraryPolicy(std::string const &name, const LibraryPolicy **p) const;
+    bool getLibraryPolicy(uint32_t libId, const LibraryPolicy **p) const;
 	void setPolicy(Policy policy);
 	Policy getPolicy() const;
 
 private:
     Policy m_policy;
     std::map<std::string, LibraryPolicy> m_libPolicyTable;
+    // Interned library name to the entries above.
+    std::unordered_map<uint32_t, const LibraryPolicy*> m_libPolicyIdTable;
 };
 
 
@@ -88,6 +92,19 @@ public:
 	                      std::string const &libName,
                           std::string const& name) const;
 
+	/**
+	 * @brief Retrieves the policy of a symbol by interned names,
+	 * same as the NID overload above without hashing strings.
+	 * 
+	 * @param modId interned module name
+	 * @param libId interned library name
+	 * @param nid symbol NID
+	 * @return Policy 
+	 */
+	Policy getSymbolPolicy(uint32_t modId,
+	                       uint32_t libId,
+	                       uint64_t nid) const;
+
 	/**
 	 * @brief Checks if a native module is loadable.
 	 * 
@@ -109,6 +126,8 @@ private:
 	const Policy m_defaultPolicy = Policy::UseBuiltin;
 	const bool m_useNativeImplsWhenBuiltinModuleNotDefined = true;	
     std::map<std::string, ModulePolicy> m_modPolicyTable;
+	// Interned module name to the entries above.
+	std::unordered_map<uint32_t, const ModulePolicy*> m_modPolicyIdTable;
 	ModuleManager& m_modManager;
 };
 
@@ -212,6 +212,8 @@ bool Emulator::registerModules()
 			break;
 		}
 
+		pModuleSystem->finalizeBuiltinModules();
+
 		// Yes, the policy is testable now
 
 		//auto testPolicy = [&]() {
@@ -34,24 +34,20 @@ bool CSceModuleSystem::registerBuiltinModule(const SCE_EXPORT_MODULE &stModule)
 		const SCE_EXPORT_LIBRARY *pLib = stModule.pLibraries;
 
 		m_moduleManager.registerBuiltinModule(szModName);
+		uint32_t modId = internSymbolName(szModName);
 
 		while (!pLib->isEndEntry())
 		{
-			const char *szLibName            = pLib->szLibraryName;
 			const SCE_EXPORT_FUNCTION *pFunc = pLib->pFunctionEntries;
+			uint32_t libId                   = internSymbolName(pLib->szLibraryName);
 
-
+			// Registered by NID only, lookups by name
+			// are turned into the NID.
 			while (!pFunc->isEndEntry())
 			{
-				m_symbolManager.registerBuiltinSymbol(szModName,
-													  szLibName,
-													  pFunc->nNid,
-													  pFunc->pFunction);
-
-				m_symbolManager.registerBuiltinSymbol(szModName,
-													  szLibName,
-													  pFunc->szFunctionName,
+				m_symbolManager.registerBuiltinSymbol(SymbolKey{ modId, libId, pFunc->nNid },
 													  pFunc->pFunction);
+				m_builtinSymbolNames.emplace(pFunc->nNid, pFunc->szFunctionName);
 
 				pFunc = pFunc->iterNext();
 			}
@@ -80,6 +76,17 @@ bool CSceModuleSystem::registerNativeSymbol(std::string const &modName,
 	return true;
 }
 
+bool CSceModuleSystem::registerNativeSymbol(SymbolKey const &key, void *p)
+{
+	m_symbolManager.registerNativeSymbol(key, p);
+	return true;
+}
+
+void CSceModuleSystem::finalizeBuiltinModules()
+{
+	m_symbolManager.buildBuiltinIndex();
+}
+
 bool CSceModuleSystem::registerNativeModule(std::string const &modName,
 												  NativeModule &&mod)
 {
@@ -111,6 +118,12 @@ const SymbolManager& CSceModuleSystem::getSymbolManager() const
 	return m_symbolManager;
 }
 
+const char* CSceModuleSystem::getBuiltinSymbolName(uint64_t nid) const
+{
+	auto iter = m_builtinSymbolNames.find(nid);
+	return iter != m_builtinSymbolNames.end() ? iter->second : nullptr;
+}
+
 PolicyManager& CSceModuleSystem::getPolicyManager()
 {
 	return m_policyManager;
@@ -202,6 +215,18 @@ const void* CSceModuleSystem::getSymbolAddress(std::string const& modName,
 	return address;
 }
 
+const void* CSceModuleSystem::getSymbolAddress(SymbolKey const& key, Policy* policy) const
+{
+	auto symbolPolicy = m_policyManager.getSymbolPolicy(key.moduleId, key.libraryId, key.nid);
+	if (policy)
+	{
+		*policy = symbolPolicy;
+	}
+
+	return symbolPolicy == Policy::UseBuiltin ? m_symbolManager.findBuiltinSymbol(key)
+											  : m_symbolManager.findNativeSymbol(key);
+}
+
 // TODO: To be done
 void CSceModuleSystem::clearModules()
 {
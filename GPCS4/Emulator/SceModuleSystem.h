@@ -32,6 +32,16 @@ public:
 								 std::string const& libName,
 								 uint64_t nid) const;
 
+	/**
+	 * @brief Get symbol address according to the corresponding policy
+	 * 
+	 * @param key interned module and library name with symbol NID
+	 * @param policy [out] the policy applied, optional
+	 * @return const void* symbol address
+	 */
+	const void *getSymbolAddress(SymbolKey const& key,
+								 Policy* policy = nullptr) const;
+
 	/**
 	 * @brief Clear modules. TODO: NOT IMPLEMENTED 
 	 * 
@@ -99,6 +109,13 @@ public:
 	 */
 	bool registerBuiltinModule(const SCE_EXPORT_MODULE& stModule);
 
+	/**
+	 * @brief Called once all builtin modules are registered,
+	 * builds the lookup index over their symbols.
+	 * 
+	 */
+	void finalizeBuiltinModules();
+
 	/**
 	 * @brief Registers a native module to the module system.
 	 * The ownship of the module is transfered after calling 
@@ -141,6 +158,16 @@ public:
 							  std::string const &symbolName,
 							  void *p);
 
+	/**
+	 * @brief Registers a symbol from native module
+	 * 
+	 * @param key interned module and library name with symbol NID
+	 * @param p address
+	 * @return true when succeeded
+	 * @return false when failed
+	 */
+	bool registerNativeSymbol(SymbolKey const &key, void *p);
+
 	/**
 	 * @brief Retrieves policy of a module
 	 * 
@@ -181,6 +208,14 @@ public:
 	 */
 	const SymbolManager& getSymbolManager() const;
 
+	/**
+	 * @brief Name of a builtin function, for reports.
+	 * 
+	 * @param nid symbol NID
+	 * @return const char* the name, or null if no builtin module exports it
+	 */
+	const char* getBuiltinSymbolName(uint64_t nid) const;
+
 	/**
 	 * @brief Gets the Policy Manager object
 	 * 
@@ -196,5 +231,7 @@ private:
 	ModuleManager m_moduleManager;
 	SymbolManager m_symbolManager;
 	PolicyManager m_policyManager;
+	// Point to the names in the export tables.
+	std::unordered_map<uint64_t, const char*> m_builtinSymbolNames;
 };
 
@@ -1,31 +1,73 @@
 #include "SymbolManager.h"
 
+LOG_CHANNEL(Emulator.SymbolManager);
+
+bool SymbolManager::getNameKey(std::string const &modName,
+							   std::string const &libName,
+							   SymbolKey *key) const
+{
+	auto interner  = SymbolNameInterner::GetInstance();
+	key->moduleId  = interner->find(modName);
+	key->libraryId = interner->find(libName);
+	// Names never interned can't be in any table.
+	return key->moduleId != SymbolNameInterner::InvalidId &&
+		   key->libraryId != SymbolNameInterner::InvalidId;
+}
+
 const void *SymbolManager::findNativeSymbol(std::string const &modName,
 	                                   std::string const &libName,
 	                                   uint64_t nid) const
 {
-	return findSymbolGeneric(m_nativeModuleSymbolNidDir, modName, libName, nid);
+	SymbolKey key = {};
+	key.nid       = nid;
+	return getNameKey(modName, libName, &key) ? findNativeSymbol(key) : nullptr;
 }
 
 const void* SymbolManager::findNativeSymbol(std::string const& modName,
 									  std::string const& libName,
 									  std::string const& symbName) const
 {
-	return findSymbolGeneric(m_nativeModuleSymbolNameDir, modName, libName, symbName);
+	const void *address = nullptr;
+	do
+	{
+		SymbolKey key = {};
+		key.nid       = SymbolNameInterner::GetInstance()->find(symbName);
+		if (key.nid == SymbolNameInterner::InvalidId ||
+			!getNameKey(modName, libName, &key))
+		{
+			break;
+		}
+
+		address = m_nativeSymbolNameTable.find(key);
+	} while (false);
+	return address;
+}
+
+const void *SymbolManager::findNativeSymbol(SymbolKey const &key) const
+{
+	return m_nativeSymbolNidTable.find(key);
 }
 
 const void* SymbolManager::findBuiltinSymbol(std::string const& modName,
 											 std::string const& libName,
 											 uint64_t nid) const
 {
-	return findSymbolGeneric(m_builtinModuleSymbolNidDir, modName, libName, nid);
+	SymbolKey key = {};
+	key.nid       = nid;
+	return getNameKey(modName, libName, &key) ? findBuiltinSymbol(key) : nullptr;
 }
 
 const void* SymbolManager::findBuiltinSymbol(std::string const& modName, 
 											 std::string const& libName,
 											 std::string const& name) const
 {
-	return findSymbolGeneric(m_builtinModuleSymbolNameDir, modName, libName, name);
+	return findBuiltinSymbol(modName, libName, computeSymbolNid(name));
+}
+
+const void *SymbolManager::findBuiltinSymbol(SymbolKey const &key) const
+{
+	return m_builtinSymbolNidIndex.empty() ? m_builtinSymbolNidTable.find(key)
+										   : m_builtinSymbolNidIndex.find(key);
 }
 
 bool SymbolManager::registerNativeSymbol(std::string const& modName,
@@ -33,11 +75,8 @@ bool SymbolManager::registerNativeSymbol(std::string const& modName,
 										 uint64_t nid,
 										 const void* address)
 {
-	return registerSymbolNidGeneric(m_nativeModuleSymbolNidDir,
-									modName,
-									libName,
-									nid,
-									address);
+	SymbolKey key = { internSymbolName(modName), internSymbolName(libName), nid };
+	return registerNativeSymbol(key, address);
 }
 
 bool SymbolManager::registerNativeSymbol(std::string const& modName,
@@ -45,11 +84,13 @@ bool SymbolManager::registerNativeSymbol(std::string const& modName,
 										 std::string const& name,
 										 const void* address)
 {
-	return registerSymbolNidGeneric(m_nativeModuleSymbolNameDir,
-									modName,
-									libName,
-									name,
-									address);
+	SymbolKey key = { internSymbolName(modName), internSymbolName(libName), internSymbolName(name) };
+	return m_nativeSymbolNameTable.insert(key, address);
+}
+
+bool SymbolManager::registerNativeSymbol(SymbolKey const &key, const void *address)
+{
+	return m_nativeSymbolNidTable.insert(key, address);
 }
 
 bool SymbolManager::registerBuiltinSymbol(std::string const& modName,
@@ -57,11 +98,8 @@ bool SymbolManager::registerBuiltinSymbol(std::string const& modName,
 										  uint64_t nid,
 										  const void* address)
 {
-	return registerSymbolNidGeneric(m_builtinModuleSymbolNidDir,
-									modName,
-									libName,
-									nid,
-									address);
+	SymbolKey key = { internSymbolName(modName), internSymbolName(libName), nid };
+	return registerBuiltinSymbol(key, address);
 }
 
 bool SymbolManager::registerBuiltinSymbol(std::string const& modName,
@@ -69,11 +107,23 @@ bool SymbolManager::registerBuiltinSymbol(std::string const& modName,
 										  std::string const& name,
 										  const void* address)
 {
-	return registerSymbolNidGeneric(m_builtinModuleSymbolNameDir,
-									modName,
-									libName,
-									name,
-									address);
+	return registerBuiltinSymbol(modName, libName, computeSymbolNid(name), address);
 }
 
+bool SymbolManager::registerBuiltinSymbol(SymbolKey const &key, const void *address)
+{
+	bool ret = m_builtinSymbolNidTable.insert(key, address);
+	if (ret && !m_builtinSymbolNidIndex.empty())
+	{
+		m_builtinSymbolNidIndex.clear();
+	}
+	return ret;
+}
 
+void SymbolManager::buildBuiltinIndex()
+{
+	if (m_builtinSymbolNidIndex.build(m_builtinSymbolNidTable))
+	{
+		LOG_DEBUG("perfect hash built over %zu builtin symbols", m_builtinSymbolNidTable.size());
+	}
+}
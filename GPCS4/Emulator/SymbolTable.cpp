@@ -0,0 +1,308 @@
+#include "SymbolTable.h"
+#include "Algorithm/Sha1Hash.h"
+
+#include <algorithm>
+#include <mutex>
+
+LOG_CHANNEL(Emulator.SymbolTable);
+
+// Keys per bucket of the perfect table on average.
+constexpr size_t   PerfectBucketSize = 4;
+constexpr uint32_t PerfectMaxSeed    = 1u << 20;
+
+static size_t nextPowerOfTwo(size_t value)
+{
+	size_t result = 1;
+	while (result < value)
+	{
+		result <<= 1;
+	}
+	return result;
+}
+
+uint32_t SymbolNameInterner::intern(std::string const &name)
+{
+	{
+		std::shared_lock<std::shared_mutex> lock(m_mutex);
+		auto iter = m_ids.find(name);
+		if (iter != m_ids.end())
+		{
+			return iter->second;
+		}
+	}
+
+	std::unique_lock<std::shared_mutex> lock(m_mutex);
+	auto result = m_ids.emplace(name, static_cast<uint32_t>(m_names.size() + 1));
+	if (result.second)
+	{
+		m_names.push_back(&result.first->first);
+	}
+	return result.first->second;
+}
+
+uint32_t SymbolNameInterner::find(std::string const &name) const
+{
+	std::shared_lock<std::shared_mutex> lock(m_mutex);
+	auto iter = m_ids.find(name);
+	return iter != m_ids.end() ? iter->second : InvalidId;
+}
+
+std::string SymbolNameInterner::name(uint32_t id) const
+{
+	std::shared_lock<std::shared_mutex> lock(m_mutex);
+	return id != InvalidId && id <= m_names.size() ? *m_names[id - 1] : std::string();
+}
+
+uint64_t computeSymbolNid(std::string const &name)
+{
+	static const uint8_t suffix[] = {
+		0x51, 0x8D, 0x64, 0xA6, 0x35, 0xDE, 0xD8, 0xC1,
+		0xE6, 0xB0, 0x39, 0xB1, 0xC3, 0xE5, 0x52, 0x30
+	};
+
+	alg::Sha1Data chunks[] = {
+		{ name.data(), name.size() },
+		{ suffix, sizeof(suffix) },
+	};
+
+	auto     hash = alg::Sha1Hash::compute(2, chunks);
+	uint64_t nid  = 0;
+	// The first 8 bytes of the digest, little endian.
+	memcpy(&nid, hash.digest().data(), sizeof(nid));
+	return nid;
+}
+
+
+bool SymbolTable::insert(SymbolKey const &key, const void *address)
+{
+	bool ret = false;
+	do
+	{
+		// Keep the load at most one half.
+		if ((m_count + 1) * 2 > m_entries.size())
+		{
+			rehash(std::max<size_t>(m_entries.size() * 2, 64));
+		}
+
+		size_t slot = hashSymbolKey(key) & m_mask;
+		while (m_entries[slot].key.moduleId != SymbolNameInterner::InvalidId)
+		{
+			if (m_entries[slot].key == key)
+			{
+				break;
+			}
+			slot = (slot + 1) & m_mask;
+		}
+
+		if (m_entries[slot].key.moduleId != SymbolNameInterner::InvalidId)
+		{
+			// already registered
+			break;
+		}
+
+		m_entries[slot] = { key, address };
+		++m_count;
+
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+const void *SymbolTable::find(SymbolKey const &key) const
+{
+	const void *address = nullptr;
+	do
+	{
+		if (m_entries.empty())
+		{
+			break;
+		}
+
+		size_t slot = hashSymbolKey(key) & m_mask;
+		while (m_entries[slot].key.moduleId != SymbolNameInterner::InvalidId)
+		{
+			if (m_entries[slot].key == key)
+			{
+				address = m_entries[slot].address;
+				break;
+			}
+			slot = (slot + 1) & m_mask;
+		}
+	} while (false);
+	return address;
+}
+
+size_t SymbolTable::size() const
+{
+	return m_count;
+}
+
+void SymbolTable::rehash(size_t capacity)
+{
+	std::vector<Entry> entries(capacity, Entry{});
+	std::swap(entries, m_entries);
+	m_mask  = capacity - 1;
+	m_count = 0;
+
+	for (auto const &entry : entries)
+	{
+		if (entry.key.moduleId != SymbolNameInterner::InvalidId)
+		{
+			insert(entry.key, entry.address);
+		}
+	}
+}
+
+
+bool PerfectSymbolTable::build(SymbolTable const &table)
+{
+	bool ret = false;
+	do
+	{
+		clear();
+
+		size_t count = table.size();
+		if (count == 0)
+		{
+			ret = true;
+			break;
+		}
+
+		size_t slotCount   = nextPowerOfTwo(std::max<size_t>(count + count / 4, 8));
+		size_t bucketCount = nextPowerOfTwo(std::max<size_t>(count / PerfectBucketSize, 2));
+
+		m_mask        = slotCount - 1;
+		m_bucketShift = 64;
+		for (size_t bits = bucketCount; bits > 1; bits >>= 1)
+		{
+			--m_bucketShift;
+		}
+
+		struct Item
+		{
+			SymbolKey   key;
+			const void *address;
+			uint64_t    hash;
+		};
+
+		std::vector<std::vector<Item>> buckets(bucketCount);
+		table.forEach([&](SymbolKey const &key, const void *address)
+					  {
+						  uint64_t hash = hashSymbolKey(key);
+						  buckets[hash >> m_bucketShift].push_back({ key, address, hash });
+					  });
+
+		// Place the largest buckets first, while most slots are free.
+		std::vector<uint32_t> order(bucketCount);
+		for (uint32_t i = 0; i != bucketCount; ++i)
+		{
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs)
+						 { return buckets[lhs].size() > buckets[rhs].size(); });
+
+		m_seeds.assign(bucketCount, 0);
+		m_entries.assign(slotCount, Entry{});
+
+		std::vector<bool>   used(slotCount, false);
+		std::vector<size_t> slots;
+		bool                placed = true;
+		for (uint32_t index : order)
+		{
+			auto &bucket = buckets[index];
+			if (bucket.empty())
+			{
+				break;
+			}
+
+			uint32_t seed = 1;
+			for (; seed != PerfectMaxSeed; ++seed)
+			{
+				slots.clear();
+				for (auto const &item : bucket)
+				{
+					size_t slot = getSlot(item.hash, seed, m_mask);
+					if (used[slot] ||
+						std::find(slots.begin(), slots.end(), slot) != slots.end())
+					{
+						break;
+					}
+					slots.push_back(slot);
+				}
+
+				if (slots.size() == bucket.size())
+				{
+					break;
+				}
+			}
+
+			if (seed == PerfectMaxSeed)
+			{
+				placed = false;
+				break;
+			}
+
+			m_seeds[index] = seed;
+			for (size_t i = 0; i != bucket.size(); ++i)
+			{
+				used[slots[i]]      = true;
+				m_entries[slots[i]] = { bucket[i].key, bucket[i].address };
+			}
+		}
+
+		if (!placed)
+		{
+			LOG_WARN("no perfect hash found for %zu symbols", count);
+			clear();
+			break;
+		}
+
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+const void *PerfectSymbolTable::find(SymbolKey const &key) const
+{
+	const void *address = nullptr;
+	do
+	{
+		if (m_entries.empty())
+		{
+			break;
+		}
+
+		uint64_t     hash  = hashSymbolKey(key);
+		uint32_t     seed  = m_seeds[hash >> m_bucketShift];
+		Entry const &entry = m_entries[getSlot(hash, seed, m_mask)];
+		if (!(entry.key == key))
+		{
+			break;
+		}
+
+		address = entry.address;
+	} while (false);
+	return address;
+}
+
+bool PerfectSymbolTable::empty() const
+{
+	return m_entries.empty();
+}
+
+void PerfectSymbolTable::clear()
+{
+	m_seeds.clear();
+	m_entries.clear();
+	m_bucketShift = 0;
+	m_mask        = 0;
+}
+
+size_t PerfectSymbolTable::getSlot(uint64_t hash, uint32_t seed, size_t mask)
+{
+	uint64_t value = hash ^ (uint64_t(seed) * 0xC2B2AE3D27D4EB4Full);
+	value ^= value >> 29;
+	value *= 0xBF58476D1CE4E5B9ull;
+	value ^= value >> 32;
+	return static_cast<size_t>(value) & mask;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "GPCS4Common.h"
+#include "UtilSingleton.h"
+
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Module and library names are interned once when a module
+// is loaded or declared, so resolving a symbol compares
+// integers instead of hashing strings.
+
+class SymbolNameInterner final : public util::Singleton<SymbolNameInterner>
+{
+	friend class util::Singleton<SymbolNameInterner>;
+
+public:
+	static constexpr uint32_t InvalidId = 0;
+
+	uint32_t intern(std::string const &name);
+
+	// Returns InvalidId if the name was never interned.
+	uint32_t find(std::string const &name) const;
+
+	std::string name(uint32_t id) const;
+
+private:
+	SymbolNameInterner()  = default;
+	~SymbolNameInterner() = default;
+
+private:
+	mutable std::shared_mutex                 m_mutex;
+	std::unordered_map<std::string, uint32_t> m_ids;
+	// Point to the keys of m_ids, indexed by id - 1.
+	std::vector<const std::string *> m_names;
+};
+
+inline uint32_t internSymbolName(std::string const &name)
+{
+	return SymbolNameInterner::GetInstance()->intern(name);
+}
+
+// NID of a symbol name, as the encoded symbol names carry it.
+uint64_t computeSymbolNid(std::string const &name);
+
+
+struct SymbolKey
+{
+	uint32_t moduleId;
+	uint32_t libraryId;
+	// NID, or the interned id of a symbol exported by name.
+	uint64_t nid;
+
+	bool operator==(SymbolKey const &other) const
+	{
+		return nid == other.nid &&
+			   moduleId == other.moduleId &&
+			   libraryId == other.libraryId;
+	}
+};
+
+inline uint64_t hashSymbolKey(SymbolKey const &key)
+{
+	// NIDs are already SHA-1 bits, the ids only need folding in.
+	uint64_t hash = key.nid ^
+					((uint64_t(key.moduleId) << 32 | key.libraryId) * 0x9E3779B97F4A7C15ull);
+	hash ^= hash >> 33;
+	hash *= 0xFF51AFD7ED558CCDull;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+
+// Open addressing table with linear probing.
+
+class SymbolTable
+{
+public:
+	SymbolTable() = default;
+
+	// Returns false if the key is already present.
+	bool insert(SymbolKey const &key, const void *address);
+
+	const void *find(SymbolKey const &key) const;
+
+	size_t size() const;
+
+	template <typename Func>
+	void forEach(Func func) const
+	{
+		for (auto const &entry : m_entries)
+		{
+			if (entry.key.moduleId != SymbolNameInterner::InvalidId)
+			{
+				func(entry.key, entry.address);
+			}
+		}
+	}
+
+private:
+	struct Entry
+	{
+		SymbolKey   key;
+		const void *address;
+	};
+
+	void rehash(size_t capacity);
+
+private:
+	std::vector<Entry> m_entries;
+	size_t             m_mask  = 0;
+	size_t             m_count = 0;
+};
+
+
+// Perfect hash over a fixed set of symbols, built with hash and displace.
+// Keys are grouped into small buckets, each bucket gets a seed
+// which sends all of its keys to free slots. A lookup is one bucket
+// read and one slot read, with no probing.
+
+class PerfectSymbolTable
+{
+public:
+	PerfectSymbolTable() = default;
+
+	// Returns false if no seeds were found, the table is left empty.
+	bool build(SymbolTable const &table);
+
+	const void *find(SymbolKey const &key) const;
+
+	bool empty() const;
+
+	void clear();
+
+private:
+	struct Entry
+	{
+		SymbolKey   key;
+		const void *address;
+	};
+
+	static size_t getSlot(uint64_t hash, uint32_t seed, size_t mask);
+
+private:
+	std::vector<uint32_t> m_seeds;
+	std::vector<Entry>    m_entries;
+	uint32_t              m_bucketShift = 0;
+	size_t                m_mask        = 0;
+};
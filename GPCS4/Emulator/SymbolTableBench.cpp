@@ -0,0 +1,295 @@
+#include "SymbolTableBench.h"
+#include "ModuleManger.h"
+#include "PolicyManager.h"
+#include "SymbolManager.h"
+#include "UtilString.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+LOG_CHANNEL(Emulator.SymbolTableBench);
+
+constexpr uint32_t BenchSymbolsPerModule  = 512;
+constexpr uint32_t BenchImportsPerSymbol  = 4;
+// One import in this many asks for a symbol nobody exports.
+constexpr uint32_t BenchUnknownImportRate = 20;
+
+namespace
+{
+
+	struct BenchSymbol
+	{
+		std::string moduleName;
+		std::string libraryName;
+		std::string name;
+		uint32_t    moduleId;
+		uint32_t    libraryId;
+		uint64_t    nid;
+		bool        builtin;
+	};
+
+	// The symbol manager as it was, three levels of string keyed maps,
+	// with every builtin export stored by NID and by name.
+	class LegacySymbolDirectory
+	{
+	public:
+		void add(BenchSymbol const& symbol, const void* address)
+		{
+			if (symbol.builtin)
+			{
+				m_builtinNidDir[symbol.moduleName][symbol.libraryName].emplace(symbol.nid, address);
+				m_builtinNameDir[symbol.moduleName][symbol.libraryName].emplace(symbol.name, address);
+			}
+			else
+			{
+				m_nativeNidDir[symbol.moduleName][symbol.libraryName].emplace(symbol.nid, address);
+			}
+		}
+
+		const void* find(std::string const& modName,
+						 std::string const& libName,
+						 uint64_t           nid,
+						 bool               builtin) const
+		{
+			const void* address = nullptr;
+			do
+			{
+				auto& table   = builtin ? m_builtinNidDir : m_nativeNidDir;
+				auto  modIter = table.find(modName);
+				if (modIter == table.end())
+				{
+					break;
+				}
+
+				auto libIter = modIter->second.find(libName);
+				if (libIter == modIter->second.end())
+				{
+					break;
+				}
+
+				auto nidIter = libIter->second.find(nid);
+				if (nidIter == libIter->second.end())
+				{
+					break;
+				}
+
+				address = nidIter->second;
+			} while (false);
+			return address;
+		}
+
+	private:
+		using NidMap  = std::unordered_map<uint64_t, const void*>;
+		using NameMap = std::unordered_map<std::string, const void*>;
+
+		std::unordered_map<std::string, std::unordered_map<std::string, NidMap>>  m_builtinNidDir;
+		std::unordered_map<std::string, std::unordered_map<std::string, NameMap>> m_builtinNameDir;
+		std::unordered_map<std::string, std::unordered_map<std::string, NidMap>>  m_nativeNidDir;
+	};
+
+	const void* getSymbolAddress(uint32_t index)
+	{
+		return reinterpret_cast<const void*>(uintptr_t(0x10000) + index * 16);
+	}
+
+}  // namespace
+
+
+SymbolTableBench::SymbolTableBench(const SymbolTableBenchDesc& desc) :
+	m_desc(desc)
+{
+}
+
+SymbolTableBench::~SymbolTableBench()
+{
+}
+
+bool SymbolTableBench::run()
+{
+	bool ret = false;
+	do
+	{
+		if (m_desc.symbolCount == 0)
+		{
+			std::printf("Nothing to run, symbol count is 0.\n");
+			break;
+		}
+
+		// Even modules are builtin, odd ones only exist natively.
+		// Builtin modules default to builtin symbols, their second
+		// library uses native ones except for a few NIDs.
+		ModuleManager modManager;
+		PolicyManager policyManager(modManager);
+
+		uint32_t                 moduleCount = (m_desc.symbolCount + BenchSymbolsPerModule - 1) / BenchSymbolsPerModule;
+		std::vector<BenchSymbol> symbols;
+		symbols.reserve(m_desc.symbolCount);
+		for (uint32_t i = 0; i != m_desc.symbolCount; ++i)
+		{
+			uint32_t    module = i / BenchSymbolsPerModule;
+			BenchSymbol symbol = {};
+			symbol.moduleName  = util::str::format("libSceBench%u", module);
+			symbol.libraryName = i % 2 ? symbol.moduleName + "Sub" : symbol.moduleName;
+			symbol.name        = util::str::format("sceBenchFunction%u", i);
+			symbol.nid         = computeSymbolNid(symbol.name);
+			symbol.builtin     = module % 2 == 0;
+			symbols.push_back(symbol);
+		}
+
+		for (uint32_t module = 0; module < moduleCount; module += 2)
+		{
+			auto modName = util::str::format("libSceBench%u", module);
+			auto first   = module * BenchSymbolsPerModule + 1;
+			modManager.registerBuiltinModule(modName);
+			policyManager.declareModule(modName)
+				.withDefault(Policy::UseBuiltin)
+				.declareSubLibrary(modName + "Sub")
+				.with(Policy::UseNative)
+				.except({ symbols[std::min(first, m_desc.symbolCount - 1)].nid });
+		}
+
+		for (auto& symbol : symbols)
+		{
+			symbol.moduleId  = internSymbolName(symbol.moduleName);
+			symbol.libraryId = internSymbolName(symbol.libraryName);
+			// Exports land where the policy will look for them.
+			symbol.builtin = policyManager.getSymbolPolicy(symbol.moduleName, symbol.libraryName, symbol.nid) ==
+							 Policy::UseBuiltin;
+		}
+
+		std::vector<BenchSymbol> imports;
+		std::mt19937             random(1234);
+		uint32_t                 importCount = m_desc.symbolCount * BenchImportsPerSymbol;
+		imports.reserve(importCount);
+		for (uint32_t i = 0; i != importCount; ++i)
+		{
+			BenchSymbol symbol = symbols[random() % symbols.size()];
+			if (i % BenchUnknownImportRate == 0)
+			{
+				symbol.nid = computeSymbolNid(util::str::format("sceBenchUnknown%u", i));
+			}
+			imports.push_back(symbol);
+		}
+
+		// Registration.
+		LegacySymbolDirectory legacyDirectory;
+		auto                  registerLegacy = [&]()
+		{
+			legacyDirectory = LegacySymbolDirectory();
+			for (uint32_t i = 0; i != symbols.size(); ++i)
+			{
+				legacyDirectory.add(symbols[i], getSymbolAddress(i));
+			}
+		};
+
+		SymbolManager symbolManager;
+		auto          registerAll = [&]()
+		{
+			symbolManager = SymbolManager();
+			for (uint32_t i = 0; i != symbols.size(); ++i)
+			{
+				auto&     symbol = symbols[i];
+				SymbolKey key    = { symbol.moduleId, symbol.libraryId, symbol.nid };
+				if (symbol.builtin)
+				{
+					symbolManager.registerBuiltinSymbol(key, getSymbolAddress(i));
+				}
+				else
+				{
+					symbolManager.registerNativeSymbol(key, getSymbolAddress(i));
+				}
+			}
+		};
+
+		double legacyRegisterTime = measure(registerLegacy);
+		double registerTime       = measure(registerAll);
+
+		// Resolution, the linker asked for the policy twice per symbol.
+		std::vector<const void*> legacyResults(importCount);
+		std::vector<const void*> results(importCount);
+
+		auto resolveLegacy = [&]()
+		{
+			for (uint32_t i = 0; i != importCount; ++i)
+			{
+				auto& symbol  = imports[i];
+				auto  policy  = policyManager.getSymbolPolicy(symbol.moduleName, symbol.libraryName, symbol.nid);
+				auto  address = legacyDirectory.find(symbol.moduleName, symbol.libraryName, symbol.nid,
+													 policy == Policy::UseBuiltin);
+				bool useNative   = policyManager.getSymbolPolicy(symbol.moduleName, symbol.libraryName, symbol.nid) ==
+								 Policy::UseNative;
+				legacyResults[i] = useNative || address ? address : nullptr;
+			}
+		};
+
+		double legacyResolveTime = measure(resolveLegacy);
+
+		auto resolveAll = [&]()
+		{
+			for (uint32_t i = 0; i != importCount; ++i)
+			{
+				auto&     symbol = imports[i];
+				SymbolKey key    = { symbol.moduleId, symbol.libraryId, symbol.nid };
+				auto      policy = policyManager.getSymbolPolicy(key.moduleId, key.libraryId, key.nid);
+				results[i]       = policy == Policy::UseBuiltin ? symbolManager.findBuiltinSymbol(key)
+																: symbolManager.findNativeSymbol(key);
+			}
+		};
+
+		double flatResolveTime = measure(resolveAll);
+		bool   flatMatch       = results == legacyResults;
+
+		auto   buildStart = std::chrono::high_resolution_clock::now();
+		symbolManager.buildBuiltinIndex();
+		double buildTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - buildStart).count();
+
+		std::fill(results.begin(), results.end(), nullptr);
+		double perfectResolveTime = measure(resolveAll);
+		bool   perfectMatch       = results == legacyResults;
+
+		uint32_t resolvedCount = static_cast<uint32_t>(
+			std::count_if(results.begin(), results.end(), [](const void* p) { return p != nullptr; }));
+
+		std::printf("Symbols        : %u exports in %u modules, %u imports, %u resolved\n",
+					m_desc.symbolCount, moduleCount, importCount, resolvedCount);
+		std::printf("String maps (previous)\n");
+		std::printf("  Register      : %.3f ms\n", legacyRegisterTime * 1000.0);
+		std::printf("  Resolve       : %.1f M/s\n", importCount / legacyResolveTime / 1000000.0);
+		std::printf("Interned keys, flat table\n");
+		std::printf("  Register      : %.3f ms\n", registerTime * 1000.0);
+		std::printf("  Resolve       : %.1f M/s\n", importCount / flatResolveTime / 1000000.0);
+		std::printf("Interned keys, perfect hash over builtin symbols\n");
+		std::printf("  Build         : %.3f ms\n", buildTime * 1000.0);
+		std::printf("  Resolve       : %.1f M/s\n", importCount / perfectResolveTime / 1000000.0);
+
+		if (!flatMatch || !perfectMatch)
+		{
+			std::printf("Resolved addresses differ from the string maps.\n");
+			break;
+		}
+
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+template <typename Func>
+double SymbolTableBench::measure(Func func)
+{
+	uint32_t repeatCount = std::max(m_desc.repeatCount, 1u);
+	double   bestTime    = 0.0;
+	for (uint32_t i = 0; i != repeatCount; ++i)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		func();
+		auto end = std::chrono::high_resolution_clock::now();
+
+		double time = std::chrono::duration<double>(end - start).count();
+		bestTime    = i == 0 ? time : std::min(bestTime, time);
+	}
+	return bestTime;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "GPCS4Common.h"
+
+#include <cstdint>
+
+struct SymbolTableBenchDesc
+{
+	// Number of exported symbols.
+	uint32_t symbolCount;
+	// Run each test N times and keep the fastest time.
+	uint32_t repeatCount;
+};
+
+// Registers a synthetic set of builtin and native exports, then
+// resolves four imports per export, a few of them unknown, the way
+// CLinker::resolveSymbol does.
+//
+// Compares the string keyed maps the symbol manager used before,
+// with two policy lookups per symbol, against interned keys on the
+// flat table and on the perfect hash built over builtin symbols.
+
+class SymbolTableBench
+{
+public:
+	SymbolTableBench(const SymbolTableBenchDesc& desc);
+	~SymbolTableBench();
+
+	bool run();
+
+private:
+	template <typename Func>
+	double measure(Func func);
+
+private:
+	SymbolTableBenchDesc m_desc;
+};
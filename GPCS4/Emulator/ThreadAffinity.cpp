@@ -0,0 +1,305 @@
+#include "ThreadAffinity.h"
+#include "Platform/PlatHardware.h"
+#include "Platform/PlatThread.h"
+
+#include <algorithm>
+
+LOG_CHANNEL(Emulator.ThreadAffinity);
+
+// Guest cores sharing an L2 on the PS4.
+constexpr std::array<uint32_t, 2> GuestClusterSizes = { 4, 3 };
+
+// Record of the calling thread, saves the lookup when sampling.
+thread_local static void* t_affinity_record = nullptr;
+
+static void logStats(const ThreadAffinityStats& stats)
+{
+	LOG_DEBUG("thread %llx %s: guest mask %llx host mask %llx, %lld sets, %lld migrations in %lld samples",
+			  stats.threadId, stats.name.c_str(), stats.guestMask, stats.hostMask,
+			  stats.setCount, stats.migrationCount, stats.sampleCount);
+}
+
+
+ThreadAffinityMapper::ThreadAffinityMapper()
+{
+}
+
+ThreadAffinityMapper::~ThreadAffinityMapper()
+{
+}
+
+bool ThreadAffinityMapper::initialize(AffinityMode mode, uint32_t reservedCoreCount)
+{
+	bool ret = false;
+	do
+	{
+		m_mode = mode;
+
+		std::vector<plat::CpuCoreInfo> cores;
+		uint32_t                       skippedCount = 0;
+		if (!plat::GetCpuTopology(cores, skippedCount))
+		{
+			LOG_WARN("get cpu topology failed, thread affinity is disabled.");
+			break;
+		}
+
+		if (skippedCount)
+		{
+			LOG_WARN("%d host processors don't fit in an affinity mask, no guest or emulator thread runs on them.", skippedCount);
+		}
+
+		// Emulator threads only get cores of their own
+		// when every guest core still gets one.
+		uint32_t coreCount     = static_cast<uint32_t>(cores.size());
+		uint32_t spareCount    = coreCount > GuestCpuCount ? coreCount - GuestCpuCount : 0;
+		uint32_t reservedCount = std::min(reservedCoreCount, spareCount);
+
+		// Keep the cores at the end for the emulator,
+		// guest clusters are more likely to fit in the first caches.
+		for (uint32_t i = 0; i != reservedCount; ++i)
+		{
+			m_emulatorMask |= cores[coreCount - 1 - i].threadMask;
+		}
+		cores.resize(coreCount - reservedCount);
+
+		std::vector<std::vector<uint64_t>> cacheGroups;
+		for (const auto& core : cores)
+		{
+			if (core.cacheId >= cacheGroups.size())
+			{
+				cacheGroups.resize(core.cacheId + 1);
+			}
+			cacheGroups[core.cacheId].push_back(core.threadMask);
+		}
+
+		auto largestGroup = [&cacheGroups]()
+		{
+			return std::max_element(cacheGroups.begin(), cacheGroups.end(),
+									[](const auto& a, const auto& b)
+									{ return a.size() < b.size(); });
+		};
+
+		// Each guest cluster stays in the cache group with
+		// the most free cores, and only spills over when it's full.
+		std::vector<uint64_t> order;
+		for (uint32_t clusterSize : GuestClusterSizes)
+		{
+			auto group = largestGroup();
+			for (uint32_t i = 0; i != clusterSize; ++i)
+			{
+				if (group->empty())
+				{
+					group = largestGroup();
+					if (group->empty())
+					{
+						break;
+					}
+				}
+				order.push_back(group->front());
+				group->erase(group->begin());
+			}
+		}
+
+		// Hosts with fewer cores than the guest share them.
+		for (uint32_t i = 0; i != GuestCpuCount; ++i)
+		{
+			m_guestCores[i] = order[i % order.size()];
+			m_guestMask |= m_guestCores[i];
+		}
+
+		for (uint32_t processor = 0; processor != m_hostToGuest.size(); ++processor)
+		{
+			m_hostToGuest[processor] = processor % GuestCpuCount;
+		}
+		for (uint32_t i = GuestCpuCount; i-- != 0;)
+		{
+			for (uint32_t processor = 0; processor != m_hostToGuest.size(); ++processor)
+			{
+				if (m_guestCores[i] & (1ull << processor))
+				{
+					m_hostToGuest[processor] = i;
+				}
+			}
+		}
+
+		for (uint32_t i = 0; i != GuestCpuCount; ++i)
+		{
+			LOG_DEBUG("guest cpu %d -> host processors %llx", i, m_guestCores[i]);
+		}
+		LOG_DEBUG("emulator threads -> host processors %llx, %s pinning",
+				  m_emulatorMask, m_mode == AffinityMode::Strict ? "strict" : "loose");
+
+		m_enabled = true;
+		ret       = true;
+	} while (false);
+	return ret;
+}
+
+uint64_t ThreadAffinityMapper::mapGuestMask(uint64_t guestMask) const
+{
+	uint64_t hostMask = 0;
+	if (m_mode == AffinityMode::Strict)
+	{
+		for (uint32_t i = 0; i != GuestCpuCount; ++i)
+		{
+			if (guestMask & (1ull << i))
+			{
+				hostMask |= m_guestCores[i];
+			}
+		}
+	}
+
+	// Masks without any valid guest core run everywhere,
+	// like on the real kernel which ignores unknown bits.
+	return hostMask ? hostMask : m_guestMask;
+}
+
+uint32_t ThreadAffinityMapper::mapHostProcessor(uint32_t processor) const
+{
+	return m_hostToGuest[processor % m_hostToGuest.size()];
+}
+
+bool ThreadAffinityMapper::bindGuestThread(uint64_t threadId, void* handle, uint64_t guestMask)
+{
+	bool ret = false;
+	do
+	{
+		ThreadRecord* record = getRecord(threadId);
+		record->guestMask.store(guestMask, std::memory_order_relaxed);
+		record->setCount.fetch_add(1, std::memory_order_relaxed);
+
+		if (!m_enabled)
+		{
+			ret = true;
+			break;
+		}
+
+		uint64_t hostMask = mapGuestMask(guestMask);
+		bool     bound    = handle ? plat::SetThreadAffinity(handle, hostMask)
+								   : plat::SetThreadAffinity(hostMask);
+		if (!bound)
+		{
+			LOG_WARN("bind thread %llx to %llx failed.", threadId, hostMask);
+			break;
+		}
+
+		record->hostMask.store(hostMask, std::memory_order_relaxed);
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+uint64_t ThreadAffinityMapper::getGuestMask(uint64_t threadId)
+{
+	return getRecord(threadId)->guestMask.load(std::memory_order_relaxed);
+}
+
+void ThreadAffinityMapper::bindEmulatorThread()
+{
+	if (m_enabled && m_emulatorMask)
+	{
+		if (!plat::SetThreadAffinity(m_emulatorMask))
+		{
+			LOG_WARN("bind emulator thread to %llx failed.", m_emulatorMask);
+		}
+	}
+}
+
+uint32_t ThreadAffinityMapper::sampleCurrentCpu(uint64_t threadId)
+{
+	auto record = reinterpret_cast<ThreadRecord*>(t_affinity_record);
+	if (!record || record->threadId != threadId)
+	{
+		record            = getRecord(threadId);
+		t_affinity_record = record;
+	}
+
+	uint32_t processor = plat::GetCurrentProcessor();
+	if (record->sampleCount.load(std::memory_order_relaxed) != 0 &&
+		record->lastProcessor != processor)
+	{
+		record->migrationCount.fetch_add(1, std::memory_order_relaxed);
+	}
+	record->lastProcessor = processor;
+	record->sampleCount.fetch_add(1, std::memory_order_relaxed);
+
+	return mapHostProcessor(processor);
+}
+
+void ThreadAffinityMapper::setThreadName(uint64_t threadId, const char* name)
+{
+	ThreadRecord* record = getRecord(threadId);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	record->name = name ? name : "";
+}
+
+void ThreadAffinityMapper::removeThread(uint64_t threadId)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto iter = m_threads.find(threadId);
+	if (iter != m_threads.end())
+	{
+		logStats(makeStats(*iter->second));
+
+		if (t_affinity_record == iter->second.get())
+		{
+			t_affinity_record = nullptr;
+		}
+		m_threads.erase(iter);
+	}
+}
+
+std::vector<ThreadAffinityStats> ThreadAffinityMapper::getStats()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	std::vector<ThreadAffinityStats> stats;
+	stats.reserve(m_threads.size());
+	for (const auto& thread : m_threads)
+	{
+		stats.push_back(makeStats(*thread.second));
+	}
+	return stats;
+}
+
+void ThreadAffinityMapper::dumpStats()
+{
+	for (const auto& stats : getStats())
+	{
+		logStats(stats);
+	}
+}
+
+ThreadAffinityMapper::ThreadRecord* ThreadAffinityMapper::getRecord(uint64_t threadId)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto& record = m_threads[threadId];
+	if (!record)
+	{
+		record                = std::make_unique<ThreadRecord>();
+		record->threadId      = threadId;
+		record->guestMask     = 0;
+		record->hostMask      = 0;
+		record->setCount      = 0;
+		record->sampleCount   = 0;
+		record->lastProcessor = 0;
+		record->migrationCount = 0;
+	}
+	return record.get();
+}
+
+ThreadAffinityStats ThreadAffinityMapper::makeStats(const ThreadRecord& record) const
+{
+	ThreadAffinityStats stats = {};
+	stats.threadId            = record.threadId;
+	stats.name                = record.name;
+	stats.guestMask           = record.guestMask.load(std::memory_order_relaxed);
+	stats.hostMask            = record.hostMask.load(std::memory_order_relaxed);
+	stats.setCount            = record.setCount.load(std::memory_order_relaxed);
+	stats.sampleCount         = record.sampleCount.load(std::memory_order_relaxed);
+	stats.migrationCount      = record.migrationCount.load(std::memory_order_relaxed);
+	return stats;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "GPCS4Common.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class AffinityMode
+{
+	// Each guest core maps to its own host core,
+	// guest threads only run where the game pinned them.
+	Strict,
+	// Guest threads run on any host core given to the guest,
+	// they are only kept off the emulator's cores.
+	Loose,
+};
+
+struct ThreadAffinityStats
+{
+	uint64_t    threadId;
+	std::string name;
+	// Mask the game asked for and the host processors it maps to.
+	uint64_t guestMask;
+	uint64_t hostMask;
+	uint64_t setCount;
+	// The running processor is sampled when the guest asks for
+	// the current cpu or yields, a migration is a change between two samples.
+	uint64_t sampleCount;
+	uint64_t migrationCount;
+};
+
+// Maps guest cpu masks onto host cores.
+//
+// The PS4 has two clusters of 4 cores with a shared L2 each,
+// games get cores 0-5 and part of core 6. Each guest cluster is
+// mapped onto cores sharing one host last level cache if possible,
+// with every guest core getting a physical core of its own.
+// A few host cores are kept for emulator threads,
+// e.g. the compute queue consumers.
+
+class ThreadAffinityMapper
+{
+public:
+	// SCE_KERNEL_CPUMASK_USER_ALL, the mask threads get by default.
+	static constexpr uint64_t DefaultGuestMask = 0x3f;
+
+	ThreadAffinityMapper();
+	~ThreadAffinityMapper();
+
+	bool initialize(AffinityMode mode, uint32_t reservedCoreCount);
+
+	// Host logical processors a guest mask runs on.
+	uint64_t mapGuestMask(uint64_t guestMask) const;
+
+	// Guest cpu index of a host logical processor.
+	uint32_t mapHostProcessor(uint32_t processor) const;
+
+	// Binds a guest thread, handle is the native thread handle,
+	// or null for the calling thread.
+	bool bindGuestThread(uint64_t threadId, void* handle, uint64_t guestMask);
+
+	uint64_t getGuestMask(uint64_t threadId);
+
+	// Binds the calling thread to the cores kept for the emulator.
+	void bindEmulatorThread();
+
+	// Samples the processor the calling guest thread runs on,
+	// returns the guest cpu index.
+	uint32_t sampleCurrentCpu(uint64_t threadId);
+
+	void setThreadName(uint64_t threadId, const char* name);
+
+	// Logs the statistics of the thread and forgets it.
+	void removeThread(uint64_t threadId);
+
+	std::vector<ThreadAffinityStats> getStats();
+
+	void dumpStats();
+
+private:
+	struct ThreadRecord
+	{
+		uint64_t    threadId;
+		std::string name;
+
+		std::atomic<uint64_t> guestMask;
+		std::atomic<uint64_t> hostMask;
+		std::atomic<uint64_t> setCount;
+		std::atomic<uint64_t> sampleCount;
+		std::atomic<uint64_t> migrationCount;
+		// Only touched by the thread itself.
+		uint32_t lastProcessor;
+	};
+
+	ThreadRecord* getRecord(uint64_t threadId);
+
+	ThreadAffinityStats makeStats(const ThreadRecord& record) const;
+
+private:
+	static constexpr uint32_t GuestCpuCount = 7;
+
+	bool         m_enabled = false;
+	AffinityMode m_mode    = AffinityMode::Loose;
+
+	// Host logical processors of each guest core.
+	std::array<uint64_t, GuestCpuCount> m_guestCores = {};
+	uint64_t                            m_guestMask  = 0;
+	uint64_t                            m_emulatorMask = 0;
+	std::array<uint8_t, 64>             m_hostToGuest  = {};
+
+	std::mutex                                                m_mutex;
+	std::unordered_map<uint64_t, std::unique_ptr<ThreadRecord>> m_threads;
+};
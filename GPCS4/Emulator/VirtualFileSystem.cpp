@@ -0,0 +1,1482 @@
+#include "VirtualFileSystem.h"
+#include "Platform/PlatPath.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#ifdef GPCS4_WINDOWS
+#include <Windows.h>
+#include <direct.h>
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "dirent/dirent.h"
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // GPCS4_WINDOWS
+
+LOG_CHANNEL(Emulator.VirtualFileSystem);
+
+enum class VfsDevice : intptr_t
+{
+	None,
+	Null,
+	Zero,
+};
+
+struct VfsMountPoint
+{
+	// Without the trailing separator.
+	std::string guestPath;
+	std::string hostPath;
+	bool        isDevice;
+};
+
+// A resolved guest path, never changed once it's in the cache.
+struct VfsPathEntry
+{
+	uint64_t    hash;
+	std::string guestPath;
+	std::string hostPath;
+	VfsDevice   device;
+	// Host directory holding the file and the name in it,
+	// -1 if the directory can't be opened or the host has no openat.
+	int         directoryFd;
+	std::string name;
+};
+
+// Host object behind a directory handle.
+struct VfsDirectory
+{
+	DIR*        dir;
+	std::string hostPath;
+};
+
+#ifdef GPCS4_WINDOWS
+constexpr char HostSeparator = '\\';
+#else
+constexpr char HostSeparator = '/';
+#endif  // GPCS4_WINDOWS
+
+static uint64_t hashPath(const char* path, size_t length)
+{
+	// FNV-1a
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (size_t i = 0; i != length; ++i)
+	{
+		hash ^= static_cast<uint8_t>(path[i]);
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+// Collapses repeated separators, . and .. components.
+// Relative paths are taken relative to /app0,
+// which is where the guest process starts.
+static std::string normalizePath(const std::string& path)
+{
+	std::vector<std::string> components;
+	if (path.empty() || path[0] != '/')
+	{
+		components.emplace_back("app0");
+	}
+
+	size_t start = 0;
+	while (start <= path.size())
+	{
+		size_t end = path.find('/', start);
+		if (end == std::string::npos)
+		{
+			end = path.size();
+		}
+
+		std::string component = path.substr(start, end - start);
+		if (component == "..")
+		{
+			if (!components.empty())
+			{
+				components.pop_back();
+			}
+		}
+		else if (!component.empty() && component != ".")
+		{
+			components.emplace_back(std::move(component));
+		}
+
+		start = end + 1;
+	}
+
+	std::string normalized;
+	for (const auto& component : components)
+	{
+		normalized += '/';
+		normalized += component;
+	}
+	return normalized.empty() ? "/" : normalized;
+}
+
+static VfsNodeType getDirEntryType(const dirent* ent)
+{
+	VfsNodeType type = VfsNodeType::Unknown;
+	if (!std::strcmp(ent->d_name, ".") || !std::strcmp(ent->d_name, ".."))
+	{
+		type = VfsNodeType::Directory;
+	}
+	else if (ent->d_type == DT_DIR)
+	{
+		type = VfsNodeType::Directory;
+	}
+	else if (ent->d_type == DT_REG)
+	{
+		type = VfsNodeType::File;
+	}
+	return type;
+}
+
+#ifdef GPCS4_WINDOWS
+
+static int getHostOpenFlags(uint32_t flags)
+{
+	int hostFlags = _O_BINARY;
+	if ((flags & VfsOpenRead) && (flags & VfsOpenWrite))
+	{
+		hostFlags |= _O_RDWR;
+	}
+	else if (flags & VfsOpenWrite)
+	{
+		hostFlags |= _O_WRONLY;
+	}
+	else
+	{
+		hostFlags |= _O_RDONLY;
+	}
+	hostFlags |= (flags & VfsOpenCreate) ? _O_CREAT : 0;
+	hostFlags |= (flags & VfsOpenTruncate) ? _O_TRUNC : 0;
+	hostFlags |= (flags & VfsOpenAppend) ? _O_APPEND : 0;
+	hostFlags |= (flags & VfsOpenExclusive) ? _O_EXCL : 0;
+	return hostFlags;
+}
+
+static int openHostFile(const VfsPathEntry& entry, uint32_t flags)
+{
+	int fd = _open(entry.hostPath.c_str(), getHostOpenFlags(flags), _S_IREAD | _S_IWRITE);
+	return fd < 0 ? -errno : fd;
+}
+
+static DIR* openHostDirectory(const VfsPathEntry& entry)
+{
+	return opendir(entry.hostPath.c_str());
+}
+
+static void fillStat(const struct _stat64& hostStat, VfsStat* stat)
+{
+	bool isDirectory = (hostStat.st_mode & _S_IFMT) == _S_IFDIR;
+	stat->type       = isDirectory ? VfsNodeType::Directory : VfsNodeType::File;
+	stat->size       = hostStat.st_size;
+	stat->inode      = hostStat.st_ino;
+	stat->writable   = (hostStat.st_mode & _S_IWRITE) != 0;
+	stat->entryCount = 0;
+}
+
+static int statHostPath(const std::string& hostPath, VfsStat* stat)
+{
+	int ret = 0;
+	do
+	{
+		struct _stat64 hostStat;
+		if (_stat64(hostPath.c_str(), &hostStat) != 0)
+		{
+			ret = -errno;
+			break;
+		}
+
+		fillStat(hostStat, stat);
+		if (stat->type == VfsNodeType::Directory)
+		{
+			stat->entryCount = plat::FileCountInDirectory(hostPath);
+		}
+	} while (false);
+	return ret;
+}
+
+static int statHostEntry(const VfsPathEntry& entry, VfsStat* stat)
+{
+	return statHostPath(entry.hostPath, stat);
+}
+
+static int statHostFile(intptr_t handle, VfsStat* stat)
+{
+	int ret = 0;
+	do
+	{
+		struct _stat64 hostStat;
+		if (_fstat64(static_cast<int>(handle), &hostStat) != 0)
+		{
+			ret = -errno;
+			break;
+		}
+		fillStat(hostStat, stat);
+	} while (false);
+	return ret;
+}
+
+static int statHostDirectory(const VfsDirectory& directory, VfsStat* stat)
+{
+	return statHostPath(directory.hostPath, stat);
+}
+
+static int closeHostFile(intptr_t handle)
+{
+	return _close(static_cast<int>(handle)) == 0 ? 0 : -errno;
+}
+
+// Positional io moves the file position on a synchronous handle,
+// so it's put back afterwards. Calls using the position hold
+// the lock of the fd, to never see it in between.
+constexpr uint32_t HostFileLockCount = 64;
+static std::mutex  g_hostFileLocks[HostFileLockCount];
+
+static std::mutex& getHostFileLock(intptr_t handle)
+{
+	return g_hostFileLocks[static_cast<uintptr_t>(handle) % HostFileLockCount];
+}
+
+static int64_t readHostFile(intptr_t handle, void* buffer, size_t size)
+{
+	std::lock_guard<std::mutex> lock(getHostFileLock(handle));
+	int count = _read(static_cast<int>(handle), buffer, static_cast<unsigned int>(size));
+	return count < 0 ? -errno : count;
+}
+
+static int64_t writeHostFile(intptr_t handle, const void* buffer, size_t size)
+{
+	std::lock_guard<std::mutex> lock(getHostFileLock(handle));
+	int count = _write(static_cast<int>(handle), buffer, static_cast<unsigned int>(size));
+	return count < 0 ? -errno : count;
+}
+
+static int64_t seekHostFile(intptr_t handle, int64_t offset, int whence)
+{
+	std::lock_guard<std::mutex> lock(getHostFileLock(handle));
+	int64_t position = _lseeki64(static_cast<int>(handle), offset, whence);
+	return position < 0 ? -errno : position;
+}
+
+static int getHostError(DWORD error)
+{
+	int ret = EIO;
+	switch (error)
+	{
+	case ERROR_INVALID_HANDLE:
+	case ERROR_ACCESS_DENIED:
+		ret = EBADF;
+		break;
+	case ERROR_DISK_FULL:
+	case ERROR_HANDLE_DISK_FULL:
+		ret = ENOSPC;
+		break;
+	case ERROR_INVALID_PARAMETER:
+	case ERROR_NEGATIVE_SEEK:
+		ret = EINVAL;
+		break;
+	case ERROR_FILE_NOT_FOUND:
+	case ERROR_PATH_NOT_FOUND:
+		ret = ENOENT;
+		break;
+	case ERROR_ALREADY_EXISTS:
+		ret = EEXIST;
+		break;
+	case ERROR_DIR_NOT_EMPTY:
+		ret = ENOTEMPTY;
+		break;
+	}
+	return ret;
+}
+
+// The CRT has no positional io, the offset is passed to the system
+// with each call instead. The system leaves the file position at the
+// end of the transfer, unlike pread on Linux, so it's saved and restored.
+static int64_t transferHostFile(intptr_t handle, void* buffer, size_t size, uint64_t offset, bool isWrite)
+{
+	std::lock_guard<std::mutex> lock(getHostFileLock(handle));
+
+	int64_t ret = 0;
+	do
+	{
+		HANDLE file = reinterpret_cast<HANDLE>(_get_osfhandle(static_cast<int>(handle)));
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			ret = -EBADF;
+			break;
+		}
+
+		int64_t position = _lseeki64(static_cast<int>(handle), 0, SEEK_CUR);
+		if (position < 0)
+		{
+			ret = -errno;
+			break;
+		}
+
+		OVERLAPPED overlapped = {};
+		overlapped.Offset     = static_cast<DWORD>(offset);
+		overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+		DWORD count   = 0;
+		DWORD length  = static_cast<DWORD>(std::min<size_t>(size, MAXDWORD));
+		BOOL  success = isWrite ? WriteFile(file, buffer, length, &count, &overlapped)
+								: ReadFile(file, buffer, length, &count, &overlapped);
+		DWORD error   = success ? ERROR_SUCCESS : GetLastError();
+
+		_lseeki64(static_cast<int>(handle), position, SEEK_SET);
+
+		if (!success)
+		{
+			// Reading at or past the end.
+			ret = !isWrite && error == ERROR_HANDLE_EOF ? 0 : -getHostError(error);
+			break;
+		}
+
+		ret = count;
+	} while (false);
+	return ret;
+}
+
+static int64_t preadHostFile(intptr_t handle, void* buffer, size_t size, uint64_t offset)
+{
+	return transferHostFile(handle, buffer, size, offset, false);
+}
+
+static int64_t pwriteHostFile(intptr_t handle, const void* buffer, size_t size, uint64_t offset)
+{
+	return transferHostFile(handle, const_cast<void*>(buffer), size, offset, true);
+}
+
+static int reopenHostFile(intptr_t handle)
+{
+	int ret = -EBADF;
+	do
+	{
+		HANDLE file = reinterpret_cast<HANDLE>(_get_osfhandle(static_cast<int>(handle)));
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			break;
+		}
+
+		// The access of the original handle isn't known,
+		// read only files can't be reopened for writing.
+		const DWORD shareMode = FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE;
+		HANDLE      copy      = ReOpenFile(file, GENERIC_READ | GENERIC_WRITE, shareMode, 0);
+		if (copy == INVALID_HANDLE_VALUE)
+		{
+			copy = ReOpenFile(file, GENERIC_READ, shareMode, 0);
+		}
+		if (copy == INVALID_HANDLE_VALUE)
+		{
+			ret = -getHostError(GetLastError());
+			break;
+		}
+
+		int fd = _open_osfhandle(reinterpret_cast<intptr_t>(copy), _O_BINARY);
+		if (fd < 0)
+		{
+			CloseHandle(copy);
+			ret = -EMFILE;
+			break;
+		}
+
+		ret = fd;
+	} while (false);
+	return ret;
+}
+
+static int makeHostDirectory(const VfsPathEntry& entry)
+{
+	return _mkdir(entry.hostPath.c_str()) == 0 ? 0 : -errno;
+}
+
+static int removeHostDirectory(const VfsPathEntry& entry)
+{
+	return _rmdir(entry.hostPath.c_str()) == 0 ? 0 : -errno;
+}
+
+static int unlinkHostFile(const VfsPathEntry& entry)
+{
+	return _unlink(entry.hostPath.c_str()) == 0 ? 0 : -errno;
+}
+
+static int renameHostPath(const VfsPathEntry& from, const VfsPathEntry& to)
+{
+	// Replaces an existing file like rename on the guest,
+	// which the CRT's rename doesn't.
+	BOOL moved = MoveFileExA(from.hostPath.c_str(), to.hostPath.c_str(), MOVEFILE_REPLACE_EXISTING);
+	return moved ? 0 : -getHostError(GetLastError());
+}
+
+static int openHostDirectoryFd(const std::string& hostPath)
+{
+	return -1;
+}
+
+static void closeHostDirectoryFd(int fd)
+{
+}
+
+#else
+
+static int getHostOpenFlags(uint32_t flags)
+{
+	int hostFlags = O_CLOEXEC;
+	if ((flags & VfsOpenRead) && (flags & VfsOpenWrite))
+	{
+		hostFlags |= O_RDWR;
+	}
+	else if (flags & VfsOpenWrite)
+	{
+		hostFlags |= O_WRONLY;
+	}
+	else
+	{
+		hostFlags |= O_RDONLY;
+	}
+	hostFlags |= (flags & VfsOpenCreate) ? O_CREAT : 0;
+	hostFlags |= (flags & VfsOpenTruncate) ? O_TRUNC : 0;
+	hostFlags |= (flags & VfsOpenAppend) ? O_APPEND : 0;
+	hostFlags |= (flags & VfsOpenExclusive) ? O_EXCL : 0;
+	hostFlags |= (flags & VfsOpenDirectory) ? O_DIRECTORY : 0;
+	return hostFlags;
+}
+
+static int openHostAt(const VfsPathEntry& entry, int hostFlags)
+{
+	int fd = entry.directoryFd != -1
+				 ? openat(entry.directoryFd, entry.name.c_str(), hostFlags, 0666)
+				 : ::open(entry.hostPath.c_str(), hostFlags, 0666);
+	return fd < 0 ? -errno : fd;
+}
+
+static int openHostFile(const VfsPathEntry& entry, uint32_t flags)
+{
+	return openHostAt(entry, getHostOpenFlags(flags));
+}
+
+static DIR* openHostDirectory(const VfsPathEntry& entry)
+{
+	DIR* dir = nullptr;
+	do
+	{
+		int fd = openHostAt(entry, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		if (fd < 0)
+		{
+			errno = -fd;
+			break;
+		}
+
+		dir = fdopendir(fd);
+		if (!dir)
+		{
+			::close(fd);
+		}
+	} while (false);
+	return dir;
+}
+
+static uint64_t countDirectoryEntries(int directoryFd)
+{
+	uint64_t count = 0;
+	do
+	{
+		// A fresh fd, so the position of the guest's one is kept.
+		int fd = openat(directoryFd, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		if (fd < 0)
+		{
+			break;
+		}
+
+		DIR* dir = fdopendir(fd);
+		if (!dir)
+		{
+			::close(fd);
+			break;
+		}
+
+		while (readdir(dir))
+		{
+			++count;
+		}
+		closedir(dir);
+	} while (false);
+	return count;
+}
+
+static void fillStat(const struct stat& hostStat, VfsStat* stat)
+{
+	stat->type       = S_ISDIR(hostStat.st_mode) ? VfsNodeType::Directory : VfsNodeType::File;
+	stat->size       = hostStat.st_size;
+	stat->inode      = hostStat.st_ino;
+	stat->writable   = (hostStat.st_mode & S_IWUSR) != 0;
+	stat->entryCount = 0;
+}
+
+static int statHostEntry(const VfsPathEntry& entry, VfsStat* stat)
+{
+	int ret = 0;
+	do
+	{
+		struct stat hostStat;
+		int         err = entry.directoryFd != -1
+							  ? fstatat(entry.directoryFd, entry.name.c_str(), &hostStat, 0)
+							  : ::stat(entry.hostPath.c_str(), &hostStat);
+		if (err != 0)
+		{
+			ret = -errno;
+			break;
+		}
+
+		fillStat(hostStat, stat);
+		if (stat->type == VfsNodeType::Directory)
+		{
+			int fd = openHostAt(entry, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+			if (fd >= 0)
+			{
+				stat->entryCount = countDirectoryEntries(fd);
+				::close(fd);
+			}
+		}
+	} while (false);
+	return ret;
+}
+
+static int statHostFile(intptr_t handle, VfsStat* stat)
+{
+	int ret = 0;
+	do
+	{
+		struct stat hostStat;
+		if (::fstat(static_cast<int>(handle), &hostStat) != 0)
+		{
+			ret = -errno;
+			break;
+		}
+		fillStat(hostStat, stat);
+	} while (false);
+	return ret;
+}
+
+static int statHostDirectory(const VfsDirectory& directory, VfsStat* stat)
+{
+	int ret = statHostFile(dirfd(directory.dir), stat);
+	if (ret == 0)
+	{
+		stat->entryCount = countDirectoryEntries(dirfd(directory.dir));
+	}
+	return ret;
+}
+
+static int closeHostFile(intptr_t handle)
+{
+	return ::close(static_cast<int>(handle)) == 0 ? 0 : -errno;
+}
+
+static int64_t readHostFile(intptr_t handle, void* buffer, size_t size)
+{
+	ssize_t count = ::read(static_cast<int>(handle), buffer, size);
+	return count < 0 ? -errno : count;
+}
+
+static int64_t writeHostFile(intptr_t handle, const void* buffer, size_t size)
+{
+	ssize_t count = ::write(static_cast<int>(handle), buffer, size);
+	return count < 0 ? -errno : count;
+}
+
+static int64_t seekHostFile(intptr_t handle, int64_t offset, int whence)
+{
+	off_t position = lseek(static_cast<int>(handle), offset, whence);
+	return position < 0 ? -errno : position;
+}
+
+static int64_t preadHostFile(intptr_t handle, void* buffer, size_t size, uint64_t offset)
+{
+	ssize_t count = ::pread(static_cast<int>(handle), buffer, size, offset);
+	return count < 0 ? -errno : count;
+}
+
+static int64_t pwriteHostFile(intptr_t handle, const void* buffer, size_t size, uint64_t offset)
+{
+	ssize_t count = ::pwrite(static_cast<int>(handle), buffer, size, offset);
+	return count < 0 ? -errno : count;
+}
+
+static int reopenHostFile(intptr_t handle)
+{
+	int ret = 0;
+	do
+	{
+		int flags = fcntl(static_cast<int>(handle), F_GETFL);
+		if (flags < 0)
+		{
+			ret = -errno;
+			break;
+		}
+
+		// Unlike dup, a new open file description with its own position.
+		char path[32];
+		std::snprintf(path, sizeof(path), "/proc/self/fd/%d", static_cast<int>(handle));
+		int fd = ::open(path, (flags & (O_ACCMODE | O_APPEND)) | O_CLOEXEC);
+		ret    = fd < 0 ? -errno : fd;
+	} while (false);
+	return ret;
+}
+
+// Directory fd and name to pass to the *at calls.
+static int getHostAtFd(const VfsPathEntry& entry, const char** name)
+{
+	*name = entry.directoryFd != -1 ? entry.name.c_str() : entry.hostPath.c_str();
+	return entry.directoryFd != -1 ? entry.directoryFd : AT_FDCWD;
+}
+
+static int makeHostDirectory(const VfsPathEntry& entry)
+{
+	const char* name = nullptr;
+	int         fd   = getHostAtFd(entry, &name);
+	return mkdirat(fd, name, 0777) == 0 ? 0 : -errno;
+}
+
+static int removeHostDirectory(const VfsPathEntry& entry)
+{
+	const char* name = nullptr;
+	int         fd   = getHostAtFd(entry, &name);
+	return unlinkat(fd, name, AT_REMOVEDIR) == 0 ? 0 : -errno;
+}
+
+static int unlinkHostFile(const VfsPathEntry& entry)
+{
+	const char* name = nullptr;
+	int         fd   = getHostAtFd(entry, &name);
+	return unlinkat(fd, name, 0) == 0 ? 0 : -errno;
+}
+
+static int renameHostPath(const VfsPathEntry& from, const VfsPathEntry& to)
+{
+	const char* fromName = nullptr;
+	const char* toName   = nullptr;
+	int         fromFd   = getHostAtFd(from, &fromName);
+	int         toFd     = getHostAtFd(to, &toName);
+	return renameat(fromFd, fromName, toFd, toName) == 0 ? 0 : -errno;
+}
+
+static int openHostDirectoryFd(const std::string& hostPath)
+{
+	return ::open(hostPath.c_str(), O_PATH | O_DIRECTORY | O_CLOEXEC);
+}
+
+static void closeHostDirectoryFd(int fd)
+{
+	::close(fd);
+}
+
+#endif  // GPCS4_WINDOWS
+
+
+// Held by every call using a resolved entry.
+class VirtualFileSystem::ReadScope
+{
+public:
+	ReadScope(VirtualFileSystem& vfs) :
+		m_vfs(vfs)
+	{
+		// Before any cache load, pairs with the fence in freeRetired.
+		m_vfs.m_readerCount.fetch_add(1, std::memory_order_seq_cst);
+	}
+
+	~ReadScope()
+	{
+		m_vfs.m_readerCount.fetch_sub(1, std::memory_order_release);
+	}
+
+private:
+	VirtualFileSystem& m_vfs;
+};
+
+
+VirtualFileSystem::VirtualFileSystem() :
+	m_cache(new std::atomic<VfsPathEntry*>[CacheSize])
+{
+	for (uint32_t i = 0; i != CacheSize; ++i)
+	{
+		m_cache[i].store(nullptr, std::memory_order_relaxed);
+	}
+}
+
+VirtualFileSystem::~VirtualFileSystem()
+{
+	for (const auto& directory : m_directoryFds)
+	{
+		closeHostDirectoryFd(directory.second);
+	}
+	for (int fd : m_retiredDirectoryFds)
+	{
+		closeHostDirectoryFd(fd);
+	}
+}
+
+bool VirtualFileSystem::mount(const std::string& guestPath, const std::string& hostPath)
+{
+	bool ret = false;
+	do
+	{
+		if (hostPath.empty())
+		{
+			LOG_ERR("empty host path for %s", guestPath.c_str());
+			break;
+		}
+
+		auto mountPoint       = std::make_unique<VfsMountPoint>();
+		mountPoint->guestPath = normalizePath(guestPath);
+		mountPoint->hostPath  = hostPath;
+		mountPoint->isDevice  = false;
+
+		std::replace(mountPoint->hostPath.begin(), mountPoint->hostPath.end(), '/', HostSeparator);
+		while (mountPoint->hostPath.size() > 1 && mountPoint->hostPath.back() == HostSeparator)
+		{
+			mountPoint->hostPath.pop_back();
+		}
+
+		LOG_DEBUG("mount %s on %s", mountPoint->hostPath.c_str(), mountPoint->guestPath.c_str());
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_mounts.emplace_back(std::move(mountPoint));
+		// Longest prefix first, so nested mounts win.
+		std::stable_sort(m_mounts.begin(), m_mounts.end(),
+						 [](const auto& lhs, const auto& rhs)
+						 { return lhs->guestPath.size() > rhs->guestPath.size(); });
+		invalidateCache();
+
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+bool VirtualFileSystem::mountDevices(const std::string& guestPath)
+{
+	auto mountPoint       = std::make_unique<VfsMountPoint>();
+	mountPoint->guestPath = normalizePath(guestPath);
+	mountPoint->isDevice  = true;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_mounts.emplace_back(std::move(mountPoint));
+	std::stable_sort(m_mounts.begin(), m_mounts.end(),
+					 [](const auto& lhs, const auto& rhs)
+					 { return lhs->guestPath.size() > rhs->guestPath.size(); });
+	invalidateCache();
+	return true;
+}
+
+void VirtualFileSystem::unmount(const std::string& guestPath)
+{
+	std::string path = normalizePath(guestPath);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto iter = std::find_if(m_mounts.begin(), m_mounts.end(),
+							 [&path](const auto& mountPoint)
+							 { return mountPoint->guestPath == path; });
+	if (iter != m_mounts.end())
+	{
+		m_mounts.erase(iter);
+		invalidateCache();
+	}
+}
+
+std::string VirtualFileSystem::hostPath(const char* guestPath)
+{
+	ReadScope           scope(*this);
+	const VfsPathEntry* entry = resolve(guestPath);
+	return entry ? entry->hostPath : std::string();
+}
+
+int VirtualFileSystem::open(const char* guestPath, uint32_t flags, VfsFile* file)
+{
+	ReadScope scope(*this);
+
+	int ret = -ENOENT;
+	do
+	{
+		const VfsPathEntry* entry = resolve(guestPath);
+		if (!entry)
+		{
+			break;
+		}
+
+		if (entry->device != VfsDevice::None)
+		{
+			file->type   = VfsNodeType::Device;
+			file->handle = static_cast<intptr_t>(entry->device);
+			ret          = 0;
+			break;
+		}
+
+		if (flags & VfsOpenDirectory)
+		{
+			DIR* dir = openHostDirectory(*entry);
+			if (!dir)
+			{
+				ret = -errno;
+				break;
+			}
+			file->type   = VfsNodeType::Directory;
+			file->handle = reinterpret_cast<intptr_t>(new VfsDirectory{ dir, entry->hostPath });
+			ret          = 0;
+			break;
+		}
+
+		int fd = openHostFile(*entry, flags);
+		if (fd < 0)
+		{
+			ret = fd;
+			break;
+		}
+
+		file->type   = VfsNodeType::File;
+		file->handle = fd;
+		ret          = 0;
+	} while (false);
+	return ret;
+}
+
+int VirtualFileSystem::close(VfsFile& file)
+{
+	int ret = 0;
+	switch (file.type)
+	{
+	case VfsNodeType::File:
+		ret = closeHostFile(file.handle);
+		break;
+	case VfsNodeType::Directory:
+	{
+		auto directory = reinterpret_cast<VfsDirectory*>(file.handle);
+		closedir(directory->dir);
+		delete directory;
+	}
+	break;
+	case VfsNodeType::Device:
+		break;
+	default:
+		ret = -EBADF;
+		break;
+	}
+
+	file = VfsFile();
+	return ret;
+}
+
+int VirtualFileSystem::reopen(const VfsFile& file, VfsFile* copy)
+{
+	int ret = 0;
+	switch (file.type)
+	{
+	case VfsNodeType::File:
+		ret = reopenHostFile(file.handle);
+		if (ret >= 0)
+		{
+			copy->type   = VfsNodeType::File;
+			copy->handle = ret;
+			ret          = 0;
+		}
+		break;
+	case VfsNodeType::Directory:
+		ret = -EISDIR;
+		break;
+	case VfsNodeType::Device:
+		*copy = file;
+		break;
+	default:
+		ret = -EBADF;
+		break;
+	}
+	return ret;
+}
+
+int VirtualFileSystem::stat(const char* guestPath, VfsStat* stat)
+{
+	ReadScope scope(*this);
+
+	int ret = -ENOENT;
+	do
+	{
+		const VfsPathEntry* entry = resolve(guestPath);
+		if (!entry)
+		{
+			break;
+		}
+
+		if (entry->device != VfsDevice::None)
+		{
+			*stat          = {};
+			stat->type     = VfsNodeType::Device;
+			stat->writable = true;
+			ret            = 0;
+			break;
+		}
+
+		ret = statHostEntry(*entry, stat);
+	} while (false);
+	return ret;
+}
+
+int VirtualFileSystem::mkdir(const char* guestPath)
+{
+	std::string hostPath;
+
+	int ret = -ENOENT;
+	do
+	{
+		ReadScope           scope(*this);
+		const VfsPathEntry* entry = resolve(guestPath);
+		if (!entry)
+		{
+			break;
+		}
+
+		if (entry->device != VfsDevice::None)
+		{
+			ret = -EEXIST;
+			break;
+		}
+
+		ret      = makeHostDirectory(*entry);
+		hostPath = entry->hostPath;
+	} while (false);
+
+	// Paths below it were resolved without a directory fd.
+	if (ret == 0)
+	{
+		invalidatePath(hostPath);
+	}
+	return ret;
+}
+
+int VirtualFileSystem::rmdir(const char* guestPath)
+{
+	std::string hostPath;
+
+	int ret = -ENOENT;
+	do
+	{
+		ReadScope           scope(*this);
+		const VfsPathEntry* entry = resolve(guestPath);
+		if (!entry)
+		{
+			break;
+		}
+
+		if (entry->device != VfsDevice::None)
+		{
+			ret = -ENOTDIR;
+			break;
+		}
+
+		ret      = removeHostDirectory(*entry);
+		hostPath = entry->hostPath;
+	} while (false);
+
+	if (ret == 0)
+	{
+		invalidatePath(hostPath);
+	}
+	return ret;
+}
+
+int VirtualFileSystem::unlink(const char* guestPath)
+{
+	std::string hostPath;
+
+	int ret = -ENOENT;
+	do
+	{
+		ReadScope           scope(*this);
+		const VfsPathEntry* entry = resolve(guestPath);
+		if (!entry)
+		{
+			break;
+		}
+
+		if (entry->device != VfsDevice::None)
+		{
+			ret = -EPERM;
+			break;
+		}
+
+		ret      = unlinkHostFile(*entry);
+		hostPath = entry->hostPath;
+	} while (false);
+
+	if (ret == 0)
+	{
+		invalidatePath(hostPath);
+	}
+	return ret;
+}
+
+int VirtualFileSystem::rename(const char* fromPath, const char* toPath)
+{
+	std::string fromHostPath;
+	std::string toHostPath;
+
+	int ret = -ENOENT;
+	do
+	{
+		ReadScope           scope(*this);
+		const VfsPathEntry* from = resolve(fromPath);
+		const VfsPathEntry* to   = resolve(toPath);
+		if (!from || !to)
+		{
+			break;
+		}
+
+		if (from->device != VfsDevice::None || to->device != VfsDevice::None)
+		{
+			ret = -EPERM;
+			break;
+		}
+
+		ret          = renameHostPath(*from, *to);
+		fromHostPath = from->hostPath;
+		toHostPath   = to->hostPath;
+	} while (false);
+
+	// A renamed directory takes its children along,
+	// a replaced one drops them.
+	if (ret == 0)
+	{
+		invalidatePath(fromHostPath);
+		invalidatePath(toHostPath);
+	}
+	return ret;
+}
+
+int VirtualFileSystem::fstat(const VfsFile& file, VfsStat* stat)
+{
+	int ret = 0;
+	switch (file.type)
+	{
+	case VfsNodeType::File:
+		ret = statHostFile(file.handle, stat);
+		break;
+	case VfsNodeType::Directory:
+		ret = statHostDirectory(*reinterpret_cast<const VfsDirectory*>(file.handle), stat);
+		break;
+	case VfsNodeType::Device:
+		*stat          = {};
+		stat->type     = VfsNodeType::Device;
+		stat->writable = true;
+		break;
+	default:
+		ret = -EBADF;
+		break;
+	}
+	return ret;
+}
+
+int64_t VirtualFileSystem::read(const VfsFile& file, void* buffer, size_t size)
+{
+	int64_t ret = -EBADF;
+	switch (file.type)
+	{
+	case VfsNodeType::File:
+		ret = readHostFile(file.handle, buffer, size);
+		break;
+	case VfsNodeType::Directory:
+		ret = -EISDIR;
+		break;
+	case VfsNodeType::Device:
+		if (static_cast<VfsDevice>(file.handle) == VfsDevice::Zero)
+		{
+			std::memset(buffer, 0, size);
+			ret = size;
+		}
+		else
+		{
+			ret = 0;
+		}
+		break;
+	default:
+		break;
+	}
+	return ret;
+}
+
+int64_t VirtualFileSystem::write(const VfsFile& file, const void* buffer, size_t size)
+{
+	int64_t ret = -EBADF;
+	switch (file.type)
+	{
+	case VfsNodeType::File:
+		ret = writeHostFile(file.handle, buffer, size);
+		break;
+	case VfsNodeType::Directory:
+		ret = -EISDIR;
+		break;
+	case VfsNodeType::Device:
+		ret = size;
+		break;
+	default:
+		break;
+	}
+	return ret;
+}
+
+int64_t VirtualFileSystem::pread(const VfsFile& file, void* buffer, size_t size, uint64_t offset)
+{
+	return file.type == VfsNodeType::File
+			   ? preadHostFile(file.handle, buffer, size, offset)
+			   : read(file, buffer, size);
+}
+
+int64_t VirtualFileSystem::pwrite(const VfsFile& file, const void* buffer, size_t size, uint64_t offset)
+{
+	return file.type == VfsNodeType::File
+			   ? pwriteHostFile(file.handle, buffer, size, offset)
+			   : write(file, buffer, size);
+}
+
+int64_t VirtualFileSystem::seek(const VfsFile& file, int64_t offset, int whence)
+{
+	int64_t ret = -EBADF;
+	switch (file.type)
+	{
+	case VfsNodeType::File:
+		ret = seekHostFile(file.handle, offset, whence);
+		break;
+	case VfsNodeType::Directory:
+	case VfsNodeType::Device:
+		ret = 0;
+		break;
+	default:
+		break;
+	}
+	return ret;
+}
+
+int VirtualFileSystem::readDirectory(const VfsFile& file, VfsDirEntry* entry)
+{
+	int ret = -ENOTDIR;
+	do
+	{
+		if (file.type != VfsNodeType::Directory)
+		{
+			break;
+		}
+
+		errno    = 0;
+		auto ent = readdir(reinterpret_cast<const VfsDirectory*>(file.handle)->dir);
+		if (!ent)
+		{
+			ret = -errno;
+			break;
+		}
+
+		entry->type  = getDirEntryType(ent);
+		entry->inode = ent->d_ino;
+		std::strncpy(entry->name, ent->d_name, sizeof(entry->name) - 1);
+		entry->name[sizeof(entry->name) - 1] = 0;
+
+		ret = 1;
+	} while (false);
+	return ret;
+}
+
+VfsStats VirtualFileSystem::getStats()
+{
+	VfsStats stats    = {};
+	stats.lookupCount = m_lookupCount.load(std::memory_order_relaxed);
+	stats.missCount   = m_missCount.load(std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	stats.entryCount = m_entries.size();
+	return stats;
+}
+
+void VirtualFileSystem::dumpStats()
+{
+	auto stats = getStats();
+	LOG_DEBUG("path cache: %lld lookups, %lld misses, %lld paths",
+			  stats.lookupCount, stats.missCount, stats.entryCount);
+}
+
+const VfsPathEntry* VirtualFileSystem::resolve(const char* guestPath)
+{
+	const VfsPathEntry* entry = nullptr;
+	do
+	{
+		if (!guestPath)
+		{
+			break;
+		}
+
+		size_t   length = std::strlen(guestPath);
+		uint64_t hash   = hashPath(guestPath, length);
+
+		m_lookupCount.fetch_add(1, std::memory_order_relaxed);
+
+		// Pairs with the release store in resolveSlow,
+		// the entry is complete before it's visible.
+		auto set = &m_cache[hash & (CacheSize - CacheWays)];
+		for (uint32_t i = 0; i != CacheWays; ++i)
+		{
+			VfsPathEntry* cached = set[i].load(std::memory_order_acquire);
+			if (cached && cached->hash == hash &&
+				cached->guestPath.size() == length &&
+				!std::memcmp(cached->guestPath.data(), guestPath, length))
+			{
+				entry = cached;
+				break;
+			}
+		}
+
+		if (entry)
+		{
+			break;
+		}
+
+		m_missCount.fetch_add(1, std::memory_order_relaxed);
+		entry = resolveSlow(guestPath, length, hash);
+	} while (false);
+	return entry;
+}
+
+const VfsPathEntry* VirtualFileSystem::resolveSlow(const char* guestPath, size_t length, uint64_t hash)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	VfsPathEntry* entry = nullptr;
+	do
+	{
+		std::string path(guestPath, length);
+
+		auto iter = m_entries.find(path);
+		if (iter != m_entries.end())
+		{
+			entry = iter->second.get();
+		}
+		else
+		{
+			auto newEntry = makeEntry(path, hash);
+			if (!newEntry)
+			{
+				break;
+			}
+
+			entry = newEntry.get();
+			m_entries.emplace(std::move(path), std::move(newEntry));
+		}
+
+		// An empty way, or one picked by the top hash bits.
+		auto     set = &m_cache[hash & (CacheSize - CacheWays)];
+		uint32_t way = static_cast<uint32_t>(hash >> 62) % CacheWays;
+		for (uint32_t i = 0; i != CacheWays; ++i)
+		{
+			if (!set[i].load(std::memory_order_relaxed))
+			{
+				way = i;
+				break;
+			}
+		}
+		set[way].store(entry, std::memory_order_release);
+	} while (false);
+	return entry;
+}
+
+std::unique_ptr<VfsPathEntry> VirtualFileSystem::makeEntry(const std::string& guestPath, uint64_t hash)
+{
+	std::unique_ptr<VfsPathEntry> entry;
+	do
+	{
+		std::string normalized = normalizePath(guestPath);
+
+		const VfsMountPoint* mountPoint = findMount(normalized);
+		if (!mountPoint)
+		{
+			LOG_WARN("no mount for %s", guestPath.c_str());
+			break;
+		}
+
+		// Path below the mount point, without the leading separator.
+		std::string relative = normalized.substr(mountPoint->guestPath.size());
+		if (!relative.empty() && relative[0] == '/')
+		{
+			relative.erase(0, 1);
+		}
+
+		entry              = std::make_unique<VfsPathEntry>();
+		entry->hash        = hash;
+		entry->guestPath   = guestPath;
+		entry->device      = VfsDevice::None;
+		entry->directoryFd = -1;
+
+		if (mountPoint->isDevice)
+		{
+			if (relative == "null")
+			{
+				entry->device = VfsDevice::Null;
+			}
+			else if (relative == "zero")
+			{
+				entry->device = VfsDevice::Zero;
+			}
+			else
+			{
+				LOG_WARN("unknown device %s", guestPath.c_str());
+				entry.reset();
+			}
+			break;
+		}
+
+		std::replace(relative.begin(), relative.end(), '/', HostSeparator);
+		entry->hostPath = relative.empty() ? mountPoint->hostPath
+										   : mountPoint->hostPath + HostSeparator + relative;
+
+		auto separator = entry->hostPath.find_last_of(HostSeparator);
+		if (separator != std::string::npos && separator + 1 < entry->hostPath.size())
+		{
+			std::string directory = separator != 0 ? entry->hostPath.substr(0, separator)
+													: entry->hostPath.substr(0, 1);
+			entry->name           = entry->hostPath.substr(separator + 1);
+			entry->directoryFd    = getDirectoryFd(directory);
+		}
+	} while (false);
+	return entry;
+}
+
+const VfsMountPoint* VirtualFileSystem::findMount(const std::string& guestPath)
+{
+	const VfsMountPoint* mountPoint = nullptr;
+	for (const auto& candidate : m_mounts)
+	{
+		const std::string& prefix = candidate->guestPath;
+		if (guestPath.compare(0, prefix.size(), prefix) != 0)
+		{
+			continue;
+		}
+
+		// Whole components only, /app0 doesn't cover /app01.
+		if (guestPath.size() != prefix.size() && guestPath[prefix.size()] != '/' && prefix != "/")
+		{
+			continue;
+		}
+
+		mountPoint = candidate.get();
+		break;
+	}
+	return mountPoint;
+}
+
+int VirtualFileSystem::getDirectoryFd(const std::string& hostPath)
+{
+	int fd = -1;
+	do
+	{
+		auto iter = m_directoryFds.find(hostPath);
+		if (iter != m_directoryFds.end())
+		{
+			fd = iter->second;
+			break;
+		}
+
+		fd = openHostDirectoryFd(hostPath);
+		if (fd < 0)
+		{
+			// Not cached, the directory may be created later.
+			break;
+		}
+
+		m_directoryFds.emplace(hostPath, fd);
+	} while (false);
+	return fd;
+}
+
+void VirtualFileSystem::invalidateCache()
+{
+	for (uint32_t i = 0; i != CacheSize; ++i)
+	{
+		m_cache[i].store(nullptr, std::memory_order_relaxed);
+	}
+
+	for (auto& entry : m_entries)
+	{
+		m_retiredEntries.emplace_back(std::move(entry.second));
+	}
+	m_entries.clear();
+
+	freeRetired();
+}
+
+void VirtualFileSystem::invalidatePath(const std::string& hostPath)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// The path itself and everything below it.
+	auto isCovered = [&hostPath](const std::string& path)
+	{
+		return path.compare(0, hostPath.size(), hostPath) == 0 &&
+			   (path.size() == hostPath.size() || path[hostPath.size()] == HostSeparator);
+	};
+
+	for (auto iter = m_entries.begin(); iter != m_entries.end();)
+	{
+		if (!isCovered(iter->second->hostPath))
+		{
+			++iter;
+			continue;
+		}
+
+		// Only resolveSlow stores to the cache, under the mutex.
+		VfsPathEntry* entry = iter->second.get();
+		auto          set   = &m_cache[entry->hash & (CacheSize - CacheWays)];
+		for (uint32_t i = 0; i != CacheWays; ++i)
+		{
+			if (set[i].load(std::memory_order_relaxed) == entry)
+			{
+				set[i].store(nullptr, std::memory_order_relaxed);
+			}
+		}
+
+		m_retiredEntries.emplace_back(std::move(iter->second));
+		iter = m_entries.erase(iter);
+	}
+
+	// Entries being retired may still be opening through them.
+	for (auto iter = m_directoryFds.begin(); iter != m_directoryFds.end();)
+	{
+		if (!isCovered(iter->first))
+		{
+			++iter;
+			continue;
+		}
+
+		m_retiredDirectoryFds.push_back(iter->second);
+		iter = m_directoryFds.erase(iter);
+	}
+
+	freeRetired();
+}
+
+void VirtualFileSystem::freeRetired()
+{
+	// A reader either counted itself before this load, or
+	// does its cache load after the entries were taken out.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_readerCount.load(std::memory_order_acquire) == 0)
+	{
+		m_retiredEntries.clear();
+		for (int fd : m_retiredDirectoryFds)
+		{
+			closeHostDirectoryFd(fd);
+		}
+		m_retiredDirectoryFds.clear();
+	}
+}
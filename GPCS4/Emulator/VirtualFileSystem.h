@@ -0,0 +1,182 @@
+#pragma once
+
+#include "GPCS4Common.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class VfsNodeType
+{
+	Unknown,
+	File,
+	Directory,
+	Device,
+};
+
+enum VfsOpenFlags : uint32_t
+{
+	VfsOpenRead      = 1 << 0,
+	VfsOpenWrite     = 1 << 1,
+	VfsOpenCreate    = 1 << 2,
+	VfsOpenTruncate  = 1 << 3,
+	VfsOpenAppend    = 1 << 4,
+	VfsOpenExclusive = 1 << 5,
+	VfsOpenDirectory = 1 << 6,
+};
+
+// Host object behind a guest fd.
+struct VfsFile
+{
+	VfsNodeType type = VfsNodeType::Unknown;
+	// Host fd of a file, VfsDirectory* of a directory, device id of a device.
+	intptr_t handle = -1;
+};
+
+struct VfsStat
+{
+	VfsNodeType type;
+	uint64_t    size;
+	uint64_t    inode;
+	bool        writable;
+	// Entries in a directory, including . and ..
+	uint64_t entryCount;
+};
+
+struct VfsDirEntry
+{
+	VfsNodeType type;
+	uint64_t    inode;
+	char        name[256];
+};
+
+struct VfsStats
+{
+	uint64_t lookupCount;
+	uint64_t missCount;
+	uint64_t entryCount;
+};
+
+struct VfsMountPoint;
+struct VfsPathEntry;
+
+// Maps guest paths onto the host file system.
+//
+// Guest paths are resolved through a mount table,
+// e.g. /app0 to the game directory, /dev to emulated devices.
+// Resolved paths are kept in a cache which is read without a lock,
+// on Linux together with an fd of the parent directory, so that
+// opening or stating a file only makes the host walk one name.
+//
+// The host tree is expected to change only through the guest,
+// which drops the cached paths it affects, and mounts to be set up
+// before the guest runs.
+//
+// Functions returning int return 0, a count or a handle on success,
+// and a negative errno on failure.
+
+class VirtualFileSystem
+{
+public:
+	VirtualFileSystem();
+	~VirtualFileSystem();
+
+	// Maps a guest directory onto a host directory.
+	bool mount(const std::string& guestPath, const std::string& hostPath);
+
+	// Guest directory holding the emulated devices.
+	bool mountDevices(const std::string& guestPath);
+
+	void unmount(const std::string& guestPath);
+
+	// Host path of a guest path, empty if no host mount covers it.
+	std::string hostPath(const char* guestPath);
+
+	int open(const char* guestPath, uint32_t flags, VfsFile* file);
+
+	int close(VfsFile& file);
+
+	// Opens the file behind a handle once more,
+	// the copy has a position of its own and must be closed too.
+	int reopen(const VfsFile& file, VfsFile* copy);
+
+	int stat(const char* guestPath, VfsStat* stat);
+
+	int mkdir(const char* guestPath);
+
+	int rmdir(const char* guestPath);
+
+	int unlink(const char* guestPath);
+
+	// Replaces an existing file at toPath.
+	int rename(const char* fromPath, const char* toPath);
+
+	int fstat(const VfsFile& file, VfsStat* stat);
+
+	int64_t read(const VfsFile& file, void* buffer, size_t size);
+
+	int64_t write(const VfsFile& file, const void* buffer, size_t size);
+
+	// Read and write at an offset, the file position is kept.
+	int64_t pread(const VfsFile& file, void* buffer, size_t size, uint64_t offset);
+
+	int64_t pwrite(const VfsFile& file, const void* buffer, size_t size, uint64_t offset);
+
+	int64_t seek(const VfsFile& file, int64_t offset, int whence);
+
+	// Returns 1 for an entry and 0 at the end of the directory.
+	int readDirectory(const VfsFile& file, VfsDirEntry* entry);
+
+	VfsStats getStats();
+
+	void dumpStats();
+
+private:
+	const VfsPathEntry* resolve(const char* guestPath);
+
+	const VfsPathEntry* resolveSlow(const char* guestPath, size_t length, uint64_t hash);
+
+	std::unique_ptr<VfsPathEntry> makeEntry(const std::string& guestPath, uint64_t hash);
+
+	const VfsMountPoint* findMount(const std::string& guestPath);
+
+	int getDirectoryFd(const std::string& hostPath);
+
+	// Drops all cached paths, called with the mutex held.
+	void invalidateCache();
+
+	// Drops the cached paths at or below a host path,
+	// and the directory fds there.
+	void invalidatePath(const std::string& hostPath);
+
+	// Frees what was retired if no call holds an entry,
+	// called with the mutex held.
+	void freeRetired();
+
+private:
+	static constexpr uint32_t CacheSize = 16384;
+	static constexpr uint32_t CacheWays = 4;
+
+	// Set associative by path hash, a full set replaces a random way.
+	std::unique_ptr<std::atomic<VfsPathEntry*>[]> m_cache;
+
+	std::atomic<uint64_t> m_lookupCount = 0;
+	std::atomic<uint64_t> m_missCount   = 0;
+
+	// Everything below is only touched on a cache miss.
+	std::mutex                                                     m_mutex;
+	std::vector<std::unique_ptr<VfsMountPoint>>                    m_mounts;
+	std::unordered_map<std::string, std::unique_ptr<VfsPathEntry>> m_entries;
+	// Entries dropped from the cache, a call may still hold them,
+	// freed once no call does.
+	std::vector<std::unique_ptr<VfsPathEntry>> m_retiredEntries;
+	std::vector<int>                           m_retiredDirectoryFds;
+	std::unordered_map<std::string, int>       m_directoryFds;
+
+	// Calls holding a resolved entry.
+	class ReadScope;
+	std::atomic<uint32_t> m_readerCount = 0;
+};
@@ -0,0 +1,319 @@
+#include "VirtualFileSystemBench.h"
+#include "VirtualFileSystem.h"
+#include "UtilString.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#ifdef GPCS4_WINDOWS
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // GPCS4_WINDOWS
+
+LOG_CHANNEL(Emulator.VirtualFileSystemBench);
+
+constexpr uint32_t BenchFileSize    = 4096;
+constexpr uint32_t BenchFilesPerDir = 64;
+
+// What plat::PS4PathToPCPath did on every call,
+// the tree is the working directory while the bench runs.
+static std::string legacyHostPath(const std::string& guestPath)
+{
+	std::string hostPath = guestPath;
+#ifdef GPCS4_WINDOWS
+	std::replace(hostPath.begin(), hostPath.end(), '/', '\\');
+	std::string appPath    = "\\app0\\";
+	std::string workingDir = std::filesystem::current_path().string() + "\\";
+#else
+	std::string appPath    = "/app0/";
+	std::string workingDir = std::filesystem::current_path().string() + "/";
+#endif  // GPCS4_WINDOWS
+	return util::str::replaceAll(hostPath, appPath, workingDir);
+}
+
+static int legacyOpen(const std::string& hostPath)
+{
+#ifdef GPCS4_WINDOWS
+	return _open(hostPath.c_str(), _O_RDONLY | _O_BINARY);
+#else
+	return ::open(hostPath.c_str(), O_RDONLY);
+#endif  // GPCS4_WINDOWS
+}
+
+static int64_t legacyRead(int fd, void* buffer, uint32_t size)
+{
+#ifdef GPCS4_WINDOWS
+	return _read(fd, buffer, size);
+#else
+	return ::read(fd, buffer, size);
+#endif  // GPCS4_WINDOWS
+}
+
+static void legacyClose(int fd)
+{
+#ifdef GPCS4_WINDOWS
+	_close(fd);
+#else
+	::close(fd);
+#endif  // GPCS4_WINDOWS
+}
+
+static uint64_t legacyStat(const std::string& hostPath)
+{
+#ifdef GPCS4_WINDOWS
+	struct _stat64 hostStat;
+	return _stat64(hostPath.c_str(), &hostStat) == 0 ? hostStat.st_size : 0;
+#else
+	struct stat hostStat;
+	return ::stat(hostPath.c_str(), &hostStat) == 0 ? hostStat.st_size : 0;
+#endif  // GPCS4_WINDOWS
+}
+
+
+VirtualFileSystemBench::VirtualFileSystemBench(const VfsBenchDesc& desc) :
+	m_desc(desc)
+{
+}
+
+VirtualFileSystemBench::~VirtualFileSystemBench()
+{
+	removeTree();
+}
+
+bool VirtualFileSystemBench::run()
+{
+	bool ret = false;
+	do
+	{
+		if (m_desc.fileCount == 0)
+		{
+			std::printf("Nothing to run, file count is 0.\n");
+			break;
+		}
+
+		if (!buildTree())
+		{
+			std::printf("Failed to build the file tree.\n");
+			break;
+		}
+
+		VirtualFileSystem vfs;
+		vfs.mount("/app0", m_root);
+
+		std::error_code error;
+		auto            workingDir = std::filesystem::current_path(error);
+		std::filesystem::current_path(m_root, error);
+
+		std::vector<uint8_t> buffer(BenchFileSize);
+		uint64_t             failCount = 0;
+
+		auto legacyOpenClose = [&]()
+		{
+			for (const auto& path : m_guestPaths)
+			{
+				int fd = legacyOpen(legacyHostPath(path));
+				failCount += fd < 0;
+				legacyClose(fd);
+			}
+		};
+
+		auto vfsOpenClose = [&]()
+		{
+			for (const auto& path : m_guestPaths)
+			{
+				VfsFile file;
+				failCount += vfs.open(path.c_str(), VfsOpenRead, &file) < 0;
+				vfs.close(file);
+			}
+		};
+
+		auto legacyStatAll = [&]()
+		{
+			for (const auto& path : m_guestPaths)
+			{
+				failCount += legacyStat(legacyHostPath(path)) != BenchFileSize;
+			}
+		};
+
+		auto vfsStatAll = [&]()
+		{
+			for (const auto& path : m_guestPaths)
+			{
+				VfsStat stat = {};
+				vfs.stat(path.c_str(), &stat);
+				failCount += stat.size != BenchFileSize;
+			}
+		};
+
+		auto legacyReadAll = [&]()
+		{
+			for (const auto& path : m_guestPaths)
+			{
+				int fd = legacyOpen(legacyHostPath(path));
+				failCount += legacyRead(fd, buffer.data(), BenchFileSize) != BenchFileSize;
+				legacyClose(fd);
+			}
+		};
+
+		auto vfsReadAll = [&]()
+		{
+			for (const auto& path : m_guestPaths)
+			{
+				VfsFile file;
+				vfs.open(path.c_str(), VfsOpenRead, &file);
+				failCount += vfs.pread(file, buffer.data(), BenchFileSize, 0) != BenchFileSize;
+				vfs.close(file);
+			}
+		};
+
+		std::printf("Tree           : %u files of %u bytes in %s\n",
+					m_desc.fileCount, BenchFileSize, m_root.c_str());
+
+		report("Open/close", measure(legacyOpenClose), measure(vfsOpenClose));
+		report("Stat", measure(legacyStatAll), measure(vfsStatAll));
+		report("Open/read/close", measure(legacyReadAll), measure(vfsReadAll));
+
+		std::filesystem::current_path(workingDir, error);
+
+		auto stats = vfs.getStats();
+		std::printf("Path cache     : %llu lookups, %llu misses, %llu paths\n",
+					static_cast<unsigned long long>(stats.lookupCount),
+					static_cast<unsigned long long>(stats.missCount),
+					static_cast<unsigned long long>(stats.entryCount));
+
+		if (failCount)
+		{
+			std::printf("%llu operations failed.\n", static_cast<unsigned long long>(failCount));
+			break;
+		}
+
+		if (!checkPosition(vfs))
+		{
+			break;
+		}
+
+		ret = true;
+	} while (false);
+
+	removeTree();
+	return ret;
+}
+
+bool VirtualFileSystemBench::buildTree()
+{
+	bool ret = false;
+	do
+	{
+		std::error_code error;
+		auto            root = std::filesystem::temp_directory_path(error) / "gpcs4_vfs_bench";
+		if (error)
+		{
+			break;
+		}
+
+		std::filesystem::remove_all(root, error);
+		m_root = root.string();
+
+		std::vector<char> content(BenchFileSize, 'x');
+		uint32_t          index = 0;
+		for (; index != m_desc.fileCount; ++index)
+		{
+			uint32_t    dirIndex = index / BenchFilesPerDir;
+			std::string dirName  = util::str::format("dir%u", dirIndex);
+			std::string fileName = util::str::format("file%u.bin", index);
+
+			std::filesystem::create_directories(root / dirName, error);
+			std::ofstream fout(root / dirName / fileName, std::ofstream::binary);
+			if (!fout.write(content.data(), content.size()))
+			{
+				break;
+			}
+
+			m_guestPaths.emplace_back("/app0/" + dirName + "/" + fileName);
+		}
+
+		ret = index == m_desc.fileCount;
+	} while (false);
+	return ret;
+}
+
+void VirtualFileSystemBench::removeTree()
+{
+	if (!m_root.empty())
+	{
+		std::error_code error;
+		std::filesystem::remove_all(m_root, error);
+		m_root.clear();
+	}
+}
+
+bool VirtualFileSystemBench::checkPosition(VirtualFileSystem& vfs)
+{
+	bool ret = false;
+	do
+	{
+		VfsFile file;
+		if (vfs.open(m_guestPaths.front().c_str(), VfsOpenRead | VfsOpenWrite, &file) < 0)
+		{
+			std::printf("Position check: failed to open %s.\n", m_guestPaths.front().c_str());
+			break;
+		}
+
+		uint8_t data[16]   = {};
+		int64_t start      = vfs.seek(file, 100, SEEK_SET);
+		bool    isRead     = vfs.pread(file, data, sizeof(data), 1000) == sizeof(data);
+		int64_t afterRead  = vfs.seek(file, 0, SEEK_CUR);
+		bool    isWritten  = vfs.pwrite(file, data, sizeof(data), 2000) == sizeof(data);
+		int64_t afterWrite = vfs.seek(file, 0, SEEK_CUR);
+		vfs.close(file);
+
+		if (!isRead || !isWritten || afterRead != start || afterWrite != start)
+		{
+			std::printf("Position check: expected %lld, %lld after pread, %lld after pwrite.\n",
+						static_cast<long long>(start),
+						static_cast<long long>(afterRead),
+						static_cast<long long>(afterWrite));
+			break;
+		}
+
+		std::printf("Position check : ok\n");
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+template <typename Func>
+double VirtualFileSystemBench::measure(Func func)
+{
+	uint32_t repeatCount = std::max(m_desc.repeatCount, 1u);
+	double   bestTime    = 0.0;
+	for (uint32_t i = 0; i != repeatCount; ++i)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		func();
+		auto end = std::chrono::high_resolution_clock::now();
+
+		double time = std::chrono::duration<double>(end - start).count();
+		bestTime    = i == 0 ? time : std::min(bestTime, time);
+	}
+	return bestTime;
+}
+
+void VirtualFileSystemBench::report(const char* name, double baselineTime, double time)
+{
+	uint32_t count = m_desc.fileCount;
+	std::printf("%s\n", name);
+	std::printf("  Path translation: %.3f ms, %.2f us per file\n",
+				baselineTime * 1000.0, baselineTime * 1000000.0 / count);
+	std::printf("  Vfs             : %.3f ms, %.2f us per file\n",
+				time * 1000.0, time * 1000000.0 / count);
+	std::printf("  Speedup         : %.2fx\n", baselineTime / time);
+}
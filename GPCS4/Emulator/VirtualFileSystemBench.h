@@ -0,0 +1,48 @@
+#pragma once
+
+#include "GPCS4Common.h"
+
+#include <string>
+#include <vector>
+
+class VirtualFileSystem;
+
+struct VfsBenchDesc
+{
+	// Files in the synthetic tree.
+	uint32_t fileCount;
+	// Run each test N times and keep the fastest time.
+	uint32_t repeatCount;
+};
+
+// Opens, stats and reads every file of a synthetic tree mounted on /app0,
+// once through the VirtualFileSystem and once by translating the guest path
+// on every call and opening the full host path, like before.
+
+class VirtualFileSystemBench
+{
+public:
+	VirtualFileSystemBench(const VfsBenchDesc& desc);
+	~VirtualFileSystemBench();
+
+	bool run();
+
+private:
+	bool buildTree();
+
+	void removeTree();
+
+	// Pread and pwrite must leave the file position where it was.
+	bool checkPosition(VirtualFileSystem& vfs);
+
+	template <typename Func>
+	double measure(Func func);
+
+	void report(const char* name, double baselineTime, double time);
+
+private:
+	VfsBenchDesc m_desc;
+
+	std::string              m_root;
+	std::vector<std::string> m_guestPaths;
+};
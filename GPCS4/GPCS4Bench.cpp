@@ -0,0 +1,346 @@
+#include "Emulator.h"
+#include "Common/GPCS4LogBench.h"
+#include "Common/SceJobBench.h"
+#include "Emulator/AsyncIoBench.h"
+#include "Emulator/HleProfilerBench.h"
+#include "Emulator/SymbolTableBench.h"
+#include "Emulator/VirtualFileSystemBench.h"
+#include "Gcn/GcnShaderBench.h"
+#include "Gnm/GnmPm4Bench.h"
+#include "Loader/ELFMapperBench.h"
+#include "Sce/SceFlipBench.h"
+#include "Sce/SceReplayer.h"
+#include "SceFiber/SceFiberBench.h"
+#include "SceLibkernel/SceSyncBench.h"
+#include "SceLibkernel/SceTimeBench.h"
+#include "ScePad/ScePadBench.h"
+
+#include <cxxopts/cxxopts.hpp>
+
+LOG_CHANNEL(Bench);
+
+cxxopts::ParseResult processCommandLine(int argc, char* argv[])
+{
+	cxxopts::Options opts("GPCS4Bench", "GPCS4 Benchmarks");
+	opts.allow_unrecognised_options();
+	opts.add_options()("D,debug-channel", "Enable debug channel. 'ALL' for all channels, append ':trace', ':debug', ':fixme', ':warn', ':error' or ':off' to set the lowest level shown.", cxxopts::value<std::vector<std::string>>())("L,list-channels", "List debug channels.")("H,help", "Print help message.");
+	opts.add_options("Log")("log-file", "Also write log messages to the given file.", cxxopts::value<std::string>());
+	opts.add_options("Log Bench")("log-bench", "Check log message formatting, then log the given number of messages per thread, formatted on the logging thread and on the caller, and report the cost of a log call.", cxxopts::value<uint32_t>())("log-bench-threads", "Number of logging threads.", cxxopts::value<uint32_t>()->default_value("2"))("log-bench-path", "File the bench messages are written to.", cxxopts::value<std::string>()->default_value("GPCS4LogBench.log"));
+	opts.add_options("Shader Bench")("shader-bench", "Compile a directory of dumped GCN shaders offline and report compile statistics.", cxxopts::value<std::string>())("bench-report", "Write per-shader results to the given CSV file.", cxxopts::value<std::string>())("bench-threads", "Number of compile threads, 0 for all hardware threads.", cxxopts::value<uint32_t>()->default_value("0"))("bench-repeat", "Compile each shader N times and keep the fastest time.", cxxopts::value<uint32_t>()->default_value("1"))("bench-validate", "Validate SPIR-V output with spirv-val.")("bench-compare-promotion", "Also compile without GPR promotion and report both SPIR-V outputs.");
+	opts.add_options("PM4 Bench")("pm4-bench", "Process a synthetic command buffer with the given number of draws and report packet throughput.", cxxopts::value<uint32_t>())("pm4-bench-repeat", "Process the command buffer N times and keep the fastest time.", cxxopts::value<uint32_t>()->default_value("10"));
+	opts.add_options("Fiber Bench")("fiber-bench", "Switch between the thread and a fiber the given number of round trips and report switch throughput.", cxxopts::value<uint32_t>());
+	opts.add_options("Job Bench")("job-bench", "Run the given number of synthetic jobs on the work stealing job scheduler and report throughput and scheduler statistics.", cxxopts::value<uint32_t>());
+	opts.add_options("Sync Bench")("sync-bench", "Run the given number of iterations per thread on contended event flags and semaphores, comparing against the mutex based versions.", cxxopts::value<uint32_t>())("sync-bench-threads", "Number of contending threads.", cxxopts::value<uint32_t>()->default_value("4"));
+	opts.add_options("VFS Bench")("vfs-bench", "Open, stat and read the given number of files of a synthetic tree through the virtual file system and report the gain over plain path translation.", cxxopts::value<uint32_t>())("vfs-bench-repeat", "Run each test N times and keep the fastest time.", cxxopts::value<uint32_t>()->default_value("5"));
+	opts.add_options("AIO Bench")("aio-bench", "Read a data file of the given size in MB through the async io engine on each backend and report throughput and the latency of urgent reads.", cxxopts::value<uint32_t>())("aio-bench-repeat", "Run each throughput test N times and keep the fastest time.", cxxopts::value<uint32_t>()->default_value("3"));
+	opts.add_options("ELF Bench")("elf-bench", "Load a synthetic executable with an image of the given size in MB, mapped and copied, and report load time and resident memory.", cxxopts::value<uint32_t>())("elf-bench-repeat", "Load the executable N times and keep the fastest time.", cxxopts::value<uint32_t>()->default_value("5"));
+	opts.add_options("Link Bench")("link-bench", "Register the given number of synthetic exports and resolve four imports for each, with string keyed maps and interned keys.", cxxopts::value<uint32_t>())("link-bench-repeat", "Run each test N times and keep the fastest time.", cxxopts::value<uint32_t>()->default_value("5"));
+	opts.add_options("Flip Bench")("flip-bench", "Flip the given number of frames of varying length at 60, 30 and 20 fps on a virtual clock and report frame time variance.", cxxopts::value<uint32_t>())("flip-bench-realtime", "Also flip N frames at 60 fps on the host clock.", cxxopts::value<uint32_t>()->default_value("0"));
+	opts.add_options("Pad Bench")("pad-bench", "Replay a synthetic input script on a virtual clock, then read the pad the given number of times per thread while it's sampled, and report read cost and torn samples.", cxxopts::value<uint32_t>())("pad-bench-threads", "Number of reading threads.", cxxopts::value<uint32_t>()->default_value("2"));
+	opts.add_options("Time Bench")("time-bench", "Call the kernel time functions the given number of times as they were before, on the host clock and on the calibrated tsc, and report the cost of a call.", cxxopts::value<uint32_t>())("time-bench-repeat", "Run each test N times and keep the fastest time.", cxxopts::value<uint32_t>()->default_value("5"));
+	opts.add_options("Replay")("replay", "Replay a capture file and report frame times.", cxxopts::value<std::string>())("replay-loops", "Replay the capture N times.", cxxopts::value<uint32_t>()->default_value("1"))("headless", "Replay without a display window, present into offscreen images.")("refresh-rate", "Vblanks per second of the emulated display, 0 to not pace flips.", cxxopts::value<uint32_t>()->default_value("0"))("profile", "Record a CPU/GPU timeline of the replay and write it to the given Chrome trace JSON file.", cxxopts::value<std::string>())("profile-start", "First frame to profile.", cxxopts::value<uint32_t>()->default_value("0"))("profile-frames", "Number of frames to profile.", cxxopts::value<uint32_t>()->default_value("60"));
+	opts.add_options("HLE Bench")("hle-bench", "Call functions the given number of times directly and through HLE profiler stubs and report the stub overhead.", cxxopts::value<uint32_t>())("hle-bench-repeat", "Run each test N times and keep the fastest time.", cxxopts::value<uint32_t>()->default_value("5"));
+
+	// Backup arg count,
+	// because cxxopts will change argc value internally,
+	// which I think is a bad design.
+	const uint32_t argCount = argc;
+
+	auto optResult = opts.parse(argc, argv);
+	if (optResult.count("H") || argCount < 2)
+	{
+		auto helpString = opts.help();
+		printf("%s\n", helpString.c_str());
+		exit(-1);
+	}
+
+	return optResult;
+}
+
+bool runShaderBench(const cxxopts::ParseResult& optResult)
+{
+	sce::gcn::GcnShaderBenchDesc desc = {};
+	desc.corpusPath       = optResult["shader-bench"].as<std::string>();
+	if (optResult.count("bench-report"))
+	{
+		desc.reportPath       = optResult["bench-report"].as<std::string>();
+	}
+	desc.threadCount      = optResult["bench-threads"].as<uint32_t>();
+	desc.repeatCount      = optResult["bench-repeat"].as<uint32_t>();
+	desc.validate         = optResult.count("bench-validate") != 0;
+	desc.comparePromotion = optResult.count("bench-compare-promotion") != 0;
+
+	sce::gcn::GcnShaderBench bench(desc);
+	return bench.run();
+}
+
+bool runPm4Bench(const cxxopts::ParseResult& optResult)
+{
+	sce::Gnm::GnmPm4BenchDesc desc = {};
+	desc.drawCount                 = optResult["pm4-bench"].as<uint32_t>();
+	desc.repeatCount               = optResult["pm4-bench-repeat"].as<uint32_t>();
+
+	sce::Gnm::GnmPm4Bench bench(desc);
+	return bench.run();
+}
+
+bool runFiberBench(const cxxopts::ParseResult& optResult)
+{
+	SceFiberBenchDesc desc = {};
+	desc.roundTripCount    = optResult["fiber-bench"].as<uint32_t>();
+
+	CSceFiberBench bench(desc);
+	return bench.Run();
+}
+
+bool runJobBench(const cxxopts::ParseResult& optResult)
+{
+	SceJobBenchDesc desc = {};
+	desc.jobCount        = optResult["job-bench"].as<uint32_t>();
+
+	CSceJobBench bench(desc);
+	return bench.Run();
+}
+
+bool runSyncBench(const cxxopts::ParseResult& optResult)
+{
+	SceSyncBenchDesc desc = {};
+	desc.iterationCount   = optResult["sync-bench"].as<uint32_t>();
+	desc.threadCount      = optResult["sync-bench-threads"].as<uint32_t>();
+
+	CSceSyncBench bench(desc);
+	return bench.Run();
+}
+
+bool runVfsBench(const cxxopts::ParseResult& optResult)
+{
+	VfsBenchDesc desc = {};
+	desc.fileCount    = optResult["vfs-bench"].as<uint32_t>();
+	desc.repeatCount  = optResult["vfs-bench-repeat"].as<uint32_t>();
+
+	VirtualFileSystemBench bench(desc);
+	return bench.run();
+}
+
+bool runAioBench(const cxxopts::ParseResult& optResult)
+{
+	AsyncIoBenchDesc desc = {};
+	desc.fileSize         = optResult["aio-bench"].as<uint32_t>();
+	desc.repeatCount      = optResult["aio-bench-repeat"].as<uint32_t>();
+
+	AsyncIoBench bench(desc);
+	return bench.run();
+}
+
+bool runElfBench(const cxxopts::ParseResult& optResult)
+{
+	ELFMapperBenchDesc desc = {};
+	desc.imageSize          = optResult["elf-bench"].as<uint32_t>();
+	desc.repeatCount        = optResult["elf-bench-repeat"].as<uint32_t>();
+
+	ELFMapperBench bench(desc);
+	return bench.run();
+}
+
+bool runLinkBench(const cxxopts::ParseResult& optResult)
+{
+	SymbolTableBenchDesc desc = {};
+	desc.symbolCount          = optResult["link-bench"].as<uint32_t>();
+	desc.repeatCount          = optResult["link-bench-repeat"].as<uint32_t>();
+
+	SymbolTableBench bench(desc);
+	return bench.run();
+}
+
+bool runFlipBench(const cxxopts::ParseResult& optResult)
+{
+	sce::SceFlipBenchDesc desc = {};
+	desc.frameCount            = optResult["flip-bench"].as<uint32_t>();
+	desc.realtimeFrameCount    = optResult["flip-bench-realtime"].as<uint32_t>();
+
+	sce::SceFlipBench bench(desc);
+	return bench.run();
+}
+
+bool runPadBench(const cxxopts::ParseResult& optResult)
+{
+	ScePadBenchDesc desc = {};
+	desc.readCount       = optResult["pad-bench"].as<uint32_t>();
+	desc.threadCount     = optResult["pad-bench-threads"].as<uint32_t>();
+
+	ScePadBench bench(desc);
+	return bench.run();
+}
+
+bool runLogBench(const cxxopts::ParseResult& optResult)
+{
+	logsys::LogBenchDesc desc = {};
+	desc.messageCount         = optResult["log-bench"].as<uint32_t>();
+	desc.threadCount          = optResult["log-bench-threads"].as<uint32_t>();
+	desc.filePath             = optResult["log-bench-path"].as<std::string>();
+
+	logsys::LogBench bench(desc);
+	return bench.run();
+}
+
+bool runTimeBench(const cxxopts::ParseResult& optResult)
+{
+	SceTimeBenchDesc desc = {};
+	desc.callCount        = optResult["time-bench"].as<uint32_t>();
+	desc.repeatCount      = optResult["time-bench-repeat"].as<uint32_t>();
+
+	CSceTimeBench bench(desc);
+	return bench.Run();
+}
+
+bool runHleBench(const cxxopts::ParseResult& optResult)
+{
+	HleProfilerBenchDesc desc = {};
+	desc.callCount            = optResult["hle-bench"].as<uint32_t>();
+	desc.repeatCount          = optResult["hle-bench-repeat"].as<uint32_t>();
+
+	HleProfilerBench bench(desc);
+	return bench.run();
+}
+
+bool runReplay(const cxxopts::ParseResult& optResult)
+{
+	bool ret = false;
+	do
+	{
+		// Replaying only needs the GPU, not the game.
+		EmulatorOptions options   = {};
+		options.headless          = optResult.count("headless") != 0;
+		options.refreshRate       = optResult["refresh-rate"].as<uint32_t>();
+		if (optResult.count("profile"))
+		{
+			options.profilePath = optResult["profile"].as<std::string>();
+		}
+		options.profileStartFrame = optResult["profile-start"].as<uint32_t>();
+		options.profileFrameCount = optResult["profile-frames"].as<uint32_t>();
+		if (!TheEmulator().Init(options))
+		{
+			break;
+		}
+
+		{
+			sce::SceReplayDesc desc = {};
+			desc.path               = optResult["replay"].as<std::string>();
+			desc.loopCount          = optResult["replay-loops"].as<uint32_t>();
+
+			sce::SceReplayer replayer(desc);
+			ret = replayer.run();
+		}
+
+		TheEmulator().Unit();
+	} while (false);
+	return ret;
+}
+
+int main(int argc, char* argv[])
+{
+	int nRet = -1;
+
+	do
+	{
+		auto optResult = processCommandLine(argc, argv);
+
+		// Initialize log system.
+		logsys::init(optResult);
+
+		// Benchmarks run on synthetic or dumped data,
+		// the emulator is never initialized.
+		if (optResult.count("shader-bench"))
+		{
+			nRet = runShaderBench(optResult) ? 0 : -1;
+			break;
+		}
+
+		if (optResult.count("pm4-bench"))
+		{
+			nRet = runPm4Bench(optResult) ? 0 : -1;
+			break;
+		}
+
+		if (optResult.count("fiber-bench"))
+		{
+			nRet = runFiberBench(optResult) ? 0 : -1;
+			break;
+		}
+
+		if (optResult.count("job-bench"))
+		{
+			nRet = runJobBench(optResult) ? 0 : -1;
+			break;
+		}
+
+		if (optResult.count("sync-bench"))
+		{
+			nRet = runSyncBench(optResult) ? 0 : -1;
+			break;
+		}
+
+		if (optResult.count("vfs-bench"))
+		{
+			nRet = runVfsBench(optResult) ? 0 : -1;
+			break;
+		}
+
+		if (optResult.count("aio-bench"))
+		{
+			nRet = runAioBench(optResult) ? 0 : -1;
+			break;
+		}
+
+		if (optResult.count("elf-bench"))
+		{
+			nRet = runElfBench(optResult) ? 0 : -1;
+			break;
+		}
+
+		if (optResult.count("link-bench"))
+		{
+			nRet = runLinkBench(optResult) ? 0 : -1;
+			break;
+		}
+
+		if (optResult.count("flip-bench"))
+		{
+			nRet = runFlipBench(optResult) ? 0 : -1;
+			break;
+		}
+
+		if (optResult.count("pad-bench"))
+		{
+			nRet = runPadBench(optResult) ? 0 : -1;
+			break;
+		}
+
+		if (optResult.count("log-bench"))
+		{
+			nRet = runLogBench(optResult) ? 0 : -1;
+			break;
+		}
+
+		if (optResult.count("time-bench"))
+		{
+			nRet = runTimeBench(optResult) ? 0 : -1;
+			break;
+		}
+
+		if (optResult.count("hle-bench"))
+		{
+			nRet = runHleBench(optResult) ? 0 : -1;
+			break;
+		}
+
+		// Replays initialize the emulator, but run no game.
+		if (optResult.count("replay"))
+		{
+			nRet = runReplay(optResult) ? 0 : -1;
+			break;
+		}
+	} while (false);
+
+	return nRet;
+}
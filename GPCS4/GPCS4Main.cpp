@@ -4,6 +4,7 @@
 #include "Loader/ModuleLoader.h"
 
 #include <cxxopts/cxxopts.hpp>
+#include <cstdio>
 #include <memory>
 
 LOG_CHANNEL(Main);
@@ -12,7 +13,18 @@ cxxopts::ParseResult processCommandLine(int argc, char* argv[])
 {
 	cxxopts::Options opts("GPCS4", "PlayStation 4 Emulator");
 	opts.allow_unrecognised_options();
-	opts.add_options()("E,eboot", "Set main executable. The current working directory will be mapped to /app0.", cxxopts::value<std::string>())("D,debug-channel", "Enable debug channel. 'ALL' for all channels.", cxxopts::value<std::vector<std::string>>())("L,list-channels", "List debug channels.")("H,help", "Print help message.");
+	opts.add_options()("E,eboot", "Set main executable. The current working directory will be mapped to /app0.", cxxopts::value<std::string>())("D,debug-channel", "Enable debug channel. 'ALL' for all channels, append ':trace', ':debug', ':fixme', ':warn', ':error' or ':off' to set the lowest level shown.", cxxopts::value<std::vector<std::string>>())("L,list-channels", "List debug channels.")("H,help", "Print help message.");
+	opts.add_options("Log")("log-file", "Also write log messages to the given file.", cxxopts::value<std::string>());
+	opts.add_options("Headless")("headless", "Run without a display window, present into offscreen images.")("dump-frames", "Dump every Nth presented frame to png in headless mode, 0 to discard all frames.", cxxopts::value<uint32_t>()->default_value("0"))("dump-path", "Directory to write dumped frames to.", cxxopts::value<std::string>()->default_value("."));
+	opts.add_options("Profiler")("profile", "Record a CPU/GPU timeline and write it to the given Chrome trace JSON file.", cxxopts::value<std::string>())("profile-start", "First frame to profile.", cxxopts::value<uint32_t>()->default_value("0"))("profile-frames", "Number of frames to profile.", cxxopts::value<uint32_t>()->default_value("60"));
+	opts.add_options("Display")("refresh-rate", "Vblanks per second of the emulated display, flips are retired at vblank. 0 to not pace flips.", cxxopts::value<uint32_t>()->default_value("60"));
+	opts.add_options("Pad")("pad-script", "Replay the given input script on the pad instead of reading the keyboard.", cxxopts::value<std::string>());
+	opts.add_options("Time")("host-clock", "Read the host clock for every guest time call, instead of the calibrated tsc.");
+	opts.add_options("HLE Profiler")("hle-profile", "Count and time calls to HLE functions, the hottest are reported on exit.")("hle-profile-interval", "Also report every N frames, 0 to only report on exit.", cxxopts::value<uint32_t>()->default_value("0"))("hle-profile-count", "Number of functions listed in a report.", cxxopts::value<uint32_t>()->default_value("30"));
+	opts.add_options("Loader")("link-threads", "Number of threads relocating modules at boot, 0 for all hardware threads.", cxxopts::value<uint32_t>()->default_value("0"));
+	opts.add_options("Async IO")("aio-backend", "Backend of asynchronous file io, 'threads' for a thread pool, 'uring' for io_uring, 'auto' to pick io_uring where the host has it.", cxxopts::value<std::string>()->default_value("threads"));
+	opts.add_options("Affinity")("affinity", "How guest thread affinity is applied, 'strict' pins each guest core to its own host core, 'loose' only keeps guest threads off the emulator's cores.", cxxopts::value<std::string>()->default_value("loose"))("reserve-cores", "Number of host cores kept for emulator threads.", cxxopts::value<uint32_t>()->default_value("1"));
+	opts.add_options("Capture")("capture", "Record submitted command buffers and the memory they reference to the given file.", cxxopts::value<std::string>())("capture-start", "First frame to capture.", cxxopts::value<uint32_t>()->default_value("0"))("capture-frames", "Number of frames to capture.", cxxopts::value<uint32_t>()->default_value("1"));
 
 	// Backup arg count,
 	// because cxxopts will change argc value internally,
@@ -30,6 +42,83 @@ cxxopts::ParseResult processCommandLine(int argc, char* argv[])
 	return optResult;
 }
 
+bool parseEmulatorOptions(const cxxopts::ParseResult& optResult, EmulatorOptions& options)
+{
+	bool ret = false;
+	do
+	{
+		options                   = {};
+		options.headless          = optResult.count("headless") != 0;
+		options.frameDumpInterval = optResult["dump-frames"].as<uint32_t>();
+		options.frameDumpPath     = optResult["dump-path"].as<std::string>();
+		if (optResult.count("profile"))
+		{
+			options.profilePath = optResult["profile"].as<std::string>();
+		}
+		options.profileStartFrame = optResult["profile-start"].as<uint32_t>();
+		options.profileFrameCount = optResult["profile-frames"].as<uint32_t>();
+		if (optResult.count("capture"))
+		{
+			options.capturePath = optResult["capture"].as<std::string>();
+		}
+		options.captureStartFrame = optResult["capture-start"].as<uint32_t>();
+		options.captureFrameCount = optResult["capture-frames"].as<uint32_t>();
+
+		auto affinity = optResult["affinity"].as<std::string>();
+		if (affinity == "strict")
+		{
+			options.affinityMode = AffinityMode::Strict;
+		}
+		else if (affinity == "loose")
+		{
+			options.affinityMode = AffinityMode::Loose;
+		}
+		else
+		{
+			std::fprintf(stderr, "unknown --affinity value %s, expected strict or loose\n", affinity.c_str());
+			break;
+		}
+		options.reservedCoreCount  = optResult["reserve-cores"].as<uint32_t>();
+		options.hleProfile         = optResult.count("hle-profile") != 0;
+		options.hleProfileInterval = optResult["hle-profile-interval"].as<uint32_t>();
+		options.hleProfileCount    = optResult["hle-profile-count"].as<uint32_t>();
+
+		if (optResult.count("pad-script"))
+		{
+			options.padScriptPath = optResult["pad-script"].as<std::string>();
+		}
+
+		options.refreshRate = optResult["refresh-rate"].as<uint32_t>();
+
+		auto aioBackend = optResult["aio-backend"].as<std::string>();
+		if (aioBackend == "threads")
+		{
+			options.aioBackend = AsyncIoBackend::ThreadPool;
+		}
+		else if (aioBackend == "uring")
+		{
+			options.aioBackend = AsyncIoBackend::IoUring;
+		}
+		else if (aioBackend == "auto")
+		{
+			options.aioBackend = AsyncIoBackend::Auto;
+		}
+		else
+		{
+			std::fprintf(stderr, "unknown --aio-backend value %s, expected threads, uring or auto\n", aioBackend.c_str());
+			break;
+		}
+
+		if (optResult.count("host-clock"))
+		{
+			options.clockSource = GuestClockSource::Host;
+		}
+
+		ret = true;
+	} while (false);
+	return ret;
+}
+
 int main(int argc, char* argv[])
 {
 	int nRet = -1;
@@ -50,7 +139,13 @@ int main(int argc, char* argv[])
 
 		LOG_DEBUG("GPCS4 start.");
 
-		if (!TheEmulator().Init())
+		EmulatorOptions options;
+		if (!parseEmulatorOptions(optResult, options))
+		{
+			break;
+		}
+
+		if (!TheEmulator().Init(options))
 		{
 			break;
 		}
@@ -60,7 +155,7 @@ int main(int argc, char* argv[])
 			break;
 		}
 
-		CLinker      linker = { *CSceModuleSystem::GetInstance() };
+		CLinker      linker = { *CSceModuleSystem::GetInstance(), optResult["link-threads"].as<uint32_t>() };
 		ModuleLoader loader = { *CSceModuleSystem::GetInstance(), linker };
 
 		auto          eboot       = optResult["E"].as<std::string>();
@@ -89,6 +89,7 @@ namespace sce::gcn
 			case GcnInstClass::ScalarAbs:
 				break;
 			case GcnInstClass::ScalarMov:
+				this->analyzeRegisterIndexing(ins);
 				break;
 			case GcnInstClass::ScalarCmp:
 				break;
@@ -107,6 +108,7 @@ namespace sce::gcn
 			case GcnInstClass::ScalarQuadMask:
 				break;
 			case GcnInstClass::VectorRegMov:
+				this->analyzeRegisterIndexing(ins);
 				break;
 			case GcnInstClass::VectorLane:
 				this->analyzeLane(ins);
@@ -269,4 +271,25 @@ namespace sce::gcn
 		}
 	}
 
+	void GcnAnalyzer::analyzeRegisterIndexing(const GcnShaderInstruction& ins)
+	{
+		auto op = ins.opcode;
+		switch (op)
+		{
+			case GcnOpcode::S_MOVRELS_B32:
+			case GcnOpcode::S_MOVRELS_B64:
+			case GcnOpcode::S_MOVRELD_B32:
+			case GcnOpcode::S_MOVRELD_B64:
+				m_analysis->sgprIndexing = true;
+				break;
+			case GcnOpcode::V_MOVRELD_B32:
+			case GcnOpcode::V_MOVRELS_B32:
+			case GcnOpcode::V_MOVRELSD_B32:
+				m_analysis->vgprIndexing = true;
+				break;
+			default:
+				break;
+		}
+	}
+
 }  // namespace sce::gcn
\ No newline at end of file
@@ -32,6 +32,11 @@ namespace sce::gcn
 
 		// VGPRs used by lane instructions.
 		std::unordered_set<uint32_t> laneVgprs;
+
+		// Register files accessed with M0 relative index,
+		// these must be kept as arrays.
+		bool sgprIndexing = false;
+		bool vgprIndexing = false;
 	};
 
 
@@ -97,6 +102,9 @@ namespace sce::gcn
 		void analyzeLane(
 			const GcnShaderInstruction& ins);
 
+		void analyzeRegisterIndexing(
+			const GcnShaderInstruction& ins);
+
 	private:
 		GcnAnalysisInfo* m_analysis;
 		GcnCfgPass       m_cfgPass;
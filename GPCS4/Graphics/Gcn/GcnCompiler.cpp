@@ -726,33 +726,44 @@ namespace sce::gcn
 
 	void GcnCompiler::emitDclGprArray()
 	{
+		bool promote = m_moduleInfo.options.promoteGprs;
+
 		// Define sgpr array.
-		emitDclGprArray(m_sArray, "s");
+		emitDclGprArray(m_sArray, "s", promote && !m_analysis->sgprIndexing);
 
 		// Define vgpr array.
-		emitDclGprArray(m_vArray, "v");
+		emitDclGprArray(m_vArray, "v", promote && !m_analysis->vgprIndexing);
 	}
 
 	void GcnCompiler::emitDclGprArray(GcnGprArray&       arrayInfo,
-									  const std::string& name)
+									  const std::string& name,
+									  bool               promote)
 	{
-		uint32_t typeId = getScalarTypeId(GcnScalarType::Float32);
+		// An access chain into a Private array can't be
+		// resolved to a register by some drivers, which
+		// then spill the whole array to scratch memory.
+		// Registers are declared on first use instead.
+		arrayInfo.promoted = promote;
+		if (!promote)
+		{
+			uint32_t typeId = getScalarTypeId(GcnScalarType::Float32);
 
-		// Note that mutable arrays will be compiled to
-		// registers by GPU driver, so we should make array
-		// length as small as possible, or there will be
-		// many useless registers and instructions emitted.
+			// Note that mutable arrays will be compiled to
+			// registers by GPU driver, so we should make array
+			// length as small as possible, or there will be
+			// many useless registers and instructions emitted.
 
-		// Define vgpr array.
-		arrayInfo.arrayLength      = 1;
-		arrayInfo.arrayLengthId    = m_module.lateConst32(getScalarTypeId(GcnScalarType::Uint32));
-		const uint32_t arrayTypeId = m_module.defArrayType(typeId, arrayInfo.arrayLengthId);
-		const uint32_t ptrTypeId   = m_module.defPointerType(
-			  arrayTypeId, spv::StorageClassPrivate);
+			// Define vgpr array.
+			arrayInfo.arrayLength      = 1;
+			arrayInfo.arrayLengthId    = m_module.lateConst32(getScalarTypeId(GcnScalarType::Uint32));
+			const uint32_t arrayTypeId = m_module.defArrayType(typeId, arrayInfo.arrayLengthId);
+			const uint32_t ptrTypeId   = m_module.defPointerType(
+				  arrayTypeId, spv::StorageClassPrivate);
 
-		arrayInfo.arrayId = m_module.newVar(
-			ptrTypeId, spv::StorageClassPrivate);
-		m_module.setDebugName(arrayInfo.arrayId, name.c_str());
+			arrayInfo.arrayId = m_module.newVar(
+				ptrTypeId, spv::StorageClassPrivate);
+			m_module.setDebugName(arrayInfo.arrayId, name.c_str());
+		}
 	}
 
 	void GcnCompiler::emitDclInput(uint32_t             regIdx,
@@ -972,8 +983,14 @@ namespace sce::gcn
 
 	void GcnCompiler::emitInputSetup()
 	{
-		m_module.setLateConst(m_vArray.arrayLengthId, &m_vArray.arrayLength);
-		m_module.setLateConst(m_sArray.arrayLengthId, &m_sArray.arrayLength);
+		if (!m_vArray.promoted)
+		{
+			m_module.setLateConst(m_vArray.arrayLengthId, &m_vArray.arrayLength);
+		}
+		if (!m_sArray.promoted)
+		{
+			m_module.setLateConst(m_sArray.arrayLengthId, &m_sArray.arrayLength);
+		}
 
 		emitInitStateRegister();
 
@@ -1599,9 +1616,6 @@ namespace sce::gcn
 			arrayPtr = &m_sArray;
 		}
 
-		uint32_t arrayId      = arrayPtr->arrayId;
-		arrayPtr->arrayLength = std::max(arrayPtr->arrayLength, reg.code + 1);
-
 		GcnRegisterPointer result;
 		result.type.ctype  = GcnScalarType::Float32;
 		result.type.ccount = 1;
@@ -1612,10 +1626,33 @@ namespace sce::gcn
 		info.type.alength = 0;
 		info.sclass       = spv::StorageClassPrivate;
 
-		uint32_t indexId = m_module.constu32(reg.code);
-		result.id        = m_module.opAccessChain(
-				   getPointerTypeId(info), arrayId,
-				   1, &indexId);
+		if (arrayPtr->promoted)
+		{
+			auto& registerIds = arrayPtr->registerIds;
+			if (reg.code >= registerIds.size())
+			{
+				registerIds.resize(reg.code + 1, 0);
+			}
+
+			if (registerIds[reg.code] == 0)
+			{
+				registerIds[reg.code] = emitNewVariable(info);
+				m_module.setDebugName(registerIds[reg.code],
+									  util::str::formatex(IsVgpr ? "v" : "s", reg.code).c_str());
+			}
+
+			result.id = registerIds[reg.code];
+		}
+		else
+		{
+			uint32_t arrayId      = arrayPtr->arrayId;
+			arrayPtr->arrayLength = std::max(arrayPtr->arrayLength, reg.code + 1);
+
+			uint32_t indexId = m_module.constu32(reg.code);
+			result.id        = m_module.opAccessChain(
+					   getPointerTypeId(info), arrayId,
+					   1, &indexId);
+		}
 
 		return result;
 	}
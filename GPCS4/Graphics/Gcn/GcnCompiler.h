@@ -228,7 +228,8 @@ namespace sce::gcn
 		void emitDclGprArray();
 		void emitDclGprArray(
 			GcnGprArray&       arrayInfo,
-			const std::string& name);
+			const std::string& name,
+			bool               promote);
 		void emitDclInput(
 			uint32_t             regIdx,
 			GcnInterpolationMode im);
@@ -679,7 +680,8 @@ namespace sce::gcn
 		///////////////////////////////////////////////////
 		// SGPR/VGRP container
 		// Some instructions use dynamic index,
-		// so we need to declare gprs in array.
+		// so we need to declare gprs in array,
+		// otherwise each gpr is a separate variable.
 		GcnGprArray m_sArray;
 		GcnGprArray m_vArray;
 
@@ -281,6 +281,11 @@ namespace sce::gcn
 		uint32_t    arrayId       = 0;
 		uint32_t    arrayLengthId = 0;
 		uint32_t    arrayLength   = 0;
+
+		// Registers are declared as separate variables,
+		// indexed by register number, 0 if not declared yet.
+		bool                  promoted = false;
+		std::vector<uint32_t> registerIds;
 	};
 	
 
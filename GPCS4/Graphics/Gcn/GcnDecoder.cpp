@@ -1076,7 +1076,7 @@ namespace sce::gcn
 
 	///////////////////////////////////////////////////////////////
 
-	inline void gcnInstCastToSOP1(const GcnShaderInstruction& ins, GcnShaderInstSOP1& result)
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstSOP1& result)
 	{
 		result.opcode  = ins.opcode;
 		result.length  = ins.length;
@@ -1086,7 +1086,7 @@ namespace sce::gcn
 		result.sdst  = ins.dst[0];
 	}
 
-	inline void gcnInstCastToSOP2(const GcnShaderInstruction& ins, GcnShaderInstSOP2& result)
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstSOP2& result)
 	{
 		result.opcode  = ins.opcode;
 		result.length  = ins.length;
@@ -1097,7 +1097,7 @@ namespace sce::gcn
 		result.sdst  = ins.dst[0];
 	}
 
-	inline void gcnInstCastToSOPK(const GcnShaderInstruction& ins, GcnShaderInstSOPK& result)
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstSOPK& result)
 	{
 		result.opcode  = ins.opcode;
 		result.length  = ins.length;
@@ -1107,7 +1107,7 @@ namespace sce::gcn
 		result.sdst    = ins.dst[0];
 	}
 
-	inline void gcnInstCastToSOPC(const GcnShaderInstruction& ins, GcnShaderInstSOPC& result)
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstSOPC& result)
 	{
 		result.opcode  = ins.opcode;
 		result.length  = ins.length;
@@ -1117,7 +1117,7 @@ namespace sce::gcn
 		result.ssrc1 = ins.src[1];
 	}
 
-	inline void gcnInstCastToSOPP(const GcnShaderInstruction& ins, GcnShaderInstSOPP& result)
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstSOPP& result)
 	{
 		result.opcode  = ins.opcode;
 		result.length  = ins.length;
@@ -1126,7 +1126,7 @@ namespace sce::gcn
 		result.control = ins.control.sopp;
 	}
 
-	inline void gcnInstCastToVOP1(const GcnShaderInstruction& ins, GcnShaderInstVOP1& result)
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstVOP1& result)
 	{
 		result.opcode  = ins.opcode;
 		result.length  = ins.length;
@@ -1136,7 +1136,7 @@ namespace sce::gcn
 		result.vdst = ins.dst[0];
 	}
 
-	inline void gcnInstCastToVOP2(const GcnShaderInstruction& ins, GcnShaderInstVOP2& result)
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstVOP2& result)
 	{
 		result.opcode  = ins.opcode;
 		result.length  = ins.length;
@@ -1147,7 +1147,7 @@ namespace sce::gcn
 		result.vdst  = ins.dst[0];
 	}
 
-	inline void gcnInstCastToVOP3(const GcnShaderInstruction& ins, GcnShaderInstVOP3& result)
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstVOP3& result)
 	{
 		result.opcode  = ins.opcode;
 		result.length  = ins.length;
@@ -1161,7 +1161,7 @@ namespace sce::gcn
 		result.sdst    = ins.dst[1];
 	}
 
-	inline void gcnInstCastToVOPC(const GcnShaderInstruction& ins, GcnShaderInstVOPC& result)
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstVOPC& result)
 	{
 		result.opcode  = ins.opcode;
 		result.length  = ins.length;
@@ -1171,7 +1171,7 @@ namespace sce::gcn
 		result.vsrc1 = ins.src[1];
 	}
 
-	inline void gcnInstCastToSMRD(const GcnShaderInstruction& ins, GcnShaderInstSMRD& result)
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstSMRD& result)
 	{
 		result.opcode  = ins.opcode;
 		result.length  = ins.length;
@@ -1187,7 +1187,7 @@ namespace sce::gcn
 		}
 	}
 
-	inline void gcnInstCastToMUBUF(const GcnShaderInstruction& ins, GcnShaderInstMUBUF& result)
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstMUBUF& result)
 	{
 		result.opcode  = ins.opcode;
 		result.length  = ins.length;
@@ -1200,7 +1200,7 @@ namespace sce::gcn
 		result.soffset = ins.src[3];
 	}
 
-	inline void gcnInstCastToMTBUF(const GcnShaderInstruction& ins, GcnShaderInstMTBUF& result)
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstMTBUF& result)
 	{
 		result.opcode  = ins.opcode;
 		result.length  = ins.length;
@@ -1213,7 +1213,7 @@ namespace sce::gcn
 		result.soffset = ins.src[3];
 	}
 
-	inline void gcnInstCastToMIMG(const GcnShaderInstruction& ins, GcnShaderInstMIMG& result)
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstMIMG& result)
 	{
 		result.opcode  = ins.opcode;
 		result.length  = ins.length;
@@ -1226,7 +1226,7 @@ namespace sce::gcn
 		result.ssamp   = ins.src[3];
 	}
 
-	inline void gcnInstCastToVINTRP(const GcnShaderInstruction& ins, GcnShaderInstVINTRP& result)
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstVINTRP& result)
 	{
 		result.opcode  = ins.opcode;
 		result.length  = ins.length;
@@ -1237,7 +1237,7 @@ namespace sce::gcn
 		result.vdst    = ins.dst[0];
 	}
 
-	inline void gcnInstCastToDS(const GcnShaderInstruction& ins, GcnShaderInstDS& result)
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstDS& result)
 	{
 		result.opcode  = ins.opcode;
 		result.length  = ins.length;
@@ -1250,7 +1250,7 @@ namespace sce::gcn
 		result.vdst    = ins.dst[0];
 	}
 
-	inline void gcnInstCastToEXP(const GcnShaderInstruction& ins, GcnShaderInstEXP& result)
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstEXP& result)
 	{
 		result.opcode  = ins.opcode;
 		result.length  = ins.length;
@@ -1289,77 +1289,4 @@ namespace sce::gcn
 		}
 	}
 
-	GcnInstructionVariant gcnInstructionConvert(const GcnShaderInstruction& ins)
-	{
-		GcnInstructionVariant result = {};
-		switch (ins.encoding)
-		{
-			case GcnInstEncoding::SOP1:
-				result = GcnShaderInstSOP1();
-				gcnInstCastToSOP1(ins, std::get<GcnShaderInstSOP1>(result));
-				break;
-			case GcnInstEncoding::SOPP:
-				result = GcnShaderInstSOPP();
-				gcnInstCastToSOPP(ins, std::get<GcnShaderInstSOPP>(result));
-				break;
-			case GcnInstEncoding::SOPC:
-				result = GcnShaderInstSOPC();
-				gcnInstCastToSOPC(ins, std::get<GcnShaderInstSOPC>(result));
-				break;
-			case GcnInstEncoding::VOP1:
-				result = GcnShaderInstVOP1();
-				gcnInstCastToVOP1(ins, std::get<GcnShaderInstVOP1>(result));
-				break;
-			case GcnInstEncoding::VOPC:
-				result = GcnShaderInstVOPC();
-				gcnInstCastToVOPC(ins, std::get<GcnShaderInstVOPC>(result));
-				break;
-			case GcnInstEncoding::VOP3:
-				result = GcnShaderInstVOP3();
-				gcnInstCastToVOP3(ins, std::get<GcnShaderInstVOP3>(result));
-				break;
-			case GcnInstEncoding::EXP:
-				result = GcnShaderInstEXP();
-				gcnInstCastToEXP(ins, std::get<GcnShaderInstEXP>(result));
-				break;
-			case GcnInstEncoding::VINTRP:
-				result = GcnShaderInstVINTRP();
-				gcnInstCastToVINTRP(ins, std::get<GcnShaderInstVINTRP>(result));
-				break;
-			case GcnInstEncoding::DS:
-				result = GcnShaderInstDS();
-				gcnInstCastToDS(ins, std::get<GcnShaderInstDS>(result));
-				break;
-			case GcnInstEncoding::MUBUF:
-				result = GcnShaderInstMUBUF();
-				gcnInstCastToMUBUF(ins, std::get<GcnShaderInstMUBUF>(result));
-				break;
-			case GcnInstEncoding::MTBUF:
-				result = GcnShaderInstMTBUF();
-				gcnInstCastToMTBUF(ins, std::get<GcnShaderInstMTBUF>(result));
-				break;
-			case GcnInstEncoding::MIMG:
-				result = GcnShaderInstMIMG();
-				gcnInstCastToMIMG(ins, std::get<GcnShaderInstMIMG>(result));
-				break;
-			case GcnInstEncoding::SMRD:
-				result = GcnShaderInstSMRD();
-				gcnInstCastToSMRD(ins, std::get<GcnShaderInstSMRD>(result));
-				break;
-			case GcnInstEncoding::SOPK:
-				result = GcnShaderInstSOPK();
-				gcnInstCastToSOPK(ins, std::get<GcnShaderInstSOPK>(result));
-				break;
-			case GcnInstEncoding::SOP2:
-				result = GcnShaderInstSOP2();
-				gcnInstCastToSOP2(ins, std::get<GcnShaderInstSOP2>(result));
-				break;
-			case GcnInstEncoding::VOP2:
-				result = GcnShaderInstVOP2();
-				gcnInstCastToVOP2(ins, std::get<GcnShaderInstVOP2>(result));
-				break;
-		}
-		return result;
-	}
-
 }  // namespace sce::gcn
@@ -108,33 +108,32 @@ namespace sce::gcn
 	 * \brief Convenient function to convert general instruction into specific encodings
 	 */
 
-	using GcnInstructionVariant =
-		std::variant<
-			GcnShaderInstSOP1,
-			GcnShaderInstSOP2,
-			GcnShaderInstSOPK,
-			GcnShaderInstSOPC,
-			GcnShaderInstSOPP,
-			GcnShaderInstVOP1,
-			GcnShaderInstVOP2,
-			GcnShaderInstVOP3,
-			GcnShaderInstVOPC,
-			GcnShaderInstSMRD,
-			GcnShaderInstMUBUF,
-			GcnShaderInstMTBUF,
-			GcnShaderInstMIMG,
-			GcnShaderInstVINTRP,
-			GcnShaderInstDS,
-			GcnShaderInstEXP>;
-
-	// Do not use this directly, use gcnInstructionAs
-	GcnInstructionVariant gcnInstructionConvert(const GcnShaderInstruction& ins);
-
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstSOP1& result);
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstSOP2& result);
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstSOPK& result);
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstSOPC& result);
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstSOPP& result);
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstVOP1& result);
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstVOP2& result);
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstVOP3& result);
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstVOPC& result);
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstSMRD& result);
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstMUBUF& result);
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstMTBUF& result);
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstMIMG& result);
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstVINTRP& result);
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstDS& result);
+	void gcnInstructionCast(const GcnShaderInstruction& ins, GcnShaderInstEXP& result);
+
+	// Only the requested encoding is built, the caller
+	// must make sure it matches the instruction.
 	template <typename InsType>
 	static inline const InsType gcnInstructionAs(
 		const GcnShaderInstruction& ins)
 	{
-		return std::get<InsType>(gcnInstructionConvert(ins));
+		InsType result = InsType();
+		gcnInstructionCast(ins, result);
+		return result;
 	}
 
 }  // namespace sce::gcn
@@ -40,6 +40,8 @@ namespace sce::gcn
 			// We take the reverse way, extract the original input semantics from these instructions.
 
 			const auto& ins = decoder.getInstruction();
+			m_codeSize += ins.length;
+
 			if (ins.opcode == GcnOpcode::S_SETPC_B64)
 			{
 				break;
@@ -19,11 +19,22 @@ namespace sce::gcn
 			return m_vsInputSemanticTable;
 		}
 
+		/**
+		 * \brief Fetch shader code size in bytes
+		 *
+		 * Includes the final s_setpc_b64.
+		 */
+		size_t size() const
+		{
+			return m_codeSize;
+		}
+
 	private:
 		void parseVsInputSemantic(const uint8_t* code);
 
 	private:
 		VertexInputSemanticTable m_vsInputSemanticTable;
+		size_t                   m_codeSize = 0;
 	};
 
 
@@ -1,6 +1,6 @@
 #include "GcnHeader.h"
 #include "GcnConstants.h"
-#include "GcnDecoder.h"
+#include "GcnInstructionList.h"
 #include "Gnm/GnmConstant.h"
 
 LOG_CHANNEL(Graphic.Gcn.GcnHeader);
@@ -12,7 +12,6 @@ namespace sce::gcn
 	GcnHeader::GcnHeader(const uint8_t* shaderCode)
 	{
 		parseHeader(shaderCode);
-		extractResourceTable(shaderCode);
 	}
 
 	GcnHeader::~GcnHeader()
@@ -34,6 +33,8 @@ namespace sce::gcn
 		const ShaderBinaryInfo* binaryInfo = reinterpret_cast<const ShaderBinaryInfo*>(token + (token[1] + 1) * 2);
 		std::memcpy(&m_binInfo, binaryInfo, sizeof(ShaderBinaryInfo));
 
+		m_binarySize = (token[1] + 1) * 2 * sizeof(uint32_t) + sizeof(ShaderBinaryInfo);
+
 		// Get usage masks and input usage slots
 		uint32_t const*       usageMasks           = reinterpret_cast<uint32_t const*>((uint8_t const*)binaryInfo - binaryInfo->m_chunkUsageBaseOffsetInDW * 4);
 		int32_t               inputUsageSlotsCount = binaryInfo->m_numInputUsageSlots;
@@ -46,7 +47,8 @@ namespace sce::gcn
 		}
 	}
 
-	void GcnHeader::extractResourceTable(const uint8_t* code)
+	void GcnHeader::extractResourceTable(
+		const GcnInstructionList& instructions)
 	{
 		// We can't distinguish some of the resource type without iterate
 		// through all shader instructions.
@@ -54,7 +56,7 @@ namespace sce::gcn
 		// may be either a sampled image or a storage image.
 		// If it is accessed via an IMAGE_LOAD_XXX instruction,
 		// then we can say it is a storage image.
-		auto typeInfo = analyzeResourceType(code);
+		auto typeInfo = analyzeResourceType(instructions);
 
 		m_resourceTable.reserve(m_inputUsageSlotTable.size());
 
@@ -126,25 +128,17 @@ namespace sce::gcn
 		}
 	}
 
-	GcnHeader::ResourceTypeInfo GcnHeader::analyzeResourceType(const uint8_t* code)
+	GcnHeader::ResourceTypeInfo GcnHeader::analyzeResourceType(
+		const GcnInstructionList& instructions)
 	{
-		const uint32_t* start = reinterpret_cast<const uint32_t*>(code);
-		const uint32_t* end   = reinterpret_cast<const uint32_t*>(code + m_binInfo.m_length);
-		GcnCodeSlice    slice(start, end);
-
-		GcnDecodeContext decoder;
-
 		GcnHeader::ResourceTypeInfo result;
 
-		while (!slice.atEnd())
+		for (const auto& ins : instructions)
 		{
-			decoder.decodeInstruction(slice);
-
-			auto& ins = decoder.getInstruction();
-
-			if (ins.opcode >= GcnOpcode::IMAGE_LOAD &&
-				ins.opcode <= GcnOpcode::IMAGE_ATOMIC_FMAX &&
-				ins.opcode != GcnOpcode::IMAGE_GET_RESINFO)
+			auto opcode = ins.opcode;
+			if (opcode >= GcnOpcode::IMAGE_LOAD &&
+				opcode <= GcnOpcode::IMAGE_ATOMIC_FMAX &&
+				opcode != GcnOpcode::IMAGE_GET_RESINFO)
 			{
 				uint32_t startRegister = ins.src[2].code << 2;
 				result.m_storageImages.insert(startRegister);
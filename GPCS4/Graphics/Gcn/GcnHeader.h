@@ -9,6 +9,8 @@
 
 namespace sce::gcn
 {
+	class GcnInstructionList;
+
 	/**
 	 * \brief Represent a resource bound to a GCN shader
 	 */
@@ -54,6 +56,17 @@ namespace sce::gcn
 			const uint8_t* shaderCode);
 		~GcnHeader();
 
+		/**
+		 * \brief Builds the resource table
+		 *
+		 * Some resource types can only be told apart by
+		 * the instructions accessing them, so the table
+		 * is built from the decoded shader code.
+		 * \param [in] instructions Decoded shader code
+		 */
+		void extractResourceTable(
+			const GcnInstructionList& instructions);
+
 		/**
 		 * \brief Unique id of the shader
 		 */
@@ -71,6 +84,17 @@ namespace sce::gcn
 			return m_binInfo.m_length;
 		}
 
+		/**
+		 * \brief Shader binary size in bytes
+		 *
+		 * Covers the code, the input usage slots
+		 * and the binary info trailing the code.
+		 */
+		size_t binarySize() const
+		{
+			return m_binarySize;
+		}
+
 		const ShaderBinaryInfo& getShaderBinaryInfo() const
 		{
 			return m_binInfo;
@@ -90,13 +114,12 @@ namespace sce::gcn
 		void parseHeader(
 			const uint8_t* shaderCode);
 
-		void extractResourceTable(const uint8_t* code);
-
 		ResourceTypeInfo
-			analyzeResourceType(const uint8_t* code);
+			analyzeResourceType(const GcnInstructionList& instructions);
 
 	private:
-		ShaderBinaryInfo       m_binInfo = {};
+		ShaderBinaryInfo       m_binInfo    = {};
+		size_t                 m_binarySize = 0;
 		InputUsageSlotTable    m_inputUsageSlotTable;
 		GcnShaderResourceTable m_resourceTable;
 	};
@@ -0,0 +1,26 @@
+#include "GcnInstructionList.h"
+#include "GcnDecoder.h"
+
+namespace sce::gcn
+{
+	GcnInstructionList::GcnInstructionList()
+	{
+	}
+
+	GcnInstructionList::GcnInstructionList(GcnCodeSlice slice)
+	{
+		GcnDecodeContext decoder;
+
+		while (!slice.atEnd())
+		{
+			decoder.decodeInstruction(slice);
+
+			m_instructions.push_back(decoder.getInstruction());
+		}
+	}
+
+	GcnInstructionList::~GcnInstructionList()
+	{
+	}
+
+}  // namespace sce::gcn
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "GcnCommon.h"
+#include "GcnInstruction.h"
+
+#include <vector>
+
+namespace sce::gcn
+{
+	class GcnCodeSlice;
+
+	/**
+	 * \brief Decoded instruction list
+	 *
+	 * Holds every instruction of a shader, decoded once
+	 * so that the header, the analyzer, the compiler and
+	 * any later pass can iterate over it without running
+	 * the decoder again.
+	 */
+	class GcnInstructionList
+	{
+	public:
+		GcnInstructionList();
+		GcnInstructionList(GcnCodeSlice slice);
+		~GcnInstructionList();
+
+		/**
+		 * \brief Number of instructions
+		 */
+		size_t size() const
+		{
+			return m_instructions.size();
+		}
+
+		/**
+		 * \brief Full decoded instruction
+		 */
+		const GcnShaderInstruction& at(size_t index) const
+		{
+			return m_instructions[index];
+		}
+
+		std::vector<GcnShaderInstruction>::const_iterator begin() const
+		{
+			return m_instructions.begin();
+		}
+
+		std::vector<GcnShaderInstruction>::const_iterator end() const
+		{
+			return m_instructions.end();
+		}
+
+	private:
+		std::vector<GcnShaderInstruction> m_instructions;
+	};
+
+}  // namespace sce::gcn
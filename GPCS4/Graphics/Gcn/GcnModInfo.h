@@ -12,6 +12,11 @@ namespace sce::gcn
 		// subgroup size into consideration,
 		// and separate subgroups while compiling.
 		bool separateSubgroup;
+
+		// Declare each SGPR/VGPR as a separate variable
+		// instead of indexing into a register file array,
+		// if the register file is never dynamically indexed.
+		bool promoteGprs;
 	};
 
 
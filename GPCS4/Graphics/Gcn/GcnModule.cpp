@@ -4,6 +4,7 @@
 #include "GcnDecoder.h"
 
 #include "PlatFile.h"
+#include "UtilProfiler.h"
 #include "UtilString.h"
 
 
@@ -16,8 +17,12 @@ namespace sce::gcn
 		const uint8_t* code) :
 		m_programInfo(type),
 		m_header(code),
-		m_code(code)
+		m_code(code),
+		m_instructions(GcnCodeSlice(
+			reinterpret_cast<const uint32_t*>(code),
+			reinterpret_cast<const uint32_t*>(code + m_header.length())))
 	{
+		m_header.extractResourceTable(m_instructions);
 	}
 
 	GcnModule::~GcnModule()
@@ -27,9 +32,20 @@ namespace sce::gcn
 	Rc<VltShader> GcnModule::compile(
 		const GcnShaderMeta& meta) const
 	{
-		const uint32_t* start = reinterpret_cast<const uint32_t*>(m_code);
-		const uint32_t* end   = reinterpret_cast<const uint32_t*>(m_code + m_header.length());
-		GcnCodeSlice    codeSlice(start, end);
+		// TODO:
+		// Generate module info from device.
+		GcnModuleInfo moduleInfo;
+		moduleInfo.options.separateSubgroup = true;
+		moduleInfo.options.promoteGprs      = true;
+
+		return this->compile(meta, moduleInfo);
+	}
+
+	Rc<VltShader> GcnModule::compile(
+		const GcnShaderMeta& meta,
+		const GcnModuleInfo& moduleInfo) const
+	{
+		PROFILER_ZONE("Compile Shader", "Gcn");
 
 		//auto fileName = util::str::formatex(
 		//	"shaders/", 
@@ -47,18 +63,13 @@ namespace sce::gcn
 
 		//return nullptr;
 
-		// TODO:
-		// Generate module info from device.
-		GcnModuleInfo moduleInfo;
-		moduleInfo.options.separateSubgroup = true;
-
 		GcnAnalysisInfo analysisInfo;
 
 		GcnAnalyzer analyzer(
 			m_programInfo,
 			analysisInfo);
 
-		this->runInstructionIterator(&analyzer, codeSlice);
+		this->runInstructionIterator(&analyzer);
 
 		GcnCompiler compiler(
 			this->name(),
@@ -68,24 +79,23 @@ namespace sce::gcn
 			meta,
 			analysisInfo);
 
-		this->runInstructionIterator(&compiler, codeSlice);
+		this->runInstructionIterator(&compiler);
 
 		return compiler.finalize();
 	}
 
 
-	void GcnModule::runInstructionIterator(
-		GcnInstructionIterator* insIterator,
-		GcnCodeSlice            slice) const
+	void GcnModule::dump(std::ostream& outputStream) const
 	{
-		GcnDecodeContext decoder;
+		outputStream.write(reinterpret_cast<const char*>(m_code), m_header.binarySize());
+	}
 
-		while (!slice.atEnd())
+	void GcnModule::runInstructionIterator(
+		GcnInstructionIterator* insIterator) const
+	{
+		for (const auto& ins : m_instructions)
 		{
-			decoder.decodeInstruction(slice);
-
-			insIterator->processInstruction(
-				decoder.getInstruction());
+			insIterator->processInstruction(ins);
 		}
 	}
 
@@ -5,8 +5,11 @@
 #include "GcnProgramInfo.h"
 #include "GcnHeader.h"
 #include "GcnFetchShader.h"
+#include "GcnInstructionList.h"
+#include "GcnModInfo.h"
 #include "Violet/VltRc.h"
 
+#include <ostream>
 #include <vector>
 
 namespace sce::vlt
@@ -58,6 +61,14 @@ namespace sce::gcn
 		}
 
 
+		/**
+		 * \brief Decoded shader code
+		 */
+		const GcnInstructionList& instructions() const
+		{
+			return m_instructions;
+		}
+
 		/**
          * \brief Compiles GCN shader to SPIR-V module
          * 
@@ -66,18 +77,37 @@ namespace sce::gcn
 		vlt::Rc<vlt::VltShader> compile(
 			const GcnShaderMeta& meta) const;
 
+		/**
+		 * \brief Compiles GCN shader with given options
+		 *
+		 * \param [in] meta Shader meta information
+		 * \param [in] moduleInfo Compile options
+		 * \returns The compiled shader object
+		 */
+		vlt::Rc<vlt::VltShader> compile(
+			const GcnShaderMeta& meta,
+			const GcnModuleInfo& moduleInfo) const;
+
+		/**
+		 * \brief Dumps GCN shader binary
+		 *
+		 * Writes the shader code together with the
+		 * trailing binary info, so that the binary
+		 * can be reloaded and compiled offline.
+		 * \param [in] outputStream Stream to write to
+		 */
+		void dump(std::ostream& outputStream) const;
+
 	private:
 
 		void runInstructionIterator(
-			GcnInstructionIterator* insIterator,
-			GcnCodeSlice            slice) const;
+			GcnInstructionIterator* insIterator) const;
 
 	private:
 		GcnProgramInfo           m_programInfo;
 		GcnHeader                m_header;
 		const uint8_t*           m_code;
-		
-		GcnShaderResourceTable m_resourceTable;
+		GcnInstructionList       m_instructions;
 	};
 
 }  // namespace sce::gcn
\ No newline at end of file
@@ -0,0 +1,431 @@
+#include "GcnShaderBench.h"
+#include "GcnModule.h"
+#include "GcnShaderMeta.h"
+#include "GcnShaderMetaFile.h"
+
+#include "Violet/VltShader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+LOG_CHANNEL(Graphic.Gcn.GcnShaderBench);
+
+using namespace sce::vlt;
+
+namespace sce::gcn
+{
+	namespace
+	{
+		bool readShaderBinary(
+			const std::filesystem::path& path,
+			std::vector<uint32_t>&       code)
+		{
+			bool ret = false;
+			do
+			{
+				std::ifstream fin(path, std::ios::binary | std::ios::ate);
+				if (!fin)
+				{
+					break;
+				}
+
+				size_t size = fin.tellg();
+				if (size == 0 || size % sizeof(uint32_t) != 0)
+				{
+					break;
+				}
+
+				code.resize(size / sizeof(uint32_t));
+				fin.seekg(0);
+				fin.read(reinterpret_cast<char*>(code.data()), size);
+
+				ret = bool(fin);
+			} while (false);
+			return ret;
+		}
+
+		std::string programTypeName(GcnProgramType type)
+		{
+			return GcnProgramInfo(type).name();
+		}
+	}  // namespace
+
+	GcnShaderBench::GcnShaderBench(const GcnShaderBenchDesc& desc) :
+		m_desc(desc)
+	{
+		m_desc.threadCount = desc.threadCount != 0
+								 ? desc.threadCount
+								 : std::max(std::thread::hardware_concurrency(), 1u);
+		m_desc.repeatCount = std::max(desc.repeatCount, 1u);
+
+		// Same options as GcnModule::compile uses at runtime.
+		m_moduleInfo.options.separateSubgroup = true;
+		m_moduleInfo.options.promoteGprs      = true;
+	}
+
+	GcnShaderBench::~GcnShaderBench()
+	{
+	}
+
+	bool GcnShaderBench::run()
+	{
+		bool ret = false;
+		do
+		{
+			if (!collectShaders())
+			{
+				break;
+			}
+
+			std::printf("Compiling %zu shaders on %u threads, %u times each.\n",
+						m_shaders.size(), m_desc.threadCount, m_desc.repeatCount);
+
+			m_results.resize(m_shaders.size());
+			m_nextShader = 0;
+
+			auto begin = std::chrono::steady_clock::now();
+
+			std::vector<std::thread> workers;
+			workers.reserve(m_desc.threadCount);
+			for (uint32_t i = 0; i != m_desc.threadCount; ++i)
+			{
+				workers.emplace_back(&GcnShaderBench::compileWorker, this);
+			}
+
+			for (auto& worker : workers)
+			{
+				worker.join();
+			}
+
+			auto   end      = std::chrono::steady_clock::now();
+			double wallTime = std::chrono::duration<double, std::milli>(end - begin).count();
+
+			if (!m_desc.reportPath.empty() && !writeReport())
+			{
+				break;
+			}
+
+			printSummary(wallTime);
+
+			ret = std::all_of(m_results.begin(), m_results.end(),
+							  [](const ShaderResult& result)
+							  { return result.compiled && result.validated; });
+		} while (false);
+		return ret;
+	}
+
+	bool GcnShaderBench::collectShaders()
+	{
+		bool ret = false;
+		do
+		{
+			std::error_code ec;
+			if (!std::filesystem::is_directory(m_desc.corpusPath, ec))
+			{
+				std::printf("Shader corpus %s is not a directory.\n", m_desc.corpusPath.c_str());
+				break;
+			}
+
+			for (const auto& file : std::filesystem::directory_iterator(m_desc.corpusPath, ec))
+			{
+				const auto& path = file.path();
+				if (path.extension() != ".gcn")
+				{
+					continue;
+				}
+
+				ShaderEntry entry;
+				entry.name       = path.stem().string();
+				entry.binaryPath = path;
+				entry.metaPath   = std::filesystem::path(path).replace_extension(".meta");
+				m_shaders.push_back(std::move(entry));
+			}
+
+			if (m_shaders.empty())
+			{
+				std::printf("No .gcn shader found in %s.\n", m_desc.corpusPath.c_str());
+				break;
+			}
+
+			// Keep the report order independent of
+			// directory iteration and thread scheduling.
+			std::sort(m_shaders.begin(), m_shaders.end(),
+					  [](const ShaderEntry& a, const ShaderEntry& b)
+					  { return a.name < b.name; });
+
+			ret = true;
+		} while (false);
+		return ret;
+	}
+
+	void GcnShaderBench::compileWorker()
+	{
+		size_t index = m_nextShader.fetch_add(1);
+		while (index < m_shaders.size())
+		{
+			compileShader(m_shaders[index], m_results[index]);
+			index = m_nextShader.fetch_add(1);
+		}
+	}
+
+	void GcnShaderBench::compileShader(
+		const ShaderEntry& entry,
+		ShaderResult&      result)
+	{
+		result = ShaderResult();
+
+		do
+		{
+			std::vector<uint32_t> code;
+			if (!readShaderBinary(entry.binaryPath, code))
+			{
+				std::printf("%s: failed to read shader binary.\n", entry.name.c_str());
+				break;
+			}
+
+			GcnShaderMeta meta = {};
+			if (!readShaderMeta(entry.metaPath, &result.type, &meta))
+			{
+				std::printf("%s: missing or outdated meta sidecar.\n", entry.name.c_str());
+				break;
+			}
+
+			const uint8_t* codePtr = reinterpret_cast<const uint8_t*>(code.data());
+
+			// Time the same work the runtime does per shader bind,
+			// that is header parsing, analysis and compilation.
+			Rc<VltShader> shader;
+			for (uint32_t i = 0; i != m_desc.repeatCount; ++i)
+			{
+				auto begin = std::chrono::steady_clock::now();
+
+				GcnModule module(result.type, codePtr);
+				shader = module.compile(meta, m_moduleInfo);
+
+				result.gcnInstructionCount = module.instructions().size();
+
+				auto   end  = std::chrono::steady_clock::now();
+				double time = std::chrono::duration<double, std::micro>(end - begin).count();
+
+				result.compileTime = i == 0 ? time : std::min(result.compileTime, time);
+			}
+
+			std::vector<char> spirv = dumpSpirv(shader);
+
+			result.compiled  = true;
+			result.spirv     = countSpirv(spirv);
+			result.validated = !m_desc.validate || validateShader(entry, spirv);
+
+			if (m_desc.comparePromotion)
+			{
+				GcnModuleInfo baselineInfo        = m_moduleInfo;
+				baselineInfo.options.promoteGprs = false;
+
+				GcnModule module(result.type, codePtr);
+				result.baseline = countSpirv(dumpSpirv(module.compile(meta, baselineInfo)));
+			}
+		} while (false);
+	}
+
+	std::vector<char> GcnShaderBench::dumpSpirv(
+		const Rc<VltShader>& shader)
+	{
+		std::ostringstream spirvStream;
+		shader->dump(spirvStream);
+		std::string spirvString = spirvStream.str();
+		return std::vector<char>(spirvString.begin(), spirvString.end());
+	}
+
+	GcnShaderBench::SpirvStats GcnShaderBench::countSpirv(
+		const std::vector<char>& spirv)
+	{
+		constexpr size_t   SpirvHeaderSize = 5;
+		constexpr uint32_t OpLoad          = 61;
+		constexpr uint32_t OpStore         = 62;
+		constexpr uint32_t OpAccessChain   = 65;
+
+		const uint32_t* words     = reinterpret_cast<const uint32_t*>(spirv.data());
+		size_t          wordCount = spirv.size() / sizeof(uint32_t);
+
+		SpirvStats stats = {};
+		stats.size       = spirv.size();
+
+		size_t index = SpirvHeaderSize;
+		while (index < wordCount)
+		{
+			uint32_t length = words[index] >> 16;
+			uint32_t opcode = words[index] & 0xFFFF;
+			if (length == 0)
+			{
+				break;
+			}
+
+			if (opcode == OpLoad || opcode == OpStore || opcode == OpAccessChain)
+			{
+				++stats.memoryOpCount;
+			}
+
+			index += length;
+			++stats.instructionCount;
+		}
+		return stats;
+	}
+
+	bool GcnShaderBench::validateShader(
+		const ShaderEntry&       entry,
+		const std::vector<char>& spirv)
+	{
+		bool ret = false;
+		do
+		{
+			std::error_code ec;
+			auto            spvPath = std::filesystem::temp_directory_path(ec) / (entry.name + ".spv");
+
+			{
+				std::ofstream fout(spvPath, std::ios::binary);
+				fout.write(spirv.data(), spirv.size());
+				if (!fout)
+				{
+					std::printf("%s: failed to write %s.\n", entry.name.c_str(), spvPath.string().c_str());
+					break;
+				}
+			}
+
+			std::string command = "spirv-val --target-env vulkan1.3 \"" + spvPath.string() + "\"";
+			int         status  = std::system(command.c_str());
+
+			std::filesystem::remove(spvPath, ec);
+
+			if (status != 0)
+			{
+				std::printf("%s: spirv-val failed.\n", entry.name.c_str());
+				break;
+			}
+
+			ret = true;
+		} while (false);
+		return ret;
+	}
+
+	bool GcnShaderBench::writeReport()
+	{
+		bool ret = false;
+		do
+		{
+			std::ofstream fout(m_desc.reportPath);
+			if (!fout)
+			{
+				std::printf("Failed to open report %s.\n", m_desc.reportPath.c_str());
+				break;
+			}
+
+			fout << "name,type,status,gcn_instructions,spirv_bytes,spirv_instructions,spirv_memory_ops,compile_us";
+			if (m_desc.comparePromotion)
+			{
+				fout << ",baseline_spirv_bytes,baseline_spirv_instructions,baseline_spirv_memory_ops";
+			}
+			fout << "\n";
+
+			char line[256] = {};
+			for (size_t i = 0; i != m_shaders.size(); ++i)
+			{
+				const auto& result = m_results[i];
+				const char* status = !result.compiled
+										 ? "failed"
+										 : (result.validated ? "ok" : "invalid");
+
+				std::snprintf(line, sizeof(line), "%s,%s,%s,%zu,%zu,%zu,%zu,%.1f",
+							  m_shaders[i].name.c_str(),
+							  result.compiled ? programTypeName(result.type).c_str() : "",
+							  status,
+							  result.gcnInstructionCount,
+							  result.spirv.size,
+							  result.spirv.instructionCount,
+							  result.spirv.memoryOpCount,
+							  result.compileTime);
+				fout << line;
+
+				if (m_desc.comparePromotion)
+				{
+					std::snprintf(line, sizeof(line), ",%zu,%zu,%zu",
+								  result.baseline.size,
+								  result.baseline.instructionCount,
+								  result.baseline.memoryOpCount);
+					fout << line;
+				}
+				fout << "\n";
+			}
+
+			ret = true;
+		} while (false);
+		return ret;
+	}
+
+	void GcnShaderBench::printSummary(double wallTime)
+	{
+		size_t     compiled        = 0;
+		size_t     invalid         = 0;
+		size_t     gcnInstructions = 0;
+		SpirvStats spirv           = {};
+		SpirvStats baseline        = {};
+
+		std::vector<double> times;
+		times.reserve(m_results.size());
+
+		for (const auto& result : m_results)
+		{
+			if (!result.compiled)
+			{
+				continue;
+			}
+
+			++compiled;
+			invalid += result.validated ? 0 : 1;
+			gcnInstructions += result.gcnInstructionCount;
+			spirv.size += result.spirv.size;
+			spirv.instructionCount += result.spirv.instructionCount;
+			spirv.memoryOpCount += result.spirv.memoryOpCount;
+			baseline.size += result.baseline.size;
+			baseline.instructionCount += result.baseline.instructionCount;
+			baseline.memoryOpCount += result.baseline.memoryOpCount;
+			times.push_back(result.compileTime);
+		}
+
+		std::printf("Shaders           : %zu compiled, %zu failed, %zu invalid\n",
+					compiled, m_results.size() - compiled, invalid);
+		std::printf("GCN instructions  : %zu\n", gcnInstructions);
+		std::printf("SPIR-V            : %zu bytes, %zu instructions, %zu memory ops\n",
+					spirv.size, spirv.instructionCount, spirv.memoryOpCount);
+		if (m_desc.comparePromotion)
+		{
+			std::printf("SPIR-V unpromoted : %zu bytes, %zu instructions, %zu memory ops\n",
+						baseline.size, baseline.instructionCount, baseline.memoryOpCount);
+		}
+
+		if (!times.empty())
+		{
+			std::sort(times.begin(), times.end());
+
+			double total = 0.0;
+			for (double time : times)
+			{
+				total += time;
+			}
+
+			std::printf("Compile time (us) : total %.1f, avg %.1f, p50 %.1f, p95 %.1f, max %.1f\n",
+						total,
+						total / times.size(),
+						times[times.size() / 2],
+						times[times.size() * 95 / 100],
+						times.back());
+		}
+
+		std::printf("Wall time         : %.1f ms\n", wallTime);
+	}
+
+}  // namespace sce::gcn
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "GcnCommon.h"
+#include "GcnModInfo.h"
+#include "GcnProgramInfo.h"
+
+#include <atomic>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace sce::vlt
+{
+	class VltShader;
+}  // namespace sce::vlt
+
+namespace sce::gcn
+{
+	/**
+	 * \brief Shader benchmark description
+	 */
+	struct GcnShaderBenchDesc
+	{
+		// Directory containing dumped .gcn binaries
+		// and their .meta sidecars.
+		std::string corpusPath;
+		// CSV file for per-shader results, sorted by name
+		// so that reports of different runs can be diffed.
+		// Empty to print the summary only.
+		std::string reportPath;
+		// Worker threads, 0 to use all hardware threads.
+		uint32_t threadCount;
+		// Compile each shader N times and keep the
+		// fastest time, to filter out noise.
+		uint32_t repeatCount;
+		// Validate output with spirv-val from PATH.
+		bool validate;
+		// Also compile without GPR promotion and
+		// report instruction counts of both.
+		bool comparePromotion;
+	};
+
+	/**
+	 * \brief Offline shader compiler benchmark
+	 *
+	 * Compiles a corpus of dumped GCN shaders through the
+	 * same decoder, analyzer and compiler as the runtime,
+	 * without running a game, and reports compile time,
+	 * SPIR-V size and instruction counts.
+	 */
+	class GcnShaderBench
+	{
+		struct ShaderEntry
+		{
+			std::string           name;
+			std::filesystem::path binaryPath;
+			std::filesystem::path metaPath;
+		};
+
+		struct SpirvStats
+		{
+			size_t size;
+			size_t instructionCount;
+			// OpAccessChain, OpLoad and OpStore
+			size_t memoryOpCount;
+		};
+
+		struct ShaderResult
+		{
+			bool           compiled;
+			bool           validated;
+			GcnProgramType type;
+			double         compileTime;
+			size_t         gcnInstructionCount;
+			SpirvStats     spirv;
+			SpirvStats     baseline;
+		};
+
+	public:
+		GcnShaderBench(const GcnShaderBenchDesc& desc);
+		~GcnShaderBench();
+
+		/**
+		 * \brief Runs the benchmark
+		 * \returns \c true if all shaders compiled
+		 *          (and validated if requested)
+		 */
+		bool run();
+
+	private:
+		bool collectShaders();
+
+		void compileWorker();
+
+		void compileShader(
+			const ShaderEntry& entry,
+			ShaderResult&      result);
+
+		bool validateShader(
+			const ShaderEntry&       entry,
+			const std::vector<char>& spirv);
+
+		static std::vector<char> dumpSpirv(
+			const vlt::Rc<vlt::VltShader>& shader);
+
+		static SpirvStats countSpirv(
+			const std::vector<char>& spirv);
+
+		bool writeReport();
+
+		void printSummary(double wallTime);
+
+	private:
+		GcnShaderBenchDesc m_desc;
+		GcnModuleInfo      m_moduleInfo;
+
+		std::vector<ShaderEntry>  m_shaders;
+		std::vector<ShaderResult> m_results;
+		std::atomic<size_t>       m_nextShader = { 0 };
+	};
+
+}  // namespace sce::gcn
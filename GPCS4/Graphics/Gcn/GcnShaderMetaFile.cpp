@@ -0,0 +1,76 @@
+#include "GcnShaderMetaFile.h"
+#include "GcnShaderMeta.h"
+
+#include <fstream>
+
+namespace sce::gcn
+{
+	namespace
+	{
+		constexpr uint32_t MetaFileMagic   = 0x5445'4D47;  // 'GMET'
+		constexpr uint32_t MetaFileVersion = 1;
+
+		struct GcnShaderMetaFileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t programType;
+			uint32_t metaSize;
+		};
+	}  // namespace
+
+	void dumpShaderMeta(
+		std::ostream&        outputStream,
+		GcnProgramType       type,
+		const GcnShaderMeta& meta)
+	{
+		GcnShaderMetaFileHeader header;
+		header.magic       = MetaFileMagic;
+		header.version     = MetaFileVersion;
+		header.programType = static_cast<uint32_t>(type);
+		header.metaSize    = sizeof(GcnShaderMeta);
+
+		outputStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		outputStream.write(reinterpret_cast<const char*>(&meta), sizeof(GcnShaderMeta));
+	}
+
+	bool readShaderMeta(
+		const std::filesystem::path& path,
+		GcnProgramType*              type,
+		GcnShaderMeta*               meta)
+	{
+		bool ret = false;
+		do
+		{
+			std::ifstream fin(path, std::ios::binary);
+			if (!fin)
+			{
+				break;
+			}
+
+			GcnShaderMetaFileHeader header = {};
+			fin.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+			// The meta layout changes along with the compiler,
+			// sidecars from an older build must be dumped again.
+			if (!fin ||
+				header.magic != MetaFileMagic ||
+				header.version != MetaFileVersion ||
+				header.metaSize != sizeof(GcnShaderMeta))
+			{
+				break;
+			}
+
+			fin.read(reinterpret_cast<char*>(meta), sizeof(GcnShaderMeta));
+			if (!fin)
+			{
+				break;
+			}
+
+			*type = static_cast<GcnProgramType>(header.programType);
+			ret   = true;
+		} while (false);
+		return ret;
+	}
+
+}  // namespace sce::gcn
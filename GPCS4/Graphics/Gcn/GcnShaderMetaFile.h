@@ -0,0 +1,43 @@
+#pragma once
+
+#include "GcnCommon.h"
+#include "GcnProgramInfo.h"
+
+#include <filesystem>
+#include <ostream>
+
+namespace sce::gcn
+{
+	union GcnShaderMeta;
+
+	/**
+	 * \brief Writes shader meta sidecar
+	 *
+	 * The sidecar is stored next to a binary written
+	 * by \ref GcnModule::dump, it holds the runtime meta
+	 * information needed to compile the binary offline.
+	 * \param [in] outputStream Stream to write to
+	 * \param [in] type Program type of the shader
+	 * \param [in] meta Shader meta information
+	 */
+	void dumpShaderMeta(
+		std::ostream&        outputStream,
+		GcnProgramType       type,
+		const GcnShaderMeta& meta);
+
+	/**
+	 * \brief Reads shader meta sidecar
+	 *
+	 * Fails if the sidecar was written by a build
+	 * with a different meta layout.
+	 * \param [in] path Sidecar file
+	 * \param [out] type Program type of the shader
+	 * \param [out] meta Shader meta information
+	 * \returns \c true on success
+	 */
+	bool readShaderMeta(
+		const std::filesystem::path& path,
+		GcnProgramType*              type,
+		GcnShaderMeta*               meta);
+
+}  // namespace sce::gcn
@@ -5,8 +5,10 @@
 #include "GnmGpuLabel.h"
 #include "VirtualGPU.h"
 
+#include "Gcn/GcnShaderMetaFile.h"
 #include "Gcn/GcnShaderRegField.h"
 #include "Gcn/GcnUtil.h"
+#include "Sce/SceCapture.h"
 #include "Sce/SceGpuQueue.h"
 #include "Sce/SceResource.h"
 #include "Sce/SceResourceTracker.h"
@@ -43,6 +45,7 @@ namespace sce::Gnm
 	{
 		m_tracker      = &(GPU().resourceTracker());
 		m_labelManager = &(GPU().labelManager());
+		m_capture      = &(GPU().capture());
 	}
 
 	void GnmCommandBuffer::writeDataInline(void* dstGpuAddr, const void* data, uint32_t sizeInDwords, WriteDataConfirmMode writeConfirm)
@@ -110,6 +113,7 @@ namespace sce::Gnm
 		uint32_t                     shaderModifier)
 	{
 		ctx.code = computeData->getCodeAddress();
+		captureShader(ctx.code);
 
 		ctx.meta.cs.computeNumThreadX = computeData->computeNumThreadX;
 		ctx.meta.cs.computeNumThreadY = computeData->computeNumThreadY;
@@ -134,6 +138,7 @@ namespace sce::Gnm
 		VkPipelineStageFlags2 stage,
 		VkAccessFlagBits2     access)
 	{
+		m_capture->captureMemory(vsharp->getBaseAddress(), vsharp->getSize());
 
 		GnmBufferCreateInfo info;
 		info.vsharp = vsharp;
@@ -170,6 +175,8 @@ namespace sce::Gnm
 		VkImageTiling         tiling,
 		VkImageLayout         layout)
 	{
+		m_capture->captureMemory(tsharp->getBaseAddress(), tsharp->getSizeAlign().m_size);
+
 		SceTexture texture;
 
 		GnmImageCreateInfo info;
@@ -313,10 +320,37 @@ namespace sce::Gnm
 			VK_SHADER_STAGE_COMPUTE_BIT,
 			shader);
 
-//#ifdef SHADER_DUMP_FILE
-		std::ofstream fout(csModule.name(), std::ios::binary);
-		shader->dump(fout);
-//#endif
+#ifdef SHADER_DUMP_FILE
+		dumpShader(csModule, ctx.meta, shader);
+#endif
+	}
+
+	void GnmCommandBuffer::dumpShader(
+		const GcnModule&     module,
+		const GcnShaderMeta& meta,
+		const Rc<VltShader>& shader)
+	{
+		auto name = module.name();
+
+		std::ofstream spvOut(name, std::ios::binary);
+		shader->dump(spvOut);
+
+		std::ofstream gcnOut(name + ".gcn", std::ios::binary);
+		module.dump(gcnOut);
+
+		std::ofstream metaOut(name + ".meta", std::ios::binary);
+		dumpShaderMeta(metaOut, module.programInfo().type(), meta);
+	}
+
+	void GnmCommandBuffer::captureShader(
+		const void* code)
+	{
+		// Parsing the header is cheap, but not free.
+		if (m_capture->isRecording())
+		{
+			GcnHeader header(reinterpret_cast<const uint8_t*>(code));
+			m_capture->captureMemory(code, header.binarySize());
+		}
 	}
 
 	ShaderStage GnmCommandBuffer::getShaderStage(
@@ -14,11 +14,17 @@
 
 #include <memory>
 
+// Dump the recompiled shader to file
+// so that we can analyze it using spirv toolset.
+// The GCN binary and its meta sidecar are dumped as well,
+// they can be compiled offline using --shader-bench.
+// #define SHADER_DUMP_FILE
 
 namespace sce
 {
 	class SceResourceTracker;
 	class SceLabelManager;
+	class SceCapture;
 	enum class SceQueueType;
 
 	namespace vlt
@@ -26,7 +32,13 @@ namespace sce
 		class VltDevice;
 		class VltContext;
 		class VltCommandList;
+		class VltShader;
 	}  // namespace vlt
+
+	namespace gcn
+	{
+		class GcnModule;
+	}  // namespace gcn
 }  // namespace sce
 
 
@@ -469,6 +481,14 @@ namespace sce::Gnm
 		ShaderStage getShaderStage(
 			VkPipelineStageFlags pipeStage);
 
+		void dumpShader(
+			const gcn::GcnModule&          module,
+			const gcn::GcnShaderMeta&      meta,
+			const vlt::Rc<vlt::VltShader>& shader);
+
+		void captureShader(
+			const void* code);
+
 		SceBuffer getResourceBuffer(
 			const GnmBufferCreateInfo& info);
 
@@ -494,6 +514,7 @@ namespace sce::Gnm
 		
 		SceResourceTracker*             m_tracker      = nullptr;
 		SceLabelManager*                m_labelManager = nullptr;
+		SceCapture*                     m_capture      = nullptr;
 		std::unique_ptr<GnmInitializer> m_initializer;
 	private:
 	};
@@ -17,8 +17,9 @@ using namespace sce::gcn;
 namespace sce::Gnm
 {
 
-	GnmCommandBufferDispatch::GnmCommandBufferDispatch(vlt::VltDevice* device) :
-		GnmCommandBuffer(device)
+	GnmCommandBufferDispatch::GnmCommandBufferDispatch(vlt::VltDevice* device, uint32_t pipeId) :
+		GnmCommandBuffer(device),
+		m_pipeId(pipeId)
 	{
 		m_initializer = std::make_unique<GnmInitializer>(m_device, VltQueueType::Compute);
 		m_context     = m_device->createContext();
@@ -302,8 +303,11 @@ namespace sce::Gnm
 										  ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
 										  : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
 
+		// Each pipe has its own event id.
+		auto eventId = static_cast<EqEventType>(kEqEventCompute0RelMem + m_pipeId);
+
 		auto label = m_labelManager->getLabel(dstGpuAddr);
-		label->writeWithInterrupt(m_context.ptr(), stage, srcSelector, immValue);
+		label->writeWithInterrupt(m_context.ptr(), stage, srcSelector, immValue, eventId);
 	}
 
 	void GnmCommandBufferDispatch::writeReleaseMemEvent(ReleaseMemEventType eventType, EventWriteDest dstSelector, void* dstGpuAddr, EventWriteSource srcSelector, uint64_t immValue, CacheAction cacheAction, CachePolicy writePolicy)
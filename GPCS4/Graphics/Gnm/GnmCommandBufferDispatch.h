@@ -9,7 +9,7 @@ namespace sce::Gnm
 	class GnmCommandBufferDispatch : public GnmCommandBuffer
 	{
 	public:
-		GnmCommandBufferDispatch(vlt::VltDevice* device);
+		GnmCommandBufferDispatch(vlt::VltDevice* device, uint32_t pipeId);
 
 		virtual ~GnmCommandBufferDispatch();
 
@@ -140,6 +140,8 @@ namespace sce::Gnm
 
 	private:
 		GnmComputeState m_state = {};
+		// Compute pipe the commands are submitted to.
+		uint32_t m_pipeId;
 
 
 	};
@@ -10,10 +10,13 @@
 
 #include "Gcn/GcnUtil.h"
 #include "Platform/PlatFile.h"
+#include "Sce/SceCapture.h"
+#include "Sce/SceGnmDriver.h"
 #include "Sce/SceGpuQueue.h"
 #include "Sce/SceResourceTracker.h"
 #include "Sce/SceLabelManager.h"
 #include "Sce/SceVideoOut.h"
+#include "UtilProfiler.h"
 #include "Violet/VltContext.h"
 #include "Violet/VltDevice.h"
 #include "Violet/VltImage.h"
@@ -21,6 +24,7 @@
 
 #include <algorithm>
 #include <array>
+#include <cstring>
 #include <fstream>
 #include <functional>
 
@@ -39,10 +43,6 @@ namespace sce::Gnm
 		__debugbreak();                \
 	}
 
-// Dump the recompiled shader to file
-// so that we can analyze it using spirv toolset.
-// #define SHADER_DUMP_FILE
-
 
 	GnmCommandBufferDraw::GnmCommandBufferDraw(vlt::VltDevice* device) :
 		GnmCommandBuffer(device)
@@ -72,60 +72,30 @@ namespace sce::Gnm
 
 	void GnmCommandBufferDraw::setPrimitiveSetup(PrimitiveSetup reg)
 	{
-		VkFrontFace     frontFace = reg.getFrontFace() == kPrimitiveSetupFrontFaceCcw ? 
-			VK_FRONT_FACE_COUNTER_CLOCKWISE : VK_FRONT_FACE_CLOCKWISE;
-		VkPolygonMode   polyMode  = cvt::convertPolygonMode(reg.getPolygonModeFront());
-		VkCullModeFlags cullMode  = cvt::convertCullMode(reg.getCullFace());
-
-		VltRasterizerState rs = {
-			polyMode,
-			cullMode,
-			frontFace,
-			VK_FALSE,
-			VK_FALSE,
-			VK_SAMPLE_COUNT_1_BIT,
-			VK_CONSERVATIVE_RASTERIZATION_MODE_DISABLED_EXT
-		};
-
-		m_context->setRasterizerState(rs);
+		setContextRegister(m_state.regs.primitiveSetup, reg.m_reg,
+						   GnmContextFlag::GpDirtyRasterizerState);
 	}
 
 	void GnmCommandBufferDraw::setScreenScissor(int32_t left, int32_t top, int32_t right, int32_t bottom)
 	{
-		VkRect2D scissor;
-		scissor.offset.x      = left;
-		scissor.offset.y      = top;
-		scissor.extent.width  = right - left;
-		scissor.extent.height = bottom - top;
-		m_context->setScissors(1, &scissor);
+		auto scissor   = m_state.regs.screenScissor;
+		scissor.left   = left;
+		scissor.top    = top;
+		scissor.right  = right;
+		scissor.bottom = bottom;
+		setContextRegister(m_state.regs.screenScissor, scissor,
+						   GnmContextFlag::GpDirtyScissor);
 	}
 
 	void GnmCommandBufferDraw::setViewport(uint32_t viewportId, float dmin, float dmax, const float scale[3], const float offset[3])
 	{
-		// The viewport's origin in Gnm is in the lower left of the screen,
-		// with Y pointing up.
-		// In Vulkan the origin is in the top left of the screen,
-		// with Y pointing downwards.
-		// We need to flip the viewport of gnm to adapt to vulkan.
-		//
-		// Note, this is going to work with VK_KHR_Maintenance1 extension enabled,
-		// which is the default of Vulkan 1.1.
-		// And we must use dynamic viewport state (vkCmdSetViewport), or negative viewport height won't work.
-
-		float width  = scale[0] / 0.5f;
-		float height = -scale[1] / 0.5f;
-		float left   = offset[0] - scale[0];
-		float top    = offset[1] + scale[1];
-
-		VkViewport viewport;
-		viewport.x        = left;
-		viewport.y        = top + height;
-		viewport.width    = width;
-		viewport.height   = -height;
-		viewport.minDepth = dmin;
-		viewport.maxDepth = dmax;
-
-		m_context->setViewports(1, &viewport);
+		auto viewport = m_state.regs.viewport;
+		viewport.dmin = dmin;
+		viewport.dmax = dmax;
+		std::copy(scale, scale + 3, viewport.scale);
+		std::copy(offset, offset + 3, viewport.offset);
+		setContextRegister(m_state.regs.viewport, viewport,
+						   GnmContextFlag::GpDirtyViewport);
 	}
 
 	void GnmCommandBufferDraw::setHardwareScreenOffset(uint32_t offsetX, uint32_t offsetY)
@@ -158,6 +128,7 @@ namespace sce::Gnm
 	{
 		auto& ctx = m_state.shaderContext[kShaderStagePs];
 		ctx.code  = psRegs->getCodeAddress();
+		captureShader(ctx.code);
 
 		const SPI_SHADER_PGM_RSRC2_PS* rsrc2 = reinterpret_cast<const SPI_SHADER_PGM_RSRC2_PS*>(&psRegs->spiShaderPgmRsrc2Ps);
 		ctx.meta.ps.userSgprCount            = rsrc2->user_sgpr;
@@ -185,6 +156,7 @@ namespace sce::Gnm
 	{
 		auto& ctx = m_state.shaderContext[kShaderStageVs];
 		ctx.code  = vsRegs->getCodeAddress();
+		captureShader(ctx.code);
 
 		const SPI_SHADER_PGM_RSRC2_VS* rsrc2 = reinterpret_cast<const SPI_SHADER_PGM_RSRC2_VS*>(&vsRegs->spiShaderPgmRsrc2Vs);
 		ctx.meta.vs.userSgprCount = rsrc2->user_sgpr;
@@ -295,6 +267,8 @@ namespace sce::Gnm
 
 	void GnmCommandBufferDraw::setRenderTarget(uint32_t rtSlot, RenderTarget const* target)
 	{
+		m_capture->captureMemory(target->getBaseAddress(), target->getColorSizeAlign().m_size);
+
 		auto resource = m_tracker->find(target->getBaseAddress());
 		do
 		{
@@ -351,6 +325,8 @@ namespace sce::Gnm
 			auto zBufferAddr = depthTarget->getZReadAddress();
 			auto resource    = m_tracker->find(zBufferAddr);
 
+			m_capture->captureMemory(zBufferAddr, depthTarget->getZSizeAlign().m_size);
+
 			Rc<VltImageView> depthView = nullptr;
 			if (!resource)
 			{
@@ -406,117 +382,28 @@ namespace sce::Gnm
 
 	void GnmCommandBufferDraw::setRenderTargetMask(uint32_t mask)
 	{
-		auto writeMasks = cvt::convertRenderTargetMask(mask);
-		for (uint32_t attachment = 0; attachment != writeMasks.size(); ++attachment)
-		{
-			m_context->setBlendMask(
-				attachment, writeMasks[attachment]);
-		}
+		setContextRegister(m_state.regs.renderTargetMask, mask,
+						   GnmContextFlag::GpDirtyBlendState);
 	}
 
 	void GnmCommandBufferDraw::setBlendControl(uint32_t rtSlot, BlendControl blendControl)
 	{
-		VkBlendFactor colorSrcFactor = cvt::convertBlendMultiplier(blendControl.getColorEquationSourceMultiplier());
-		VkBlendFactor colorDstFactor = cvt::convertBlendMultiplier(blendControl.getColorEquationDestinationMultiplier());
-		VkBlendOp     colorBlendOp   = cvt::convertBlendFunc(blendControl.getColorEquationBlendFunction());
-
-		VkBlendFactor alphaSrcFactor = cvt::convertBlendMultiplier(blendControl.getAlphaEquationSourceMultiplier());
-		VkBlendFactor alphaDstFactor = cvt::convertBlendMultiplier(blendControl.getAlphaEquationDestinationMultiplier());
-		VkBlendOp     alphaBlendOp   = cvt::convertBlendFunc(blendControl.getAlphaEquationBlendFunction());
-
-		VkColorComponentFlags fullMask = 
-			VK_COLOR_COMPONENT_R_BIT | 
-			VK_COLOR_COMPONENT_G_BIT | 
-			VK_COLOR_COMPONENT_B_BIT | 
-			VK_COLOR_COMPONENT_A_BIT;  
-
-		// Here we set color write mask to fullMask.
-		// The real mask value should be set through setRenderTargetMask call.
-
-		VltBlendMode blend = {
-			(VkBool32)blendControl.getBlendEnable(),
-			colorSrcFactor,
-			colorDstFactor,
-			colorBlendOp,
-			alphaSrcFactor,
-			alphaDstFactor,
-			alphaBlendOp,
-			fullMask
-		};
-
-		m_context->setBlendMode(rtSlot, blend);
-
-		VltLogicOpState loState;
-		loState.enableLogicOp = VK_FALSE;
-		loState.logicOp       = VK_LOGIC_OP_NO_OP;
-
-		m_context->setLogicOpState(loState);
+		setContextRegister(m_state.regs.blendControl[rtSlot], blendControl.m_reg,
+						   GnmContextFlag::GpDirtyBlendState);
 	}
 
 	void GnmCommandBufferDraw::setDepthStencilControl(DepthStencilControl depthControl)
 	{
 		LOG_ASSERT(depthControl.stencilEnable == false, "stencil test not supported yet.");
 
-		VkCompareOp depthCmpOp = cvt::convertCompareFunc(depthControl.getDepthControlZCompareFunction());
-		VkCompareOp stencilFront = cvt::convertCompareFunc(depthControl.getStencilFunction());
-		VkCompareOp stencilBack = cvt::convertCompareFunc(depthControl.getStencilFunctionBack());
-
-		VkStencilOpState frontOp = {};
-		frontOp.compareOp        = stencilFront;
-		VkStencilOpState backOp  = {};
-		backOp.compareOp         = stencilBack;
-
-		VltDepthStencilState ds = {
-			(VkBool32)depthControl.depthEnable,
-			(VkBool32)depthControl.zWrite,
-			(VkBool32)depthControl.stencilEnable,
-			depthCmpOp,
-			frontOp,
-			backOp
-		};
-
-		// We use depth bounds test to emulate DbRenderControl
-		m_context->setDepthBoundsTestEnable(m_state.ds.dbClearDepth
-												? VK_TRUE
-												: depthControl.depthBoundsEnable);
-
-		m_context->setDepthStencilState(ds);
+		setContextRegister(m_state.regs.depthStencilControl, depthControl.m_reg,
+						   GnmContextFlag::GpDirtyDepthStencilState);
 	}
 
 	void GnmCommandBufferDraw::setDbRenderControl(DbRenderControl reg)
 	{
-		bool depthClear    = reg.getDepthClearEnable();
-		bool htielCompress = reg.getHtileResummarizeEnable();
-		if (depthClear && !htielCompress)
-		{
-			// In Gnm, when depth clear enable and HTILE compress disable
-			// all writes to the depth buffer will use the depth clear value set by
-			// DrawCommandBuffer::setDepthClearValue() instead of the fragment's depth value.
-			// 
-			// For vulkan, we use depth bound test to emulate this somehow.
-			// We first set the depth clear value to clear depth buffer once render pass begin.
-			// Then force depth bound test failed to leave depth buffer untouched.
-			// This way the depth buffer remains the clear value.
-
-			// TODO:
-			// This approach is not accurate, fix it in the future.
-
-			m_context->setDepthBoundsTestEnable(VK_TRUE);
-
-			VltDepthBoundsRange depthBounds;
-			depthBounds.minDepthBounds    = 1.0;
-			depthBounds.maxDepthBounds    = 0.0;
-			m_context->setDepthBoundsRange(depthBounds);
-
-			m_state.ds.dbClearDepth = true;
-		}
-		else
-		{
-			m_context->setDepthBoundsTestEnable(VK_FALSE);
-			m_state.ds.dbClearDepth = false;
-		}
-
-		
+		setContextRegister(m_state.regs.dbRenderControl, reg.m_reg,
+						   GnmContextFlag::GpDirtyDepthStencilState);
 	}
 
 	void GnmCommandBufferDraw::setVgtControl(uint8_t primGroupSizeMinusOne)
@@ -537,14 +424,12 @@ namespace sce::Gnm
 		}
 
 		LOG_ASSERT(topology != VK_PRIMITIVE_TOPOLOGY_MAX_ENUM, "primType not supported.");
+		// Auto index generation needs the topology
+		// before the state is converted.
 		m_state.ia.topology = topology;
 
-		VltInputAssemblyState ia = {
-			topology,
-			VK_FALSE,
-			0
-		};
-		m_context->setInputAssemblyState(ia);
+		setContextRegister(m_state.regs.primitiveType, static_cast<uint32_t>(primType),
+						   GnmContextFlag::GpDirtyInputAssemblyState);
 	}
 
 	void GnmCommandBufferDraw::setIndexSize(IndexSize indexSize, CachePolicy cachePolicy)
@@ -577,6 +462,8 @@ namespace sce::Gnm
 			sizeof(uint16_t) * indexCount : 
 			sizeof(uint32_t) * indexCount;
 
+		m_capture->captureMemory(indexAddr, indexBufferSize);
+
 		m_state.ia.indexBuffer = generateIndexBuffer(indexAddr, indexBufferSize);
 
 		commitGraphicsState();
@@ -629,7 +516,7 @@ namespace sce::Gnm
 										  : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
 
 		auto label = m_labelManager->getLabel(dstGpuAddr);
-		label->writeWithInterrupt(m_context.ptr(), stage, srcSelector, immValue);
+		label->writeWithInterrupt(m_context.ptr(), stage, srcSelector, immValue, kEqEventGfxEop);
 	}
 
 	void GnmCommandBufferDraw::writeAtEndOfShader(EndOfShaderEventType eventType, void* dstGpuAddr, uint32_t immValue)
@@ -663,8 +550,8 @@ namespace sce::Gnm
 
 	void GnmCommandBufferDraw::setDepthStencilDisable()
 	{
-		VltDepthStencilState ds = {};
-		m_context->setDepthStencilState(ds);
+		setContextRegister(m_state.regs.depthStencilControl, 0u,
+						   GnmContextFlag::GpDirtyDepthStencilState);
 	}
 
 	void GnmCommandBufferDraw::flushShaderCachesAndWait(CacheAction cacheAction, uint32_t extendedCacheMask, StallCommandBufferParserMode commandBufferStallMode)
@@ -706,6 +593,7 @@ namespace sce::Gnm
 
 	void GnmCommandBufferDraw::prepareFlip(void* labelAddr, uint32_t value)
 	{
+		m_capture->captureMemory(labelAddr, sizeof(uint32_t));
 		*(uint32_t*)labelAddr = value;
 		onPrepareFlip();
 	}
@@ -713,12 +601,15 @@ namespace sce::Gnm
 	void GnmCommandBufferDraw::prepareFlipWithEopInterrupt(EndOfPipeEventType eventType, CacheAction cacheAction)
 	{
 		onPrepareFlip();
+		GPU().gnmDriver().requestFlipInterrupt();
 	}
 
 	void GnmCommandBufferDraw::prepareFlipWithEopInterrupt(EndOfPipeEventType eventType, void* labelAddr, uint32_t value, CacheAction cacheAction)
 	{
+		m_capture->captureMemory(labelAddr, sizeof(uint32_t));
 		*(uint32_t*)labelAddr = value;
 		onPrepareFlip();
+		GPU().gnmDriver().requestFlipInterrupt();
 	}
 
 	void GnmCommandBufferDraw::setCsShader(const gcn::CsStageRegisters* computeData, uint32_t shaderModifier)
@@ -812,6 +703,8 @@ namespace sce::Gnm
 	inline void GnmCommandBufferDraw::bindVertexBuffer(
 		const Buffer* vsharp, uint32_t binding)
 	{
+		m_capture->captureMemory(vsharp->getBaseAddress(), vsharp->getSize());
+
 		GnmBufferCreateInfo info;
 		info.vsharp     = vsharp;
 		info.usage      = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
@@ -838,6 +731,8 @@ namespace sce::Gnm
 		{
 			GcnFetchShader fs(reinterpret_cast<const uint8_t*>(fsCode));
 			semaTable = fs.getVertexInputSemanticTable();
+
+			m_capture->captureMemory(fsCode, fs.size());
 		}
 
 		// Update input layout
@@ -847,6 +742,9 @@ namespace sce::Gnm
 			LOG_ASSERT(vertexTableReg >= 0, "vertex table not found while input semantic exist.");
 			const uint32_t* vertexTable = *reinterpret_cast<uint32_t* const*>(&ctx.userData[vertexTableReg]);
 
+			m_capture->captureMemory(vertexTable,
+									 semaTable.size() * ShaderConstantDwordSize::kDwordSizeVertexBuffer * sizeof(uint32_t));
+
 			bool singleBinding = isSingleVertexBinding(vertexTable, semaTable);
 
 			std::array<VltVertexAttribute, kMaxVertexBufferCount> attributes;
@@ -964,8 +862,7 @@ namespace sce::Gnm
 				shader);
 
 #ifdef SHADER_DUMP_FILE
-			std::ofstream fout(vsModule.name(), std::ios::binary);
-			shader->dump(fout);
+			dumpShader(vsModule, ctx.meta, shader);
 #endif
 
 		} while (false);
@@ -998,14 +895,274 @@ namespace sce::Gnm
 				shader);
 
 #ifdef SHADER_DUMP_FILE
-			std::ofstream fout(psModule.name(), std::ios::binary);
-			shader->dump(fout);
+			dumpShader(psModule, ctx.meta, shader);
 #endif
 		} while (false);
 	}
 
+	template <typename T>
+	void GnmCommandBufferDraw::setContextRegister(
+		T&             reg,
+		const T&       value,
+		GnmContextFlag group)
+	{
+		// Games tend to set the same state before every draw,
+		// which would otherwise dirty the Violet pipeline state.
+		++m_stats.registerSets;
+		if (!m_state.regs.valid.test(group) ||
+			std::memcmp(&reg, &value, sizeof(T)) != 0)
+		{
+			reg = value;
+			m_state.regs.valid.set(group);
+			m_flags.set(group);
+		}
+	}
+
+	void GnmCommandBufferDraw::flushContextState()
+	{
+		if (m_flags.test(GnmContextFlag::GpDirtyRasterizerState))
+		{
+			updateRasterizerState();
+		}
+
+		if (m_flags.any(GnmContextFlag::GpDirtyViewport,
+						GnmContextFlag::GpDirtyScissor))
+		{
+			updateViewportState();
+		}
+
+		if (m_flags.test(GnmContextFlag::GpDirtyBlendState))
+		{
+			updateBlendState();
+		}
+
+		if (m_flags.test(GnmContextFlag::GpDirtyDepthStencilState))
+		{
+			updateDepthStencilState();
+		}
+
+		if (m_flags.test(GnmContextFlag::GpDirtyInputAssemblyState))
+		{
+			updateInputAssemblyState();
+		}
+	}
+
+	void GnmCommandBufferDraw::updateRasterizerState()
+	{
+		m_flags.clr(GnmContextFlag::GpDirtyRasterizerState);
+		++m_stats.groupConversions;
+
+		PrimitiveSetup reg;
+		reg.m_reg = m_state.regs.primitiveSetup;
+
+		VkFrontFace     frontFace = reg.getFrontFace() == kPrimitiveSetupFrontFaceCcw ? 
+			VK_FRONT_FACE_COUNTER_CLOCKWISE : VK_FRONT_FACE_CLOCKWISE;
+		VkPolygonMode   polyMode  = cvt::convertPolygonMode(reg.getPolygonModeFront());
+		VkCullModeFlags cullMode  = cvt::convertCullMode(reg.getCullFace());
+
+		VltRasterizerState rs = {
+			polyMode,
+			cullMode,
+			frontFace,
+			VK_FALSE,
+			VK_FALSE,
+			VK_SAMPLE_COUNT_1_BIT,
+			VK_CONSERVATIVE_RASTERIZATION_MODE_DISABLED_EXT
+		};
+
+		m_context->setRasterizerState(rs);
+	}
+
+	void GnmCommandBufferDraw::updateViewportState()
+	{
+		m_flags.clr(GnmContextFlag::GpDirtyViewport,
+					GnmContextFlag::GpDirtyScissor);
+		++m_stats.groupConversions;
+
+		const auto& regs = m_state.regs;
+
+		if (regs.valid.test(GnmContextFlag::GpDirtyScissor))
+		{
+			VkRect2D scissor;
+			scissor.offset.x      = regs.screenScissor.left;
+			scissor.offset.y      = regs.screenScissor.top;
+			scissor.extent.width  = regs.screenScissor.right - regs.screenScissor.left;
+			scissor.extent.height = regs.screenScissor.bottom - regs.screenScissor.top;
+			m_context->setScissors(1, &scissor);
+		}
+
+		// Set after the scissor, because a viewport
+		// of zero width is replaced by an empty scissor.
+		if (regs.valid.test(GnmContextFlag::GpDirtyViewport))
+		{
+			// The viewport's origin in Gnm is in the lower left of the screen,
+			// with Y pointing up.
+			// In Vulkan the origin is in the top left of the screen,
+			// with Y pointing downwards.
+			// We need to flip the viewport of gnm to adapt to vulkan.
+			//
+			// Note, this is going to work with VK_KHR_Maintenance1 extension enabled,
+			// which is the default of Vulkan 1.1.
+			// And we must use dynamic viewport state (vkCmdSetViewport), or negative viewport height won't work.
+
+			const auto& scale  = regs.viewport.scale;
+			const auto& offset = regs.viewport.offset;
+
+			float width  = scale[0] / 0.5f;
+			float height = -scale[1] / 0.5f;
+			float left   = offset[0] - scale[0];
+			float top    = offset[1] + scale[1];
+
+			VkViewport viewport;
+			viewport.x        = left;
+			viewport.y        = top + height;
+			viewport.width    = width;
+			viewport.height   = -height;
+			viewport.minDepth = regs.viewport.dmin;
+			viewport.maxDepth = regs.viewport.dmax;
+
+			m_context->setViewports(1, &viewport);
+		}
+	}
+
+	void GnmCommandBufferDraw::updateBlendState()
+	{
+		m_flags.clr(GnmContextFlag::GpDirtyBlendState);
+		++m_stats.groupConversions;
+
+		const auto& regs = m_state.regs;
+
+		VkColorComponentFlags fullMask = 
+			VK_COLOR_COMPONENT_R_BIT | 
+			VK_COLOR_COMPONENT_G_BIT | 
+			VK_COLOR_COMPONENT_B_BIT | 
+			VK_COLOR_COMPONENT_A_BIT;  
+
+		// Slots never set hold the reset value, which disables blending.
+		for (uint32_t rtSlot = 0; rtSlot != regs.blendControl.size(); ++rtSlot)
+		{
+			BlendControl blendControl;
+			blendControl.m_reg = regs.blendControl[rtSlot];
+
+			VkBlendFactor colorSrcFactor = cvt::convertBlendMultiplier(blendControl.getColorEquationSourceMultiplier());
+			VkBlendFactor colorDstFactor = cvt::convertBlendMultiplier(blendControl.getColorEquationDestinationMultiplier());
+			VkBlendOp     colorBlendOp   = cvt::convertBlendFunc(blendControl.getColorEquationBlendFunction());
+
+			VkBlendFactor alphaSrcFactor = cvt::convertBlendMultiplier(blendControl.getAlphaEquationSourceMultiplier());
+			VkBlendFactor alphaDstFactor = cvt::convertBlendMultiplier(blendControl.getAlphaEquationDestinationMultiplier());
+			VkBlendOp     alphaBlendOp   = cvt::convertBlendFunc(blendControl.getAlphaEquationBlendFunction());
+
+			// Here we set color write mask to fullMask.
+			// The real mask value is set from the render target mask below.
+
+			VltBlendMode blend = {
+				(VkBool32)blendControl.getBlendEnable(),
+				colorSrcFactor,
+				colorDstFactor,
+				colorBlendOp,
+				alphaSrcFactor,
+				alphaDstFactor,
+				alphaBlendOp,
+				fullMask
+			};
+
+			m_context->setBlendMode(rtSlot, blend);
+		}
+
+		VltLogicOpState loState;
+		loState.enableLogicOp = VK_FALSE;
+		loState.logicOp       = VK_LOGIC_OP_NO_OP;
+
+		m_context->setLogicOpState(loState);
+
+		auto writeMasks = cvt::convertRenderTargetMask(regs.renderTargetMask);
+		for (uint32_t attachment = 0; attachment != writeMasks.size(); ++attachment)
+		{
+			m_context->setBlendMask(
+				attachment, writeMasks[attachment]);
+		}
+	}
+
+	void GnmCommandBufferDraw::updateDepthStencilState()
+	{
+		m_flags.clr(GnmContextFlag::GpDirtyDepthStencilState);
+		++m_stats.groupConversions;
+
+		const auto& regs = m_state.regs;
+
+		DbRenderControl dbRenderControl;
+		dbRenderControl.m_reg = regs.dbRenderControl;
+
+		bool depthClear    = dbRenderControl.getDepthClearEnable();
+		bool htielCompress = dbRenderControl.getHtileResummarizeEnable();
+
+		// In Gnm, when depth clear enable and HTILE compress disable
+		// all writes to the depth buffer will use the depth clear value set by
+		// DrawCommandBuffer::setDepthClearValue() instead of the fragment's depth value.
+		//
+		// For vulkan, we use depth bound test to emulate this somehow.
+		// We first set the depth clear value to clear depth buffer once render pass begin.
+		// Then force depth bound test failed to leave depth buffer untouched.
+		// This way the depth buffer remains the clear value.
+
+		// TODO:
+		// This approach is not accurate, fix it in the future.
+		m_state.ds.dbClearDepth = depthClear && !htielCompress;
+
+		// A zero register means depth stencil is disabled.
+		VltDepthStencilState ds = {};
+
+		DepthStencilControl depthControl;
+		depthControl.m_reg = regs.depthStencilControl;
+		if (depthControl.m_reg != 0)
+		{
+			VkCompareOp depthCmpOp   = cvt::convertCompareFunc(depthControl.getDepthControlZCompareFunction());
+			VkCompareOp stencilFront = cvt::convertCompareFunc(depthControl.getStencilFunction());
+			VkCompareOp stencilBack  = cvt::convertCompareFunc(depthControl.getStencilFunctionBack());
+
+			ds.enableDepthTest          = (VkBool32)depthControl.depthEnable;
+			ds.enableDepthWrite         = (VkBool32)depthControl.zWrite;
+			ds.enableStencilTest        = (VkBool32)depthControl.stencilEnable;
+			ds.depthCompareOp           = depthCmpOp;
+			ds.stencilOpFront.compareOp = stencilFront;
+			ds.stencilOpBack.compareOp  = stencilBack;
+		}
+
+		m_context->setDepthStencilState(ds);
+
+		if (m_state.ds.dbClearDepth)
+		{
+			m_context->setDepthBoundsTestEnable(VK_TRUE);
+
+			VltDepthBoundsRange depthBounds;
+			depthBounds.minDepthBounds = 1.0;
+			depthBounds.maxDepthBounds = 0.0;
+			m_context->setDepthBoundsRange(depthBounds);
+		}
+		else
+		{
+			// We use depth bounds test to emulate DbRenderControl
+			m_context->setDepthBoundsTestEnable(depthControl.depthBoundsEnable);
+		}
+	}
+
+	void GnmCommandBufferDraw::updateInputAssemblyState()
+	{
+		m_flags.clr(GnmContextFlag::GpDirtyInputAssemblyState);
+		++m_stats.groupConversions;
+
+		VltInputAssemblyState ia = {
+			m_state.ia.topology,
+			VK_FALSE,
+			0
+		};
+		m_context->setInputAssemblyState(ia);
+	}
+
 	void GnmCommandBufferDraw::commitGraphicsState()
 	{
+		flushContextState();
+
 		updateVertexShaderStage();
 
 		updatePixelShaderStage();
@@ -1050,6 +1207,14 @@ namespace sce::Gnm
 		// This is the last cmd for a command buffer submission,
 		// we can do some finish works before submit and present.
 
+		if (util::prof::isRecording())
+		{
+			util::prof::recordCounter("Context register sets", m_stats.registerSets);
+			util::prof::recordCounter("Context conversions saved",
+									  m_stats.registerSets - m_stats.groupConversions);
+		}
+
+		m_stats = {};
 	}
 
 	void GnmCommandBufferDraw::updateMetaTextureInfo(
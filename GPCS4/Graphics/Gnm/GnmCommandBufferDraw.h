@@ -157,6 +157,20 @@ namespace sce::Gnm
 		void updateVertexShaderStage();
 		void updatePixelShaderStage();
 
+		template <typename T>
+		void setContextRegister(
+			T&             reg,
+			const T&       value,
+			GnmContextFlag group);
+
+		void flushContextState();
+
+		void updateRasterizerState();
+		void updateViewportState();
+		void updateBlendState();
+		void updateDepthStencilState();
+		void updateInputAssemblyState();
+
 		void commitGraphicsState();
 		void commitComputeState();
 
@@ -176,6 +190,7 @@ namespace sce::Gnm
 	private:
 		GnmGraphicsState m_state;
 		GnmContextFlags  m_flags; 
+		GnmContextStats  m_stats;
 	};
 
 }  // namespace sce::Gnm
@@ -5,8 +5,13 @@
 #include "GnmSampler.h"
 #include "GnmTexture.h"
 #include "UtilBit.h"
+#include "UtilProfiler.h"
+#include "Emulator.h"
+#include "MemoryWriteWatch.h"
+#include "VirtualGPU.h"
 
 #include "Gcn/GcnShaderRegister.h"
+#include "Sce/SceCapture.h"
 #include "Violet/VltBuffer.h"
 
 using namespace util;
@@ -33,9 +38,15 @@ namespace sce::Gnm
 
 	const uint32_t c_stageBases[kShaderStageCount] = { 0x2E40, 0x2C0C, 0x2C4C, 0x2C8C, 0x2CCC, 0x2D0C, 0x2D4C };
 
+	// Trace of the command buffer being processed on this thread,
+	// a fault in a packet handler is raised on the same thread.
+	static thread_local const GnmPacketTrace* t_activeTrace = nullptr;
+
 	GnmCommandProcessor::GnmCommandProcessor() :
 		m_cb(nullptr)
 	{
+		static const bool crashCallbackAdded = logsys::addCrashCallback(&GnmCommandProcessor::onCrash);
+		(void)crashCallbackAdded;
 	}
 
 	GnmCommandProcessor::~GnmCommandProcessor()
@@ -52,6 +63,31 @@ namespace sce::Gnm
 		bool bRet = false;
 		do
 		{
+			// An entry is valid while no page of the buffer was written after
+			// the stamp it was decoded at. The stamp is taken before decoding,
+			// so writes racing with it, including by packets targeting the
+			// buffer itself, invalidate the entry as well.
+			uint64_t lastWrite = 0;
+			uint64_t now       = 0;
+			bool     watched   = MemoryWriteWatch::GetInstance()->sync(commandBuffer, commandSize, &lastWrite, &now);
+
+			auto iter = m_decodeCache.find(commandBuffer);
+			if (watched && iter != m_decodeCache.end() &&
+				iter->second.size == commandSize &&
+				lastWrite <= iter->second.stamp)
+			{
+				replayDecoded(commandBuffer, iter->second);
+				bRet = true;
+				break;
+			}
+
+			++m_decodeMissCount;
+
+			DecodedCommandBuffer decoded;
+			decoded.size   = commandSize;
+			decoded.stamp  = now;
+			bool cacheable = watched;
+
 			// Note:
 			// If something went unusual here, like you found many zero dwords or TYPE0 packets
 			// it's likely because there are some GnmDriver functions not implemented,
@@ -62,12 +98,15 @@ namespace sce::Gnm
 
 			while (processedCmdSize < commandSize)
 			{
+				m_trace.record(commandBuffer, processedCmdSize, pm4Hdr->u32All);
+
 				uint32_t pm4Type = pm4Hdr->type;
 
 				switch (pm4Type)
 				{
 				case PM4_TYPE_0:
 					processPM4Type0((PPM4_TYPE_0_HEADER)pm4Hdr, (uint32_t*)(pm4Hdr + 1));
+					cacheable = false;
 					break;
 				case PM4_TYPE_2:
 				{
@@ -78,10 +117,18 @@ namespace sce::Gnm
 				}
 					break;
 				case PM4_TYPE_3:
-					processPM4Type3((PPM4_TYPE_3_HEADER)pm4Hdr, (uint32_t*)(pm4Hdr + 1));
+				{
+					PacketHandler handler = processPM4Type3((PPM4_TYPE_3_HEADER)pm4Hdr, (uint32_t*)(pm4Hdr + 1));
+					if (handler)
+					{
+						decoded.packets.push_back({ handler, processedCmdSize });
+					}
+				}
 					break;
 				default:
 					LOG_ERR("Invalid pm4 type %d", pm4Type);
+					m_trace.dump(TraceDumpCount);
+					cacheable = false;
 					break;
 				}
 
@@ -105,6 +152,13 @@ namespace sce::Gnm
 				processedCmdSize += processedLength;
 			}
 
+			// Buffers with packets we can't process are not cached,
+			// so that the errors keep being reported.
+			if (cacheable)
+			{
+				insertDecoded(commandBuffer, std::move(decoded));
+			}
+
 			bRet = true;
 		} while (false);
 
@@ -113,219 +167,271 @@ namespace sce::Gnm
 
 	void GnmCommandProcessor::processCommandBuffer(const void* commandBuffer, uint32_t commandSize)
 	{
+		PROFILER_ZONE("Process Command Buffer", "Gnm");
+
+		// Entries may be in use while processing nested
+		// indirect buffers, only drop them out here.
+		if (m_decodeCacheSize > DecodeCacheBudget)
+		{
+			m_decodeCache.clear();
+			m_decodeCacheSize = 0;
+		}
+
+		t_activeTrace = &m_trace;
 		processCmdInternal(commandBuffer, commandSize);
+		t_activeTrace = nullptr;
 	}
 
-	void GnmCommandProcessor::processPM4Type0(PPM4_TYPE_0_HEADER pm4Hdr, uint32_t* regDataX)
+	void GnmCommandProcessor::dumpTrace() const
 	{
-		LOG_FIXME("Type 0 PM4 packet is not supported.");
+		m_trace.write(TraceDumpCount);
 	}
 
-	void GnmCommandProcessor::processPM4Type3(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody)
+	void GnmCommandProcessor::onCrash()
 	{
-		IT_OpCodeType opcode = (IT_OpCodeType)pm4Hdr->opcode;
+		if (t_activeTrace)
+		{
+			t_activeTrace->write(TraceDumpCount);
+		}
+	}
 
-		LOG_DEBUG("OpCode Name %s", opcodeName(*(uint32_t*)pm4Hdr));
+	void GnmCommandProcessor::replayDecoded(
+		const void*                 commandBuffer,
+		const DecodedCommandBuffer& decoded)
+	{
+		const uint8_t* base = reinterpret_cast<const uint8_t*>(commandBuffer);
+		for (const auto& packet : decoded.packets)
+		{
+			PPM4_TYPE_3_HEADER pm4Hdr = (PPM4_TYPE_3_HEADER)(base + packet.offset);
+			m_trace.record(commandBuffer, packet.offset, pm4Hdr->u32All);
 
-		switch (opcode)
+			(this->*packet.handler)(pm4Hdr, (uint32_t*)(pm4Hdr + 1));
+
+			// Packets consumed by a handler were left out when decoding.
+			m_skipPm4Count = 0;
+		}
+
+		// Decoding stops at the flip packet.
+		m_flipPacketDone = false;
+	}
+
+	void GnmCommandProcessor::insertDecoded(
+		const void*            commandBuffer,
+		DecodedCommandBuffer&& decoded)
+	{
+		auto& entry = m_decodeCache[commandBuffer];
+		m_decodeCacheSize -= entry.packets.size();
+		m_decodeCacheSize += decoded.packets.size();
+		entry = std::move(decoded);
+	}
+
+	void GnmCommandProcessor::processPM4Type0(PPM4_TYPE_0_HEADER pm4Hdr, uint32_t* regDataX)
+	{
+		LOG_FIXME("Type 0 PM4 packet is not supported.");
+	}
+
+	GnmCommandProcessor::PacketHandler GnmCommandProcessor::processPM4Type3(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody)
+	{
+		PacketHandler handler = s_opcodeTable[pm4Hdr->opcode];
+		if (pm4Hdr->opcode == IT_GNM_PRIVATE)
 		{
-		case IT_NOP:
-			onNop(pm4Hdr, itBody);
-			break;
-		case IT_SET_BASE:
-			onSetBase(pm4Hdr, itBody);
-			break;
-		case IT_INDEX_BUFFER_SIZE:
-			onIndexBufferSize(pm4Hdr, itBody);
-			break;
-		case IT_SET_PREDICATION:
-			onSetPredication(pm4Hdr, itBody);
-			break;
-		case IT_COND_EXEC:
-			onCondExec(pm4Hdr, itBody);
-			break;
-		case IT_INDEX_BASE:
-			onIndexBase(pm4Hdr, itBody);
-			break;
-		case IT_INDEX_TYPE:
-			onIndexType(pm4Hdr, itBody);
-			break;
-		case IT_NUM_INSTANCES:
-			onNumInstances(pm4Hdr, itBody);
-			break;
-		case IT_STRMOUT_BUFFER_UPDATE:
-			onStrmoutBufferUpdate(pm4Hdr, itBody);
-			break;
-		case IT_WRITE_DATA:
-			onWriteData(pm4Hdr, itBody);
-			break;
-		case IT_MEM_SEMAPHORE:
-			onMemSemaphore(pm4Hdr, itBody);
-			break;
-		case IT_WAIT_REG_MEM:
-			onWaitRegMem(pm4Hdr, itBody);
-			break;
-		case IT_INDIRECT_BUFFER:
-			onIndirectBuffer(pm4Hdr, itBody);
-			break;
-		case IT_PFP_SYNC_ME:
-			onPfpSyncMe(pm4Hdr, itBody);
-			break;
-		case IT_EVENT_WRITE:
-			onEventWrite(pm4Hdr, itBody);
-			break;
-		case IT_EVENT_WRITE_EOP:
-			onEventWriteEop(pm4Hdr, itBody);
-			break;
-		case IT_EVENT_WRITE_EOS:
-			onEventWriteEos(pm4Hdr, itBody);
-			break;
-		case IT_DMA_DATA:
-			onDmaData(pm4Hdr, itBody);
-			break;
-		case IT_ACQUIRE_MEM:
-			onAcquireMem(pm4Hdr, itBody);
-			break;
-		case IT_REWIND:
-			onRewind(pm4Hdr, itBody);
-			break;
-		case IT_SET_CONFIG_REG:
-			onSetConfigReg(pm4Hdr, itBody);
-			break;
-		case IT_SET_CONTEXT_REG:  // 0x69
-			onSetContextReg(pm4Hdr, itBody);
-			break;
-		case IT_SET_SH_REG:
-			onSetShReg(pm4Hdr, itBody);
-			break;
-		case IT_SET_UCONFIG_REG:  // 0x79
-			onSetUconfigReg(pm4Hdr, itBody);
-			break;
-		case IT_INCREMENT_DE_COUNTER:
-			onIncrementDeCounter(pm4Hdr, itBody);
-			break;
-		case IT_WAIT_ON_CE_COUNTER:
-			onWaitOnCeCounter(pm4Hdr, itBody);
-			break;
-		case IT_DISPATCH_DRAW_PREAMBLE__GFX09:
-			onDispatchDrawPreambleGfx09(pm4Hdr, itBody);
-			break;
-		case IT_DISPATCH_DRAW__GFX09:
-			onDispatchDrawGfx09(pm4Hdr, itBody);
-			break;
-		case IT_GET_LOD_STATS__GFX09:
-			onGetLodStatsGfx09(pm4Hdr, itBody);
-			break;
-		case IT_RELEASE_MEM:
-			onReleaseMem(pm4Hdr, itBody);
-			break;
-		// Private handler
-		case IT_GNM_PRIVATE:
-			onGnmPrivate(pm4Hdr, itBody);
-			break;
+			// Note:
+			// Most private opcode handlers are not much complicated,
+			// just cast pm4Hdr to proper GnmCmdxxx and call the graphic function.
+			// Register the handler of a new private opcode in buildPrivateTable.
+			handler = s_privateTable[PM4_PRIV(pm4Hdr->u32All)];
+		}
 
-		// Legacy packets used in old SDKs.
-		case IT_DRAW_INDEX_AUTO:
-		case IT_DISPATCH_DIRECT:
-			onGnmLegacy(pm4Hdr, itBody);
-			break;
+		if (handler)
+		{
+			(this->*handler)(pm4Hdr, itBody);
+		}
+		return handler;
+	}
 
+	constexpr GnmCommandProcessor::PacketTable GnmCommandProcessor::buildOpcodeTable()
+	{
 		// The following opcode types are not used by Gnm
 
 		// TODO:
 		// There maybe still some opcodes belongs to Gnm that is not found.
-		// We should find all and place them above.
-		case IT_CLEAR_STATE:
-		case IT_DISPATCH_INDIRECT:
-		case IT_INDIRECT_BUFFER_END:
-		case IT_INDIRECT_BUFFER_CNST_END:
-		case IT_ATOMIC_GDS:
-		case IT_ATOMIC_MEM:
-		case IT_OCCLUSION_QUERY:
-		case IT_REG_RMW:
-		case IT_PRED_EXEC:
-		case IT_DRAW_INDIRECT:
-		case IT_DRAW_INDEX_INDIRECT:
-		case IT_DRAW_INDEX_2:
-		case IT_CONTEXT_CONTROL:
-		case IT_DRAW_INDIRECT_MULTI:
-		case IT_DRAW_INDEX_MULTI_AUTO:
-		case IT_INDIRECT_BUFFER_PRIV:
-		case IT_INDIRECT_BUFFER_CNST:
-		case IT_DRAW_INDEX_OFFSET_2:
-		case IT_DRAW_PREAMBLE:
-		case IT_DRAW_INDEX_INDIRECT_MULTI:
-		case IT_DRAW_INDEX_MULTI_INST:
-		case IT_COPY_DW:
-		case IT_COPY_DATA:
-		case IT_CP_DMA:
-		case IT_SURFACE_SYNC:
-		case IT_ME_INITIALIZE:
-		case IT_COND_WRITE:
-		case IT_PREAMBLE_CNTL:
-		case IT_DRAW_RESERVED0:
-		case IT_DRAW_RESERVED1:
-		case IT_DRAW_RESERVED2:
-		case IT_DRAW_RESERVED3:
-		case IT_CONTEXT_REG_RMW:
-		case IT_GFX_CNTX_UPDATE:
-		case IT_BLK_CNTX_UPDATE:
-		case IT_INCR_UPDT_STATE:
-		case IT_INTERRUPT:
-		case IT_GEN_PDEPTE:
-		case IT_INDIRECT_BUFFER_PASID:
-		case IT_PRIME_UTCL2:
-		case IT_LOAD_UCONFIG_REG:
-		case IT_LOAD_SH_REG:
-		case IT_LOAD_CONFIG_REG:
-		case IT_LOAD_CONTEXT_REG:
-		case IT_LOAD_COMPUTE_STATE:
-		case IT_LOAD_SH_REG_INDEX:
-		case IT_SET_CONTEXT_REG_INDEX:
-		case IT_SET_VGPR_REG_DI_MULTI:
-		case IT_SET_SH_REG_DI:
-		case IT_SET_CONTEXT_REG_INDIRECT:
-		case IT_SET_SH_REG_DI_MULTI:
-		case IT_GFX_PIPE_LOCK:
-		case IT_SET_SH_REG_OFFSET:
-		case IT_SET_QUEUE_REG:
-		case IT_SET_UCONFIG_REG_INDEX:
-		case IT_FORWARD_HEADER:
-		case IT_SCRATCH_RAM_WRITE:
-		case IT_SCRATCH_RAM_READ:
-		case IT_LOAD_CONST_RAM:
-		case IT_WRITE_CONST_RAM:
-		case IT_DUMP_CONST_RAM:
-		case IT_INCREMENT_CE_COUNTER:
-		case IT_WAIT_ON_DE_COUNTER_DIFF:
-		case IT_SWITCH_BUFFER:
-		case IT_FRAME_CONTROL:
-		case IT_INDEX_ATTRIBUTES_INDIRECT:
-		case IT_WAIT_REG_MEM64:
-		case IT_COND_PREEMPT:
-		case IT_HDP_FLUSH:
-		case IT_INVALIDATE_TLBS:
-		case IT_DMA_DATA_FILL_MULTI:
-		case IT_SET_SH_REG_INDEX:
-		case IT_DRAW_INDIRECT_COUNT_MULTI:
-		case IT_DRAW_INDEX_INDIRECT_COUNT_MULTI:
-		case IT_DUMP_CONST_RAM_OFFSET:
-		case IT_LOAD_CONTEXT_REG_INDEX:
-		case IT_SET_RESOURCES:
-		case IT_MAP_PROCESS:
-		case IT_MAP_QUEUES:
-		case IT_UNMAP_QUEUES:
-		case IT_QUERY_STATUS:
-		case IT_RUN_LIST:
-		case IT_MAP_PROCESS_VM:
-		case IT_DRAW_MULTI_PREAMBLE__GFX09:
-		case IT_AQL_PACKET__GFX09:
-			LOG_ERR("Opcode not supported %X", opcode);
-			break;
-		default:
-			LOG_ERR("Invalid opcode %X", opcode);
-			break;
+		// We should find all and place them below.
+		constexpr IT_OpCodeType unsupportedOpcodes[] = {
+			IT_CLEAR_STATE,
+			IT_DISPATCH_INDIRECT,
+			IT_INDIRECT_BUFFER_END,
+			IT_INDIRECT_BUFFER_CNST_END,
+			IT_ATOMIC_GDS,
+			IT_ATOMIC_MEM,
+			IT_OCCLUSION_QUERY,
+			IT_REG_RMW,
+			IT_PRED_EXEC,
+			IT_DRAW_INDIRECT,
+			IT_DRAW_INDEX_INDIRECT,
+			IT_DRAW_INDEX_2,
+			IT_CONTEXT_CONTROL,
+			IT_DRAW_INDIRECT_MULTI,
+			IT_DRAW_INDEX_MULTI_AUTO,
+			IT_INDIRECT_BUFFER_PRIV,
+			IT_INDIRECT_BUFFER_CNST,
+			IT_DRAW_INDEX_OFFSET_2,
+			IT_DRAW_PREAMBLE,
+			IT_DRAW_INDEX_INDIRECT_MULTI,
+			IT_DRAW_INDEX_MULTI_INST,
+			IT_COPY_DW,
+			IT_COPY_DATA,
+			IT_CP_DMA,
+			IT_SURFACE_SYNC,
+			IT_ME_INITIALIZE,
+			IT_COND_WRITE,
+			IT_PREAMBLE_CNTL,
+			IT_DRAW_RESERVED0,
+			IT_DRAW_RESERVED1,
+			IT_DRAW_RESERVED2,
+			IT_DRAW_RESERVED3,
+			IT_CONTEXT_REG_RMW,
+			IT_GFX_CNTX_UPDATE,
+			IT_BLK_CNTX_UPDATE,
+			IT_INCR_UPDT_STATE,
+			IT_INTERRUPT,
+			IT_GEN_PDEPTE,
+			IT_INDIRECT_BUFFER_PASID,
+			IT_PRIME_UTCL2,
+			IT_LOAD_UCONFIG_REG,
+			IT_LOAD_SH_REG,
+			IT_LOAD_CONFIG_REG,
+			IT_LOAD_CONTEXT_REG,
+			IT_LOAD_COMPUTE_STATE,
+			IT_LOAD_SH_REG_INDEX,
+			IT_SET_CONTEXT_REG_INDEX,
+			IT_SET_VGPR_REG_DI_MULTI,
+			IT_SET_SH_REG_DI,
+			IT_SET_CONTEXT_REG_INDIRECT,
+			IT_SET_SH_REG_DI_MULTI,
+			IT_GFX_PIPE_LOCK,
+			IT_SET_SH_REG_OFFSET,
+			IT_SET_QUEUE_REG,
+			IT_SET_UCONFIG_REG_INDEX,
+			IT_FORWARD_HEADER,
+			IT_SCRATCH_RAM_WRITE,
+			IT_SCRATCH_RAM_READ,
+			IT_LOAD_CONST_RAM,
+			IT_WRITE_CONST_RAM,
+			IT_DUMP_CONST_RAM,
+			IT_INCREMENT_CE_COUNTER,
+			IT_WAIT_ON_DE_COUNTER_DIFF,
+			IT_SWITCH_BUFFER,
+			IT_FRAME_CONTROL,
+			IT_INDEX_ATTRIBUTES_INDIRECT,
+			IT_WAIT_REG_MEM64,
+			IT_COND_PREEMPT,
+			IT_HDP_FLUSH,
+			IT_INVALIDATE_TLBS,
+			IT_DMA_DATA_FILL_MULTI,
+			IT_SET_SH_REG_INDEX,
+			IT_DRAW_INDIRECT_COUNT_MULTI,
+			IT_DRAW_INDEX_INDIRECT_COUNT_MULTI,
+			IT_DUMP_CONST_RAM_OFFSET,
+			IT_LOAD_CONTEXT_REG_INDEX,
+			IT_SET_RESOURCES,
+			IT_MAP_PROCESS,
+			IT_MAP_QUEUES,
+			IT_UNMAP_QUEUES,
+			IT_QUERY_STATUS,
+			IT_RUN_LIST,
+			IT_MAP_PROCESS_VM,
+			IT_DRAW_MULTI_PREAMBLE__GFX09,
+			IT_AQL_PACKET__GFX09,
+		};
+
+		PacketTable table = {};
+		for (auto& handler : table)
+		{
+			handler = &GnmCommandProcessor::onInvalidOpcode;
+		}
+
+		for (auto opcode : unsupportedOpcodes)
+		{
+			table[opcode] = &GnmCommandProcessor::onUnsupportedOpcode;
 		}
+
+		table[IT_NOP]                           = &GnmCommandProcessor::onNop;
+		table[IT_SET_BASE]                      = &GnmCommandProcessor::onSetBase;
+		table[IT_INDEX_BUFFER_SIZE]             = &GnmCommandProcessor::onIndexBufferSize;
+		table[IT_SET_PREDICATION]               = &GnmCommandProcessor::onSetPredication;
+		table[IT_COND_EXEC]                     = &GnmCommandProcessor::onCondExec;
+		table[IT_INDEX_BASE]                    = &GnmCommandProcessor::onIndexBase;
+		table[IT_INDEX_TYPE]                    = &GnmCommandProcessor::onIndexType;
+		table[IT_NUM_INSTANCES]                 = &GnmCommandProcessor::onNumInstances;
+		table[IT_STRMOUT_BUFFER_UPDATE]         = &GnmCommandProcessor::onStrmoutBufferUpdate;
+		table[IT_WRITE_DATA]                    = &GnmCommandProcessor::onWriteData;
+		table[IT_MEM_SEMAPHORE]                 = &GnmCommandProcessor::onMemSemaphore;
+		table[IT_WAIT_REG_MEM]                  = &GnmCommandProcessor::onWaitRegMem;
+		table[IT_INDIRECT_BUFFER]               = &GnmCommandProcessor::onIndirectBuffer;
+		table[IT_PFP_SYNC_ME]                   = &GnmCommandProcessor::onPfpSyncMe;
+		table[IT_EVENT_WRITE]                   = &GnmCommandProcessor::onEventWrite;
+		table[IT_EVENT_WRITE_EOP]               = &GnmCommandProcessor::onEventWriteEop;
+		table[IT_EVENT_WRITE_EOS]               = &GnmCommandProcessor::onEventWriteEos;
+		table[IT_DMA_DATA]                      = &GnmCommandProcessor::onDmaData;
+		table[IT_ACQUIRE_MEM]                   = &GnmCommandProcessor::onAcquireMem;
+		table[IT_REWIND]                        = &GnmCommandProcessor::onRewind;
+		table[IT_SET_CONFIG_REG]                = &GnmCommandProcessor::onSetConfigReg;
+		table[IT_SET_CONTEXT_REG]               = &GnmCommandProcessor::onSetContextReg;
+		table[IT_SET_SH_REG]                    = &GnmCommandProcessor::onSetShReg;
+		table[IT_SET_UCONFIG_REG]               = &GnmCommandProcessor::onSetUconfigReg;
+		table[IT_INCREMENT_DE_COUNTER]          = &GnmCommandProcessor::onIncrementDeCounter;
+		table[IT_WAIT_ON_CE_COUNTER]            = &GnmCommandProcessor::onWaitOnCeCounter;
+		table[IT_DISPATCH_DRAW_PREAMBLE__GFX09] = &GnmCommandProcessor::onDispatchDrawPreambleGfx09;
+		table[IT_DISPATCH_DRAW__GFX09]          = &GnmCommandProcessor::onDispatchDrawGfx09;
+		table[IT_GET_LOD_STATS__GFX09]          = &GnmCommandProcessor::onGetLodStatsGfx09;
+		table[IT_RELEASE_MEM]                   = &GnmCommandProcessor::onReleaseMem;
+		// IT_GNM_PRIVATE is dispatched through the private table,
+		// see processPM4Type3.
+		// Legacy packets used in old SDKs.
+		table[IT_DRAW_INDEX_AUTO] = &GnmCommandProcessor::onGnmLegacy;
+		table[IT_DISPATCH_DIRECT] = &GnmCommandProcessor::onGnmLegacy;
+
+		return table;
+	}
+
+	constexpr GnmCommandProcessor::PacketTable GnmCommandProcessor::buildPrivateTable()
+	{
+		// Private opcodes without a handler are ignored.
+		PacketTable table = {};
+
+		table[OP_PRIV_INITIALIZE_DEFAULT_HARDWARE_STATE] = &GnmCommandProcessor::onInitializeDefaultHardwareState;
+		table[OP_PRIV_SET_EMBEDDED_VS_SHADER]            = &GnmCommandProcessor::onSetEmbeddedVsShader;
+		table[OP_PRIV_SET_VS_SHADER]                     = &GnmCommandProcessor::onSetVsShader;
+		table[OP_PRIV_SET_PS_SHADER]                     = &GnmCommandProcessor::onSetPsShader;
+		table[OP_PRIV_SET_CS_SHADER]                     = &GnmCommandProcessor::onSetCsShader;
+		table[OP_PRIV_UPDATE_PS_SHADER]                  = &GnmCommandProcessor::onUpdatePsShader;
+		table[OP_PRIV_UPDATE_VS_SHADER]                  = &GnmCommandProcessor::onUpdateVsShader;
+		table[OP_PRIV_SET_VGT_CONTROL]                   = &GnmCommandProcessor::onSetVgtControl;
+		table[OP_PRIV_DRAW_INDEX]                        = &GnmCommandProcessor::onDrawIndex;
+		table[OP_PRIV_DRAW_INDEX_AUTO]                   = &GnmCommandProcessor::onDrawIndexAuto;
+		table[OP_PRIV_WAIT_UNTIL_SAFE_FOR_RENDERING]     = &GnmCommandProcessor::onWaitUntilSafeForRendering;
+		table[OP_PRIV_DISPATCH_DIRECT]                   = &GnmCommandProcessor::onDispatchDirect;
+		table[OP_PRIV_COMPUTE_WAIT_ON_ADDRESS]           = &GnmCommandProcessor::onComputeWaitOnAddress;
+
+		return table;
+	}
+
+	// Defined constexpr so the tables are built by the compiler and live
+	// in read only data, not filled in by a dynamic initializer at startup.
+	constexpr GnmCommandProcessor::PacketTable GnmCommandProcessor::s_opcodeTable  = GnmCommandProcessor::buildOpcodeTable();
+	constexpr GnmCommandProcessor::PacketTable GnmCommandProcessor::s_privateTable = GnmCommandProcessor::buildPrivateTable();
+
+	void GnmCommandProcessor::onInvalidOpcode(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody)
+	{
+		LOG_ERR("Invalid opcode %X", pm4Hdr->opcode);
+		// We most likely lost track of packet boundaries,
+		// the preceding packets tell where.
+		m_trace.dump(TraceDumpCount);
+	}
+
+	void GnmCommandProcessor::onUnsupportedOpcode(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody)
+	{
+		LOG_ERR("Opcode not supported %X", pm4Hdr->opcode);
 	}
 
 	// NOP packet usually used for providing a hint for the following packet,
@@ -458,6 +564,10 @@ namespace sce::Gnm
 		void*    command = reinterpret_cast<void*>(util::buildUint64(packet->ibBaseHi32, packet->ibBaseLo));
 		uint32_t size    = packet->VI.ibSize * sizeof(uint32_t);
 
+		// Packets are patched while processing,
+		// capture before that.
+		GPU().capture().captureMemory(command, size);
+
 		uint32_t oldHint = m_lastHint;
 		m_lastHint       = 0;
 
@@ -831,142 +941,79 @@ namespace sce::Gnm
 		}
 	}
 
-	void GnmCommandProcessor::onGnmPrivate(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody)
+	void GnmCommandProcessor::onInitializeDefaultHardwareState(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody)
+	{
+		m_cb->initializeDefaultHardwareState();
+	}
+
+	void GnmCommandProcessor::onSetEmbeddedVsShader(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody)
+	{
+		GnmCmdVSShader* param = (GnmCmdVSShader*)pm4Hdr;
+		m_cb->setEmbeddedVsShader(param->shaderId, param->modifier);
+	}
+
+	void GnmCommandProcessor::onSetVsShader(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody)
+	{
+		GnmCmdVSShader* param = (GnmCmdVSShader*)pm4Hdr;
+		m_cb->setVsShader(&param->vsRegs, param->modifier);
+	}
+
+	void GnmCommandProcessor::onSetPsShader(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody)
+	{
+		GnmCmdPSShader* param = (GnmCmdPSShader*)pm4Hdr;
+		m_cb->setPsShader(&param->psRegs);
+	}
+
+	void GnmCommandProcessor::onSetCsShader(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody)
+	{
+		GnmCmdCSShader* param = (GnmCmdCSShader*)pm4Hdr;
+		m_cb->setCsShader(&param->csRegs, param->modifier);
+	}
+
+	void GnmCommandProcessor::onUpdatePsShader(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody)
+	{
+		GnmCmdPSShader* param = (GnmCmdPSShader*)pm4Hdr;
+		m_cb->updatePsShader(&param->psRegs);
+	}
+
+	void GnmCommandProcessor::onUpdateVsShader(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody)
+	{
+		GnmCmdVSShader* param = (GnmCmdVSShader*)pm4Hdr;
+		m_cb->updateVsShader(&param->vsRegs, param->modifier);
+	}
+
+	void GnmCommandProcessor::onSetVgtControl(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody)
 	{
-		// Note:
-		// Most private opcode handle cases are not much complicated,
-		// just cast pm4Hdr to proper GnmCmdxxx and call the graphic function.
-		// But if it's going to be complicated (eg. contains 'if' statement),
-		// please write a new function to handle it,
-		// like onDrawIndex
-
-		IT_OpCodePriv priv = PM4_PRIV(*(uint32_t*)pm4Hdr);
-		switch (priv)
+		GnmCmdVgtControl* param = (GnmCmdVgtControl*)pm4Hdr;
+		m_cb->setVgtControlForNeo(param->primGroupSizeMinusOne,
+								  (WdSwitchOnlyOnEopMode)param->wdSwitchOnlyOnEopMode,
+								  (VgtPartialVsWaveMode)param->partialVsWaveMode);
+	}
+
+	void GnmCommandProcessor::onWaitUntilSafeForRendering(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody)
+	{
+		GnmCmdWaitFlipDone* param = (GnmCmdWaitFlipDone*)pm4Hdr;
+		m_cb->waitUntilSafeForRendering(param->videoOutHandle, param->displayBufferIndex);
+	}
+
+	void GnmCommandProcessor::onDispatchDirect(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody)
+	{
+		GnmCmdDispatchDirect*     param = (GnmCmdDispatchDirect*)pm4Hdr;
+		DispatchOrderedAppendMode mode  = (DispatchOrderedAppendMode)bit::extract(param->pred, 4, 3);
+		if (mode == kDispatchOrderedAppendModeDisabled)
 		{
-			case OP_PRIV_INITIALIZE_DEFAULT_HARDWARE_STATE:
-				m_cb->initializeDefaultHardwareState();
-				break;
-			case OP_PRIV_INITIALIZE_TO_DEFAULT_CONTEXT_STATE:
-				break;
-			case OP_PRIV_SET_EMBEDDED_VS_SHADER:
-			{
-				GnmCmdVSShader* param = (GnmCmdVSShader*)pm4Hdr;
-				m_cb->setEmbeddedVsShader(param->shaderId, param->modifier);
-			}
-			break;
-			case OP_PRIV_SET_EMBEDDED_PS_SHADER:
-				break;
-			case OP_PRIV_SET_VS_SHADER:
-			{
-				GnmCmdVSShader* param = (GnmCmdVSShader*)pm4Hdr;
-				m_cb->setVsShader(&param->vsRegs, param->modifier);
-			}
-			break;
-			case OP_PRIV_SET_PS_SHADER:
-			{
-				GnmCmdPSShader* param = (GnmCmdPSShader*)pm4Hdr;
-				m_cb->setPsShader(&param->psRegs);
-			}
-			break;
-			case OP_PRIV_SET_CS_SHADER:
-			{
-				GnmCmdCSShader* param = (GnmCmdCSShader*)pm4Hdr;
-				m_cb->setCsShader(&param->csRegs, param->modifier);
-			}
-			break;
-			case OP_PRIV_SET_ES_SHADER:
-				break;
-			case OP_PRIV_SET_GS_SHADER:
-				break;
-			case OP_PRIV_SET_HS_SHADER:
-				break;
-			case OP_PRIV_SET_LS_SHADER:
-				break;
-			case OP_PRIV_UPDATE_GS_SHADER:
-				break;
-			case OP_PRIV_UPDATE_HS_SHADER:
-				break;
-			case OP_PRIV_UPDATE_PS_SHADER:
-			{
-				GnmCmdPSShader* param = (GnmCmdPSShader*)pm4Hdr;
-				m_cb->updatePsShader(&param->psRegs);
-			}
-			break;
-			case OP_PRIV_UPDATE_VS_SHADER:
-			{
-				GnmCmdVSShader* param = (GnmCmdVSShader*)pm4Hdr;
-				m_cb->updateVsShader(&param->vsRegs, param->modifier);
-			}
-			break;
-			case OP_PRIV_SET_VGT_CONTROL:
-			{
-				GnmCmdVgtControl* param = (GnmCmdVgtControl*)pm4Hdr;
-				m_cb->setVgtControlForNeo(param->primGroupSizeMinusOne,
-										  (WdSwitchOnlyOnEopMode)param->wdSwitchOnlyOnEopMode,
-										  (VgtPartialVsWaveMode)param->partialVsWaveMode);
-			}
-			break;
-			case OP_PRIV_RESET_VGT_CONTROL:
-				break;
-			case OP_PRIV_DRAW_INDEX:
-				onDrawIndex(pm4Hdr, itBody);
-				break;
-			case OP_PRIV_DRAW_INDEX_AUTO:
-				onDrawIndexAuto(pm4Hdr, itBody);
-				break;
-			case OP_PRIV_DRAW_INDEX_INDIRECT:
-				break;
-			case OP_PRIV_DRAW_INDEX_INDIRECT_COUNT_MULTI:
-				break;
-			case OP_PRIV_DRAW_INDEX_MULTI_INSTANCED:
-				break;
-			case OP_PRIV_DRAW_INDEX_OFFSET:
-				break;
-			case OP_PRIV_DRAW_INDIRECT:
-				break;
-			case OP_PRIV_DRAW_INDIRECT_COUNT_MULTI:
-				break;
-			case OP_PRIV_DRAW_OPAQUE_AUTO:
-				break;
-			case OP_PRIV_WAIT_UNTIL_SAFE_FOR_RENDERING:
-			{
-				GnmCmdWaitFlipDone* param = (GnmCmdWaitFlipDone*)pm4Hdr;
-				m_cb->waitUntilSafeForRendering(param->videoOutHandle, param->displayBufferIndex);
-			}
-			break;
-			case OP_PRIV_PUSH_MARKER:
-				break;
-			case OP_PRIV_PUSH_COLOR_MARKER:
-				break;
-			case OP_PRIV_POP_MARKER:
-				break;
-			case OP_PRIV_SET_MARKER:
-				break;
-			case OP_PRIV_DISPATCH_DIRECT:
-			{
-				GnmCmdDispatchDirect*     param = (GnmCmdDispatchDirect*)pm4Hdr;
-				DispatchOrderedAppendMode mode  = (DispatchOrderedAppendMode)bit::extract(param->pred, 4, 3);
-				if (mode == kDispatchOrderedAppendModeDisabled)
-				{
-					m_cb->dispatch(param->threadGroupX, param->threadGroupY, param->threadGroupZ);
-				}
-				else
-				{
-					m_cb->dispatchWithOrderedAppend(param->threadGroupX, param->threadGroupY, param->threadGroupZ, mode);
-				}
-			}
-				break;
-			case OP_PRIV_DISPATCH_INDIRECT:
-				break;
-			case OP_PRIV_COMPUTE_WAIT_ON_ADDRESS:
-			{
-				GnmCmdComputeWaitOnAddress* param = (GnmCmdComputeWaitOnAddress*)pm4Hdr;
-				m_cb->waitOnAddress((void*)param->gpuAddr, param->mask, (WaitCompareFunc)param->compareFunc, param->refValue);
-			}
-				break;
-			default:
-				break;
+			m_cb->dispatch(param->threadGroupX, param->threadGroupY, param->threadGroupZ);
 		}
+		else
+		{
+			m_cb->dispatchWithOrderedAppend(param->threadGroupX, param->threadGroupY, param->threadGroupZ, mode);
+		}
+	}
+
+	void GnmCommandProcessor::onComputeWaitOnAddress(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody)
+	{
+		GnmCmdComputeWaitOnAddress* param = (GnmCmdComputeWaitOnAddress*)pm4Hdr;
+		m_cb->waitOnAddress((void*)param->gpuAddr, param->mask, (WaitCompareFunc)param->compareFunc, param->refValue);
 	}
 
 	void GnmCommandProcessor::onGnmLegacy(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody)
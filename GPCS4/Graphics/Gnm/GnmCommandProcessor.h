@@ -3,9 +3,14 @@
 #include "GnmCommandBuffer.h"
 #include "GnmCommon.h"
 #include "GnmOpCode.h"
+#include "GnmPacketTrace.h"
 
 #include "Violet/VltRc.h"
 
+#include <array>
+#include <unordered_map>
+#include <vector>
+
 namespace sce
 {
 	namespace vlt
@@ -39,9 +44,44 @@ namespace sce
 
 			void processCommandBuffer(const void* commandBuffer, uint32_t commandSize);
 
+			// Writes the latest packets to stderr, when the device was lost.
+			void dumpTrace() const;
+
+			// Command buffers that had to be decoded, not replayed from the cache.
+			uint64_t getDecodeMissCount() const
+			{
+				return m_decodeMissCount;
+			}
+
 		private:
+			using PacketHandler = void (GnmCommandProcessor::*)(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
+			using PacketTable   = std::array<PacketHandler, 256>;
+
+			// Packets traced before the one that failed to process.
+			static constexpr uint32_t TraceDumpCount = 32;
+
+			// Packets kept in the decode cache.
+			static constexpr size_t DecodeCacheBudget = 1 << 20;
+
+			struct DecodedPacket
+			{
+				PacketHandler handler;
+				uint32_t      offset;
+			};
+
+			// Handler calls a command buffer was translated to, games
+			// submit many unchanged command buffers every frame.
+			struct DecodedCommandBuffer
+			{
+				std::vector<DecodedPacket> packets;
+				uint32_t                   size;
+				// Write watch stamp taken before decoding.
+				uint64_t stamp;
+			};
+
 			void processPM4Type0(PPM4_TYPE_0_HEADER pm4Hdr, uint32_t* regDataX);
-			void processPM4Type3(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
+			// Returns the handler called, null if the packet is ignored.
+			PacketHandler processPM4Type3(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
 
 			// Type 3 pm4 packet handlers
 			void onNop(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
@@ -75,15 +115,27 @@ namespace sce
 			void onGetLodStatsGfx09(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
 			void onReleaseMem(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
 
-			// Private
-			void onGnmPrivate(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
 			// Legacy packets used in old SDKs.
 			void onGnmLegacy(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
 
+			void onInvalidOpcode(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
+			void onUnsupportedOpcode(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
+
 			// Parsing methods
 			void onPrepareFlipOrEopInterrupt(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
 			void onDrawIndex(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
 			void onDrawIndexAuto(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
+			void onInitializeDefaultHardwareState(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
+			void onSetEmbeddedVsShader(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
+			void onSetVsShader(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
+			void onSetPsShader(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
+			void onSetCsShader(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
+			void onUpdatePsShader(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
+			void onUpdateVsShader(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
+			void onSetVgtControl(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
+			void onWaitUntilSafeForRendering(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
+			void onDispatchDirect(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
+			void onComputeWaitOnAddress(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
 			void onSetViewport(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
 			void onSetRenderTarget(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
 			void onSetDepthRenderTarget(PPM4_TYPE_3_HEADER pm4Hdr, uint32_t* itBody);
@@ -110,6 +162,29 @@ namespace sce
 
 			bool processCmdInternal(const void* commandBuffer, uint32_t commandSize);
 
+			// Writes the trace of the processor running on the crashing thread.
+			static void onCrash();
+
+			void replayDecoded(
+				const void*                 commandBuffer,
+				const DecodedCommandBuffer& decoded);
+
+			void insertDecoded(
+				const void*            commandBuffer,
+				DecodedCommandBuffer&& decoded);
+
+			static constexpr PacketTable buildOpcodeTable();
+			static constexpr PacketTable buildPrivateTable();
+
+		private:
+			// Handlers indexed by type 3 opcode.
+			// Declared const since the class is incomplete here,
+			// the definitions are constexpr.
+			static const PacketTable s_opcodeTable;
+			// Handlers indexed by private opcode of IT_GNM_PRIVATE packets,
+			// null entries are ignored.
+			static const PacketTable s_privateTable;
+
 		private:
 			GnmCommandBuffer* m_cb;
 
@@ -127,6 +202,15 @@ namespace sce
 			// This should be the the real pm4 packet count which forms a gnm call minus one.
 			// e.g. 2 packets makes gnm call, m_skipPm4Count = 1
 			uint32_t m_skipPm4Count = 0;
+
+			// Recently processed packets, dumped when processing fails.
+			GnmPacketTrace m_trace;
+
+			// Decoded command buffers by address, including
+			// those reached through IT_INDIRECT_BUFFER.
+			std::unordered_map<const void*, DecodedCommandBuffer> m_decodeCache;
+			size_t                                                m_decodeCacheSize = 0;
+			uint64_t                                              m_decodeMissCount = 0;
 		};
 
 	}  // namespace Gnm
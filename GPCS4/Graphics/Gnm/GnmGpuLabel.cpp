@@ -3,6 +3,9 @@
 #include "Violet/VltContext.h"
 #include "Violet/VltSemaphore.h"
 #include "PlatProcess.h"
+#include "Emulator.h"
+#include "VirtualGPU.h"
+#include "Sce/SceGnmDriver.h"
 
 using namespace sce::vlt;
 
@@ -31,6 +34,27 @@ namespace sce::Gnm
 		VkPipelineStageFlags2 stage,
 		EventWriteSource      srcSelector,
 		uint64_t              immValue)
+	{
+		signal(context, stage, srcSelector, immValue, false, kEqEventGfxEop);
+	}
+
+	void GnmGpuLabel::writeWithInterrupt(
+		VltContext*           context,
+		VkPipelineStageFlags2 stage,
+		EventWriteSource      srcSelector,
+		uint64_t              immValue,
+		EqEventType           eventType)
+	{
+		signal(context, stage, srcSelector, immValue, true, eventType);
+	}
+
+	void GnmGpuLabel::signal(
+		VltContext*           context,
+		VkPipelineStageFlags2 stage,
+		EventWriteSource      srcSelector,
+		uint64_t              immValue,
+		bool                  interrupt,
+		EqEventType           eventType)
 	{
 		if (m_semaphore == nullptr)
 		{
@@ -53,7 +77,7 @@ namespace sce::Gnm
 		// Asynchronously set label value upon semaphore is signaled.
 		// Record the returned future so that when the class is destructed,
 		// we can make sure the label has been updated.
-		m_future = std::async(std::launch::async, [this, srcSelector, immValue]()
+		m_future = std::async(std::launch::async, [this, srcSelector, immValue, interrupt, eventType]()
 			{ 
 				m_semaphore->wait(immValue);
 
@@ -63,18 +87,14 @@ namespace sce::Gnm
 					*reinterpret_cast<uint64_t*>(m_label) = immValue; 
 				else
 					*reinterpret_cast<uint64_t*>(m_label) = plat::GetProcessTimeCounter();
-			});
-	}
 
-	void GnmGpuLabel::writeWithInterrupt(
-		VltContext*           context,
-		VkPipelineStageFlags2 stage,
-		EventWriteSource      srcSelector,
-		uint64_t              immValue)
-	{
-		// TODO:
-		// Implement interrupt
-		write(context, stage, srcSelector, immValue);
+				// The interrupt is raised after the label write,
+				// waiters may check the label when woken up.
+				if (interrupt)
+				{
+					GPU().gnmDriver().triggerEqEvent(eventType);
+				}
+			});
 	}
 
 	void GnmGpuLabel::wait(
@@ -36,7 +36,8 @@ namespace sce::Gnm
 			vlt::VltContext*      context,
 			VkPipelineStageFlags2 stage,
 			EventWriteSource      srcSelector,
-			uint64_t              immValue);
+			uint64_t              immValue,
+			EqEventType           eventType);
 
 		void wait(
 			vlt::VltContext* context,
@@ -44,6 +45,15 @@ namespace sce::Gnm
 			WaitCompareFunc  compareFunc,
 			uint32_t         refValue);
 		
+	private:
+		void signal(
+			vlt::VltContext*      context,
+			VkPipelineStageFlags2 stage,
+			EventWriteSource      srcSelector,
+			uint64_t              immValue,
+			bool                  interrupt,
+			EqEventType           eventType);
+
 	private:
 		vlt::VltDevice* m_device;
 		void*           m_label;
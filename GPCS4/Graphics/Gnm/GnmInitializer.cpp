@@ -6,6 +6,8 @@
 #include "Violet/VltDevice.h"
 #include "Violet/VltContext.h"
 
+#include "UtilProfiler.h"
+
 using namespace sce::vlt;
 
 LOG_CHANNEL(Graphic.Gnm.GnmInitializer);
@@ -35,6 +37,8 @@ namespace sce::Gnm
 	void GnmInitializer::initBuffer(
 		const Rc<VltBuffer>& buffer, const Buffer* vsharp)
 	{
+		PROFILER_ZONE("Init Buffer", "Gnm");
+
 		VkMemoryPropertyFlags memFlags = buffer->memFlags();
 
 		(memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
@@ -45,6 +49,8 @@ namespace sce::Gnm
 	void GnmInitializer::initTexture(
 		const Rc<VltImage>& image, const Texture* tsharp)
 	{
+		PROFILER_ZONE("Init Texture", "Gnm");
+
 		VkMemoryPropertyFlags memFlags = image->memFlags();
 		(memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
 			? initHostVisibleTexture(image, tsharp)
@@ -173,6 +179,8 @@ namespace sce::Gnm
 
 	void GnmInitializer::flushInternal()
 	{
+		PROFILER_ZONE("Flush Initializer", "Gnm");
+
 		m_context->flushCommandList();
 
 		m_transferCommands = 0;
@@ -0,0 +1,76 @@
+#include "GnmPacketTrace.h"
+#include "GnmOpCode.h"
+
+#include <algorithm>
+#include <cstdio>
+
+LOG_CHANNEL(Graphic.Gnm.GnmPacketTrace);
+
+namespace sce::Gnm
+{
+
+	GnmPacketTrace::GnmPacketTrace() :
+		m_entries(std::make_unique<GnmPacketTraceEntry[]>(EntryCount))
+	{
+		static_assert((EntryCount & (EntryCount - 1)) == 0, "entry count must be a power of two.");
+	}
+
+	GnmPacketTrace::~GnmPacketTrace()
+	{
+	}
+
+	std::string GnmPacketTrace::decode(uint32_t count) const
+	{
+		std::string text;
+
+		uint64_t entryCount = std::min<uint64_t>({ count, EntryCount, m_count });
+		for (uint64_t index = m_count - entryCount; index != m_count; ++index)
+		{
+			const auto& entry = m_entries[index & (EntryCount - 1)];
+
+			uint32_t    type = PM4_TYPE(entry.header);
+			const char* name = nullptr;
+			switch (type)
+			{
+			case PM4_TYPE_0:
+				name = "TYPE_0";
+				break;
+			case PM4_TYPE_2:
+				name = "TYPE_2";
+				break;
+			case PM4_TYPE_3:
+				name = opcodeName(entry.header);
+				break;
+			default:
+				name = "Invalid packet type";
+				break;
+			}
+
+			char line[256];
+			std::snprintf(line, sizeof(line),
+						  "#%llu %p+0x%06X %08X len %u %s\n",
+						  static_cast<unsigned long long>(index),
+						  entry.commandBuffer,
+						  entry.offset,
+						  entry.header,
+						  type == PM4_TYPE_2 ? 1 : PM4_LENGTH_DW(entry.header),
+						  name);
+			text += line;
+		}
+		return text;
+	}
+
+	void GnmPacketTrace::dump(uint32_t count) const
+	{
+		auto text = decode(count);
+		LOG_ERR("PM4 packet trace, latest %u packets:\n%s", count, text.c_str());
+	}
+
+	void GnmPacketTrace::write(uint32_t count) const
+	{
+		auto text = decode(count);
+		std::fprintf(stderr, "PM4 packet trace, latest %u packets:\n%s", count, text.c_str());
+		std::fflush(stderr);
+	}
+
+}  // namespace sce::Gnm
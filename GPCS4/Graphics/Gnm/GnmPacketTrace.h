@@ -0,0 +1,86 @@
+#pragma once
+
+#include "GnmCommon.h"
+
+#include <memory>
+#include <string>
+
+namespace sce::Gnm
+{
+
+	/**
+	 * \brief PM4 packet trace entry
+	 */
+	struct GnmPacketTraceEntry
+	{
+		// Command buffer the packet belongs to.
+		const void* commandBuffer;
+		// Offset of the packet in bytes.
+		uint32_t offset;
+		// Raw packet header, holds type, opcode, length
+		// and the private opcode of IT_GNM_PRIVATE packets.
+		uint32_t header;
+	};
+
+	/**
+	 * \brief PM4 packet trace ring
+	 *
+	 * Keeps the headers of the latest processed packets in
+	 * binary form. Recording is a couple of stores, so the
+	 * trace is always on, the entries are decoded to text
+	 * only when something goes wrong.
+	 */
+	class GnmPacketTrace
+	{
+	public:
+		// Must be a power of two.
+		static constexpr uint32_t EntryCount = 1024;
+
+		GnmPacketTrace();
+		~GnmPacketTrace();
+
+		/**
+		 * \brief Records a packet
+		 *
+		 * \param [in] commandBuffer Command buffer being processed
+		 * \param [in] offset Offset of the packet in bytes
+		 * \param [in] header Raw packet header
+		 */
+		void record(
+			const void* commandBuffer,
+			uint32_t    offset,
+			uint32_t    header)
+		{
+			auto& entry         = m_entries[m_count & (EntryCount - 1)];
+			entry.commandBuffer = commandBuffer;
+			entry.offset        = offset;
+			entry.header        = header;
+			++m_count;
+		}
+
+		/**
+		 * \brief Decodes the latest packets
+		 *
+		 * \param [in] count Max number of packets to decode
+		 * \returns One line per packet, oldest first
+		 */
+		std::string decode(uint32_t count) const;
+
+		/**
+		 * \brief Logs the latest packets as an error
+		 */
+		void dump(uint32_t count) const;
+
+		/**
+		 * \brief Writes the latest packets to stderr
+		 *
+		 * Unlike dump, works in every build, for fatal errors.
+		 */
+		void write(uint32_t count) const;
+
+	private:
+		std::unique_ptr<GnmPacketTraceEntry[]> m_entries;
+		uint64_t                               m_count = 0;
+	};
+
+}  // namespace sce::Gnm
@@ -0,0 +1,163 @@
+#include "GnmPm4Bench.h"
+#include "GnmCommandBufferDummy.h"
+#include "GnmCommandProcessor.h"
+#include "GnmOpCode.h"
+#include "GnmStructure.h"
+#include "PlatMemory.h"
+#include "UtilMath.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+LOG_CHANNEL(Graphic.Gnm.GnmPm4Bench);
+
+namespace sce::Gnm
+{
+
+	GnmPm4Bench::GnmPm4Bench(const GnmPm4BenchDesc& desc) :
+		m_desc(desc)
+	{
+	}
+
+	GnmPm4Bench::~GnmPm4Bench()
+	{
+	}
+
+	bool GnmPm4Bench::run()
+	{
+		bool ret = false;
+		do
+		{
+			if (m_desc.drawCount == 0)
+			{
+				std::printf("Nothing to process, draw count is 0.\n");
+				break;
+			}
+
+			buildCommandBuffer();
+
+			// The dummy command buffer never touches the device.
+			GnmCommandBufferDummy commandBuffer(nullptr);
+			GnmCommandProcessor   processor;
+			processor.attachCommandBuffer(&commandBuffer);
+
+			const uint32_t commandSize = static_cast<uint32_t>(m_commands.size() * sizeof(uint32_t));
+			const uint32_t repeatCount = std::max(m_desc.repeatCount, 1u);
+
+			// Submit from write watched memory like guest memory,
+			// the decode cache is only used for such buffers.
+			plat::memory_ptr memory(reinterpret_cast<uint8_t*>(plat::VMAllocate(
+				nullptr, util::align(commandSize, plat::VM_PAGE_SIZE),
+				plat::VMAT_RESERVE_COMMIT_WATCH, plat::VMPF_CPU_RW)));
+			if (!memory)
+			{
+				std::printf("Failed to allocate %u bytes of command buffer.\n", commandSize);
+				break;
+			}
+			std::memcpy(memory.get(), m_commands.data(), commandSize);
+
+			// The first run decodes the command buffer,
+			// later runs replay it from the decode cache.
+			double firstTime = 0.0;
+			double bestTime  = 0.0;
+			double totalTime = 0.0;
+			for (uint32_t i = 0; i != repeatCount; ++i)
+			{
+				auto start = std::chrono::high_resolution_clock::now();
+				processor.processCommandBuffer(memory.get(), commandSize);
+				auto end = std::chrono::high_resolution_clock::now();
+
+				double time = std::chrono::duration<double>(end - start).count();
+				firstTime   = i == 0 ? time : firstTime;
+				bestTime    = i == 0 ? time : std::min(bestTime, time);
+				totalTime += time;
+			}
+
+			std::printf("Command buffer : %llu packets, %u draws, %u bytes\n",
+						static_cast<unsigned long long>(m_packetCount),
+						m_desc.drawCount,
+						commandSize);
+			std::printf("First          : %.3f ms, %.2f Mpackets/s\n",
+						firstTime * 1000.0,
+						m_packetCount / firstTime / 1000000.0);
+			std::printf("Best           : %.3f ms, %.2f Mpackets/s\n",
+						bestTime * 1000.0,
+						m_packetCount / bestTime / 1000000.0);
+			std::printf("Average        : %.3f ms over %u runs\n",
+						totalTime * 1000.0 / repeatCount,
+						repeatCount);
+
+			// An unchanged buffer is replayed, but any write to it must
+			// make it decoded again, even one that leaves the content as it was.
+			uint64_t missCount = processor.getDecodeMissCount();
+			processor.processCommandBuffer(memory.get(), commandSize);
+			if (processor.getDecodeMissCount() != missCount)
+			{
+				std::printf("Decode cache   : not used, no write watch on this platform\n");
+			}
+			else
+			{
+				std::memcpy(memory.get(), m_commands.data(), sizeof(uint32_t));
+				processor.processCommandBuffer(memory.get(), commandSize);
+				bool rewritten = processor.getDecodeMissCount() == missCount + 1;
+				std::printf("Rewrite check  : %s\n", rewritten ? "ok" : "failed");
+			}
+
+			ret = true;
+		} while (false);
+		return ret;
+	}
+
+	void GnmPm4Bench::buildCommandBuffer()
+	{
+		m_commands.clear();
+		m_packetCount = 0;
+
+		for (uint32_t i = 0; i != m_desc.drawCount; ++i)
+		{
+			// Alternate values between draws, like a game
+			// switching materials, but also repeat some
+			// state to exercise redundant set filtering.
+			uint32_t variant = i & 3;
+
+			emitContextReg(OP_HINT_SET_PRIMITIVE_SETUP, 0x0000'0240);
+			emitContextReg(OP_HINT_SET_RENDER_TARGET_MASK, 0x0000'000F);
+			emitContextReg(OP_HINT_SET_DEPTH_STENCIL_CONTROL, variant ? 0x0000'0076 : 0);
+			emitContextReg(0x1E0, variant == 1 ? 0x4005'0501 : 0);
+			emitUconfigReg(OP_HINT_SET_PRIMITIVE_TYPE_BASE, kPrimitiveTypeTriList);
+			emitDrawIndexAuto(3 * (variant + 1));
+		}
+	}
+
+	void GnmPm4Bench::emitContextReg(uint32_t reg, uint32_t value)
+	{
+		m_commands.push_back(PM4_HEADER_BUILD(3, IT_SET_CONTEXT_REG, 0));
+		m_commands.push_back(reg);
+		m_commands.push_back(value);
+		++m_packetCount;
+	}
+
+	void GnmPm4Bench::emitUconfigReg(uint32_t reg, uint32_t value)
+	{
+		m_commands.push_back(PM4_HEADER_BUILD(3, IT_SET_UCONFIG_REG, 0));
+		m_commands.push_back(reg);
+		m_commands.push_back(value);
+		++m_packetCount;
+	}
+
+	void GnmPm4Bench::emitDrawIndexAuto(uint32_t indexCount)
+	{
+		const uint32_t      paramSize = sizeof(GnmCmdDrawIndexAuto) / sizeof(uint32_t);
+		GnmCmdDrawIndexAuto param     = {};
+		param.opcode                  = PM4_HEADER_BUILD(paramSize, IT_GNM_PRIVATE, OP_PRIV_DRAW_INDEX_AUTO);
+		param.indexCount              = indexCount;
+
+		size_t offset = m_commands.size();
+		m_commands.resize(offset + paramSize);
+		std::memcpy(&m_commands[offset], &param, sizeof(param));
+		++m_packetCount;
+	}
+
+}  // namespace sce::Gnm
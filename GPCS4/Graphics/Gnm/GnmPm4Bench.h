@@ -0,0 +1,59 @@
+#pragma once
+
+#include "GnmCommon.h"
+
+#include <vector>
+
+namespace sce::Gnm
+{
+
+	/**
+	 * \brief PM4 benchmark description
+	 */
+	struct GnmPm4BenchDesc
+	{
+		// Number of draws in the synthetic command buffer,
+		// each draw is preceded by a handful of state packets.
+		uint32_t drawCount;
+		// Process the command buffer N times and keep
+		// the fastest time, to filter out noise.
+		uint32_t repeatCount;
+	};
+
+	/**
+	 * \brief PM4 packet processing benchmark
+	 *
+	 * Builds a synthetic command buffer of typical state and
+	 * draw packets and feeds it to the command processor with
+	 * a dummy command buffer attached, so that only packet
+	 * parsing and dispatch is measured, no GPU is needed.
+	 */
+	class GnmPm4Bench
+	{
+	public:
+		GnmPm4Bench(const GnmPm4BenchDesc& desc);
+		~GnmPm4Bench();
+
+		/**
+		 * \brief Runs the benchmark
+		 * \returns \c true if the benchmark ran
+		 */
+		bool run();
+
+	private:
+		void buildCommandBuffer();
+
+		void emitContextReg(uint32_t reg, uint32_t value);
+
+		void emitUconfigReg(uint32_t reg, uint32_t value);
+
+		void emitDrawIndexAuto(uint32_t indexCount);
+
+	private:
+		GnmPm4BenchDesc m_desc;
+
+		std::vector<uint32_t> m_commands;
+		uint64_t              m_packetCount = 0;
+	};
+
+}  // namespace sce::Gnm
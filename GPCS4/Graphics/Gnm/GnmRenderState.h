@@ -7,6 +7,7 @@
 #include "Gcn/GcnConstants.h"
 #include "Gcn/GcnShaderMeta.h"
 #include "Gcn/GcnModule.h"
+#include "Violet/VltLimit.h"
 
 #include <array>
 
@@ -32,7 +33,12 @@ namespace sce::Gnm
      */
 	enum class GnmContextFlag : uint32_t
 	{
-		GpPlaceHolder,            ///< PlaceHolder
+		GpDirtyRasterizerState,     ///< Primitive setup has changed
+		GpDirtyViewport,            ///< Viewport has changed
+		GpDirtyScissor,             ///< Screen scissor has changed
+		GpDirtyBlendState,          ///< Blend control or render target mask has changed
+		GpDirtyDepthStencilState,   ///< Depth stencil control or DB render control has changed
+		GpDirtyInputAssemblyState,  ///< Primitive type has changed
 	};
 
 	using GnmContextFlags = util::Flags<GnmContextFlag>;
@@ -64,6 +70,60 @@ namespace sce::Gnm
 		SceResource* displayRenderTarget = nullptr;
 	};
 
+	/**
+	 * \brief Context register shadow
+	 *
+	 * Last values of the context registers which map
+	 * to Violet pipeline state. Setting a register only
+	 * updates the shadow, changed register groups are
+	 * converted to Violet state at draw time.
+	 */
+	struct GnmContextRegisters
+	{
+		uint32_t primitiveSetup = 0;
+
+		struct
+		{
+			float dmin      = 0.0f;
+			float dmax      = 0.0f;
+			float scale[3]  = {};
+			float offset[3] = {};
+		} viewport;
+
+		struct
+		{
+			int32_t left   = 0;
+			int32_t top    = 0;
+			int32_t right  = 0;
+			int32_t bottom = 0;
+		} screenScissor;
+
+		std::array<uint32_t, vlt::MaxNumRenderTargets> blendControl = {};
+		// Applied after blend control, which resets write masks.
+		uint32_t renderTargetMask = 0xFFFFFFFF;
+
+		uint32_t depthStencilControl = 0;
+		uint32_t dbRenderControl     = 0;
+
+		uint32_t primitiveType = 0;
+
+		// Register groups set at least once,
+		// a group is never converted before that.
+		GnmContextFlags valid;
+	};
+
+	/**
+	 * \brief Context state statistics
+	 *
+	 * Counts register sets and the register group
+	 * conversions they resulted in, reset every frame.
+	 */
+	struct GnmContextStats
+	{
+		uint32_t registerSets     = 0;
+		uint32_t groupConversions = 0;
+	};
+
 	struct GnmGraphicsState
 	{
 		std::array<GnmShaderContext, kShaderStageCount> shaderContext = {};
@@ -71,6 +131,8 @@ namespace sce::Gnm
 		GnmInputAssemblerState ia = {};
 		GnmDepthStencilState   ds = {};
 		GnmOutputMergerState   om = {};
+
+		GnmContextRegisters regs = {};
 	};
 
 	struct GnmComputeState
@@ -0,0 +1,333 @@
+#include "SceCapture.h"
+#include "SceGpuQueue.h"
+#include "SceVideoOut.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+LOG_CHANNEL(Graphic.Sce.SceCapture);
+
+namespace sce
+{
+	namespace
+	{
+		struct Submission
+		{
+			SceCaptureSubmit               info = {};
+			std::vector<SceCaptureCommand> commands;
+			std::vector<SceCaptureRange>   ranges;
+			// Address to size of ranges already recorded.
+			std::unordered_map<uint64_t, uint64_t> captured;
+		};
+
+		thread_local std::unique_ptr<Submission> t_submission;
+
+		uint64_t hashMemory(const void* data, size_t size)
+		{
+			// FNV-1a over 64 bit words, with the high half folded
+			// back after each step so that every bit of a word
+			// affects the whole hash.
+			constexpr uint64_t Prime = 0x0000'0100'0000'01B3;
+
+			const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+			uint64_t       hash  = 0xCBF2'9CE4'8422'2325 ^ size;
+
+			size_t wordCount = size / sizeof(uint64_t);
+			for (size_t i = 0; i != wordCount; ++i)
+			{
+				uint64_t word;
+				std::memcpy(&word, bytes + i * sizeof(uint64_t), sizeof(uint64_t));
+				hash = (hash ^ word) * Prime;
+				hash ^= hash >> 32;
+			}
+
+			for (size_t i = wordCount * sizeof(uint64_t); i != size; ++i)
+			{
+				hash = (hash ^ bytes[i]) * Prime;
+			}
+			return hash;
+		}
+	}  // namespace
+
+	SceCapture::SceCapture()
+	{
+	}
+
+	SceCapture::~SceCapture()
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		closeFile();
+	}
+
+	void SceCapture::initialize(const SceCaptureDesc& desc)
+	{
+		m_desc    = desc;
+		m_enabled = desc.frameCount != 0;
+		m_frame   = 0;
+
+		// Frame 0 is never preceded by a flip.
+		if (m_enabled && m_desc.startFrame == 0)
+		{
+			std::lock_guard<std::mutex> guard(m_mutex);
+			openFile();
+		}
+	}
+
+	bool SceCapture::isRecording() const
+	{
+		return t_submission != nullptr;
+	}
+
+	void SceCapture::recordVideoOut(
+		uint32_t     handle,
+		SceVideoOut& videoOut)
+	{
+		do
+		{
+			if (!isCapturing())
+			{
+				break;
+			}
+
+			std::lock_guard<std::mutex> guard(m_mutex);
+			if (m_videoOutDone || !m_file.is_open())
+			{
+				break;
+			}
+
+			SceCaptureVideoOut chunk = {};
+			chunk.handle             = handle;
+			chunk.busType            = videoOut.busType();
+			chunk.bufferCount        = std::min(videoOut.displayBufferCount(), SceCaptureMaxDisplayBuffers);
+			chunk.attribute          = videoOut.displayBufferAttribute();
+			for (uint32_t i = 0; i != chunk.bufferCount; ++i)
+			{
+				chunk.addresses[i] = reinterpret_cast<uint64_t>(
+					videoOut.getDisplayBuffer(i).address);
+			}
+
+			writeChunkHeader(SceCaptureChunkType::VideoOut, sizeof(chunk));
+			m_file.write(reinterpret_cast<const char*>(&chunk), sizeof(chunk));
+
+			m_videoOutDone = true;
+		} while (false);
+	}
+
+	void SceCapture::beginSubmit(
+		SceQueueType type,
+		uint32_t     vqueueId)
+	{
+		if (isCapturing())
+		{
+			t_submission                 = std::make_unique<Submission>();
+			t_submission->info.queueType = static_cast<uint32_t>(type);
+			t_submission->info.vqueueId  = vqueueId;
+		}
+	}
+
+	void SceCapture::addCommand(
+		const void* buffer,
+		uint32_t    size)
+	{
+		if (t_submission)
+		{
+			SceCaptureCommand command = {};
+			command.address           = reinterpret_cast<uint64_t>(buffer);
+			command.size              = size;
+			t_submission->commands.push_back(command);
+
+			captureMemory(buffer, size);
+		}
+	}
+
+	void SceCapture::captureMemory(
+		const void* address,
+		size_t      size)
+	{
+		do
+		{
+			if (!t_submission || address == nullptr || size == 0)
+			{
+				break;
+			}
+
+			// Packets processed later may change the memory,
+			// e.g. label writes, keep the content seen first.
+			uint64_t addressValue = reinterpret_cast<uint64_t>(address);
+			auto&    captured     = t_submission->captured[addressValue];
+			if (captured >= size)
+			{
+				break;
+			}
+			captured = size;
+
+			SceCaptureRange range = {};
+			range.address         = addressValue;
+			range.size            = size;
+			{
+				std::lock_guard<std::mutex> guard(m_mutex);
+				range.blob = writeBlob(address, size);
+			}
+			t_submission->ranges.push_back(range);
+		} while (false);
+	}
+
+	void SceCapture::endSubmit(
+		uint32_t videoOutHandle,
+		uint32_t displayBufferIndex,
+		uint32_t flipMode,
+		int64_t  flipArg)
+	{
+		do
+		{
+			if (!t_submission)
+			{
+				break;
+			}
+
+			std::unique_ptr<Submission> submission = std::move(t_submission);
+
+			auto& info              = submission->info;
+			info.commandCount       = static_cast<uint32_t>(submission->commands.size());
+			info.rangeCount         = static_cast<uint32_t>(submission->ranges.size());
+			info.videoOutHandle     = videoOutHandle;
+			info.displayBufferIndex = displayBufferIndex;
+			info.flipMode           = flipMode;
+			info.flipArg            = flipArg;
+
+			size_t commandSize = sizeof(SceCaptureCommand) * submission->commands.size();
+			size_t rangeSize   = sizeof(SceCaptureRange) * submission->ranges.size();
+
+			std::lock_guard<std::mutex> guard(m_mutex);
+			if (!m_file.is_open())
+			{
+				break;
+			}
+
+			writeChunkHeader(SceCaptureChunkType::Submit, sizeof(info) + commandSize + rangeSize);
+			m_file.write(reinterpret_cast<const char*>(&info), sizeof(info));
+			m_file.write(reinterpret_cast<const char*>(submission->commands.data()), commandSize);
+			m_file.write(reinterpret_cast<const char*>(submission->ranges.data()), rangeSize);
+
+			++m_submitCount;
+		} while (false);
+	}
+
+	void SceCapture::nextFrame()
+	{
+		do
+		{
+			if (!m_enabled)
+			{
+				break;
+			}
+
+			++m_frame;
+
+			std::lock_guard<std::mutex> guard(m_mutex);
+			if (m_frame == m_desc.startFrame)
+			{
+				openFile();
+			}
+			else if (m_frame == uint64_t(m_desc.startFrame) + m_desc.frameCount)
+			{
+				closeFile();
+				m_enabled = false;
+			}
+		} while (false);
+	}
+
+	void SceCapture::openFile()
+	{
+		do
+		{
+			m_file.open(m_desc.path, std::ios::binary | std::ios::trunc);
+			if (!m_file)
+			{
+				LOG_ERR("open capture file %s failed.", m_desc.path.c_str());
+				m_enabled = false;
+				break;
+			}
+
+			SceCaptureFileHeader header = {};
+			header.magic                = SceCaptureMagic;
+			header.version              = SceCaptureVersion;
+			m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+			m_blobs.clear();
+			m_blobData.clear();
+			m_blobCount    = 0;
+			m_blobBytes    = 0;
+			m_submitCount  = 0;
+			m_videoOutDone = false;
+
+			m_capturing.store(true, std::memory_order_relaxed);
+		} while (false);
+	}
+
+	void SceCapture::closeFile()
+	{
+		m_capturing.store(false, std::memory_order_relaxed);
+
+		if (m_file.is_open())
+		{
+			m_file.close();
+
+			std::printf("%u submissions, %u blobs (%llu bytes) written to %s\n",
+						m_submitCount,
+						m_blobCount,
+						static_cast<unsigned long long>(m_blobBytes),
+						m_desc.path.c_str());
+		}
+	}
+
+	void SceCapture::writeChunkHeader(
+		SceCaptureChunkType type,
+		uint64_t            size)
+	{
+		SceCaptureChunkHeader header = {};
+		header.type                  = type;
+		header.size                  = size;
+		m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	}
+
+	uint32_t SceCapture::writeBlob(
+		const void* data,
+		size_t      size)
+	{
+		uint64_t hash  = hashMemory(data, size);
+		auto     bytes = reinterpret_cast<const uint8_t*>(data);
+
+		uint32_t index = m_blobCount;
+		auto     range = m_blobs.equal_range(hash);
+		for (auto iter = range.first; iter != range.second; ++iter)
+		{
+			const auto& content = m_blobData[iter->second];
+			if (content.size() == size && std::memcmp(content.data(), data, size) == 0)
+			{
+				index = iter->second;
+				break;
+			}
+		}
+
+		if (index == m_blobCount)
+		{
+			SceCaptureBlob blob = {};
+			blob.hash           = hash;
+			blob.size           = size;
+
+			writeChunkHeader(SceCaptureChunkType::Blob, sizeof(blob) + size);
+			m_file.write(reinterpret_cast<const char*>(&blob), sizeof(blob));
+			m_file.write(reinterpret_cast<const char*>(data), size);
+
+			m_blobs.emplace(hash, m_blobCount++);
+			m_blobData.emplace_back(bytes, bytes + size);
+			m_blobBytes += size;
+		}
+		return index;
+	}
+
+}  // namespace sce
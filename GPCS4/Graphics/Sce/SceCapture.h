@@ -0,0 +1,150 @@
+#pragma once
+
+#include "SceCommon.h"
+#include "SceCaptureFile.h"
+
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sce
+{
+	class SceVideoOut;
+	enum class SceQueueType;
+
+	struct SceCaptureDesc
+	{
+		// Capture file to write.
+		std::string path;
+		// Range of frames to capture.
+		uint32_t startFrame;
+		uint32_t frameCount;
+	};
+
+	/**
+	 * \brief PM4 capture writer
+	 *
+	 * Records submitted command buffers together with the
+	 * guest memory they reference, so that the frames can be
+	 * replayed without the game, see \ref SceReplayer.
+	 *
+	 * A submission is recorded on the thread which processes
+	 * it, memory referenced while processing is collected by
+	 * \ref captureMemory, which does nothing when the calling
+	 * thread is not recording a submission.
+	 */
+	class SceCapture
+	{
+	public:
+		SceCapture();
+		~SceCapture();
+
+		void initialize(const SceCaptureDesc& desc);
+
+		/**
+		 * \brief Whether the current frame is captured
+		 */
+		bool isCapturing() const
+		{
+			return m_capturing.load(std::memory_order_relaxed);
+		}
+
+		/**
+		 * \brief Whether the calling thread records a submission
+		 */
+		bool isRecording() const;
+
+		/**
+		 * \brief Records video out configuration
+		 *
+		 * Written once per capture, before the first
+		 * submission using the video out.
+		 */
+		void recordVideoOut(
+			uint32_t     handle,
+			SceVideoOut& videoOut);
+
+		/**
+		 * \brief Starts recording a submission
+		 *
+		 * \param [in] type Queue the commands are submitted to
+		 * \param [in] vqueueId Compute queue id, 0 for graphics
+		 */
+		void beginSubmit(
+			SceQueueType type,
+			uint32_t     vqueueId);
+
+		/**
+		 * \brief Records a command buffer of the submission
+		 *
+		 * Must be called before the command buffer is
+		 * processed, the processor patches some packets.
+		 */
+		void addCommand(
+			const void* buffer,
+			uint32_t    size);
+
+		/**
+		 * \brief Records guest memory content
+		 *
+		 * Only the first reference of an address within
+		 * a submission is recorded.
+		 */
+		void captureMemory(
+			const void* address,
+			size_t      size);
+
+		/**
+		 * \brief Finishes and writes the submission
+		 *
+		 * Flip parameters are ignored for compute queues.
+		 */
+		void endSubmit(
+			uint32_t videoOutHandle,
+			uint32_t displayBufferIndex,
+			uint32_t flipMode,
+			int64_t  flipArg);
+
+		/**
+		 * \brief Marks the end of a frame
+		 *
+		 * Called after a flip, starts or stops capturing
+		 * according to the frame range.
+		 */
+		void nextFrame();
+
+	private:
+		void openFile();
+
+		void closeFile();
+
+		void writeChunkHeader(
+			SceCaptureChunkType type,
+			uint64_t            size);
+
+		uint32_t writeBlob(
+			const void* data,
+			size_t      size);
+
+	private:
+		SceCaptureDesc    m_desc      = {};
+		bool              m_enabled   = false;
+		uint64_t          m_frame     = 0;
+		std::atomic<bool> m_capturing = { false };
+
+		std::mutex    m_mutex;
+		std::ofstream m_file;
+		// Blobs by hash, and a copy of their content, so that
+		// a blob is only reused when the bytes are the same.
+		std::unordered_multimap<uint64_t, uint32_t> m_blobs;
+		std::vector<std::vector<uint8_t>>           m_blobData;
+		uint32_t                                    m_blobCount    = 0;
+		uint64_t                                    m_blobBytes    = 0;
+		uint32_t                                    m_submitCount  = 0;
+		bool                                        m_videoOutDone = false;
+	};
+
+}  // namespace sce
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "SceCommon.h"
+#include "SceVideoOut/sce_videoout_types.h"
+
+namespace sce
+{
+	/*
+	 * PM4 capture file layout
+	 *
+	 * The file starts with a SceCaptureFileHeader, followed by
+	 * chunks. Each chunk is a SceCaptureChunkHeader followed by
+	 * chunk data of the given size, so a reader can skip chunk
+	 * types it doesn't know.
+	 *
+	 * Chunks are written in the order the guest issued the calls.
+	 * Guest memory content is stored once per distinct content
+	 * in blob chunks, a blob must appear before the first submit
+	 * chunk referring to it. Blobs are indexed in file order.
+	 */
+
+	constexpr uint32_t SceCaptureMagic   = 0x5041'4347;  // 'GCAP'
+	constexpr uint32_t SceCaptureVersion = 1;
+
+	constexpr uint32_t SceCaptureMaxDisplayBuffers = 16;
+
+	enum class SceCaptureChunkType : uint32_t
+	{
+		// SceCaptureBlob, followed by blob content.
+		Blob = 0,
+		// SceCaptureVideoOut
+		VideoOut = 1,
+		// SceCaptureSubmit, followed by commandCount SceCaptureCommand
+		// and rangeCount SceCaptureRange.
+		Submit = 2,
+	};
+
+	struct SceCaptureFileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+	};
+
+	struct SceCaptureChunkHeader
+	{
+		SceCaptureChunkType type;
+		uint32_t            reserved;
+		uint64_t            size;
+	};
+
+	struct SceCaptureBlob
+	{
+		uint64_t hash;
+		uint64_t size;
+	};
+
+	struct SceCaptureVideoOut
+	{
+		uint32_t                   handle;
+		int32_t                    busType;
+		uint32_t                   bufferCount;
+		uint32_t                   reserved;
+		SceVideoOutBufferAttribute attribute;
+		uint64_t                   addresses[SceCaptureMaxDisplayBuffers];
+	};
+
+	struct SceCaptureSubmit
+	{
+		uint32_t queueType;  // SceQueueType
+		uint32_t vqueueId;   // Compute queue only
+		uint32_t commandCount;
+		uint32_t rangeCount;
+		// Graphics queue only,
+		// parameters of submitAndFlipCommandBuffers.
+		uint32_t videoOutHandle;
+		uint32_t displayBufferIndex;
+		uint32_t flipMode;
+		uint32_t reserved;
+		int64_t  flipArg;
+	};
+
+	struct SceCaptureCommand
+	{
+		uint64_t address;
+		uint32_t size;
+		uint32_t reserved;
+	};
+
+	/**
+	 * \brief Guest memory range
+	 *
+	 * Content of the range at the time it was first
+	 * referenced during processing of the submission.
+	 */
+	struct SceCaptureRange
+	{
+		uint64_t address;
+		uint64_t size;
+		uint32_t blob;
+		uint32_t reserved;
+	};
+
+}  // namespace sce
@@ -1,32 +1,124 @@
 #include "SceComputeQueue.h"
+#include "SceCapture.h"
+#include "SceGnmDriver.h"
 #include "SceGpuQueue.h"
+#include "Emulator.h"
+#include "ThreadAffinity.h"
+#include "VirtualGPU.h"
 #include "Violet/VltDevice.h"
 #include "Violet/VltCmdList.h"
 
+#include <atomic>
+
 namespace sce
 {
 
 	SceComputeQueue::SceComputeQueue(
 		vlt::VltDevice* device,
+		uint32_t        vqueueId,
 		void*           ringBaseAddr,
 		uint32_t        ringSizeInDW,
 		void*           readPtrAddr):
+		m_vqueueId(vqueueId),
 		m_ringBegin(reinterpret_cast<uint32_t*>(ringBaseAddr)),
 		m_ringEnd(m_ringBegin + ringSizeInDW),
 		m_ringCmd(m_ringBegin),
 		m_offsetPtr(reinterpret_cast<uint32_t*>(readPtrAddr)),
-		m_queue(std::make_unique<SceGpuQueue>(device, SceQueueType::Compute))
+		m_queue(std::make_unique<SceGpuQueue>(device, SceQueueType::Compute, getVQueuePipeId(vqueueId)))
 	{
 		*m_offsetPtr = 0;
+
+		m_thread = std::thread([this]
+							   { runConsumer(); });
 	}
 
 	SceComputeQueue::~SceComputeQueue()
 	{
+		// Commands already published are
+		// processed before the thread exits.
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stopped = true;
+		}
+		m_doorbellCond.notify_one();
+
+		m_thread.join();
 	}
 
 	void SceComputeQueue::dingDong(uint32_t nextStartOffsetInDw)
 	{
-		std::lock_guard<std::mutex> lock(m_mutex);
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_doorbells.push(nextStartOffsetInDw);
+			++m_published;
+		}
+		m_doorbellCond.notify_one();
+	}
+
+	void SceComputeQueue::synchronize()
+	{
+		// Doorbells rung after this point are not waited for,
+		// so a busy ring can't hold the caller indefinitely.
+		std::unique_lock<std::mutex> lock(m_mutex);
+		uint64_t published = m_published;
+		m_retiredCond.wait(lock, [this, published]
+						   { return m_retired >= published; });
+	}
+
+	void SceComputeQueue::runConsumer()
+	{
+		// Keep the consumer off the cores given to the game.
+		TheEmulator().affinity().bindEmulatorThread();
+
+		std::vector<uint32_t> doorbells;
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (true)
+		{
+			m_doorbellCond.wait(lock, [this]
+								{ return !m_doorbells.empty() || m_stopped; });
+
+			if (m_doorbells.empty())
+			{
+				break;
+			}
+
+			// Take all pending doorbells, so that commands
+			// published while we were busy go into one submission.
+			while (!m_doorbells.empty())
+			{
+				doorbells.push_back(m_doorbells.front());
+				m_doorbells.pop();
+			}
+			uint64_t count = doorbells.size();
+
+			lock.unlock();
+
+			for (uint32_t offset : doorbells)
+			{
+				recordCommands(offset);
+			}
+			doorbells.clear();
+
+			submitCommand();
+
+			// Submission is synchronous, the commands have retired.
+			std::atomic_thread_fence(std::memory_order_release);
+			*reinterpret_cast<volatile uint32_t*>(m_offsetPtr) =
+				static_cast<uint32_t>(m_ringCmd - m_ringBegin);
+
+			lock.lock();
+
+			m_retired += count;
+			m_retiredCond.notify_all();
+		}
+	}
+
+	void SceComputeQueue::recordCommands(uint32_t nextStartOffsetInDw)
+	{
+		// Capture records the submission of the calling thread.
+		auto& capture = GPU().capture();
+		capture.beginSubmit(SceQueueType::Compute, m_vqueueId);
 
 		uint32_t* nextCmd = m_ringBegin + nextStartOffsetInDw;
 
@@ -34,10 +126,7 @@ namespace sce
 		{
 			// Normal case,
 			// execute command in range [m_ringCmd, nextCmd]
-			SceGpuCommand cmd = {};
-			cmd.buffer        = m_ringCmd;
-			cmd.size          = static_cast<uint32_t>(nextCmd - m_ringCmd) * sizeof(uint32_t);
-			m_queue->record(cmd);
+			recordSegment(m_ringCmd, nextCmd);
 		}
 		else
 		{
@@ -46,25 +135,29 @@ namespace sce
 
 			if (m_ringCmd != m_ringEnd)
 			{
-				SceGpuCommand cmd = {};
-				cmd.buffer        = m_ringCmd;
-				cmd.size          = static_cast<uint32_t>(m_ringEnd - m_ringCmd) * sizeof(uint32_t);
-				m_queue->record(cmd);
+				recordSegment(m_ringCmd, m_ringEnd);
 			}
 
 			if (m_ringBegin != nextCmd)
 			{
-				SceGpuCommand cmd = {};
-				cmd.buffer        = m_ringBegin;
-				cmd.size          = static_cast<uint32_t>(nextCmd - m_ringBegin) * sizeof(uint32_t);
-				m_queue->record(cmd);
+				recordSegment(m_ringBegin, nextCmd);
 			}
 		}
 
-		submitCommand();
+		capture.endSubmit(0, 0, 0, 0);
+
+		m_ringCmd = nextCmd;
+	}
 
-		m_ringCmd    = nextCmd;
-		*m_offsetPtr = static_cast<uint32_t>(m_ringCmd - m_ringBegin);
+	void SceComputeQueue::recordSegment(
+		const uint32_t* begin,
+		const uint32_t* end)
+	{
+		SceGpuCommand cmd = {};
+		cmd.buffer        = begin;
+		cmd.size          = static_cast<uint32_t>(end - begin) * sizeof(uint32_t);
+		GPU().capture().addCommand(cmd.buffer, cmd.size);
+		m_queue->record(cmd);
 	}
 
 	void SceComputeQueue::submitCommand()
@@ -75,4 +168,4 @@ namespace sce
 		m_queue->submit(submission);
 	}
 
-}  // namespace sce
\ No newline at end of file
+}  // namespace sce
@@ -2,8 +2,11 @@
 
 #include "SceCommon.h"
 
+#include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <queue>
+#include <thread>
 #include <vector>
 
 namespace sce
@@ -17,33 +20,72 @@ namespace sce
 
 	/**
 	 * \brief Compute queue
-	 * 
+	 *
 	 * Manage a ring buffer for compute command
 	 * and submit to gpu queue.
+	 *
+	 * Like the hardware queue, commands are consumed
+	 * by a dedicated thread, ringing the doorbell only
+	 * publishes the new write offset. The read pointer
+	 * is advanced once the commands have retired.
 	 */
 	class SceComputeQueue
 	{
 	public:
 		SceComputeQueue(vlt::VltDevice* device,
+						uint32_t        vqueueId,
 						void*           ringBaseAddr,
 						uint32_t        ringSizeInDW,
 						void*           readPtrAddr);
 		~SceComputeQueue();
 
+		/**
+		 * \brief Rings the doorbell
+		 *
+		 * Returns immediately, commands up to the given
+		 * offset are processed by the consumer thread.
+		 * \param [in] nextStartOffsetInDw Write offset
+		 */
 		void dingDong(uint32_t nextStartOffsetInDw);
 
+		/**
+		 * \brief Waits for commands published before the call
+		 */
+		void synchronize();
+
 	private:
+		void runConsumer();
+
+		void recordCommands(uint32_t nextStartOffsetInDw);
+
+		void recordSegment(
+			const uint32_t* begin,
+			const uint32_t* end);
+
 		void submitCommand();
 
 	private:
+		uint32_t  m_vqueueId;
 		uint32_t* m_ringBegin;
 		uint32_t* m_ringEnd;
 		uint32_t* m_ringCmd;
 		uint32_t* m_offsetPtr;
 
-		std::mutex                   m_mutex;
 		std::unique_ptr<SceGpuQueue> m_queue;
+
+		// Write offsets of doorbells not consumed yet,
+		// kept one by one because an offset equal to
+		// the read offset means a full ring.
+		std::mutex              m_mutex;
+		std::condition_variable m_doorbellCond;
+		std::condition_variable m_retiredCond;
+		std::queue<uint32_t>    m_doorbells;
+		uint64_t                m_published = 0;
+		uint64_t                m_retired   = 0;
+		bool                    m_stopped   = false;
+
+		std::thread m_thread;
 	};
 
 
-}  // namespace sce
\ No newline at end of file
+}  // namespace sce
@@ -0,0 +1,249 @@
+#include "SceFlipBench.h"
+#include "SceFlipQueue.h"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <utility>
+
+LOG_CHANNEL(Graphic.Sce.SceFlipBench);
+
+namespace sce
+{
+	constexpr uint32_t FlipBenchRefreshRate = 60;
+	constexpr uint64_t FlipBenchSecond      = 1000000000;
+
+	// Tsc in nanoseconds, so that statuses read as times.
+	static SceFlipQueueDesc makeBenchDesc(uint32_t refreshRate, uint32_t queueDepth)
+	{
+		SceFlipQueueDesc desc = {};
+		desc.refreshRate      = refreshRate;
+		desc.queueDepth       = queueDepth;
+		desc.tscFrequency     = FlipBenchSecond;
+		return desc;
+	}
+
+	SceFlipBench::SceFlipBench(const SceFlipBenchDesc& desc) :
+		m_desc(desc)
+	{
+	}
+
+	SceFlipBench::~SceFlipBench()
+	{
+	}
+
+	bool SceFlipBench::run()
+	{
+		bool ret = false;
+		do
+		{
+			if (m_desc.frameCount < 2)
+			{
+				std::printf("Nothing to run, at least 2 frames are needed.\n");
+				break;
+			}
+
+			if (!checkQueue())
+			{
+				std::printf("Flip queue check failed.\n");
+				break;
+			}
+
+			std::printf("Frames         : %u per test, vblank at %u Hz on a virtual clock\n",
+						m_desc.frameCount, FlipBenchRefreshRate);
+
+			if (!runVirtual(60) || !runVirtual(30) || !runVirtual(20))
+			{
+				break;
+			}
+
+			if (m_desc.realtimeFrameCount != 0 && !runRealtime())
+			{
+				break;
+			}
+
+			ret = true;
+		} while (false);
+		return ret;
+	}
+
+	bool SceFlipBench::checkQueue()
+	{
+		SceFlipQueue queue(makeBenchDesc(FlipBenchRefreshRate, 2));
+		queue.setFlipRate(30);
+
+		uint64_t time   = 0;
+		auto     vblank = [&queue, &time]()
+		{
+			time += queue.vblankTime(1);
+			queue.vblank(time);
+			return queue.getFlipStatus();
+		};
+
+		bool passed = true;
+
+		// Two flips fit, the third doesn't.
+		passed &= queue.submitFlip(0, SCE_VIDEO_OUT_FLIP_MODE_VSYNC, 100, time);
+		passed &= queue.submitFlip(1, SCE_VIDEO_OUT_FLIP_MODE_VSYNC, 101, time);
+		passed &= !queue.submitFlip(0, SCE_VIDEO_OUT_FLIP_MODE_VSYNC, 102, time);
+		passed &= queue.pendingCount() == 2;
+
+		// At 30 fps flips retire every second vblank.
+		auto status = vblank();
+		passed &= status.count == 1 && status.flipArg == 100 && status.flipPendingNum == 1;
+		status = vblank();
+		passed &= status.count == 1 && status.currentBuffer == 0;
+		status = vblank();
+		passed &= status.count == 2 && status.flipArg == 101 && status.currentBuffer == 1;
+		passed &= status.tsc == time;
+
+		// Hsync flips go out at once, multi vsync
+		// flips all retire at the next vblank.
+		passed &= queue.submitFlip(-1, SCE_VIDEO_OUT_FLIP_MODE_HSYNC, 103, time);
+		status = queue.getFlipStatus();
+		passed &= status.count == 3 && status.currentBuffer == -1;
+		passed &= queue.submitFlip(0, SCE_VIDEO_OUT_FLIP_MODE_VSYNC_MULTI, 104, time);
+		passed &= queue.submitFlip(1, SCE_VIDEO_OUT_FLIP_MODE_VSYNC_MULTI, 105, time);
+		status = vblank();
+		passed &= status.count == 5 && status.flipArg == 105 && status.flipPendingNum == 0;
+
+		passed &= queue.getVblankStatus().count == 4;
+		return passed;
+	}
+
+	bool SceFlipBench::runVirtual(uint32_t flipRate)
+	{
+		bool     ret        = false;
+		uint64_t flipPeriod = FlipBenchSecond / flipRate;
+
+		// The game waits for its previous flip before queueing
+		// the next one, like a double buffered swapchain.
+		auto simulate = [this, flipRate, flipPeriod](uint32_t refreshRate)
+		{
+			SceFlipQueue queue(makeBenchDesc(refreshRate, 2));
+			queue.setFlipRate(flipRate);
+
+			uint64_t time   = 0;
+			uint64_t vblank = 1;
+			auto     runTo  = [&queue, &vblank](uint64_t end)
+			{
+				while (queue.vblankTime(vblank) <= end)
+				{
+					queue.vblank(queue.vblankTime(vblank++));
+				}
+			};
+
+			m_seed = 1;
+			for (uint32_t frame = 0; frame != m_desc.frameCount; ++frame)
+			{
+				time += frameWorkTime(frame, flipPeriod);
+				if (refreshRate != 0)
+				{
+					runTo(time);
+					while (queue.pendingCount() != 0)
+					{
+						time = queue.vblankTime(vblank);
+						runTo(time);
+					}
+				}
+				queue.submitFlip(frame % 2, SCE_VIDEO_OUT_FLIP_MODE_VSYNC, frame, time);
+			}
+
+			while (queue.pendingCount() != 0)
+			{
+				runTo(queue.vblankTime(vblank));
+			}
+
+			auto stats = queue.getFrameStats();
+			auto last  = queue.getFlipStatus().flipArg;
+			return std::make_pair(stats, last);
+		};
+
+		do
+		{
+			auto paced   = simulate(FlipBenchRefreshRate);
+			auto unpaced = simulate(0);
+
+			// Whole vblanks per flip.
+			uint64_t minPeriod = FlipBenchSecond * (FlipBenchRefreshRate / flipRate) / FlipBenchRefreshRate;
+
+			char name[32] = {};
+			std::snprintf(name, sizeof(name), "%u fps paced", flipRate);
+			printStats(name, paced.first);
+			std::snprintf(name, sizeof(name), "%u fps unpaced", flipRate);
+			printStats(name, unpaced.first);
+
+			// Every frame was flipped, in order, and
+			// no flip came sooner than the flip rate allows.
+			int64_t lastArg = m_desc.frameCount - 1;
+			if (paced.first.flipCount != m_desc.frameCount || paced.second != lastArg ||
+				unpaced.first.flipCount != m_desc.frameCount || unpaced.second != lastArg ||
+				paced.first.minNs < minPeriod)
+			{
+				std::printf("Flips at %u fps are wrong.\n", flipRate);
+				break;
+			}
+
+			ret = true;
+		} while (false);
+		return ret;
+	}
+
+	bool SceFlipBench::runRealtime()
+	{
+		uint64_t flipPeriod = FlipBenchSecond / FlipBenchRefreshRate;
+
+		SceFlipQueue queue(makeBenchDesc(FlipBenchRefreshRate, 2));
+		queue.start();
+
+		m_seed = 1;
+		for (uint32_t frame = 0; frame != m_desc.realtimeFrameCount; ++frame)
+		{
+			std::this_thread::sleep_for(std::chrono::nanoseconds(frameWorkTime(frame, flipPeriod)));
+			while (queue.pendingCount() != 0)
+			{
+				queue.waitVblank();
+			}
+			queue.submitFlip(frame % 2, SCE_VIDEO_OUT_FLIP_MODE_VSYNC, frame, SceFlipQueue::now());
+		}
+
+		while (queue.pendingCount() != 0)
+		{
+			queue.waitVblank();
+		}
+		queue.stop();
+
+		auto stats = queue.getFrameStats();
+		std::printf("Host clock     : %u frames at %u fps\n", m_desc.realtimeFrameCount, FlipBenchRefreshRate);
+		printStats("60 fps paced", stats);
+		std::printf("  %-14s: %.3f ms avg, %.3f ms max\n", "vblank late",
+					stats.meanLatenessNs / 1000000.0, stats.maxLatenessNs / 1000000.0);
+
+		return stats.flipCount == m_desc.realtimeFrameCount;
+	}
+
+	uint64_t SceFlipBench::frameWorkTime(uint32_t frame, uint64_t flipPeriod)
+	{
+		// 70% of the flip period, +-25%, and a hitch of one and
+		// a half more every 37 frames, longer than the one frame
+		// the game can run ahead.
+		m_seed          = m_seed * 1664525 + 1013904223;
+		double jitter   = (m_seed >> 8) / double(1 << 24) * 0.5 - 0.25;
+		double workTime = flipPeriod * (0.7 + jitter);
+		if (frame % 37 == 36)
+		{
+			workTime += flipPeriod * 1.5;
+		}
+		return static_cast<uint64_t>(workTime);
+	}
+
+	void SceFlipBench::printStats(const char* name, const SceFrameStats& stats)
+	{
+		std::printf("  %-14s: %.3f ms avg, %.3f ms stddev, %.3f - %.3f ms, %llu missed\n",
+					name,
+					stats.meanNs / 1000000.0, stats.stdDevNs / 1000000.0,
+					stats.minNs / 1000000.0, stats.maxNs / 1000000.0,
+					stats.missedCount);
+	}
+
+}  // namespace sce
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "SceCommon.h"
+
+namespace sce
+{
+	struct SceFrameStats;
+
+	struct SceFlipBenchDesc
+	{
+		// Number of frames flipped by each test.
+		uint32_t frameCount;
+		// Frames of the test on the host clock, 0 to skip it.
+		uint32_t realtimeFrameCount;
+	};
+
+	/**
+	 * \brief Flip queue frame pacing benchmark
+	 *
+	 * A simulated game renders frames of varying length and
+	 * flips them through a flip queue at 60, 30 and 20 fps.
+	 * Vblanks come from a virtual clock, so the results are
+	 * exact and the test takes no time. The same frames
+	 * flipped without pacing show the variance removed.
+	 *
+	 * Optionally the vblank thread is run on the host clock
+	 * to also report how late it wakes up.
+	 */
+	class SceFlipBench
+	{
+	public:
+		SceFlipBench(const SceFlipBenchDesc& desc);
+		~SceFlipBench();
+
+		bool run();
+
+	private:
+		bool checkQueue();
+
+		bool runVirtual(uint32_t flipRate);
+
+		bool runRealtime();
+
+		uint64_t frameWorkTime(uint32_t frame, uint64_t flipPeriod);
+
+		void printStats(const char* name, const SceFrameStats& stats);
+
+	private:
+		SceFlipBenchDesc m_desc;
+		uint32_t         m_seed = 0;
+	};
+
+}  // namespace sce
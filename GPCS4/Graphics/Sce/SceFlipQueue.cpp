@@ -0,0 +1,332 @@
+#include "SceFlipQueue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+LOG_CHANNEL(Graphic.Sce.SceFlipQueue);
+
+namespace sce
+{
+	// The vblank thread sleeps until this long before a vblank
+	// and yields for the rest, host sleeps are not that precise.
+	constexpr uint64_t VblankSpinTimeNs = 1000000;
+
+	constexpr uint64_t NanosecondsPerSecond = 1000000000;
+
+	SceFlipQueue::SceFlipQueue(const SceFlipQueueDesc& desc) :
+		m_desc(desc)
+	{
+		m_desc.queueDepth          = std::max(m_desc.queueDepth, 1u);
+		m_flipStatus.currentBuffer = -1;
+		setFlipRate(60);
+	}
+
+	SceFlipQueue::~SceFlipQueue()
+	{
+		stop();
+	}
+
+	void SceFlipQueue::start()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_running && m_desc.refreshRate != 0)
+		{
+			m_running = true;
+			m_thread  = std::thread([this]()
+									{ runVblank(); });
+		}
+	}
+
+	void SceFlipQueue::stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_running = false;
+			m_cond.notify_all();
+		}
+
+		if (m_thread.joinable())
+		{
+			m_thread.join();
+		}
+	}
+
+	uint64_t SceFlipQueue::now()
+	{
+		auto time = std::chrono::steady_clock::now().time_since_epoch();
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+	}
+
+	void SceFlipQueue::setFlipRate(uint32_t rate)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_flipRate     = std::max(rate, 1u);
+		m_flipInterval = std::max((m_desc.refreshRate + m_flipRate / 2) / m_flipRate, 1u);
+	}
+
+	uint32_t SceFlipQueue::getFlipRate() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_flipRate;
+	}
+
+	bool SceFlipQueue::submitFlip(
+		int32_t  bufferIndex,
+		uint32_t flipMode,
+		int64_t  flipArg,
+		uint64_t time)
+	{
+		bool ret = false;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			do
+			{
+				if (m_pending.size() >= m_desc.queueDepth)
+				{
+					break;
+				}
+
+				Flip flip        = {};
+				flip.bufferIndex = bufferIndex;
+				flip.flipMode    = flipMode;
+				flip.flipArg     = flipArg;
+				flip.submitTime  = time;
+
+				// Nothing paces flips without vblanks, and hsync
+				// flips go out at once unless others are ahead.
+				bool immediate = m_desc.refreshRate == 0 ||
+								 (flipMode == SCE_VIDEO_OUT_FLIP_MODE_HSYNC && m_pending.empty());
+				if (immediate)
+				{
+					retireFlip(flip, time);
+				}
+				else
+				{
+					m_pending.push_back(flip);
+				}
+
+				ret = true;
+			} while (false);
+		}
+		triggerFlips();
+		return ret;
+	}
+
+	void SceFlipQueue::waitFlipSlot()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_cond.wait(lock, [this]()
+					{ return !m_running || m_pending.size() < m_desc.queueDepth; });
+	}
+
+	void SceFlipQueue::waitVblank()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		if (m_running)
+		{
+			uint64_t count = m_vblankStatus.count;
+			m_cond.wait(lock, [this, count]()
+						{ return !m_running || m_vblankStatus.count != count; });
+		}
+		else
+		{
+			// No one else would ever signal it.
+			lock.unlock();
+			vblank(now());
+		}
+	}
+
+	void SceFlipQueue::vblank(uint64_t time)
+	{
+		uint64_t count = 0;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			count                      = ++m_vblankStatus.count;
+			m_vblankStatus.processTime = time / 1000;
+			m_vblankStatus.tsc         = toTsc(time);
+
+			bool rateDue = m_flipStatus.count == 0 ||
+						   count - m_lastFlipVblank >= m_flipInterval;
+			while (!m_pending.empty())
+			{
+				const auto& flip = m_pending.front();
+				bool        free = isRateFree(flip);
+				if (!free && !rateDue)
+				{
+					break;
+				}
+
+				retireFlip(flip, time);
+				rateDue = rateDue && free;
+				m_pending.pop_front();
+			}
+
+			m_cond.notify_all();
+		}
+
+		triggerFlips();
+		m_vblankEvent.Trigger(SCE_VIDEO_OUT_EVENT_VBLANK, count);
+	}
+
+	uint64_t SceFlipQueue::vblankTime(uint64_t index) const
+	{
+		return m_desc.refreshRate != 0 ? index * NanosecondsPerSecond / m_desc.refreshRate : 0;
+	}
+
+	uint32_t SceFlipQueue::pendingCount() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return static_cast<uint32_t>(m_pending.size());
+	}
+
+	SceVideoOutFlipStatus SceFlipQueue::getFlipStatus() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		SceVideoOutFlipStatus status = m_flipStatus;
+		status.flipPendingNum        = static_cast<int32_t>(m_pending.size());
+		return status;
+	}
+
+	SceVideoOutVblankStatus SceFlipQueue::getVblankStatus() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_vblankStatus;
+	}
+
+	SceFrameStats SceFlipQueue::getFrameStats() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		SceFrameStats stats = {};
+		stats.flipCount     = m_flipStatus.count;
+		stats.minNs         = m_frameMin;
+		stats.maxNs         = m_frameMax;
+		stats.missedCount   = m_missedCount;
+		stats.maxLatenessNs = m_latenessMax;
+		if (m_frameCount != 0)
+		{
+			stats.meanNs   = m_frameSum / m_frameCount;
+			stats.stdDevNs = std::sqrt(std::max(m_frameSumSq / m_frameCount - stats.meanNs * stats.meanNs, 0.0));
+		}
+		if (m_wakeCount != 0)
+		{
+			stats.meanLatenessNs = m_latenessSum / m_wakeCount;
+		}
+		return stats;
+	}
+
+	CSceEventSource& SceFlipQueue::flipEvent()
+	{
+		return m_flipEvent;
+	}
+
+	CSceEventSource& SceFlipQueue::vblankEvent()
+	{
+		return m_vblankEvent;
+	}
+
+	void SceFlipQueue::runVblank()
+	{
+		uint64_t start = now();
+		uint64_t index = 1;
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (m_running)
+		{
+			uint64_t target = start + vblankTime(index);
+			auto     sleep  = std::chrono::nanoseconds(target - VblankSpinTimeNs);
+			auto     wake   = std::chrono::steady_clock::time_point(
+				std::chrono::duration_cast<std::chrono::steady_clock::duration>(sleep));
+			if (m_cond.wait_until(lock, wake, [this]()
+								  { return !m_running; }))
+			{
+				break;
+			}
+			lock.unlock();
+
+			uint64_t time = now();
+			while (time < target)
+			{
+				std::this_thread::yield();
+				time = now();
+			}
+
+			vblank(time);
+
+			lock.lock();
+			uint64_t lateness = time - target;
+			m_latenessSum += static_cast<double>(lateness);
+			m_latenessMax = std::max(m_latenessMax, lateness);
+			++m_wakeCount;
+
+			// Vblanks missed while this thread didn't run are
+			// skipped rather than caught up in a burst.
+			index = std::max(index + 1, (time - start) * m_desc.refreshRate / NanosecondsPerSecond + 1);
+		}
+	}
+
+	bool SceFlipQueue::isRateFree(const Flip& flip) const
+	{
+		return flip.flipMode == SCE_VIDEO_OUT_FLIP_MODE_HSYNC ||
+			   flip.flipMode == SCE_VIDEO_OUT_FLIP_MODE_VSYNC_MULTI;
+	}
+
+	void SceFlipQueue::retireFlip(const Flip& flip, uint64_t time)
+	{
+		if (m_flipStatus.count != 0)
+		{
+			uint64_t frameTime = time - m_lastFlipTime;
+			uint64_t period    = m_desc.refreshRate != 0 ? vblankTime(m_flipInterval)
+														 : NanosecondsPerSecond / m_flipRate;
+
+			m_frameMin = m_frameCount == 0 ? frameTime : std::min(m_frameMin, frameTime);
+			m_frameMax = std::max(m_frameMax, frameTime);
+			m_frameSum += static_cast<double>(frameTime);
+			m_frameSumSq += static_cast<double>(frameTime) * frameTime;
+			m_missedCount += frameTime * 2 > period * 3 ? 1 : 0;
+			++m_frameCount;
+		}
+
+		if (!isRateFree(flip))
+		{
+			m_lastFlipVblank = m_vblankStatus.count;
+		}
+		m_lastFlipTime = time;
+
+		++m_flipStatus.count;
+		m_flipStatus.processTime   = time / 1000;
+		m_flipStatus.tsc           = toTsc(time);
+		m_flipStatus.flipArg       = flip.flipArg;
+		m_flipStatus.submitTsc     = toTsc(flip.submitTime);
+		m_flipStatus.currentBuffer = flip.bufferIndex;
+
+		m_retiredArgs.push_back(flip.flipArg);
+	}
+
+	void SceFlipQueue::triggerFlips()
+	{
+		std::vector<int64_t> retiredArgs;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			retiredArgs.swap(m_retiredArgs);
+		}
+
+		// Events are triggered without the lock held,
+		// waiters may query the status right away.
+		for (auto flipArg : retiredArgs)
+		{
+			m_flipEvent.Trigger(SCE_VIDEO_OUT_EVENT_FLIP, flipArg);
+		}
+	}
+
+	uint64_t SceFlipQueue::toTsc(uint64_t time) const
+	{
+		// Split to not overflow, the frequency is in GHz range.
+		uint64_t seconds = time / NanosecondsPerSecond;
+		uint64_t rest    = time % NanosecondsPerSecond;
+		return m_desc.tscOffset + seconds * m_desc.tscFrequency + rest * m_desc.tscFrequency / NanosecondsPerSecond;
+	}
+
+}  // namespace sce
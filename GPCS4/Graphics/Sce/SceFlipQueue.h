@@ -0,0 +1,196 @@
+#pragma once
+
+#include "SceCommon.h"
+#include "SceVideoOut/sce_videoout_types.h"
+#include "SceLibkernel/SceEventQueue.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace sce
+{
+	struct SceFlipQueueDesc
+	{
+		// Vblanks per second, 0 means flips are
+		// processed as soon as they are submitted.
+		uint32_t refreshRate;
+		// Number of flips which can be pending at once.
+		uint32_t queueDepth;
+		// Ticks per second of the tsc in flip and vblank status.
+		uint64_t tscFrequency;
+		// Tsc at steady clock time 0, wraps around
+		// if the tsc started after the steady clock.
+		uint64_t tscOffset;
+	};
+
+	/**
+	 * \brief Frame pacing of processed flips
+	 *
+	 * Frame times are the intervals between two flips.
+	 */
+	struct SceFrameStats
+	{
+		uint64_t flipCount;
+		double   meanNs;
+		double   stdDevNs;
+		uint64_t minNs;
+		uint64_t maxNs;
+		// Frames which took longer than one and a half flip periods.
+		uint64_t missedCount;
+		// How late the vblank thread woke up.
+		double   meanLatenessNs;
+		uint64_t maxLatenessNs;
+	};
+
+	/**
+	 * \brief Flip queue of a video out port
+	 *
+	 * Flips are queued by the game and retired at vblank,
+	 * at most one per flip period, e.g. every second vblank
+	 * at 30 fps. Flips in hsync or multi vsync mode don't wait
+	 * for the flip rate, several may retire in one vblank.
+	 *
+	 * Vblanks come from a thread on the host clock once
+	 * started, or else from whoever calls vblank(), so that
+	 * the queue can be driven headlessly on a virtual clock.
+	 * Times are in nanoseconds in both cases.
+	 */
+	class SceFlipQueue
+	{
+	public:
+		SceFlipQueue(const SceFlipQueueDesc& desc);
+		~SceFlipQueue();
+
+		/**
+		 * \brief Starts the vblank thread
+		 *
+		 * Does nothing if the refresh rate is 0.
+		 */
+		void start();
+
+		void stop();
+
+		/**
+		 * \brief Host time the vblank thread runs on
+		 */
+		static uint64_t now();
+
+		/**
+		 * \brief Sets flips per second
+		 *
+		 * Rounded to a whole number of vblanks per flip.
+		 */
+		void setFlipRate(uint32_t rate);
+
+		uint32_t getFlipRate() const;
+
+		/**
+		 * \brief Queues a flip
+		 *
+		 * \param [in] bufferIndex Display buffer, -1 to flip to blank
+		 * \param [in] flipMode SceVideoOutFlipMode
+		 * \param [in] time Submit time
+		 * \returns False if the queue is full
+		 */
+		bool submitFlip(
+			int32_t  bufferIndex,
+			uint32_t flipMode,
+			int64_t  flipArg,
+			uint64_t time);
+
+		/**
+		 * \brief Waits until a flip can be queued
+		 *
+		 * Returns at once when there's no vblank thread,
+		 * nothing would retire the pending flips.
+		 */
+		void waitFlipSlot();
+
+		/**
+		 * \brief Waits for the next vblank
+		 */
+		void waitVblank();
+
+		/**
+		 * \brief Processes one vblank
+		 *
+		 * Retires the flips which are due and
+		 * triggers flip and vblank events.
+		 * \param [in] time Time of the vblank
+		 */
+		void vblank(uint64_t time);
+
+		/**
+		 * \brief Time of a vblank since the first one
+		 */
+		uint64_t vblankTime(uint64_t index) const;
+
+		uint32_t pendingCount() const;
+
+		SceVideoOutFlipStatus getFlipStatus() const;
+
+		SceVideoOutVblankStatus getVblankStatus() const;
+
+		SceFrameStats getFrameStats() const;
+
+		CSceEventSource& flipEvent();
+
+		CSceEventSource& vblankEvent();
+
+	private:
+		struct Flip
+		{
+			int32_t  bufferIndex;
+			uint32_t flipMode;
+			int64_t  flipArg;
+			uint64_t submitTime;
+		};
+
+		void runVblank();
+
+		bool isRateFree(const Flip& flip) const;
+
+		void retireFlip(const Flip& flip, uint64_t time);
+
+		void triggerFlips();
+
+		uint64_t toTsc(uint64_t time) const;
+
+	private:
+		SceFlipQueueDesc m_desc;
+
+		mutable std::mutex      m_mutex;
+		std::condition_variable m_cond;
+		std::deque<Flip>        m_pending;
+		uint32_t                m_flipRate = 60;
+		// Vblanks between two flips.
+		uint32_t                m_flipInterval = 1;
+
+		SceVideoOutFlipStatus   m_flipStatus   = {};
+		SceVideoOutVblankStatus m_vblankStatus = {};
+		uint64_t                m_lastFlipVblank = 0;
+		uint64_t                m_lastFlipTime   = 0;
+		// Args of retired flips whose events are not triggered yet.
+		std::vector<int64_t>    m_retiredArgs;
+
+		// Frame time sums, for the mean and variance.
+		uint64_t m_frameCount    = 0;
+		double   m_frameSum      = 0.0;
+		double   m_frameSumSq    = 0.0;
+		uint64_t m_frameMin      = 0;
+		uint64_t m_frameMax      = 0;
+		uint64_t m_missedCount   = 0;
+		uint64_t m_wakeCount     = 0;
+		double   m_latenessSum   = 0.0;
+		uint64_t m_latenessMax   = 0;
+
+		bool        m_running = false;
+		std::thread m_thread;
+
+		CSceEventSource m_flipEvent;
+		CSceEventSource m_vblankEvent;
+	};
+
+}  // namespace sce
@@ -1,7 +1,9 @@
 #include "SceGnmDriver.h"
 
 #include "Emulator.h"
+#include "HleProfiler.h"
 #include "VirtualGPU.h"
+#include "SceCapture.h"
 #include "SceVideoOut.h"
 #include "SceGpuQueue.h"
 #include "SceComputeQueue.h"
@@ -9,6 +11,7 @@
 #include "SceResourceTracker.h"
 #include "SceLabelManager.h"
 #include "UtilMath.h"
+#include "UtilProfiler.h"
 #include "sce_errors.h"
 
 #include "Gnm/GnmCommandBufferDraw.h"
@@ -28,9 +31,9 @@ namespace sce
 	using namespace vlt;
 	using namespace Gnm;
 
-	SceGnmDriver::SceGnmDriver()
+	SceGnmDriver::SceGnmDriver(bool headless)
 	{
-		bool success = initGnmDriver();
+		bool success = initGnmDriver(headless);
 		LOG_ASSERT(success == true, "init Gnm Driver failed.");
 	}
 
@@ -39,12 +42,12 @@ namespace sce
 		destroyGpuQueues();
 	}
 
-	bool SceGnmDriver::initGnmDriver()
+	bool SceGnmDriver::initGnmDriver(bool headless)
 	{
 		bool ret = false;
 		do
 		{
-			if (!createVltDevice())
+			if (!createVltDevice(headless))
 			{
 				LOG_ERR("create vlt device failed.");
 				break;
@@ -57,12 +60,12 @@ namespace sce
 		return ret;
 	}
 
-	bool SceGnmDriver::createVltDevice()
+	bool SceGnmDriver::createVltDevice(bool headless)
 	{
 		bool ret = false;
 		do
 		{
-			m_instance = new VltInstance();
+			m_instance = new VltInstance(headless);
 
 			// adapters are ranked internally by their power
 			// typically first one is the most powerful GPU in system
@@ -135,17 +138,60 @@ namespace sce
 		// and use it as render target.
 		trackRenderTarget(displayBufferIndex);
 
+		auto& capture = GPU().capture();
+		if (capture.isCapturing() && videoOutHandle != 0)
+		{
+			capture.recordVideoOut(videoOutHandle, GPU().videoOutGet(videoOutHandle));
+		}
+		capture.beginSubmit(SceQueueType::Graphics, 0);
+
 		SceGpuCommand cmd = {};
 		cmd.buffer        = dcbGpuAddrs[0];
 		cmd.size          = dcbSizesInBytes[0];
+		capture.addCommand(cmd.buffer, cmd.size);
 		m_graphicsQueue->record(cmd);
 
+		capture.endSubmit(videoOutHandle, displayBufferIndex, flipMode, flipArg);
+
 		submitPresent(displayBufferIndex);
 
+		// Presentation is synchronous, but the flip is retired at vblank
+		// like on hardware, waiting for room in the flip queue paces the game.
+		if (videoOutHandle != 0)
+		{
+			auto& flipQueue = GPU().videoOutGet(videoOutHandle).flipQueue();
+			while (!flipQueue.submitFlip(displayBufferIndex, flipMode, flipArg, SceFlipQueue::now()))
+			{
+				flipQueue.waitFlipSlot();
+			}
+		}
+
+		if (m_flipInterrupt)
+		{
+			m_flipInterrupt = false;
+			triggerEqEvent(kEqEventGfxEop);
+		}
+
 		downloadResource();
+
+		// Compute queues record against the same resource tracker.
+		// Only doorbells rung before the flip are waited for, rings
+		// with nothing pending return without blocking.
+		for (auto& compQueue : m_computeQueues)
+		{
+			if (compQueue)
+			{
+				compQueue->synchronize();
+			}
+		}
+
 		// clear resource tracker every frame
 		cleanupFrame();
 
+		util::prof::nextFrame();
+		HleProfiler::GetInstance()->nextFrame();
+		capture.nextFrame();
+
 		return SCE_OK;
 	}
 
@@ -163,6 +209,34 @@ namespace sce
 		m_swapchain->present(imageIndex);
 	}
 
+	CSceEventSource* SceGnmDriver::eqEvent(Gnm::EqEventType type)
+	{
+		CSceEventSource* source = nullptr;
+		if (type == kEqEventGfxEop)
+		{
+			source = &m_eqEvents[MaxPipeId];
+		}
+		else if (type < MaxPipeId)
+		{
+			source = &m_eqEvents[type];
+		}
+		return source;
+	}
+
+	void SceGnmDriver::triggerEqEvent(Gnm::EqEventType type)
+	{
+		auto source = eqEvent(type);
+		if (source)
+		{
+			source->Trigger(type, 0);
+		}
+	}
+
+	void SceGnmDriver::requestFlipInterrupt()
+	{
+		m_flipInterrupt = true;
+	}
+
 	int SceGnmDriver::sceGnmSubmitDone(void)
 	{
 		// Gnm::submitDone() is the place to hint the PS4 OS that
@@ -173,7 +247,10 @@ namespace sce
 		// to process the window event.
 		// Currently I didn't find a very good place, so I place it here.
 		
-		glfwPollEvents();
+		if (!m_instance->isHeadless())
+		{
+			glfwPollEvents();
+		}
 
 		// TODO:
 		// Execute the Gnm::DrawCommandBuffer::InitializeDefaultHardwareState command.
@@ -185,7 +262,7 @@ namespace sce
 	{
 		// Create the only graphics queue.
 		m_graphicsQueue = std::make_unique<SceGpuQueue>(
-			m_device.ptr(), SceQueueType::Graphics);
+			m_device.ptr(), SceQueueType::Graphics, 0);
 	}
 
 	uint32_t SceGnmDriver::mapComputeQueue(uint32_t pipeId,
@@ -227,15 +304,12 @@ namespace sce
 				break;
 			}
 
-			vqueueId = VQueueIdBegin + pipeId * MaxPipeId + queueId;
-			if (vqueueId >= MaxComputeQueueCount)
-			{
-				LOG_ERR("vqueueId is larger than max queue count.");
-				break;
-			}
-
+			// Queues of a pipe are numbered together,
+			// so the pipe can be told from the id.
+			vqueueId                     = VQueueIdBegin + pipeId * MaxQueueId + queueId;
 			uint32_t vqueueIndex         = vqueueId - VQueueIdBegin;
 			m_computeQueues[vqueueIndex] = std::make_unique<SceComputeQueue>(m_device.ptr(),
+																			 vqueueId,
 																			 ringBaseAddr,
 																			 ringSizeInDW,
 																			 readPtrAddr);
@@ -248,13 +322,13 @@ namespace sce
 	{
 		do
 		{
-			if (vqueueId >= MaxComputeQueueCount)
+			uint32_t vqueueIndex = vqueueId - VQueueIdBegin;
+			if (vqueueIndex >= MaxComputeQueueCount)
 			{
 				LOG_ERR("vqueueId is larger than max queue count.");
 				break;
 			}
 
-			uint32_t vqueueIndex = vqueueId - VQueueIdBegin;
 			m_computeQueues[vqueueIndex].reset();
 
 		} while (false);
@@ -265,6 +339,9 @@ namespace sce
 		uint32_t nextStartOffsetInDw)
 	{
 		uint32_t vqueueIndex = vqueueId - VQueueIdBegin;
+
+		// Returns immediately like the hardware doorbell,
+		// the queue's own thread consumes the ring.
 		m_computeQueues[vqueueIndex]->dingDong(nextStartOffsetInDw);
 	}
 
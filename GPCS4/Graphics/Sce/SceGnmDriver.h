@@ -1,6 +1,8 @@
 #pragma once
 
 #include "SceCommon.h"
+#include "Gnm/GnmConstant.h"
+#include "SceLibkernel/SceEventQueue.h"
 
 #include "Violet/VltRc.h"
 
@@ -33,12 +35,19 @@ namespace sce
 	constexpr uint32_t MaxQueueId           = 8;
 	constexpr uint32_t MaxComputeQueueCount = MaxPipeId * MaxQueueId;
 
+	// Compute pipe a vqueue id is mapped on.
+	constexpr uint32_t getVQueuePipeId(uint32_t vqueueId)
+	{
+		return (vqueueId - VQueueIdBegin) / MaxQueueId;
+	}
+
 	class SceGnmDriver
 	{
 		friend class VirtualGPU;
 		friend class SceVideoOut;
+		friend class SceReplayer;
 	public:
-		SceGnmDriver();
+		SceGnmDriver(bool headless);
 		~SceGnmDriver();
 
 		/// Graphics
@@ -76,10 +85,37 @@ namespace sce
 			uint32_t vqueueId,
 			uint32_t nextStartOffsetInDw);
 
+		/// Events
+
+		/**
+		 * \brief Gets the event source of an eq event
+		 *
+		 * \param [in] type Eq event type
+		 * \returns The event source, or nullptr for an invalid type
+		 */
+		CSceEventSource* eqEvent(Gnm::EqEventType type);
+
+		/**
+		 * \brief Triggers an eq event
+		 *
+		 * Called when the GPU reaches an interrupt,
+		 * from any thread.
+		 * \param [in] type Eq event type
+		 */
+		void triggerEqEvent(Gnm::EqEventType type);
+
+		/**
+		 * \brief Requests an EOP interrupt after flip
+		 *
+		 * The interrupt is raised once the current
+		 * flip submission has been presented.
+		 */
+		void requestFlipInterrupt();
+
 	private:
-		bool initGnmDriver();
+		bool initGnmDriver(bool headless);
 
-		bool createVltDevice();
+		bool createVltDevice(bool headless);
 
 		void createSwapchain(
 			SceVideoOut*         videoOut,
@@ -106,6 +142,10 @@ namespace sce
 				   MaxComputeQueueCount> m_computeQueues;
 
 		std::unique_ptr<SceSwapchain> m_swapchain;
+
+		// Compute pipe release mem events, then the gfx EOP event.
+		std::array<CSceEventSource, MaxPipeId + 1> m_eqEvents;
+		bool                                       m_flipInterrupt = false;
 	};
 
 }  // namespace sce
\ No newline at end of file
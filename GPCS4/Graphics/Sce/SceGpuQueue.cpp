@@ -16,10 +16,11 @@ namespace sce
 
 	SceGpuQueue::SceGpuQueue(
 		vlt::VltDevice* device,
-		SceQueueType    type) :
+		SceQueueType    type,
+		uint32_t        pipeId) :
 		m_device(device)
 	{
-		createQueue(type);
+		createQueue(type, pipeId);
 	}
 
 	SceGpuQueue::~SceGpuQueue()
@@ -33,10 +34,16 @@ namespace sce
 
 	void SceGpuQueue::submit(const SceGpuSubmission& submission)
 	{
-		m_device->submitCommandList(
+		VkResult status = m_device->submitCommandList(
 			m_cmd->finalize(),
 			submission.wait,
 			submission.wake);
+		if (status == VK_ERROR_DEVICE_LOST)
+		{
+			// Most likely caused by the packets just recorded.
+			LOG_ERR("device lost while executing a command buffer.");
+			m_cp->dumpTrace();
+		}
 	}
 
 	void SceGpuQueue::synchronize()
@@ -44,7 +51,7 @@ namespace sce
 		m_device->syncSubmission();
 	}
 
-	void SceGpuQueue::createQueue(SceQueueType type)
+	void SceGpuQueue::createQueue(SceQueueType type, uint32_t pipeId)
 	{
 		m_cp = std::make_unique<GnmCommandProcessor>();
 
@@ -54,7 +61,7 @@ namespace sce
 		}
 		else
 		{
-			m_cmd = std::make_unique<GnmCommandBufferDispatch>(m_device);
+			m_cmd = std::make_unique<GnmCommandBufferDispatch>(m_device, pipeId);
 		}
 
 #ifdef GPCS4_NO_GRAPHICS
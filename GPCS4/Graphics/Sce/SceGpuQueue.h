@@ -43,9 +43,17 @@ namespace sce
 	class SceGpuQueue
 	{
 	public:
+		/**
+		 * \brief Creates a queue
+		 *
+		 * \param pipeId Compute pipe the queue is mapped on,
+		 *               release mem events are reported on it.
+		 *               0 for the graphics queue.
+		 */
 		SceGpuQueue(
 			vlt::VltDevice* device,
-			SceQueueType    type);
+			SceQueueType    type,
+			uint32_t        pipeId);
 		~SceGpuQueue();
 
 		/**
@@ -69,7 +77,7 @@ namespace sce
 		void synchronize();
 
 	private:
-		void createQueue(SceQueueType type);
+		void createQueue(SceQueueType type, uint32_t pipeId);
 
 	private:
 		vlt::VltDevice* m_device;
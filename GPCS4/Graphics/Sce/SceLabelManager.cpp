@@ -1,4 +1,7 @@
 #include "SceLabelManager.h"
+#include "SceCapture.h"
+#include "Emulator.h"
+#include "VirtualGPU.h"
 
 #include "Gnm/GnmGpuLabel.h"
 #include "Violet/VltDevice.h"
@@ -24,6 +27,10 @@ namespace sce
 	{
 		LOG_ASSERT(labelAddress != nullptr, "null label address passed.");
 
+		// Labels are written and waited on by the command buffer,
+		// the memory must exist when replaying a capture.
+		GPU().capture().captureMemory(labelAddress, sizeof(uint64_t));
+
 		std::lock_guard<util::sync::Spinlock> guard(m_lock);
 		GnmGpuLabel* label = nullptr;
 
@@ -0,0 +1,201 @@
+#include "SceOffscreenPresenter.h"
+
+#include "Violet/VltBuffer.h"
+#include "Violet/VltContext.h"
+#include "Violet/VltDevice.h"
+#include "Violet/VltFormat.h"
+#include "Violet/VltImage.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image/stb_image_write.h>
+
+LOG_CHANNEL(Graphic.Sce.SceOffscreenPresenter);
+
+namespace sce
+{
+	using namespace vlt;
+
+	SceOffscreenPresenter::SceOffscreenPresenter(
+		VltDevice*                    device,
+		const OffscreenPresenterDesc& desc) :
+		m_device(device),
+		m_desc(desc),
+		m_fence(new util::sync::Fence())
+	{
+		m_texelSize = imageFormatInfo(m_desc.imageFormat)->elementSize;
+
+		createImages();
+
+		if (m_desc.dumpInterval != 0)
+		{
+			std::filesystem::create_directories(m_desc.dumpPath);
+		}
+	}
+
+	SceOffscreenPresenter::~SceOffscreenPresenter()
+	{
+		// Frames still in flight may need a dump.
+		for (auto& image : m_images)
+		{
+			retireImage(image);
+		}
+	}
+
+	void SceOffscreenPresenter::presentImage(
+		VltContext*         ctx,
+		const Rc<VltImage>& image)
+	{
+		auto& target = m_images.at(m_imageIndex);
+		retireImage(target);
+
+		VkImageSubresourceLayers subresource;
+		subresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+		subresource.mipLevel       = 0;
+		subresource.baseArrayLayer = 0;
+		subresource.layerCount     = 1;
+
+		VkExtent3D extent = image->mipLevelExtent(0);
+		extent.width      = std::min(extent.width, m_desc.imageExtent.width);
+		extent.height     = std::min(extent.height, m_desc.imageExtent.height);
+
+		ctx->copyImageToBuffer(
+			target.buffer, 0,
+			m_desc.imageExtent,
+			image, subresource,
+			VkOffset3D{ 0, 0, 0 }, extent);
+
+		target.fenceValue = ++m_fenceValue;
+		ctx->signal(m_fence, target.fenceValue);
+
+		// Only dump frames that the user is interested in,
+		// the others are discarded to keep the overhead low.
+		target.frame       = m_frameCount;
+		target.dumpPending = m_desc.dumpInterval != 0 &&
+							 m_frameCount % m_desc.dumpInterval == 0;
+	}
+
+	void SceOffscreenPresenter::finishPresent()
+	{
+		updateFrameStats();
+
+		m_frameCount += 1;
+		m_imageIndex += 1;
+		m_imageIndex %= m_images.size();
+	}
+
+	uint64_t SceOffscreenPresenter::frameCount() const
+	{
+		return m_frameCount;
+	}
+
+	void SceOffscreenPresenter::createImages()
+	{
+		VltBufferCreateInfo info;
+		info.size   = m_desc.imageExtent.width * m_desc.imageExtent.height * m_texelSize;
+		info.usage  = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		info.stages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		info.access = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+		uint32_t imageCount = std::max(m_desc.imageCount, 1u);
+		m_images.resize(imageCount);
+		for (auto& image : m_images)
+		{
+			image.buffer = m_device->createBuffer(info,
+												  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+													  VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		}
+	}
+
+	void SceOffscreenPresenter::retireImage(OffscreenImage& image)
+	{
+		m_fence->wait(image.fenceValue);
+
+		if (image.dumpPending)
+		{
+			dumpImage(image.buffer, image.frame);
+			image.dumpPending = false;
+		}
+	}
+
+	void SceOffscreenPresenter::dumpImage(
+		const Rc<VltBuffer>& image,
+		uint64_t             frame)
+	{
+		constexpr uint32_t PngChannels = 4;
+
+		do
+		{
+			if (m_texelSize != PngChannels)
+			{
+				LOG_WARN("only 32 bit display buffer can be dumped, format %d", m_desc.imageFormat);
+				break;
+			}
+
+			uint32_t width  = m_desc.imageExtent.width;
+			uint32_t height = m_desc.imageExtent.height;
+
+			std::vector<uint8_t> pixels(width * height * PngChannels);
+			std::memcpy(pixels.data(), image->mapPtr(0), pixels.size());
+
+			bool isBgra = m_desc.imageFormat == VK_FORMAT_B8G8R8A8_UNORM ||
+						  m_desc.imageFormat == VK_FORMAT_B8G8R8A8_SRGB;
+			for (size_t i = 0; i != pixels.size(); i += PngChannels)
+			{
+				if (isBgra)
+				{
+					std::swap(pixels[i + 0], pixels[i + 2]);
+				}
+				// Display buffers don't carry meaningful alpha.
+				pixels[i + 3] = 0xFF;
+			}
+
+			char fileName[64] = {};
+			std::snprintf(fileName, sizeof(fileName), "frame_%06llu.png", frame);
+			auto filePath = std::filesystem::path(m_desc.dumpPath) / fileName;
+
+			if (!stbi_write_png(filePath.string().c_str(),
+								width, height, PngChannels,
+								pixels.data(), width * PngChannels))
+			{
+				LOG_WARN("dump frame %llu failed.", frame);
+				break;
+			}
+		} while (false);
+	}
+
+	void SceOffscreenPresenter::updateFrameStats()
+	{
+		auto now = std::chrono::steady_clock::now();
+		if (m_frameCount != 0)
+		{
+			double frameTime = std::chrono::duration<double, std::milli>(now - m_lastPresent).count();
+
+			m_frameTimeSum   += frameTime;
+			m_frameTimeCount += 1;
+			m_frameTimeMin   = m_frameTimeMin == 0.0 ? frameTime : std::min(m_frameTimeMin, frameTime);
+			m_frameTimeMax   = std::max(m_frameTimeMax, frameTime);
+		}
+		m_lastPresent = now;
+
+		if (m_frameTimeCount == FrameStatInterval)
+		{
+			// Headless runs are measured by this, print it in every build.
+			std::printf("frame %llu, avg %.3f ms, min %.3f ms, max %.3f ms\n",
+						static_cast<unsigned long long>(m_frameCount),
+						m_frameTimeSum / m_frameTimeCount,
+						m_frameTimeMin,
+						m_frameTimeMax);
+
+			m_frameTimeSum   = 0.0;
+			m_frameTimeCount = 0;
+			m_frameTimeMin   = 0.0;
+			m_frameTimeMax   = 0.0;
+		}
+	}
+
+}  // namespace sce
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "SceCommon.h"
+
+#include "Violet/VltRc.h"
+#include "UtilSync.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace sce
+{
+	namespace vlt
+	{
+		class VltDevice;
+		class VltContext;
+		class VltBuffer;
+		class VltImage;
+	}  // namespace vlt
+
+	/**
+     * \brief Offscreen presenter description
+     */
+	struct OffscreenPresenterDesc
+	{
+		VkExtent2D  imageExtent;
+		VkFormat    imageFormat;
+		uint32_t    imageCount;
+		// Dump every Nth frame, 0 to discard all frames.
+		uint32_t    dumpInterval;
+		std::string dumpPath;
+	};
+
+	/**
+     * \brief Offscreen presenter
+     *
+     * Used in headless mode, when there's no window
+     * surface to present to. Display buffers are
+     * copied into a ring of host-visible images,
+     * which can then be dumped to disk or discarded.
+     */
+	class SceOffscreenPresenter : public vlt::RcObject
+	{
+		constexpr static uint32_t FrameStatInterval = 300;
+
+	public:
+		SceOffscreenPresenter(
+			vlt::VltDevice*               device,
+			const OffscreenPresenterDesc& desc);
+
+		virtual ~SceOffscreenPresenter();
+
+		/**
+         * \brief Records presentation commands
+         *
+         * Copies the image into the next host-visible
+         * image in the ring. The image must be in it's
+         * default layout. Waits for the previous frame
+         * copied into the same image, and dumps it if
+         * necessary.
+         * \param [in] ctx Context
+         * \param [in] image Image to present
+         */
+		void presentImage(
+			vlt::VltContext*              ctx,
+			const vlt::Rc<vlt::VltImage>& image);
+
+		/**
+         * \brief Finishes presentation
+         *
+         * Must be called after the command list recorded
+         * by \ref presentImage is submitted. Advances the
+         * ring without waiting for the GPU.
+         */
+		void finishPresent();
+
+		/**
+         * \brief Number of presented frames
+         */
+		uint64_t frameCount() const;
+
+	private:
+		struct OffscreenImage
+		{
+			vlt::Rc<vlt::VltBuffer> buffer;
+			// Fence value of the last copy into the buffer.
+			uint64_t fenceValue  = 0;
+			uint64_t frame       = 0;
+			bool     dumpPending = false;
+		};
+
+		void createImages();
+
+		void retireImage(OffscreenImage& image);
+
+		void dumpImage(
+			const vlt::Rc<vlt::VltBuffer>& image,
+			uint64_t                       frame);
+
+		void updateFrameStats();
+
+	private:
+		vlt::VltDevice*        m_device;
+		OffscreenPresenterDesc m_desc;
+		VkDeviceSize           m_texelSize = 0;
+
+		std::vector<OffscreenImage> m_images;
+
+		vlt::Rc<util::sync::Fence> m_fence;
+		uint64_t                   m_fenceValue = 0;
+
+		uint32_t m_imageIndex = 0;
+		uint64_t m_frameCount = 0;
+
+		std::chrono::steady_clock::time_point m_lastPresent;
+		uint32_t                              m_frameTimeCount = 0;
+		double                                m_frameTimeSum   = 0.0;
+		double                                m_frameTimeMin   = 0.0;
+		double                                m_frameTimeMax   = 0.0;
+	};
+
+}  // namespace sce
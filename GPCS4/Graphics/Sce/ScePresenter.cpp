@@ -65,7 +65,11 @@ namespace sce
 		info.pImageIndices      = &m_imageIndex;
 		info.pResults           = nullptr;
 
-		VkResult status = vkQueuePresentKHR(m_device.queue, &info);
+		VkResult status = VK_SUCCESS;
+		{
+			std::lock_guard<std::mutex> lock(*m_device.queueLock);
+			status = vkQueuePresentKHR(m_device.queue, &info);
+		}
 
 		m_frameIndex += 1;
 		m_frameIndex %= m_semaphores.size();
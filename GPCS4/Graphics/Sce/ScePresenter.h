@@ -4,6 +4,8 @@
 
 #include "Violet/VltRc.h"
 
+#include <mutex>
+
 namespace sce
 {
 	/**
@@ -17,6 +19,8 @@ namespace sce
 		VkDevice device = VK_NULL_HANDLE;
 		// Present queue
 		VkQueue queue = VK_NULL_HANDLE;
+		// Lock of the present queue, shared with submissions to it
+		std::mutex* queueLock = nullptr;
 		// Window surface to present to
 		VkSurfaceKHR surface = VK_NULL_HANDLE;
 	};
@@ -0,0 +1,503 @@
+#include "SceReplayer.h"
+#include "SceGnmDriver.h"
+#include "SceGpuQueue.h"
+#include "SceVideoOut.h"
+
+#include "Emulator.h"
+#include "Platform.h"
+#include "VirtualGPU.h"
+#include "sce_errors.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+LOG_CHANNEL(Graphic.Sce.SceReplayer);
+
+namespace sce
+{
+	namespace
+	{
+		struct MemoryRegion
+		{
+			uint64_t begin;
+			uint64_t end;
+		};
+
+		void addRegion(
+			std::vector<MemoryRegion>& regions,
+			uint64_t                   address,
+			uint64_t                   size)
+		{
+			constexpr uint64_t PageMask = plat::VM_PAGE_SIZE - 1;
+
+			MemoryRegion region;
+			region.begin = address & ~PageMask;
+			region.end   = (address + size + PageMask) & ~PageMask;
+			regions.push_back(region);
+		}
+
+		// Bytes per pixel of a display buffer.
+		uint32_t getPixelSize(SceVideoOutPixelFormat pixelFormat)
+		{
+			uint32_t size = sizeof(uint32_t);
+			switch (pixelFormat)
+			{
+			case SCE_VIDEO_OUT_PIXEL_FORMAT_B16_G16_R16_A16_FLOAT:
+				size = sizeof(uint64_t);
+				break;
+			default:
+				break;
+			}
+			return size;
+		}
+	}  // namespace
+
+	SceReplayer::SceReplayer(const SceReplayDesc& desc) :
+		m_desc(desc)
+	{
+		m_desc.loopCount = std::max(desc.loopCount, 1u);
+	}
+
+	SceReplayer::~SceReplayer()
+	{
+		m_computeQueues.clear();
+		unmapMemory();
+	}
+
+	bool SceReplayer::run()
+	{
+		bool ret = false;
+		do
+		{
+			if (!loadCapture())
+			{
+				break;
+			}
+
+			if (!mapMemory())
+			{
+				break;
+			}
+
+			if (!openVideoOut())
+			{
+				break;
+			}
+
+			std::printf("Replaying %zu submissions, %u times.\n",
+						m_submissions.size(), m_desc.loopCount);
+
+			auto begin = std::chrono::steady_clock::now();
+
+			for (uint32_t loop = 0; loop != m_desc.loopCount; ++loop)
+			{
+				double frameTime = 0.0;
+				for (const auto& submission : m_submissions)
+				{
+					// Restoring memory is not part of the frame.
+					restoreMemory(submission);
+
+					auto submitBegin = std::chrono::steady_clock::now();
+					replaySubmission(submission);
+					auto submitEnd = std::chrono::steady_clock::now();
+
+					frameTime += std::chrono::duration<double, std::milli>(submitEnd - submitBegin).count();
+
+					bool isFlip = submission.info.queueType == static_cast<uint32_t>(SceQueueType::Graphics) &&
+								  submission.info.videoOutHandle != 0;
+					if (isFlip)
+					{
+						m_frameTimes.push_back(frameTime);
+						frameTime = 0.0;
+					}
+				}
+			}
+
+			auto   end      = std::chrono::steady_clock::now();
+			double wallTime = std::chrono::duration<double, std::milli>(end - begin).count();
+
+			printSummary(wallTime);
+
+			ret = true;
+		} while (false);
+		return ret;
+	}
+
+	bool SceReplayer::loadCapture()
+	{
+		bool ret = false;
+		do
+		{
+			std::ifstream fin(m_desc.path, std::ios::binary | std::ios::ate);
+			if (!fin)
+			{
+				std::printf("Failed to open capture %s.\n", m_desc.path.c_str());
+				break;
+			}
+
+			size_t fileSize = fin.tellg();
+			m_data.resize(fileSize);
+			fin.seekg(0);
+			fin.read(reinterpret_cast<char*>(m_data.data()), fileSize);
+
+			SceCaptureFileHeader fileHeader = {};
+			if (!fin || fileSize < sizeof(fileHeader))
+			{
+				std::printf("Failed to read capture %s.\n", m_desc.path.c_str());
+				break;
+			}
+
+			std::memcpy(&fileHeader, m_data.data(), sizeof(fileHeader));
+			if (fileHeader.magic != SceCaptureMagic ||
+				fileHeader.version != SceCaptureVersion)
+			{
+				std::printf("%s is not a capture file or was written by another version.\n", m_desc.path.c_str());
+				break;
+			}
+
+			bool   valid  = true;
+			size_t offset = sizeof(fileHeader);
+			while (valid && offset != fileSize)
+			{
+				SceCaptureChunkHeader header = {};
+				if (fileSize - offset < sizeof(header))
+				{
+					valid = false;
+					break;
+				}
+
+				std::memcpy(&header, m_data.data() + offset, sizeof(header));
+				offset += sizeof(header);
+
+				if (fileSize - offset < header.size)
+				{
+					valid = false;
+					break;
+				}
+
+				valid = parseChunk(header, m_data.data() + offset);
+				offset += header.size;
+			}
+
+			if (!valid)
+			{
+				std::printf("Capture %s is truncated or corrupted.\n", m_desc.path.c_str());
+				break;
+			}
+
+			if (!m_hasVideoOut)
+			{
+				// The graphics queue presents to the video out.
+				std::printf("Capture %s has no video out, nothing to replay.\n", m_desc.path.c_str());
+				break;
+			}
+
+			ret = true;
+		} while (false);
+		return ret;
+	}
+
+	bool SceReplayer::parseChunk(
+		const SceCaptureChunkHeader& header,
+		const uint8_t*               data)
+	{
+		bool ret = false;
+		do
+		{
+			switch (header.type)
+			{
+				case SceCaptureChunkType::Blob:
+				{
+					SceCaptureBlob blobHeader = {};
+					if (header.size < sizeof(blobHeader))
+					{
+						break;
+					}
+					std::memcpy(&blobHeader, data, sizeof(blobHeader));
+
+					if (header.size - sizeof(blobHeader) != blobHeader.size)
+					{
+						break;
+					}
+
+					Blob blob;
+					blob.data = data + sizeof(blobHeader);
+					blob.size = blobHeader.size;
+					m_blobs.push_back(blob);
+
+					ret = true;
+				}
+				break;
+				case SceCaptureChunkType::VideoOut:
+				{
+					if (header.size != sizeof(SceCaptureVideoOut))
+					{
+						break;
+					}
+					std::memcpy(&m_videoOut, data, sizeof(SceCaptureVideoOut));
+					m_hasVideoOut = true;
+
+					ret = true;
+				}
+				break;
+				case SceCaptureChunkType::Submit:
+				{
+					Submission submission;
+					if (header.size < sizeof(submission.info))
+					{
+						break;
+					}
+					std::memcpy(&submission.info, data, sizeof(submission.info));
+
+					size_t commandSize = sizeof(SceCaptureCommand) * submission.info.commandCount;
+					size_t rangeSize   = sizeof(SceCaptureRange) * submission.info.rangeCount;
+					if (header.size != sizeof(submission.info) + commandSize + rangeSize)
+					{
+						break;
+					}
+
+					submission.commands.resize(submission.info.commandCount);
+					submission.ranges.resize(submission.info.rangeCount);
+					std::memcpy(submission.commands.data(), data + sizeof(submission.info), commandSize);
+					std::memcpy(submission.ranges.data(), data + sizeof(submission.info) + commandSize, rangeSize);
+
+					// Blobs always precede the submission using them.
+					bool blobsValid = std::all_of(submission.ranges.begin(), submission.ranges.end(),
+												  [this](const SceCaptureRange& range)
+												  { return range.blob < m_blobs.size() &&
+														   m_blobs[range.blob].size == range.size; });
+					if (!blobsValid)
+					{
+						break;
+					}
+
+					m_submissions.push_back(std::move(submission));
+
+					ret = true;
+				}
+				break;
+				default:
+					// Unknown chunk from a newer writer, skip it.
+					ret = true;
+					break;
+			}
+		} while (false);
+		return ret;
+	}
+
+	bool SceReplayer::mapMemory()
+	{
+		bool ret = false;
+		do
+		{
+			std::vector<MemoryRegion> regions;
+			for (const auto& submission : m_submissions)
+			{
+				for (const auto& range : submission.ranges)
+				{
+					addRegion(regions, range.address, range.size);
+				}
+			}
+
+			// Display buffers are written when frames are
+			// downloaded, they may never be captured.
+			const auto& attribute         = m_videoOut.attribute;
+			uint64_t    displayBufferSize = uint64_t(attribute.pitchInPixel) * attribute.height *
+										 getPixelSize((SceVideoOutPixelFormat)attribute.pixelFormat);
+			for (uint32_t i = 0; i != m_videoOut.bufferCount; ++i)
+			{
+				addRegion(regions, m_videoOut.addresses[i], displayBufferSize);
+			}
+
+			std::sort(regions.begin(), regions.end(),
+					  [](const MemoryRegion& a, const MemoryRegion& b)
+					  { return a.begin < b.begin; });
+
+			std::vector<MemoryRegion> merged;
+			for (const auto& region : regions)
+			{
+				if (!merged.empty() && region.begin <= merged.back().end)
+				{
+					merged.back().end = std::max(merged.back().end, region.end);
+				}
+				else
+				{
+					merged.push_back(region);
+				}
+			}
+
+			bool     mapped    = true;
+			uint64_t totalSize = 0;
+			for (const auto& region : merged)
+			{
+				void* address = reinterpret_cast<void*>(region.begin);
+				void* memory  = plat::VMAllocate(address, region.end - region.begin,
+												 plat::VMAT_RESERVE_COMMIT_WATCH, plat::VMPF_CPU_RW);
+				if (memory != address)
+				{
+					std::printf("Failed to map guest memory at %p, size 0x%llx.\n",
+								address, static_cast<unsigned long long>(region.end - region.begin));
+					if (memory != nullptr)
+					{
+						plat::VMFree(memory);
+					}
+					mapped = false;
+					break;
+				}
+
+				m_mappings.push_back(memory);
+				totalSize += region.end - region.begin;
+			}
+
+			if (!mapped)
+			{
+				break;
+			}
+
+			std::printf("Mapped %zu guest memory regions, %llu bytes.\n",
+						merged.size(), static_cast<unsigned long long>(totalSize));
+
+			ret = true;
+		} while (false);
+		return ret;
+	}
+
+	void SceReplayer::unmapMemory()
+	{
+		for (auto memory : m_mappings)
+		{
+			plat::VMFree(memory);
+		}
+		m_mappings.clear();
+	}
+
+	bool SceReplayer::openVideoOut()
+	{
+		bool ret = false;
+		do
+		{
+			auto& gpu    = GPU();
+			int   handle = gpu.videoOutOpen(0, m_videoOut.busType, 0, nullptr);
+			if (SCE_ERROR_IS_FAILURE(handle))
+			{
+				std::printf("Failed to open video out, bus type %d.\n", m_videoOut.busType);
+				break;
+			}
+			m_videoOutHandle = handle;
+
+			std::vector<void*> addresses(m_videoOut.bufferCount);
+			for (uint32_t i = 0; i != m_videoOut.bufferCount; ++i)
+			{
+				addresses[i] = reinterpret_cast<void*>(m_videoOut.addresses[i]);
+			}
+
+			auto& videoOut = gpu.videoOutGet(m_videoOutHandle);
+			if (!videoOut.registerDisplayrBuffers(0, addresses.data(), m_videoOut.bufferCount, &m_videoOut.attribute))
+			{
+				std::printf("Failed to register display buffers.\n");
+				break;
+			}
+
+			ret = true;
+		} while (false);
+		return ret;
+	}
+
+	void SceReplayer::restoreMemory(const Submission& submission)
+	{
+		for (const auto& range : submission.ranges)
+		{
+			const auto& blob = m_blobs[range.blob];
+			std::memcpy(reinterpret_cast<void*>(range.address), blob.data, blob.size);
+		}
+	}
+
+	void SceReplayer::replaySubmission(const Submission& submission)
+	{
+		const auto& info = submission.info;
+		if (info.queueType == static_cast<uint32_t>(SceQueueType::Graphics))
+		{
+			LOG_ASSERT(info.commandCount == 1, "graphics submission must have exactly one command buffer.");
+
+			void*    dcb     = reinterpret_cast<void*>(submission.commands[0].address);
+			uint32_t dcbSize = submission.commands[0].size;
+
+			auto& driver = GPU().gnmDriver();
+			if (info.videoOutHandle != 0)
+			{
+				driver.submitAndFlipCommandBuffers(1, &dcb, &dcbSize, nullptr, nullptr,
+												   m_videoOutHandle,
+												   info.displayBufferIndex,
+												   info.flipMode,
+												   info.flipArg);
+			}
+			else
+			{
+				driver.submitCommandBuffers(1, &dcb, &dcbSize, nullptr, nullptr);
+			}
+		}
+		else
+		{
+			replayCompute(submission);
+		}
+	}
+
+	void SceReplayer::replayCompute(const Submission& submission)
+	{
+		// The ring state of a compute queue is not captured,
+		// so we feed the captured ring slices directly
+		// to a queue of the same type.
+		auto& queue = m_computeQueues[submission.info.vqueueId];
+		if (!queue)
+		{
+			auto& driver = GPU().gnmDriver();
+			queue        = std::make_unique<SceGpuQueue>(driver.m_device.ptr(),
+															 SceQueueType::Compute,
+															 getVQueuePipeId(submission.info.vqueueId));
+		}
+
+		for (const auto& command : submission.commands)
+		{
+			SceGpuCommand cmd = {};
+			cmd.buffer        = reinterpret_cast<const void*>(command.address);
+			cmd.size          = command.size;
+			queue->record(cmd);
+		}
+
+		SceGpuSubmission gpuSubmission = {};
+		gpuSubmission.wait             = VK_NULL_HANDLE;
+		gpuSubmission.wake             = VK_NULL_HANDLE;
+		queue->submit(gpuSubmission);
+	}
+
+	void SceReplayer::printSummary(double wallTime)
+	{
+		std::printf("Frames            : %zu\n", m_frameTimes.size());
+
+		if (!m_frameTimes.empty())
+		{
+			auto times = m_frameTimes;
+			std::sort(times.begin(), times.end());
+
+			double total = 0.0;
+			for (double time : times)
+			{
+				total += time;
+			}
+
+			double average = total / times.size();
+			std::printf("Frame time (ms)   : avg %.3f, p50 %.3f, p95 %.3f, max %.3f\n",
+						average,
+						times[times.size() / 2],
+						times[times.size() * 95 / 100],
+						times.back());
+			std::printf("Frame rate        : %.1f fps\n", 1000.0 / average);
+		}
+
+		std::printf("Wall time         : %.1f ms\n", wallTime);
+	}
+
+}  // namespace sce
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "SceCommon.h"
+#include "SceCaptureFile.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sce
+{
+	class SceGpuQueue;
+
+	struct SceReplayDesc
+	{
+		// Capture file written by SceCapture.
+		std::string path;
+		// Replay the whole capture N times.
+		uint32_t loopCount;
+	};
+
+	/**
+	 * \brief PM4 capture replayer
+	 *
+	 * Maps the captured guest memory back at its original
+	 * addresses and feeds the captured command buffers to the
+	 * same queues the game would submit to, so that frames can
+	 * be benchmarked reproducibly without running the game.
+	 *
+	 * Memory referenced by a submission is restored right before
+	 * it is replayed, thus every loop starts from the same state.
+	 */
+	class SceReplayer
+	{
+		struct Blob
+		{
+			const uint8_t* data;
+			size_t         size;
+		};
+
+		struct Submission
+		{
+			SceCaptureSubmit               info;
+			std::vector<SceCaptureCommand> commands;
+			std::vector<SceCaptureRange>   ranges;
+		};
+
+	public:
+		SceReplayer(const SceReplayDesc& desc);
+		~SceReplayer();
+
+		/**
+		 * \brief Runs the replay
+		 * \returns \c true if the capture was replayed
+		 */
+		bool run();
+
+	private:
+		bool loadCapture();
+
+		bool parseChunk(
+			const SceCaptureChunkHeader& header,
+			const uint8_t*               data);
+
+		bool mapMemory();
+
+		void unmapMemory();
+
+		bool openVideoOut();
+
+		void restoreMemory(const Submission& submission);
+
+		void replaySubmission(const Submission& submission);
+
+		void replayCompute(const Submission& submission);
+
+		void printSummary(double wallTime);
+
+	private:
+		SceReplayDesc m_desc;
+
+		std::vector<uint8_t>    m_data;
+		std::vector<Blob>       m_blobs;
+		std::vector<Submission> m_submissions;
+		SceCaptureVideoOut      m_videoOut       = {};
+		bool                    m_hasVideoOut    = false;
+		uint32_t                m_videoOutHandle = 0;
+
+		std::vector<void*> m_mappings;
+
+		std::unordered_map<uint32_t, std::unique_ptr<SceGpuQueue>> m_computeQueues;
+
+		std::vector<double> m_frameTimes;
+	};
+
+}  // namespace sce
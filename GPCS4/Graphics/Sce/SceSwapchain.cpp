@@ -1,5 +1,7 @@
 #include "SceSwapchain.h"
 
+#include "Emulator.h"
+#include "SceOffscreenPresenter.h"
 #include "ScePresenter.h"
 #include "SceSwapchainBlitter.h"
 #include "SceVideoOut.h"
@@ -21,9 +23,16 @@ namespace sce
 		m_context(device.device->createContext()),
 		m_blitter(new SceSwapchainBlitter(device.device))
 	{
-		createPresenter(desc);
+		if (!device.device->instance()->isHeadless())
+		{
+			createPresenter(desc);
 
-		createSwapImageViews();
+			createSwapImageViews();
+		}
+		else
+		{
+			createOffscreenPresenter(desc);
+		}
 
 		createRenderTargets();
 	}
@@ -38,6 +47,18 @@ namespace sce
 	}
 
 	void SceSwapchain::present(uint32_t index)
+	{
+		if (m_offscreenPresenter != nullptr)
+		{
+			presentOffscreen(index);
+		}
+		else
+		{
+			presentWindow(index);
+		}
+	}
+
+	void SceSwapchain::presentWindow(uint32_t index)
 	{
 		auto& device = m_device.device;
 
@@ -77,6 +98,33 @@ namespace sce
 		device->presentImage(m_presenter);
 	}
 
+	void SceSwapchain::presentOffscreen(uint32_t index)
+	{
+		auto& device = m_device.device;
+
+		m_context->beginRecording(
+			device->createCommandList(VltQueueType::Graphics));
+
+		auto& target = m_renderTargets[index];
+
+		// Same as window presentation, the render target
+		// should go back to it's default layout before copy.
+		m_context->transformImage(
+			target.image,
+			target.image->getAvailableSubresources(),
+			VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+		m_offscreenPresenter->presentImage(m_context.ptr(), target.image);
+
+		device->submitCommandList(
+			m_context->endRecording(),
+			VK_NULL_HANDLE,
+			VK_NULL_HANDLE);
+
+		m_offscreenPresenter->finishPresent();
+	}
+
 	void SceSwapchain::createPresenter(const PresenterDesc& desc)
 	{
 		VkInstance      instance = m_device.device->instance()->handle();
@@ -84,11 +132,27 @@ namespace sce
 		device.adapter           = m_device.adapter;
 		device.device            = m_device.device->handle();
 		device.queue             = m_device.device->queues().graphics.queueHandle;
+		device.queueLock         = m_device.device->queues().graphics.queueLock;
 		device.surface           = m_device.videoOut->getSurface(instance);
 
 		m_presenter = new ScePresenter(device, desc);
 	}
 
+	void SceSwapchain::createOffscreenPresenter(const PresenterDesc& desc)
+	{
+		const auto& options   = TheEmulator().options();
+		const auto& attribute = m_device.videoOut->displayBufferAttribute();
+
+		OffscreenPresenterDesc offscreenDesc = {};
+		offscreenDesc.imageExtent            = desc.imageExtent;
+		offscreenDesc.imageFormat            = cvt::convertVideoOutPixelFormat((SceVideoOutPixelFormat)attribute.pixelFormat);
+		offscreenDesc.imageCount             = desc.imageCount;
+		offscreenDesc.dumpInterval           = options.frameDumpInterval;
+		offscreenDesc.dumpPath               = options.frameDumpPath;
+
+		m_offscreenPresenter = new SceOffscreenPresenter(m_device.device, offscreenDesc);
+	}
+
 	void SceSwapchain::createRenderTargets()
 	{
 		// Create display buffer backend render targets
@@ -14,6 +14,7 @@ namespace sce
 	}  // namespace vlt
 
 	class ScePresenter;
+	class SceOffscreenPresenter;
 	class SceSwapchainBlitter;
 	class SceVideoOut;
 	struct PresenterDesc;
@@ -46,9 +47,16 @@ namespace sce
 		void present(uint32_t index);
 
 	private:
+		void presentWindow(uint32_t index);
+
+		void presentOffscreen(uint32_t index);
+
 		void createPresenter(
 			const PresenterDesc& desc);
 
+		void createOffscreenPresenter(
+			const PresenterDesc& desc);
+
 		void createRenderTargets();
 
 		void createSwapImageViews();
@@ -56,8 +64,9 @@ namespace sce
 	private:
 		SceSwapchainDevice m_device;
 
-		vlt::Rc<vlt::VltContext> m_context;
-		vlt::Rc<ScePresenter>    m_presenter;
+		vlt::Rc<vlt::VltContext>       m_context;
+		vlt::Rc<ScePresenter>          m_presenter;
+		vlt::Rc<SceOffscreenPresenter> m_offscreenPresenter;
 
 		std::vector<vlt::Rc<vlt::VltImageView>> m_imageViews;
 		vlt::Rc<SceSwapchainBlitter>            m_blitter;
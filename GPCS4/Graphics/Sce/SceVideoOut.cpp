@@ -3,46 +3,51 @@
 #include "Emulator.h"
 #include "SceGnmDriver.h"
 #include "ScePresenter.h"
+#include "GuestClock.h"
 #include "VirtualGPU.h"
 
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
+LOG_CHANNEL(Graphic.Sce.SceVideoOut);
+
 namespace sce
 {
 
-	VirtualDisplay::VirtualDisplay()
+	VirtualDisplay::VirtualDisplay(bool headless)
 	{
-		glfwInit();
-
-		// for vulkan
-		glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-		// a hardware display shouldn't be resizable of course.
-		// well, a virtual one should be:) ,but currently we just disable resize.
-		glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
-
-		m_window = glfwCreateWindow(VirtualDisplayWidth, VirtualDisplayHeight, GPCS4_APP_NAME, nullptr, nullptr);
-		glfwSetWindowUserPointer(m_window, this);
-
-		glfwSetWindowSizeCallback(m_window, windowResizeCallback);
-		glfwSetFramebufferSizeCallback(m_window, framebufferResizeCallback);
+		// There's no window system on headless machines,
+		// the display is then only a virtual size.
+		if (!headless)
+		{
+			createWindow();
+		}
 	}
 
 	VirtualDisplay::~VirtualDisplay()
 	{
-		glfwDestroyWindow(m_window);
-		glfwTerminate();
+		if (m_window)
+		{
+			glfwDestroyWindow(m_window);
+			glfwTerminate();
+		}
 	}
 
 	void VirtualDisplay::processEvents()
 	{
-		glfwPollEvents();
+		if (m_window)
+		{
+			glfwPollEvents();
+		}
 	}
 
 	DisplaySize VirtualDisplay::getSize() const
 	{
-		DisplaySize result = {};
-		glfwGetFramebufferSize(m_window, (int*)&result.width, (int*)&result.height);
+		DisplaySize result = { VirtualDisplayWidth, VirtualDisplayHeight };
+		if (m_window)
+		{
+			glfwGetFramebufferSize(m_window, (int*)&result.width, (int*)&result.height);
+		}
 		return result;
 	}
 
@@ -50,13 +55,30 @@ namespace sce
 	{
 		// this is the only window surface during the process lifetime
 		// let system destroy the surface when the window is destroied.
-		if (m_windowSurface == VK_NULL_HANDLE)
+		if (m_window && m_windowSurface == VK_NULL_HANDLE)
 		{
 			glfwCreateWindowSurface(instance, m_window, nullptr, &m_windowSurface);
 		}
 		return m_windowSurface;
 	}
 
+	void VirtualDisplay::createWindow()
+	{
+		glfwInit();
+
+		// for vulkan
+		glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+		// a hardware display shouldn't be resizable of course.
+		// well, a virtual one should be:) ,but currently we just disable resize.
+		glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+
+		m_window = glfwCreateWindow(VirtualDisplayWidth, VirtualDisplayHeight, GPCS4_APP_NAME, nullptr, nullptr);
+		glfwSetWindowUserPointer(m_window, this);
+
+		glfwSetWindowSizeCallback(m_window, windowResizeCallback);
+		glfwSetFramebufferSizeCallback(m_window, framebufferResizeCallback);
+	}
+
 	void VirtualDisplay::windowResizeCallback(GLFWwindow* window, int width, int height)
 	{
 	}
@@ -67,13 +89,42 @@ namespace sce
 
 	//////////////////////////////////////////////////////////////////////////
 
-	SceVideoOut::SceVideoOut(int32_t busType, const void* param) :
-		m_busType(busType)
+	// Same as the flip queue of the hardware.
+	constexpr uint32_t SceFlipQueueDepth = 16;
+
+	static SceFlipQueueDesc makeFlipQueueDesc(uint32_t refreshRate)
 	{
+		SceFlipQueueDesc desc = {};
+		desc.refreshRate      = refreshRate;
+		desc.queueDepth       = SceFlipQueueDepth;
+		// Same tsc as sceKernelReadTsc.
+		auto& clock           = TheEmulator().clock();
+		desc.tscFrequency     = clock.tscFrequency();
+		desc.tscOffset        = clock.toTsc(0);
+		return desc;
+	}
+
+	SceVideoOut::SceVideoOut(int32_t busType, const void* param, bool headless, uint32_t refreshRate) :
+		m_display(headless),
+		m_busType(busType),
+		m_flipQueue(makeFlipQueueDesc(refreshRate))
+	{
+		m_flipQueue.start();
 	}
 
 	SceVideoOut::~SceVideoOut()
 	{
+		m_flipQueue.stop();
+
+		auto stats = m_flipQueue.getFrameStats();
+		if (stats.flipCount > 1)
+		{
+			LOG_DEBUG("video out %d: %llu flips, frame time %.3f ms avg, %.3f ms stddev, %.3f - %.3f ms, %llu missed",
+					  m_busType, stats.flipCount,
+					  stats.meanNs / 1000000.0, stats.stdDevNs / 1000000.0,
+					  stats.minNs / 1000000.0, stats.maxNs / 1000000.0,
+					  stats.missedCount);
+		}
 	}
 
 	int32_t SceVideoOut::busType()
@@ -162,12 +213,27 @@ namespace sce
 
 	void SceVideoOut::setFlipRate(uint32_t rate)
 	{
-		m_flipRate = rate;
+		m_flipQueue.setFlipRate(rate);
 	}
 
 	uint32_t SceVideoOut::getFlipRate() const
 	{
-		return m_flipRate;
+		return m_flipQueue.getFlipRate();
+	}
+
+	CSceEventSource& SceVideoOut::flipEvent()
+	{
+		return m_flipQueue.flipEvent();
+	}
+
+	CSceEventSource& SceVideoOut::vblankEvent()
+	{
+		return m_flipQueue.vblankEvent();
+	}
+
+	SceFlipQueue& SceVideoOut::flipQueue()
+	{
+		return m_flipQueue;
 	}
 
 	uint32_t SceVideoOut::calculateBufferSize(const SceVideoOutBufferAttribute* attribute)
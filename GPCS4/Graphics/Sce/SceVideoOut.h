@@ -1,7 +1,9 @@
 #pragma once
 
 #include "SceCommon.h"
+#include "SceFlipQueue.h"
 #include "SceVideoOut/sce_videoout_types.h"
+#include "SceLibkernel/SceEventQueue.h"
 
 #include <vector>
 
@@ -29,7 +31,13 @@ namespace sce
 		const uint32_t VirtualDisplayHeight = 1080;
 
 	public:
-		VirtualDisplay();
+		/**
+	     * \brief Create the display
+	     * 
+	     * \param [in] headless Don't create a window,
+	     *        the display is then only a virtual size.
+	     */
+		VirtualDisplay(bool headless);
 		~VirtualDisplay();
 
 		void processEvents();
@@ -52,6 +60,8 @@ namespace sce
 		VkSurfaceKHR getWindowSurface(VkInstance instance);
 
 	private:
+		void createWindow();
+
 		static void windowResizeCallback(
 			GLFWwindow* window,
 			int         width,
@@ -86,7 +96,11 @@ namespace sce
 	class SceVideoOut
 	{
 	public:
-		SceVideoOut(int32_t busType, const void* param);
+		/**
+		 * \param [in] refreshRate Vblanks per second,
+		 *        0 to not pace flips at all.
+		 */
+		SceVideoOut(int32_t busType, const void* param, bool headless, uint32_t refreshRate);
 		~SceVideoOut();
 
 		int32_t busType();
@@ -113,6 +127,24 @@ namespace sce
 
 		uint32_t getFlipRate() const;
 
+		/**
+		 * \brief Flip event source
+		 *
+		 * Queues registered with sceVideoOutAddFlipEvent
+		 * are triggered once a flip is presented.
+		 */
+		CSceEventSource& flipEvent();
+
+		/**
+		 * \brief Vblank event source
+		 */
+		CSceEventSource& vblankEvent();
+
+		/**
+		 * \brief Flips and vblanks of this port
+		 */
+		SceFlipQueue& flipQueue();
+
 	private:
 		uint32_t calculateBufferSize(
 			const SceVideoOutBufferAttribute* attribute);
@@ -124,11 +156,12 @@ namespace sce
 		VirtualDisplay m_display;
 
 		// SceVideoOutBusType
-		int32_t  m_busType  = 0;
-		uint32_t m_flipRate = 60;
+		int32_t m_busType = 0;
 
 		SceVideoOutBufferAttribute    m_attribute = {};
 		std::vector<SceDisplayBuffer> m_displayBuffers;
+
+		SceFlipQueue m_flipQueue;
 	};
 
 }  // namespace sce
@@ -461,6 +461,12 @@ namespace sce::vlt
 	{
 		VltDeviceExtensions devExtensions;
 
+		// Swapchain is meaningless without a surface to present to.
+		if (instance->isHeadless())
+		{
+			devExtensions.khrSwapchain.setMode(VltExtMode::Disabled);
+		}
+
 		std::array<VltExt*, 4> devExtensionList = { {
 			&devExtensions.extMemoryBudget,
 			&devExtensions.extMemoryPriority,
@@ -2,6 +2,8 @@
 
 #include "VltDevice.h"
 
+#include "UtilProfiler.h"
+
 namespace sce::vlt
 {
 	VltCommandList::VltCommandList(VltDevice* device, VltQueueType queueType) :
@@ -71,6 +73,22 @@ namespace sce::vlt
 			if (vkCreateSemaphore(m_device->handle(), &semInfo, nullptr, &m_transSemaphore) != VK_SUCCESS)
 				Logger::exception("DxvkCommandList: Failed to create semaphore");
 		}
+
+		// Timestamps are written only when profiling,
+		// a begin and an end query per submission.
+		if (m_device->properties().core.properties.limits.timestampComputeAndGraphics)
+		{
+			VkQueryPoolCreateInfo queryInfo;
+			queryInfo.sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			queryInfo.pNext              = nullptr;
+			queryInfo.flags              = 0;
+			queryInfo.queryType          = VK_QUERY_TYPE_TIMESTAMP;
+			queryInfo.queryCount         = 2;
+			queryInfo.pipelineStatistics = 0;
+
+			if (vkCreateQueryPool(m_device->handle(), &queryInfo, nullptr, &m_timestampPool) != VK_SUCCESS)
+				Logger::err("DxvkCommandList: Failed to create timestamp query pool");
+		}
 	}
 
 	VltCommandList::~VltCommandList()
@@ -78,6 +96,7 @@ namespace sce::vlt
 		this->reset();
 
 		vkDestroySemaphore(m_device->handle(), m_transSemaphore, nullptr);
+		vkDestroyQueryPool(m_device->handle(), m_timestampPool, nullptr);
 
 		vkDestroyCommandPool(m_device->handle(), m_execPool, nullptr);
 		vkDestroyCommandPool(m_device->handle(), m_transferPool, nullptr);
@@ -104,7 +123,7 @@ namespace sce::vlt
 			{
 				info.wakeSync.emplace_back(
 					populateSemaphoreSubmit(m_transSemaphore, 0, VK_PIPELINE_STAGE_TRANSFER_BIT));
-				VkResult status = submitToQueue(transfer.queueHandle, VK_NULL_HANDLE, info);
+				VkResult status = submitToQueue(transfer, VK_NULL_HANDLE, info);
 
 				if (status != VK_SUCCESS)
 					return status;
@@ -132,7 +151,7 @@ namespace sce::vlt
 				populateSemaphoreSubmit(wakeSemaphore, 0, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT));
 		}
 
-		return submitToQueue(exec.queueHandle, m_fence, info);
+		return submitToQueue(exec, m_fence, info);
 	}
 
 	VkResult VltCommandList::synchronize()
@@ -172,16 +191,57 @@ namespace sce::vlt
 		// Unconditionally mark the exec buffer as used. There
 		// is virtually no use case where this isn't correct.
 		m_cmdBuffersUsed = VltCmdType::ExecBuffer;
+
+		m_timestampWritten = m_timestampPool && util::prof::isRecording();
+		if (m_timestampWritten)
+		{
+			vkCmdResetQueryPool(m_execBuffer, m_timestampPool, 0, 2);
+			vkCmdWriteTimestamp(m_execBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_timestampPool, 0);
+		}
 	}
 
 	void VltCommandList::endRecording()
 	{
+		if (m_timestampWritten)
+		{
+			vkCmdWriteTimestamp(m_execBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_timestampPool, 1);
+		}
+
 		if (vkEndCommandBuffer(m_execBuffer) != VK_SUCCESS ||
 			vkEndCommandBuffer(m_initBuffer) != VK_SUCCESS ||
 			vkEndCommandBuffer(m_transBuffer) != VK_SUCCESS)
 			Logger::err("DxvkCommandList::endRecording: Failed to record command buffer");
 	}
 
+	bool VltCommandList::queryGpuTime(
+		uint64_t* begin,
+		uint64_t* end)
+	{
+		bool result = false;
+		do
+		{
+			if (!m_timestampWritten)
+			{
+				break;
+			}
+
+			uint64_t timestamps[2] = {};
+			if (vkGetQueryPoolResults(m_device->handle(), m_timestampPool, 0, 2,
+									  sizeof(timestamps), timestamps, sizeof(uint64_t),
+									  VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+			{
+				break;
+			}
+
+			double period = m_device->properties().core.properties.limits.timestampPeriod;
+			*begin        = static_cast<uint64_t>(timestamps[0] * period);
+			*end          = static_cast<uint64_t>(timestamps[1] * period);
+
+			result = true;
+		} while (false);
+		return result;
+	}
+
 	void VltCommandList::reset()
 	{
 		// Signal resources and events to
@@ -199,7 +259,7 @@ namespace sce::vlt
 	}
 
 	VkResult VltCommandList::submitToQueue(
-		VkQueue                   queue,
+		const VltDeviceQueue&     queue,
 		VkFence                   fence,
 		const VltQueueSubmission& info)
 	{
@@ -226,7 +286,8 @@ namespace sce::vlt
 		submitInfo.signalSemaphoreInfoCount = info.wakeSync.size();
 		submitInfo.pSignalSemaphoreInfos    = info.wakeSync.data();
 	
-		return vkQueueSubmit2(queue, 1, &submitInfo, fence);
+		std::lock_guard<std::mutex> lock(*queue.queueLock);
+		return vkQueueSubmit2(queue.queueHandle, 1, &submitInfo, fence);
 	}
 
 	void VltCommandList::signalSemaphore(const VltSemaphoreSubmission& submission)
@@ -337,6 +398,7 @@ namespace sce::vlt
 			submitInfo.pSignalSemaphoreInfos    = nullptr;
 		}
 
+		std::lock_guard<std::mutex> lock(*exec.queueLock);
 		vkQueueSubmit2(exec.queueHandle, 1, &submitInfo, VK_NULL_HANDLE);
 
 		m_semaphoreTracker.trackSemaphore(submission.semaphore);
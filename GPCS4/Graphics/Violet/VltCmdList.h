@@ -11,6 +11,7 @@
 namespace sce::vlt
 {
 	class VltDevice;
+	struct VltDeviceQueue;
 
 	/**
      * \brief Command buffer flags
@@ -119,6 +120,20 @@ namespace sce::vlt
          */
 		void endRecording();
 
+		/**
+         * \brief Queries GPU execution time
+         *
+         * Only valid after the command list has been
+         * synchronized, and only if it was recorded
+         * while the profiler was recording.
+         * \param [out] begin Start time in nanoseconds
+         * \param [out] end End time in nanoseconds
+         * \returns \c true if timestamps are available
+         */
+		bool queryGpuTime(
+			uint64_t* begin,
+			uint64_t* end);
+
 
 		/**
          * \brief Adds a resource to track
@@ -838,7 +853,7 @@ namespace sce::vlt
 			bool                          signal);
 
 		VkResult submitToQueue(
-			VkQueue                   queue,
+			const VltDeviceQueue&     queue,
 			VkFence                   fence,
 			const VltQueueSubmission& info);
 
@@ -857,6 +872,9 @@ namespace sce::vlt
 
 		VkSemaphore m_transSemaphore = VK_NULL_HANDLE;
 
+		VkQueryPool m_timestampPool    = VK_NULL_HANDLE;
+		bool        m_timestampWritten = false;
+
 		VltCmdBufferFlags m_cmdBuffersUsed;
 
 		VltLifetimeTracker       m_resources;
@@ -3,6 +3,8 @@
 #include "VltDevice.h"
 #include "VltPipeManager.h"
 
+#include "UtilProfiler.h"
+
 namespace sce::vlt
 {
 
@@ -82,6 +84,8 @@ namespace sce::vlt
 	VkPipeline VltComputePipeline::createPipeline(
 		const VltComputePipelineStateInfo& state) const
 	{
+		PROFILER_ZONE("Create Compute Pipeline", "Vlt");
+
 		std::vector<VkDescriptorSetLayoutBinding> bindings;
 
 		if (Logger::logLevel() <= LogLevel::Debug)
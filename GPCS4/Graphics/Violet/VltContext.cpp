@@ -6,6 +6,8 @@
 #include "VltGpuEvent.h"
 #include "VltDescriptor.h"
 
+#include "UtilProfiler.h"
+
 LOG_CHANNEL("Graphic.Violet");
 
 namespace sce::vlt
@@ -147,6 +149,8 @@ namespace sce::vlt
 		uint32_t firstVertex,
 		uint32_t firstInstance)
 	{
+		PROFILER_ZONE("Draw", "Vlt");
+
 		if (this->commitGraphicsState<false, false>())
 		{
 			m_cmd->cmdDraw(
@@ -162,6 +166,8 @@ namespace sce::vlt
 		uint32_t vertexOffset,
 		uint32_t firstInstance)
 	{
+		PROFILER_ZONE("DrawIndexed", "Vlt");
+
 		if (this->commitGraphicsState<true, false>())
 		{
 			m_cmd->cmdDrawIndexed(
@@ -176,6 +182,8 @@ namespace sce::vlt
 		uint32_t y,
 		uint32_t z)
 	{
+		PROFILER_ZONE("Dispatch", "Vlt");
+
 		if (this->commitComputeState())
 		{
 			this->commitComputePrevBarriers();
@@ -375,6 +383,74 @@ namespace sce::vlt
 	}
 
 
+	void VltContext::copyImageToBuffer(
+		const Rc<VltBuffer>&     dstBuffer,
+		VkDeviceSize             dstOffset,
+		VkExtent2D               dstExtent,
+		const Rc<VltImage>&      srcImage,
+		VkImageSubresourceLayers srcSubresource,
+		VkOffset3D               srcOffset,
+		VkExtent3D               srcExtent)
+	{
+		this->endRendering();
+
+		auto dstSlice = dstBuffer->getSliceHandle(dstOffset, 0);
+
+		// We may copy to only one aspect of a depth-stencil image,
+		// but pipeline barriers need to have all aspect bits set
+		auto srcFormatInfo = srcImage->formatInfo();
+
+		auto srcSubresourceRange       = vutil::makeSubresourceRange(srcSubresource);
+		srcSubresourceRange.aspectMask = srcFormatInfo->aspectMask;
+
+		if (m_execBarriers.isImageDirty(srcImage, srcSubresourceRange, VltAccess::Write) ||
+			m_execBarriers.isBufferDirty(dstSlice, VltAccess::Write))
+			m_execBarriers.recordCommands(m_cmd);
+
+		// Select a suitable image layout for the transfer op
+		VkImageLayout srcImageLayoutTransfer = srcImage->pickLayout(VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+
+		m_execAcquires.accessImage(
+			srcImage, srcSubresourceRange,
+			srcImage->info().layout,
+			srcImage->info().stages, 0,
+			srcImageLayoutTransfer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_ACCESS_TRANSFER_READ_BIT);
+
+		m_execAcquires.recordCommands(m_cmd);
+
+		VkBufferImageCopy copyRegion;
+		copyRegion.bufferOffset      = dstSlice.offset;
+		copyRegion.bufferRowLength   = dstExtent.width;
+		copyRegion.bufferImageHeight = dstExtent.height;
+		copyRegion.imageSubresource  = srcSubresource;
+		copyRegion.imageOffset       = srcOffset;
+		copyRegion.imageExtent       = srcExtent;
+
+		m_cmd->cmdCopyImageToBuffer(VltCmdType::ExecBuffer,
+									srcImage->handle(), srcImageLayoutTransfer,
+									dstSlice.handle, 1, &copyRegion);
+
+		m_execBarriers.accessImage(
+			srcImage, srcSubresourceRange,
+			srcImageLayoutTransfer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_ACCESS_TRANSFER_READ_BIT,
+			srcImage->info().layout,
+			srcImage->info().stages,
+			srcImage->info().access);
+
+		m_execBarriers.accessBuffer(dstSlice,
+									VK_PIPELINE_STAGE_TRANSFER_BIT,
+									VK_ACCESS_TRANSFER_WRITE_BIT,
+									dstBuffer->info().stages,
+									dstBuffer->info().access);
+
+		m_cmd->trackResource<VltAccess::Read>(srcImage);
+		m_cmd->trackResource<VltAccess::Write>(dstBuffer);
+	}
+
 	void VltContext::updateIndexBufferBinding()
 	{
 		m_flags.clr(VltContextFlag::GpDirtyIndexBuffer);
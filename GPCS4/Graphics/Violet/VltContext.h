@@ -577,6 +577,26 @@ namespace sce::vlt
 			VkExtent2D               srcExtent);
 
 		/**
+		 * \brief Copies data from an image into a buffer
+		 *
+		 * \param [in] dstBuffer Destination buffer
+		 * \param [in] dstOffset Destination offset, in bytes
+		 * \param [in] dstExtent Destination data extent
+		 * \param [in] srcImage Source image
+		 * \param [in] srcSubresource Source subresource
+		 * \param [in] srcOffset Source area offset
+		 * \param [in] srcExtent Source area size
+		 */
+		void copyImageToBuffer(
+			const Rc<VltBuffer>&     dstBuffer,
+			VkDeviceSize             dstOffset,
+			VkExtent2D               dstExtent,
+			const Rc<VltImage>&      srcImage,
+			VkImageSubresourceLayers srcSubresource,
+			VkOffset3D               srcOffset,
+			VkExtent3D               srcExtent);
+
+		/**
          * \brief Sets barrier control flags
          *
          * Barrier control flags can be used to control
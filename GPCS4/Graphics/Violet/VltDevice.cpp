@@ -29,6 +29,16 @@ namespace sce::vlt
 		m_queues.graphics  = getQueue(queueFamilies.graphics, 0);
 		m_queues.compute   = getQueue(queueFamilies.compute, 0);
 		m_queues.transfer  = getQueue(queueFamilies.transfer, 0);
+
+		m_queues.graphics.queueLock = &m_queueLocks[0];
+		m_queues.compute.queueLock  = m_queues.compute.queueHandle == m_queues.graphics.queueHandle
+										  ? m_queues.graphics.queueLock
+										  : &m_queueLocks[1];
+		m_queues.transfer.queueLock = m_queues.transfer.queueHandle == m_queues.graphics.queueHandle
+										  ? m_queues.graphics.queueLock
+									  : m_queues.transfer.queueHandle == m_queues.compute.queueHandle
+										  ? m_queues.compute.queueLock
+										  : &m_queueLocks[2];
 	}
 
 	VltDevice::~VltDevice()
@@ -184,7 +194,7 @@ namespace sce::vlt
 		return new VltSemaphore(this, info);
 	}
 
-	void VltDevice::submitCommandList(
+	VkResult VltDevice::submitCommandList(
 		const Rc<VltCommandList>& commandList,
 		VkSemaphore               waitSync,
 		VkSemaphore               wakeSync)
@@ -193,7 +203,7 @@ namespace sce::vlt
 		submitInfo.cmdList  = commandList;
 		submitInfo.waitSync = waitSync;
 		submitInfo.wakeSync = wakeSync;
-		m_submissionQueue.submit(submitInfo);
+		return m_submissionQueue.submit(submitInfo);
 	}
 
 	void VltDevice::presentImage(
@@ -14,6 +14,9 @@
 #include "VltObject.h"
 #include "VltSemaphore.h"
 
+#include <array>
+#include <mutex>
+
 namespace sce::gcn
 {
 	class SpirvCodeBuffer;
@@ -34,6 +37,10 @@ namespace sce::vlt
 		VkQueue  queueHandle = VK_NULL_HANDLE;
 		uint32_t queueFamily = 0;
 		uint32_t queueIndex  = 0;
+		// Taken for every submit and present. Queues sharing
+		// a handle, e.g. compute falling back to graphics,
+		// share the lock as well.
+		std::mutex* queueLock = nullptr;
 	};
 
 	/**
@@ -319,8 +326,10 @@ namespace sce::vlt
 		 * \param [in] commandList The command list to submit
 		 * \param [in] waitSync (Optional) Semaphore to wait on
 		 * \param [in] wakeSync (Optional) Semaphore to notify
+		 * \returns Status of the submission, \c VK_ERROR_DEVICE_LOST
+		 *          if the device was lost while it ran
 		 */
-		void submitCommandList(
+		VkResult submitCommandList(
 			const Rc<VltCommandList>& commandList,
 			VkSemaphore               waitSync,
 			VkSemaphore               wakeSync);
@@ -376,6 +385,8 @@ namespace sce::vlt
 		VltObjects m_objects;
 
 		VltDeviceQueueSet m_queues;
+		// One per distinct VkQueue in m_queues.
+		std::array<std::mutex, 3> m_queueLocks;
 
 		VltSubmissionQueue m_submissionQueue;
 
@@ -4,6 +4,8 @@
 #include "VltPipeManager.h"
 #include "VltShader.h"
 
+#include "UtilProfiler.h"
+
 
 namespace sce::vlt
 {
@@ -127,6 +129,8 @@ namespace sce::vlt
 		const VltGraphicsPipelineStateInfo& state,
 		const VltAttachmentFormat&          format) const
 	{
+		PROFILER_ZONE("Create Graphics Pipeline", "Vlt");
+
 		if (Logger::logLevel() <= LogLevel::Debug)
 		{
 			Logger::debug("Compiling graphics pipeline...");
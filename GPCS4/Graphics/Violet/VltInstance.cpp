@@ -12,7 +12,8 @@ LOG_CHANNEL(Graphic.Violet);
 
 namespace sce::vlt
 {
-	VltInstance::VltInstance()
+	VltInstance::VltInstance(bool headless) :
+		m_headless(headless)
 	{
 		m_instance = this->createInstance();
 		m_adapters = this->queryAdapters();
@@ -63,7 +64,19 @@ namespace sce::vlt
 		} };
 
 		// merge platform extensions
-		auto platformExtensions = getPlatformExtensions();
+		std::vector<VltExt> platformExtensions;
+		if (!m_headless)
+		{
+			platformExtensions = getPlatformExtensions();
+		}
+		else
+		{
+			// No window system on headless machines,
+			// the presenter renders to offscreen images instead.
+			insExtensions.khrGetSurfaceCapabilities2.setMode(VltExtMode::Disabled);
+			insExtensions.khrSurface.setMode(VltExtMode::Disabled);
+		}
+
 		for (auto& ext : platformExtensions)
 		{
 			insExtensionList.push_back(&ext);
@@ -19,7 +19,14 @@ namespace sce::vlt
 	{
 
 	public:
-		VltInstance();
+		/**
+		 * \brief Creates the instance
+		 * 
+		 * \param [in] headless Do not enable window system
+		 *        integration extensions, used when there's
+		 *        no display to present to.
+		 */
+		VltInstance(bool headless = false);
 		virtual ~VltInstance();
 
 		/**
@@ -62,6 +69,15 @@ namespace sce::vlt
 			return m_extensions;
 		}
 
+		/**
+		 * \brief Whether the instance can present to a surface
+		 * \returns \c false if created in headless mode
+		 */
+		bool isHeadless() const
+		{
+			return m_headless;
+		}
+
 	private:
 		std::vector<VltExt> getPlatformExtensions();
 
@@ -89,6 +105,7 @@ namespace sce::vlt
 			void*                                       pUserData);
 
 	private:
+		bool                  m_headless = false;
 		VkInstance            m_instance = VK_NULL_HANDLE;
 		VltInstanceExtensions m_extensions;
 
@@ -11,32 +11,32 @@ namespace sce::vlt
 
 	void Logger::log(LogLevel level, const std::string& message)
 	{
-		LOG_DEBUG(message.c_str());
+		LOG_DEBUG("%s", message.c_str());
 	}
 
 	void Logger::trace(const std::string& message)
 	{
-		LOG_TRACE(message.c_str());
+		LOG_TRACE("%s", message.c_str());
 	}
 
 	void Logger::debug(const std::string& message)
 	{
-		LOG_DEBUG(message.c_str());
+		LOG_DEBUG("%s", message.c_str());
 	}
 
 	void Logger::info(const std::string& message)
 	{
-		LOG_DEBUG(message.c_str());
+		LOG_DEBUG("%s", message.c_str());
 	}
 
 	void Logger::warn(const std::string& message)
 	{
-		LOG_WARN(message.c_str());
+		LOG_WARN("%s", message.c_str());
 	}
 
 	void Logger::err(const std::string& message)
 	{
-		LOG_ERR(message.c_str());
+		LOG_ERR("%s", message.c_str());
 	}
 
 	void Logger::exception(const std::string& message)
@@ -2,6 +2,8 @@
 #include "VltDevice.h"
 #include "Sce/ScePresenter.h"
 
+#include "UtilProfiler.h"
+
 namespace sce::vlt
 {
 
@@ -14,10 +16,13 @@ namespace sce::vlt
 	{
 	}
 
-	void VltSubmissionQueue::submit(const VltSubmitInfo& submission)
+	VkResult VltSubmissionQueue::submit(const VltSubmitInfo& submission)
 	{
-		auto& cmdList = submission.cmdList;
-		cmdList->submit(submission.waitSync, submission.wakeSync);
+		PROFILER_ZONE("Submit", "Vlt");
+
+		// The command list takes the lock of each VkQueue it submits to.
+		auto&    cmdList = submission.cmdList;
+		VkResult status  = cmdList->submit(submission.waitSync, submission.wakeSync);
 
 		// TODO:
 		// Calling synchronize will block the CPU waiting for the submission done on GPU,
@@ -30,18 +35,38 @@ namespace sce::vlt
 		// So I keep it single threaded to make debugging easier.
 
 		// Wait for command buffer submit finish.
-		cmdList->synchronize();
+		if (status == VK_SUCCESS)
+		{
+			status = cmdList->synchronize();
+		}
+
+		if (status != VK_SUCCESS)
+		{
+			Logger::err(util::str::formatex("VltSubmissionQueue: Command list failed: ", status));
+		}
+
+		if (util::prof::isRecording())
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			recordGpuTime(cmdList);
+		}
+
+		// Wake up anyone waiting for the command list.
+		cmdList->notifyObjects();
 
 		// After submit done, reset cmdlist to release resource.
 		cmdList->reset();
 
 		// Finally, recycle the cmdlist for next use.
 		m_device->recycleCommandList(cmdList);
+		return status;
 	}
 
 	void VltSubmissionQueue::present(
 		const VltPresentInfo& presentInfo)
 	{
+		PROFILER_ZONE("Present", "Vlt");
+
 		auto& presenter = presentInfo.presenter;
 		presenter->presentImage();
 	}
@@ -53,4 +78,28 @@ namespace sce::vlt
 		// This need to be implemented after we support asynchronous submit.
 	}
 
+	void VltSubmissionQueue::recordGpuTime(
+		const Rc<VltCommandList>& cmdList)
+	{
+		uint64_t gpuBegin = 0;
+		uint64_t gpuEnd   = 0;
+		if (cmdList->queryGpuTime(&gpuBegin, &gpuEnd))
+		{
+			// Without calibrated timestamps, the best we know is that
+			// the fence wait returned after the GPU finished, so every
+			// submission gives an upper bound of the clock offset.
+			int64_t offset  = int64_t(util::prof::now()) - int64_t(gpuEnd);
+			m_gpuTimeOffset = std::min(m_gpuTimeOffset, offset);
+
+			auto track = cmdList->type() == VltQueueType::Graphics
+							 ? util::prof::ProfilerTrack::GpuGraphics
+							 : util::prof::ProfilerTrack::GpuCompute;
+
+			util::prof::recordTrackZone(track,
+										"Command List", "GPU",
+										gpuBegin + m_gpuTimeOffset,
+										gpuEnd + m_gpuTimeOffset);
+		}
+	}
+
 }  // namespace sce::vlt
\ No newline at end of file
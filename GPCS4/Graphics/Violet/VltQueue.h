@@ -3,6 +3,8 @@
 #include "VltCommon.h"
 #include "VltCmdList.h"
 
+#include <mutex>
+
 namespace sce
 {
 	class ScePresenter;
@@ -48,7 +50,7 @@ namespace sce
 			VltSubmissionQueue(VltDevice* device);
 			~VltSubmissionQueue();
 
-			void submit(
+			VkResult submit(
 				const VltSubmitInfo& submission);
 
 			void present(
@@ -56,8 +58,18 @@ namespace sce
 
 			void synchronize();
 
+		private:
+			void recordGpuTime(
+				const Rc<VltCommandList>& cmdList);
+
 		private:
 			VltDevice* m_device;
+
+			// Compute queues submit from their own threads.
+			std::mutex m_mutex;
+
+			// GPU to profiler time offset, see recordGpuTime.
+			int64_t m_gpuTimeOffset = INT64_MAX;
 		};
 	} // namespace vlt
 }  // namespace sce
\ No newline at end of file
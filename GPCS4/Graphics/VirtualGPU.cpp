@@ -4,6 +4,7 @@
 #include "sce_errors.h"
 
 #include "Gnm/GnmConstant.h"
+#include "Sce/SceCapture.h"
 #include "Sce/SceGnmDriver.h"
 #include "Sce/SceResourceTracker.h"
 #include "Sce/SceLabelManager.h"
@@ -14,11 +15,14 @@ LOG_CHANNEL(Graphic.VirtualGPU);
 namespace sce
 {
 
-	VirtualGPU::VirtualGPU()
+	VirtualGPU::VirtualGPU(bool headless, uint32_t refreshRate) :
+		m_headless(headless),
+		m_refreshRate(refreshRate)
 	{
-		m_gnmDriver    = std::make_shared<SceGnmDriver>();
+		m_gnmDriver    = std::make_shared<SceGnmDriver>(headless);
 		m_tracker      = std::make_shared<SceResourceTracker>();
 		m_labelManager = std::make_shared<SceLabelManager>(m_gnmDriver->m_device.ptr());
+		m_capture      = std::make_shared<SceCapture>();
 	}
 
 	VirtualGPU::~VirtualGPU()
@@ -47,7 +51,7 @@ namespace sce
 				break;
 			}
 
-			m_videoOutSlots[typeIndex] = std::make_shared<SceVideoOut>(type, param);
+			m_videoOutSlots[typeIndex] = std::make_shared<SceVideoOut>(type, param, m_headless, m_refreshRate);
 
 			result = SceVideoOutPortBase + typeIndex;
 		} while (false);
@@ -96,9 +100,19 @@ namespace sce
 		return *m_labelManager;
 	}
 
+	SceCapture& VirtualGPU::capture()
+	{
+		return *m_capture;
+	}
+
 	Gnm::GpuMode VirtualGPU::mode()
 	{
 		return Gnm::kGpuModeNeo;
 	}
 
+	bool VirtualGPU::isHeadless() const
+	{
+		return m_headless;
+	}
+
 }  // namespace sce
\ No newline at end of file
@@ -18,6 +18,7 @@ namespace sce
 	class SceGnmDriver;
 	class SceResourceTracker;
 	class SceLabelManager;
+	class SceCapture;
 	
 	class VirtualGPU final
 	{
@@ -25,7 +26,12 @@ namespace sce
 		constexpr static uint32_t SceVideoOutCount    = 3;
 
 	public:
-		VirtualGPU();
+		/**
+		 * \param [in] headless Run without a display window.
+		 * \param [in] refreshRate Vblanks per second of video
+		 *        out ports, 0 to not pace flips.
+		 */
+		VirtualGPU(bool headless, uint32_t refreshRate);
 		~VirtualGPU();
 
 		/**
@@ -59,6 +65,11 @@ namespace sce
 		 */
 		SceLabelManager& labelManager();
 
+		/**
+		 * \brief Get PM4 capture writer.
+		 */
+		SceCapture& capture();
+
 		/**
 		 * \brief Global GPU mode.
 		 * 
@@ -68,7 +79,14 @@ namespace sce
 		 */
 		Gnm::GpuMode mode();
 
+		/**
+		 * \brief Whether there's a display window
+		 */
+		bool isHeadless() const;
+
 	private:
+		bool     m_headless    = false;
+		uint32_t m_refreshRate = 60;
 
 		// it's better to use std::unique_ptr here
 		// but to prevent annoying errors of missing destructor
@@ -81,6 +99,7 @@ namespace sce
 
 		std::shared_ptr<SceResourceTracker> m_tracker      = nullptr;
 		std::shared_ptr<SceLabelManager>    m_labelManager = nullptr;
+		std::shared_ptr<SceCapture>         m_capture      = nullptr;
 	};
 
 }  // namespace sce
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "ELFMapper.h"
 
 #include "Emulator/ModuleSystemCommon.h"
+#include "Emulator/SymbolTable.h"
 #include "Platform.h"
 
 #include <algorithm>
@@ -31,7 +32,10 @@ bool ELFMapper::loadFile(std::string const &filePath, NativeModule *mod)
 
 		m_moduleData = mod;
 
-		if (!plat::LoadFile(filePath, mod->m_fileMemory))
+		// The file is mapped rather than read, only the pages
+		// we actually look at are brought in.
+		mod->m_fileMapping.reset(plat::MapFile(filePath));
+		if (!mod->m_fileMapping)
 		{
 			LOG_ERR("failed to load file %s", filePath.c_str());
 			break;
@@ -45,24 +49,24 @@ bool ELFMapper::loadFile(std::string const &filePath, NativeModule *mod)
 bool ELFMapper::validateHeader()
 {
 
-	bool retVal      = false;
-	auto &fileMemory = m_moduleData->m_fileMemory;
+	bool retVal = false;
 
 	do
 	{
-		if (m_moduleData == nullptr)
+		if (m_moduleData == nullptr || !m_moduleData->m_fileMapping)
 		{
 			LOG_ERR("file has not been loaded");
 			break;
 		}
 
-		if (fileMemory.size() < sizeof(*m_moduleData->m_elfHeader))
+		auto fileMapping = m_moduleData->m_fileMapping.get();
+		if (fileMapping->nSize < sizeof(*m_moduleData->m_elfHeader))
 		{
-			LOG_ERR("file size error. size=%d", fileMemory.size());
+			LOG_ERR("file size error. size=%d", fileMapping->nSize);
 			break;
 		}
 
-		m_moduleData->m_elfHeader = reinterpret_cast<Elf64_Ehdr *>(fileMemory.data());
+		m_moduleData->m_elfHeader = reinterpret_cast<Elf64_Ehdr *>(fileMapping->pData);
 		auto elfHeader            = m_moduleData->m_elfHeader;
 
 		if (strncmp((const char *)elfHeader->e_ident, ELFMAG, SELFMAG))
@@ -100,9 +104,9 @@ bool ELFMapper::parseSegmentHeaders()
 			break;
 		}
 
-		auto&        fileMemory     = m_moduleData->m_fileMemory;
+		auto         fileMapping    = m_moduleData->m_fileMapping.get();
 		MODULE_INFO& info           = m_moduleData->m_moduleInfo;
-		uint8_t*     pSegmentHeader = fileMemory.data() + m_moduleData->m_elfHeader->e_phoff;
+		uint8_t*     pSegmentHeader = fileMapping->pData + m_moduleData->m_elfHeader->e_phoff;
 		uint32_t     shCount        = m_moduleData->m_elfHeader->e_phnum;
 
 		m_moduleData->m_segmentHeaders.resize(shCount);
@@ -110,7 +114,7 @@ bool ELFMapper::parseSegmentHeaders()
 		memcpy(m_moduleData->m_segmentHeaders.data(), pSegmentHeader,
 			   shCount * sizeof(Elf64_Phdr));
 
-		uint8_t *pBuffer = fileMemory.data();
+		uint8_t *pBuffer = fileMapping->pData;
 
 		for (auto &hdr : m_moduleData->m_segmentHeaders)
 		{
@@ -240,9 +244,20 @@ bool ELFMapper::mapImageIntoMemory()
 			break;
 		}
 
+		// Segments are placed at their address aligned down to p_align,
+		// so the image must be aligned to the largest of them.
+		size_t imageAlign = plat::VM_PAGE_SIZE;
+		for (auto const &phdr : m_moduleData->m_segmentHeaders)
+		{
+			if (isSegmentLoadable(phdr))
+			{
+				imageAlign = std::max(imageAlign, size_t(phdr.p_align));
+			}
+		}
+
 		uint8_t* buffer = reinterpret_cast<uint8_t*>(plat::VMAllocateAlign(
 			nullptr,
-			totalSize, plat::VM_PAGE_SIZE,
+			totalSize, imageAlign,
 			plat::VMAT_RESERVE_COMMIT, plat::VMPF_CPU_RWX));
 
 		if (buffer == nullptr)
@@ -347,8 +362,10 @@ bool ELFMapper::parseSymbols()
 					LOG_ERR("fail to find information for symbol %s", name);
 				}
 			}
-			si.address = reinterpret_cast<uint64_t>(addr);
-			auto idx   = m_moduleData->m_symbols.size();
+			si.moduleId  = internSymbolName(si.moduleName);
+			si.libraryId = internSymbolName(si.libraryName);
+			si.address   = reinterpret_cast<uint64_t>(addr);
+			auto idx     = m_moduleData->m_symbols.size();
 			m_moduleData->m_symbols.emplace_back(si);
 			m_moduleData->m_nameSymbolMap.insert(std::make_pair(name, idx));
 			if (symbol.st_value != 0)
@@ -391,8 +408,10 @@ bool ELFMapper::parseSymbols()
 					LOG_ERR("fail to find information for symbol %s", name);
 				}
 			}
-			si.address = reinterpret_cast<uint64_t>(addr);
-			auto idx   = m_moduleData->m_symbols.size();
+			si.moduleId  = internSymbolName(si.moduleName);
+			si.libraryId = internSymbolName(si.libraryName);
+			si.address   = reinterpret_cast<uint64_t>(addr);
+			auto idx     = m_moduleData->m_symbols.size();
 			m_moduleData->m_symbols.emplace_back(si);
 			m_moduleData->m_nameSymbolMap.insert(std::make_pair(name, idx));
 			if (symbol.st_value != 0)
@@ -650,7 +669,7 @@ size_t ELFMapper::calculateTotalLoadableSize()
 			}
 
 			size_t alignedAddr =
-				util::alignDown(phdr.p_vaddr + phdr.p_memsz, phdr.p_align);
+				util::align(phdr.p_vaddr + phdr.p_memsz, phdr.p_align);
 			if (alignedAddr > loadAddrEnd)
 			{
 				loadAddrEnd = alignedAddr;
@@ -685,21 +704,17 @@ bool ELFMapper::mapCodeSegment(Elf64_Phdr const &phdr)
 {
 	bool retVal       = false;
 	MODULE_INFO &info = m_moduleData->m_moduleInfo;
-	auto &fileData    = m_moduleData->m_fileMemory;
 	do
 	{
-		if (fileData.empty())
-		{
-			break;
-		}
-
 		info.nCodeSize = phdr.p_memsz;
 		info.pCodeAddr = reinterpret_cast<uint8_t*>(
 			util::alignDown(size_t(info.pMappedAddr + phdr.p_vaddr), phdr.p_align));
 
-		uint8_t *fileDataPtr = fileData.data() + phdr.p_offset;
+		if (!mapSegmentData(phdr, info.pCodeAddr))
+		{
+			break;
+		}
 
-		memcpy(info.pCodeAddr, fileDataPtr, phdr.p_filesz);
 		if (m_moduleData->m_elfHeader->e_entry != 0)
 		{
 			//info.pEntryPoint = info.pCodeAddr + m_moduleData->elfHeader->e_entry;
@@ -728,21 +743,13 @@ bool ELFMapper::mapSecReloSegment(Elf64_Phdr const &phdr)
 {
 	bool retVal       = false;
 	MODULE_INFO &info = m_moduleData->m_moduleInfo;
-	auto &fileData    = m_moduleData->m_fileMemory;
 
 	do
 	{
-		if (fileData.empty())
-		{
-			break;
-		}
-
 		uint8_t *relroAddr = reinterpret_cast<uint8_t *>(
 			util::alignDown(size_t(info.pMappedAddr + phdr.p_vaddr), phdr.p_align));
-		uint8_t *fileDataPtr = fileData.data() + phdr.p_offset;
 
-		memcpy(relroAddr, fileDataPtr, phdr.p_filesz);
-		retVal = true;
+		retVal = mapSegmentData(phdr, relroAddr);
 
 	} while (false);
 
@@ -753,21 +760,17 @@ bool ELFMapper::mapDataSegment(Elf64_Phdr const &phdr)
 {
 	bool retVal       = false;
 	MODULE_INFO &info = m_moduleData->m_moduleInfo;
-	auto &fileData    = m_moduleData->m_fileMemory;
 
 	do
 	{
-		if (fileData.empty())
-		{
-			break;
-		}
-
 		info.nDataSize = phdr.p_memsz;
 		info.pDataAddr = reinterpret_cast<uint8_t *>(
 			util::alignDown(size_t(info.pMappedAddr) + phdr.p_vaddr, phdr.p_align));
 
-		uint8_t *fileDataPtr = fileData.data() + phdr.p_offset;
-		memcpy(info.pDataAddr, fileDataPtr, phdr.p_filesz);
+		if (!mapSegmentData(phdr, info.pDataAddr))
+		{
+			break;
+		}
 
 		if (info.pProcParam != nullptr)
 		{
@@ -780,3 +783,51 @@ bool ELFMapper::mapDataSegment(Elf64_Phdr const &phdr)
 
 	return retVal;
 }
+
+bool ELFMapper::mapSegmentData(Elf64_Phdr const &phdr, uint8_t *pDest)
+{
+	bool retVal      = false;
+	auto fileMapping = m_moduleData->m_fileMapping.get();
+
+	do
+	{
+		if (fileMapping == nullptr ||
+			phdr.p_offset + phdr.p_filesz > fileMapping->nSize)
+		{
+			LOG_ERR("segment out of file. offset=%lx size=%lx", phdr.p_offset, phdr.p_filesz);
+			break;
+		}
+
+		if (phdr.p_filesz == 0)
+		{
+			retVal = true;
+			break;
+		}
+
+#ifndef GPCS4_WINDOWS
+		// Where file offset and address share the page alignment, the file
+		// pages are mapped over the image instead of copied. They are read
+		// in when first executed or accessed, and only the pages
+		// relocation writes to are copied.
+		MODULE_INFO &info    = m_moduleData->m_moduleInfo;
+		size_t       mapSize = util::align(phdr.p_filesz, plat::VM_PAGE_SIZE);
+		bool         inImage = pDest + mapSize <= info.pMappedAddr + info.nMappedSize;
+		if (inImage &&
+			plat::MapFileFixed(fileMapping, phdr.p_offset, pDest, mapSize, plat::VMPF_CPU_RWX))
+		{
+			// The last page holds whatever follows the segment in the file,
+			// clear it like the rest of the image.
+			memset(pDest + phdr.p_filesz, 0, mapSize - phdr.p_filesz);
+			retVal = true;
+			break;
+		}
+#endif  // GPCS4_WINDOWS
+
+		// The file view is still mapped lazily,
+		// only the pages of the segment are read.
+		memcpy(pDest, fileMapping->pData + phdr.p_offset, phdr.p_filesz);
+		retVal = true;
+	} while (false);
+
+	return retVal;
+}
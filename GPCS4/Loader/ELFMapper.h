@@ -35,6 +35,7 @@ private:
 	bool mapCodeSegment(Elf64_Phdr const &hdr);
 	bool mapSecReloSegment(Elf64_Phdr const &phdr);
 	bool mapDataSegment(Elf64_Phdr const &phdr);
+	bool mapSegmentData(Elf64_Phdr const &phdr, uint8_t *pDest);
 
 	NativeModule *m_moduleData;
 };
@@ -0,0 +1,439 @@
+#include "ELFMapperBench.h"
+#include "ELFMapper.h"
+#include "Platform.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+LOG_CHANNEL(Loader.ELFMapperBench);
+
+constexpr uint64_t BenchSegmentAlign = 0x4000;
+// Relocations are spread one per page over relro and data,
+// as pointer tables usually are.
+constexpr uint64_t BenchRelocStride = plat::VM_PAGE_SIZE;
+
+struct BenchImage
+{
+	uint8_t*    pImageBase;
+	Elf64_Rela* pRela;
+	uint32_t    nRelaCount;
+	uint8_t*    pCodeAddr;
+	uint64_t    nCodeSize;
+};
+
+// The R_X86_64_RELATIVE part of CLinker::relocateRela.
+static void relocateImage(const BenchImage& image)
+{
+	for (uint32_t i = 0; i != image.nRelaCount; ++i)
+	{
+		const Elf64_Rela& rela = image.pRela[i];
+		if (ELF64_R_TYPE(rela.r_info) != R_X86_64_RELATIVE)
+		{
+			continue;
+		}
+
+		auto pTarget = reinterpret_cast<uint64_t*>(image.pImageBase + rela.r_offset);
+		*pTarget     = reinterpret_cast<uint64_t>(image.pImageBase) + rela.r_addend;
+	}
+}
+
+// What running the game does to the code sooner or later.
+static void touchCode(const BenchImage& image)
+{
+	const volatile uint8_t* pCode = image.pCodeAddr;
+	for (uint64_t offset = 0; offset < image.nCodeSize; offset += plat::VM_PAGE_SIZE)
+	{
+		pCode[offset];
+	}
+}
+
+static double getResidentMB(size_t before, size_t after)
+{
+	return after > before ? static_cast<double>(after - before) / (1024.0 * 1024.0) : 0.0;
+}
+
+
+ELFMapperBench::ELFMapperBench(const ELFMapperBenchDesc& desc) :
+	m_desc(desc)
+{
+}
+
+ELFMapperBench::~ELFMapperBench()
+{
+	removeFile();
+}
+
+bool ELFMapperBench::run()
+{
+	bool ret = false;
+	do
+	{
+		if (m_desc.imageSize == 0)
+		{
+			std::printf("Nothing to run, image size is 0.\n");
+			break;
+		}
+
+		if (!createFile())
+		{
+			std::printf("Failed to create the executable.\n");
+			break;
+		}
+
+		std::printf("Executable     : %u MB image in %s\n",
+					m_desc.imageSize, m_filePath.c_str());
+
+		// The file was just written, both paths
+		// read it out of the page cache.
+		if (!runCopied() || !runMapped())
+		{
+			break;
+		}
+
+		std::printf("Peak resident  : %.1f MB for the process\n",
+					getResidentMB(0, plat::GetProcessPeakResidentSize()));
+
+		ret = true;
+	} while (false);
+
+	removeFile();
+	return ret;
+}
+
+bool ELFMapperBench::runMapped()
+{
+	bool ret = false;
+	do
+	{
+		double   loadTime     = 0.0;
+		double   touchTime    = 0.0;
+		double   residentSize = 0.0;
+		bool     success      = true;
+
+		uint32_t repeatCount = std::max(m_desc.repeatCount, 1u);
+		for (uint32_t i = 0; i != repeatCount; ++i)
+		{
+			size_t       residentBefore = plat::GetProcessResidentSize();
+			NativeModule mod = {};
+			ELFMapper    mapper;
+
+			auto start = std::chrono::high_resolution_clock::now();
+			success &= mapper.loadFile(m_filePath, &mod) &&
+					   mapper.validateHeader() &&
+					   mapper.parseSegmentHeaders() &&
+					   mapper.parseDynamicSection() &&
+					   mapper.mapImageIntoMemory() &&
+					   mapper.parseSymbols();
+			if (!success)
+			{
+				break;
+			}
+
+			auto&      info  = mod.getModuleInfo();
+			BenchImage image = {};
+			image.pImageBase = info.pCodeAddr;
+			image.pRela      = reinterpret_cast<Elf64_Rela*>(info.pRela);
+			image.nRelaCount = info.nRelaCount;
+			image.pCodeAddr  = info.pCodeAddr;
+			image.nCodeSize  = info.nCodeSize;
+			relocateImage(image);
+			auto loaded = std::chrono::high_resolution_clock::now();
+
+			size_t residentAfter = plat::GetProcessResidentSize();
+
+			touchCode(image);
+			auto touched = std::chrono::high_resolution_clock::now();
+
+			double load  = std::chrono::duration<double>(loaded - start).count();
+			double touch = std::chrono::duration<double>(touched - loaded).count();
+			loadTime     = i == 0 ? load : std::min(loadTime, load);
+			touchTime    = i == 0 ? touch : std::min(touchTime, touch);
+			residentSize = i == 0 ? getResidentMB(residentBefore, residentAfter) : residentSize;
+		}
+
+		if (!success)
+		{
+			std::printf("ELFMapper failed to load the executable.\n");
+			break;
+		}
+
+		std::printf("Mapped (ELFMapper)\n");
+		std::printf("  Load          : %.3f ms\n", loadTime * 1000.0);
+		std::printf("  Resident      : %.1f MB after load\n", residentSize);
+		std::printf("  Touch code    : %.3f ms\n", touchTime * 1000.0);
+
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+bool ELFMapperBench::runCopied()
+{
+	bool ret = false;
+	do
+	{
+		double   loadTime     = 0.0;
+		double   touchTime    = 0.0;
+		double   residentSize = 0.0;
+		bool     success      = true;
+
+		uint32_t repeatCount = std::max(m_desc.repeatCount, 1u);
+		for (uint32_t i = 0; i != repeatCount; ++i)
+		{
+			size_t residentBefore = plat::GetProcessResidentSize();
+
+			auto start = std::chrono::high_resolution_clock::now();
+
+			// ELFMapper as it was, the whole file in memory
+			// and every segment copied into the image.
+			std::vector<uint8_t> fileData;
+			if (!plat::LoadFile(m_filePath, fileData))
+			{
+				success = false;
+				break;
+			}
+
+			auto pHeader  = reinterpret_cast<Elf64_Ehdr*>(fileData.data());
+			auto pSegment = reinterpret_cast<Elf64_Phdr*>(fileData.data() + pHeader->e_phoff);
+
+			size_t      imageSize = 0;
+			Elf64_Phdr* pDynLib   = nullptr;
+			Elf64_Phdr* pDynamic  = nullptr;
+			for (uint32_t s = 0; s != pHeader->e_phnum; ++s)
+			{
+				auto& phdr = pSegment[s];
+				if (phdr.p_type == PT_LOAD || phdr.p_type == PT_SCE_RELRO)
+				{
+					imageSize = std::max(imageSize, util::align(phdr.p_vaddr + phdr.p_memsz, phdr.p_align));
+				}
+				else if (phdr.p_type == PT_SCE_DYNLIBDATA)
+				{
+					pDynLib = &phdr;
+				}
+				else if (phdr.p_type == PT_DYNAMIC)
+				{
+					pDynamic = &phdr;
+				}
+			}
+
+			plat::memory_ptr image(reinterpret_cast<uint8_t*>(plat::VMAllocateAlign(
+				nullptr, imageSize, plat::VM_PAGE_SIZE,
+				plat::VMAT_RESERVE_COMMIT, plat::VMPF_CPU_RWX)));
+			if (!image || !pDynLib || !pDynamic)
+			{
+				success = false;
+				break;
+			}
+
+			for (uint32_t s = 0; s != pHeader->e_phnum; ++s)
+			{
+				auto& phdr = pSegment[s];
+				if (phdr.p_type == PT_LOAD || phdr.p_type == PT_SCE_RELRO)
+				{
+					memcpy(image.get() + phdr.p_vaddr, fileData.data() + phdr.p_offset, phdr.p_filesz);
+				}
+			}
+
+			auto pDynLibData = fileData.data() + pDynLib->p_offset;
+			auto pDynEntry   = reinterpret_cast<Elf64_Dyn*>(fileData.data() + pDynamic->p_offset);
+
+			BenchImage bench = {};
+			bench.pImageBase = image.get();
+			bench.pCodeAddr  = image.get();
+			bench.nCodeSize  = pSegment[0].p_memsz;
+			for (; pDynEntry->d_tag != DT_NULL; ++pDynEntry)
+			{
+				if (pDynEntry->d_tag == DT_SCE_RELA)
+				{
+					bench.pRela = reinterpret_cast<Elf64_Rela*>(pDynLibData + pDynEntry->d_un.d_ptr);
+				}
+				else if (pDynEntry->d_tag == DT_SCE_RELASZ)
+				{
+					bench.nRelaCount = pDynEntry->d_un.d_val / sizeof(Elf64_Rela);
+				}
+			}
+			relocateImage(bench);
+			auto loaded = std::chrono::high_resolution_clock::now();
+
+			size_t residentAfter = plat::GetProcessResidentSize();
+
+			touchCode(bench);
+			auto touched = std::chrono::high_resolution_clock::now();
+
+			double load  = std::chrono::duration<double>(loaded - start).count();
+			double touch = std::chrono::duration<double>(touched - loaded).count();
+			loadTime     = i == 0 ? load : std::min(loadTime, load);
+			touchTime    = i == 0 ? touch : std::min(touchTime, touch);
+			residentSize = i == 0 ? getResidentMB(residentBefore, residentAfter) : residentSize;
+		}
+
+		if (!success)
+		{
+			std::printf("Failed to copy the executable.\n");
+			break;
+		}
+
+		std::printf("Copied (previous ELFMapper)\n");
+		std::printf("  Load          : %.3f ms\n", loadTime * 1000.0);
+		std::printf("  Resident      : %.1f MB after load\n", residentSize);
+		std::printf("  Touch code    : %.3f ms\n", touchTime * 1000.0);
+
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+bool ELFMapperBench::createFile()
+{
+	bool ret = false;
+	do
+	{
+		std::error_code error;
+		auto            root = std::filesystem::temp_directory_path(error) / "gpcs4_elf_bench";
+		if (error)
+		{
+			break;
+		}
+
+		std::filesystem::remove_all(root, error);
+		std::filesystem::create_directories(root, error);
+		m_root     = root.string();
+		m_filePath = (root / "eboot.bin").string();
+
+		// Three quarters code, the rest split between relro and data.
+		// Data has as much bss as it has file content.
+		uint64_t imageSize = static_cast<uint64_t>(m_desc.imageSize) * 1024 * 1024;
+		uint64_t relroSize = util::align(imageSize / 8, BenchSegmentAlign);
+		uint64_t dataSize  = relroSize;
+		uint64_t codeSize  = imageSize - relroSize - dataSize;
+
+		enum
+		{
+			SegmentCode,
+			SegmentRelro,
+			SegmentData,
+			SegmentDynamic,
+			SegmentDynLib,
+			SegmentCount
+		};
+
+		Elf64_Phdr segments[SegmentCount] = {};
+
+		segments[SegmentCode].p_type   = PT_LOAD;
+		segments[SegmentCode].p_flags  = PF_R | PF_X;
+		segments[SegmentCode].p_offset = BenchSegmentAlign;
+		segments[SegmentCode].p_vaddr  = 0;
+		segments[SegmentCode].p_filesz = codeSize;
+		segments[SegmentCode].p_memsz  = codeSize;
+		segments[SegmentCode].p_align  = BenchSegmentAlign;
+
+		segments[SegmentRelro].p_type   = PT_SCE_RELRO;
+		segments[SegmentRelro].p_flags  = PF_R;
+		segments[SegmentRelro].p_offset = BenchSegmentAlign + codeSize;
+		segments[SegmentRelro].p_vaddr  = codeSize;
+		segments[SegmentRelro].p_filesz = relroSize;
+		segments[SegmentRelro].p_memsz  = relroSize;
+		segments[SegmentRelro].p_align  = BenchSegmentAlign;
+
+		segments[SegmentData].p_type   = PT_LOAD;
+		segments[SegmentData].p_flags  = PF_R | PF_W;
+		segments[SegmentData].p_offset = BenchSegmentAlign + codeSize + relroSize;
+		segments[SegmentData].p_vaddr  = codeSize + relroSize;
+		segments[SegmentData].p_filesz = dataSize / 2;
+		segments[SegmentData].p_memsz  = dataSize;
+		segments[SegmentData].p_align  = BenchSegmentAlign;
+
+		// Dynlib data holds a lone null symbol, an empty string table
+		// and the relocations, the dynamic table follows it.
+		std::vector<Elf64_Rela> relocations;
+		uint64_t                relocEnd = codeSize + relroSize + dataSize / 2;
+		for (uint64_t offset = codeSize; offset < relocEnd; offset += BenchRelocStride)
+		{
+			Elf64_Rela rela = {};
+			rela.r_offset   = offset;
+			rela.r_info     = R_X86_64_RELATIVE;
+			rela.r_addend   = offset % codeSize;
+			relocations.push_back(rela);
+		}
+
+		std::vector<uint8_t> dynLib(sizeof(Elf64_Sym) + sizeof(uint64_t), 0);
+		uint64_t             relaOffset = dynLib.size();
+		uint64_t             relaSize   = relocations.size() * sizeof(Elf64_Rela);
+		dynLib.resize(relaOffset + relaSize);
+		memcpy(dynLib.data() + relaOffset, relocations.data(), relaSize);
+
+		Elf64_Dyn dynamic[] = {
+			{ DT_SCE_SYMTAB, { 0 } },
+			{ DT_SCE_SYMTABSZ, { sizeof(Elf64_Sym) } },
+			{ DT_SCE_STRTAB, { sizeof(Elf64_Sym) } },
+			{ DT_SCE_STRSZ, { 1 } },
+			{ DT_SCE_RELA, { relaOffset } },
+			{ DT_SCE_RELASZ, { relaSize } },
+			{ DT_NULL, { 0 } },
+		};
+
+		segments[SegmentDynLib].p_type   = PT_SCE_DYNLIBDATA;
+		segments[SegmentDynLib].p_flags  = PF_R;
+		segments[SegmentDynLib].p_offset = segments[SegmentData].p_offset + segments[SegmentData].p_filesz;
+		segments[SegmentDynLib].p_filesz = dynLib.size();
+
+		segments[SegmentDynamic].p_type   = PT_DYNAMIC;
+		segments[SegmentDynamic].p_flags  = PF_R;
+		segments[SegmentDynamic].p_offset = segments[SegmentDynLib].p_offset + dynLib.size();
+		segments[SegmentDynamic].p_filesz = sizeof(dynamic);
+
+		Elf64_Ehdr header = {};
+		memcpy(header.e_ident, ELFMAG, SELFMAG);
+		header.e_ident[EI_CLASS] = ELFCLASS64;
+		header.e_ident[EI_DATA]  = ELFDATA2LSB;
+		header.e_type            = ET_SCE_DYNEXEC;
+		header.e_machine         = EM_X86_64;
+		header.e_phoff           = sizeof(Elf64_Ehdr);
+		header.e_phentsize       = sizeof(Elf64_Phdr);
+		header.e_phnum           = SegmentCount;
+
+		std::ofstream fout(m_filePath, std::ofstream::binary);
+
+		std::vector<uint8_t> headerPage(BenchSegmentAlign, 0);
+		memcpy(headerPage.data(), &header, sizeof(header));
+		memcpy(headerPage.data() + header.e_phoff, segments, sizeof(segments));
+		fout.write(reinterpret_cast<const char*>(headerPage.data()), headerPage.size());
+
+		// Code is int3, relro and data a pattern the relocations overwrite.
+		std::vector<uint8_t> content(1024 * 1024, 0xCC);
+		for (uint64_t written = 0; written < codeSize; written += content.size())
+		{
+			fout.write(reinterpret_cast<const char*>(content.data()),
+					   std::min<uint64_t>(content.size(), codeSize - written));
+		}
+
+		std::fill(content.begin(), content.end(), 0x5A);
+		uint64_t tableSize = relroSize + dataSize / 2;
+		for (uint64_t written = 0; written < tableSize; written += content.size())
+		{
+			fout.write(reinterpret_cast<const char*>(content.data()),
+					   std::min<uint64_t>(content.size(), tableSize - written));
+		}
+
+		fout.write(reinterpret_cast<const char*>(dynLib.data()), dynLib.size());
+		fout.write(reinterpret_cast<const char*>(dynamic), sizeof(dynamic));
+
+		ret = fout.good();
+	} while (false);
+	return ret;
+}
+
+void ELFMapperBench::removeFile()
+{
+	if (!m_root.empty())
+	{
+		std::error_code error;
+		std::filesystem::remove_all(m_root, error);
+		m_root.clear();
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "GPCS4Common.h"
+
+#include <string>
+
+struct ELFMapperBenchDesc
+{
+	// Size of the loadable image in MB.
+	uint32_t imageSize;
+	// Run each test N times and keep the fastest time.
+	uint32_t repeatCount;
+};
+
+// Loads a synthetic executable through ELFMapper, and the way it
+// was done before, reading the whole file and copying each segment.
+//
+// Reports the time to load and relocate the image, the memory it
+// keeps resident, and the time to touch every code page afterwards,
+// which is where the mapped path pays for its pages.
+
+class ELFMapperBench
+{
+public:
+	ELFMapperBench(const ELFMapperBenchDesc& desc);
+	~ELFMapperBench();
+
+	bool run();
+
+private:
+	bool createFile();
+
+	void removeFile();
+
+	bool runMapped();
+
+	bool runCopied();
+
+private:
+	ELFMapperBenchDesc m_desc;
+
+	std::string m_root;
+	std::string m_filePath;
+};
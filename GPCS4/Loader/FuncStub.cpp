@@ -1,11 +1,14 @@
 #include "FuncStub.h"
 #include "PlatDebug.h"
 
+#include <algorithm>
+#include <cstddef>
+
 LOG_CHANNEL(Loader.FuncStub);
 
 static void logFunc(const char *log) 
 {
-	LOG_TRACE(log); 
+	LOG_TRACE("%s", log); 
 }
 
 // Trap the debugger when an unresolved function is called.
@@ -136,6 +139,216 @@ void FuncStubGenerator::patchDestPointer(const void *dest)
 	patch(0x5c, reinterpret_cast<uint64_t>(dest));
 }
 
+// Both profile stubs start by loading the thread block, calling
+// the attach routine first if the thread has none yet.
+// The counters live at ProfileStubThread::counters[index].
+static_assert(offsetof(ProfileStubThread, depth) == 0x10, "depth offset is encoded in the stub.");
+static_assert(offsetof(ProfileStubThread, frames) == 0x20, "frames offset is encoded in the stub.");
+static_assert(sizeof(ProfileStubFrame) == 0x10, "frame size is encoded in the stub.");
+
+const ProfileStubGenerator::Template ProfileStubGenerator::timedTemplate = {
+	{
+		0x64, 0x4C, 0x8B, 0x1C, 0x25, 0xAA, 0xAA, 0xAA, 0xAA, // 00: mov r11, fs:[slot]
+		0x4D, 0x85, 0xDB,                                     // 09: test r11, r11
+		0x75, 0x0F,                                           // 0c: jnz 1d
+		0x49, 0xBB, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, // 0e: mov r11, _attach
+		0x41, 0xFF, 0xD3,                                     // 18: call r11
+		0xEB, 0xE3,                                           // 1b: jmp 00
+
+		0x49, 0x89, 0x03,                                     // 1d: mov [r11], rax
+		0x49, 0x89, 0x53, 0x08,                               // 20: mov [r11+8], rdx
+		0x49, 0x8B, 0x43, 0x10,                               // 24: mov rax, [r11+depth]
+		0x48, 0x83, 0xF8, ProfileStubMaxDepth,                // 28: cmp rax, max depth
+		0x73, 0x2F,                                           // 2c: jae 5d, too deep to time
+		0x49, 0xFF, 0x43, 0x10,                               // 2e: inc qword [r11+depth]
+		0x48, 0xC1, 0xE0, 0x04,                               // 32: shl rax, 4
+		0x4D, 0x8D, 0x94, 0x03, 0x20, 0x00, 0x00, 0x00,       // 36: lea r10, [r11+rax+frames]
+		0x48, 0x8B, 0x14, 0x24,                               // 3e: mov rdx, [rsp]
+		0x49, 0x89, 0x12,                                     // 42: mov [r10], rdx
+		0x48, 0x8D, 0x15, 0x25, 0x00, 0x00, 0x00,             // 45: lea rdx, [rip+exit]
+		0x48, 0x89, 0x14, 0x24,                               // 4c: mov [rsp], rdx
+		0x0F, 0x31,                                           // 50: rdtsc
+		0x48, 0xC1, 0xE2, 0x20,                               // 52: shl rdx, 32
+		0x48, 0x09, 0xD0,                                     // 56: or rax, rdx
+		0x49, 0x89, 0x42, 0x08,                               // 59: mov [r10+8], rax
+		0x49, 0x8B, 0x03,                                     // 5d: mov rax, [r11]
+		0x49, 0x8B, 0x53, 0x08,                               // 60: mov rdx, [r11+8]
+		0x49, 0xBB, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, // 64: mov r11, _dest
+		0x41, 0xFF, 0xE3,                                     // 6e: jmp r11
+
+		// exit, return values are in rax, rdx and xmm0-1
+		0x64, 0x4C, 0x8B, 0x1C, 0x25, 0xAA, 0xAA, 0xAA, 0xAA, // 71: mov r11, fs:[slot]
+		0x49, 0x89, 0x03,                                     // 7a: mov [r11], rax
+		0x49, 0x89, 0x53, 0x08,                               // 7d: mov [r11+8], rdx
+		0x0F, 0x31,                                           // 81: rdtsc
+		0x48, 0xC1, 0xE2, 0x20,                               // 83: shl rdx, 32
+		0x48, 0x09, 0xD0,                                     // 87: or rax, rdx
+		0x4D, 0x8B, 0x53, 0x10,                               // 8a: mov r10, [r11+depth]
+		0x49, 0xFF, 0xCA,                                     // 8e: dec r10
+		0x4D, 0x89, 0x53, 0x10,                               // 91: mov [r11+depth], r10
+		0x49, 0xC1, 0xE2, 0x04,                               // 95: shl r10, 4
+		0x4F, 0x8D, 0x94, 0x13, 0x20, 0x00, 0x00, 0x00,       // 99: lea r10, [r11+r10+frames]
+		0x49, 0x2B, 0x42, 0x08,                               // a1: sub rax, [r10+8]
+		0x49, 0x01, 0x83, 0xAA, 0xAA, 0xAA, 0xAA,             // a5: add [r11+_ticks], rax
+		0x49, 0xFF, 0x83, 0xAA, 0xAA, 0xAA, 0xAA,             // ac: inc qword [r11+_calls]
+		0x49, 0x8B, 0x03,                                     // b3: mov rax, [r11]
+		0x49, 0x8B, 0x53, 0x08,                               // b6: mov rdx, [r11+8]
+		// The return stack is off by one now, an indirect jump
+		// at least gets predicted per stub.
+		0x4D, 0x8B, 0x12,                                     // ba: mov r10, [r10]
+		0x41, 0xFF, 0xE2,                                     // bd: jmp r10
+	},
+	{ 0x00, 0x71 },
+	0x10,
+	0xaf,
+	0xa8,
+	0x66,
+};
+
+const ProfileStubGenerator::Template ProfileStubGenerator::countTemplate = {
+	{
+		0x64, 0x4C, 0x8B, 0x1C, 0x25, 0xAA, 0xAA, 0xAA, 0xAA, // 00: mov r11, fs:[slot]
+		0x4D, 0x85, 0xDB,                                     // 09: test r11, r11
+		0x75, 0x0F,                                           // 0c: jnz 1d
+		0x49, 0xBB, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, // 0e: mov r11, _attach
+		0x41, 0xFF, 0xD3,                                     // 18: call r11
+		0xEB, 0xE3,                                           // 1b: jmp 00
+
+		0x49, 0xFF, 0x83, 0xAA, 0xAA, 0xAA, 0xAA,             // 1d: inc qword [r11+_calls]
+		0x49, 0xBB, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, // 24: mov r11, _dest
+		0x41, 0xFF, 0xE3,                                     // 2e: jmp r11
+	},
+	{ 0x00 },
+	0x10,
+	0x20,
+	0,
+	0x26,
+};
+
+// Entered with a call from a stub, so the stack is 16 byte aligned.
+// Keeps the guest argument registers and calls into the host,
+// with shadow space for the Windows calling convention.
+const std::vector<uint8_t> ProfileStubGenerator::attachTemplate = {
+	0x50,                                           // push rax
+	0x57,                                           // push rdi
+	0x56,                                           // push rsi
+	0x52,                                           // push rdx
+	0x51,                                           // push rcx
+	0x41, 0x50,                                     // push r8
+	0x41, 0x51,                                     // push r9
+	0x41, 0x52,                                     // push r10
+	0x48, 0x81, 0xEC, 0xA0, 0x00, 0x00, 0x00,       // sub rsp, 0xa0
+	0xF3, 0x0F, 0x7F, 0x44, 0x24, 0x20,             // movdqu [rsp+0x20], xmm0
+	0xF3, 0x0F, 0x7F, 0x4C, 0x24, 0x30,             // movdqu [rsp+0x30], xmm1
+	0xF3, 0x0F, 0x7F, 0x54, 0x24, 0x40,             // movdqu [rsp+0x40], xmm2
+	0xF3, 0x0F, 0x7F, 0x5C, 0x24, 0x50,             // movdqu [rsp+0x50], xmm3
+	0xF3, 0x0F, 0x7F, 0x64, 0x24, 0x60,             // movdqu [rsp+0x60], xmm4
+	0xF3, 0x0F, 0x7F, 0x6C, 0x24, 0x70,             // movdqu [rsp+0x70], xmm5
+	0xF3, 0x0F, 0x7F, 0xB4, 0x24, 0x80, 0x00, 0x00, 0x00, // movdqu [rsp+0x80], xmm6
+	0xF3, 0x0F, 0x7F, 0xBC, 0x24, 0x90, 0x00, 0x00, 0x00, // movdqu [rsp+0x90], xmm7
+	0x48, 0xB8, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, // movabs rax, _attachThread
+	0xFF, 0xD0,                                     // call rax
+	0xF3, 0x0F, 0x6F, 0x44, 0x24, 0x20,             // movdqu xmm0, [rsp+0x20]
+	0xF3, 0x0F, 0x6F, 0x4C, 0x24, 0x30,             // movdqu xmm1, [rsp+0x30]
+	0xF3, 0x0F, 0x6F, 0x54, 0x24, 0x40,             // movdqu xmm2, [rsp+0x40]
+	0xF3, 0x0F, 0x6F, 0x5C, 0x24, 0x50,             // movdqu xmm3, [rsp+0x50]
+	0xF3, 0x0F, 0x6F, 0x64, 0x24, 0x60,             // movdqu xmm4, [rsp+0x60]
+	0xF3, 0x0F, 0x6F, 0x6C, 0x24, 0x70,             // movdqu xmm5, [rsp+0x70]
+	0xF3, 0x0F, 0x6F, 0xB4, 0x24, 0x80, 0x00, 0x00, 0x00, // movdqu xmm6, [rsp+0x80]
+	0xF3, 0x0F, 0x6F, 0xBC, 0x24, 0x90, 0x00, 0x00, 0x00, // movdqu xmm7, [rsp+0x90]
+	0x48, 0x81, 0xC4, 0xA0, 0x00, 0x00, 0x00,       // add rsp, 0xa0
+	0x41, 0x5A,                                     // pop r10
+	0x41, 0x59,                                     // pop r9
+	0x41, 0x58,                                     // pop r8
+	0x59,                                           // pop rcx
+	0x5A,                                           // pop rdx
+	0x5E,                                           // pop rsi
+	0x5F,                                           // pop rdi
+	0x58,                                           // pop rax
+	0xC3,                                           // ret
+};
+
+bool ProfileStubGenerator::attach(void *memory, bool timed)
+{
+	bool retval = false;
+	do
+	{
+		if (memory == nullptr)
+		{
+			LOG_ERR("null pointer error");
+			break;
+		}
+		m_memory   = reinterpret_cast<uint8_t *>(memory);
+		m_template = timed ? &timedTemplate : &countTemplate;
+		memcpy(m_memory, m_template->code.data(), m_template->code.size());
+		retval = true;
+	} while (false);
+
+	return retval;
+}
+
+void ProfileStubGenerator::patchThreadSlot(const plat::ThreadSlot &slot)
+{
+	for (auto offset : m_template->slotOffsets)
+	{
+		patch(offset, slot.segmentPrefix);
+		patch(offset + 5, slot.offset);
+	}
+}
+
+void ProfileStubGenerator::patchAttachRoutine(const void *routine)
+{
+	patch(m_template->attachOffset, reinterpret_cast<uint64_t>(routine));
+}
+
+void ProfileStubGenerator::patchCounterIndex(uint32_t index)
+{
+	// Displacements are 32 bits.
+	size_t counter = offsetof(ProfileStubThread, counters) + index * sizeof(ProfileStubCounter);
+	patch(m_template->callCountOffset,
+		  static_cast<uint32_t>(counter + offsetof(ProfileStubCounter, callCount)));
+	if (m_template->tickCountOffset != 0)
+	{
+		patch(m_template->tickCountOffset,
+			  static_cast<uint32_t>(counter + offsetof(ProfileStubCounter, tickCount)));
+	}
+}
+
+void ProfileStubGenerator::patchDestPointer(const void *dest)
+{
+	patch(m_template->destOffset, reinterpret_cast<uint64_t>(dest));
+}
+
+size_t ProfileStubGenerator::size() const
+{
+	return std::max(timedTemplate.code.size(), countTemplate.code.size());
+}
+
+bool ProfileStubGenerator::generateAttachRoutine(void *memory, void (*attachThread)())
+{
+	bool retval = false;
+	do
+	{
+		if (memory == nullptr)
+		{
+			LOG_ERR("null pointer error");
+			break;
+		}
+		m_memory   = reinterpret_cast<uint8_t *>(memory);
+		m_template = nullptr;
+		memcpy(m_memory, attachTemplate.data(), attachTemplate.size());
+		patch(0x4a, reinterpret_cast<uint64_t>(attachThread));
+		retval = true;
+	} while (false);
+
+	return retval;
+}
+
+size_t ProfileStubGenerator::attachRoutineSize() const
+{
+	return attachTemplate.size();
+}
+
 FuncStubManager::FuncStubManager(JitFunctionPool *pool, FuncStubGenerator *stub)
 	: m_pool{pool}, m_stub{stub}
 {
@@ -143,6 +356,8 @@ FuncStubManager::FuncStubManager(JitFunctionPool *pool, FuncStubGenerator *stub)
 
 void *FuncStubManager::generate(std::string const &message, void *dest)
 {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
 	void *retPtr = nullptr;
 	do
 	{
@@ -4,6 +4,8 @@
 #include "Platform.h"
 
 #include <vector>
+#include <deque>
+#include <mutex>
 #include <string>
 #include <cstdint>
 
@@ -44,6 +46,92 @@ private:
 	const static std::vector<uint8_t> funcTemplate;
 };
 
+// Counters of one thread the profile stubs write to.
+// The stubs find it through a thread slot, and the
+// field offsets are encoded in the stub templates.
+
+constexpr uint32_t ProfileStubMaxDepth = 64;
+constexpr uint32_t ProfileStubMaxCount = 8192;
+
+struct ProfileStubFrame
+{
+	uint64_t returnAddress;
+	uint64_t startTick;
+};
+
+struct ProfileStubCounter
+{
+	uint64_t callCount;
+	// Inclusive, in TSC ticks.
+	uint64_t tickCount;
+};
+
+struct ProfileStubThread
+{
+	// rax and rdx are kept here while rdtsc runs.
+	uint64_t           scratch[2];
+	uint64_t           depth;
+	uint64_t           threadId;
+	ProfileStubFrame   frames[ProfileStubMaxDepth];
+	ProfileStubCounter counters[ProfileStubMaxCount];
+};
+
+// Stubs counting the calls to a function, no locks
+// and no host calls except the first time a thread
+// comes through, where the attach routine is called.
+//
+// A timed stub also swaps the return address for its own
+// to read the TSC again on return, so it must not be used
+// for functions which don't return to their caller once,
+// like longjmp or fiber switches. A count stub only counts.
+
+class ProfileStubGenerator
+{
+public:
+	ProfileStubGenerator() = default;
+	bool attach(void *memory, bool timed);
+	void patchThreadSlot(const plat::ThreadSlot &slot);
+	void patchAttachRoutine(const void *routine);
+	void patchCounterIndex(uint32_t index);
+	void patchDestPointer(const void *destPointer);
+	size_t size() const;
+
+	// The attach routine keeps the argument registers and
+	// calls attachThread, which must set the thread slot.
+	bool generateAttachRoutine(void *memory, void (*attachThread)());
+	size_t attachRoutineSize() const;
+
+private:
+	template <typename T>
+	void patch(size_t offset, T value)
+	{
+		auto ptr = reinterpret_cast<T *>(&m_memory[offset]);
+		*ptr     = value;
+	}
+
+	struct Template
+	{
+		std::vector<uint8_t> code;
+		// Offsets of the segment prefix and displacement
+		// of each thread slot load.
+		std::vector<size_t> slotOffsets;
+		size_t              attachOffset;
+		size_t              callCountOffset;
+		// Zero if the stub doesn't time.
+		size_t tickCountOffset;
+		size_t destOffset;
+	};
+
+	uint8_t        *m_memory   = nullptr;
+	const Template *m_template = nullptr;
+	const static Template timedTemplate;
+	const static Template countTemplate;
+	const static std::vector<uint8_t> attachTemplate;
+};
+
+// Modules are relocated on several threads, so stubs
+// can be generated concurrently.
+
 class FuncStubManager
 {
 public:
@@ -51,7 +139,9 @@ public:
 	void *generate(std::string const &message, void *dest);
 	void *generateUnknown(std::string const &message);
 private:
-	std::vector<std::string> m_messageList;
+	std::mutex m_mutex;
+	// Stubs point to the messages, which must not move.
+	std::deque<std::string> m_messageList;
 	JitFunctionPool *m_pool;
 	FuncStubGenerator *m_stub;
 };
@@ -3,8 +3,18 @@
 #include "UtilString.h"
 #include "Platform.h"
 
+#include <cstdio>
+
 LOG_CHANNEL(Loader.ModuleLoader);
 
+static uint64_t elapsedMicroseconds(std::chrono::steady_clock::time_point& start)
+{
+	auto now     = std::chrono::steady_clock::now();
+	auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - start);
+	start        = now;
+	return elapsed.count();
+}
+
 #define ADD_BLACK_MODULE(name) (name".sprx")
 
 const std::set<std::string> ModuleLoader::m_moduleInitBlackList = 
@@ -30,6 +40,9 @@ bool ModuleLoader::loadModule(std::string const &fileName,
 	do
 	{
 		NativeModule mod = {};
+		m_stats          = {};
+
+		auto start = std::chrono::steady_clock::now();
 
 		bool exist = false;
 		retVal = loadModuleFromFile(fileName, &mod, &exist);
@@ -50,24 +63,36 @@ bool ModuleLoader::loadModule(std::string const &fileName,
 			break;
 		}
 
+		m_stats.mapTime = elapsedMicroseconds(start);
+
 		retVal = loadDependencies();
 		if (!retVal)
 		{
 			break;
 		}
 
+		m_stats.dependencyTime = elapsedMicroseconds(start);
+
 		retVal = m_linker.relocateModules();
 		if (!retVal)
 		{
 			break;
 		}
 
+		m_stats.relocateTime    = elapsedMicroseconds(start);
+		m_stats.relocationCount = m_linker.getRelocationCount();
+
+		// Modules are still initialized one by one, in load order.
 		retVal = initializeModules();
 		if (!retVal)
 		{
 			break;
 		}
 
+		m_stats.initializeTime = elapsedMicroseconds(start);
+		m_stats.moduleCount    = static_cast<uint32_t>(m_modSystem.getAllNativeModules().size());
+		reportLoadStats();
+
 		*modOut = &(m_modSystem.getAllNativeModules()[0]);
 		retVal  = true;
 	} while (false);
@@ -75,6 +100,26 @@ bool ModuleLoader::loadModule(std::string const &fileName,
 	return retVal;
 }
 
+ModuleLoadStats const &ModuleLoader::getLoadStats() const
+{
+	return m_stats;
+}
+
+void ModuleLoader::reportLoadStats() const
+{
+	auto toMs = [](uint64_t us) { return us / 1000.0; };
+
+	uint64_t total = m_stats.mapTime + m_stats.dependencyTime +
+					 m_stats.relocateTime + m_stats.initializeTime;
+	// Printed in every build, it's what boot time work is measured by.
+	std::printf("%u modules loaded in %.2f ms\n", m_stats.moduleCount, toMs(total));
+	std::printf("  map executable : %.2f ms\n", toMs(m_stats.mapTime));
+	std::printf("  dependencies   : %.2f ms\n", toMs(m_stats.dependencyTime));
+	std::printf("  relocation     : %.2f ms, %llu relocations\n",
+				toMs(m_stats.relocateTime), static_cast<unsigned long long>(m_stats.relocationCount));
+	std::printf("  initialization : %.2f ms\n", toMs(m_stats.initializeTime));
+}
+
 bool ModuleLoader::loadModuleFromFile(std::string const &fileName,
 									  NativeModule *mod,
 									  bool *exist)
@@ -313,8 +358,8 @@ bool ModuleLoader::registerSymbol(NativeModule const &mod, size_t idx)
 
 	if (info->isEncoded)
 	{
-		m_modSystem.registerNativeSymbol(info->moduleName, info->libraryName, info->nid,
-									 reinterpret_cast<void *>(info->address));
+		SymbolKey key = { info->moduleId, info->libraryId, info->nid };
+		m_modSystem.registerNativeSymbol(key, reinterpret_cast<void *>(info->address));
 	}
 	else
 	{
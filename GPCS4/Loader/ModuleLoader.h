@@ -8,16 +8,33 @@
 #include "Emulator/SceModuleSystem.h"
 #include "Emulator/TLSHandler.h"
 
+#include <chrono>
 #include <queue>
 #include <set>
 #include <string>
 
+// Time spent in each phase of loadModule, in microseconds.
+struct ModuleLoadStats
+{
+	uint64_t mapTime;
+	uint64_t dependencyTime;
+	uint64_t relocateTime;
+	uint64_t initializeTime;
+	uint32_t moduleCount;
+	uint64_t relocationCount;
+};
+
 class ModuleLoader
 {
 public:
 	ModuleLoader(CSceModuleSystem &modSystem, CLinker &linker);
 	bool loadModule(std::string const &fileName, NativeModule **mod);
+
+	ModuleLoadStats const &getLoadStats() const;
+
 private:
+	void reportLoadStats() const;
+
 	bool loadModuleFromFile(std::string const &fileName,
 							NativeModule *mod,
 							bool *exist);
@@ -38,6 +55,7 @@ private:
 	CSceModuleSystem &m_modSystem;
 	CLinker &m_linker;
 	ELFMapper m_mapper;
+	ModuleLoadStats m_stats = {};
 
 	// init_proc of modules in this black list will not be called.
 	const static std::set<std::string> m_moduleInitBlackList;
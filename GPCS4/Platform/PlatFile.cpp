@@ -1,6 +1,13 @@
 #include "PlatFile.h"
 #include <fstream>
 
+#ifdef GPCS4_LINUX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // GPCS4_LINUX
+
 namespace plat
 {;
 
@@ -76,11 +83,142 @@ bool StoreFile(const std::string& strFilename, const std::vector<uint8_t>& vtDat
 #include <Windows.h>
 #undef WIN32_LEAN_AND_MEAN
 
+MappedFile* MapFile(const std::string& strFilename)
+{
+	MappedFile* pFile    = nullptr;
+	HANDLE      hFile    = INVALID_HANDLE_VALUE;
+	HANDLE      hMapping = nullptr;
+	do
+	{
+		hFile = CreateFileA(strFilename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+							OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (hFile == INVALID_HANDLE_VALUE)
+		{
+			break;
+		}
+
+		LARGE_INTEGER nFileSize = {};
+		if (!GetFileSizeEx(hFile, &nFileSize) || nFileSize.QuadPart == 0)
+		{
+			break;
+		}
 
+		hMapping = CreateFileMappingA(hFile, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		if (!hMapping)
+		{
+			break;
+		}
 
+		void* pView = MapViewOfFile(hMapping, FILE_MAP_COPY, 0, 0, 0);
+		if (!pView)
+		{
+			break;
+		}
+
+		pFile           = new MappedFile();
+		pFile->pData    = reinterpret_cast<uint8_t*>(pView);
+		pFile->nSize    = static_cast<size_t>(nFileSize.QuadPart);
+		pFile->hFile    = reinterpret_cast<intptr_t>(hFile);
+		pFile->hMapping = reinterpret_cast<intptr_t>(hMapping);
+	} while (false);
+
+	if (!pFile)
+	{
+		if (hMapping)
+		{
+			CloseHandle(hMapping);
+		}
+		if (hFile != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(hFile);
+		}
+	}
+	return pFile;
+}
+
+void UnmapFile(MappedFile* pFile)
+{
+	UnmapViewOfFile(pFile->pData);
+	CloseHandle(reinterpret_cast<HANDLE>(pFile->hMapping));
+	CloseHandle(reinterpret_cast<HANDLE>(pFile->hFile));
+	delete pFile;
+}
 
 #else
 
+MappedFile* MapFile(const std::string& strFilename)
+{
+	MappedFile* pFile = nullptr;
+	int         fd    = -1;
+	do
+	{
+		fd = open(strFilename.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+		{
+			break;
+		}
+
+		struct stat st = {};
+		if (fstat(fd, &st) != 0 || st.st_size == 0)
+		{
+			break;
+		}
+
+		void* pView = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		if (pView == MAP_FAILED)
+		{
+			break;
+		}
+
+		pFile           = new MappedFile();
+		pFile->pData    = reinterpret_cast<uint8_t*>(pView);
+		pFile->nSize    = static_cast<size_t>(st.st_size);
+		pFile->hFile    = fd;
+		pFile->hMapping = 0;
+	} while (false);
+
+	if (!pFile && fd >= 0)
+	{
+		close(fd);
+	}
+	return pFile;
+}
+
+void UnmapFile(MappedFile* pFile)
+{
+	munmap(pFile->pData, pFile->nSize);
+	close(static_cast<int>(pFile->hFile));
+	delete pFile;
+}
+
+bool MapFileFixed(const MappedFile* pFile, size_t nOffset,
+	void* pAddress, size_t nSize, VM_PROTECT_FLAG nProtect)
+{
+	bool bRet = false;
+	do
+	{
+		if ((nOffset % VM_PAGE_SIZE) != 0 ||
+			(reinterpret_cast<uintptr_t>(pAddress) % VM_PAGE_SIZE) != 0)
+		{
+			break;
+		}
+
+		int nProt = PROT_NONE;
+		nProt |= (nProtect & VMPF_CPU_READ) ? PROT_READ : 0;
+		nProt |= (nProtect & VMPF_CPU_WRITE) ? PROT_WRITE : 0;
+		nProt |= (nProtect & VMPF_CPU_EXEC) ? PROT_EXEC : 0;
+
+		void* pMem = mmap(pAddress, nSize, nProt, MAP_PRIVATE | MAP_FIXED,
+						  static_cast<int>(pFile->hFile), nOffset);
+		if (pMem == MAP_FAILED)
+		{
+			break;
+		}
+
+		bRet = true;
+	} while (false);
+	return bRet;
+}
 
 #endif  //GPCS4_WINDOWS
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "GPCS4Common.h"
+#include "PlatMemory.h"
 
 #include <string>
 #include <vector>
@@ -28,4 +29,43 @@ struct FileCloser
 
 typedef std::unique_ptr<FILE, FileCloser> file_uptr;
 
+// A private view of a whole file.
+// Pages are read in by the host on first touch,
+// written pages are copied and never reach the file.
+struct MappedFile
+{
+	uint8_t*       pData;
+	size_t         nSize;
+	intptr_t       hFile;
+	intptr_t       hMapping;
+};
+
+MappedFile* MapFile(const std::string& strFilename);
+
+void UnmapFile(MappedFile* pFile);
+
+#ifndef GPCS4_WINDOWS
+
+// Maps nSize bytes of the file at nOffset onto pAddress, replacing the pages there.
+// The pages are private, written pages are copied on write and never reach the file.
+// Both pAddress and nOffset must be page aligned.
+// Windows can only place a view into a placeholder reservation,
+// at an offset aligned to the 64K allocation granularity,
+// so there the caller copies out of the whole file view instead.
+bool MapFileFixed(const MappedFile* pFile, size_t nOffset, 
+	void* pAddress, size_t nSize, VM_PROTECT_FLAG nProtect);
+
+#endif  // GPCS4_WINDOWS
+
+struct FileUnMapper
+{
+	void operator()(MappedFile* pFile) const noexcept
+	{
+		if (pFile != nullptr)
+			UnmapFile(pFile);
+	}
+};
+
+typedef std::unique_ptr<MappedFile, FileUnMapper> mapped_file_ptr;
+
 }
@@ -1,5 +1,17 @@
 #include "PlatHardware.h"
 
+#ifdef GPCS4_WINDOWS
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif  // GPCS4_WINDOWS
+
+#ifdef GPCS4_LINUX
+#include <sched.h>
+#include <cstdio>
+#include <cstdlib>
+#endif  // GPCS4_LINUX
+
 
 namespace plat
 {
@@ -26,11 +38,260 @@ uint64_t GetTscFrequency()
 	return nFreq;
 }
 
+bool GetCpuTopology(std::vector<CpuCoreInfo>& cores, uint32_t& skippedCount)
+{
+	bool ret = false;
+	do
+	{
+		cores.clear();
+		skippedCount = 0;
 
-#else
+		// Processes spanning several groups get no mask at all.
+		DWORD_PTR processMask = 0;
+		DWORD_PTR systemMask  = 0;
+		if (!GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask) || !processMask)
+		{
+			break;
+		}
+
+		GROUP_AFFINITY groupAffinity = {};
+		if (!GetThreadGroupAffinity(GetCurrentThread(), &groupAffinity))
+		{
+			break;
+		}
+		WORD group = groupAffinity.Group;
+
+		DWORD length = 0;
+		GetLogicalProcessorInformationEx(RelationAll, nullptr, &length);
+		if (GetLastError() != ERROR_INSUFFICIENT_BUFFER)
+		{
+			break;
+		}
+
+		std::vector<uint8_t> buffer(length);
+		auto                 info = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data());
+		if (!GetLogicalProcessorInformationEx(RelationAll, info, &length))
+		{
+			break;
+		}
+
+		// Caches come in any order relative to cores,
+		// collect them first and match by mask afterwards.
+		std::vector<uint64_t> caches;
+		uint32_t              cacheLevel = 0;
+
+		for (DWORD offset = 0; offset < length;)
+		{
+			auto entry = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + offset);
+			if (entry->Relationship == RelationProcessorCore)
+			{
+				const GROUP_AFFINITY& groupMask = entry->Processor.GroupMask[0];
+				if (groupMask.Group != group)
+				{
+					skippedCount += static_cast<uint32_t>(__popcnt64(groupMask.Mask));
+				}
+				else if (uint64_t mask = groupMask.Mask & processMask)
+				{
+					cores.push_back({ mask, 0 });
+				}
+			}
+			else if (entry->Relationship == RelationCache &&
+					 entry->Cache.GroupMask.Group == group &&
+					 (entry->Cache.Type == CacheUnified || entry->Cache.Type == CacheData))
+			{
+				if (entry->Cache.Level > cacheLevel)
+				{
+					cacheLevel = entry->Cache.Level;
+					caches.clear();
+				}
+				if (entry->Cache.Level == cacheLevel)
+				{
+					caches.push_back(entry->Cache.GroupMask.Mask);
+				}
+			}
+			offset += entry->Size;
+		}
+
+		for (auto& core : cores)
+		{
+			for (uint32_t i = 0; i != caches.size(); ++i)
+			{
+				if (core.threadMask & caches[i])
+				{
+					core.cacheId = i;
+					break;
+				}
+			}
+		}
+
+		ret = !cores.empty();
+	} while (false);
+	return ret;
+}
 
+uint32_t GetCurrentProcessor()
+{
+	return GetCurrentProcessorNumber();
+}
+
+#elif defined(GPCS4_LINUX)
+
+// Parses a sysfs cpu list, e.g. "0-3,8-11".
+static uint64_t readCpuList(const char* path)
+{
+	uint64_t mask = 0;
+	do
+	{
+		FILE* file = fopen(path, "r");
+		if (!file)
+		{
+			break;
+		}
+
+		char list[256] = {};
+		bool read      = fgets(list, sizeof(list), file) != nullptr;
+		fclose(file);
+		if (!read)
+		{
+			break;
+		}
+
+		char* cursor = list;
+		while (*cursor >= '0' && *cursor <= '9')
+		{
+			uint32_t first = strtoul(cursor, &cursor, 10);
+			uint32_t last  = first;
+			if (*cursor == '-')
+			{
+				last = strtoul(cursor + 1, &cursor, 10);
+			}
+			for (uint32_t i = first; i <= last && i < 64; ++i)
+			{
+				mask |= 1ull << i;
+			}
+			if (*cursor == ',')
+			{
+				++cursor;
+			}
+		}
+	} while (false);
+	return mask;
+}
+
+uint64_t GetTscFrequency()
+{
+	return 0;
+}
+
+bool GetCpuTopology(std::vector<CpuCoreInfo>& cores, uint32_t& skippedCount)
+{
+	cores.clear();
+	skippedCount = 0;
+
+	// Only the processors the process may run on,
+	// these need not be numbered from 0 nor be contiguous.
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+	{
+		return false;
+	}
+
+	uint64_t allowedMask = 0;
+	for (uint32_t cpu = 0; cpu != CPU_SETSIZE; ++cpu)
+	{
+		if (!CPU_ISSET(cpu, &allowed))
+		{
+			continue;
+		}
+		if (cpu >= 64)
+		{
+			++skippedCount;
+			continue;
+		}
+		allowedMask |= 1ull << cpu;
+	}
+
+	uint64_t              visited = 0;
+	std::vector<uint64_t> caches;
+	for (uint32_t cpu = 0; cpu != 64; ++cpu)
+	{
+		if (!(allowedMask & (1ull << cpu)) || (visited & (1ull << cpu)))
+		{
+			continue;
+		}
+
+		char path[128];
+		snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/thread_siblings_list", cpu);
+		uint64_t threadMask = readCpuList(path) & allowedMask;
+		if (!threadMask)
+		{
+			threadMask = 1ull << cpu;
+		}
+		visited |= threadMask;
+
+		// The highest cache index is the last level cache.
+		uint64_t cacheMask = 0;
+		for (uint32_t index = 0; index != 8; ++index)
+		{
+			snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/shared_cpu_list", cpu, index);
+			uint64_t mask = readCpuList(path);
+			if (!mask)
+			{
+				break;
+			}
+			cacheMask = mask;
+		}
+
+		uint32_t cacheId = 0;
+		while (cacheId != caches.size() && !(caches[cacheId] & threadMask))
+		{
+			++cacheId;
+		}
+		if (cacheId == caches.size())
+		{
+			caches.push_back(cacheMask ? cacheMask : threadMask);
+		}
+
+		cores.push_back({ threadMask, cacheId });
+	}
+
+	return !cores.empty();
+}
+
+uint32_t GetCurrentProcessor()
+{
+	int cpu = sched_getcpu();
+	return cpu < 0 ? 0 : static_cast<uint32_t>(cpu);
+}
 
 #endif  //GPCS4_WINDOWS
 
 
+bool IsTscInvariant()
+{
+	bool ret = false;
+	do
+	{
+		// Power management leaf, edx bit 8 is invariant tsc.
+		uint32_t regs[4] = {};
+#ifdef GPCS4_WINDOWS
+		__cpuid(reinterpret_cast<int*>(regs), 0x80000000);
+		if (regs[0] < 0x80000007)
+		{
+			break;
+		}
+		__cpuid(reinterpret_cast<int*>(regs), 0x80000007);
+#else
+		if (!__get_cpuid(0x80000007, &regs[0], &regs[1], &regs[2], &regs[3]))
+		{
+			break;
+		}
+#endif  // GPCS4_WINDOWS
+		ret = (regs[3] & (1u << 8)) != 0;
+	} while (false);
+	return ret;
+}
+
+
 }
\ No newline at end of file
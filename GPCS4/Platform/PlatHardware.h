@@ -2,6 +2,8 @@
 
 #include "GPCS4Common.h"
 
+#include <vector>
+
 
 namespace plat
 {
@@ -9,5 +11,28 @@ namespace plat
 
 uint64_t GetTscFrequency();
 
+// Whether the tsc ticks at a constant rate, in all power
+// states and on all cores, so it can be used as a clock.
+bool IsTscInvariant();
+
+
+struct CpuCoreInfo
+{
+	// Logical processors of the physical core,
+	// more than one bit set with SMT.
+	uint64_t threadMask;
+	// Cores sharing the last level cache have the same id.
+	uint32_t cacheId;
+};
+
+// Physical cores the process is allowed to run on,
+// processors outside the process affinity mask are left out.
+// Masks only hold 64 processors, so processors of other groups
+// on Windows and above 63 on Linux are skipped and counted in skippedCount.
+bool GetCpuTopology(std::vector<CpuCoreInfo>& cores, uint32_t& skippedCount);
+
+// Logical processor the calling thread is running on.
+uint32_t GetCurrentProcessor();
+
 
 }
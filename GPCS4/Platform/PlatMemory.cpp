@@ -1,5 +1,11 @@
 #include "PlatMemory.h"
 
+#ifdef GPCS4_LINUX
+#include <sys/mman.h>
+#include <map>
+#include <mutex>
+#endif  // GPCS4_LINUX
+
 LOG_CHANNEL(Platform.UtilMemory);
 
 namespace plat
@@ -110,6 +116,11 @@ inline uint32_t GetTypeFlag(VM_ALLOCATION_TYPE nOldFlag)
 			nNewFlag |= MEM_COMMIT;
 		}
 
+		if (nOldFlag & VMAT_WRITE_WATCH)
+		{
+			nNewFlag |= MEM_WRITE_WATCH;
+		}
+
 	} while (false);
 	return nNewFlag;
 }
@@ -209,10 +220,233 @@ bool VMQuery(void* pAddress, MemoryInformation* pInfo)
 	return ret;
 }
 
+bool VMGetWrittenPages(void* pAddress, size_t nSize, std::vector<void*>& pages)
+{
+	bool bRet = false;
+	do
+	{
+		uintptr_t pStart = util::alignDown(reinterpret_cast<uintptr_t>(pAddress), VM_PAGE_SIZE);
+		size_t    nLen   = util::align(reinterpret_cast<uintptr_t>(pAddress) + nSize, VM_PAGE_SIZE) - pStart;
+
+		// Room for every page, so one call returns them all.
+		ULONG_PTR nCount       = nLen / VM_PAGE_SIZE;
+		DWORD     nGranularity = 0;
+		pages.resize(nCount);
+		if (GetWriteWatch(WRITE_WATCH_FLAG_RESET, reinterpret_cast<void*>(pStart), nLen,
+						  pages.data(), &nCount, &nGranularity) != 0)
+		{
+			pages.clear();
+			break;
+		}
+
+		pages.resize(nCount);
+		bRet = true;
+	} while (false);
+	return bRet;
+}
+
 
 #elif defined(GPCS4_LINUX)
 
-//TODO: Other platform implementation 
+// munmap needs the size of the region, which VMFree isn't given,
+// so every region we map is recorded here.
+struct RegionRecord
+{
+	size_t          nSize;
+	VM_PROTECT_FLAG nProtect;
+};
+
+static std::mutex                     g_regionMutex;
+static std::map<uintptr_t, RegionRecord> g_regionMap;
+
+inline int GetProtectFlag(VM_PROTECT_FLAG nOldFlag)
+{
+	int nNewFlag = PROT_NONE;
+	if (nOldFlag & VMPF_CPU_READ)
+	{
+		nNewFlag |= PROT_READ;
+	}
+
+	if (nOldFlag & VMPF_CPU_WRITE)
+	{
+		nNewFlag |= PROT_WRITE;
+	}
+
+	if (nOldFlag & VMPF_CPU_EXEC)
+	{
+		nNewFlag |= PROT_EXEC;
+	}
+	return nNewFlag;
+}
+
+static void RecordRegion(void* pAddress, size_t nSize, VM_PROTECT_FLAG nProtect)
+{
+	std::lock_guard<std::mutex> lock(g_regionMutex);
+	g_regionMap[reinterpret_cast<uintptr_t>(pAddress)] = { nSize, nProtect };
+}
+
+void* VMAllocate(void* pAddress, size_t nSize,
+	VM_ALLOCATION_TYPE nType, VM_PROTECT_FLAG nProtect)
+{
+	void* pAddr = nullptr;
+	do
+	{
+		// A reserved only region is kept inaccessible until it is committed.
+		int nProt  = (nType & VMAT_COMMIT) ? GetProtectFlag(nProtect) : PROT_NONE;
+		int nFlags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+		if (pAddress)
+		{
+			nFlags |= MAP_FIXED_NOREPLACE;
+		}
+
+		void* pMem = mmap(pAddress, nSize, nProt, nFlags, -1, 0);
+		if (pMem == MAP_FAILED)
+		{
+			break;
+		}
+
+		if (pAddress && pMem != pAddress)
+		{
+			// Old kernels take MAP_FIXED_NOREPLACE as a hint.
+			munmap(pMem, nSize);
+			break;
+		}
+
+		RecordRegion(pMem, nSize, nProtect);
+		pAddr = pMem;
+	} while (false);
+	return pAddr;
+}
+
+void* VMAllocateAlign(void* pAddress, size_t nSize, size_t nAlign,
+	VM_ALLOCATION_TYPE nType, VM_PROTECT_FLAG nProtect)
+{
+	void* pAlignedAddr = nullptr;
+	do
+	{
+		nAlign = util::align(nAlign, VM_PAGE_SIZE);
+		nSize  = util::align(nSize, VM_PAGE_SIZE);
+
+		// Map enough to hold an aligned block, then trim both ends.
+		size_t nTotalSize = nSize + nAlign;
+		int    nFlags     = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+		void*  pAddr      = mmap(pAddress, nTotalSize, GetProtectFlag(nProtect), nFlags, -1, 0);
+		if (pAddr == MAP_FAILED)
+		{
+			break;
+		}
+
+		uintptr_t pStart   = reinterpret_cast<uintptr_t>(pAddr);
+		uintptr_t pAligned = util::align(pStart, nAlign);
+		size_t    nHead    = pAligned - pStart;
+		size_t    nTail    = nTotalSize - nHead - nSize;
+		if (nHead)
+		{
+			munmap(pAddr, nHead);
+		}
+		if (nTail)
+		{
+			munmap(reinterpret_cast<void*>(pAligned + nSize), nTail);
+		}
+
+		RecordRegion(reinterpret_cast<void*>(pAligned), nSize, nProtect);
+		pAlignedAddr = reinterpret_cast<void*>(pAligned);
+	} while (false);
+	return pAlignedAddr;
+}
+
+void VMFree(void* pAddress)
+{
+	do
+	{
+		size_t nSize = 0;
+		{
+			std::lock_guard<std::mutex> lock(g_regionMutex);
+			auto iter = g_regionMap.find(reinterpret_cast<uintptr_t>(pAddress));
+			if (iter == g_regionMap.end())
+			{
+				LOG_ERR("free unknown region %p", pAddress);
+				break;
+			}
+			nSize = iter->second.nSize;
+			g_regionMap.erase(iter);
+		}
+
+		munmap(pAddress, nSize);
+	} while (false);
+}
+
+bool VMProtect(void* pAddress, size_t nSize,
+	VM_PROTECT_FLAG nNewProtect, VM_PROTECT_FLAG* pOldProtect)
+{
+	bool bRet = false;
+	do
+	{
+		uintptr_t pStart = util::alignDown(reinterpret_cast<uintptr_t>(pAddress), VM_PAGE_SIZE);
+		size_t    nLen   = util::align(reinterpret_cast<uintptr_t>(pAddress) + nSize, VM_PAGE_SIZE) - pStart;
+
+		if (pOldProtect)
+		{
+			// Linux doesn't report page protection cheaply,
+			// the region's last recorded protection is returned.
+			MemoryInformation info = {};
+			*pOldProtect           = VMQuery(pAddress, &info) ? info.nRegionProtect : VMPF_NOACCESS;
+		}
+
+		if (mprotect(reinterpret_cast<void*>(pStart), nLen, GetProtectFlag(nNewProtect)) != 0)
+		{
+			break;
+		}
+
+		std::lock_guard<std::mutex> lock(g_regionMutex);
+		auto iter = g_regionMap.find(pStart);
+		if (iter != g_regionMap.end() && iter->second.nSize == nLen)
+		{
+			iter->second.nProtect = nNewProtect;
+		}
+
+		bRet = true;
+	} while (false);
+	return bRet;
+}
+
+bool VMQuery(void* pAddress, MemoryInformation* pInfo)
+{
+	bool ret = false;
+	do
+	{
+		std::lock_guard<std::mutex> lock(g_regionMutex);
+
+		uintptr_t nAddr = reinterpret_cast<uintptr_t>(pAddress);
+		auto      iter  = g_regionMap.upper_bound(nAddr);
+		if (iter == g_regionMap.begin())
+		{
+			break;
+		}
+
+		--iter;
+		if (nAddr >= iter->first + iter->second.nSize)
+		{
+			break;
+		}
+
+		pInfo->pRegionStart   = reinterpret_cast<void*>(iter->first);
+		pInfo->nRegionSize    = iter->second.nSize;
+		pInfo->nRegionState   = VMRS_COMMIT;
+		pInfo->nRegionProtect = iter->second.nProtect;
+
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+bool VMGetWrittenPages(void* pAddress, size_t nSize, std::vector<void*>& pages)
+{
+	// Soft dirty bits are per process, not per range,
+	// and clearing them would race with other readers.
+	pages.clear();
+	return false;
+}
 
 #endif  //GPCS4_WINDOWS
 
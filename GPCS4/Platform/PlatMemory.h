@@ -2,6 +2,7 @@
 #include "GPCS4Common.h"
 
 #include <memory>
+#include <vector>
 
 //Virtual memory stuffs
 // NOTE:
@@ -30,7 +31,11 @@ enum VM_ALLOCATION_TYPE
 {
 	VMAT_RESERVE	=	0x00000001,
 	VMAT_COMMIT		=	0x00000010,
-	VMAT_RESERVE_COMMIT = VMAT_RESERVE | VMAT_COMMIT
+	VMAT_RESERVE_COMMIT = VMAT_RESERVE | VMAT_COMMIT,
+	// Track written pages, see VMGetWrittenPages.
+	// Must be given when the region is reserved.
+	VMAT_WRITE_WATCH	=	0x00000100,
+	VMAT_RESERVE_COMMIT_WATCH = VMAT_RESERVE_COMMIT | VMAT_WRITE_WATCH
 };
 
 enum VM_REGION_STATE
@@ -61,6 +66,11 @@ bool VMProtect(void* pAddress, size_t nSize,
 
 bool VMQuery(void* pAddress, MemoryInformation* pInfo);
 
+// Gets the pages written since the last call and resets their state.
+// The range must lie in a single region allocated with VMAT_WRITE_WATCH,
+// returns false if it doesn't or the platform can't track writes.
+bool VMGetWrittenPages(void* pAddress, size_t nSize, std::vector<void*>& pages);
+
 struct MemoryUnMapper
 {
 	void operator()(void* pMem) const noexcept
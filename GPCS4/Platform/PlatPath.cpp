@@ -1,5 +1,4 @@
 #include "PlatPath.h"
-#include "UtilString.h"
 #include <algorithm>
 
 LOG_CHANNEL(Platform.UtilPath);
@@ -13,31 +12,6 @@ namespace plat
 #include <Windows.h>
 #undef WIN32_LEAN_AND_MEAN
 
-std::string GetWorkingDirPath()
-{
-	std::string workingDir;
-	do
-	{
-		CHAR szPath[MAX_PATH];
-		if (!GetCurrentDirectory(MAX_PATH, szPath))
-		{
-			break;
-		}
-		workingDir.assign(szPath);
-		workingDir += "\\";
-	} while (false);
-	return workingDir;
-}
-
-std::string PS4PathToPCPath(const std::string &strPs4Path)
-{
-	std::string strPcPath = strPs4Path;
-	std::replace(strPcPath.begin(), strPcPath.end(), '/', '\\');
-	std::string strWorkingDirPath = GetWorkingDirPath();
-	strPcPath                     = util::str::replaceAll(strPcPath, "\\app0\\", strWorkingDirPath);
-	return strPcPath;
-}
-
 size_t FileCountInDirectory(const std::string &path)
 {
 	int counter = 0;
@@ -1,5 +1,12 @@
 #include "PlatProcess.h"
 
+#ifdef GPCS4_LINUX
+#include <sys/resource.h>
+#include <unistd.h>
+#include <cstdio>
+#include <ctime>
+#endif  // GPCS4_LINUX
+
 
 namespace plat
 {
@@ -8,6 +15,7 @@ namespace plat
 
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
+#include <Psapi.h>
 #undef WIN32_LEAN_AND_MEAN
 
 uint64_t GetProcessTimeCounter()
@@ -57,8 +65,91 @@ uint64_t GetProcessTimeFrequency()
 	return nFreq;
 }
 
+// Kernel plus user time, in 100 nanosecond units.
+static uint64_t addCpuTimes(const FILETIME& kernelTime, const FILETIME& userTime)
+{
+	ULARGE_INTEGER kernel = { kernelTime.dwLowDateTime, kernelTime.dwHighDateTime };
+	ULARGE_INTEGER user   = { userTime.dwLowDateTime, userTime.dwHighDateTime };
+	return (kernel.QuadPart + user.QuadPart) * 100;
+}
+
+uint64_t GetProcessCpuTime()
+{
+	FILETIME creationTime = {}, exitTime = {}, kernelTime = {}, userTime = {};
+	GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime);
+	return addCpuTimes(kernelTime, userTime);
+}
+
+uint64_t GetThreadCpuTime()
+{
+	FILETIME creationTime = {}, exitTime = {}, kernelTime = {}, userTime = {};
+	GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime);
+	return addCpuTimes(kernelTime, userTime);
+}
+
+size_t GetProcessResidentSize()
+{
+	PROCESS_MEMORY_COUNTERS stCounters = {};
+	GetProcessMemoryInfo(GetCurrentProcess(), &stCounters, sizeof(stCounters));
+	return stCounters.WorkingSetSize;
+}
+
+size_t GetProcessPeakResidentSize()
+{
+	PROCESS_MEMORY_COUNTERS stCounters = {};
+	GetProcessMemoryInfo(GetCurrentProcess(), &stCounters, sizeof(stCounters));
+	return stCounters.PeakWorkingSetSize;
+}
+
 #else
 
+static uint64_t getCpuClock(clockid_t clockId)
+{
+	struct timespec ts = {};
+	clock_gettime(clockId, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+uint64_t GetProcessCpuTime()
+{
+	return getCpuClock(CLOCK_PROCESS_CPUTIME_ID);
+}
+
+uint64_t GetThreadCpuTime()
+{
+	return getCpuClock(CLOCK_THREAD_CPUTIME_ID);
+}
+
+size_t GetProcessResidentSize()
+{
+	size_t nResident = 0;
+	do
+	{
+		FILE* fp = fopen("/proc/self/statm", "r");
+		if (!fp)
+		{
+			break;
+		}
+
+		unsigned long nTotalPages    = 0;
+		unsigned long nResidentPages = 0;
+		if (fscanf(fp, "%lu %lu", &nTotalPages, &nResidentPages) == 2)
+		{
+			nResident = nResidentPages * sysconf(_SC_PAGESIZE);
+		}
+		fclose(fp);
+	} while (false);
+	return nResident;
+}
+
+size_t GetProcessPeakResidentSize()
+{
+	struct rusage stUsage = {};
+	getrusage(RUSAGE_SELF, &stUsage);
+	// ru_maxrss is in kilobytes.
+	return static_cast<size_t>(stUsage.ru_maxrss) * 1024;
+}
+
 #endif  //GPCS4_WINDOWS
 
 
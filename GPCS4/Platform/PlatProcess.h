@@ -9,4 +9,16 @@ uint64_t GetProcessTimeCounter();
 
 uint64_t GetProcessTimeFrequency();
 
+// Cpu time used by the whole process, in nanoseconds.
+uint64_t GetProcessCpuTime();
+
+// Cpu time used by the calling thread, in nanoseconds.
+uint64_t GetThreadCpuTime();
+
+// Bytes of the process currently resident in physical memory.
+size_t GetProcessResidentSize();
+
+// Highest resident size the process has reached.
+size_t GetProcessPeakResidentSize();
+
 }
@@ -1,5 +1,19 @@
 #include "PlatThread.h"
 
+#include <algorithm>
+
+#ifdef GPCS4_LINUX
+#include <sys/types.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#endif  // GPCS4_LINUX
+
 namespace plat
 {;
 
@@ -9,6 +23,8 @@ namespace plat
 #include <Windows.h>
 #undef WIN32_LEAN_AND_MEAN
 
+#pragma comment(lib, "Synchronization.lib")
+
 
 uint64_t GetThreadId(void)
 {
@@ -20,10 +36,82 @@ void ThreadYield()
 	SwitchToThread();
 }
 
+bool SetThreadAffinity(uint64_t mask)
+{
+	return SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(mask)) != 0;
+}
+
+bool SetThreadAffinity(void* thread, uint64_t mask)
+{
+	return SetThreadAffinityMask(static_cast<HANDLE>(thread), static_cast<DWORD_PTR>(mask)) != 0;
+}
+
+bool FutexWait(std::atomic<uint32_t>* address, uint32_t expected, const uint64_t* timeoutUs)
+{
+	// Round up, waking early would look like a spurious wakeup
+	// to the caller, which then waits again for the rest.
+	DWORD timeoutMs = timeoutUs ? static_cast<DWORD>(std::min<uint64_t>((*timeoutUs + 999) / 1000, INFINITE - 1))
+								: INFINITE;
+	BOOL  woken     = WaitOnAddress(address, &expected, sizeof(expected), timeoutMs);
+	return woken || GetLastError() != ERROR_TIMEOUT;
+}
+
+void FutexWake(std::atomic<uint32_t>* address, uint32_t count)
+{
+	for (uint32_t i = 0; i != count; ++i)
+	{
+		WakeByAddressSingle(address);
+	}
+}
+
+void FutexWakeAll(std::atomic<uint32_t>* address)
+{
+	WakeByAddressAll(address);
+}
+
+// The first 64 TLS slots are stored inline in the TEB.
+constexpr int32_t  TebTlsSlotsOffset = 0x1480;
+constexpr uint32_t TebTlsSlotCount   = 64;
+
+bool AllocateThreadSlot(ThreadSlot* slot)
+{
+	bool ret = false;
+	do
+	{
+		DWORD index = TlsAlloc();
+		if (index == TLS_OUT_OF_INDEXES)
+		{
+			break;
+		}
+
+		if (index >= TebTlsSlotCount)
+		{
+			// Expansion slots need another load.
+			TlsFree(index);
+			break;
+		}
+
+		slot->segmentPrefix = 0x65;  // gs
+		slot->offset        = TebTlsSlotsOffset + index * sizeof(void*);
+		slot->index         = index;
+		ret                 = true;
+	} while (false);
+	return ret;
+}
+
+void SetThreadSlotValue(const ThreadSlot& slot, void* value)
+{
+	TlsSetValue(slot.index, value);
+}
+
+void* GetThreadSlotValue(const ThreadSlot& slot)
+{
+	return TlsGetValue(slot.index);
+}
+
 
 #elif defined(GPCS4_LINUX)
 
-#include <sys/types.h>
 uint64_t GetThreadId(void)
 {
 	return gettid();
@@ -35,6 +123,108 @@ void ThreadYield()
 
 }
 
+static bool SetPthreadAffinity(pthread_t thread, uint64_t mask)
+{
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	for (uint32_t i = 0; i != 64; ++i)
+	{
+		if (mask & (1ull << i))
+		{
+			CPU_SET(i, &cpuSet);
+		}
+	}
+	return pthread_setaffinity_np(thread, sizeof(cpuSet), &cpuSet) == 0;
+}
+
+bool SetThreadAffinity(uint64_t mask)
+{
+	return SetPthreadAffinity(pthread_self(), mask);
+}
+
+bool SetThreadAffinity(void* thread, uint64_t mask)
+{
+	return SetPthreadAffinity(reinterpret_cast<pthread_t>(thread), mask);
+}
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be 32 bits.");
+
+bool FutexWait(std::atomic<uint32_t>* address, uint32_t expected, const uint64_t* timeoutUs)
+{
+	timespec  timeout  = {};
+	timespec* pTimeout = nullptr;
+	if (timeoutUs)
+	{
+		timeout.tv_sec  = *timeoutUs / 1000000;
+		timeout.tv_nsec = (*timeoutUs % 1000000) * 1000;
+		pTimeout        = &timeout;
+	}
+
+	long ret = syscall(SYS_futex, reinterpret_cast<uint32_t*>(address), FUTEX_WAIT_PRIVATE,
+					   expected, pTimeout, nullptr, 0);
+	return ret == 0 || errno != ETIMEDOUT;
+}
+
+void FutexWake(std::atomic<uint32_t>* address, uint32_t count)
+{
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(address), FUTEX_WAKE_PRIVATE,
+			std::min<uint32_t>(count, INT_MAX), nullptr, nullptr, 0);
+}
+
+void FutexWakeAll(std::atomic<uint32_t>* address)
+{
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(address), FUTEX_WAKE_PRIVATE,
+			INT_MAX, nullptr, nullptr, 0);
+}
+
+constexpr uint32_t ThreadSlotCount = 8;
+
+// Static TLS of the executable sits at the same offset
+// from the thread pointer on every thread.
+static thread_local void* t_threadSlots[ThreadSlotCount] __attribute__((tls_model("initial-exec")));
+static std::atomic<uint32_t> g_threadSlotCount = { 0 };
+
+bool AllocateThreadSlot(ThreadSlot* slot)
+{
+	bool ret = false;
+	do
+	{
+		uint32_t index = g_threadSlotCount.fetch_add(1);
+		if (index >= ThreadSlotCount)
+		{
+			break;
+		}
+
+		// fs:0 holds the thread pointer itself.
+		uintptr_t threadPointer = 0;
+		asm volatile("mov %%fs:0, %0"
+					 : "=r"(threadPointer));
+
+		intptr_t offset = reinterpret_cast<intptr_t>(&t_threadSlots[index]) -
+						  static_cast<intptr_t>(threadPointer);
+		if (offset < INT32_MIN || offset > INT32_MAX)
+		{
+			break;
+		}
+
+		slot->segmentPrefix = 0x64;  // fs
+		slot->offset        = static_cast<int32_t>(offset);
+		slot->index         = index;
+		ret                 = true;
+	} while (false);
+	return ret;
+}
+
+void SetThreadSlotValue(const ThreadSlot& slot, void* value)
+{
+	t_threadSlots[slot.index] = value;
+}
+
+void* GetThreadSlotValue(const ThreadSlot& slot)
+{
+	return t_threadSlots[slot.index];
+}
+
 #endif  //GPCS4_WINDOWS
 
 
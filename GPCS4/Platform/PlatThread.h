@@ -2,6 +2,8 @@
 
 #include "GPCS4Common.h"
 
+#include <atomic>
+
 namespace plat
 {
 
@@ -9,4 +11,37 @@ uint64_t GetThreadId(void);
 
 void ThreadYield();
 
+// Bind the calling thread to the host logical processors in mask.
+bool SetThreadAffinity(uint64_t mask);
+
+// Same for another thread, given its native handle.
+bool SetThreadAffinity(void* thread, uint64_t mask);
+
+// Sleeps while the word equals expected, until woken or the timeout
+// in microseconds passes, null waits forever.
+// Returns false on timeout, wakeups may be spurious.
+bool FutexWait(std::atomic<uint32_t>* address, uint32_t expected, const uint64_t* timeoutUs);
+
+// Wakes up to count threads sleeping on the word.
+void FutexWake(std::atomic<uint32_t>* address, uint32_t count);
+
+void FutexWakeAll(std::atomic<uint32_t>* address);
+
+// A pointer sized value of every thread, which generated
+// code reads with a single segment relative load:
+// mov reg, seg:[offset], seg being fs or gs as given by segmentPrefix.
+struct ThreadSlot
+{
+	uint8_t  segmentPrefix;
+	int32_t  offset;
+	uint32_t index;
+};
+
+// Slots are never freed, there are only a few of them.
+bool AllocateThreadSlot(ThreadSlot* slot);
+
+void SetThreadSlotValue(const ThreadSlot& slot, void* value);
+
+void* GetThreadSlotValue(const ThreadSlot& slot);
+
 }
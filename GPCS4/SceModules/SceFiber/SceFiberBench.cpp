@@ -0,0 +1,223 @@
+#include "SceFiberBench.h"
+#include "sce_fiber.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+
+#ifdef GPCS4_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#undef WIN32_LEAN_AND_MEAN
+#elif defined(GPCS4_LINUX)
+#include <ucontext.h>
+#endif  // GPCS4_WINDOWS
+
+LOG_CHANNEL(SceModules.SceFiber.SceFiberBench);
+
+constexpr uint64_t FiberBenchStackSize = 64 * 1024;
+
+static void PS4API sceFiberBenchEntry(uint64_t argOnInitialize, uint64_t argOnRun)
+{
+	uint64_t value = argOnRun;
+	while (true)
+	{
+		sceFiberReturnToThread(value + 1, &value);
+	}
+}
+
+
+#ifdef GPCS4_WINDOWS
+
+struct FiberBenchBaseline
+{
+	void*    threadFiber;
+	void*    fiber;
+	uint64_t value;
+};
+
+static void WINAPI fiberBenchBaselineEntry(void* param)
+{
+	auto baseline = reinterpret_cast<FiberBenchBaseline*>(param);
+	while (true)
+	{
+		baseline->value++;
+		SwitchToFiber(baseline->threadFiber);
+	}
+}
+
+#elif defined(GPCS4_LINUX)
+
+struct FiberBenchBaseline
+{
+	ucontext_t threadContext;
+	ucontext_t fiberContext;
+	uint64_t   value;
+};
+
+static FiberBenchBaseline* s_baseline = nullptr;
+
+static void fiberBenchBaselineEntry()
+{
+	while (true)
+	{
+		s_baseline->value++;
+		swapcontext(&s_baseline->fiberContext, &s_baseline->threadContext);
+	}
+}
+
+#endif  // GPCS4_WINDOWS
+
+
+CSceFiberBench::CSceFiberBench(const SceFiberBenchDesc& desc) :
+	m_desc(desc)
+{
+}
+
+CSceFiberBench::~CSceFiberBench()
+{
+}
+
+bool CSceFiberBench::Run()
+{
+	bool ret = false;
+	do
+	{
+		if (m_desc.roundTripCount == 0)
+		{
+			std::printf("Nothing to run, round trip count is 0.\n");
+			break;
+		}
+
+		double fiberTime = RunSceFiber();
+		if (fiberTime < 0.0)
+		{
+			break;
+		}
+
+		double baselineTime = RunBaseline();
+
+		std::printf("Round trips    : %u, %u switches\n",
+					m_desc.roundTripCount,
+					m_desc.roundTripCount * 2);
+		Report("SceFiber", fiberTime);
+		if (baselineTime >= 0.0)
+		{
+#ifdef GPCS4_WINDOWS
+			Report("Win32 fiber", baselineTime);
+#else
+			Report("ucontext", baselineTime);
+#endif  // GPCS4_WINDOWS
+			std::printf("Speedup        : %.2fx\n", baselineTime / fiberTime);
+		}
+
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+double CSceFiberBench::RunSceFiber()
+{
+	double seconds = -1.0;
+	do
+	{
+		auto stack = std::make_unique<uint8_t[]>(FiberBenchStackSize + SCE_FIBER_CONTEXT_ALIGNMENT);
+		auto addr  = reinterpret_cast<uintptr_t>(stack.get());
+		addr       = (addr + SCE_FIBER_CONTEXT_ALIGNMENT - 1) & ~uintptr_t(SCE_FIBER_CONTEXT_ALIGNMENT - 1);
+
+		SceFiber fiber = {};
+		int      err   = _sceFiberInitializeImpl(&fiber, "bench", sceFiberBenchEntry, 0,
+												 reinterpret_cast<void*>(addr), FiberBenchStackSize,
+												 nullptr, 0);
+		if (err != SCE_OK)
+		{
+			std::printf("Initialize fiber failed %X.\n", err);
+			break;
+		}
+
+		uint64_t value = 0;
+		auto     start = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i != m_desc.roundTripCount; ++i)
+		{
+			sceFiberRun(&fiber, value, &value);
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+
+		// The fiber stays suspended in its entry,
+		// it's never resumed after this point.
+		sceFiberFinalize(&fiber);
+
+		if (value != m_desc.roundTripCount)
+		{
+			std::printf("Fiber returned %llu, expected %u.\n",
+						static_cast<unsigned long long>(value),
+						m_desc.roundTripCount);
+			break;
+		}
+
+		seconds = std::chrono::duration<double>(end - start).count();
+	} while (false);
+	return seconds;
+}
+
+double CSceFiberBench::RunBaseline()
+{
+	double seconds = -1.0;
+	do
+	{
+#ifdef GPCS4_WINDOWS
+		FiberBenchBaseline baseline = {};
+		baseline.threadFiber        = ConvertThreadToFiber(nullptr);
+		baseline.fiber              = CreateFiber(FiberBenchStackSize, fiberBenchBaselineEntry, &baseline);
+		if (!baseline.threadFiber || !baseline.fiber)
+		{
+			std::printf("Create Win32 fiber failed.\n");
+			break;
+		}
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i != m_desc.roundTripCount; ++i)
+		{
+			SwitchToFiber(baseline.fiber);
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+
+		DeleteFiber(baseline.fiber);
+		ConvertFiberToThread();
+#elif defined(GPCS4_LINUX)
+		auto stack = std::make_unique<uint8_t[]>(FiberBenchStackSize);
+
+		FiberBenchBaseline baseline = {};
+		s_baseline                  = &baseline;
+		getcontext(&baseline.fiberContext);
+		baseline.fiberContext.uc_stack.ss_sp   = stack.get();
+		baseline.fiberContext.uc_stack.ss_size = FiberBenchStackSize;
+		baseline.fiberContext.uc_link          = nullptr;
+		makecontext(&baseline.fiberContext, fiberBenchBaselineEntry, 0);
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i != m_desc.roundTripCount; ++i)
+		{
+			swapcontext(&baseline.threadContext, &baseline.fiberContext);
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+
+		s_baseline = nullptr;
+#else
+		break;
+#endif  // GPCS4_WINDOWS
+
+		seconds = std::chrono::duration<double>(end - start).count();
+	} while (false);
+	return seconds;
+}
+
+void CSceFiberBench::Report(const char* name, double seconds)
+{
+	double switchCount = m_desc.roundTripCount * 2.0;
+	std::printf("%-15s: %.3f ms, %.2f M switches/s, %.1f ns per switch\n",
+				name,
+				seconds * 1000.0,
+				switchCount / seconds / 1000000.0,
+				seconds * 1000000000.0 / switchCount);
+}
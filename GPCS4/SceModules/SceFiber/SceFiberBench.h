@@ -0,0 +1,35 @@
+#pragma once
+#include "GPCS4Common.h"
+
+
+struct SceFiberBenchDesc
+{
+	// Number of round trips between the thread
+	// and a fiber, each round trip is two switches.
+	uint32_t roundTripCount;
+};
+
+
+// Measures the fiber context switch throughput
+// through the HLE fiber functions, and the same
+// ping-pong on the host platform's own user mode
+// context switch as a baseline.
+
+class CSceFiberBench
+{
+public:
+	CSceFiberBench(const SceFiberBenchDesc& desc);
+	~CSceFiberBench();
+
+	bool Run();
+
+private:
+	double RunSceFiber();
+
+	double RunBaseline();
+
+	void Report(const char* name, double seconds);
+
+private:
+	SceFiberBenchDesc m_desc;
+};
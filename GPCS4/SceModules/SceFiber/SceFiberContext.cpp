@@ -0,0 +1,148 @@
+#include "SceFiberContext.h"
+
+#include <cstddef>
+
+LOG_CHANNEL(SceModules.SceFiber.SceFiberContext);
+
+// Initial MXCSR and x87 control word, the power-on defaults.
+constexpr uint32_t FiberInitialMxcsr  = 0x1F80;
+constexpr uint16_t FiberInitialFpucw  = 0x037F;
+
+// Saved context frame, from the saved stack pointer upwards.
+struct SceFiberContextFrame
+{
+	uint32_t mxcsr;
+	uint16_t fpucw;
+	uint16_t padding;
+#ifdef GPCS4_WINDOWS
+	// Stack bounds the system checks the stack pointer against,
+	// from the NT_TIB and the TEB.
+	uint64_t deallocationStack;
+	uint64_t stackLimit;
+	uint64_t stackBase;
+	uint64_t tibPadding;
+#endif  // GPCS4_WINDOWS
+	uint64_t r15;
+	uint64_t r14;
+	uint64_t r13;
+	uint64_t r12;
+	uint64_t rbx;
+	uint64_t rbp;
+	uint64_t rip;
+};
+
+#ifdef GPCS4_WINDOWS
+
+// Stack probes, guard page growth and exception dispatch use the
+// stack bounds of the thread, they must follow the stack switched to.
+#define FIBER_FRAME_SIZE "40"
+#define FIBER_SAVE_TIB               \
+	"movq %gs:0x1478, %r10\n"        \
+	"movq %r10, 8(%rsp)\n"           \
+	"movq %gs:0x10, %r10\n"          \
+	"movq %r10, 16(%rsp)\n"          \
+	"movq %gs:0x08, %r10\n"          \
+	"movq %r10, 24(%rsp)\n"
+#define FIBER_LOAD_TIB               \
+	"movq 8(%rsp), %r10\n"           \
+	"movq %r10, %gs:0x1478\n"        \
+	"movq 16(%rsp), %r10\n"          \
+	"movq %r10, %gs:0x10\n"          \
+	"movq 24(%rsp), %r10\n"          \
+	"movq %r10, %gs:0x08\n"
+static_assert(offsetof(SceFiberContextFrame, deallocationStack) == 8 &&
+				  offsetof(SceFiberContextFrame, stackLimit) == 16 &&
+				  offsetof(SceFiberContextFrame, stackBase) == 24 &&
+				  offsetof(SceFiberContextFrame, r15) == 40,
+			  "frame layout must match the switch routine.");
+
+#else
+
+#define FIBER_FRAME_SIZE "8"
+#define FIBER_SAVE_TIB   ""
+#define FIBER_LOAD_TIB   ""
+static_assert(offsetof(SceFiberContextFrame, r15) == 8, "frame layout must match the switch routine.");
+
+#endif  // GPCS4_WINDOWS
+
+
+// First code run by a new context, returned to by SceFiberSwapContext.
+// r12 = argOnInitialize, r13 = entry, r14 = exitArg, r15 = exitHandler,
+// rax = the arg passed to the switch.
+PS4NAKED
+static void SceFiberContextStart()
+{
+	asm volatile(
+		"movq %r12, %rdi\n"
+		"movq %rax, %rsi\n"
+		"callq *%r13\n"
+		"movq %r14, %rdi\n"
+		"callq *%r15\n"
+		"ud2\n");
+}
+
+
+SceFiberContextSp SceFiberMakeContext(void* stackAddr, uint64_t stackSize,
+	void* entry, uint64_t argOnInitialize,
+	SceFiberContextExit exitHandler, void* exitArg)
+{
+	uintptr_t stackTop = reinterpret_cast<uintptr_t>(stackAddr) + stackSize;
+	stackTop &= ~uintptr_t(15);
+
+	// Keep 16 bytes above the frame so that the start
+	// routine is entered with a 16 bytes aligned stack,
+	// like any function right before a call.
+	auto frame = reinterpret_cast<SceFiberContextFrame*>(stackTop - sizeof(SceFiberContextFrame) - 16);
+	static_assert(sizeof(SceFiberContextFrame) % 16 == 0, "frame must keep stack alignment.");
+
+	*frame       = {};
+	frame->mxcsr = FiberInitialMxcsr;
+	frame->fpucw = FiberInitialFpucw;
+	frame->r12   = argOnInitialize;
+	frame->r13   = reinterpret_cast<uint64_t>(entry);
+	frame->r14   = reinterpret_cast<uint64_t>(exitArg);
+	frame->r15   = reinterpret_cast<uint64_t>(exitHandler);
+	frame->rip   = reinterpret_cast<uint64_t>(&SceFiberContextStart);
+#ifdef GPCS4_WINDOWS
+	frame->deallocationStack = reinterpret_cast<uint64_t>(stackAddr);
+	frame->stackLimit        = reinterpret_cast<uint64_t>(stackAddr);
+	frame->stackBase         = reinterpret_cast<uint64_t>(stackAddr) + stackSize;
+#endif  // GPCS4_WINDOWS
+
+	return reinterpret_cast<SceFiberContextSp>(frame);
+}
+
+
+// rdi = saveSp, rsi = loadSp, rdx = arg
+// Only the System V callee-saved registers are preserved,
+// all callers are PS4API functions.
+PS4NAKED
+uint64_t PS4API SceFiberSwapContext(SceFiberContextSp* saveSp, SceFiberContextSp loadSp, uint64_t arg)
+{
+	asm volatile(
+		"pushq %rbp\n"
+		"pushq %rbx\n"
+		"pushq %r12\n"
+		"pushq %r13\n"
+		"pushq %r14\n"
+		"pushq %r15\n"
+		"subq $" FIBER_FRAME_SIZE ", %rsp\n"
+		"stmxcsr (%rsp)\n"
+		"fnstcw 4(%rsp)\n"
+		FIBER_SAVE_TIB
+		"movq %rsp, (%rdi)\n"
+
+		"movq %rsi, %rsp\n"
+		"ldmxcsr (%rsp)\n"
+		"fldcw 4(%rsp)\n"
+		FIBER_LOAD_TIB
+		"addq $" FIBER_FRAME_SIZE ", %rsp\n"
+		"popq %r15\n"
+		"popq %r14\n"
+		"popq %r13\n"
+		"popq %r12\n"
+		"popq %rbx\n"
+		"popq %rbp\n"
+		"movq %rdx, %rax\n"
+		"retq\n");
+}
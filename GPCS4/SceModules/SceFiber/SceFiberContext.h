@@ -0,0 +1,25 @@
+#pragma once
+#include "GPCS4Common.h"
+
+// User mode context switch for fibers.
+//
+// A suspended context is only a stack pointer, the callee-saved
+// registers, MXCSR and x87 control word are pushed on its own stack,
+// on Windows the stack bounds of the thread as well.
+// Switching makes no system call.
+
+typedef uint64_t SceFiberContextSp;
+
+typedef void PS4API (*SceFiberContextExit)(void* exitArg);
+
+// Builds the initial frame of a context on the given stack.
+// Once switched to, the context calls entry(argOnInitialize, arg),
+// arg being the value passed to the switch.
+// If entry returns, exitHandler(exitArg) is called, it must not return.
+SceFiberContextSp SceFiberMakeContext(void* stackAddr, uint64_t stackSize,
+	void* entry, uint64_t argOnInitialize,
+	SceFiberContextExit exitHandler, void* exitArg);
+
+// Saves the current context to *saveSp and resumes loadSp.
+// Returns the arg given by whoever resumes the saved context.
+extern "C" uint64_t PS4API SceFiberSwapContext(SceFiberContextSp* saveSp, SceFiberContextSp loadSp, uint64_t arg);
@@ -1,4 +1,7 @@
 #include "sce_fiber.h"
+#include "SceFiberContext.h"
+
+#include <cstring>
 
 
 // Note:
@@ -7,50 +10,317 @@
 
 LOG_CHANNEL(SceModules.SceFiber);
 
+
+// Fiber state lives in the SceFiber memory given by the game.
+struct SceFiberObject
+{
+	uint64_t          magic;
+	uint32_t          state;
+	// Context memory was allocated here, not given by the game.
+	uint32_t          ownsContext;
+	SceFiberEntry     entry;
+	uint64_t          argOnInitialize;
+	void*             addrContext;
+	uint64_t          sizeContext;
+	SceFiberContextSp contextSp;
+	char              name[SCE_FIBER_MAX_NAME_LENGTH + 1];
+};
+static_assert(sizeof(SceFiberObject) <= sizeof(SceFiber), "fiber object too large.");
+
+constexpr uint64_t SceFiberMagic = 0x5245424946454353;  // "SCEFIBER"
+
+// Fibers initialized without context memory run on the thread stack.
+// They get a stack of their own instead, so that they can be
+// suspended and resumed like any other fiber.
+constexpr uint64_t SceFiberThreadStackSize = 1024 * 1024;
+
+enum SceFiberState : uint32_t
+{
+	SceFiberStateIdle,
+	SceFiberStateRun,
+	SceFiberStateTerminated,
+};
+
+// The fiber running on this thread and the thread's own
+// context, which sceFiberRun suspends.
+struct SceFiberThreadState
+{
+	SceFiberObject*   current;
+	SceFiberContextSp threadSp;
+};
+
+thread_local static SceFiberThreadState t_fiber_thread = {};
+
+
+static SceFiberObject* sceFiberGetObject(SceFiber* fiber)
+{
+	auto object = reinterpret_cast<SceFiberObject*>(fiber);
+	return (object && object->magic == SceFiberMagic) ? object : nullptr;
+}
+
+
+static void PS4API sceFiberEntryReturned(void* exitArg)
+{
+	auto object = reinterpret_cast<SceFiberObject*>(exitArg);
+	LOG_ERR("fiber %s returned from its entry.", object->name);
+
+	// Behave like the fiber returned to thread for good,
+	// it can't be run again.
+	object->state          = SceFiberStateTerminated;
+	t_fiber_thread.current = nullptr;
+
+	SceFiberContextSp deadSp = 0;
+	SceFiberSwapContext(&deadSp, t_fiber_thread.threadSp, 0);
+}
+
+
 //////////////////////////////////////////////////////////////////////////
 // library: libSceFiber
 //////////////////////////////////////////////////////////////////////////
 
-int PS4API _sceFiberInitializeImpl(void)
+int PS4API _sceFiberInitializeImpl(SceFiber* fiber, const char* name, SceFiberEntry entry, uint64_t argOnInitialize,
+	void* addrContext, uint64_t sizeContext, const SceFiberOptParam* optParam, uint32_t buildVersion)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
-}
+	LOG_SCE_TRACE("fiber %p name %s entry %p context %p size %x", fiber, name, entry, addrContext, sizeContext);
+	int ret = SCE_FIBER_ERROR_INVALID;
+	do
+	{
+		if (!fiber || !name || !entry)
+		{
+			ret = SCE_FIBER_ERROR_NULL;
+			break;
+		}
 
+		if ((uintptr_t)fiber % 8 != 0 || (uintptr_t)optParam % 8 != 0)
+		{
+			ret = SCE_FIBER_ERROR_ALIGNMENT;
+			break;
+		}
 
-int PS4API sceFiberFinalize(void)
-{
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+		size_t nameLength = strlen(name);
+		if (nameLength > SCE_FIBER_MAX_NAME_LENGTH)
+		{
+			break;
+		}
+
+		if ((uintptr_t)addrContext % SCE_FIBER_CONTEXT_ALIGNMENT != 0 ||
+			sizeContext % SCE_FIBER_CONTEXT_ALIGNMENT != 0)
+		{
+			ret = SCE_FIBER_ERROR_ALIGNMENT;
+			break;
+		}
+
+		if (addrContext && sizeContext < SCE_FIBER_CONTEXT_MINIMUM_SIZE)
+		{
+			ret = SCE_FIBER_ERROR_RANGE;
+			break;
+		}
+
+		bool ownsContext = !addrContext;
+		if (ownsContext)
+		{
+			addrContext = new uint8_t[SceFiberThreadStackSize];
+			sizeContext = SceFiberThreadStackSize;
+		}
+
+		auto object             = reinterpret_cast<SceFiberObject*>(fiber);
+		*object                 = {};
+		object->magic           = SceFiberMagic;
+		object->state           = SceFiberStateIdle;
+		object->ownsContext     = ownsContext;
+		object->entry           = entry;
+		object->argOnInitialize = argOnInitialize;
+		object->addrContext     = addrContext;
+		object->sizeContext     = sizeContext;
+		object->contextSp       = SceFiberMakeContext(addrContext, sizeContext,
+			reinterpret_cast<void*>(entry), argOnInitialize,
+			sceFiberEntryReturned, object);
+		memcpy(object->name, name, nameLength + 1);
+
+		ret = SCE_OK;
+	} while (false);
+	return ret;
 }
 
 
-int PS4API sceFiberReturnToThread(void)
+int PS4API sceFiberFinalize(SceFiber* fiber)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("fiber %p", fiber);
+	int ret = SCE_FIBER_ERROR_INVALID;
+	do
+	{
+		if (!fiber)
+		{
+			ret = SCE_FIBER_ERROR_NULL;
+			break;
+		}
+
+		auto object = sceFiberGetObject(fiber);
+		if (!object)
+		{
+			break;
+		}
+
+		if (object->state == SceFiberStateRun)
+		{
+			ret = SCE_FIBER_ERROR_STATE;
+			break;
+		}
+
+		object->magic = 0;
+
+		if (object->ownsContext)
+		{
+			delete[] reinterpret_cast<uint8_t*>(object->addrContext);
+		}
+
+		ret = SCE_OK;
+	} while (false);
+	return ret;
 }
 
 
-int PS4API sceFiberRun(void)
+int PS4API sceFiberRun(SceFiber* fiber, uint64_t argOnRunTo, uint64_t* argOnReturn)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	int ret = SCE_FIBER_ERROR_INVALID;
+	do
+	{
+		if (!fiber)
+		{
+			ret = SCE_FIBER_ERROR_NULL;
+			break;
+		}
+
+		auto object = sceFiberGetObject(fiber);
+		if (!object)
+		{
+			break;
+		}
+
+		// Fibers are run from the thread context only,
+		// switch between them with sceFiberSwitch.
+		if (t_fiber_thread.current)
+		{
+			ret = SCE_FIBER_ERROR_PERMISSION;
+			break;
+		}
+
+		if (object->state != SceFiberStateIdle)
+		{
+			ret = SCE_FIBER_ERROR_STATE;
+			break;
+		}
+
+		object->state          = SceFiberStateRun;
+		t_fiber_thread.current = object;
+
+		// Returns when a fiber of this thread calls sceFiberReturnToThread.
+		uint64_t arg = SceFiberSwapContext(&t_fiber_thread.threadSp, object->contextSp, argOnRunTo);
+		if (argOnReturn)
+		{
+			*argOnReturn = arg;
+		}
+
+		ret = SCE_OK;
+	} while (false);
+	return ret;
 }
 
 
-int PS4API sceFiberSwitch(void)
+int PS4API sceFiberSwitch(SceFiber* fiber, uint64_t argOnRunTo, uint64_t* argOnRun)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	int ret = SCE_FIBER_ERROR_INVALID;
+	do
+	{
+		if (!fiber)
+		{
+			ret = SCE_FIBER_ERROR_NULL;
+			break;
+		}
+
+		auto object = sceFiberGetObject(fiber);
+		if (!object)
+		{
+			break;
+		}
+
+		auto self = t_fiber_thread.current;
+		if (!self)
+		{
+			ret = SCE_FIBER_ERROR_PERMISSION;
+			break;
+		}
+
+		if (object->state != SceFiberStateIdle)
+		{
+			ret = SCE_FIBER_ERROR_STATE;
+			break;
+		}
+
+		self->state            = SceFiberStateIdle;
+		object->state          = SceFiberStateRun;
+		t_fiber_thread.current = object;
+
+		// Returns when another fiber runs or switches to us.
+		uint64_t arg = SceFiberSwapContext(&self->contextSp, object->contextSp, argOnRunTo);
+		if (argOnRun)
+		{
+			*argOnRun = arg;
+		}
+
+		ret = SCE_OK;
+	} while (false);
+	return ret;
 }
 
-int PS4API sceFiberGetSelf(void)
+
+int PS4API sceFiberReturnToThread(uint64_t argOnReturn, uint64_t* argOnRun)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	int ret = SCE_FIBER_ERROR_INVALID;
+	do
+	{
+		auto self = t_fiber_thread.current;
+		if (!self)
+		{
+			ret = SCE_FIBER_ERROR_PERMISSION;
+			break;
+		}
+
+		self->state            = SceFiberStateIdle;
+		t_fiber_thread.current = nullptr;
+
+		uint64_t arg = SceFiberSwapContext(&self->contextSp, t_fiber_thread.threadSp, argOnReturn);
+		if (argOnRun)
+		{
+			*argOnRun = arg;
+		}
+
+		ret = SCE_OK;
+	} while (false);
+	return ret;
 }
 
 
+int PS4API sceFiberGetSelf(SceFiber** fiber)
+{
+	int ret = SCE_FIBER_ERROR_INVALID;
+	do
+	{
+		if (!fiber)
+		{
+			ret = SCE_FIBER_ERROR_NULL;
+			break;
+		}
+
+		if (!t_fiber_thread.current)
+		{
+			ret = SCE_FIBER_ERROR_PERMISSION;
+			break;
+		}
 
+		*fiber = reinterpret_cast<SceFiber*>(t_fiber_thread.current);
 
+		ret = SCE_OK;
+	} while (false);
+	return ret;
+}
@@ -10,6 +10,7 @@
 #pragma once
 
 #include "sce_module_common.h"
+#include "sce_fiber_types.h"
 
 
 extern const SCE_EXPORT_MODULE g_ExpModuleSceFiber;
@@ -25,22 +26,23 @@ extern const SCE_EXPORT_MODULE g_ExpModuleSceFiber;
 // library: libSceFiber
 //////////////////////////////////////////////////////////////////////////
 
-int PS4API _sceFiberInitializeImpl(void);
+int PS4API _sceFiberInitializeImpl(SceFiber* fiber, const char* name, SceFiberEntry entry, uint64_t argOnInitialize,
+	void* addrContext, uint64_t sizeContext, const SceFiberOptParam* optParam, uint32_t buildVersion);
 
 
-int PS4API sceFiberFinalize(void);
+int PS4API sceFiberFinalize(SceFiber* fiber);
 
 
-int PS4API sceFiberReturnToThread(void);
+int PS4API sceFiberReturnToThread(uint64_t argOnReturn, uint64_t* argOnRun);
 
 
-int PS4API sceFiberRun(void);
+int PS4API sceFiberRun(SceFiber* fiber, uint64_t argOnRunTo, uint64_t* argOnReturn);
 
 
-int PS4API sceFiberSwitch(void);
+int PS4API sceFiberSwitch(SceFiber* fiber, uint64_t argOnRunTo, uint64_t* argOnRun);
 
 
-int PS4API sceFiberGetSelf(void);
+int PS4API sceFiberGetSelf(SceFiber** fiber);
 
 
 
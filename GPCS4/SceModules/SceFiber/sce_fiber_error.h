@@ -0,0 +1,11 @@
+#pragma once
+
+
+
+// Fiber errors
+#define SCE_FIBER_ERROR_NULL					-2141650943	 //0x80590001
+#define SCE_FIBER_ERROR_ALIGNMENT				-2141650942	 //0x80590002
+#define SCE_FIBER_ERROR_RANGE					-2141650941	 //0x80590003
+#define SCE_FIBER_ERROR_INVALID					-2141650940	 //0x80590004
+#define SCE_FIBER_ERROR_PERMISSION				-2141650939	 //0x80590005
+#define SCE_FIBER_ERROR_STATE					-2141650938	 //0x80590006
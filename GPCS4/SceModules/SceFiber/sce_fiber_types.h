@@ -0,0 +1,22 @@
+#pragma once
+
+
+#define SCE_FIBER_MAX_NAME_LENGTH       31
+#define SCE_FIBER_CONTEXT_ALIGNMENT     16
+#define SCE_FIBER_CONTEXT_MINIMUM_SIZE  512
+
+
+typedef void PS4API (*SceFiberEntry)(uint64_t argOnInitialize, uint64_t argOnRun);
+
+
+// Opaque to the game, the fiber state is stored in it.
+struct PS4ALIGN(8) SceFiber
+{
+	uint8_t _reserved[128];
+};
+
+
+struct PS4ALIGN(8) SceFiberOptParam
+{
+	uint8_t _reserved[128];
+};
@@ -1,7 +1,17 @@
 #include "sce_fios2.h"
 
-#include "Platform/PlatPath.h"
-
+#include "AsyncIoEngine.h"
+#include "Emulator.h"
+#include "MapSlot.h"
+#include "ThreadAffinity.h"
+#include "VirtualFileSystem.h"
+#include "winpthreads/include/pthread.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
 #include <filesystem>
 
 // Note:
@@ -10,6 +20,250 @@
 
 LOG_CHANNEL(SceModules.SceFios2);
 
+struct FiosFile
+{
+	VfsFile              file;
+	std::atomic<int64_t> offset;
+};
+
+constexpr uint32_t FiosFileMax = 1024;
+constexpr uint32_t FiosOpMax   = 4096;
+
+// Op handles start here, so that an op is
+// never mistaken for a file handle.
+constexpr SceFiosHandle FiosOpHandleBase = 0x10000;
+
+// Holds a slot while the op is being submitted.
+static AsyncIoOp* const FiosOpReserved = reinterpret_cast<AsyncIoOp*>(1);
+
+MapSlot<FiosFile*>  g_fiosFiles(FiosFileMax);
+MapSlot<AsyncIoOp*> g_fiosOps(FiosOpMax);
+// Finding an empty slot and filling it are two steps.
+std::mutex g_fiosSlotMutex;
+
+struct FiosCallback
+{
+	SceFiosOpCallback pCallback;
+	void*             pContext;
+	SceFiosOp         op;
+	int               error;
+};
+
+// Op callbacks are guest code, they are called on a guest thread
+// of their own rather than on the io thread which completed the op,
+// so that a slow callback doesn't hold back other io.
+std::once_flag           g_fiosCallbackOnce;
+std::mutex               g_fiosCallbackMutex;
+std::condition_variable  g_fiosCallbackCond;
+std::deque<FiosCallback> g_fiosCallbacks;
+
+
+inline int getFiosError(int64_t hostError)
+{
+	int ret = SCE_FIOS_ERROR_ACCESS;
+	switch (-hostError)
+	{
+	case ENOENT:
+	case ENOTDIR:
+		ret = SCE_FIOS_ERROR_BAD_PATH;
+		break;
+	case EBADF:
+		ret = SCE_FIOS_ERROR_BAD_FH;
+		break;
+	case EISDIR:
+		ret = SCE_FIOS_ERROR_NOT_A_FILE;
+		break;
+	case EROFS:
+		ret = SCE_FIOS_ERROR_READ_ONLY;
+		break;
+	case ENAMETOOLONG:
+		ret = SCE_FIOS_ERROR_PATH_TOO_LONG;
+		break;
+	case EINVAL:
+		ret = SCE_FIOS_ERROR_BAD_OFFSET;
+		break;
+	case EIO:
+		ret = SCE_FIOS_ERROR_MEDIA_GONE;
+		break;
+	case ECANCELED:
+		ret = SCE_FIOS_ERROR_CANCELLED;
+		break;
+	}
+	return ret;
+}
+
+inline FiosFile* getFiosFile(SceFiosFH fh)
+{
+	FiosFile* file = nullptr;
+	if (fh > 0 && fh < FiosFileMax)
+	{
+		file = g_fiosFiles[fh];
+	}
+	return file;
+}
+
+inline AsyncIoOp* getFiosOp(SceFiosOp op)
+{
+	AsyncIoOp* ioOp  = nullptr;
+	uint32_t   index = static_cast<uint32_t>(op - FiosOpHandleBase);
+	if (op > FiosOpHandleBase && index < FiosOpMax && g_fiosOps[index] != FiosOpReserved)
+	{
+		ioOp = g_fiosOps[index];
+	}
+	return ioOp;
+}
+
+// A read which hit the end of the file early fails with EOF,
+// the bytes it did read are still counted.
+static int getOpError(const AsyncIoOp* op)
+{
+	int     ret   = SCE_OK;
+	int32_t error = op->error.load();
+	if (error != 0)
+	{
+		ret = getFiosError(error);
+	}
+	else if (op->request.type == AsyncIoType::Read &&
+			 op->transferred.load() < static_cast<int64_t>(op->request.size))
+	{
+		ret = SCE_FIOS_ERROR_EOF;
+	}
+	return ret;
+}
+
+inline SceFiosSize getOpResult(const AsyncIoOp* op)
+{
+	int         error = getOpError(op);
+	SceFiosSize count = op->transferred.load();
+	return (error == SCE_OK || (error == SCE_FIOS_ERROR_EOF && count != 0)) ? count : error;
+}
+
+inline void getFiosStat(const VfsStat& stat, SceFiosStat* pOutStatus)
+{
+	memset(pOutStatus, 0, sizeof(SceFiosStat));
+	pOutStatus->fileSize  = stat.size;
+	pOutStatus->ino       = stat.inode;
+	pOutStatus->statFlags = SCE_FIOS_STATUS_READABLE;
+	pOutStatus->statFlags |= stat.writable ? SCE_FIOS_STATUS_WRITABLE : 0;
+	pOutStatus->statFlags |= stat.type == VfsNodeType::Directory ? SCE_FIOS_STATUS_DIRECTORY : 0;
+}
+
+static AsyncIoRequest makeRequest(const SceFiosOpAttr* pAttr, AsyncIoType type,
+								  const FiosFile* file, const void* pBuf, SceFiosSize length, SceFiosOffset offset)
+{
+	AsyncIoRequest request;
+	request.type   = type;
+	request.file   = file->file;
+	request.buffer = const_cast<void*>(pBuf);
+	request.size   = length;
+	request.offset = offset;
+	if (pAttr)
+	{
+		request.priority = pAttr->priority;
+		// The latest possible deadline is the same as none.
+		request.deadline = pAttr->deadline != SCE_FIOS_TIME_LATEST ? pAttr->deadline : 0;
+	}
+	return request;
+}
+
+static void* runFiosCallbacks(void* arg)
+{
+	// Set up like a thread the guest created.
+	auto& affinity = TheEmulator().affinity();
+	affinity.setThreadName(pthread_self(), "SceFiosCallback");
+	affinity.bindGuestThread(pthread_self(), nullptr, ThreadAffinityMapper::DefaultGuestMask);
+
+	std::unique_lock<std::mutex> lock(g_fiosCallbackMutex);
+	while (true)
+	{
+		g_fiosCallbackCond.wait(lock, []
+								{ return !g_fiosCallbacks.empty(); });
+
+		FiosCallback callback = g_fiosCallbacks.front();
+		g_fiosCallbacks.pop_front();
+
+		lock.unlock();
+		callback.pCallback(callback.pContext, callback.op, SCE_FIOS_OPEVENT_COMPLETE, callback.error);
+		lock.lock();
+	}
+	return nullptr;
+}
+
+// Called from the guest thread submitting
+// the first op which has a callback.
+static void startFiosCallbackThread()
+{
+	std::call_once(g_fiosCallbackOnce, []()
+				   {
+					   pthread_t thread;
+					   if (pthread_create(&thread, nullptr, runFiosCallbacks, nullptr) != 0)
+					   {
+						   LOG_ERR("create fios callback thread failed");
+					   }
+				   });
+}
+
+static void postFiosCallback(const FiosCallback& callback)
+{
+	{
+		std::lock_guard<std::mutex> lock(g_fiosCallbackMutex);
+		g_fiosCallbacks.push_back(callback);
+	}
+	g_fiosCallbackCond.notify_one();
+}
+
+static SceFiosOp submitOp(const SceFiosOpAttr* pAttr, AsyncIoRequest& request)
+{
+	SceFiosOp op = SCE_FIOS_HANDLE_INVALID;
+	do
+	{
+		uint32_t index = 0;
+		{
+			std::lock_guard<std::mutex> lock(g_fiosSlotMutex);
+			index = g_fiosOps.GetEmptySlotIndex();
+			if (index == 0)
+			{
+				break;
+			}
+			g_fiosOps[index] = FiosOpReserved;
+		}
+
+		op = FiosOpHandleBase + index;
+		if (pAttr && pAttr->pCallback)
+		{
+			startFiosCallbackThread();
+
+			SceFiosOpCallback pCallback = pAttr->pCallback;
+			void*             pContext  = pAttr->pCallbackContext;
+			request.callback = [pCallback, pContext, op](AsyncIoOp& ioOp)
+			{
+				postFiosCallback({ pCallback, pContext, op, getOpError(&ioOp) });
+			};
+		}
+
+		// The op is found by its handle before it may
+		// complete, which can happen within start.
+		auto& aio        = TheEmulator().aio();
+		auto  ioOp       = aio.prepare(request);
+		g_fiosOps[index] = ioOp;
+		aio.start(ioOp);
+	} while (false);
+	return op;
+}
+
+// Sync calls go through the engine too,
+// so that they are ordered with the async ones.
+static SceFiosSize runSync(const AsyncIoRequest& request)
+{
+	auto& aio = TheEmulator().aio();
+
+	AsyncIoOp* op = aio.submit(request);
+	aio.wait(op);
+	SceFiosSize ret = getOpResult(op);
+	aio.release(op);
+	return ret;
+}
+
 //////////////////////////////////////////////////////////////////////////
 // library: libSceFios2
 //////////////////////////////////////////////////////////////////////////
@@ -21,17 +275,26 @@ int PS4API sceFiosDateToComponents(void)
 }
 
 
-int PS4API sceFiosDeleteSync(void)
+int PS4API sceFiosDeleteSync(const SceFiosOpAttr* pAttr, const char* pPath)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("path %s", pPath);
+
+	auto&   vfs  = TheEmulator().vfs();
+	VfsStat stat = {};
+	int     err  = vfs.stat(pPath, &stat);
+	if (err == 0)
+	{
+		err = stat.type == VfsNodeType::Directory ? vfs.rmdir(pPath) : vfs.unlink(pPath);
+	}
+	return err < 0 ? getFiosError(err) : SCE_OK;
 }
 
 
-int PS4API sceFiosDirectoryCreateSync(void)
+int PS4API sceFiosDirectoryCreateSync(const SceFiosOpAttr* pAttr, const char* pPath)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("path %s", pPath);
+	int err = TheEmulator().vfs().mkdir(pPath);
+	return err < 0 ? getFiosError(err) : SCE_OK;
 }
 
 
@@ -40,7 +303,7 @@ bool PS4API sceFiosFileExistsSync(const SceFiosOpAttr* pAttr, const char* pPath)
 	LOG_SCE_TRACE("path %s", pPath);
 
 	LOG_ASSERT(pAttr == nullptr, "only support null attr.");
-	auto path = plat::PS4PathToPCPath(pPath);
+	auto path = TheEmulator().vfs().hostPath(pPath);
 	bool isDir = std::filesystem::is_directory(path);
 	bool exists = std::filesystem::exists(path);
 	return !isDir && exists;
@@ -52,80 +315,285 @@ bool PS4API sceFiosDirectoryExistsSync(const SceFiosOpAttr *pAttr, const char *p
 	LOG_SCE_TRACE("path %s", pPath);
 
 	LOG_ASSERT(pAttr == nullptr, "only support null attr.");
-	auto path   = plat::PS4PathToPCPath(pPath);
+	auto path   = TheEmulator().vfs().hostPath(pPath);
 	bool isDir  = std::filesystem::is_directory(path);
 	bool exists = std::filesystem::exists(path);
 	return isDir && exists;
 }
 
 
-int PS4API sceFiosFHCloseSync(void)
+int PS4API sceFiosFHCloseSync(const SceFiosOpAttr* pAttr, SceFiosFH fh)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("fh %d", fh);
+
+	int ret = SCE_FIOS_ERROR_BAD_FH;
+	do
+	{
+		FiosFile* file = getFiosFile(fh);
+		if (!file)
+		{
+			break;
+		}
+
+		g_fiosFiles[fh] = nullptr;
+
+		TheEmulator().aio().forgetFile(file->file);
+		TheEmulator().vfs().close(file->file);
+		delete file;
+
+		ret = SCE_OK;
+	} while (false);
+	return ret;
 }
 
 
-int PS4API sceFiosFHOpenSync(void)
+int PS4API sceFiosFHOpenSync(const SceFiosOpAttr* pAttr, SceFiosFH* pOutFH, const char* pPath, const SceFiosOpenParams* pOpenParams)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("path %s", pPath);
+
+	int ret = SCE_FIOS_ERROR_BAD_PTR;
+	do
+	{
+		if (!pOutFH || !pPath)
+		{
+			break;
+		}
+
+		uint32_t openFlags = pOpenParams ? pOpenParams->openFlags : SCE_FIOS_O_READ;
+		uint32_t vfsFlags  = 0;
+		vfsFlags |= (openFlags & SCE_FIOS_O_READ) ? VfsOpenRead : 0;
+		vfsFlags |= (openFlags & SCE_FIOS_O_WRITE) ? VfsOpenWrite : 0;
+		vfsFlags |= (openFlags & SCE_FIOS_O_APPEND) ? VfsOpenAppend : 0;
+		vfsFlags |= (openFlags & SCE_FIOS_O_CREAT) ? VfsOpenCreate : 0;
+		vfsFlags |= (openFlags & SCE_FIOS_O_TRUNC) ? VfsOpenTruncate : 0;
+		if (!(vfsFlags & (VfsOpenRead | VfsOpenWrite)))
+		{
+			vfsFlags |= VfsOpenRead;
+		}
+
+		VfsFile vfsFile;
+		int     err = TheEmulator().vfs().open(pPath, vfsFlags, &vfsFile);
+		if (err < 0)
+		{
+			ret = getFiosError(err);
+			break;
+		}
+
+		auto file    = new FiosFile();
+		file->file   = vfsFile;
+		file->offset = 0;
+
+		uint32_t index = 0;
+		{
+			std::lock_guard<std::mutex> lock(g_fiosSlotMutex);
+			index = g_fiosFiles.GetEmptySlotIndex();
+			if (index != 0)
+			{
+				g_fiosFiles[index] = file;
+			}
+		}
+
+		if (index == 0)
+		{
+			TheEmulator().vfs().close(file->file);
+			delete file;
+			ret = SCE_FIOS_ERROR_CANT_ALLOCATE_FH;
+			break;
+		}
+
+		*pOutFH = index;
+		ret     = SCE_OK;
+	} while (false);
+	return ret;
 }
 
 
-int PS4API sceFiosFHReadSync(void)
+SceFiosSize PS4API sceFiosFHReadSync(const SceFiosOpAttr* pAttr, SceFiosFH fh, void* pBuf, SceFiosSize length)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("fh %d buf %p length %lld", fh, pBuf, length);
+
+	SceFiosSize ret = SCE_FIOS_ERROR_BAD_FH;
+	do
+	{
+		FiosFile* file = getFiosFile(fh);
+		if (!file)
+		{
+			break;
+		}
+
+		ret = runSync(makeRequest(pAttr, AsyncIoType::Read, file, pBuf, length, file->offset));
+		if (ret > 0)
+		{
+			file->offset += ret;
+		}
+	} while (false);
+	return ret;
 }
 
 
-int PS4API sceFiosFHSeek(void)
+SceFiosOffset PS4API sceFiosFHSeek(SceFiosFH fh, SceFiosOffset offset, SceFiosWhence whence)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("fh %d offset %lld whence %d", fh, offset, whence);
+
+	SceFiosOffset ret = SCE_FIOS_ERROR_BAD_FH;
+	do
+	{
+		FiosFile* file = getFiosFile(fh);
+		if (!file)
+		{
+			break;
+		}
+
+		SceFiosOffset position = offset;
+		if (whence == SCE_FIOS_SEEK_CUR)
+		{
+			position += file->offset;
+		}
+		else if (whence == SCE_FIOS_SEEK_END)
+		{
+			VfsStat stat = {};
+			TheEmulator().vfs().fstat(file->file, &stat);
+			position += stat.size;
+		}
+
+		if (position < 0)
+		{
+			ret = SCE_FIOS_ERROR_BAD_OFFSET;
+			break;
+		}
+
+		file->offset = position;
+		ret          = position;
+	} while (false);
+	return ret;
 }
 
 
-int PS4API sceFiosFHStatSync(void)
+int PS4API sceFiosFHStatSync(const SceFiosOpAttr* pAttr, SceFiosFH fh, SceFiosStat* pOutStatus)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("fh %d", fh);
+
+	int ret = SCE_FIOS_ERROR_BAD_FH;
+	do
+	{
+		FiosFile* file = getFiosFile(fh);
+		if (!file)
+		{
+			break;
+		}
+
+		VfsStat stat = {};
+		int     err  = TheEmulator().vfs().fstat(file->file, &stat);
+		if (err < 0)
+		{
+			ret = getFiosError(err);
+			break;
+		}
+
+		getFiosStat(stat, pOutStatus);
+		ret = SCE_OK;
+	} while (false);
+	return ret;
 }
 
 
-int PS4API sceFiosFHWriteSync(void)
+SceFiosSize PS4API sceFiosFHWriteSync(const SceFiosOpAttr* pAttr, SceFiosFH fh, const void* pBuf, SceFiosSize length)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("fh %d buf %p length %lld", fh, pBuf, length);
+
+	SceFiosSize ret = SCE_FIOS_ERROR_BAD_FH;
+	do
+	{
+		FiosFile* file = getFiosFile(fh);
+		if (!file)
+		{
+			break;
+		}
+
+		ret = runSync(makeRequest(pAttr, AsyncIoType::Write, file, pBuf, length, file->offset));
+		if (ret > 0)
+		{
+			file->offset += ret;
+		}
+	} while (false);
+	return ret;
 }
 
 
-int PS4API sceFiosFileGetSizeSync(void)
+SceFiosSize PS4API sceFiosFileGetSizeSync(const SceFiosOpAttr* pAttr, const char* pPath)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("path %s", pPath);
+
+	VfsStat stat = {};
+	int     err  = TheEmulator().vfs().stat(pPath, &stat);
+	return err < 0 ? getFiosError(err) : static_cast<SceFiosSize>(stat.size);
 }
 
 
-int PS4API sceFiosFileReadSync(void)
+SceFiosSize PS4API sceFiosFileReadSync(const SceFiosOpAttr* pAttr, const char* pPath, void* pBuf, SceFiosSize length, SceFiosOffset offset)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("path %s buf %p length %lld offset %lld", pPath, pBuf, length, offset);
+
+	SceFiosSize ret = 0;
+	do
+	{
+		FiosFile file;
+		int      err = TheEmulator().vfs().open(pPath, VfsOpenRead, &file.file);
+		if (err < 0)
+		{
+			ret = getFiosError(err);
+			break;
+		}
+
+		ret = runSync(makeRequest(pAttr, AsyncIoType::Read, &file, pBuf, length, offset));
+		TheEmulator().aio().forgetFile(file.file);
+		TheEmulator().vfs().close(file.file);
+	} while (false);
+	return ret;
 }
 
 
-int PS4API sceFiosFileWriteSync(void)
+SceFiosSize PS4API sceFiosFileWriteSync(const SceFiosOpAttr* pAttr, const char* pPath, const void* pBuf, SceFiosSize length, SceFiosOffset offset)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("path %s buf %p length %lld offset %lld", pPath, pBuf, length, offset);
+
+	SceFiosSize ret = 0;
+	do
+	{
+		FiosFile file;
+		int      err = TheEmulator().vfs().open(pPath, VfsOpenWrite | VfsOpenCreate, &file.file);
+		if (err < 0)
+		{
+			ret = getFiosError(err);
+			break;
+		}
+
+		ret = runSync(makeRequest(pAttr, AsyncIoType::Write, &file, pBuf, length, offset));
+		TheEmulator().aio().forgetFile(file.file);
+		TheEmulator().vfs().close(file.file);
+	} while (false);
+	return ret;
 }
 
 
-int PS4API sceFiosStatSync(void)
+int PS4API sceFiosStatSync(const SceFiosOpAttr* pAttr, const char* pPath, SceFiosStat* pOutStatus)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("path %s", pPath);
+
+	int ret = SCE_OK;
+	do
+	{
+		VfsStat stat = {};
+		int     err  = TheEmulator().vfs().stat(pPath, &stat);
+		if (err < 0)
+		{
+			ret = getFiosError(err);
+			break;
+		}
+
+		getFiosStat(stat, pOutStatus);
+	} while (false);
+	return ret;
 }
 
 
@@ -150,22 +618,334 @@ int PS4API sceFiosFHToFileno(void)
 }
 
 
-int PS4API sceFiosIsValidHandle(void) 
+bool PS4API sceFiosIsValidHandle(SceFiosHandle h)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("handle %d", h);
+	return getFiosFile(h) != nullptr || getFiosOp(h) != nullptr;
 }
 
 
-int PS4API sceFiosFHOpenWithModeSync(void) 
+int PS4API sceFiosFHOpenWithModeSync(const SceFiosOpAttr* pAttr, SceFiosFH* pOutFH, const char* pPath, const SceFiosOpenParams* pOpenParams, int32_t nativeMode)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	// The host decides the mode of new files.
+	return sceFiosFHOpenSync(pAttr, pOutFH, pPath, pOpenParams);
 }
 
 
-int PS4API sceFiosRenameSync(void)
+int PS4API sceFiosRenameSync(const SceFiosOpAttr* pAttr, const char* pOldPath, const char* pNewPath)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("from %s to %s", pOldPath, pNewPath);
+	int err = TheEmulator().vfs().rename(pOldPath, pNewPath);
+	return err < 0 ? getFiosError(err) : SCE_OK;
+}
+
+
+SceFiosOp PS4API sceFiosFHRead(const SceFiosOpAttr* pAttr, SceFiosFH fh, void* pBuf, SceFiosSize length)
+{
+	LOG_SCE_TRACE("fh %d buf %p length %lld", fh, pBuf, length);
+
+	SceFiosOp ret = SCE_FIOS_HANDLE_INVALID;
+	do
+	{
+		FiosFile* file = getFiosFile(fh);
+		if (!file)
+		{
+			break;
+		}
+
+		// The position moves on submit, so that
+		// back to back reads don't overlap.
+		auto request = makeRequest(pAttr, AsyncIoType::Read, file, pBuf, length, file->offset.fetch_add(length));
+		ret          = submitOp(pAttr, request);
+	} while (false);
+	return ret;
+}
+
+
+SceFiosOp PS4API sceFiosFHPread(const SceFiosOpAttr* pAttr, SceFiosFH fh, void* pBuf, SceFiosSize length, SceFiosOffset offset)
+{
+	LOG_SCE_TRACE("fh %d buf %p length %lld offset %lld", fh, pBuf, length, offset);
+
+	SceFiosOp ret = SCE_FIOS_HANDLE_INVALID;
+	do
+	{
+		FiosFile* file = getFiosFile(fh);
+		if (!file)
+		{
+			break;
+		}
+
+		auto request = makeRequest(pAttr, AsyncIoType::Read, file, pBuf, length, offset);
+		ret          = submitOp(pAttr, request);
+	} while (false);
+	return ret;
+}
+
+
+SceFiosSize PS4API sceFiosFHPreadSync(const SceFiosOpAttr* pAttr, SceFiosFH fh, void* pBuf, SceFiosSize length, SceFiosOffset offset)
+{
+	LOG_SCE_TRACE("fh %d buf %p length %lld offset %lld", fh, pBuf, length, offset);
+
+	FiosFile* file = getFiosFile(fh);
+	return file ? runSync(makeRequest(pAttr, AsyncIoType::Read, file, pBuf, length, offset))
+				: SCE_FIOS_ERROR_BAD_FH;
+}
+
+
+SceFiosOp PS4API sceFiosFHWrite(const SceFiosOpAttr* pAttr, SceFiosFH fh, const void* pBuf, SceFiosSize length)
+{
+	LOG_SCE_TRACE("fh %d buf %p length %lld", fh, pBuf, length);
+
+	SceFiosOp ret = SCE_FIOS_HANDLE_INVALID;
+	do
+	{
+		FiosFile* file = getFiosFile(fh);
+		if (!file)
+		{
+			break;
+		}
+
+		auto request = makeRequest(pAttr, AsyncIoType::Write, file, pBuf, length, file->offset.fetch_add(length));
+		ret          = submitOp(pAttr, request);
+	} while (false);
+	return ret;
+}
+
+
+SceFiosOp PS4API sceFiosFHPwrite(const SceFiosOpAttr* pAttr, SceFiosFH fh, const void* pBuf, SceFiosSize length, SceFiosOffset offset)
+{
+	LOG_SCE_TRACE("fh %d buf %p length %lld offset %lld", fh, pBuf, length, offset);
+
+	SceFiosOp ret = SCE_FIOS_HANDLE_INVALID;
+	do
+	{
+		FiosFile* file = getFiosFile(fh);
+		if (!file)
+		{
+			break;
+		}
+
+		auto request = makeRequest(pAttr, AsyncIoType::Write, file, pBuf, length, offset);
+		ret          = submitOp(pAttr, request);
+	} while (false);
+	return ret;
+}
+
+
+SceFiosSize PS4API sceFiosFHPwriteSync(const SceFiosOpAttr* pAttr, SceFiosFH fh, const void* pBuf, SceFiosSize length, SceFiosOffset offset)
+{
+	LOG_SCE_TRACE("fh %d buf %p length %lld offset %lld", fh, pBuf, length, offset);
+
+	FiosFile* file = getFiosFile(fh);
+	return file ? runSync(makeRequest(pAttr, AsyncIoType::Write, file, pBuf, length, offset))
+				: SCE_FIOS_ERROR_BAD_FH;
+}
+
+
+SceFiosOffset PS4API sceFiosFHGetSize(SceFiosFH fh)
+{
+	LOG_SCE_TRACE("fh %d", fh);
+
+	SceFiosOffset ret = SCE_FIOS_ERROR_BAD_FH;
+	do
+	{
+		FiosFile* file = getFiosFile(fh);
+		if (!file)
+		{
+			break;
+		}
+
+		VfsStat stat = {};
+		int     err  = TheEmulator().vfs().fstat(file->file, &stat);
+		ret          = err < 0 ? getFiosError(err) : static_cast<SceFiosOffset>(stat.size);
+	} while (false);
+	return ret;
+}
+
+
+SceFiosOp PS4API sceFiosCachePrefetchFH(const SceFiosOpAttr* pAttr, SceFiosFH fh)
+{
+	LOG_SCE_TRACE("fh %d", fh);
+
+	SceFiosOffset size = sceFiosFHGetSize(fh);
+	return size >= 0 ? sceFiosCachePrefetchFHRange(pAttr, fh, 0, size) : SCE_FIOS_HANDLE_INVALID;
+}
+
+
+SceFiosOp PS4API sceFiosCachePrefetchFHRange(const SceFiosOpAttr* pAttr, SceFiosFH fh, SceFiosOffset offset, SceFiosSize length)
+{
+	LOG_SCE_TRACE("fh %d offset %lld length %lld", fh, offset, length);
+
+	SceFiosOp ret = SCE_FIOS_HANDLE_INVALID;
+	do
+	{
+		FiosFile* file = getFiosFile(fh);
+		if (!file)
+		{
+			break;
+		}
+
+		// There is no cache of our own,
+		// the host page cache is asked to fill in instead.
+		auto request = makeRequest(pAttr, AsyncIoType::Prefetch, file, nullptr, length, offset);
+		ret          = submitOp(pAttr, request);
+	} while (false);
+	return ret;
+}
+
+
+int PS4API sceFiosOpWait(SceFiosOp op)
+{
+	LOG_SCE_TRACE("op %d", op);
+
+	int ret = SCE_FIOS_ERROR_BAD_OP;
+	do
+	{
+		AsyncIoOp* ioOp = getFiosOp(op);
+		if (!ioOp)
+		{
+			break;
+		}
+
+		TheEmulator().aio().wait(ioOp);
+		ret = getOpError(ioOp);
+	} while (false);
+	return ret;
+}
+
+
+int PS4API sceFiosOpWaitUntil(SceFiosOp op, SceFiosTime deadline)
+{
+	LOG_SCE_TRACE("op %d deadline %lld", op, deadline);
+
+	int ret = SCE_FIOS_ERROR_BAD_OP;
+	do
+	{
+		AsyncIoOp* ioOp = getFiosOp(op);
+		if (!ioOp)
+		{
+			break;
+		}
+
+		bool isDone = false;
+		if (deadline == SCE_FIOS_TIME_NULL || deadline == SCE_FIOS_TIME_LATEST)
+		{
+			isDone = TheEmulator().aio().wait(ioOp);
+		}
+		else
+		{
+			SceFiosTime timeLeft = std::max<SceFiosTime>(deadline - sceFiosTimeGetCurrent(), 0);
+			uint64_t    timeout  = static_cast<uint64_t>(timeLeft) / 1000;
+			isDone               = TheEmulator().aio().wait(ioOp, &timeout);
+		}
+
+		ret = isDone ? getOpError(ioOp) : SCE_FIOS_ERROR_TIMEOUT;
+	} while (false);
+	return ret;
+}
+
+
+bool PS4API sceFiosOpIsDone(SceFiosOp op)
+{
+	LOG_SCE_TRACE("op %d", op);
+
+	AsyncIoOp* ioOp = getFiosOp(op);
+	return ioOp ? TheEmulator().aio().isDone(ioOp) : true;
+}
+
+
+int PS4API sceFiosOpGetError(SceFiosOp op)
+{
+	LOG_SCE_TRACE("op %d", op);
+
+	int ret = SCE_FIOS_ERROR_BAD_OP;
+	do
+	{
+		AsyncIoOp* ioOp = getFiosOp(op);
+		if (!ioOp)
+		{
+			break;
+		}
+
+		ret = TheEmulator().aio().isDone(ioOp) ? getOpError(ioOp) : SCE_FIOS_ERROR_BUSY;
+	} while (false);
+	return ret;
+}
+
+
+SceFiosSize PS4API sceFiosOpGetActualCount(SceFiosOp op)
+{
+	LOG_SCE_TRACE("op %d", op);
+
+	AsyncIoOp* ioOp = getFiosOp(op);
+	return ioOp ? ioOp->transferred.load() : SCE_FIOS_ERROR_BAD_OP;
+}
+
+
+void PS4API sceFiosOpCancel(SceFiosOp op)
+{
+	LOG_SCE_TRACE("op %d", op);
+
+	AsyncIoOp* ioOp = getFiosOp(op);
+	if (ioOp)
+	{
+		TheEmulator().aio().cancel(ioOp);
+	}
+}
+
+
+void PS4API sceFiosOpDelete(SceFiosOp op)
+{
+	LOG_SCE_TRACE("op %d", op);
+
+	do
+	{
+		AsyncIoOp* ioOp = getFiosOp(op);
+		if (!ioOp)
+		{
+			break;
+		}
+
+		g_fiosOps[op - FiosOpHandleBase] = nullptr;
+
+		// The engine keeps its own reference
+		// until the op is done.
+		TheEmulator().aio().cancel(ioOp);
+		TheEmulator().aio().release(ioOp);
+	} while (false);
+}
+
+
+SceFiosSize PS4API sceFiosOpSyncWait(SceFiosOp op)
+{
+	LOG_SCE_TRACE("op %d", op);
+
+	SceFiosSize ret = SCE_FIOS_ERROR_BAD_OP;
+	do
+	{
+		AsyncIoOp* ioOp = getFiosOp(op);
+		if (!ioOp)
+		{
+			break;
+		}
+
+		TheEmulator().aio().wait(ioOp);
+		ret = getOpResult(ioOp);
+		sceFiosOpDelete(op);
+	} while (false);
+	return ret;
+}
+
+
+SceFiosSize PS4API sceFiosOpSyncWaitForIO(SceFiosOp op)
+{
+	return sceFiosOpSyncWait(op);
+}
+
+
+SceFiosTime PS4API sceFiosTimeGetCurrent(void)
+{
+	// Same clock as op deadlines.
+	using namespace std::chrono;
+	return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
 }
@@ -28,46 +28,46 @@ extern const SCE_EXPORT_MODULE g_ExpModuleSceFios2;
 int PS4API sceFiosDateToComponents(void);
 
 
-int PS4API sceFiosDeleteSync(void);
+int PS4API sceFiosDeleteSync(const SceFiosOpAttr* pAttr, const char* pPath);
 
 
-int PS4API sceFiosDirectoryCreateSync(void);
+int PS4API sceFiosDirectoryCreateSync(const SceFiosOpAttr* pAttr, const char* pPath);
 
 
 bool PS4API sceFiosDirectoryExistsSync(const SceFiosOpAttr *pAttr, const char *pPath);
 
 
-int PS4API sceFiosFHCloseSync(void);
+int PS4API sceFiosFHCloseSync(const SceFiosOpAttr* pAttr, SceFiosFH fh);
 
 
-int PS4API sceFiosFHOpenSync(void);
+int PS4API sceFiosFHOpenSync(const SceFiosOpAttr* pAttr, SceFiosFH* pOutFH, const char* pPath, const SceFiosOpenParams* pOpenParams);
 
 
-int PS4API sceFiosFHReadSync(void);
+SceFiosSize PS4API sceFiosFHReadSync(const SceFiosOpAttr* pAttr, SceFiosFH fh, void* pBuf, SceFiosSize length);
 
 
-int PS4API sceFiosFHSeek(void);
+SceFiosOffset PS4API sceFiosFHSeek(SceFiosFH fh, SceFiosOffset offset, SceFiosWhence whence);
 
 
-int PS4API sceFiosFHStatSync(void);
+int PS4API sceFiosFHStatSync(const SceFiosOpAttr* pAttr, SceFiosFH fh, SceFiosStat* pOutStatus);
 
 
-int PS4API sceFiosFHWriteSync(void);
+SceFiosSize PS4API sceFiosFHWriteSync(const SceFiosOpAttr* pAttr, SceFiosFH fh, const void* pBuf, SceFiosSize length);
 
 
 bool PS4API sceFiosFileExistsSync(const SceFiosOpAttr *pAttr, const char *pPath);
 
 
-int PS4API sceFiosFileGetSizeSync(void);
+SceFiosSize PS4API sceFiosFileGetSizeSync(const SceFiosOpAttr* pAttr, const char* pPath);
 
 
-int PS4API sceFiosFileReadSync(void);
+SceFiosSize PS4API sceFiosFileReadSync(const SceFiosOpAttr* pAttr, const char* pPath, void* pBuf, SceFiosSize length, SceFiosOffset offset);
 
 
-int PS4API sceFiosFileWriteSync(void);
+SceFiosSize PS4API sceFiosFileWriteSync(const SceFiosOpAttr* pAttr, const char* pPath, const void* pBuf, SceFiosSize length, SceFiosOffset offset);
 
 
-int PS4API sceFiosStatSync(void);
+int PS4API sceFiosStatSync(const SceFiosOpAttr* pAttr, const char* pPath, SceFiosStat* pOutStatus);
 
 
 int PS4API sceFiosDeallocatePassthruFH(void);
@@ -79,10 +79,67 @@ int PS4API sceFiosFilenoToFH(void);
 int PS4API sceFiosFHToFileno(void);
 
 
-int PS4API sceFiosIsValidHandle(void);
+bool PS4API sceFiosIsValidHandle(SceFiosHandle h);
 
 
-int PS4API sceFiosFHOpenWithModeSync(void);
+int PS4API sceFiosFHOpenWithModeSync(const SceFiosOpAttr* pAttr, SceFiosFH* pOutFH, const char* pPath, const SceFiosOpenParams* pOpenParams, int32_t nativeMode);
 
 
-int PS4API sceFiosRenameSync(void);
\ No newline at end of file
+int PS4API sceFiosRenameSync(const SceFiosOpAttr* pAttr, const char* pOldPath, const char* pNewPath);
+
+
+SceFiosOp PS4API sceFiosFHRead(const SceFiosOpAttr* pAttr, SceFiosFH fh, void* pBuf, SceFiosSize length);
+
+
+SceFiosOp PS4API sceFiosFHPread(const SceFiosOpAttr* pAttr, SceFiosFH fh, void* pBuf, SceFiosSize length, SceFiosOffset offset);
+
+
+SceFiosSize PS4API sceFiosFHPreadSync(const SceFiosOpAttr* pAttr, SceFiosFH fh, void* pBuf, SceFiosSize length, SceFiosOffset offset);
+
+
+SceFiosOp PS4API sceFiosFHWrite(const SceFiosOpAttr* pAttr, SceFiosFH fh, const void* pBuf, SceFiosSize length);
+
+
+SceFiosOp PS4API sceFiosFHPwrite(const SceFiosOpAttr* pAttr, SceFiosFH fh, const void* pBuf, SceFiosSize length, SceFiosOffset offset);
+
+
+SceFiosSize PS4API sceFiosFHPwriteSync(const SceFiosOpAttr* pAttr, SceFiosFH fh, const void* pBuf, SceFiosSize length, SceFiosOffset offset);
+
+
+SceFiosOffset PS4API sceFiosFHGetSize(SceFiosFH fh);
+
+
+SceFiosOp PS4API sceFiosCachePrefetchFH(const SceFiosOpAttr* pAttr, SceFiosFH fh);
+
+
+SceFiosOp PS4API sceFiosCachePrefetchFHRange(const SceFiosOpAttr* pAttr, SceFiosFH fh, SceFiosOffset offset, SceFiosSize length);
+
+
+int PS4API sceFiosOpWait(SceFiosOp op);
+
+
+int PS4API sceFiosOpWaitUntil(SceFiosOp op, SceFiosTime deadline);
+
+
+bool PS4API sceFiosOpIsDone(SceFiosOp op);
+
+
+int PS4API sceFiosOpGetError(SceFiosOp op);
+
+
+SceFiosSize PS4API sceFiosOpGetActualCount(SceFiosOp op);
+
+
+void PS4API sceFiosOpCancel(SceFiosOp op);
+
+
+void PS4API sceFiosOpDelete(SceFiosOp op);
+
+
+SceFiosSize PS4API sceFiosOpSyncWait(SceFiosOp op);
+
+
+SceFiosSize PS4API sceFiosOpSyncWaitForIO(SceFiosOp op);
+
+
+SceFiosTime PS4API sceFiosTimeGetCurrent(void);
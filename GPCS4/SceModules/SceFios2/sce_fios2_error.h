@@ -0,0 +1,36 @@
+#pragma once
+
+
+
+// Fios2 errors
+#define SCE_FIOS_ERROR_UNIMPLEMENTED				-2138963967	 //0x80820001
+#define SCE_FIOS_ERROR_CANT_ALLOCATE_OP				-2138963966	 //0x80820002
+#define SCE_FIOS_ERROR_CANT_ALLOCATE_FH				-2138963965	 //0x80820003
+#define SCE_FIOS_ERROR_CANT_ALLOCATE_DH				-2138963964	 //0x80820004
+#define SCE_FIOS_ERROR_CANT_ALLOCATE_CHUNK			-2138963963	 //0x80820005
+#define SCE_FIOS_ERROR_BAD_PATH						-2138963962	 //0x80820006
+#define SCE_FIOS_ERROR_BAD_PTR						-2138963961	 //0x80820007
+#define SCE_FIOS_ERROR_BAD_OFFSET					-2138963960	 //0x80820008
+#define SCE_FIOS_ERROR_BAD_SIZE						-2138963959	 //0x80820009
+#define SCE_FIOS_ERROR_BAD_IOVCNT					-2138963958	 //0x8082000A
+#define SCE_FIOS_ERROR_BAD_OP						-2138963957	 //0x8082000B
+#define SCE_FIOS_ERROR_BAD_FH						-2138963956	 //0x8082000C
+#define SCE_FIOS_ERROR_BAD_DH						-2138963955	 //0x8082000D
+#define SCE_FIOS_ERROR_BAD_ALIGNMENT				-2138963954	 //0x8082000E
+#define SCE_FIOS_ERROR_NOT_A_FILE					-2138963953	 //0x8082000F
+#define SCE_FIOS_ERROR_NOT_A_DIRECTORY				-2138963952	 //0x80820010
+#define SCE_FIOS_ERROR_EOF							-2138963951	 //0x80820011
+#define SCE_FIOS_ERROR_TIMEOUT						-2138963950	 //0x80820012
+#define SCE_FIOS_ERROR_CANCELLED					-2138963949	 //0x80820013
+#define SCE_FIOS_ERROR_ACCESS						-2138963948	 //0x80820014
+#define SCE_FIOS_ERROR_DECOMPRESSION				-2138963947	 //0x80820015
+#define SCE_FIOS_ERROR_READ_ONLY					-2138963946	 //0x80820016
+#define SCE_FIOS_ERROR_WRITE_ONLY					-2138963945	 //0x80820017
+#define SCE_FIOS_ERROR_MEDIA_GONE					-2138963944	 //0x80820018
+#define SCE_FIOS_ERROR_PATH_TOO_LONG				-2138963943	 //0x80820019
+#define SCE_FIOS_ERROR_TOO_MANY_OVERLAYS			-2138963942	 //0x8082001A
+#define SCE_FIOS_ERROR_BAD_OVERLAY					-2138963941	 //0x8082001B
+#define SCE_FIOS_ERROR_BAD_ORDER					-2138963940	 //0x8082001C
+#define SCE_FIOS_ERROR_BAD_INDEX					-2138963939	 //0x8082001D
+#define SCE_FIOS_ERROR_EVENT_NOT_HANDLED			-2138963938	 //0x8082001E
+#define SCE_FIOS_ERROR_BUSY							-2138963937	 //0x8082001F
@@ -29,6 +29,25 @@ static const SCE_EXPORT_FUNCTION g_pSceFios2_libSceFios2_FunctionTable[] =
 	{ 0xF081A3C2D9EF6302, "sceFiosIsValidHandle", (void*)sceFiosIsValidHandle },
 	{ 0xC35DCE8E6ECE37DA, "sceFiosFHOpenWithModeSync", (void*)sceFiosFHOpenWithModeSync },
 	{ 0x1BFDFD96C752817A, "sceFiosRenameSync", (void*)sceFiosRenameSync },
+	{ 0x720FD5A0FA9962CB, "sceFiosFHRead", (void*)sceFiosFHRead },
+	{ 0xAD1F30ABB605459B, "sceFiosFHPread", (void*)sceFiosFHPread },
+	{ 0xDA6F7E3A9728FE19, "sceFiosFHPreadSync", (void*)sceFiosFHPreadSync },
+	{ 0xBAB5079061B0780E, "sceFiosFHWrite", (void*)sceFiosFHWrite },
+	{ 0x3DBC4655F3AF5106, "sceFiosFHPwrite", (void*)sceFiosFHPwrite },
+	{ 0x80C71F3AD1D6EB39, "sceFiosFHPwriteSync", (void*)sceFiosFHPwriteSync },
+	{ 0x15D8E8A8540E96DD, "sceFiosFHGetSize", (void*)sceFiosFHGetSize },
+	{ 0x886A6E681150AE84, "sceFiosCachePrefetchFH", (void*)sceFiosCachePrefetchFH },
+	{ 0xB93E0405F976F38A, "sceFiosCachePrefetchFHRange", (void*)sceFiosCachePrefetchFHRange },
+	{ 0x4A7A104169C62BD2, "sceFiosOpWait", (void*)sceFiosOpWait },
+	{ 0x652B058AD6782A99, "sceFiosOpWaitUntil", (void*)sceFiosOpWaitUntil },
+	{ 0x6DF828D8EB66AB3D, "sceFiosOpIsDone", (void*)sceFiosOpIsDone },
+	{ 0x5FEEEB21F63DECFB, "sceFiosOpGetError", (void*)sceFiosOpGetError },
+	{ 0xF8546F2A49D48F52, "sceFiosOpGetActualCount", (void*)sceFiosOpGetActualCount },
+	{ 0x140EDD52579E1A29, "sceFiosOpCancel", (void*)sceFiosOpCancel },
+	{ 0xE5CC8472294EFC9D, "sceFiosOpDelete", (void*)sceFiosOpDelete },
+	{ 0xDB0BEA4BB39D6FA3, "sceFiosOpSyncWait", (void*)sceFiosOpSyncWait },
+	{ 0x9CFFCB69B6311DB9, "sceFiosOpSyncWaitForIO", (void*)sceFiosOpSyncWaitForIO },
+	{ 0x35490118E640462E, "sceFiosTimeGetCurrent", (void*)sceFiosTimeGetCurrent },
 	SCE_FUNCTION_ENTRY_END
 };
 
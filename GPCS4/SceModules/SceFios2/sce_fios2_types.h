@@ -6,12 +6,38 @@
 
 #define SCE_FIOS_HANDLE_INVALID 0
 
+#define SCE_FIOS_TIME_NULL     0
+#define SCE_FIOS_TIME_EARLIEST 1
+#define SCE_FIOS_TIME_LATEST   0x7FFFFFFFFFFFFFFFLL
+
+#define SCE_FIOS_O_READ   (1 << 0)
+#define SCE_FIOS_O_WRITE  (1 << 1)
+#define SCE_FIOS_O_APPEND (1 << 2)
+#define SCE_FIOS_O_CREAT  (1 << 3)
+#define SCE_FIOS_O_TRUNC  (1 << 4)
+
+#define SCE_FIOS_SEEK_SET 0
+#define SCE_FIOS_SEEK_CUR 1
+#define SCE_FIOS_SEEK_END 2
+
+#define SCE_FIOS_STATUS_DIRECTORY (1 << 0)
+#define SCE_FIOS_STATUS_READABLE  (1 << 1)
+#define SCE_FIOS_STATUS_WRITABLE  (1 << 2)
+
+#define SCE_FIOS_OPEVENT_COMPLETE 1
+#define SCE_FIOS_OPEVENT_DELETE   2
+
 typedef int32_t SceFiosHandle;
 typedef SceFiosHandle SceFiosOp;
+typedef SceFiosHandle SceFiosFH;
 typedef int64_t SceFiosTime;
+typedef int64_t SceFiosSize;
+typedef int64_t SceFiosOffset;
+typedef int64_t SceFiosDate;
 typedef uint8_t SceFiosOpEvent;
+typedef int32_t SceFiosWhence;
 
-typedef int (*SceFiosOpCallback)(void* pContext, SceFiosOp op, SceFiosOpEvent event, int err);
+typedef int (PS4API *SceFiosOpCallback)(void* pContext, SceFiosOp op, SceFiosOpEvent event, int err);
 
 struct SceFiosOpAttr
 {
@@ -23,4 +49,33 @@ struct SceFiosOpAttr
 	uint32_t userTag;
 	void* userPtr;
 	void* pReserved;
-};
\ No newline at end of file
+};
+
+struct SceFiosBuffer
+{
+	void* pPtr;
+	size_t length;
+};
+
+struct SceFiosOpenParams
+{
+	uint32_t openFlags : 16;
+	uint32_t opFlags : 16;
+	uint32_t reserved;
+	SceFiosBuffer buffer;
+};
+
+struct SceFiosStat
+{
+	SceFiosOffset fileSize;
+	SceFiosDate accessDate;
+	SceFiosDate modificationDate;
+	SceFiosDate creationDate;
+	uint32_t statFlags;
+	uint32_t reserved;
+	int64_t uid;
+	int64_t gid;
+	int64_t dev;
+	int64_t ino;
+	int64_t mode;
+};
@@ -1,24 +1,49 @@
 #include "sce_gnmdriver.h"
+#include "Emulator.h"
+#include "VirtualGPU.h"
+#include "Sce/SceGnmDriver.h"
+#include "SceLibkernel/SceEventQueue.h"
 
 LOG_CHANNEL(SceModules.SceDriver.GnmEQEvent);
 
 int PS4API sceGnmAddEqEvent(SceKernelEqueue eq, Gnm::EqEventType id, void* udata)
 {
-	LOG_SCE_GRAPHIC("Not implemented");
-	LOG_ASSERT(id == Gnm::kEqEventGfxEop, "TODO");
-	return SCE_OK;
+	LOG_SCE_GRAPHIC("eq %p id %d udata %p", eq, id, udata);
+	int ret = SCE_KERNEL_ERROR_EINVAL;
+	do
+	{
+		auto source = GPU().gnmDriver().eqEvent(id);
+		if (!source)
+		{
+			break;
+		}
+
+		ret = source->AddQueue((CSceEventQueue*)eq, id, SCE_KERNEL_EVFILT_GRAPHICS_CORE, udata);
+	} while (false);
+	return ret;
 }
 
 
-int PS4API sceGnmGetEqEventType(void)
+int PS4API sceGnmGetEqEventType(const SceKernelEvent* ev)
 {
-	LOG_SCE_GRAPHIC("Not implemented");
-	return SCE_OK;
+	LOG_SCE_GRAPHIC("ev %p", ev);
+	return static_cast<int>(ev->ident);
 }
 
 
-int PS4API sceGnmDeleteEqEvent(void)
+int PS4API sceGnmDeleteEqEvent(SceKernelEqueue eq, Gnm::EqEventType id)
 {
-	LOG_SCE_GRAPHIC("Not implemented");
-	return SCE_OK;
+	LOG_SCE_GRAPHIC("eq %p id %d", eq, id);
+	int ret = SCE_KERNEL_ERROR_EINVAL;
+	do
+	{
+		auto source = GPU().gnmDriver().eqEvent(id);
+		if (!source)
+		{
+			break;
+		}
+
+		ret = source->RemoveQueue((CSceEventQueue*)eq, id, SCE_KERNEL_EVFILT_GRAPHICS_CORE);
+	} while (false);
+	return ret;
 }
@@ -53,7 +53,7 @@ int PS4API sceGnmCreateWorkloadStream(void);
 int PS4API sceGnmDebugHardwareStatus(void);
 
 
-int PS4API sceGnmDeleteEqEvent(void);
+int PS4API sceGnmDeleteEqEvent(SceKernelEqueue eq, Gnm::EqEventType id);
 
 
 int PS4API sceGnmDestroyWorkloadStream(void);
@@ -144,7 +144,7 @@ int PS4API sceGnmEndWorkload(void);
 int PS4API sceGnmFlushGarlic(void);
 
 
-int PS4API sceGnmGetEqEventType(void);
+int PS4API sceGnmGetEqEventType(const SceKernelEvent* ev);
 
 
 int PS4API sceGnmGetEqTimeStamp(void);
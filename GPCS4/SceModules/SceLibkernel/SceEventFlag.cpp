@@ -2,9 +2,8 @@
 #include "sce_errors.h"
 #include "sce_kernel_eventflag.h"
 #include "Platform/PlatThread.h"
-#include <functional>
 
-#include <functional>
+#include <chrono>
 
 LOG_CHANNEL(SceModules.SceLibkernel.SceEventFlag);
 
@@ -12,6 +11,9 @@ CSceEventFlag::CSceEventFlag(const std::string& name, uint32_t attr, uint64_t in
 	m_attr(attr),
 	m_name(name),
 	m_bitPattern(initPattern),
+	m_sequence(0),
+	m_waiterCount(0),
+	m_cancelCount(0),
 	m_anyWaiting(false)
 {
 
@@ -19,20 +21,16 @@ CSceEventFlag::CSceEventFlag(const std::string& name, uint32_t attr, uint64_t in
 
 CSceEventFlag::~CSceEventFlag()
 {
-	std::lock_guard lock(m_mutex);
 }
 
 int CSceEventFlag::Set(uint64_t bitPattern)
 {
-	std::lock_guard lock(m_mutex);
-	m_bitPattern |= bitPattern;
-	if (m_attr & SCE_KERNEL_EVF_ATTR_SINGLE)
+	// Pairs with the waiter count increment in Wait,
+	// either the waiter sees the new pattern, or we see the waiter.
+	m_bitPattern.fetch_or(bitPattern, std::memory_order_seq_cst);
+	if (m_waiterCount.load(std::memory_order_seq_cst) != 0)
 	{
-		m_cond.notify_one();
-	}
-	else
-	{
-		m_cond.notify_all();
+		WakeWaiters();
 	}
 	return SCE_OK;
 }
@@ -40,143 +38,194 @@ int CSceEventFlag::Set(uint64_t bitPattern)
 int CSceEventFlag::Wait(uint64_t bitPattern, uint32_t mode, uint64_t* pResultPat, SceKernelUseconds* pTimeout)
 {
 	int err = SCE_KERNEL_ERROR_ESRCH;
-	bool condMet = false;
-	std::unique_lock<std::mutex> lock(m_mutex);
-	do 
+	do
 	{
-		if (IsSingleMode())
-		{
-			if (m_anyWaiting)
-			{
-				err = SCE_KERNEL_ERROR_EPERM;
-				break;
-			}
-			else
-			{
-				m_anyWaiting = true;
-			}
-		}
-
-		if (IsConditionMet(mode, bitPattern))
+		if (!(mode & (SCE_KERNEL_EVF_WAITMODE_AND | SCE_KERNEL_EVF_WAITMODE_OR)))
 		{
-			err = SCE_OK;
-			condMet = true;
+			LOG_ERR("invalid mode %x", mode);
+			err = SCE_KERNEL_ERROR_EINVAL;
 			break;
 		}
 
-		std::function<bool (void)> pred;
-		if (mode & SCE_KERNEL_EVF_WAITMODE_AND)
-		{
-			pred = [this, bitPattern] { return (m_bitPattern & bitPattern) == bitPattern; };
-		}
-		else if (mode & SCE_KERNEL_EVF_WAITMODE_OR)
+		if (IsSingleMode() && m_anyWaiting.exchange(true, std::memory_order_acquire))
 		{
-			pred = [this, bitPattern] { return (m_bitPattern & bitPattern) != 0; };
-		}
-		else
-		{
-			LOG_ERR("invalid mode %x", mode);
+			err = SCE_KERNEL_ERROR_EPERM;
+			break;
 		}
 
-	
-		if (!pTimeout)
+		if (TryAcquire(bitPattern, mode, pResultPat))
 		{
-			m_cond.wait(lock, pred);
-			condMet = true;
+			err = SCE_OK;
 		}
 		else
 		{
-			auto timeMs = std::chrono::microseconds(*pTimeout);
-			auto start = std::chrono::high_resolution_clock::now();
+			using namespace std::chrono;
+			auto deadline = steady_clock::now() + microseconds(pTimeout ? *pTimeout : 0);
 
-			bool notExpired = m_cond.wait_for(lock, timeMs, pred);
+			uint32_t cancelCount = m_cancelCount.load(std::memory_order_acquire);
+			m_waiterCount.fetch_add(1, std::memory_order_seq_cst);
+			while (true)
+			{
+				// Read the sequence before checking the pattern,
+				// a Set in between changes it and the wait returns at once.
+				uint32_t sequence = m_sequence.load(std::memory_order_seq_cst);
+
+				if (m_cancelCount.load(std::memory_order_acquire) != cancelCount)
+				{
+					err = SCE_KERNEL_ERROR_ECANCELED;
+					break;
+				}
+
+				if (TryAcquire(bitPattern, mode, pResultPat))
+				{
+					err = SCE_OK;
+					break;
+				}
+
+				if (!pTimeout)
+				{
+					plat::FutexWait(&m_sequence, sequence, nullptr);
+					continue;
+				}
+
+				auto now = steady_clock::now();
+				if (now >= deadline)
+				{
+					err = SCE_KERNEL_ERROR_ETIMEDOUT;
+					break;
+				}
+
+				uint64_t timeLeft = duration_cast<microseconds>(deadline - now).count();
+				plat::FutexWait(&m_sequence, sequence, &timeLeft);
+			}
+			m_waiterCount.fetch_sub(1, std::memory_order_relaxed);
 
-			auto end = std::chrono::high_resolution_clock::now();
-			if (notExpired)
+			if (pTimeout)
 			{
-				auto dura = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-				auto timeLeft = timeMs - dura;
-				*pTimeout = timeLeft.count();
-				condMet = true;
+				auto timeLeft = duration_cast<microseconds>(deadline - steady_clock::now()).count();
+				*pTimeout     = timeLeft > 0 && err != SCE_KERNEL_ERROR_ETIMEDOUT
+									? static_cast<SceKernelUseconds>(timeLeft)
+									: 0;
 			}
-			else
+
+			if (err != SCE_OK && pResultPat)
 			{
-				*pTimeout = 0;
-				err = SCE_KERNEL_ERROR_ETIMEDOUT;
-				condMet = false;
-				break;
+				*pResultPat = m_bitPattern.load(std::memory_order_relaxed);
 			}
 		}
-		//LOG_DEBUG("thread awake %d", UtilThread::GetThreadId());
 
-		err = SCE_OK;
+		if (IsSingleMode())
+		{
+			m_anyWaiting.store(false, std::memory_order_release);
+		}
 	} while (false);
 
-	if (IsSingleMode() && (err != SCE_KERNEL_ERROR_EPERM))
-	{
-		m_anyWaiting = false;
-	}
+	return err;
+}
 
-	if (pResultPat)
+int CSceEventFlag::Poll(uint64_t bitPattern, uint32_t mode, uint64_t* pResultPat)
+{
+	int err = SCE_KERNEL_ERROR_EBUSY;
+	do
 	{
-		*pResultPat = m_bitPattern;
-	}
+		if (!(mode & (SCE_KERNEL_EVF_WAITMODE_AND | SCE_KERNEL_EVF_WAITMODE_OR)))
+		{
+			err = SCE_KERNEL_ERROR_EINVAL;
+			break;
+		}
 
-	if (condMet)
-	{
-		if (mode & SCE_KERNEL_EVF_WAITMODE_CLEAR_ALL)
+		if (IsSingleMode() && m_anyWaiting.load(std::memory_order_relaxed))
 		{
-			m_bitPattern = 0;
+			err = SCE_KERNEL_ERROR_EPERM;
+			break;
 		}
-		else if (mode & SCE_KERNEL_EVF_WAITMODE_CLEAR_PAT)
+
+		if (!TryAcquire(bitPattern, mode, pResultPat))
 		{
-			m_bitPattern &= ~bitPattern;
+			if (pResultPat)
+			{
+				*pResultPat = m_bitPattern.load(std::memory_order_relaxed);
+			}
+			break;
 		}
-	}
 
+		err = SCE_OK;
+	} while (false);
 	return err;
 }
 
-// TODO:
-// implement this
-int CSceEventFlag::Poll(uint64_t bitPattern, uint32_t mode, uint64_t* pResultPat)
-{
-	//throw std::logic_error("not implemented");
-	return SCE_KERNEL_ERROR_ESRCH;
-}
-
-// TODO:
-// implement this
 int CSceEventFlag::Clear(uint64_t bitPattern)
 {
-	throw std::logic_error("not implemented");
-	return SCE_KERNEL_ERROR_ESRCH;
+	// Bits are kept where the pattern is set,
+	// clearing never wakes anyone up.
+	m_bitPattern.fetch_and(bitPattern, std::memory_order_relaxed);
+	return SCE_OK;
 }
 
-// TODO:
-// implement this
 int CSceEventFlag::Cancel(uint64_t setPattern, int* pNumWaitThreads)
 {
-	throw std::logic_error("not implemented");
-	return SCE_KERNEL_ERROR_ESRCH;
+	if (pNumWaitThreads)
+	{
+		*pNumWaitThreads = static_cast<int>(m_waiterCount.load(std::memory_order_relaxed));
+	}
+
+	m_bitPattern.store(setPattern, std::memory_order_relaxed);
+	m_cancelCount.fetch_add(1, std::memory_order_seq_cst);
+	WakeWaiters();
+	return SCE_OK;
 }
 
-bool CSceEventFlag::IsConditionMet(uint32_t mode, uint64_t bitPattern)
+bool CSceEventFlag::TryAcquire(uint64_t bitPattern, uint32_t mode, uint64_t* pResultPat)
 {
-	bool bMet = false;
-	if (mode & SCE_KERNEL_EVF_WAITMODE_AND)
+	bool     met     = false;
+	uint64_t pattern = m_bitPattern.load(std::memory_order_acquire);
+	while (true)
 	{
-		bMet = ((m_bitPattern & bitPattern) == m_bitPattern);
+		met = (mode & SCE_KERNEL_EVF_WAITMODE_AND) ? (pattern & bitPattern) == bitPattern
+												   : (pattern & bitPattern) != 0;
+		if (!met)
+		{
+			break;
+		}
+
+		uint64_t newPattern = pattern;
+		if (mode & SCE_KERNEL_EVF_WAITMODE_CLEAR_ALL)
+		{
+			newPattern = 0;
+		}
+		else if (mode & SCE_KERNEL_EVF_WAITMODE_CLEAR_PAT)
+		{
+			newPattern &= ~bitPattern;
+		}
+
+		if (newPattern == pattern ||
+			m_bitPattern.compare_exchange_weak(pattern, newPattern, std::memory_order_acq_rel))
+		{
+			break;
+		}
 	}
-	else if (mode & SCE_KERNEL_EVF_WAITMODE_OR)
+
+	// The pattern before clearing is returned.
+	if (met && pResultPat)
+	{
+		*pResultPat = pattern;
+	}
+	return met;
+}
+
+void CSceEventFlag::WakeWaiters()
+{
+	m_sequence.fetch_add(1, std::memory_order_seq_cst);
+	if (IsSingleMode())
 	{
-		bMet = ((m_bitPattern & bitPattern) != 0);
+		plat::FutexWake(&m_sequence, 1);
 	}
 	else
 	{
-		LOG_ERR("invalid mode %x", mode);
+		// Waiters wait for different bits,
+		// each of them checks its own condition.
+		plat::FutexWakeAll(&m_sequence);
 	}
-	return bMet;
 }
 
 bool CSceEventFlag::IsSingleMode()
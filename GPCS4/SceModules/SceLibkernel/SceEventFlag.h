@@ -1,11 +1,18 @@
 #pragma once
 #include "GPCS4Common.h"
 #include <string>
-#include <mutex>
-#include <condition_variable>
+#include <atomic>
 #include "sce_kernel_types.h"
 
 
+// Event flag without a lock.
+//
+// Set, poll and the wait which finds its condition met
+// are a single atomic operation on the pattern.
+// Waiters sleep on a 32 bit sequence word, which is
+// bumped whenever the pattern changes while anyone is waiting,
+// since a futex can't compare the 64 bit pattern itself.
+
 class CSceEventFlag
 {
 public:
@@ -23,15 +30,22 @@ public:
 	int Cancel(uint64_t setPattern, int* pNumWaitThreads);
 
 private:
-	bool IsConditionMet(uint32_t mode, uint64_t bitPattern);
+	// Takes the pattern if the condition is met,
+	// clearing it as the mode says.
+	bool TryAcquire(uint64_t bitPattern, uint32_t mode, uint64_t* pResultPat);
+
+	void WakeWaiters();
+
 	bool IsSingleMode();
 
 private:
-	uint32_t m_attr;
-	std::string m_name;
-	uint64_t m_bitPattern;
-	std::mutex m_mutex;
-	std::condition_variable m_cond;
-	bool m_anyWaiting;
+	uint32_t              m_attr;
+	std::string           m_name;
+	std::atomic<uint64_t> m_bitPattern;
+	std::atomic<uint32_t> m_sequence;
+	std::atomic<uint32_t> m_waiterCount;
+	// Bumped by Cancel, waiters which see it change give up.
+	std::atomic<uint32_t> m_cancelCount;
+	std::atomic<bool>     m_anyWaiting;
 };
 
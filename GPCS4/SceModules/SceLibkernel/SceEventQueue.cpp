@@ -0,0 +1,413 @@
+#include "SceEventQueue.h"
+#include "sce_errors.h"
+
+#include <algorithm>
+
+LOG_CHANNEL(SceModules.SceLibkernel.SceEventQueue);
+
+CSceEventQueue::CSceEventQueue(const std::string& name) :
+	m_name(name)
+{
+
+}
+
+CSceEventQueue::~CSceEventQueue()
+{
+	// Sources trigger events with their own lock held,
+	// so detach from them without holding ours.
+	std::vector<CSceEventSource*> sources;
+	{
+		std::lock_guard lock(m_mutex);
+		for (auto& knote : m_knotes)
+		{
+			if (knote.source &&
+				std::find(sources.begin(), sources.end(), knote.source) == sources.end())
+			{
+				sources.push_back(knote.source);
+			}
+		}
+	}
+
+	for (auto source : sources)
+	{
+		source->DetachQueue(this);
+	}
+
+	// Wake up pending waiters and wait for them to leave,
+	// they must not touch the queue after we return.
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_closed = true;
+	m_cond.notify_all();
+	m_cond.wait(lock, [this] { return m_waiters == 0; });
+}
+
+int CSceEventQueue::AddEvent(uintptr_t ident, short filter, uint16_t flags, void* udata, CSceEventSource* source)
+{
+	std::lock_guard lock(m_mutex);
+
+	// Adding an existing event modifies it, like kevent.
+	SceKnote* knote = FindKnote(ident, filter);
+	if (!knote)
+	{
+		knote = &m_knotes.emplace_back();
+		*knote = {};
+	}
+
+	knote->event.ident  = ident;
+	knote->event.filter = filter;
+	knote->event.flags  = flags & ~(SCE_KERNEL_EV_ADD | SCE_KERNEL_EV_DELETE);
+	knote->event.fflags = 0;
+	knote->event.data   = 0;
+	knote->event.udata  = udata;
+	knote->triggered    = false;
+	knote->source       = source;
+
+	return SCE_OK;
+}
+
+int CSceEventQueue::AddTimer(uintptr_t ident, SceKernelUseconds period, void* udata)
+{
+	int err = SCE_KERNEL_ERROR_UNKNOWN;
+	do
+	{
+		if (period == 0)
+		{
+			err = SCE_KERNEL_ERROR_EINVAL;
+			break;
+		}
+
+		std::lock_guard lock(m_mutex);
+
+		SceKnote* knote = FindKnote(ident, SCE_KERNEL_EVFILT_TIMER);
+		if (!knote)
+		{
+			knote = &m_knotes.emplace_back();
+			*knote = {};
+		}
+
+		knote->event.ident  = ident;
+		knote->event.filter = SCE_KERNEL_EVFILT_TIMER;
+		knote->event.flags  = SCE_KERNEL_EV_CLEAR;
+		knote->event.fflags = 0;
+		knote->event.data   = 0;
+		knote->event.udata  = udata;
+		knote->triggered    = false;
+		knote->source       = nullptr;
+		knote->period       = std::chrono::microseconds(period);
+		knote->nextFire     = Clock::now() + knote->period;
+
+		// A waiter may need to wake up earlier now.
+		m_cond.notify_all();
+
+		err = SCE_OK;
+	} while (false);
+	return err;
+}
+
+int CSceEventQueue::DeleteEvent(uintptr_t ident, short filter)
+{
+	std::lock_guard lock(m_mutex);
+
+	auto iter = std::find_if(m_knotes.begin(), m_knotes.end(),
+		[ident, filter](const SceKnote& knote)
+		{
+			return knote.event.ident == ident && knote.event.filter == filter;
+		});
+
+	int err = SCE_KERNEL_ERROR_ENOENT;
+	if (iter != m_knotes.end())
+	{
+		m_knotes.erase(iter);
+		err = SCE_OK;
+	}
+	return err;
+}
+
+int CSceEventQueue::TriggerEvent(uintptr_t ident, short filter, intptr_t data)
+{
+	int err = SCE_KERNEL_ERROR_ENOENT;
+	do
+	{
+		std::lock_guard lock(m_mutex);
+
+		SceKnote* knote = FindKnote(ident, filter);
+		if (!knote)
+		{
+			break;
+		}
+
+		knote->event.data = data;
+		knote->triggered  = true;
+
+		m_cond.notify_all();
+
+		err = SCE_OK;
+	} while (false);
+	return err;
+}
+
+int CSceEventQueue::TriggerUserEvent(uintptr_t ident, void* udata)
+{
+	int err = SCE_KERNEL_ERROR_ENOENT;
+	do
+	{
+		std::lock_guard lock(m_mutex);
+
+		SceKnote* knote = FindKnote(ident, SCE_KERNEL_EVFILT_USER);
+		if (!knote)
+		{
+			break;
+		}
+
+		knote->event.udata = udata;
+		knote->triggered   = true;
+
+		m_cond.notify_all();
+
+		err = SCE_OK;
+	} while (false);
+	return err;
+}
+
+int CSceEventQueue::Wait(SceKernelEvent* ev, int num, int* out, SceKernelUseconds* pTimeout)
+{
+	int err = SCE_KERNEL_ERROR_UNKNOWN;
+	int count = 0;
+	std::unique_lock<std::mutex> lock(m_mutex);
+	++m_waiters;
+	do
+	{
+		if (!ev || num < 1)
+		{
+			err = SCE_KERNEL_ERROR_EINVAL;
+			break;
+		}
+
+		auto start = Clock::now();
+		auto now = start;
+		auto deadline = pTimeout ? start + std::chrono::microseconds(*pTimeout) : Clock::time_point::max();
+
+		while (true)
+		{
+			if (m_closed)
+			{
+				err = SCE_KERNEL_ERROR_EBADF;
+				break;
+			}
+
+			FireTimers(now);
+
+			count = CollectEvents(ev, num);
+			if (count != 0)
+			{
+				err = SCE_OK;
+				break;
+			}
+
+			if (now >= deadline)
+			{
+				err = SCE_KERNEL_ERROR_ETIMEDOUT;
+				break;
+			}
+
+			// Sleep until an event is triggered,
+			// the next timer expires or we time out.
+			auto wakeup = std::min(deadline, NextTimer());
+			if (wakeup == Clock::time_point::max())
+			{
+				m_cond.wait(lock);
+			}
+			else
+			{
+				m_cond.wait_until(lock, wakeup);
+			}
+
+			now = Clock::now();
+		}
+
+		if (pTimeout)
+		{
+			auto dura = std::chrono::duration_cast<std::chrono::microseconds>(now - start);
+			auto timeLeft = std::max<int64_t>(*pTimeout - dura.count(), 0);
+			*pTimeout = static_cast<SceKernelUseconds>(timeLeft);
+		}
+	} while (false);
+
+	if (out)
+	{
+		*out = count;
+	}
+
+	--m_waiters;
+	if (m_closed && m_waiters == 0)
+	{
+		m_cond.notify_all();
+	}
+
+	return err;
+}
+
+CSceEventQueue::SceKnote* CSceEventQueue::FindKnote(uintptr_t ident, short filter)
+{
+	SceKnote* result = nullptr;
+	for (auto& knote : m_knotes)
+	{
+		if (knote.event.ident == ident && knote.event.filter == filter)
+		{
+			result = &knote;
+			break;
+		}
+	}
+	return result;
+}
+
+void CSceEventQueue::FireTimers(Clock::time_point now)
+{
+	for (auto& knote : m_knotes)
+	{
+		if (knote.event.filter != SCE_KERNEL_EVFILT_TIMER || now < knote.nextFire)
+		{
+			continue;
+		}
+
+		// Data is the number of expirations
+		// since the event was last retrieved.
+		auto expirations = (now - knote.nextFire) / knote.period + 1;
+		knote.event.data += static_cast<intptr_t>(expirations);
+		knote.nextFire += knote.period * expirations;
+		knote.triggered = true;
+	}
+}
+
+CSceEventQueue::Clock::time_point CSceEventQueue::NextTimer()
+{
+	auto next = Clock::time_point::max();
+	for (auto& knote : m_knotes)
+	{
+		if (knote.event.filter == SCE_KERNEL_EVFILT_TIMER)
+		{
+			next = std::min(next, knote.nextFire);
+		}
+	}
+	return next;
+}
+
+int CSceEventQueue::CollectEvents(SceKernelEvent* ev, int num)
+{
+	int count = 0;
+	auto iter = m_knotes.begin();
+	while (iter != m_knotes.end() && count < num)
+	{
+		if (!iter->triggered)
+		{
+			++iter;
+			continue;
+		}
+
+		ev[count++] = iter->event;
+
+		if (iter->event.flags & SCE_KERNEL_EV_ONESHOT)
+		{
+			iter = m_knotes.erase(iter);
+			continue;
+		}
+
+		// Level triggered events stay triggered
+		// until they are deleted.
+		if (iter->event.flags & SCE_KERNEL_EV_CLEAR)
+		{
+			iter->triggered  = false;
+			iter->event.data = 0;
+		}
+		++iter;
+	}
+	return count;
+}
+
+
+CSceEventSource::CSceEventSource()
+{
+
+}
+
+CSceEventSource::~CSceEventSource()
+{
+	std::lock_guard lock(m_mutex);
+	for (auto& reg : m_registrations)
+	{
+		reg.eq->DeleteEvent(reg.ident, reg.filter);
+	}
+}
+
+int CSceEventSource::AddQueue(CSceEventQueue* eq, uintptr_t ident, short filter, void* udata)
+{
+	int err = SCE_KERNEL_ERROR_UNKNOWN;
+	do
+	{
+		if (!eq)
+		{
+			err = SCE_KERNEL_ERROR_EBADF;
+			break;
+		}
+
+		std::lock_guard lock(m_mutex);
+
+		// Device events are edge triggered.
+		err = eq->AddEvent(ident, filter, SCE_KERNEL_EV_CLEAR, udata, this);
+		if (err != SCE_OK)
+		{
+			break;
+		}
+
+		auto iter = std::find_if(m_registrations.begin(), m_registrations.end(),
+			[eq, ident, filter](const Registration& reg)
+			{
+				return reg.eq == eq && reg.ident == ident && reg.filter == filter;
+			});
+		if (iter == m_registrations.end())
+		{
+			m_registrations.push_back({ eq, ident, filter });
+		}
+	} while (false);
+	return err;
+}
+
+int CSceEventSource::RemoveQueue(CSceEventQueue* eq, uintptr_t ident, short filter)
+{
+	std::lock_guard lock(m_mutex);
+
+	auto iter = std::find_if(m_registrations.begin(), m_registrations.end(),
+		[eq, ident, filter](const Registration& reg)
+		{
+			return reg.eq == eq && reg.ident == ident && reg.filter == filter;
+		});
+
+	int err = SCE_KERNEL_ERROR_ENOENT;
+	if (iter != m_registrations.end())
+	{
+		m_registrations.erase(iter);
+		err = eq->DeleteEvent(ident, filter);
+	}
+	return err;
+}
+
+void CSceEventSource::DetachQueue(CSceEventQueue* eq)
+{
+	std::lock_guard lock(m_mutex);
+	m_registrations.erase(
+		std::remove_if(m_registrations.begin(), m_registrations.end(),
+			[eq](const Registration& reg) { return reg.eq == eq; }),
+		m_registrations.end());
+}
+
+void CSceEventSource::Trigger(uintptr_t ident, intptr_t data)
+{
+	std::lock_guard lock(m_mutex);
+	for (auto& reg : m_registrations)
+	{
+		if (reg.ident == ident)
+		{
+			reg.eq->TriggerEvent(reg.ident, reg.filter, data);
+		}
+	}
+}
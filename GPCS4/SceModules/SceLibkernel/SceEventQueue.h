@@ -0,0 +1,102 @@
+#pragma once
+#include "GPCS4Common.h"
+#include "sce_kernel_types.h"
+#include "sce_kernel_eventqueue.h"
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <condition_variable>
+
+class CSceEventSource;
+
+// A kqueue like event queue.
+// Events are registered by (ident, filter) pair,
+// waiters sleep on a condition variable until
+// one of the registered events is triggered,
+// a timer expires or the timeout is reached.
+// Deleting the queue fails pending waits with EBADF
+// and blocks until every waiter has left.
+
+class CSceEventQueue
+{
+public:
+	CSceEventQueue(const std::string& name);
+	~CSceEventQueue();
+
+	int AddEvent(uintptr_t ident, short filter, uint16_t flags, void* udata, CSceEventSource* source = nullptr);
+
+	// microseconds
+	int AddTimer(uintptr_t ident, SceKernelUseconds period, void* udata);
+
+	int DeleteEvent(uintptr_t ident, short filter);
+
+	int TriggerEvent(uintptr_t ident, short filter, intptr_t data);
+
+	int TriggerUserEvent(uintptr_t ident, void* udata);
+
+	// microseconds
+	int Wait(SceKernelEvent* ev, int num, int* out, SceKernelUseconds* pTimeout);
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct SceKnote
+	{
+		SceKernelEvent   event;
+		bool             triggered;
+		CSceEventSource* source;
+		// Timer only
+		Clock::duration   period;
+		Clock::time_point nextFire;
+	};
+
+	SceKnote* FindKnote(uintptr_t ident, short filter);
+
+	void FireTimers(Clock::time_point now);
+
+	Clock::time_point NextTimer();
+
+	int CollectEvents(SceKernelEvent* ev, int num);
+
+private:
+	std::string m_name;
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	std::vector<SceKnote> m_knotes;
+	// Threads inside Wait.
+	uint32_t m_waiters = 0;
+	bool m_closed = false;
+};
+
+
+// An object which triggers events, like a device,
+// the same event can be registered to several queues.
+
+class CSceEventSource
+{
+public:
+	CSceEventSource();
+	~CSceEventSource();
+
+	int AddQueue(CSceEventQueue* eq, uintptr_t ident, short filter, void* udata);
+
+	int RemoveQueue(CSceEventQueue* eq, uintptr_t ident, short filter);
+
+	// Called by a queue being deleted.
+	void DetachQueue(CSceEventQueue* eq);
+
+	void Trigger(uintptr_t ident, intptr_t data);
+
+private:
+	struct Registration
+	{
+		CSceEventQueue* eq;
+		uintptr_t       ident;
+		short           filter;
+	};
+
+	std::mutex m_mutex;
+	std::vector<Registration> m_registrations;
+};
+
@@ -1,34 +1,64 @@
 #include "SceSemaphore.h"
 #include "sce_errors.h"
+#include "Platform/PlatThread.h"
+
 #include <chrono>
 
 CSceSemaphore::CSceSemaphore(const std::string& name, int initCount, int maxCount, uint32_t mode):
 	m_name(name),
+	m_initCount(initCount),
+	m_maxCount(maxCount),
 	m_count(initCount),
-	m_maxCount(maxCount)
+	m_sequence(0),
+	m_waiterCount(0),
+	m_bulkWaiterCount(0),
+	m_cancelCount(0)
 {
 
 }
 
 CSceSemaphore::~CSceSemaphore()
 {
-	std::lock_guard lock(m_mutex);
 }
 
 int CSceSemaphore::Signal(int count)
 {
 	int err = SCE_KERNEL_ERROR_UNKNOWN;
-	std::lock_guard lock(m_mutex);
 	do 
 	{
-		if (m_count + count > m_maxCount)
+		if (count < 1)
+		{
+			err = SCE_KERNEL_ERROR_EINVAL;
+			break;
+		}
+
+		bool    overflow = false;
+		int32_t current  = m_count.load(std::memory_order_relaxed);
+		do
+		{
+			overflow = current + count > m_maxCount;
+		} while (!overflow &&
+				 !m_count.compare_exchange_weak(current, current + count, std::memory_order_seq_cst));
+
+		if (overflow)
 		{
 			err = SCE_KERNEL_ERROR_EINVAL;
 			break;
 		}
 
-		m_count += count;
-		m_cond.notify_one();
+		// Pairs with the waiter count increment in Wait.
+		if (m_waiterCount.load(std::memory_order_seq_cst) != 0)
+		{
+			m_sequence.fetch_add(1, std::memory_order_seq_cst);
+			if (m_bulkWaiterCount.load(std::memory_order_relaxed) != 0)
+			{
+				plat::FutexWakeAll(&m_sequence);
+			}
+			else
+			{
+				plat::FutexWake(&m_sequence, count);
+			}
+		}
 
 		err = SCE_OK;
 	} while (false);
@@ -38,16 +68,19 @@ int CSceSemaphore::Signal(int count)
 int CSceSemaphore::Poll(int count)
 {
 	int err = SCE_KERNEL_ERROR_UNKNOWN;
-	std::lock_guard lock(m_mutex);
 	do 
 	{
 		if (count < 1 || count > m_maxCount)
 		{
-			err = SCE_KERNEL_ERROR_EBUSY;
+			err = SCE_KERNEL_ERROR_EINVAL;
 			break;
 		}
 
-		m_count -= count;
+		if (!TryAcquire(count))
+		{
+			err = SCE_KERNEL_ERROR_EBUSY;
+			break;
+		}
 
 		err = SCE_OK;
 	} while (false);
@@ -57,7 +90,6 @@ int CSceSemaphore::Poll(int count)
 int CSceSemaphore::Wait(int count, uint32_t* pTimeOut)
 {
 	int err = SCE_KERNEL_ERROR_UNKNOWN;
-	std::unique_lock<std::mutex> lock(m_mutex);
 	do 
 	{
 		if (count < 1 || count > m_maxCount)
@@ -66,44 +98,106 @@ int CSceSemaphore::Wait(int count, uint32_t* pTimeOut)
 			break;
 		}
 
-		auto pred = [this, count] { return m_count >= count; };
-		if (!pTimeOut)  // infinite
+		if (TryAcquire(count))
 		{
-			m_cond.wait(lock, pred);
-			m_count -= count;
+			err = SCE_OK;
+			break;
 		}
-		else
+
+		using namespace std::chrono;
+		auto deadline = steady_clock::now() + microseconds(pTimeOut ? *pTimeOut : 0);
+
+		uint32_t cancelCount = m_cancelCount.load(std::memory_order_acquire);
+		if (count > 1)
 		{
-			auto timeMs = std::chrono::microseconds(*pTimeOut);
-			auto start = std::chrono::high_resolution_clock::now();
+			m_bulkWaiterCount.fetch_add(1, std::memory_order_relaxed);
+		}
+		m_waiterCount.fetch_add(1, std::memory_order_seq_cst);
+		while (true)
+		{
+			// Read the sequence before checking the count,
+			// a Signal in between changes it and the wait returns at once.
+			uint32_t sequence = m_sequence.load(std::memory_order_seq_cst);
+
+			if (m_cancelCount.load(std::memory_order_acquire) != cancelCount)
+			{
+				err = SCE_KERNEL_ERROR_ECANCELED;
+				break;
+			}
 
-			bool notExpired = m_cond.wait_for(lock, timeMs, pred);
+			if (TryAcquire(count))
+			{
+				err = SCE_OK;
+				break;
+			}
 
-			auto end = std::chrono::high_resolution_clock::now();
-			if (notExpired)
+			if (!pTimeOut)  // infinite
 			{
-				auto dura = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-				auto timeLeft = timeMs - dura;
-				*pTimeOut = timeLeft.count();
-				m_count -= count;
+				plat::FutexWait(&m_sequence, sequence, nullptr);
+				continue;
 			}
-			else
+
+			auto now = steady_clock::now();
+			if (now >= deadline)
 			{
-				*pTimeOut = 0;
 				err = SCE_KERNEL_ERROR_ETIMEDOUT;
 				break;
 			}
 
+			uint64_t timeLeft = duration_cast<microseconds>(deadline - now).count();
+			plat::FutexWait(&m_sequence, sequence, &timeLeft);
+		}
+		m_waiterCount.fetch_sub(1, std::memory_order_relaxed);
+		if (count > 1)
+		{
+			m_bulkWaiterCount.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		if (pTimeOut)
+		{
+			auto timeLeft = duration_cast<microseconds>(deadline - steady_clock::now()).count();
+			*pTimeOut     = timeLeft > 0 && err != SCE_KERNEL_ERROR_ETIMEDOUT
+								? static_cast<uint32_t>(timeLeft)
+								: 0;
+		}
+	} while (false);
+	return err;
+}
+
+int CSceSemaphore::Cancel(int setCount, int* pNumWaitThreads)
+{
+	int err = SCE_KERNEL_ERROR_UNKNOWN;
+	do
+	{
+		if (setCount > m_maxCount)
+		{
+			err = SCE_KERNEL_ERROR_EINVAL;
+			break;
+		}
+
+		if (pNumWaitThreads)
+		{
+			*pNumWaitThreads = static_cast<int>(m_waiterCount.load(std::memory_order_relaxed));
 		}
 
+		// A negative count restores the initial one.
+		m_count.store(setCount < 0 ? m_initCount : setCount, std::memory_order_relaxed);
+		m_cancelCount.fetch_add(1, std::memory_order_seq_cst);
+		m_sequence.fetch_add(1, std::memory_order_seq_cst);
+		plat::FutexWakeAll(&m_sequence);
+
 		err = SCE_OK;
 	} while (false);
 	return err;
 }
 
-// TODO:
-// implement Cancel
-int CSceSemaphore::Cancel(int setCount, uint32_t* pNumWaitThreads)
+bool CSceSemaphore::TryAcquire(int count)
 {
-	return SCE_KERNEL_ERROR_ESRCH;
+	bool    acquired = false;
+	int32_t current  = m_count.load(std::memory_order_relaxed);
+	while (!acquired && current >= count)
+	{
+		acquired = m_count.compare_exchange_weak(current, current - count, std::memory_order_acquire);
+	}
+	return acquired;
 }
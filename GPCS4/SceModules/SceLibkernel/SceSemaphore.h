@@ -1,12 +1,15 @@
 #pragma once
 #include "GPCS4Common.h"
 #include <string>
-#include <mutex>
-#include <condition_variable>
+#include <atomic>
 
 // TODO:
-// this is a very simple implementation
-// thread queue feature is not supported yet
+// thread queue feature is not supported yet,
+// waiters are not woken in FIFO or priority order.
+
+// Semaphore without a lock, works like CSceEventFlag.
+// Signal, poll and the wait which finds enough resources
+// are a single atomic operation on the count.
 
 class CSceSemaphore
 {
@@ -21,15 +24,21 @@ public:
 	// microseconds
 	int Wait(int count, uint32_t* pTimeOut);
 
-	int Cancel(int setCount, uint32_t* pNumWaitThreads);
+	int Cancel(int setCount, int* pNumWaitThreads);
 
+private:
+	bool TryAcquire(int count);
 
 private:
-	std::string m_name;
-	std::mutex m_mutex;
-	std::condition_variable m_cond;
-	int m_count;
-	int m_maxCount;
+	std::string           m_name;
+	int                   m_initCount;
+	int                   m_maxCount;
+	std::atomic<int32_t>  m_count;
+	std::atomic<uint32_t> m_sequence;
+	std::atomic<uint32_t> m_waiterCount;
+	// Waiters which need more than one resource,
+	// while there are any, every waiter is woken up on signal.
+	std::atomic<uint32_t> m_bulkWaiterCount;
+	std::atomic<uint32_t> m_cancelCount;
 };
 
-
@@ -0,0 +1,261 @@
+#include "SceSyncBench.h"
+#include "SceEventFlag.h"
+#include "SceSemaphore.h"
+#include "sce_errors.h"
+#include "sce_kernel_eventflag.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+LOG_CHANNEL(SceModules.SceLibkernel.SceSyncBench);
+
+// The mutex and condition variable event flag
+// CSceEventFlag used before, only what the bench needs.
+class LegacyEventFlag
+{
+public:
+	LegacyEventFlag(const std::string& name, uint32_t attr, uint64_t initPattern) :
+		m_bitPattern(initPattern)
+	{
+	}
+
+	int Set(uint64_t bitPattern)
+	{
+		std::lock_guard lock(m_mutex);
+		m_bitPattern |= bitPattern;
+		m_cond.notify_all();
+		return SCE_OK;
+	}
+
+	int Wait(uint64_t bitPattern, uint32_t mode, uint64_t* pResultPat, SceKernelUseconds* pTimeout)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		std::function<bool(void)> pred;
+		if (mode & SCE_KERNEL_EVF_WAITMODE_AND)
+		{
+			pred = [this, bitPattern] { return (m_bitPattern & bitPattern) == bitPattern; };
+		}
+		else
+		{
+			pred = [this, bitPattern] { return (m_bitPattern & bitPattern) != 0; };
+		}
+		m_cond.wait(lock, pred);
+
+		if (pResultPat)
+		{
+			*pResultPat = m_bitPattern;
+		}
+		if (mode & SCE_KERNEL_EVF_WAITMODE_CLEAR_ALL)
+		{
+			m_bitPattern = 0;
+		}
+		else if (mode & SCE_KERNEL_EVF_WAITMODE_CLEAR_PAT)
+		{
+			m_bitPattern &= ~bitPattern;
+		}
+		return SCE_OK;
+	}
+
+private:
+	uint64_t                m_bitPattern;
+	std::mutex              m_mutex;
+	std::condition_variable m_cond;
+};
+
+// Same for the semaphore.
+class LegacySemaphore
+{
+public:
+	LegacySemaphore(const std::string& name, int initCount, int maxCount, uint32_t mode) :
+		m_count(initCount),
+		m_maxCount(maxCount)
+	{
+	}
+
+	int Signal(int count)
+	{
+		std::lock_guard lock(m_mutex);
+		m_count += count;
+		m_cond.notify_one();
+		return SCE_OK;
+	}
+
+	int Wait(int count, uint32_t* pTimeOut)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_cond.wait(lock, [this, count] { return m_count >= count; });
+		m_count -= count;
+		return SCE_OK;
+	}
+
+private:
+	std::mutex              m_mutex;
+	std::condition_variable m_cond;
+	int                     m_count;
+	int                     m_maxCount;
+};
+
+
+CSceSyncBench::CSceSyncBench(const SceSyncBenchDesc& desc) :
+	m_desc(desc)
+{
+}
+
+CSceSyncBench::~CSceSyncBench()
+{
+}
+
+bool CSceSyncBench::Run()
+{
+	bool ret = false;
+	do
+	{
+		if (m_desc.iterationCount == 0 || m_desc.threadCount == 0)
+		{
+			std::printf("Nothing to run, iteration or thread count is 0.\n");
+			break;
+		}
+
+		// Ping-pong needs pairs.
+		uint32_t pairCount = std::max(m_desc.threadCount / 2, 1u);
+
+		std::printf("Iterations     : %u per thread, %u threads, %u host threads\n",
+					m_desc.iterationCount,
+					m_desc.threadCount,
+					std::thread::hardware_concurrency());
+
+		Report("Event flag set/wait, 1 thread",
+			   m_desc.iterationCount,
+			   RunEventFlagUncontended<LegacyEventFlag>(),
+			   RunEventFlagUncontended<CSceEventFlag>());
+
+		Report("Event flag ping-pong",
+			   uint64_t(m_desc.iterationCount) * pairCount * 2,
+			   RunEventFlagPingPong<LegacyEventFlag>(),
+			   RunEventFlagPingPong<CSceEventFlag>());
+
+		Report("Semaphore wait/signal",
+			   uint64_t(m_desc.iterationCount) * m_desc.threadCount,
+			   RunSemaphoreContended<LegacySemaphore>(),
+			   RunSemaphoreContended<CSceSemaphore>());
+
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+template <typename EventFlag>
+double CSceSyncBench::RunEventFlagUncontended()
+{
+	EventFlag flag("bench", SCE_KERNEL_EVF_ATTR_MULTI, 0);
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (uint32_t i = 0; i != m_desc.iterationCount; ++i)
+	{
+		uint64_t result = 0;
+		flag.Set(1);
+		flag.Wait(1, SCE_KERNEL_EVF_WAITMODE_AND | SCE_KERNEL_EVF_WAITMODE_CLEAR_PAT, &result, nullptr);
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	return std::chrono::duration<double>(end - start).count();
+}
+
+template <typename EventFlag>
+double CSceSyncBench::RunEventFlagPingPong()
+{
+	// All pairs share one flag, with two bits each,
+	// so every set wakes waiters of other pairs too.
+	uint32_t  pairCount = std::min(std::max(m_desc.threadCount / 2, 1u), 32u);
+	EventFlag flag("bench", SCE_KERNEL_EVF_ATTR_MULTI, 0);
+
+	auto pinger = [this, &flag](uint64_t ping, uint64_t pong)
+	{
+		for (uint32_t i = 0; i != m_desc.iterationCount; ++i)
+		{
+			flag.Set(ping);
+			flag.Wait(pong, SCE_KERNEL_EVF_WAITMODE_OR | SCE_KERNEL_EVF_WAITMODE_CLEAR_PAT, nullptr, nullptr);
+		}
+	};
+
+	auto ponger = [this, &flag](uint64_t ping, uint64_t pong)
+	{
+		for (uint32_t i = 0; i != m_desc.iterationCount; ++i)
+		{
+			flag.Wait(ping, SCE_KERNEL_EVF_WAITMODE_OR | SCE_KERNEL_EVF_WAITMODE_CLEAR_PAT, nullptr, nullptr);
+			flag.Set(pong);
+		}
+	};
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i != pairCount; ++i)
+	{
+		uint64_t ping = 1ull << (i * 2);
+		uint64_t pong = 1ull << (i * 2 + 1);
+		threads.emplace_back(pinger, ping, pong);
+		threads.emplace_back(ponger, ping, pong);
+	}
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+
+	return std::chrono::duration<double>(end - start).count();
+}
+
+template <typename Semaphore>
+double CSceSyncBench::RunSemaphoreContended()
+{
+	// Used as a lock shared by all threads,
+	// half of the threads can hold it at once.
+	int       slotCount = std::max<int>(m_desc.threadCount / 2, 1);
+	Semaphore semaphore("bench", slotCount, slotCount, 0);
+
+	auto worker = [this, &semaphore]()
+	{
+		for (uint32_t i = 0; i != m_desc.iterationCount; ++i)
+		{
+			semaphore.Wait(1, nullptr);
+			semaphore.Signal(1);
+		}
+	};
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i != m_desc.threadCount; ++i)
+	{
+		threads.emplace_back(worker);
+	}
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+
+	return std::chrono::duration<double>(end - start).count();
+}
+
+void CSceSyncBench::Report(const char* name, uint64_t operationCount, double baselineTime, double time)
+{
+	std::printf("%s\n", name);
+	std::printf("  Mutex/condvar: %.3f ms, %.1f ns per operation\n",
+				baselineTime * 1000.0,
+				baselineTime * 1000000000.0 / operationCount);
+	std::printf("  Futex        : %.3f ms, %.1f ns per operation\n",
+				time * 1000.0,
+				time * 1000000000.0 / operationCount);
+	std::printf("  Speedup      : %.2fx\n", baselineTime / time);
+}
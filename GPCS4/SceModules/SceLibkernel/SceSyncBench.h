@@ -0,0 +1,40 @@
+#pragma once
+#include "GPCS4Common.h"
+
+
+struct SceSyncBenchDesc
+{
+	// Operations each thread does per test.
+	uint32_t iterationCount;
+	// Threads contending for the same object.
+	uint32_t threadCount;
+};
+
+
+// Measures CSceEventFlag and CSceSemaphore under contention,
+// and the same workloads on the previous mutex and
+// condition variable implementation as a baseline.
+
+class CSceSyncBench
+{
+public:
+	CSceSyncBench(const SceSyncBenchDesc& desc);
+	~CSceSyncBench();
+
+	bool Run();
+
+private:
+	template <typename EventFlag>
+	double RunEventFlagUncontended();
+
+	template <typename EventFlag>
+	double RunEventFlagPingPong();
+
+	template <typename Semaphore>
+	double RunSemaphoreContended();
+
+	void Report(const char* name, uint64_t operationCount, double baselineTime, double time);
+
+private:
+	SceSyncBenchDesc m_desc;
+};
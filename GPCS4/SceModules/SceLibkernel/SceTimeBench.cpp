@@ -0,0 +1,372 @@
+#include "SceTimeBench.h"
+#include "sce_libkernel.h"
+#include "Emulator.h"
+#include "GuestClock.h"
+#include "Platform/PlatHardware.h"
+#include "Platform/PlatProcess.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <thread>
+
+LOG_CHANNEL(SceModules.SceLibkernel.SceTimeBench);
+
+struct SceTimeFunctions
+{
+	uint64_t(PS4API* readTsc)(void);
+	uint64_t(PS4API* getTscFrequency)(void);
+	uint64_t(PS4API* getProcessTime)(void);
+	uint64_t(PS4API* getProcessTimeCounter)(void);
+	int(PS4API* clockGettime)(sce_clockid_t clk_id, struct sce_timespec* tp);
+};
+
+namespace
+{
+	enum SceTimeTest
+	{
+		kReadTsc,
+		kGetTscFrequency,
+		kGetProcessTime,
+		kGetProcessTimeCounter,
+		kClockRealtime,
+		kClockMonotonic,
+		kTimeTestCount,
+	};
+
+	const char* const SceTimeTestNames[kTimeTestCount] = {
+		"sceKernelReadTsc",
+		"sceKernelGetTscFrequency",
+		"sceKernelGetProcessTime",
+		"sceKernelGetProcessTimeCounter",
+		"clock_gettime(CLOCK_REALTIME)",
+		"clock_gettime(CLOCK_MONOTONIC)",
+	};
+
+	// How far the guest clocks may be from the host's.
+	constexpr uint64_t ClockToleranceNs = 2000000;
+	// How far the tsc frequency may be from the one measured here.
+	constexpr double   FrequencyTolerance = 0.001;
+	constexpr uint32_t FrequencyCheckMs   = 100;
+
+	// Results are summed into this, so calls aren't optimized out.
+	volatile uint64_t g_benchSink = 0;
+
+	uint64_t steadyNow()
+	{
+		auto time = std::chrono::steady_clock::now().time_since_epoch();
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+	}
+
+	uint64_t utcNow()
+	{
+		auto time = std::chrono::system_clock::now().time_since_epoch();
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+	}
+
+	uint64_t toNs(const sce_timespec& tp)
+	{
+		return static_cast<uint64_t>(tp.tv_sec) * 1000000000 + tp.tv_nsec;
+	}
+
+	bool isNear(uint64_t a, uint64_t b, uint64_t tolerance)
+	{
+		return (a > b ? a - b : b - a) <= tolerance;
+	}
+
+	// The time functions before the guest clock. Windows read the
+	// performance counter, the steady clock stands in for it elsewhere.
+
+	uint64_t PS4API legacyReadTsc(void)
+	{
+#ifdef GPCS4_WINDOWS
+		return plat::GetProcessTimeCounter();
+#else
+		return steadyNow();
+#endif  // GPCS4_WINDOWS
+	}
+
+	uint64_t PS4API legacyGetTscFrequency(void)
+	{
+#ifdef GPCS4_WINDOWS
+		return plat::GetTscFrequency();
+#else
+		return 1000000000;
+#endif  // GPCS4_WINDOWS
+	}
+
+	// Was a stub returning a constant, one host clock read
+	// is the least it could have done.
+	uint64_t PS4API legacyGetProcessTime(void)
+	{
+		return steadyNow() / 1000;
+	}
+
+	// Every clock id was the UTC time.
+	int PS4API legacyClockGettime(sce_clockid_t clk_id, struct sce_timespec* tp)
+	{
+		struct timespec ts;
+		memset(tp, 0, sizeof(*tp));
+		timespec_get(&ts, TIME_UTC);
+		tp->tv_sec  = ts.tv_sec;
+		tp->tv_nsec = ts.tv_nsec;
+		return 0;
+	}
+
+	const SceTimeFunctions LegacyFunctions = {
+		legacyReadTsc,
+		legacyGetTscFrequency,
+		legacyGetProcessTime,
+		legacyReadTsc,
+		legacyClockGettime,
+	};
+
+	const SceTimeFunctions GuestFunctions = {
+		sceKernelReadTsc,
+		sceKernelGetTscFrequency,
+		sceKernelGetProcessTime,
+		sceKernelGetProcessTimeCounter,
+		scek_clock_gettime,
+	};
+
+}  // namespace
+
+CSceTimeBench::CSceTimeBench(const SceTimeBenchDesc& desc) :
+	m_desc(desc),
+	m_tscBased(false)
+{
+}
+
+CSceTimeBench::~CSceTimeBench()
+{
+}
+
+bool CSceTimeBench::Run()
+{
+	bool ret = false;
+	do
+	{
+		if (m_desc.callCount == 0)
+		{
+			std::printf("Nothing to run, call count is 0.\n");
+			break;
+		}
+
+		auto& clock = TheEmulator().clock();
+
+		double legacyTimes[kTimeTestCount] = {};
+		double hostTimes[kTimeTestCount]   = {};
+		double tscTimes[kTimeTestCount]    = {};
+
+		GuestClockDesc hostDesc;
+		hostDesc.source = GuestClockSource::Host;
+		clock.initialize(hostDesc);
+		if (!CheckClockIds())
+		{
+			break;
+		}
+		MeasureFunctions(LegacyFunctions, legacyTimes);
+		MeasureFunctions(GuestFunctions, hostTimes);
+
+		clock.initialize(GuestClockDesc());
+		m_tscBased = clock.isTscBased();
+		if (m_tscBased)
+		{
+			if (!CheckClockIds() || !CheckTscClocks())
+			{
+				break;
+			}
+			MeasureFunctions(GuestFunctions, tscTimes);
+		}
+
+		std::printf("Calls          : %u per test, tsc %s\n", m_desc.callCount,
+					m_tscBased ? "invariant" : "not invariant, it's not measured");
+		if (m_tscBased)
+		{
+			std::printf("Tsc frequency  : %.3f MHz\n", clock.tscFrequency() / 1000000.0);
+		}
+		for (uint32_t i = 0; i != kTimeTestCount; ++i)
+		{
+			Report(SceTimeTestNames[i], legacyTimes[i], hostTimes[i], tscTimes[i]);
+		}
+
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+bool CSceTimeBench::CheckClockIds()
+{
+	bool ret = false;
+	do
+	{
+		sce_timespec tp = {};
+
+		// Clocks which are read from the same host clock.
+		struct
+		{
+			sce_clockid_t id;
+			bool          utc;
+		} const timeClocks[] = {
+			{ SCE_KERNEL_CLOCK_REALTIME, true },
+			{ SCE_KERNEL_CLOCK_REALTIME_PRECISE, true },
+			{ SCE_KERNEL_CLOCK_REALTIME_FAST, true },
+			{ SCE_KERNEL_CLOCK_EXT_NETWORK, true },
+			{ SCE_KERNEL_CLOCK_MONOTONIC, false },
+			{ SCE_KERNEL_CLOCK_MONOTONIC_PRECISE, false },
+			{ SCE_KERNEL_CLOCK_MONOTONIC_FAST, false },
+			{ SCE_KERNEL_CLOCK_UPTIME, false },
+		};
+
+		bool passed = true;
+		for (const auto& clock : timeClocks)
+		{
+			passed &= sceKernelClockGettime(clock.id, &tp) == SCE_OK &&
+					  isNear(toNs(tp), clock.utc ? utcNow() : steadyNow(), ClockToleranceNs);
+		}
+		if (!passed)
+		{
+			std::printf("Clock ids don't read the right clocks.\n");
+			break;
+		}
+
+		uint64_t start = sceKernelGetProcessTime();
+		passed &= sceKernelClockGettime(SCE_KERNEL_CLOCK_SECOND, &tp) == SCE_OK &&
+				  tp.tv_nsec == 0 && isNear(toNs(tp), utcNow(), 1000000000);
+		passed &= sceKernelClockGettime(SCE_KERNEL_CLOCK_PROCTIME, &tp) == SCE_OK &&
+				  toNs(tp) / 1000 >= start && toNs(tp) / 1000 <= sceKernelGetProcessTime();
+
+		// The thread's cpu time is part of the process's.
+		sce_timespec processTp = {};
+		passed &= sceKernelClockGettime(SCE_KERNEL_CLOCK_THREAD_CPUTIME_ID, &tp) == SCE_OK &&
+				  sceKernelClockGettime(SCE_KERNEL_CLOCK_PROF, &processTp) == SCE_OK &&
+				  toNs(tp) <= toNs(processTp);
+		if (!passed)
+		{
+			std::printf("Second, process or cpu time clocks are wrong.\n");
+			break;
+		}
+
+		// Bad ids and pointers, the posix function sets errno instead.
+		errno = 0;
+		passed &= sceKernelClockGettime(3, &tp) == SCE_KERNEL_ERROR_EINVAL;
+		passed &= sceKernelClockGettime(SCE_KERNEL_CLOCK_MONOTONIC, nullptr) == SCE_KERNEL_ERROR_EFAULT;
+		passed &= scek_clock_gettime(20, &tp) == -1 && errno == EINVAL;
+		if (!passed)
+		{
+			std::printf("Bad clock ids aren't rejected.\n");
+			break;
+		}
+
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+bool CSceTimeBench::CheckTscClocks()
+{
+	bool ret = false;
+	do
+	{
+		auto& clock = TheEmulator().clock();
+
+		uint64_t startTsc  = sceKernelReadTsc();
+		uint64_t startTime = steadyNow();
+		std::this_thread::sleep_for(std::chrono::milliseconds(FrequencyCheckMs));
+		uint64_t endTsc  = sceKernelReadTsc();
+		uint64_t endTime = steadyNow();
+
+		double frequency = double(endTsc - startTsc) * 1000000000.0 / double(endTime - startTime);
+		double error     = frequency / sceKernelGetTscFrequency() - 1.0;
+		if (error > FrequencyTolerance || error < -FrequencyTolerance)
+		{
+			std::printf("Tsc frequency is %.0f Hz, measured %.0f Hz.\n",
+						double(sceKernelGetTscFrequency()), frequency);
+			break;
+		}
+
+		// Flip statuses convert steady clock times to the same tsc.
+		uint64_t toleranceTicks = ClockToleranceNs * clock.tscFrequency() / 1000000000;
+		if (!isNear(clock.toTsc(steadyNow()), sceKernelReadTsc(), toleranceTicks))
+		{
+			std::printf("Steady clock times don't convert to the tsc.\n");
+			break;
+		}
+
+		uint64_t lastTsc  = 0;
+		uint64_t lastTime = 0;
+		bool     passed   = true;
+		for (uint32_t i = 0; i != m_desc.callCount; ++i)
+		{
+			sce_timespec tp = {};
+			scek_clock_gettime(SCE_KERNEL_CLOCK_MONOTONIC, &tp);
+			uint64_t tsc  = sceKernelReadTsc();
+			uint64_t time = toNs(tp);
+			passed &= tsc >= lastTsc && time >= lastTime;
+			lastTsc  = tsc;
+			lastTime = time;
+		}
+		if (!passed)
+		{
+			std::printf("Monotonic clock went back.\n");
+			break;
+		}
+
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+template <typename Func>
+double CSceTimeBench::Measure(Func func)
+{
+	uint32_t repeatCount = std::max(m_desc.repeatCount, 1u);
+	double   bestTime    = 0.0;
+	for (uint32_t i = 0; i != repeatCount; ++i)
+	{
+		uint64_t sum   = 0;
+		auto     start = std::chrono::high_resolution_clock::now();
+		for (uint32_t j = 0; j != m_desc.callCount; ++j)
+		{
+			sum += func();
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+		g_benchSink += sum;
+
+		double time = std::chrono::duration<double, std::nano>(end - start).count() / m_desc.callCount;
+		bestTime    = i == 0 ? time : std::min(bestTime, time);
+	}
+	return bestTime;
+}
+
+void CSceTimeBench::MeasureFunctions(const SceTimeFunctions& functions, double* times)
+{
+	times[kReadTsc]               = Measure([&]() { return functions.readTsc(); });
+	times[kGetTscFrequency]       = Measure([&]() { return functions.getTscFrequency(); });
+	times[kGetProcessTime]        = Measure([&]() { return functions.getProcessTime(); });
+	times[kGetProcessTimeCounter] = Measure([&]() { return functions.getProcessTimeCounter(); });
+
+	auto clockGettime = [&](sce_clockid_t clk_id)
+	{
+		sce_timespec tp = {};
+		functions.clockGettime(clk_id, &tp);
+		return static_cast<uint64_t>(tp.tv_nsec);
+	};
+	times[kClockRealtime]  = Measure([&]() { return clockGettime(SCE_KERNEL_CLOCK_REALTIME); });
+	times[kClockMonotonic] = Measure([&]() { return clockGettime(SCE_KERNEL_CLOCK_MONOTONIC); });
+}
+
+void CSceTimeBench::Report(const char* name, double legacyTime, double hostTime, double tscTime)
+{
+	std::printf("%s\n", name);
+	std::printf("  Before       : %.1f ns per call\n", legacyTime);
+	std::printf("  Host clock   : %.1f ns per call\n", hostTime);
+	if (m_tscBased)
+	{
+		std::printf("  Tsc          : %.1f ns per call\n", tscTime);
+		std::printf("  Speedup      : %.2fx\n", legacyTime / tscTime);
+	}
+}
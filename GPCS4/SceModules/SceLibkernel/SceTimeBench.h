@@ -0,0 +1,46 @@
+#pragma once
+#include "GPCS4Common.h"
+
+struct SceTimeFunctions;
+
+struct SceTimeBenchDesc
+{
+	// Calls of each time function per test.
+	uint32_t callCount;
+	// Run each test N times and keep the fastest time.
+	uint32_t repeatCount;
+};
+
+
+// Calls the kernel time functions as they were before the
+// guest clock, then on the guest clock reading the host clock,
+// then on the calibrated tsc, and reports the cost of a call.
+//
+// Also checks that clock ids map to the right clocks, and that
+// the tsc based clocks agree with the host's.
+
+class CSceTimeBench
+{
+public:
+	CSceTimeBench(const SceTimeBenchDesc& desc);
+	~CSceTimeBench();
+
+	bool Run();
+
+private:
+	bool CheckClockIds();
+
+	bool CheckTscClocks();
+
+	template <typename Func>
+	double Measure(Func func);
+
+	// Nanoseconds per call of each function.
+	void MeasureFunctions(const SceTimeFunctions& functions, double* times);
+
+	void Report(const char* name, double legacyTime, double hostTime, double tscTime);
+
+private:
+	SceTimeBenchDesc m_desc;
+	bool             m_tscBased;
+};
@@ -57,6 +57,20 @@ int PS4API sceKernelWaitEventFlag(SceKernelEventFlag ef,
 
 int PS4API sceKernelPollEventFlag(SceKernelEventFlag ef, uint64_t bitPattern, uint32_t waitMode, uint64_t* pResultPat)
 {
-	LOG_SCE_DUMMY_IMPL();
+	//LOG_SCE_TRACE("ef %p bitpat %x mode %x", ef, bitPattern, waitMode);
 	return ((CSceEventFlag*)ef)->Poll(bitPattern, waitMode, pResultPat);
+}
+
+
+int PS4API sceKernelClearEventFlag(SceKernelEventFlag ef, uint64_t bitPattern)
+{
+	//LOG_SCE_TRACE("ef %p bitpat %x", ef, bitPattern);
+	return ((CSceEventFlag*)ef)->Clear(bitPattern);
+}
+
+
+int PS4API sceKernelCancelEventFlag(SceKernelEventFlag ef, uint64_t setPattern, int* pNumWaitThreads)
+{
+	LOG_SCE_TRACE("ef %p setpat %x", ef, setPattern);
+	return ((CSceEventFlag*)ef)->Cancel(setPattern, pNumWaitThreads);
 }
\ No newline at end of file
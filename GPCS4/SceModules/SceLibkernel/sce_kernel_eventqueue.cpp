@@ -1,33 +1,178 @@
 #include "sce_libkernel.h"
-#include "Platform/PlatTime.h"
+#include "SceEventQueue.h"
 
 LOG_CHANNEL(SceModules.SceLibkernel.eventqueue);
 
 int PS4API sceKernelCreateEqueue(SceKernelEqueue *eq, const char *name)
 {
 	LOG_SCE_GRAPHIC("eq %p, name %s", eq, name);
-	*eq = (void*)0xCAFEBABE;
-	LOG_DEBUG("name %s", name);
-	return SCE_OK;
+	int err = SCE_KERNEL_ERROR_UNKNOWN;
+	do
+	{
+		if (!eq || !name)
+		{
+			err = SCE_KERNEL_ERROR_EINVAL;
+			break;
+		}
+
+		if (strlen(name) >= 32)
+		{
+			err = SCE_KERNEL_ERROR_ENAMETOOLONG;
+			break;
+		}
+
+		*eq = (SceKernelEqueue)new CSceEventQueue(name);
+
+		err = SCE_OK;
+	} while (false);
+	return err;
 }
 
 
 int PS4API sceKernelDeleteEqueue(SceKernelEqueue eq)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_GRAPHIC("eq %p", eq);
+	int err = SCE_KERNEL_ERROR_UNKNOWN;
+	do
+	{
+		if (!eq)
+		{
+			err = SCE_KERNEL_ERROR_EBADF;
+			break;
+		}
+
+		delete (CSceEventQueue*)eq;
+
+		err = SCE_OK;
+	} while (false);
+	return err;
 }
 
 
-int PS4API sceKernelWaitEqueue(SceKernelEqueue eq, SceKernelEvent *ev, 
+int PS4API sceKernelWaitEqueue(SceKernelEqueue eq, SceKernelEvent *ev,
 	int num, int *out, SceKernelUseconds *timo)
 {
 	LOG_SCE_GRAPHIC("eq %p, num %d", eq, num);
-	if (out)
+	int err = SCE_KERNEL_ERROR_UNKNOWN;
+	do
+	{
+		if (!eq)
+		{
+			err = SCE_KERNEL_ERROR_EBADF;
+			break;
+		}
+
+		err = ((CSceEventQueue*)eq)->Wait(ev, num, out, timo);
+	} while (false);
+	return err;
+}
+
+
+int PS4API sceKernelAddUserEvent(SceKernelEqueue eq, int id)
+{
+	LOG_SCE_TRACE("eq %p id %d", eq, id);
+	int err = SCE_KERNEL_ERROR_EBADF;
+	if (eq)
+	{
+		err = ((CSceEventQueue*)eq)->AddEvent(id, SCE_KERNEL_EVFILT_USER, 0, nullptr);
+	}
+	return err;
+}
+
+
+int PS4API sceKernelAddUserEventEdge(SceKernelEqueue eq, int id)
+{
+	LOG_SCE_TRACE("eq %p id %d", eq, id);
+	int err = SCE_KERNEL_ERROR_EBADF;
+	if (eq)
+	{
+		err = ((CSceEventQueue*)eq)->AddEvent(id, SCE_KERNEL_EVFILT_USER, SCE_KERNEL_EV_CLEAR, nullptr);
+	}
+	return err;
+}
+
+
+int PS4API sceKernelTriggerUserEvent(SceKernelEqueue eq, int id, void *udata)
+{
+	LOG_SCE_TRACE("eq %p id %d udata %p", eq, id, udata);
+	int err = SCE_KERNEL_ERROR_UNKNOWN;
+	do
+	{
+		if (!eq)
+		{
+			err = SCE_KERNEL_ERROR_EBADF;
+			break;
+		}
+
+		// The user data is given at trigger time for user events.
+		auto queue = (CSceEventQueue*)eq;
+		err = queue->TriggerUserEvent(id, udata);
+	} while (false);
+	return err;
+}
+
+
+int PS4API sceKernelDeleteUserEvent(SceKernelEqueue eq, int id)
+{
+	LOG_SCE_TRACE("eq %p id %d", eq, id);
+	int err = SCE_KERNEL_ERROR_EBADF;
+	if (eq)
 	{
-		*out = 1;
+		err = ((CSceEventQueue*)eq)->DeleteEvent(id, SCE_KERNEL_EVFILT_USER);
 	}
+	return err;
+}
 
-	plat::MicroSleep(10);
-	return SCE_OK;
-}
\ No newline at end of file
+
+int PS4API sceKernelAddTimerEvent(SceKernelEqueue eq, int id, SceKernelUseconds usec, void *udata)
+{
+	LOG_SCE_TRACE("eq %p id %d usec %d udata %p", eq, id, usec, udata);
+	int err = SCE_KERNEL_ERROR_EBADF;
+	if (eq)
+	{
+		err = ((CSceEventQueue*)eq)->AddTimer(id, usec, udata);
+	}
+	return err;
+}
+
+
+int PS4API sceKernelDeleteTimerEvent(SceKernelEqueue eq, int id)
+{
+	LOG_SCE_TRACE("eq %p id %d", eq, id);
+	int err = SCE_KERNEL_ERROR_EBADF;
+	if (eq)
+	{
+		err = ((CSceEventQueue*)eq)->DeleteEvent(id, SCE_KERNEL_EVFILT_TIMER);
+	}
+	return err;
+}
+
+
+uintptr_t PS4API sceKernelGetEventId(const SceKernelEvent *ev)
+{
+	return ev->ident;
+}
+
+
+int PS4API sceKernelGetEventFilter(const SceKernelEvent *ev)
+{
+	return ev->filter;
+}
+
+
+intptr_t PS4API sceKernelGetEventData(const SceKernelEvent *ev)
+{
+	return ev->data;
+}
+
+
+unsigned int PS4API sceKernelGetEventFflags(const SceKernelEvent *ev)
+{
+	return ev->fflags;
+}
+
+
+void* PS4API sceKernelGetEventUserData(const SceKernelEvent *ev)
+{
+	return ev->udata;
+}
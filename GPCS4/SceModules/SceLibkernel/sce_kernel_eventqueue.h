@@ -1,7 +1,18 @@
 #pragma once
 
 
-struct sce_kevent 
+#define SCE_KERNEL_EVFILT_TIMER          (-7)
+#define SCE_KERNEL_EVFILT_USER           (-11)
+#define SCE_KERNEL_EVFILT_VIDEO_OUT      (-13)
+#define SCE_KERNEL_EVFILT_GRAPHICS_CORE  (-14)
+
+#define SCE_KERNEL_EV_ADD      0x0001
+#define SCE_KERNEL_EV_DELETE   0x0002
+#define SCE_KERNEL_EV_ONESHOT  0x0010
+#define SCE_KERNEL_EV_CLEAR    0x0020
+
+
+struct sce_kevent
 {
 	uintptr_t	ident;		/* identifier for this event */
 	short		filter;		/* filter for event */
@@ -13,4 +24,4 @@ struct sce_kevent
 
 
 typedef void* SceKernelEqueue;
-typedef struct sce_kevent SceKernelEvent;
\ No newline at end of file
+typedef struct sce_kevent SceKernelEvent;
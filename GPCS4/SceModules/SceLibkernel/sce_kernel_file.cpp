@@ -1,277 +1,385 @@
 #include "sce_libkernel.h"
 #include "sce_kernel_file.h"
 #include "MapSlot.h"
-#include "Platform/PlatPath.h"
-#include <io.h>
-#include <fcntl.h>
+#include "Emulator.h"
+#include "AsyncIoEngine.h"
+#include "VirtualFileSystem.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
 #include <cstdio>
+#include <cstring>
 
 LOG_CHANNEL(SceModules.SceLibkernel.file);
 
-// this will be more friendly on linux....
+bool isEqualVfsFile(const VfsFile& lhs, const VfsFile& rhs)
+{
+	return (lhs.handle == rhs.handle) && (lhs.type == rhs.type);
+}
 
-#ifdef GPCS4_WINDOWS
+bool isEmptyVfsFile(const VfsFile& item)
+{
+	return (item.type == VfsNodeType::Unknown);
+}
 
-#include "dirent/dirent.h"
+// guest fds index into this slot array,
+// each slot holds the host file, directory or device behind it
+MapSlot<VfsFile, isEmptyVfsFile, isEqualVfsFile> g_fdSlots(SCE_FD_MAX);
 
-enum FdType
+// ops of one aio submit id
+struct KernelAioRequest
 {
-	FD_TYPE_UNKNOWN,
-	FD_TYPE_FILE,
-	FD_TYPE_DIRECTORY
+	std::vector<AsyncIoOp*> ops;
 };
 
-struct FdItem
-{
-	uintptr_t fd;  // Maybe a file or a directory
-	FdType type;
-};
+MapSlot<KernelAioRequest*> g_aioSlots(SCE_KERNEL_AIO_REQUEST_MAX);
+// finding an empty slot and filling it are two steps
+std::mutex g_aioSlotMutex;
 
-bool isEqualFdItem(const FdItem& lhs, const FdItem& rhs)
+
+// Host errno values differ from the FreeBSD ones the
+// guest expects, e.g. 11 is EDEADLK there but EAGAIN
+// on Linux and the Windows CRT, so map them by name.
+inline int getSceError(int64_t hostError)
 {
-	return (lhs.fd == rhs.fd) && (lhs.type == rhs.type);
+	int ret = SCE_KERNEL_ERROR_EIO;
+	switch (-hostError)
+	{
+	case EPERM:
+		ret = SCE_KERNEL_ERROR_EPERM;
+		break;
+	case ENOENT:
+		ret = SCE_KERNEL_ERROR_ENOENT;
+		break;
+	case ESRCH:
+		ret = SCE_KERNEL_ERROR_ESRCH;
+		break;
+	case EINTR:
+		ret = SCE_KERNEL_ERROR_EINTR;
+		break;
+	case EIO:
+		ret = SCE_KERNEL_ERROR_EIO;
+		break;
+	case ENXIO:
+		ret = SCE_KERNEL_ERROR_ENXIO;
+		break;
+	case E2BIG:
+		ret = SCE_KERNEL_ERROR_E2BIG;
+		break;
+	case EBADF:
+		ret = SCE_KERNEL_ERROR_EBADF;
+		break;
+	case EAGAIN:
+		ret = SCE_KERNEL_ERROR_EAGAIN;
+		break;
+	case EDEADLK:
+		ret = SCE_KERNEL_ERROR_EDEADLK;
+		break;
+	case ENOMEM:
+		ret = SCE_KERNEL_ERROR_ENOMEM;
+		break;
+	case EACCES:
+		ret = SCE_KERNEL_ERROR_EACCES;
+		break;
+	case EFAULT:
+		ret = SCE_KERNEL_ERROR_EFAULT;
+		break;
+	case EBUSY:
+		ret = SCE_KERNEL_ERROR_EBUSY;
+		break;
+	case EEXIST:
+		ret = SCE_KERNEL_ERROR_EEXIST;
+		break;
+	case EXDEV:
+		ret = SCE_KERNEL_ERROR_EXDEV;
+		break;
+	case ENODEV:
+		ret = SCE_KERNEL_ERROR_ENODEV;
+		break;
+	case ENOTDIR:
+		ret = SCE_KERNEL_ERROR_ENOTDIR;
+		break;
+	case EISDIR:
+		ret = SCE_KERNEL_ERROR_EISDIR;
+		break;
+	case EINVAL:
+		ret = SCE_KERNEL_ERROR_EINVAL;
+		break;
+	case ENFILE:
+		ret = SCE_KERNEL_ERROR_ENFILE;
+		break;
+	case EMFILE:
+		ret = SCE_KERNEL_ERROR_EMFILE;
+		break;
+	case ENOTTY:
+		ret = SCE_KERNEL_ERROR_ENOTTY;
+		break;
+	case EFBIG:
+		ret = SCE_KERNEL_ERROR_EFBIG;
+		break;
+	case ENOSPC:
+		ret = SCE_KERNEL_ERROR_ENOSPC;
+		break;
+	case ESPIPE:
+		ret = SCE_KERNEL_ERROR_ESPIPE;
+		break;
+	case EROFS:
+		ret = SCE_KERNEL_ERROR_EROFS;
+		break;
+	case EMLINK:
+		ret = SCE_KERNEL_ERROR_EMLINK;
+		break;
+	case EPIPE:
+		ret = SCE_KERNEL_ERROR_EPIPE;
+		break;
+	case ERANGE:
+		ret = SCE_KERNEL_ERROR_ERANGE;
+		break;
+	case ELOOP:
+		ret = SCE_KERNEL_ERROR_ELOOP;
+		break;
+	case ENAMETOOLONG:
+		ret = SCE_KERNEL_ERROR_ENAMETOOLONG;
+		break;
+	case ENOTEMPTY:
+		ret = SCE_KERNEL_ERROR_ENOTEMPTY;
+		break;
+	case ENOSYS:
+		ret = SCE_KERNEL_ERROR_ENOSYS;
+		break;
+	case ETIMEDOUT:
+		ret = SCE_KERNEL_ERROR_ETIMEDOUT;
+		break;
+	case EOVERFLOW:
+		ret = SCE_KERNEL_ERROR_EOVERFLOW;
+		break;
+	case ECANCELED:
+		ret = SCE_KERNEL_ERROR_ECANCELED;
+		break;
+	}
+	return ret;
 }
 
-bool isEmptyFdItem(const FdItem& item)
+inline VfsFile* getFile(int d)
 {
-	return (item.fd == 0 && item.type == FD_TYPE_UNKNOWN);
+	VfsFile* file = nullptr;
+	if (d > 0 && d < SCE_FD_MAX && !isEmptyVfsFile(g_fdSlots[d]))
+	{
+		file = &g_fdSlots[d];
+	}
+	return file;
 }
 
-// since windows doesn't allow open(directory),
-// we record both DIR* and fd in this slot array
-MapSlot<FdItem, isEmptyFdItem, isEqualFdItem> g_fdSlots(SCE_FD_MAX);
-
-
-inline bool getDirName(DIR* dir, char* dirname, int len)
+inline uint32_t getVfsOpenFlags(int flags)
 {
-	bool bRet = false;
-	do
+	uint32_t vfsFlags = 0;
+	switch (flags & O_ACCMODE)
 	{
-		wchar_t* wfname = dir->wdirp->patt;
-		if (!wfname)
-		{
-			break;
-		}
+	case SCE_KERNEL_O_WRONLY:
+		vfsFlags = VfsOpenWrite;
+		break;
+	case SCE_KERNEL_O_RDWR:
+		vfsFlags = VfsOpenRead | VfsOpenWrite;
+		break;
+	default:
+		vfsFlags = VfsOpenRead;
+		break;
+	}
 
-		if (wcstombs(dirname, wfname, len) == (size_t)-1)
-		{
-			break;
-		}
-		
-		int str_len = strlen(dirname);
-		dirname[str_len - 2] = 0;
-		dirname[str_len - 1] = 0;
-		
-		bRet  = true;
-	}while(false);
-	return bRet;
+	vfsFlags |= (flags & SCE_KERNEL_O_CREAT) ? VfsOpenCreate : 0;
+	vfsFlags |= (flags & SCE_KERNEL_O_TRUNC) ? VfsOpenTruncate : 0;
+	vfsFlags |= (flags & SCE_KERNEL_O_APPEND) ? VfsOpenAppend : 0;
+	vfsFlags |= (flags & SCE_KERNEL_O_EXCL) ? VfsOpenExclusive : 0;
+	vfsFlags |= (flags & SCE_KERNEL_O_DIRECTORY) ? VfsOpenDirectory : 0;
+	return vfsFlags;
 }
 
-#endif  //GPCS4_WINDOWS
+inline void getSceStat(const VfsStat& stat, SceKernelStat* sb)
+{
+	memset(sb, 0, sizeof(SceKernelStat));
+	sb->st_mode = stat.writable ? SCE_KERNEL_S_IRWU : SCE_KERNEL_S_IRU;
+	sb->st_ino  = static_cast<sce_ino_t>(stat.inode);
+	sb->st_size = stat.size;
+
+	switch (stat.type)
+	{
+	case VfsNodeType::Directory:
+		// games size their getdents buffer from this
+		sb->st_mode |= SCE_KERNEL_S_IFDIR;
+		sb->st_blocks  = stat.entryCount;
+		sb->st_blksize = sizeof(SceKernelDirent);
+		break;
+	case VfsNodeType::Device:
+		sb->st_mode |= SCE_S_IFCHR;
+		break;
+	default:
+		sb->st_mode |= SCE_KERNEL_S_IFREG;
+		sb->st_blocks  = stat.size / SSD_BLOCK_SIZE + ((stat.size % SSD_BLOCK_SIZE) ? 1 : 0);
+		sb->st_blksize = SSD_BLOCK_SIZE;
+		break;
+	}
+}
 
 
 int PS4API scek__write(int fd, const void* buf, size_t size)
 {
 	LOG_SCE_TRACE("fd %d buf 0x%p size %zu", fd, buf, size);
 
+	int ret = 0;
 	do 
 	{
-		_write(fd, buf, size);
-
 		if (fd != 1 && fd != 2)
 		{
+			ret = sceKernelWrite(fd, buf, size);
 			break;
 		}
 
+		fwrite(buf, 1, size, fd == 1 ? stdout : stderr);
+
 		// If it's stdout/stderr, also log it to emulator logger
 		// TODO: Strip newline, log line already adds one
 		std::string tempBuf(static_cast<const char*>(buf), 0, size);
 		tempBuf.append("\0"); // buf is not guaranteed to be null-terminated, so append null terminator after 'size' chars
 		LOG_TRACE("%s", tempBuf.c_str());
 		
+		ret = size;
 	} while (false);
 
-	return size;
+	return ret;
 }
 
 
 int PS4API sceKernelOpen(const char *path, int flags, SceKernelMode mode)
 {
 	LOG_SCE_TRACE("path %s flag %x mode %x", path, flags, mode);
-	std::string pcPath = plat::PS4PathToPCPath(path);
-
-#ifdef GPCS4_WINDOWS
-	int idx = g_fdSlots.GetEmptySlotIndex();
-	bool hasError = false;
-	if (flags & SCE_KERNEL_O_DIRECTORY)
-	{
-		DIR* dir = opendir(pcPath.c_str());
-		if (!dir)
-		{
-			LOG_WARN("open dir failed %s", path);
-			hasError = true;
-		}
-		g_fdSlots[idx].fd = (uintptr_t)dir;
-		g_fdSlots[idx].type = FD_TYPE_DIRECTORY;
 
-	}
-	else
+	int ret = SCE_KERNEL_ERROR_EMFILE;
+	do
 	{
-		LOG_ASSERT((flags == SCE_KERNEL_O_RDONLY || flags & SCE_KERNEL_O_TRUNC), "not supported flag.");
-		LOG_ASSERT((mode == SCE_KERNEL_S_IRU) || ((mode == SCE_KERNEL_S_INONE) && ((flags & SCE_KERNEL_O_CREAT) == 0)) || ((mode == SCE_KERNEL_S_IRWU) && ((flags & SCE_KERNEL_O_TRUNC))), "not supported mode.");
-
-		int oflag;
-		int pmode;
-		
-		if (flags & SCE_KERNEL_O_TRUNC) 
-		{
-			oflag = _O_CREAT | _O_TRUNC | _O_BINARY;
-			pmode = _S_IREAD | _S_IWRITE;
-		}
-		else 
+		int idx = g_fdSlots.GetEmptySlotIndex();
+		if (idx == 0)
 		{
-			oflag = _O_RDONLY | _O_BINARY;
-			pmode = _S_IREAD;
+			LOG_WARN("no free fd for %s", path);
+			break;
 		}
 
-		int fd = _open(pcPath.c_str(), oflag, pmode);
-		if (fd == -1)
+		VfsFile file;
+		int     err = TheEmulator().vfs().open(path, getVfsOpenFlags(flags), &file);
+		if (err < 0)
 		{
-			LOG_WARN("open file failed %s", path);
-			hasError = true;
-			g_fdSlots[idx].fd = 0;
-			g_fdSlots[idx].type = FD_TYPE_UNKNOWN;
-		}
-		else
-		{
-			g_fdSlots[idx].fd = fd;
-			g_fdSlots[idx].type = FD_TYPE_FILE;
+			LOG_WARN("open %s failed %d", path, err);
+			ret = getSceError(err);
+			break;
 		}
-	}
 
-	int ret_fd = hasError ? -1 : idx;
-	return ret_fd;
-#endif  //GPCS4_WINDOWS
+		g_fdSlots[idx] = file;
+		ret            = idx;
+	} while (false);
+	return ret;
 }
 
 
 ssize_t PS4API sceKernelRead(int d, void *buf, size_t nbytes)
 {
 	LOG_SCE_TRACE("d %d buff %p nbytes %x", d, buf, nbytes);
-	int fd = g_fdSlots[d].fd;
-	return _read(fd, buf, nbytes);
+
+	ssize_t ret = SCE_KERNEL_ERROR_EBADF;
+	do
+	{
+		VfsFile* file = getFile(d);
+		if (!file)
+		{
+			break;
+		}
+
+		int64_t count = TheEmulator().vfs().read(*file, buf, nbytes);
+		ret           = count < 0 ? getSceError(count) : count;
+	} while (false);
+	return ret;
 }
 
 
 ssize_t PS4API sceKernelWrite(int d, const void *buf, size_t nbytes)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
-}
+	LOG_SCE_TRACE("d %d buff %p nbytes %x", d, buf, nbytes);
 
+	ssize_t ret = SCE_KERNEL_ERROR_EBADF;
+	do
+	{
+		VfsFile* file = getFile(d);
+		if (!file)
+		{
+			break;
+		}
 
-sce_off_t PS4API sceKernelLseek(int fildes, sce_off_t offset, int whence)
-{
-	LOG_SCE_TRACE("fd %d off %d where %d", fildes, offset, whence);
-	int fd = g_fdSlots[fildes].fd;
-	return _lseeki64(fd, offset, whence);
+		int64_t count = TheEmulator().vfs().write(*file, buf, nbytes);
+		ret           = count < 0 ? getSceError(count) : count;
+	} while (false);
+	return ret;
 }
 
 
-int PS4API sceKernelClose(int d)
+sce_off_t PS4API sceKernelLseek(int fildes, sce_off_t offset, int whence)
 {
-	LOG_SCE_TRACE("fd %d", d);
+	LOG_SCE_TRACE("fd %d off %d where %d", fildes, offset, whence);
 
-#ifdef GPCS4_WINDOWS
-	int ret = -1;
-	FdItem& item = g_fdSlots[d];
-	if (item.type == FD_TYPE_DIRECTORY)
-	{
-		DIR* dir = (DIR*)item.fd;
-		closedir(dir);
-	}
-	else
+	sce_off_t ret = SCE_KERNEL_ERROR_EBADF;
+	do
 	{
-		int fd = item.fd;
-		_close(fd);
-	}
+		VfsFile* file = getFile(fildes);
+		if (!file)
+		{
+			break;
+		}
 
-	g_fdSlots[d] = {0, FD_TYPE_UNKNOWN};
+		int64_t position = TheEmulator().vfs().seek(*file, offset, whence);
+		ret              = position < 0 ? getSceError(position) : position;
+	} while (false);
 	return ret;
-#endif  //GPCS4_WINDOWS
 }
 
 
-inline sce_mode_t getSceFileMode(uint16_t oldMode)
+int PS4API sceKernelClose(int d)
 {
-	sce_mode_t sceMode = 0;
-	if (oldMode & _S_IREAD)
-	{
-		sceMode = SCE_KERNEL_S_IRU;
-	}
+	LOG_SCE_TRACE("fd %d", d);
 
-	if (oldMode & _S_IWRITE)
+	int ret = SCE_KERNEL_ERROR_EBADF;
+	do
 	{
-		sceMode = SCE_KERNEL_S_IRWU;
-	}
+		VfsFile* file = getFile(d);
+		if (!file)
+		{
+			break;
+		}
 
-	if (oldMode & _S_IFMT & _S_IFREG)
-	{
-		sceMode |= SCE_KERNEL_S_IFREG;
-	}
-	else if (oldMode & _S_IFMT & _S_IFDIR)
-	{
-		sceMode |= SCE_KERNEL_S_IFDIR;
-	}
-	return sceMode;
+		TheEmulator().aio().forgetFile(*file);
+		int err = TheEmulator().vfs().close(*file);
+		ret     = err < 0 ? getSceError(err) : SCE_OK;
+	} while (false);
+	return ret;
 }
 
 
 int PS4API scek_fstat(int fd, SceKernelStat *sb)
 {
 	LOG_SCE_TRACE("fd %d sb %p", fd, sb);
-
-	struct stat stat;
-	int ret = fstat(fd, &stat);
-	sb->st_mode = getSceFileMode(stat.st_mode);
-	sb->st_size = stat.st_size;
-	if (stat.st_mode & _S_IFMT & _S_IFDIR)
-	{
-		// TODO
-		sb->st_blocks = 0; // UtilPath::FileCountInDirectory(pcPath);
-		sb->st_blksize = sizeof(SceKernelDirent);
-	}
-	else
-	{
-		sb->st_blocks = stat.st_size / SSD_BLOCK_SIZE + (stat.st_size % SSD_BLOCK_SIZE) ? 1 : 0;
-		sb->st_blksize = SSD_BLOCK_SIZE;
-	}
-	return ret;
+	return sceKernelFstat(fd, sb);
 }
 
 
 int PS4API sceKernelStat(const char *path, SceKernelStat *sb)
 {
 	LOG_SCE_TRACE("path %s sb %p", path, sb);
-	std::string pcPath = plat::PS4PathToPCPath(path);
-
-	struct _stat stat;
-	int ret = _stat(pcPath.c_str(), &stat);
-	sb->st_mode = getSceFileMode(stat.st_mode);
-	//sb->st_atim = stat.st_atime;
-	//sb->st_mtim = stat.st_mtime;
-	//sb->st_ctim = stat.st_ctime;
-	sb->st_size = stat.st_size;
-	//sb->st_birthtim = stat.st_ctime; //?
-	if (stat.st_mode & _S_IFMT & _S_IFDIR)
+
+	VfsStat stat = {};
+	int     ret  = TheEmulator().vfs().stat(path, &stat);
+	if (ret < 0)
 	{
-		sb->st_blocks = plat::FileCountInDirectory(pcPath);
-		sb->st_blksize = sizeof(SceKernelDirent);
+		ret = getSceError(ret);
 	}
 	else
 	{
-		sb->st_blocks = stat.st_size / SSD_BLOCK_SIZE + (stat.st_size % SSD_BLOCK_SIZE) ? 1 : 0;
-		sb->st_blksize = SSD_BLOCK_SIZE;
+		getSceStat(stat, sb);
 	}
 	return ret;
 }
@@ -281,43 +389,26 @@ int PS4API sceKernelFstat(int fd, SceKernelStat *sb)
 {
 	LOG_SCE_TRACE("fd %d sb %p", fd, sb);
 
-#ifdef GPCS4_WINDOWS
-	int ret = -1;
-	FdItem& item = g_fdSlots[fd];
-	if (item.type == FD_TYPE_DIRECTORY)
-	{
-		char dir_path[SCE_MAX_PATH] = { 0 };
-		getDirName((DIR*)item.fd, dir_path, SCE_MAX_PATH);
-		struct _stat stat;
-		ret = _stat(dir_path, &stat);
-		sb->st_mode = getSceFileMode(stat.st_mode);
-		
-		//sb->st_atim = stat.st_atime;
-		//sb->st_mtim = stat.st_mtime;
-		//sb->st_ctim = stat.st_ctime;
-		sb->st_size = stat.st_size;
-		//sb->st_birthtim = stat.st_ctime; //?
-		sb->st_blocks = plat::FileCountInDirectory(dir_path);
-		sb->st_blksize = sizeof(SceKernelDirent);
-	}
-	else
+	int ret = SCE_KERNEL_ERROR_EBADF;
+	do
 	{
-		int pcFd = item.fd;
-		struct _stat stat;
-		ret = _fstat(pcFd, &stat);
-		sb->st_mode = getSceFileMode(stat.st_mode);
-
-		//sb->st_atim = stat.st_atime;
-		//sb->st_mtim = stat.st_mtime;
-		//sb->st_ctim = stat.st_ctime;
-		sb->st_size = stat.st_size;
-		//sb->st_birthtim = stat.st_ctime; //?
-		sb->st_blocks = stat.st_size / SSD_BLOCK_SIZE + (stat.st_size % SSD_BLOCK_SIZE) ? 1 : 0;
-		sb->st_blksize = SSD_BLOCK_SIZE;
-	}
+		VfsFile* file = getFile(fd);
+		if (!file)
+		{
+			break;
+		}
 
+		VfsStat stat = {};
+		ret          = TheEmulator().vfs().fstat(*file, &stat);
+		if (ret < 0)
+		{
+			ret = getSceError(ret);
+			break;
+		}
+
+		getSceStat(stat, sb);
+	} while (false);
 	return ret;
-#endif  //GPCS4_WINDOWS
 }
 
 
@@ -334,69 +425,60 @@ int PS4API sceKernelFtruncate(void)
 	return SCE_OK;
 }
 
-inline uint8_t getSceFileType(dirent* ent)
-{
-	uint8_t type = SCE_KERNEL_DT_UNKNOWN;
-	if ( (ent->d_namlen == 1 && !strncmp(ent->d_name, ".", 1)) ||
-		 (ent->d_namlen == 2 && !strncmp(ent->d_name, ".", 2)) )
-	{
-		type = SCE_KERNEL_DT_DIR;
-	}
-	else
-	{
-		switch (ent->d_type)
-		{
-		case DT_DIR:
-			type = SCE_KERNEL_DT_DIR;
-			break;
-		case DT_REG:
-			type = SCE_KERNEL_DT_REG;
-			break;
-		default:
-			LOG_ERR("found unknown file type. file %s type %x", ent->d_name, ent->d_type);
-			break;
-		}
-	}
-
-	return type;
-}
-
 int PS4API sceKernelGetdents(int fd, char *buf, int nbytes)
 {
 	LOG_SCE_TRACE("fd %d buff %p nbytes %x", fd, buf, nbytes);
-#ifdef GPCS4_WINDOWS
+
 	int ret = SCE_KERNEL_ERROR_EBADF;
 	do 
 	{
-		FdItem& item = g_fdSlots[fd];
-		if (item.type != FD_TYPE_DIRECTORY)
+		VfsFile* file = getFile(fd);
+		if (!file)
+		{
+			break;
+		}
+
+		if (file->type != VfsNodeType::Directory || nbytes < static_cast<int>(sizeof(SceKernelDirent)))
 		{
 			ret = SCE_KERNEL_ERROR_EINVAL;
 			break;
 		}
 
-		DIR* dir = (DIR*)item.fd;
-		dirent *ent;
-		ent = readdir(dir);
-		if (!ent)
+		VfsDirEntry entry;
+		int         err = TheEmulator().vfs().readDirectory(*file, &entry);
+		if (err <= 0)
 		{
-			ret = 0;  //ends
+			ret = err < 0 ? getSceError(err) : 0;  //ends
 			break;
 		}
 
+		uint8_t type = SCE_KERNEL_DT_UNKNOWN;
+		if (entry.type == VfsNodeType::Directory)
+		{
+			type = SCE_KERNEL_DT_DIR;
+		}
+		else if (entry.type == VfsNodeType::File)
+		{
+			type = SCE_KERNEL_DT_REG;
+		}
+		else
+		{
+			LOG_ERR("found unknown file type. file %s", entry.name);
+		}
+
 		SceKernelDirent* sce_ent = (SceKernelDirent*)buf;
-		sce_ent->d_fileno = ent->d_ino;
-		sce_ent->d_reclen = sizeof(SceKernelDirent);
-		sce_ent->d_type = getSceFileType(ent);
-		sce_ent->d_namlen = ent->d_namlen;
-		strcpy_s(sce_ent->d_name, SCE_MAX_PATH, ent->d_name);
+		size_t           namlen  = std::min(strlen(entry.name), size_t(SCE_MAX_PATH));
+		sce_ent->d_fileno        = static_cast<uint32_t>(entry.inode);
+		sce_ent->d_reclen        = sizeof(SceKernelDirent);
+		sce_ent->d_type          = type;
+		sce_ent->d_namlen        = static_cast<uint8_t>(namlen);
+		memcpy(sce_ent->d_name, entry.name, namlen);
+		sce_ent->d_name[namlen] = 0;
 		
 		ret = sizeof(SceKernelDirent);
 	} while (false);
 
 	return ret;
-
-#endif  //GPCS4_WINDOWS
 }
 
 
@@ -414,32 +496,36 @@ int PS4API sceKernelChmod(void)
 }
 
 
-int PS4API sceKernelMkdir(void)
+int PS4API sceKernelMkdir(const char *path, SceKernelMode mode)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("path %s mode %o", path, mode);
+	// The host decides the mode of new directories.
+	int err = TheEmulator().vfs().mkdir(path);
+	return err < 0 ? getSceError(err) : SCE_OK;
 }
 
 
-int PS4API sceKernelRename(void)
+int PS4API sceKernelRename(const char *from, const char *to)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("from %s to %s", from, to);
+	int err = TheEmulator().vfs().rename(from, to);
+	return err < 0 ? getSceError(err) : SCE_OK;
 }
 
 
-int PS4API sceKernelUnlink(void)
+int PS4API sceKernelUnlink(const char *path)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("path %s", path);
+	int err = TheEmulator().vfs().unlink(path);
+	return err < 0 ? getSceError(err) : SCE_OK;
 }
 
 
 int PS4API scek__open(const char* path, int flags, SceKernelMode mode)
 {
 	LOG_SCE_TRACE("'%s', 0x%x, 0x%x", path, flags, mode);
-	int fd = _open(path, flags, mode);
-	return fd;
+	// guest open flags are the FreeBSD ones, same as sceKernelOpen
+	return sceKernelOpen(path, flags, mode);
 }
 
 int PS4API scek_shm_open(const char *name, int oflag, SceKernelMode mode)
@@ -456,13 +542,336 @@ int PS4API scek_shm_unlink(const char *name)
 }
 
 
-ssize_t PS4API sceKernelPread(int d, void* buf, size_t nbytes, off_t offset) 
+ssize_t PS4API sceKernelPread(int d, void* buf, size_t nbytes, sce_off_t offset) 
+{
+	LOG_SCE_TRACE("fd %d, buf %p, nbytes %lu, offset %d", d, buf, nbytes, offset);
+
+	ssize_t ret = SCE_KERNEL_ERROR_EBADF;
+	do
+	{
+		VfsFile* file = getFile(d);
+		if (!file)
+		{
+			break;
+		}
+
+		if (offset < 0)
+		{
+			ret = SCE_KERNEL_ERROR_EINVAL;
+			break;
+		}
+
+		// The read/write position pointer for the file will not move
+		int64_t count = TheEmulator().vfs().pread(*file, buf, nbytes, offset);
+		ret           = count < 0 ? getSceError(count) : count;
+	} while (false);
+	return ret;
+}
+
+
+ssize_t PS4API sceKernelPwrite(int d, const void* buf, size_t nbytes, sce_off_t offset)
 {
 	LOG_SCE_TRACE("fd %d, buf %p, nbytes %lu, offset %d", d, buf, nbytes, offset);
-	// The read/write position pointer for the file will not move
-	auto off = _lseek(d, 0, SEEK_CUR);
-	_lseek(d, offset, SEEK_SET);
-	auto ret = _read(d, buf, nbytes);
-	_lseek(d, off, SEEK_SET);
+
+	ssize_t ret = SCE_KERNEL_ERROR_EBADF;
+	do
+	{
+		VfsFile* file = getFile(d);
+		if (!file)
+		{
+			break;
+		}
+
+		if (offset < 0)
+		{
+			ret = SCE_KERNEL_ERROR_EINVAL;
+			break;
+		}
+
+		int64_t count = TheEmulator().vfs().pwrite(*file, buf, nbytes, offset);
+		ret           = count < 0 ? getSceError(count) : count;
+	} while (false);
+	return ret;
+}
+
+
+inline KernelAioRequest* getAioRequest(SceKernelAioSubmitId id)
+{
+	KernelAioRequest* request = nullptr;
+	if (id > 0 && id < SCE_KERNEL_AIO_REQUEST_MAX)
+	{
+		request = g_aioSlots[id];
+	}
+	return request;
+}
+
+static AsyncIoOp* submitAioCommand(const SceKernelAioRWRequest& req, AsyncIoType type, int prio)
+{
+	SceKernelAioResult* result = req.result;
+	if (result)
+	{
+		result->state = SCE_KERNEL_AIO_STATE_SUBMITTED;
+	}
+
+	AsyncIoRequest request;
+	request.type     = type;
+	request.buffer   = req.buf;
+	request.size     = req.nbyte;
+	request.offset   = req.offset;
+	request.priority = prio - SCE_KERNEL_AIO_PRIORITY_MID;
+	request.callback = [result](AsyncIoOp& op)
+	{
+		if (!result)
+		{
+			return;
+		}
+
+		int32_t error = op.error.load();
+		if (error == -ECANCELED)
+		{
+			result->returnValue = SCE_KERNEL_ERROR_ECANCELED;
+			result->state       = SCE_KERNEL_AIO_STATE_ABORTED;
+		}
+		else
+		{
+			result->returnValue = error != 0 ? getSceError(error) : op.transferred.load();
+			result->state       = SCE_KERNEL_AIO_STATE_COMPLETED;
+		}
+	};
+
+	VfsFile* file = getFile(req.fd);
+	if (file)
+	{
+		request.file = *file;
+	}
+	else
+	{
+		// completes right away with EBADF
+		request.file.type = VfsNodeType::File;
+	}
+	return TheEmulator().aio().submit(request);
+}
+
+// one submit id for all commands, or one for each
+static int submitAioCommands(SceKernelAioRWRequest req[], int size, int prio,
+							 SceKernelAioSubmitId* id, AsyncIoType type, bool isMultiple)
+{
+	int ret = SCE_KERNEL_ERROR_EINVAL;
+	do
+	{
+		if (!req || !id || size <= 0)
+		{
+			break;
+		}
+
+		int requestCount = isMultiple ? size : 1;
+		int commandCount = isMultiple ? 1 : size;
+
+		std::vector<uint32_t> indices;
+		{
+			std::lock_guard<std::mutex> lock(g_aioSlotMutex);
+			for (int i = 0; i != requestCount; ++i)
+			{
+				uint32_t index = g_aioSlots.GetEmptySlotIndex();
+				if (index == 0)
+				{
+					break;
+				}
+
+				g_aioSlots[index] = new KernelAioRequest();
+				indices.push_back(index);
+			}
+
+			if (indices.size() != static_cast<size_t>(requestCount))
+			{
+				for (auto index : indices)
+				{
+					delete g_aioSlots[index];
+					g_aioSlots[index] = nullptr;
+				}
+				ret = SCE_KERNEL_ERROR_EAGAIN;
+				break;
+			}
+		}
+
+		for (int i = 0; i != requestCount; ++i)
+		{
+			KernelAioRequest* request = g_aioSlots[indices[i]];
+			for (int j = 0; j != commandCount; ++j)
+			{
+				request->ops.push_back(submitAioCommand(req[i * commandCount + j], type, prio));
+			}
+			id[i] = indices[i];
+		}
+
+		ret = SCE_OK;
+	} while (false);
 	return ret;
 }
+
+
+int PS4API sceKernelAioSubmitReadCommands(SceKernelAioRWRequest req[], int size, int prio, SceKernelAioSubmitId* id)
+{
+	LOG_SCE_TRACE("req %p size %d prio %d", req, size, prio);
+	return submitAioCommands(req, size, prio, id, AsyncIoType::Read, false);
+}
+
+
+int PS4API sceKernelAioSubmitReadCommandsMultiple(SceKernelAioRWRequest req[], int size, int prio, SceKernelAioSubmitId id[])
+{
+	LOG_SCE_TRACE("req %p size %d prio %d", req, size, prio);
+	return submitAioCommands(req, size, prio, id, AsyncIoType::Read, true);
+}
+
+
+int PS4API sceKernelAioSubmitWriteCommands(SceKernelAioRWRequest req[], int size, int prio, SceKernelAioSubmitId* id)
+{
+	LOG_SCE_TRACE("req %p size %d prio %d", req, size, prio);
+	return submitAioCommands(req, size, prio, id, AsyncIoType::Write, false);
+}
+
+
+int PS4API sceKernelAioSubmitWriteCommandsMultiple(SceKernelAioRWRequest req[], int size, int prio, SceKernelAioSubmitId id[])
+{
+	LOG_SCE_TRACE("req %p size %d prio %d", req, size, prio);
+	return submitAioCommands(req, size, prio, id, AsyncIoType::Write, true);
+}
+
+
+int PS4API sceKernelAioWaitRequest(SceKernelAioSubmitId id, int* state, SceKernelUseconds* usec)
+{
+	LOG_SCE_TRACE("id %d", id);
+
+	int ret = SCE_KERNEL_ERROR_ESRCH;
+	do
+	{
+		KernelAioRequest* request = getAioRequest(id);
+		if (!request)
+		{
+			break;
+		}
+
+		using namespace std::chrono;
+		auto& aio      = TheEmulator().aio();
+		auto  deadline = steady_clock::now() + microseconds(usec ? *usec : 0);
+
+		bool isDone = true;
+		for (auto op : request->ops)
+		{
+			if (!usec)
+			{
+				aio.wait(op);
+				continue;
+			}
+
+			auto     now      = steady_clock::now();
+			uint64_t timeLeft = now < deadline ? duration_cast<microseconds>(deadline - now).count() : 0;
+			if (!aio.wait(op, &timeLeft))
+			{
+				isDone = false;
+				break;
+			}
+		}
+
+		if (state)
+		{
+			*state = isDone ? SCE_KERNEL_AIO_STATE_COMPLETED : SCE_KERNEL_AIO_STATE_PROCESSING;
+		}
+		ret = isDone ? SCE_OK : SCE_KERNEL_ERROR_ETIMEDOUT;
+	} while (false);
+	return ret;
+}
+
+
+int PS4API sceKernelAioPollRequest(SceKernelAioSubmitId id, int* state)
+{
+	LOG_SCE_TRACE("id %d", id);
+
+	int ret = SCE_KERNEL_ERROR_ESRCH;
+	do
+	{
+		KernelAioRequest* request = getAioRequest(id);
+		if (!request)
+		{
+			break;
+		}
+
+		auto& aio    = TheEmulator().aio();
+		bool  isDone = std::all_of(request->ops.begin(), request->ops.end(),
+								   [&aio](const AsyncIoOp* op) { return aio.isDone(op); });
+		if (state)
+		{
+			*state = isDone ? SCE_KERNEL_AIO_STATE_COMPLETED : SCE_KERNEL_AIO_STATE_PROCESSING;
+		}
+		ret = SCE_OK;
+	} while (false);
+	return ret;
+}
+
+
+int PS4API sceKernelAioCancelRequest(SceKernelAioSubmitId id, int* state)
+{
+	LOG_SCE_TRACE("id %d", id);
+
+	int ret = SCE_KERNEL_ERROR_ESRCH;
+	do
+	{
+		KernelAioRequest* request = getAioRequest(id);
+		if (!request)
+		{
+			break;
+		}
+
+		auto& aio         = TheEmulator().aio();
+		bool  isCancelled = false;
+		for (auto op : request->ops)
+		{
+			aio.cancel(op);
+			// commands already running finish normally
+			aio.wait(op);
+			isCancelled |= op->error.load() == -ECANCELED;
+		}
+
+		if (state)
+		{
+			*state = isCancelled ? SCE_KERNEL_AIO_STATE_ABORTED : SCE_KERNEL_AIO_STATE_COMPLETED;
+		}
+		ret = SCE_OK;
+	} while (false);
+	return ret;
+}
+
+
+int PS4API sceKernelAioDeleteRequest(SceKernelAioSubmitId id, int* ret)
+{
+	LOG_SCE_TRACE("id %d", id);
+
+	int err = SCE_KERNEL_ERROR_ESRCH;
+	do
+	{
+		KernelAioRequest* request = getAioRequest(id);
+		if (!request)
+		{
+			break;
+		}
+
+		g_aioSlots[id] = nullptr;
+
+		// the guest may free the buffers once this returns
+		auto& aio = TheEmulator().aio();
+		for (auto op : request->ops)
+		{
+			aio.cancel(op);
+			aio.wait(op);
+			aio.release(op);
+		}
+		delete request;
+
+		if (ret)
+		{
+			*ret = SCE_OK;
+		}
+		err = SCE_OK;
+	} while (false);
+	return err;
+}
@@ -146,3 +146,34 @@ struct sce_dirent
 };
 
 typedef struct sce_dirent SceKernelDirent;
+
+
+// asynchronous io
+
+#define SCE_KERNEL_AIO_REQUEST_MAX 0x80
+
+#define SCE_KERNEL_AIO_STATE_SUBMITTED  1
+#define SCE_KERNEL_AIO_STATE_PROCESSING 2
+#define SCE_KERNEL_AIO_STATE_COMPLETED  3
+#define SCE_KERNEL_AIO_STATE_ABORTED    4
+
+#define SCE_KERNEL_AIO_PRIORITY_LOW  1
+#define SCE_KERNEL_AIO_PRIORITY_MID  2
+#define SCE_KERNEL_AIO_PRIORITY_HIGH 3
+
+typedef int32_t SceKernelAioSubmitId;
+
+struct SceKernelAioResult
+{
+	int64_t  returnValue;
+	uint32_t state;
+};
+
+struct SceKernelAioRWRequest
+{
+	sce_off_t           offset;
+	size_t              nbyte;
+	void*               buf;
+	SceKernelAioResult* result;
+	int                 fd;
+};
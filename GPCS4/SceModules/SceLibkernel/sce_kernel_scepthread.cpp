@@ -5,6 +5,8 @@
 
 #include "Platform.h"
 #include "Emulator/TLSHandler.h"
+#include "Emulator/ThreadAffinity.h"
+#include "Emulator.h"
 
 #include <utility>
 
@@ -308,6 +310,7 @@ int PS4API scePthreadAttrInit(ScePthreadAttr *attr)
 	LOG_SCE_TRACE("attr %p", attr);
 	sce_pthread_attr_t* object = (sce_pthread_attr_t*)calloc(1, sizeof(sce_pthread_attr_t));
 	int                 err    = pthread_attr_init(&object->handle);
+	object->affinity           = SCE_KERNEL_CPUMASK_USER_ALL;
 	*attr                      = object;
 	return pthreadErrorToSceError(err);
 }
@@ -330,10 +333,23 @@ int PS4API scePthreadAttrGetschedparam(void)
 
 
 
-int PS4API scePthreadAttrSetaffinity(void)
+int PS4API scePthreadAttrSetaffinity(ScePthreadAttr *attr, const SceKernelCpumask mask)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("attr %p mask %llx", attr, mask);
+	int ret = SCE_KERNEL_ERROR_EINVAL;
+	do
+	{
+		if (!attr || !*attr)
+		{
+			break;
+		}
+
+		// Applied by the new thread itself when it starts.
+		(*attr)->affinity = mask;
+
+		ret = SCE_OK;
+	} while (false);
+	return ret;
 }
 
 inline int sceDetachStateToPthreadState(int oldState)
@@ -456,22 +472,22 @@ ScePthread PS4API scePthreadSelf(void)
 
 int PS4API scePthreadSetaffinity(ScePthread thread, const SceKernelCpumask mask)
 {
-	//LOG_SCE_TRACE("mask %x", mask);
-	//cpu_set_t cpuset;
-	//// TODO:
-	//// should limit cpu count according to running machine
-	//for (int i = 0; i != SCE_KERNEL_CPU_MAX; ++i)
-	//{
-	//	if (util::isBitSet(mask, i))
-	//	{
-	//		CPU_SET(i, &cpuset);
-	//	}
-	//}
-	//
-	//int err = pthread_setaffinity_np(g_threadSlot[thread], sizeof(cpu_set_t), &cpuset);
-	//return pthreadErrorToSceError(err);
-	LOG_SCE_DUMMY_IMPL();
-	return SCE_OK;
+	LOG_SCE_TRACE("thread %d mask %llx", thread, mask);
+
+	// Guest mask bits are mapped onto host cores,
+	// see ThreadAffinityMapper.
+	void* handle = nullptr;
+	if (!pthread_equal(thread, pthread_self()))
+	{
+#ifdef GPCS4_WINDOWS
+		handle = pthread_gethandle(thread);
+#else
+		handle = reinterpret_cast<void*>(thread);
+#endif  // GPCS4_WINDOWS
+	}
+
+	bool bound = TheEmulator().affinity().bindGuestThread(thread, handle, mask);
+	return bound ? SCE_OK : SCE_KERNEL_ERROR_ESRCH;
 }
 
 
@@ -547,6 +563,9 @@ int PS4API scePthreadCreate(ScePthread *thread, const ScePthreadAttr *attr, void
 	param->entry = (void*)entry;
 	param->arg = arg;
 
+	param->affinity = (*attr)->affinity;
+	param->name     = name ? name : "";
+
 	int err = pthread_create(thread, &((*attr)->handle), newThreadWrapper, param);
 	if (!err)
 	{
@@ -567,10 +586,22 @@ void PS4API scePthreadExit(void *value_ptr)
 }
 
 
-int PS4API scePthreadGetaffinity(void)
+int PS4API scePthreadGetaffinity(ScePthread thread, SceKernelCpumask* mask)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("thread %d mask %p", thread, mask);
+	int ret = SCE_KERNEL_ERROR_EINVAL;
+	do
+	{
+		if (!mask)
+		{
+			break;
+		}
+
+		*mask = TheEmulator().affinity().getGuestMask(thread);
+
+		ret = SCE_OK;
+	} while (false);
+	return ret;
 }
 
 thread_local static int t_thread_prio = 0;
@@ -608,6 +639,7 @@ int PS4API scePthreadRename(void)
 void PS4API scePthreadYield(void)
 {
 	LOG_SCE_TRACE("");
+	TheEmulator().affinity().sampleCurrentCpu(scePthreadSelf());
 	plat::ThreadYield();
 }
 
@@ -16,6 +16,8 @@ struct sce_pthread_attr_t
 {
 	uint32_t       dummy[256];
 	pthread_attr_t handle;
+	// SceKernelCpumask
+	uint64_t       affinity;
 };
 
 struct sce_pthread_barrier_t
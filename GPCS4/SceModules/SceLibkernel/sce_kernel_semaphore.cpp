@@ -44,3 +44,16 @@ int PS4API sceKernelWaitSema(SceKernelSema sem, int need, SceKernelUseconds *tim
 	return ((CSceSemaphore*)sem)->Wait(need, timo);
 }
 
+
+int PS4API sceKernelPollSema(SceKernelSema sem, int need)
+{
+	LOG_SCE_TRACE("sem %p need %d", sem, need);
+	return ((CSceSemaphore*)sem)->Poll(need);
+}
+
+
+int PS4API sceKernelCancelSema(SceKernelSema sem, int setCount, int* pNumWaitThreads)
+{
+	LOG_SCE_TRACE("sem %p count %d", sem, setCount);
+	return ((CSceSemaphore*)sem)->Cancel(setCount, pNumWaitThreads);
+}
@@ -1,19 +1,21 @@
 #include "sce_libkernel.h"
+#include "Emulator.h"
+#include "GuestClock.h"
 #include "Platform.h"
-#include <ctime>
+#include <cerrno>
 
 LOG_CHANNEL(SceModules.SceLibkernel.time);
 
 uint64_t PS4API sceKernelGetProcessTime(void)
 {
-	LOG_SCE_DUMMY_IMPL();
-	return 0x123456;
+	// Microseconds.
+	return TheEmulator().clock().now(GuestClockType::Process) / 1000;
 }
 
 
 uint64_t PS4API sceKernelGetProcessTimeCounter(void)
 {
-	uint64_t nCount = plat::GetProcessTimeCounter();
+	uint64_t nCount = TheEmulator().clock().processTicks();
 	//LOG_SCE_TRACE("process time counter %lld", nCount);
 	return nCount;
 }
@@ -21,7 +23,7 @@ uint64_t PS4API sceKernelGetProcessTimeCounter(void)
 
 uint64_t PS4API sceKernelGetProcessTimeCounterFrequency(void)
 {
-	uint64_t nFreq = plat::GetProcessTimeFrequency();
+	uint64_t nFreq = TheEmulator().clock().tscFrequency();
 	LOG_SCE_TRACE("process time frequency %lld", nFreq);
 	return nFreq;
 }
@@ -29,7 +31,7 @@ uint64_t PS4API sceKernelGetProcessTimeCounterFrequency(void)
 
 uint64_t PS4API sceKernelGetTscFrequency(void)
 {
-	uint64_t nFreq = plat::GetTscFrequency();
+	uint64_t nFreq = TheEmulator().clock().tscFrequency();
 	LOG_SCE_TRACE("freq %llx", nFreq);
 	return nFreq;
 }
@@ -37,12 +39,78 @@ uint64_t PS4API sceKernelGetTscFrequency(void)
 
 uint64_t PS4API sceKernelReadTsc(void)
 {
-	uint64_t nCount = plat::GetProcessTimeCounter();
+	uint64_t nCount = TheEmulator().clock().readTsc();
 	//LOG_SCE_TRACE("tsc %lld", nCount);
 	return nCount;
 }
 
 
+// The precise and fast variants only differ in cost on FreeBSD,
+// network clocks are the host's UTC time.
+static int getClockTime(sce_clockid_t clk_id, struct sce_timespec* tp)
+{
+	int ret = SCE_KERNEL_ERROR_EINVAL;
+	do
+	{
+		if (!tp)
+		{
+			ret = SCE_KERNEL_ERROR_EFAULT;
+			break;
+		}
+
+		GuestClockType type  = GuestClockType::Monotonic;
+		bool           known = true;
+		switch (clk_id)
+		{
+		case SCE_KERNEL_CLOCK_REALTIME:
+		case SCE_KERNEL_CLOCK_REALTIME_PRECISE:
+		case SCE_KERNEL_CLOCK_REALTIME_FAST:
+		case SCE_KERNEL_CLOCK_SECOND:
+		case SCE_KERNEL_CLOCK_EXT_NETWORK:
+		case SCE_KERNEL_CLOCK_EXT_DEBUG_NETWORK:
+		case SCE_KERNEL_CLOCK_EXT_AD_NETWORK:
+		case SCE_KERNEL_CLOCK_EXT_RAW_NETWORK:
+			type = GuestClockType::Utc;
+			break;
+		case SCE_KERNEL_CLOCK_MONOTONIC:
+		case SCE_KERNEL_CLOCK_MONOTONIC_PRECISE:
+		case SCE_KERNEL_CLOCK_MONOTONIC_FAST:
+		case SCE_KERNEL_CLOCK_UPTIME:
+		case SCE_KERNEL_CLOCK_UPTIME_PRECISE:
+		case SCE_KERNEL_CLOCK_UPTIME_FAST:
+			type = GuestClockType::Monotonic;
+			break;
+		case SCE_KERNEL_CLOCK_PROCTIME:
+			type = GuestClockType::Process;
+			break;
+		// Virtual is user time only, the host doesn't tell it apart.
+		case SCE_KERNEL_CLOCK_VIRTUAL:
+		case SCE_KERNEL_CLOCK_PROF:
+			type = GuestClockType::ProcessCpu;
+			break;
+		case SCE_KERNEL_CLOCK_THREAD_CPUTIME_ID:
+			type = GuestClockType::ThreadCpu;
+			break;
+		default:
+			known = false;
+			break;
+		}
+
+		if (!known)
+		{
+			LOG_WARN("unknown clock id %d", clk_id);
+			break;
+		}
+
+		uint64_t time = TheEmulator().clock().now(type);
+		tp->tv_sec    = time / 1000000000;
+		tp->tv_nsec   = clk_id == SCE_KERNEL_CLOCK_SECOND ? 0 : time % 1000000000;
+
+		ret = SCE_OK;
+	} while (false);
+	return ret;
+}
+
 
 //////////////////////////////////////////////////////////////////////////
 // library: libScePosix
@@ -51,22 +119,20 @@ uint64_t PS4API sceKernelReadTsc(void)
 int PS4API scek_clock_gettime(sce_clockid_t clk_id, struct sce_timespec * tp)
 {
 	//LOG_SCE_TRACE("id %d tp %p", clk_id, tp);
-	// TODO:
-	// TIME_UTC is CLOCK_REALTIME,
-	// we need CLOCK_MONOTONIC
-	struct timespec ts;
-	memset(tp, 0, sizeof(*tp));
-	timespec_get(&ts, TIME_UTC);
-	tp->tv_sec = ts.tv_sec;
-	tp->tv_nsec = ts.tv_nsec;
-	return 0;
+	int ret = getClockTime(clk_id, tp);
+	if (ret != SCE_OK)
+	{
+		errno = ret == SCE_KERNEL_ERROR_EFAULT ? EFAULT : EINVAL;
+		ret   = -1;
+	}
+	return ret;
 }
 
 
 int PS4API sceKernelClockGettime(sce_clockid_t clk_id, struct sce_timespec * tp)
 {
 	LOG_SCE_TRACE("id %d tp %p", clk_id, tp);
-	return scek_clock_gettime(clk_id, tp);
+	return getClockTime(clk_id, tp);
 }
 
 
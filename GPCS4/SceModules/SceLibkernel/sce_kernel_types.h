@@ -16,3 +16,23 @@ typedef void* SceKernelSema;
 #define SCE_KERNEL_CPUMODE_7CPU_NORMAL   5
 
 
+#define SCE_KERNEL_CLOCK_REALTIME             0
+#define SCE_KERNEL_CLOCK_VIRTUAL              1
+#define SCE_KERNEL_CLOCK_PROF                 2
+#define SCE_KERNEL_CLOCK_MONOTONIC            4
+#define SCE_KERNEL_CLOCK_UPTIME               5
+#define SCE_KERNEL_CLOCK_UPTIME_PRECISE       7
+#define SCE_KERNEL_CLOCK_UPTIME_FAST          8
+#define SCE_KERNEL_CLOCK_REALTIME_PRECISE     9
+#define SCE_KERNEL_CLOCK_REALTIME_FAST        10
+#define SCE_KERNEL_CLOCK_MONOTONIC_PRECISE    11
+#define SCE_KERNEL_CLOCK_MONOTONIC_FAST       12
+#define SCE_KERNEL_CLOCK_SECOND               13
+#define SCE_KERNEL_CLOCK_THREAD_CPUTIME_ID    14
+#define SCE_KERNEL_CLOCK_PROCTIME             15
+#define SCE_KERNEL_CLOCK_EXT_NETWORK          16
+#define SCE_KERNEL_CLOCK_EXT_DEBUG_NETWORK    17
+#define SCE_KERNEL_CLOCK_EXT_AD_NETWORK       18
+#define SCE_KERNEL_CLOCK_EXT_RAW_NETWORK      19
+
+
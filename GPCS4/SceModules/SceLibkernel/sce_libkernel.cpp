@@ -1,6 +1,7 @@
 #include "sce_libkernel.h"
 
 #include "Emulator.h"
+#include "ThreadAffinity.h"
 #include "Platform.h"
 #include "SceModuleSystem.h"
 #include "VirtualGPU.h"
@@ -218,15 +219,27 @@ int PS4API scePthreadAttrGet(ScePthread thread, ScePthreadAttr* attr)
 {
 	LOG_SCE_DUMMY_IMPL();
 	pthread_attr_init(&((*attr)->handle));
+	(*attr)->affinity = TheEmulator().affinity().getGuestMask(thread);
 	return SCE_OK;
 }
 
 
-int PS4API scePthreadAttrGetaffinity(ScePthread thread, SceKernelCpumask* mask)
+int PS4API scePthreadAttrGetaffinity(const ScePthreadAttr* attr, SceKernelCpumask* mask)
 {
-	LOG_SCE_DUMMY_IMPL();
-	*mask = 0;
-	return SCE_OK;
+	LOG_SCE_TRACE("attr %p mask %p", attr, mask);
+	int ret = SCE_KERNEL_ERROR_EINVAL;
+	do
+	{
+		if (!attr || !*attr || !mask)
+		{
+			break;
+		}
+
+		*mask = (*attr)->affinity;
+
+		ret = SCE_OK;
+	} while (false);
+	return ret;
 }
 
 
@@ -238,8 +251,9 @@ int PS4API sceKernelGetProcessType(int pid)
 
 int PS4API sceKernelGetCurrentCpu(void)
 {
-	LOG_FIXME("Not implemented");
-	return 0;
+	// Reports the guest core the host processor maps to,
+	// and counts the thread's migrations along the way.
+	return TheEmulator().affinity().sampleCurrentCpu(scePthreadSelf());
 }
 
 
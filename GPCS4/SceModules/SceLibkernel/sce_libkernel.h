@@ -84,9 +84,21 @@ int PS4API sceKernelCreateEventFlag(SceKernelEventFlag *ef, const char *pName, u
 int PS4API sceKernelPollEventFlag(SceKernelEventFlag ef, uint64_t bitPattern, uint32_t waitMode, uint64_t* pResultPat);
 
 
+int PS4API sceKernelClearEventFlag(SceKernelEventFlag ef, uint64_t bitPattern);
+
+
+int PS4API sceKernelCancelEventFlag(SceKernelEventFlag ef, uint64_t setPattern, int* pNumWaitThreads);
+
+
 int PS4API sceKernelCreateSema(SceKernelSema *sem, const char *name, uint32_t attr, int init, int max, const SceKernelSemaOptParam *opt);
 
 
+int PS4API sceKernelPollSema(SceKernelSema sem, int need);
+
+
+int PS4API sceKernelCancelSema(SceKernelSema sem, int setCount, int* pNumWaitThreads);
+
+
 int PS4API sceKernelDeleteEqueue(SceKernelEqueue eq);
 
 
@@ -144,7 +156,7 @@ int PS4API sceKernelCheckReachability(void);
 int PS4API sceKernelChmod(void);
 
 
-int PS4API sceKernelMkdir(void);
+int PS4API sceKernelMkdir(const char *path, SceKernelMode mode);
 
 
 int PS4API sceKernelOpen(const char *path, int flags, SceKernelMode mode);
@@ -162,7 +174,7 @@ int PS4API sceKernelReleaseDirectMemory(sce_off_t start, size_t len);
 int PS4API sceKernelReleaseFlexibleMemory(void);
 
 
-int PS4API sceKernelRename(void);
+int PS4API sceKernelRename(const char *from, const char *to);
 
 
 int PS4API sceKernelSetEventFlag(SceKernelEventFlag ef, uint64_t bitPattern);
@@ -174,7 +186,7 @@ int PS4API sceKernelSignalSema(SceKernelSema sem, int count);
 int PS4API sceKernelStat(const char *path, SceKernelStat *sb);
 
 
-int PS4API sceKernelUnlink(void);
+int PS4API sceKernelUnlink(const char *path);
 
 
 int PS4API sceKernelUsleep(SceKernelUseconds microseconds);
@@ -183,6 +195,39 @@ int PS4API sceKernelUsleep(SceKernelUseconds microseconds);
 int PS4API sceKernelWaitEqueue(SceKernelEqueue eq, SceKernelEvent *ev, int num, int *out, SceKernelUseconds *timo);
 
 
+int PS4API sceKernelAddUserEvent(SceKernelEqueue eq, int id);
+
+
+int PS4API sceKernelAddUserEventEdge(SceKernelEqueue eq, int id);
+
+
+int PS4API sceKernelTriggerUserEvent(SceKernelEqueue eq, int id, void *udata);
+
+
+int PS4API sceKernelDeleteUserEvent(SceKernelEqueue eq, int id);
+
+
+int PS4API sceKernelAddTimerEvent(SceKernelEqueue eq, int id, SceKernelUseconds usec, void *udata);
+
+
+int PS4API sceKernelDeleteTimerEvent(SceKernelEqueue eq, int id);
+
+
+uintptr_t PS4API sceKernelGetEventId(const SceKernelEvent *ev);
+
+
+int PS4API sceKernelGetEventFilter(const SceKernelEvent *ev);
+
+
+intptr_t PS4API sceKernelGetEventData(const SceKernelEvent *ev);
+
+
+unsigned int PS4API sceKernelGetEventFflags(const SceKernelEvent *ev);
+
+
+void* PS4API sceKernelGetEventUserData(const SceKernelEvent *ev);
+
+
 int PS4API sceKernelWaitEventFlag(SceKernelEventFlag ef, uint64_t bitPattern, uint32_t waitMode, uint64_t *pResultPat, SceKernelUseconds *pTimeout);
 
 
@@ -201,7 +246,7 @@ int PS4API scePthreadAttrGetschedparam(void);
 int PS4API scePthreadAttrInit(ScePthreadAttr *attr);
 
 
-int PS4API scePthreadAttrSetaffinity(void);
+int PS4API scePthreadAttrSetaffinity(ScePthreadAttr *attr, const SceKernelCpumask mask);
 
 
 int PS4API scePthreadAttrSetdetachstate(ScePthreadAttr *attr, int state);
@@ -246,7 +291,7 @@ int PS4API scePthreadCreate(ScePthread *thread, const ScePthreadAttr *attr, void
 void PS4API scePthreadExit(void *value_ptr);
 
 
-int PS4API scePthreadGetaffinity(void);
+int PS4API scePthreadGetaffinity(ScePthread thread, SceKernelCpumask* mask);
 
 
 int PS4API scePthreadGetprio(ScePthread thread, int *prio);
@@ -405,7 +450,7 @@ int PS4API scePthreadKeyCreate(void);
 int PS4API scePthreadAttrGet(ScePthread thread, ScePthreadAttr* attr);
 
 
-int PS4API scePthreadAttrGetaffinity(ScePthread thread, SceKernelCpumask* mask);
+int PS4API scePthreadAttrGetaffinity(const ScePthreadAttr* attr, SceKernelCpumask* mask);
 
 
 int PS4API scePthreadMutexTimedlock(void);
@@ -636,7 +681,34 @@ int PS4API scePthreadEqual(ScePthread thread1, ScePthread thread2);
 pthread_t PS4API scePthreadGetthreadid();
 
 
-ssize_t PS4API sceKernelPread(int d, void* buf, size_t nbytes, off_t offset);
+ssize_t PS4API sceKernelPread(int d, void* buf, size_t nbytes, sce_off_t offset);
+
+
+ssize_t PS4API sceKernelPwrite(int d, const void* buf, size_t nbytes, sce_off_t offset);
+
+
+int PS4API sceKernelAioSubmitReadCommands(SceKernelAioRWRequest req[], int size, int prio, SceKernelAioSubmitId* id);
+
+
+int PS4API sceKernelAioSubmitReadCommandsMultiple(SceKernelAioRWRequest req[], int size, int prio, SceKernelAioSubmitId id[]);
+
+
+int PS4API sceKernelAioSubmitWriteCommands(SceKernelAioRWRequest req[], int size, int prio, SceKernelAioSubmitId* id);
+
+
+int PS4API sceKernelAioSubmitWriteCommandsMultiple(SceKernelAioRWRequest req[], int size, int prio, SceKernelAioSubmitId id[]);
+
+
+int PS4API sceKernelAioWaitRequest(SceKernelAioSubmitId id, int* state, SceKernelUseconds* usec);
+
+
+int PS4API sceKernelAioPollRequest(SceKernelAioSubmitId id, int* state);
+
+
+int PS4API sceKernelAioCancelRequest(SceKernelAioSubmitId id, int* state);
+
+
+int PS4API sceKernelAioDeleteRequest(SceKernelAioSubmitId id, int* ret);
 
 
 
@@ -55,6 +55,17 @@ static const SCE_EXPORT_FUNCTION g_pSceLibkernel_libkernel_FunctionTable[] =
 	{ 0x0145D5C5678953F0, "sceKernelUnlink", (void*)sceKernelUnlink },
 	{ 0xD637D72D15738AC7, "sceKernelUsleep", (void*)sceKernelUsleep },
 	{ 0x7F3C8C2ACF648A6D, "sceKernelWaitEqueue", (void*)sceKernelWaitEqueue },
+	{ 0xE11EBF3AF2367040, "sceKernelAddUserEvent", (void*)sceKernelAddUserEvent },
+	{ 0x583B339926D6B839, "sceKernelAddUserEventEdge", (void*)sceKernelAddUserEventEdge },
+	{ 0x17A7B4930A387279, "sceKernelTriggerUserEvent", (void*)sceKernelTriggerUserEvent },
+	{ 0x2C90F07523539C38, "sceKernelDeleteUserEvent", (void*)sceKernelDeleteUserEvent },
+	{ 0xE7B64AF8E0C45D66, "sceKernelAddTimerEvent", (void*)sceKernelAddTimerEvent },
+	{ 0x6164055325C855D5, "sceKernelDeleteTimerEvent", (void*)sceKernelDeleteTimerEvent },
+	{ 0x989EDA8219A0BDF7, "sceKernelGetEventId", (void*)sceKernelGetEventId },
+	{ 0xDB708F3C8D6DC816, "sceKernelGetEventFilter", (void*)sceKernelGetEventFilter },
+	{ 0x9301B2CA3A21239D, "sceKernelGetEventData", (void*)sceKernelGetEventData },
+	{ 0x434AABF40CAA2529, "sceKernelGetEventFflags", (void*)sceKernelGetEventFflags },
+	{ 0xBF3FA9836CDDA292, "sceKernelGetEventUserData", (void*)sceKernelGetEventUserData },
 	{ 0x253BC17E58586B34, "sceKernelWaitEventFlag", (void*)sceKernelWaitEventFlag },
 	{ 0x6716B45614154EC9, "sceKernelWaitSema", (void*)sceKernelWaitSema },
 	{ 0xE304B37BDD8184B2, "sceKernelWrite", (void*)sceKernelWrite },
@@ -138,6 +149,10 @@ static const SCE_EXPORT_FUNCTION g_pSceLibkernel_libkernel_FunctionTable[] =
 	{ 0x42E2586762951864, "shm_open", (void*)scek_shm_open },
 	{ 0xB4F5AC6CE5063BC9, "shm_unlink", (void*)scek_shm_unlink },
 	{ 0xf65be3e438c76620, "sceKernelPollEventFlag", (void*)sceKernelPollEventFlag },
+	{ 0xEEE8411564404BAD, "sceKernelClearEventFlag", (void*)sceKernelClearEventFlag },
+	{ 0x3D992EE19AD726A8, "sceKernelCancelEventFlag", (void*)sceKernelCancelEventFlag },
+	{ 0xD76C0E1E4F32C1BD, "sceKernelPollSema", (void*)sceKernelPollSema },
+	{ 0xE03334E94D813446, "sceKernelCancelSema", (void*)sceKernelCancelSema },
 	{ 0xacd856cfe96f38c5, "_sceKernelSetThreadDtors", (void*)_sceKernelSetThreadDtors },
 	{ 0xa41ff2199da743da, "_sceKernelSetThreadAtexitCount", (void*)_sceKernelSetThreadAtexitCount },
 	{ 0x5a109cd70dc48522, "_sceKernelSetThreadAtexitReport", (void*)_sceKernelSetThreadAtexitReport },
@@ -158,6 +173,15 @@ static const SCE_EXPORT_FUNCTION g_pSceLibkernel_libkernel_FunctionTable[] =
 	{ 0xDCFB55EA9DD0357E, "scePthreadEqual", (void*)scePthreadEqual },
 	{ 0x108FF9FE396AD9D1, "scePthreadGetthreadid", (void*)scePthreadGetthreadid },
 	{ 0xFABDEB305C08B55E, "sceKernelPread", (void*)sceKernelPread },
+	{ 0x9CA5A2FCDD87055E, "sceKernelPwrite", (void*)sceKernelPwrite },
+	{ 0x1E05FBF80391239F, "sceKernelAioSubmitReadCommands", (void*)sceKernelAioSubmitReadCommands },
+	{ 0x9574F49B73FFBECE, "sceKernelAioSubmitReadCommandsMultiple", (void*)sceKernelAioSubmitReadCommandsMultiple },
+	{ 0x5D0F02F32F9D7BE1, "sceKernelAioSubmitWriteCommands", (void*)sceKernelAioSubmitWriteCommands },
+	{ 0xC53DC2A73D3287A6, "sceKernelAioSubmitWriteCommandsMultiple", (void*)sceKernelAioSubmitWriteCommandsMultiple },
+	{ 0x28E17FA096D056F7, "sceKernelAioWaitRequest", (void*)sceKernelAioWaitRequest },
+	{ 0xDA93AEA16A02C5D9, "sceKernelAioPollRequest", (void*)sceKernelAioPollRequest },
+	{ 0x7D1E76D4A20681BF, "sceKernelAioCancelRequest", (void*)sceKernelAioCancelRequest },
+	{ 0xE5380C13A018B72E, "sceKernelAioDeleteRequest", (void*)sceKernelAioDeleteRequest },
 	{ 0xDE4EA4C7FCCE3924, "sceKernelMlock", (void*)sceKernelMlock },
 	{ 0x9FCF2FC770B99D6F, "gettimeofday", (void*)scek_gettimeofday },
 	{ 0xC92F14D931827B50, "nanosleep", (void*)scek_nanosleep },
@@ -1,6 +1,8 @@
 #include "sce_pthread_common.h"
 #include "sce_libkernel.h"
 #include "Emulator/TLSHandler.h"
+#include "Emulator/ThreadAffinity.h"
+#include "Emulator.h"
 
 LOG_CHANNEL(SceModules.SceLibkernel.pthreadcommon);
 
@@ -18,9 +20,17 @@ void* newThreadWrapper(void* arg)
 		ScePthread tid = scePthreadSelf();
 		LOG_DEBUG("new sce thread created %d", tid);
 
+		// Bind before running any guest code, so that
+		// threads never run on the emulator's cores.
+		auto& affinity = TheEmulator().affinity();
+		affinity.setThreadName(tid, param->name.c_str());
+		affinity.bindGuestThread(tid, nullptr, param->affinity);
+
 		PFUNC_PS4_THREAD_ENTRY pSceEntry = (PFUNC_PS4_THREAD_ENTRY)param->entry;
 		ret = pSceEntry(param->arg);
 
+		affinity.removeThread(tid);
+
 		// release tls data
 		TLSManager* tlsMgr = TLSManager::GetInstance();
 		tlsMgr->notifyThreadExit();
@@ -3,10 +3,14 @@
 #include "winpthreads/include/pthread.h"
 #include "MapSlot.h"
 
+#include <string>
+
 struct SCE_THREAD_PARAM
 {
-	void* entry;
-	void* arg;
+	void*            entry;
+	void*            arg;
+	SceKernelCpumask affinity;
+	std::string      name;
 };
 
 void *newThreadWrapper(void *arg);
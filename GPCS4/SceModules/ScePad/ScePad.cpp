@@ -1,36 +1,66 @@
 #include "ScePad.h"
+#include "Emulator.h"
 #include "sce_errors.h"
 #include "sce_pad_error.h"
-#include "Platform/PlatProcess.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <sstream>
 #include <stdexcept>
 
 using namespace plat;
 
 LOG_CHANNEL(SceModules.ScePad);
 
-SceInputController::~SceInputController()
+// Report rate of a DualShock 4 over USB.
+constexpr uint32_t PadSampleRate = 250;
+
+static void fillControllerInformation(ScePadControllerInformation* info)
 {
+	memset(info, 0, sizeof(ScePadControllerInformation));
+	info->touchPadInfo.pixelDensity = 1;
+	info->touchPadInfo.resolution.x = 256;
+	info->touchPadInfo.resolution.y = 256;
+	info->stickInfo.deadZoneLeft    = 2;
+	info->stickInfo.deadZoneRight   = 2;
+
+	info->connectionType = SCE_PAD_CONNECTION_TYPE_LOCAL;
+	info->connectedCount = 1;
+	info->connected      = true;
+	info->deviceClass    = SCE_PAD_DEVICE_CLASS_STANDARD;
 }
 
-
-SceGamepad::SceGamepad()
+// Connected, sticks centered, nothing pressed.
+static void fillIdleState(ScePadData* data)
 {
+	memset(data, 0, sizeof(ScePadData));
+	data->connected      = true;
+	data->connectedCount = 1;
+	data->leftStick      = { 0x80, 0x80 };
+	data->rightStick     = { 0x80, 0x80 };
+	data->analogButtons  = { 0, 0, { 2, 2 } };
 }
 
-SceGamepad::~SceGamepad()
+SceInputController::~SceInputController()
 {
 }
 
 
-int SceGamepad::read(ScePadData* data, int32_t num)
+SceGamepad::SceGamepad()
+{
+}
+
+SceGamepad::~SceGamepad()
 {
-	
 }
 
 
-int SceGamepad::readState(ScePadData* data)
+void SceGamepad::sample(uint64_t time, ScePadData* data)
 {
+	// There's no host gamepad backend yet.
+	memset(data, 0, sizeof(ScePadData));
 }
 
 int SceGamepad::getInformation(ScePadControllerInformation* info)
@@ -63,20 +93,20 @@ SceKeyboard::~SceKeyboard()
 {
 }
 
-int SceKeyboard::read(ScePadData* data, int32_t num)
+void SceKeyboard::sample(uint64_t time, ScePadData* data)
 {
-	// 2020/2/14 13:03 UTC  DummyCatz: Retro City RamPage calls this
-	// function, but it is not implemented and pops illegal instruction.
-	// I just make a dummy implemention for it in order to continue running.
-	LOG_SCE_DUMMY_IMPL();
-	*data = {};
-	data->connected = true;
+	fillIdleState(data);
 
-	return SCE_OK;
+	// Not every platform has a keyboard backend,
+	// the pad is then connected but idle.
+	if (m_device)
+	{
+		readKeyboard(data);
+	}
 }
 
 
-int SceKeyboard::readState(ScePadData* data)
+void SceKeyboard::readKeyboard(ScePadData* data)
 {
 	// TODO:
 	// Just quick and dirty implement currently. :)
@@ -166,8 +196,6 @@ int SceKeyboard::readState(ScePadData* data)
 		buttons |= SCE_PAD_BUTTON_R3;
 	}
 
-	LOG_DEBUG_IF(buttons != 0, "pad buttons %08X", buttons);
-
 	ScePadAnalogStick leftStick = { 0x80, 0x80 };
 
 	if (m_device->getKeyState(KeyCode::KEY_A) == KeyState::Press)
@@ -212,16 +240,10 @@ int SceKeyboard::readState(ScePadData* data)
 		rightStick.y += 127;
 	}
 
-	memset(data, 0, sizeof(ScePadData));
-	data->connected      = true;
-	data->connectedCount = 1;
-	data->timestamp      = plat::GetProcessTimeCounter();
-	data->buttons        = buttons;
-	data->leftStick      = leftStick;
-	data->rightStick     = rightStick;
-	data->analogButtons  = analogButtons;
-
-	return SCE_OK;
+	data->buttons       = buttons;
+	data->leftStick     = leftStick;
+	data->rightStick    = rightStick;
+	data->analogButtons = analogButtons;
 }
 
 int SceKeyboard::getInformation(ScePadControllerInformation* info)
@@ -234,17 +256,7 @@ int SceKeyboard::getInformation(ScePadControllerInformation* info)
 			break;
 		}
 
-		memset(info, 0, sizeof(ScePadControllerInformation));
-		info->touchPadInfo.pixelDensity = 1;
-		info->touchPadInfo.resolution.x = 256;
-		info->touchPadInfo.resolution.y = 256;
-		info->stickInfo.deadZoneLeft    = 2;
-		info->stickInfo.deadZoneRight   = 2;
-
-		info->connectionType = SCE_PAD_CONNECTION_TYPE_LOCAL;
-		info->connectedCount = 1;
-		info->connected      = true;
-		info->deviceClass    = SCE_PAD_DEVICE_CLASS_STANDARD;
+		fillControllerInformation(info);
 
 		ret = SCE_OK;
 	} while (false);
@@ -266,19 +278,227 @@ int SceKeyboard::setVibration(int32_t handle, const ScePadVibrationParam* pParam
 	return SCE_OK;
 }
 
+SceInputScript::SceInputScript()
+{
+}
+
+SceInputScript::~SceInputScript()
+{
+}
+
+bool SceInputScript::load(const std::string& path)
+{
+	bool ret = false;
+	do
+	{
+		std::ifstream file(path);
+		if (!file)
+		{
+			LOG_ERR("open input script %s failed", path.c_str());
+			break;
+		}
+
+		std::stringstream text;
+		text << file.rdbuf();
+		ret = parse(text.str());
+	} while (false);
+	return ret;
+}
+
+bool SceInputScript::parse(const std::string& text)
+{
+	bool ret = true;
+
+	std::istringstream lines(text);
+	std::string        line;
+	uint32_t           lineNumber = 0;
+	m_entries.clear();
+	while (std::getline(lines, line))
+	{
+		++lineNumber;
+		line = line.substr(0, line.find('#'));
+		if (line.find_first_not_of(" \t\r") == std::string::npos)
+		{
+			continue;
+		}
+
+		Entry entry = {};
+		if (!parseLine(line, &entry) ||
+			(!m_entries.empty() && entry.time < m_entries.back().time))
+		{
+			LOG_ERR("bad input script line %u: %s", lineNumber, line.c_str());
+			ret = false;
+			break;
+		}
+		m_entries.push_back(entry);
+	}
+
+	m_cursor  = 0;
+	m_started = false;
+	return ret;
+}
+
+bool SceInputScript::parseLine(const std::string& line, Entry* entry)
+{
+	static const std::pair<const char*, uint32_t> buttonNames[] = {
+		{ "L3", SCE_PAD_BUTTON_L3 },
+		{ "R3", SCE_PAD_BUTTON_R3 },
+		{ "OPTIONS", SCE_PAD_BUTTON_OPTIONS },
+		{ "UP", SCE_PAD_BUTTON_UP },
+		{ "RIGHT", SCE_PAD_BUTTON_RIGHT },
+		{ "DOWN", SCE_PAD_BUTTON_DOWN },
+		{ "LEFT", SCE_PAD_BUTTON_LEFT },
+		{ "L2", SCE_PAD_BUTTON_L2 },
+		{ "R2", SCE_PAD_BUTTON_R2 },
+		{ "L1", SCE_PAD_BUTTON_L1 },
+		{ "R1", SCE_PAD_BUTTON_R1 },
+		{ "TRIANGLE", SCE_PAD_BUTTON_TRIANGLE },
+		{ "CIRCLE", SCE_PAD_BUTTON_CIRCLE },
+		{ "CROSS", SCE_PAD_BUTTON_CROSS },
+		{ "SQUARE", SCE_PAD_BUTTON_SQUARE },
+		{ "TOUCH_PAD", SCE_PAD_BUTTON_TOUCH_PAD },
+	};
+
+	bool ret = false;
+	do
+	{
+		std::istringstream fields(line);
+		double             milliseconds = 0.0;
+		std::string        buttons;
+		if (!(fields >> milliseconds >> buttons) || milliseconds < 0.0)
+		{
+			break;
+		}
+
+		entry->time = static_cast<uint64_t>(milliseconds * 1000.0);
+
+		bool known = true;
+		if (isdigit(static_cast<unsigned char>(buttons[0])))
+		{
+			entry->buttons = std::strtoul(buttons.c_str(), nullptr, 0);
+		}
+		else
+		{
+			std::istringstream names(buttons);
+			std::string        name;
+			while (known && std::getline(names, name, '|'))
+			{
+				auto iter = std::find_if(std::begin(buttonNames), std::end(buttonNames),
+										 [&name](auto const& button)
+										 { return name == button.first; });
+				known     = iter != std::end(buttonNames);
+				entry->buttons |= known ? iter->second : 0;
+			}
+		}
+		if (!known)
+		{
+			break;
+		}
+
+		// Sticks and triggers are optional, in that order.
+		uint32_t axes[6]   = { 0x80, 0x80, 0x80, 0x80, 0, 0 };
+		uint32_t axisCount = 0;
+		while (axisCount != 6 && fields >> axes[axisCount])
+		{
+			++axisCount;
+		}
+		bool inRange = std::all_of(std::begin(axes), std::end(axes),
+								   [](uint32_t axis)
+								   { return axis <= 0xFF; });
+
+		std::string rest;
+		fields.clear();
+		fields >> rest;
+		if (!rest.empty() || (axisCount != 0 && axisCount != 4 && axisCount != 6) || !inRange)
+		{
+			break;
+		}
+
+		entry->leftStick     = { uint8_t(axes[0]), uint8_t(axes[1]) };
+		entry->rightStick    = { uint8_t(axes[2]), uint8_t(axes[3]) };
+		entry->analogButtons = { uint8_t(axes[4]), uint8_t(axes[5]), { 2, 2 } };
+
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+void SceInputScript::sample(uint64_t time, ScePadData* data)
+{
+	if (!m_started)
+	{
+		m_startTime = time;
+		m_started   = true;
+	}
+
+	// Samples come in order, so the cursor only moves forward.
+	uint64_t elapsed = time - m_startTime;
+	while (m_cursor + 1 < m_entries.size() && m_entries[m_cursor + 1].time <= elapsed)
+	{
+		++m_cursor;
+	}
+
+	fillIdleState(data);
+	if (!m_entries.empty() && m_entries[m_cursor].time <= elapsed)
+	{
+		const auto& entry   = m_entries[m_cursor];
+		data->buttons       = entry.buttons;
+		data->leftStick     = entry.leftStick;
+		data->rightStick    = entry.rightStick;
+		data->analogButtons = entry.analogButtons;
+	}
+}
+
+int SceInputScript::getInformation(ScePadControllerInformation* info)
+{
+	int ret = SCE_PAD_ERROR_INVALID_ARG;
+	do
+	{
+		if (!info)
+		{
+			break;
+		}
+
+		fillControllerInformation(info);
+
+		ret = SCE_OK;
+	} while (false);
+	return ret;
+}
+
+int SceInputScript::setLightBar(int32_t handle, const ScePadLightBarParam* pParam)
+{
+	return SCE_OK;
+}
+
+int SceInputScript::resetLightBar(int32_t handle)
+{
+	return SCE_OK;
+}
+
+int SceInputScript::setVibration(int32_t handle, const ScePadVibrationParam* pParam)
+{
+	return SCE_OK;
+}
+
 ScePad::ScePad(SceUserServiceUserId userId, int32_t type, int32_t index):
 	m_userId(userId),
 	m_type(type),
 	m_index(index)
 {
-	// TODO:
-	// use somewhat config to decide which one to use
-	m_controller = std::make_unique<SceKeyboard>();
-	//m_controller = std::make_unique<SceGamepad>();
+	m_controller = createController();
+
+	// Sample once right away, so that there's
+	// always a state to read.
+	m_sampler = std::make_unique<ScePadSampler>(m_controller.get());
+	m_sampler->sample(ScePadSampler::now());
+	m_sampler->start(PadSampleRate);
 }
 
 ScePad::~ScePad()
 {
+	// Stops sampling before the controller goes away.
+	m_sampler.reset();
 }
 
 SceUserServiceUserId ScePad::userId() const
@@ -293,12 +513,34 @@ int32_t ScePad::type() const
 
 int ScePad::read(ScePadData* data, int32_t num)
 {
-	return m_controller->read(data, num);
+	int ret = SCE_PAD_ERROR_INVALID_ARG;
+	do
+	{
+		if (!data || num <= 0)
+		{
+			break;
+		}
+
+		ret = m_sampler->read(data, num);
+	} while (false);
+	return ret;
 }
 
 int ScePad::readState(ScePadData* data)
 {
-	return m_controller->readState(data);
+	int ret = SCE_PAD_ERROR_INVALID_ARG;
+	do
+	{
+		if (!data)
+		{
+			break;
+		}
+
+		m_sampler->readState(data);
+
+		ret = SCE_OK;
+	} while (false);
+	return ret;
 }
 
 int ScePad::getInformation(ScePadControllerInformation* info)
@@ -321,3 +563,26 @@ int ScePad::setVibration(int32_t handle, const ScePadVibrationParam* pParam)
 	return m_controller->setVibration(handle, pParam);
 }
 
+std::unique_ptr<SceInputController> ScePad::createController()
+{
+	std::unique_ptr<SceInputController> controller;
+
+	auto& scriptPath = TheEmulator().options().padScriptPath;
+	if (!scriptPath.empty())
+	{
+		auto script = std::make_unique<SceInputScript>();
+		if (script->load(scriptPath))
+		{
+			controller = std::move(script);
+		}
+	}
+
+	// TODO:
+	// use somewhat config to decide which one to use
+	if (!controller)
+	{
+		controller = std::make_unique<SceKeyboard>();
+		//controller = std::make_unique<SceGamepad>();
+	}
+	return controller;
+}
@@ -4,19 +4,32 @@
 #include "sce_types.h"
 #include "sce_pad_types.h"
 #include "PlatInput.h"
+#include "ScePadSampler.h"
 
 #include <memory>
+#include <string>
+#include <vector>
 
 
+/**
+ * \brief Source of pad samples
+ *
+ * sample() is called on the sampling thread of the pad,
+ * never on the guest thread reading it.
+ */
 class SceInputController
 {
 public:
 
 	virtual ~SceInputController() = 0;
 
-	virtual int read(ScePadData* data, int32_t num) = 0;
-
-	virtual int readState(ScePadData* data) = 0;
+	/**
+	 * \brief Fills a pad state
+	 *
+	 * \param [in] time Sample time in microseconds
+	 * \param [out] data State, the timestamp is set by the caller
+	 */
+	virtual void sample(uint64_t time, ScePadData* data) = 0;
 
 	virtual int getInformation(ScePadControllerInformation* info) = 0;
 
@@ -34,9 +47,7 @@ public:
 	SceGamepad();
 	virtual ~SceGamepad();
 
-	virtual int read(ScePadData* data, int32_t num) override;
-
-	virtual int readState(ScePadData* data) override;
+	virtual void sample(uint64_t time, ScePadData* data) override;
 
 	virtual int getInformation(ScePadControllerInformation* info) override;
 
@@ -57,9 +68,7 @@ public:
 	SceKeyboard();
 	virtual ~SceKeyboard();
 
-	virtual int read(ScePadData* data, int32_t num) override;
-
-	virtual int readState(ScePadData* data) override;
+	virtual void sample(uint64_t time, ScePadData* data) override;
 
 	virtual int getInformation(ScePadControllerInformation* info) override;
 
@@ -69,12 +78,72 @@ public:
 
  	virtual int setVibration(int32_t handle, const ScePadVibrationParam* pParam) override;
 
+ private:
+	void readKeyboard(ScePadData* data);
+
  private:
 	std::unique_ptr<plat::InputDevice> m_device;
 };
 
 
 
+/**
+ * \brief Replays a script of pad states
+ *
+ * One state per line, from the given time on:
+ * \code
+ * # milliseconds buttons [lx ly rx ry [l2 r2]]
+ * 0    0
+ * 500  CROSS
+ * 600  UP|CROSS 128 0 128 128
+ * \endcode
+ * Buttons are names joined by '|' or a number, sticks
+ * are centered and triggers released when left out.
+ * Times are relative to the first sample, the last
+ * state is kept once the script ends, which makes
+ * runs deterministic and headless.
+ */
+class SceInputScript : public SceInputController
+{
+public:
+	SceInputScript();
+	virtual ~SceInputScript();
+
+	bool load(const std::string& path);
+
+	bool parse(const std::string& text);
+
+	virtual void sample(uint64_t time, ScePadData* data) override;
+
+	virtual int getInformation(ScePadControllerInformation* info) override;
+
+	virtual int setLightBar(int32_t handle, const ScePadLightBarParam* pParam) override;
+
+	virtual int resetLightBar(int32_t handle) override;
+
+	virtual int setVibration(int32_t handle, const ScePadVibrationParam* pParam) override;
+
+private:
+	struct Entry
+	{
+		uint64_t            time;
+		uint32_t            buttons;
+		ScePadAnalogStick   leftStick;
+		ScePadAnalogStick   rightStick;
+		ScePadAnalogButtons analogButtons;
+	};
+
+	bool parseLine(const std::string& line, Entry* entry);
+
+private:
+	std::vector<Entry> m_entries;
+	size_t             m_cursor    = 0;
+	uint64_t           m_startTime = 0;
+	bool               m_started   = false;
+};
+
+
+
 class ScePad
 {
 public:
@@ -97,10 +166,13 @@ public:
 
 	int setVibration(int32_t handle, const ScePadVibrationParam* pParam);
 
+private:
+	std::unique_ptr<SceInputController> createController();
+
 private:
 	SceUserServiceUserId m_userId;
 	int32_t m_type;
 	int32_t m_index;
 	std::unique_ptr<SceInputController> m_controller;
+	std::unique_ptr<ScePadSampler> m_sampler;
 };
-
@@ -0,0 +1,277 @@
+#include "ScePadBench.h"
+#include "ScePad.h"
+#include "ScePadSampler.h"
+#include "sce_errors.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+LOG_CHANNEL(SceModules.ScePad.ScePadBench);
+
+namespace
+{
+	constexpr uint32_t ScriptEntryCount  = 500;
+	constexpr uint64_t ScriptEntryPeriod = 20000;
+	constexpr uint64_t SamplePeriod      = 4000;
+	constexpr uint64_t ReadPeriod        = 16667;
+	constexpr int32_t  ReadBatchSize     = 8;
+
+	// Much faster than a real pad, to have slots
+	// rewritten while they're being read.
+	constexpr uint32_t ConcurrentSampleRate = 8000;
+
+	// Every field is derived from the sample number,
+	// so a sample mixing two of them can be told.
+	class CheckController : public SceInputController
+	{
+	public:
+		void sample(uint64_t time, ScePadData* data) override
+		{
+			uint32_t counter          = ++m_counter;
+			data->buttons             = counter;
+			data->leftStick           = { uint8_t(counter), uint8_t(counter >> 8) };
+			data->rightStick          = { uint8_t(counter >> 16), uint8_t(counter >> 24) };
+			data->orientation.x       = float(counter & 0xFFFF);
+			data->connected           = true;
+			data->connectedCount      = 1;
+			data->deviceUniqueDataLen = SCE_PAD_MAX_DEVICE_UNIQUE_DATA_SIZE;
+			for (uint32_t i = 0; i != SCE_PAD_MAX_DEVICE_UNIQUE_DATA_SIZE; ++i)
+			{
+				data->deviceUniqueData[i] = uint8_t(counter + i);
+			}
+		}
+
+		int getInformation(ScePadControllerInformation* info) override
+		{
+			return SCE_OK;
+		}
+
+		int setLightBar(int32_t handle, const ScePadLightBarParam* pParam) override
+		{
+			return SCE_OK;
+		}
+
+		int resetLightBar(int32_t handle) override
+		{
+			return SCE_OK;
+		}
+
+		int setVibration(int32_t handle, const ScePadVibrationParam* pParam) override
+		{
+			return SCE_OK;
+		}
+
+		static bool isConsistent(const ScePadData& data)
+		{
+			uint32_t counter = data.buttons;
+			bool     ret     = data.leftStick.x == uint8_t(counter) &&
+						   data.leftStick.y == uint8_t(counter >> 8) &&
+						   data.rightStick.x == uint8_t(counter >> 16) &&
+						   data.rightStick.y == uint8_t(counter >> 24) &&
+						   data.orientation.x == float(counter & 0xFFFF);
+			for (uint32_t i = 0; i != SCE_PAD_MAX_DEVICE_UNIQUE_DATA_SIZE; ++i)
+			{
+				ret = ret && data.deviceUniqueData[i] == uint8_t(counter + i);
+			}
+			return ret;
+		}
+
+	private:
+		uint32_t m_counter = 0;
+	};
+
+}  // namespace
+
+ScePadBench::ScePadBench(const ScePadBenchDesc& desc) :
+	m_desc(desc)
+{
+}
+
+ScePadBench::~ScePadBench()
+{
+}
+
+bool ScePadBench::run()
+{
+	bool ret = false;
+	do
+	{
+		if (m_desc.readCount == 0 || m_desc.threadCount == 0)
+		{
+			std::printf("Nothing to run, read or thread count is 0.\n");
+			break;
+		}
+
+		if (!runScript() || !runConcurrent())
+		{
+			break;
+		}
+
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+bool ScePadBench::runScript()
+{
+	bool ret = false;
+	do
+	{
+		// Named buttons, sticks and triggers, and a bad line.
+		SceInputScript named;
+		SceInputScript bad;
+		ScePadData     data = {};
+		if (!named.parse("# comment\n0 UP|CROSS 1 2 3 4 5 6\n") || bad.parse("0 JUMP\n"))
+		{
+			std::printf("Parsing input scripts failed.\n");
+			break;
+		}
+		named.sample(0, &data);
+		if (data.buttons != (SCE_PAD_BUTTON_UP | SCE_PAD_BUTTON_CROSS) ||
+			data.leftStick.x != 1 || data.rightStick.y != 4 || data.analogButtons.r2 != 6)
+		{
+			std::printf("Named input script state is wrong.\n");
+			break;
+		}
+
+		// Each state lasts a few samples, the buttons
+		// number the states to check their order.
+		std::ostringstream text;
+		for (uint32_t i = 0; i != ScriptEntryCount; ++i)
+		{
+			uint32_t state = i + 1;
+			text << (i * ScriptEntryPeriod) / 1000.0 << " " << state << " "
+				 << (state * 3) % 256 << " 128 128 128\n";
+		}
+
+		SceInputScript script;
+		if (!script.parse(text.str()))
+		{
+			std::printf("Parsing the generated input script failed.\n");
+			break;
+		}
+
+		ScePadSampler sampler(&script);
+		std::vector<ScePadData> batch(ReadBatchSize);
+
+		uint64_t endTime     = ScriptEntryCount * ScriptEntryPeriod;
+		uint64_t sampleTime  = 0;
+		uint64_t readTime    = ReadPeriod;
+		uint64_t lastTime    = 0;
+		uint32_t lastState   = 0;
+		uint32_t stateCount  = 0;
+		uint64_t readCount   = 0;
+		uint64_t sampleCount = 0;
+		int32_t  maxBatch    = 0;
+		bool     passed      = true;
+		while (sampleTime <= endTime)
+		{
+			sampler.sample(sampleTime);
+			sampleTime += SamplePeriod;
+
+			for (; readTime < sampleTime; readTime += ReadPeriod)
+			{
+				int32_t count = sampler.read(batch.data(), ReadBatchSize);
+				for (int32_t i = 0; i != count; ++i)
+				{
+					const auto& sample = batch[i];
+					// New samples only, in order.
+					passed &= sampleCount == 0 || sample.timestamp > lastTime;
+					passed &= sample.leftStick.x == (sample.buttons * 3) % 256;
+					if (sample.buttons != lastState)
+					{
+						passed &= sample.buttons == lastState + 1;
+						lastState = sample.buttons;
+						++stateCount;
+					}
+					lastTime = sample.timestamp;
+					++sampleCount;
+				}
+				maxBatch = std::max(maxBatch, count);
+				++readCount;
+			}
+		}
+
+		std::printf("Script         : %u states, %llu samples at %llu Hz, %llu reads at 60 fps\n",
+					ScriptEntryCount, sampler.sampleCount(), 1000000 / SamplePeriod, readCount);
+		std::printf("  Read         : %llu samples, up to %d per read, %u states seen\n",
+					sampleCount, maxBatch, stateCount);
+
+		// The last read may leave a few samples unread.
+		if (!passed || stateCount != ScriptEntryCount ||
+			sampler.sampleCount() - sampleCount > ReadPeriod / SamplePeriod + 1)
+		{
+			std::printf("Replayed samples are wrong.\n");
+			break;
+		}
+
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+bool ScePadBench::runConcurrent()
+{
+	CheckController controller;
+	ScePadSampler   sampler(&controller);
+	sampler.sample(ScePadSampler::now());
+	sampler.start(ConcurrentSampleRate);
+
+	std::atomic<uint64_t> tornCount = { 0 };
+	std::atomic<uint64_t> stateTime = { 0 };
+	std::atomic<uint64_t> readTime  = { 0 };
+
+	auto reader = [&]()
+	{
+		ScePadData              data = {};
+		std::vector<ScePadData> batch(ReadBatchSize);
+		uint64_t                torn = 0;
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i != m_desc.readCount; ++i)
+		{
+			sampler.readState(&data);
+			torn += CheckController::isConsistent(data) ? 0 : 1;
+		}
+		auto middle = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i != m_desc.readCount; ++i)
+		{
+			int32_t count = sampler.read(batch.data(), ReadBatchSize);
+			for (int32_t j = 0; j != count; ++j)
+			{
+				torn += CheckController::isConsistent(batch[j]) ? 0 : 1;
+			}
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+
+		tornCount += torn;
+		stateTime += std::chrono::duration_cast<std::chrono::nanoseconds>(middle - start).count();
+		readTime += std::chrono::duration_cast<std::chrono::nanoseconds>(end - middle).count();
+	};
+
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i != m_desc.threadCount; ++i)
+	{
+		threads.emplace_back(reader);
+	}
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+	sampler.stop();
+
+	double readCount = double(m_desc.readCount) * m_desc.threadCount;
+	std::printf("Concurrent     : %u readers, %u reads each, sampling at %u Hz\n",
+				m_desc.threadCount, m_desc.readCount, ConcurrentSampleRate);
+	std::printf("  readState    : %.1f ns per call\n", stateTime / readCount);
+	std::printf("  read(%d)      : %.1f ns per call\n", ReadBatchSize, readTime / readCount);
+	std::printf("  Samples      : %llu taken, %llu torn reads\n",
+				sampler.sampleCount(), tornCount.load());
+
+	return tornCount == 0;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "GPCS4Common.h"
+
+
+struct ScePadBenchDesc
+{
+	// Reads each reader thread does in the concurrent test.
+	uint32_t readCount;
+	// Threads reading the pad at once.
+	uint32_t threadCount;
+};
+
+
+// Replays an input script through a pad sampler on a virtual
+// clock, reading it like a game at 60 fps, and checks that
+// every scripted state shows up once, in order, with its
+// timestamp.
+//
+// Then samples on the sampling thread while other threads
+// read, and reports the cost of a read and whether any
+// read returned a torn sample.
+
+class ScePadBench
+{
+public:
+	ScePadBench(const ScePadBenchDesc& desc);
+	~ScePadBench();
+
+	bool run();
+
+private:
+	bool runScript();
+
+	bool runConcurrent();
+
+private:
+	ScePadBenchDesc m_desc;
+};
@@ -0,0 +1,190 @@
+#include "ScePadSampler.h"
+#include "ScePad.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+LOG_CHANNEL(SceModules.ScePad.ScePadSampler);
+
+ScePadSampler::ScePadSampler(SceInputController* controller) :
+	m_controller(controller)
+{
+}
+
+ScePadSampler::~ScePadSampler()
+{
+	stop();
+}
+
+void ScePadSampler::start(uint32_t rate)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!m_running && rate != 0)
+	{
+		m_running = true;
+		m_thread  = std::thread([this, rate]()
+								{ runSampler(rate); });
+	}
+}
+
+void ScePadSampler::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_running = false;
+		m_cond.notify_all();
+	}
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+}
+
+uint64_t ScePadSampler::now()
+{
+	auto time = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+}
+
+void ScePadSampler::sample(uint64_t time)
+{
+	ScePadData data = {};
+	m_controller->sample(time, &data);
+	data.timestamp = time;
+
+	uint64_t words[DataWordCount] = {};
+	std::memcpy(words, &data, sizeof(data));
+
+	uint64_t index = m_writeCount.load(std::memory_order_relaxed);
+	auto&    slot  = m_history[index % HistorySize];
+
+	slot.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	for (uint32_t i = 0; i != DataWordCount; ++i)
+	{
+		slot.words[i].store(words[i], std::memory_order_relaxed);
+	}
+	slot.sequence.store(index * 2 + 2, std::memory_order_release);
+
+	m_writeCount.store(index + 1, std::memory_order_release);
+}
+
+bool ScePadSampler::readState(ScePadData* data) const
+{
+	bool ret = false;
+	while (true)
+	{
+		uint64_t count = m_writeCount.load(std::memory_order_acquire);
+		if (count == 0)
+		{
+			break;
+		}
+
+		// Only fails if the ring wrapped around during the copy.
+		if (loadSample(count - 1, data))
+		{
+			ret = true;
+			break;
+		}
+	}
+	return ret;
+}
+
+int32_t ScePadSampler::read(ScePadData* data, int32_t num)
+{
+	int32_t count = 0;
+	do
+	{
+		if (num <= 0)
+		{
+			break;
+		}
+
+		uint64_t end   = m_writeCount.load(std::memory_order_acquire);
+		uint64_t begin = m_readCount.load(std::memory_order_relaxed);
+		if (begin >= end)
+		{
+			count = readState(data) ? 1 : 0;
+			break;
+		}
+
+		begin = std::max(begin, end - std::min<uint64_t>(end, std::min<uint64_t>(num, HistorySize)));
+		for (uint64_t index = begin; index != end; ++index)
+		{
+			if (loadSample(index, &data[count]))
+			{
+				++count;
+			}
+		}
+		m_readCount.store(end, std::memory_order_relaxed);
+	} while (false);
+	return count;
+}
+
+uint64_t ScePadSampler::sampleCount() const
+{
+	return m_writeCount.load(std::memory_order_acquire);
+}
+
+bool ScePadSampler::loadSample(uint64_t index, ScePadData* data) const
+{
+	bool ret = false;
+	do
+	{
+		const auto& slot     = m_history[index % HistorySize];
+		uint64_t    expected = index * 2 + 2;
+
+		// Odd, or another sample of the same slot.
+		uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+		if (sequence != expected)
+		{
+			break;
+		}
+
+		uint64_t words[DataWordCount];
+		for (uint32_t i = 0; i != DataWordCount; ++i)
+		{
+			words[i] = slot.words[i].load(std::memory_order_relaxed);
+		}
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot.sequence.load(std::memory_order_relaxed) != expected)
+		{
+			break;
+		}
+
+		std::memcpy(data, words, sizeof(ScePadData));
+		ret = true;
+	} while (false);
+	return ret;
+}
+
+void ScePadSampler::runSampler(uint32_t rate)
+{
+	uint64_t start = now();
+	uint64_t index = 0;
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (m_running)
+	{
+		lock.unlock();
+		sample(now());
+		lock.lock();
+
+		// Samples missed while this thread didn't run are dropped.
+		uint64_t next = start + ++index * 1000000 / rate;
+		uint64_t time = now();
+		if (next < time)
+		{
+			index = (time - start) * rate / 1000000 + 1;
+			next  = start + index * 1000000 / rate;
+		}
+
+		auto wake = std::chrono::steady_clock::time_point(
+			std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::microseconds(next)));
+		m_cond.wait_until(lock, wake, [this]()
+						  { return !m_running; });
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "GPCS4Common.h"
+#include "sce_pad_types.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+class SceInputController;
+
+/**
+ * \brief Samples a controller on a thread of its own
+ *
+ * Samples are published to a ring of the latest ones, each
+ * slot guarded by a sequence lock. Readers on guest threads
+ * take no lock and never wait for the sampling thread, a
+ * slot rewritten while being copied is detected and skipped.
+ *
+ * Without the thread, samples are taken by whoever calls
+ * sample(), so that a pad can be driven on a virtual clock.
+ */
+class ScePadSampler
+{
+	// Power of two, samples older than this are lost.
+	constexpr static uint32_t HistorySize = 64;
+
+	constexpr static uint32_t DataWordCount = (sizeof(ScePadData) + 7) / 8;
+
+public:
+	ScePadSampler(SceInputController* controller);
+	~ScePadSampler();
+
+	/**
+	 * \brief Starts the sampling thread
+	 *
+	 * \param [in] rate Samples per second
+	 */
+	void start(uint32_t rate);
+
+	void stop();
+
+	/**
+	 * \brief Time the sampling thread runs on, in microseconds
+	 */
+	static uint64_t now();
+
+	/**
+	 * \brief Takes and publishes one sample
+	 *
+	 * There must be one caller at a time.
+	 * \param [in] time Sample time in microseconds
+	 */
+	void sample(uint64_t time);
+
+	/**
+	 * \brief Gets the latest sample
+	 *
+	 * \returns False if nothing was sampled yet
+	 */
+	bool readState(ScePadData* data) const;
+
+	/**
+	 * \brief Gets the samples taken since the last read
+	 *
+	 * If there are more than num, the latest num are returned.
+	 * Without new ones, the latest sample is returned again.
+	 * \returns Number of samples, oldest first
+	 */
+	int32_t read(ScePadData* data, int32_t num);
+
+	/**
+	 * \brief Number of samples taken so far
+	 */
+	uint64_t sampleCount() const;
+
+private:
+	struct Slot
+	{
+		// 2 * (index + 1) once sample index is stored,
+		// odd while it's being written.
+		std::atomic<uint64_t>                            sequence = { 0 };
+		std::array<std::atomic<uint64_t>, DataWordCount> words;
+	};
+
+	bool loadSample(uint64_t index, ScePadData* data) const;
+
+	void runSampler(uint32_t rate);
+
+private:
+	SceInputController* m_controller;
+
+	std::array<Slot, HistorySize> m_history;
+	std::atomic<uint64_t>         m_writeCount = { 0 };
+	// Next sample returned by read.
+	std::atomic<uint64_t>         m_readCount = { 0 };
+
+	std::mutex              m_mutex;
+	std::condition_variable m_cond;
+	bool                    m_running = false;
+	std::thread             m_thread;
+};
@@ -134,10 +134,24 @@ int PS4API sceVideoOutRegisterStereoBuffers(int32_t handle, int32_t startIndex,
 }
 
 
-int PS4API sceVideoOutAddFlipEvent(void)
+int PS4API sceVideoOutAddFlipEvent(SceKernelEqueue eq, int32_t handle, void *udata)
 {
-	LOG_SCE_GRAPHIC("Not implemented");
-	return SCE_OK;
+	LOG_SCE_GRAPHIC("eq %p handle %d udata %p", eq, handle, udata);
+	auto& videoOut = GPU().videoOutGet(handle);
+	return videoOut.flipEvent().AddQueue((CSceEventQueue*)eq,
+										 SCE_VIDEO_OUT_EVENT_FLIP,
+										 SCE_KERNEL_EVFILT_VIDEO_OUT,
+										 udata);
+}
+
+
+int PS4API sceVideoOutDeleteFlipEvent(SceKernelEqueue eq, int32_t handle)
+{
+	LOG_SCE_GRAPHIC("eq %p handle %d", eq, handle);
+	auto& videoOut = GPU().videoOutGet(handle);
+	return videoOut.flipEvent().RemoveQueue((CSceEventQueue*)eq,
+											SCE_VIDEO_OUT_EVENT_FLIP,
+											SCE_KERNEL_EVFILT_VIDEO_OUT);
 }
 
 
@@ -169,30 +183,57 @@ int PS4API sceVideoOutGetDeviceCapabilityInfo_(void)
 }
 
 
-int PS4API sceVideoOutGetEventData(void)
+int PS4API sceVideoOutGetEventData(const SceKernelEvent *ev, int64_t *data)
 {
-	LOG_SCE_GRAPHIC("Not implemented");
-	return SCE_OK;
+	LOG_SCE_GRAPHIC("ev %p", ev);
+	int ret = SCE_VIDEO_OUT_ERROR_INVALID_ADDRESS;
+	do
+	{
+		if (!ev || !data)
+		{
+			break;
+		}
+
+		if (ev->filter != SCE_KERNEL_EVFILT_VIDEO_OUT)
+		{
+			ret = SCE_VIDEO_OUT_ERROR_INVALID_EVENT;
+			break;
+		}
+
+		// The flip arg is stored as is when the event is triggered.
+		*data = ev->data;
+
+		ret = SCE_OK;
+	} while (false);
+	return ret;
 }
 
 
 int PS4API sceVideoOutGetFlipStatus(int32_t handle, SceVideoOutFlipStatus *status)
 {
-	LOG_SCE_GRAPHIC("Dummy Implementation");
-
-	static uint64_t sCount = 1;
+	LOG_SCE_GRAPHIC("handle %d", handle);
+	int ret = SCE_VIDEO_OUT_ERROR_INVALID_ADDRESS;
+	do
+	{
+		if (!status)
+		{
+			break;
+		}
 
-	*status = {};
-	status->count = sCount++;
+		auto& videoOut = GPU().videoOutGet(handle);
+		*status        = videoOut.flipQueue().getFlipStatus();
 
-	return SCE_OK;
+		ret = SCE_OK;
+	} while (false);
+	return ret;
 }
 
 
-int PS4API sceVideoOutIsFlipPending(void)
+int PS4API sceVideoOutIsFlipPending(int32_t handle)
 {
-	LOG_SCE_GRAPHIC("Not implemented");
-	return SCE_OK;
+	LOG_SCE_GRAPHIC("handle %d", handle);
+	auto& videoOut = GPU().videoOutGet(handle);
+	return videoOut.flipQueue().pendingCount();
 }
 
 
@@ -217,23 +258,65 @@ int PS4API sceVideoOutSubmitChangeBufferAttribute(void)
 }
 
 
-int PS4API sceVideoOutSubmitFlip(void)
+int PS4API sceVideoOutSubmitFlip(int32_t handle, int32_t bufferIndex, uint32_t flipMode, int64_t flipArg)
 {
-	LOG_SCE_GRAPHIC("Not implemented");
-	return SCE_OK;
+	LOG_SCE_GRAPHIC("handle %d index %d mode %d arg %lld", handle, bufferIndex, flipMode, flipArg);
+	int ret = SCE_VIDEO_OUT_ERROR_INVALID_VALUE;
+	do
+	{
+		if (flipMode < SCE_VIDEO_OUT_FLIP_MODE_VSYNC || flipMode > SCE_VIDEO_OUT_FLIP_MODE_WINDOW_2)
+		{
+			ret = SCE_VIDEO_OUT_ERROR_INVALID_FLIP_MODE;
+			break;
+		}
+
+		auto& videoOut = GPU().videoOutGet(handle);
+
+		// -1 flips to a blank screen.
+		if (bufferIndex < -1 || bufferIndex >= static_cast<int32_t>(videoOut.displayBufferCount()))
+		{
+			ret = SCE_VIDEO_OUT_ERROR_INVALID_INDEX;
+			break;
+		}
+
+		// Buffers are presented when command buffers are submitted,
+		// only the flip is tracked here.
+		if (!videoOut.flipQueue().submitFlip(bufferIndex, flipMode, flipArg, sce::SceFlipQueue::now()))
+		{
+			ret = SCE_VIDEO_OUT_ERROR_FLIP_QUEUE_FULL;
+			break;
+		}
+
+		ret = SCE_OK;
+	} while (false);
+	return ret;
 }
 
 
-int PS4API sceVideoOutWaitVblank(void)
+int PS4API sceVideoOutWaitVblank(int32_t handle)
 {
-	LOG_SCE_GRAPHIC("Not implemented");
+	LOG_SCE_GRAPHIC("handle %d", handle);
+	auto& videoOut = GPU().videoOutGet(handle);
+	videoOut.flipQueue().waitVblank();
 	return SCE_OK;
 }
 
 
-int PS4API sceVideoOutGetVblankStatus( void )
+int PS4API sceVideoOutGetVblankStatus(int32_t handle, SceVideoOutVblankStatus *status)
 {
-	LOG_SCE_GRAPHIC("Not implemented");
-	return SCE_OK;
-}
+	LOG_SCE_GRAPHIC("handle %d", handle);
+	int ret = SCE_VIDEO_OUT_ERROR_INVALID_ADDRESS;
+	do
+	{
+		if (!status)
+		{
+			break;
+		}
+
+		auto& videoOut = GPU().videoOutGet(handle);
+		*status        = videoOut.flipQueue().getVblankStatus();
 
+		ret = SCE_OK;
+	} while (false);
+	return ret;
+}
@@ -11,6 +11,7 @@
 
 #include "sce_module_common.h"
 #include "sce_videoout_types.h"
+#include "SceLibkernel/sce_kernel_eventqueue.h"
 
 
 extern const SCE_EXPORT_MODULE g_ExpModuleSceVideoOut;
@@ -47,7 +48,10 @@ int PS4API sceVideoOutSetBufferAttribute(SceVideoOutBufferAttribute *attribute,
 int PS4API sceVideoOutSetFlipRate(int32_t handle, int32_t rate);
 
 
-int PS4API sceVideoOutAddFlipEvent(void);
+int PS4API sceVideoOutAddFlipEvent(SceKernelEqueue eq, int32_t handle, void *udata);
+
+
+int PS4API sceVideoOutDeleteFlipEvent(SceKernelEqueue eq, int32_t handle);
 
 
 int PS4API sceVideoOutAdjustColor_(void);
@@ -62,13 +66,13 @@ int PS4API sceVideoOutConfigureOutputMode_(void);
 int PS4API sceVideoOutGetDeviceCapabilityInfo_(void);
 
 
-int PS4API sceVideoOutGetEventData(void);
+int PS4API sceVideoOutGetEventData(const SceKernelEvent *ev, int64_t *data);
 
 
 int PS4API sceVideoOutGetFlipStatus(int32_t handle, SceVideoOutFlipStatus *status); 
 
 
-int PS4API sceVideoOutIsFlipPending(void);
+int PS4API sceVideoOutIsFlipPending(int32_t handle);
 
 
 int PS4API sceVideoOutModeSetAny_(void);
@@ -80,11 +84,11 @@ int PS4API sceVideoOutSetWindowModeMargins(void);
 int PS4API sceVideoOutSubmitChangeBufferAttribute(void);
 
 
-int PS4API sceVideoOutSubmitFlip(void);
+int PS4API sceVideoOutSubmitFlip(int32_t handle, int32_t bufferIndex, uint32_t flipMode, int64_t flipArg);
 
 
-int PS4API sceVideoOutWaitVblank(void);
+int PS4API sceVideoOutWaitVblank(int32_t handle);
 
 
-int PS4API sceVideoOutGetVblankStatus(void);
+int PS4API sceVideoOutGetVblankStatus(int32_t handle, SceVideoOutVblankStatus *status);
 
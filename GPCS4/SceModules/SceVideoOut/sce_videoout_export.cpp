@@ -16,6 +16,7 @@ static const SCE_EXPORT_FUNCTION g_pSceVideoOut_libSceVideoOut_FunctionTable[] =
 	{ 0x8BAFEC47DD56B7FE, "sceVideoOutSetBufferAttribute", (void*)sceVideoOutSetBufferAttribute },
 	{ 0x0818AEE26084D430, "sceVideoOutSetFlipRate", (void*)sceVideoOutSetFlipRate },
 	{ 0x1D7CE32BDC88DF49, "sceVideoOutAddFlipEvent", (void*)sceVideoOutAddFlipEvent },
+	{ 0xFCECE7D05D401518, "sceVideoOutDeleteFlipEvent", (void*)sceVideoOutDeleteFlipEvent },
 	{ 0xA6FF42239542F91D, "sceVideoOutAdjustColor_", (void*)sceVideoOutAdjustColor_ },
 	{ 0x0D886159B2527918, "sceVideoOutColorSettingsSetGamma_", (void*)sceVideoOutColorSettingsSetGamma_ },
 	{ 0x3756C4A09E12470E, "sceVideoOutConfigureOutputMode_", (void*)sceVideoOutConfigureOutputMode_ },
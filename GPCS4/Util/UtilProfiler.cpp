@@ -0,0 +1,264 @@
+#include "UtilProfiler.h"
+#include "UtilSync.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+LOG_CHANNEL(Util.Profiler);
+
+namespace util::prof
+{
+	std::atomic<bool> g_recording = { false };
+
+	namespace
+	{
+		constexpr uint32_t TrackThreadBase = 1000;
+
+		struct ZoneEvent
+		{
+			const char* name;
+			const char* category;
+			uint64_t    begin;
+			uint64_t    end;
+			uint32_t    tid;
+			// Counter samples have no category,
+			// the value is stored in end.
+			bool        counter;
+		};
+
+		// Each thread owns a buffer, so recording a zone
+		// only takes an uncontested spinlock. The lock is
+		// taken by the flip thread when the trace is written.
+		struct ThreadBuffer
+		{
+			sync::Spinlock         lock;
+			uint32_t               tid = 0;
+			std::vector<ZoneEvent> events;
+		};
+
+		struct ProfilerState
+		{
+			ProfilerDesc desc    = {};
+			bool         enabled = false;
+			uint64_t     frame   = 0;
+			uint64_t     frameBegin = 0;
+
+			std::chrono::steady_clock::time_point epoch;
+
+			std::mutex                                 mutex;
+			std::vector<std::shared_ptr<ThreadBuffer>> threads;
+			uint32_t                                   nextTid = 1;
+		};
+
+		ProfilerState& state()
+		{
+			static ProfilerState s_state;
+			return s_state;
+		}
+
+		ThreadBuffer& threadBuffer()
+		{
+			thread_local std::shared_ptr<ThreadBuffer> t_buffer;
+			if (unlikely(!t_buffer))
+			{
+				auto& s  = state();
+				t_buffer = std::make_shared<ThreadBuffer>();
+
+				std::lock_guard<std::mutex> guard(s.mutex);
+				t_buffer->tid = s.nextTid++;
+				s.threads.push_back(t_buffer);
+			}
+			return *t_buffer;
+		}
+
+		void pushEvent(const ZoneEvent& event)
+		{
+			auto& buffer = threadBuffer();
+
+			std::lock_guard<sync::Spinlock> guard(buffer.lock);
+			buffer.events.push_back(event);
+		}
+
+		const char* trackName(uint32_t tid)
+		{
+			const char* name = nullptr;
+			switch (static_cast<ProfilerTrack>(tid - TrackThreadBase))
+			{
+			case ProfilerTrack::Frame:
+				name = "Frames";
+				break;
+			case ProfilerTrack::GpuGraphics:
+				name = "GPU Graphics";
+				break;
+			case ProfilerTrack::GpuCompute:
+				name = "GPU Compute";
+				break;
+			}
+			return name;
+		}
+
+		void clearEvents()
+		{
+			auto& s = state();
+
+			std::lock_guard<std::mutex> guard(s.mutex);
+			for (auto& thread : s.threads)
+			{
+				std::lock_guard<sync::Spinlock> lock(thread->lock);
+				thread->events.clear();
+			}
+		}
+
+		void writeTrace()
+		{
+			auto& s = state();
+
+			do
+			{
+				FILE* file = std::fopen(s.desc.path.c_str(), "w");
+				if (!file)
+				{
+					LOG_ERR("open trace file %s failed.", s.desc.path.c_str());
+					break;
+				}
+
+				std::fprintf(file, "{\"traceEvents\":[\n");
+
+				for (uint32_t track = 0; track <= static_cast<uint32_t>(ProfilerTrack::GpuCompute); ++track)
+				{
+					uint32_t tid = TrackThreadBase + track;
+					std::fprintf(file,
+								 "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}},\n",
+								 tid, trackName(tid));
+				}
+
+				size_t eventCount = 0;
+				{
+					std::lock_guard<std::mutex> guard(s.mutex);
+					for (auto& thread : s.threads)
+					{
+						std::lock_guard<sync::Spinlock> lock(thread->lock);
+						for (const auto& event : thread->events)
+						{
+							if (event.counter)
+							{
+								std::fprintf(file,
+											 "{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"value\":%llu}},\n",
+											 event.name,
+											 event.begin / 1000.0,
+											 static_cast<unsigned long long>(event.end));
+							}
+							else
+							{
+								std::fprintf(file,
+											 "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f},\n",
+											 event.name,
+											 event.category,
+											 event.tid,
+											 event.begin / 1000.0,
+											 (event.end - event.begin) / 1000.0);
+							}
+						}
+						eventCount += thread->events.size();
+						thread->events.clear();
+					}
+				}
+
+				// Chrome's trace viewer doesn't accept a trailing comma.
+				std::fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"GPCS4\"}}\n");
+				std::fprintf(file, "]}\n");
+				std::fclose(file);
+
+				LOG_DEBUG("%zu events written to %s", eventCount, s.desc.path.c_str());
+			} while (false);
+		}
+	}  // namespace
+
+	void initialize(const ProfilerDesc& desc)
+	{
+		auto& s = state();
+
+		s.desc    = desc;
+		s.enabled = desc.frameCount != 0;
+		s.frame   = 0;
+		s.epoch   = std::chrono::steady_clock::now();
+
+		// Frame 0 is never preceded by a flip.
+		if (s.enabled && s.desc.startFrame == 0)
+		{
+			s.frameBegin = now();
+			g_recording.store(true, std::memory_order_relaxed);
+		}
+	}
+
+	uint64_t now()
+	{
+		auto duration = std::chrono::steady_clock::now() - state().epoch;
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+	}
+
+	void recordZone(
+		const char* name,
+		const char* category,
+		uint64_t    begin,
+		uint64_t    end)
+	{
+		pushEvent(ZoneEvent{ name, category, begin, end, threadBuffer().tid, false });
+	}
+
+	void recordTrackZone(
+		ProfilerTrack track,
+		const char*   name,
+		const char*   category,
+		uint64_t      begin,
+		uint64_t      end)
+	{
+		uint32_t tid = TrackThreadBase + static_cast<uint32_t>(track);
+		pushEvent(ZoneEvent{ name, category, begin, end, tid, false });
+	}
+
+	void recordCounter(
+		const char* name,
+		uint64_t    value)
+	{
+		pushEvent(ZoneEvent{ name, nullptr, now(), value, 0, true });
+	}
+
+	void nextFrame()
+	{
+		auto& s = state();
+
+		do
+		{
+			if (!s.enabled)
+			{
+				break;
+			}
+
+			uint64_t frameEnd = now();
+			if (isRecording())
+			{
+				recordTrackZone(ProfilerTrack::Frame, "Frame", "Frame", s.frameBegin, frameEnd);
+			}
+			s.frameBegin = frameEnd;
+
+			++s.frame;
+
+			if (s.frame == s.desc.startFrame)
+			{
+				clearEvents();
+				g_recording.store(true, std::memory_order_relaxed);
+			}
+			else if (s.frame == uint64_t(s.desc.startFrame) + s.desc.frameCount)
+			{
+				g_recording.store(false, std::memory_order_relaxed);
+				writeTrace();
+				s.enabled = false;
+			}
+		} while (false);
+	}
+
+}  // namespace util::prof
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "GPCS4Common.h"
+#include "UtilLikely.h"
+
+#include <atomic>
+#include <string>
+
+namespace util::prof
+{
+	/**
+	 * \brief Profiler description
+	 *
+	 * Frames are counted by \ref nextFrame, recording
+	 * starts at \c startFrame and lasts \c frameCount
+	 * frames, after which a Chrome trace-event JSON
+	 * file is written to \c path.
+	 */
+	struct ProfilerDesc
+	{
+		std::string path;
+		uint32_t    startFrame;
+		uint32_t    frameCount;
+	};
+
+	/**
+	 * \brief Timeline track
+	 *
+	 * GPU work and frame markers are not executed
+	 * by any CPU thread, so they go to pseudo threads.
+	 */
+	enum class ProfilerTrack : uint32_t
+	{
+		Frame       = 0,
+		GpuGraphics = 1,
+		GpuCompute  = 2,
+	};
+
+	extern std::atomic<bool> g_recording;
+
+	/**
+	 * \brief Checks whether zones are recorded
+	 *
+	 * This is the only cost paid by a zone
+	 * when the profiler is disabled.
+	 */
+	inline bool isRecording()
+	{
+		return unlikely(g_recording.load(std::memory_order_relaxed));
+	}
+
+	/**
+	 * \brief Enables the profiler
+	 *
+	 * Must be called once before the first frame.
+	 * \param [in] desc Profiler description
+	 */
+	void initialize(const ProfilerDesc& desc);
+
+	/**
+	 * \brief Current profiler time
+	 * \returns Nanoseconds since profiler epoch
+	 */
+	uint64_t now();
+
+	/**
+	 * \brief Records a CPU zone for the calling thread
+	 *
+	 * \c name and \c category must be string literals,
+	 * only the pointers are stored until the trace is written.
+	 */
+	void recordZone(
+		const char* name,
+		const char* category,
+		uint64_t    begin,
+		uint64_t    end);
+
+	/**
+	 * \brief Records a zone on a pseudo track
+	 *
+	 * Times must already be converted to profiler time.
+	 */
+	void recordTrackZone(
+		ProfilerTrack track,
+		const char*   name,
+		const char*   category,
+		uint64_t      begin,
+		uint64_t      end);
+
+	/**
+	 * \brief Records a counter sample
+	 *
+	 * Counters are shown as graphs above the tracks.
+	 * \c name must be a string literal.
+	 */
+	void recordCounter(
+		const char* name,
+		uint64_t    value);
+
+	/**
+	 * \brief Advances to the next frame
+	 *
+	 * Called once per flip. Starts and stops recording
+	 * according to the frame range, and writes the trace
+	 * file when the range is complete.
+	 */
+	void nextFrame();
+
+	/**
+	 * \brief Scoped CPU zone
+	 *
+	 * Records the lifetime of the object
+	 * as a zone of the calling thread.
+	 */
+	class ScopedZone
+	{
+	public:
+		ScopedZone(const char* name, const char* category) :
+			m_name(name),
+			m_category(category)
+		{
+			if (isRecording())
+			{
+				m_begin = now();
+			}
+		}
+
+		~ScopedZone()
+		{
+			if (m_begin != 0)
+			{
+				recordZone(m_name, m_category, m_begin, now());
+			}
+		}
+
+		ScopedZone(const ScopedZone&) = delete;
+		ScopedZone& operator=(const ScopedZone&) = delete;
+
+	private:
+		const char* m_name;
+		const char* m_category;
+		uint64_t    m_begin = 0;
+	};
+
+}  // namespace util::prof
+
+#define PROFILER_ZONE_CONCAT_IMPL(a, b) a##b
+#define PROFILER_ZONE_CONCAT(a, b)      PROFILER_ZONE_CONCAT_IMPL(a, b)
+
+#define PROFILER_ZONE(name, category) \
+	util::prof::ScopedZone PROFILER_ZONE_CONCAT(__profilerZone, __LINE__)(name, category)